@@ -15,6 +15,13 @@
 #include "esp_flash.h"
 #include "esp_ota_ops.h"
 #include "esp_image_format.h"
+#include "esp_timer.h"
+#include "maps.hpp"
+#include "trackRecorder.hpp"
+#include "waypointStore.hpp"
+#include "gpxParser.hpp"
+#include "trackSimplify.hpp"
+#include "nmeaCapture.hpp"
 
 static const char logo[] =
 "\r\n"
@@ -32,6 +39,7 @@ static const char logo[] =
 static const char* TAG = "CLI";
 
 extern Power power;
+extern Maps mapView;
 
 /**
  * @brief Reboots the ESP device.
@@ -268,6 +276,279 @@ void wcli_webfile(char *args, Stream *response)
     }
 }
 
+/**
+ * @brief Benchmarks raster tile decoding, Q565 against PNG.
+ * 
+ * @details CLI command: tilebench [zoom x y]. Uses the tile under the GPS position if no tile is given.
+ */
+void wcli_tilebench(char *args, Stream *response)
+{
+    static const uint8_t BENCH_LOOPS = 10;
+    unsigned int tileZ = zoom;
+    unsigned int tileX = 0;
+    unsigned int tileY = 0;
+
+    if (sscanf(args, "%u %u %u", &tileZ, &tileX, &tileY) != 3)
+    {
+        auto tile = mapView.getMapTile(gps.gpsData.longitude, gps.gpsData.latitude, zoom, 0, 0);
+        tileZ = tile.zoom;
+        tileX = tile.tilex;
+        tileY = tile.tiley;
+    }
+
+    char pngPath[128];
+    char q565Path[128];
+    snprintf(pngPath, sizeof(pngPath), mapRenderFolder, tileZ, tileX, tileY);
+    snprintf(q565Path, sizeof(q565Path), mapQ565Folder, tileZ, tileX, tileY);
+    response->printf("Tile %u/%u/%u, %u loops\r\n", tileZ, tileX, tileY, BENCH_LOOPS);
+
+    TFT_eSprite benchSprite = TFT_eSprite(&tft);
+    if (!benchSprite.createSprite(256, 256))
+    {
+        response->println("Not enough memory for bench sprite");
+        return;
+    }
+
+    float pngMs = 0.0f;
+    float q565Ms = 0.0f;
+
+    if (storage.exists(pngPath))
+    {
+        int64_t start = esp_timer_get_time();
+        for (uint8_t i = 0; i < BENCH_LOOPS; i++)
+            benchSprite.drawPngFile(pngPath, 0, 0);
+        pngMs = (esp_timer_get_time() - start) / 1000.0f / BENCH_LOOPS;
+        response->printf("PNG\t: %u bytes, %.2f ms/tile\r\n", storage.size(pngPath), pngMs);
+    }
+    else
+        response->println("PNG\t: not found");
+
+    if (storage.exists(q565Path))
+    {
+        // Own file buffer, the map render task uses its one meanwhile
+        Maps::TileBuffer benchBuffer;
+        int64_t start = esp_timer_get_time();
+        for (uint8_t i = 0; i < BENCH_LOOPS; i++)
+            Maps::drawQ565File(q565Path, benchSprite, 0, 0, benchBuffer);
+        q565Ms = (esp_timer_get_time() - start) / 1000.0f / BENCH_LOOPS;
+        response->printf("Q565\t: %u bytes, %.2f ms/tile\r\n", storage.size(q565Path), q565Ms);
+    }
+    else
+        response->println("Q565\t: not found");
+
+    if (pngMs > 0.0f && q565Ms > 0.0f)
+        response->printf("Speedup\t: x%.1f\r\n", pngMs / q565Ms);
+
+    benchSprite.deleteSprite();
+}
+
+/**
+ * @brief Shows the statistics of the last vector map frame.
+ * 
+ * @details CLI command: mapstats
+ */
+void wcli_mapstats(char *args, Stream *response)
+{
+    const Maps::RenderStats &stats = mapView.renderStats;
+    response->printf("Frame budget\t: %u ms%s\r\n", mapSet.renderBudget, mapSet.renderBudget == 0 ? " (off)" : "");
+    response->printf("Features\t: %u\r\n", stats.features);
+    response->printf("First frame\t: %lu ms\r\n", (unsigned long)stats.firstFrameMs);
+    response->printf("Full frame\t: %lu ms\r\n", (unsigned long)stats.frameMs);
+    response->printf("Tile reads\t: %lu ms\r\n", (unsigned long)stats.fetchMs);
+    response->printf("Deferred\t: %u layers, %u slices\r\n", stats.layersDeferred, stats.slices);
+}
+
+/**
+ * @brief Trace dump output to the CLI stream.
+ */
+static void sdtraceWriter(const char *data, size_t len, void *arg)
+{
+    ((Stream *)arg)->write((const uint8_t *)data, len);
+}
+
+/**
+ * @brief Controls the SD access trace.
+ * 
+ * @details CLI command: sdtrace [start|stop|clear|dump]
+ */
+void wcli_sdtrace(char *args, Stream *response)
+{
+    Pair<String, String> operands = wcli.parseCommand(args);
+    String action = operands.first();
+
+    if (action == "start")
+    {
+        if (storage.startTrace())
+            response->println("SD trace started");
+        else
+            response->println("Not enough memory for SD trace");
+    }
+    else if (action == "stop")
+    {
+        storage.stopTrace();
+        response->println("SD trace stopped");
+    }
+    else if (action == "clear")
+    {
+        storage.clearTrace();
+        response->println("SD trace cleared");
+    }
+    else if (action == "dump")
+        storage.dumpTrace(sdtraceWriter, response);
+    else
+    {
+        response->printf("SD trace\t: %s, %lu events\r\n", storage.isTracing() ? "running" : "stopped",
+                         (unsigned long)storage.getTraceCount());
+        response->println("usage: sdtrace [start|stop|clear|dump]");
+    }
+}
+
+/**
+ * @brief Starts or stops the GPX track recorder and shows its status.
+ * 
+ * @details CLI command: trkrec [start|stop]
+ */
+void wcli_trkrec(char *args, Stream *response)
+{
+    Pair<String, String> operands = wcli.parseCommand(args);
+    String action = operands.first();
+
+    if (action == "start")
+    {
+        if (!trackRecorder.start())
+        {
+            response->println("Track recorder not started");
+            return;
+        }
+    }
+    else if (action == "stop")
+        trackRecorder.stop();
+
+    const TrackLog &log = trackRecorder.getLog();
+    response->printf("Recorder\t: %s\r\n", trackRecorder.isRecording() ? "recording" : "stopped");
+    response->printf("File\t\t: %s\r\n", trackRecorder.getFileName());
+    response->printf("Points\t\t: %lu (%lu dropped)\r\n", (unsigned long)log.points, (unsigned long)log.dropped);
+    response->printf("Queued\t\t: %u bytes\r\n", log.pending());
+    response->printf("Written\t\t: %lu bytes, %lu batches (%lu errors), slowest %lu ms\r\n",
+                     (unsigned long)trackRecorder.bytesWritten, (unsigned long)trackRecorder.flushes,
+                     (unsigned long)trackRecorder.flushErrors, (unsigned long)trackRecorder.maxFlushMs);
+}
+
+/**
+ * @brief Starts or stops the capture of the raw GPS byte stream and shows its status.
+ * 
+ * @details CLI command: nmeacap [start|stop]
+ */
+void wcli_nmeacap(char *args, Stream *response)
+{
+    Pair<String, String> operands = wcli.parseCommand(args);
+    String action = operands.first();
+
+    if (action == "start")
+    {
+        if (!nmeaCapture.start())
+        {
+            response->println("NMEA capture not started");
+            return;
+        }
+    }
+    else if (action == "stop")
+        nmeaCapture.stop();
+
+    response->printf("Capture\t\t: %s\r\n", nmeaCapture.isCapturing() ? "capturing" : "stopped");
+    response->printf("File\t\t: %s\r\n", nmeaCapture.getFileName());
+    response->printf("Captured\t: %lu bytes (%lu bursts dropped)\r\n", (unsigned long)nmeaCapture.bytesCaptured,
+                     (unsigned long)nmeaCapture.dropped);
+    response->printf("Written\t\t: %lu bytes\r\n", (unsigned long)nmeaCapture.bytesWritten);
+    response->printf("Sentences\t: %lu (%lu dropped before parsing)\r\n", (unsigned long)nmeaRing.sentences,
+                     (unsigned long)nmeaRing.dropped);
+}
+
+/**
+ * @brief Shows the waypoint store status, exports it to GPX, compacts its log or imports a GPX file.
+ * 
+ * @details CLI command: wptdb [export|compact|import <file>]
+ */
+void wcli_wptdb(char *args, Stream *response)
+{
+    Pair<String, String> operands = wcli.parseCommand(args);
+    String action = operands.first();
+
+    if (!waypointStore.isOpen())
+    {
+        response->println("Waypoint store not open");
+        return;
+    }
+
+    if (action == "export")
+        response->println(waypointStore.exportGpx() ? "Exported" : "Export failed");
+    else if (action == "compact")
+        response->println(waypointStore.compact() ? "Compacted" : "Compaction failed");
+    else if (action == "import")
+    {
+        String file = operands.second();
+        if (file.isEmpty())
+        {
+            response->println("usage: wptdb import <file>");
+            return;
+        }
+        response->println(waypointStore.importGpx(file.c_str()) ? "Imported" : "Import failed");
+    }
+
+    response->printf("File\t\t: %s\r\n", wptFile);
+    response->printf("Waypoints\t: %lu\r\n", (unsigned long)waypointStore.liveCount);
+    response->printf("Log\t\t: %lu bytes, %lu dead records\r\n", (unsigned long)waypointStore.logSize,
+                     (unsigned long)waypointStore.deadCount);
+    response->printf("GPX\t\t: %s\r\n", waypointStore.dirty ? "export pending" : "up to date");
+}
+
+/**
+ * @brief Shows GPX tracks on the map as reference tracks, or removes them.
+ * 
+ * @details CLI command: trkshow [<file>|clear]
+ */
+void wcli_trkshow(char *args, Stream *response)
+{
+    static const uint16_t palette[] = {TFT_MAGENTA, TFT_DARKGREEN, TFT_ORANGE, TFT_PURPLE, TFT_CYAN, TFT_BROWN};
+    Pair<String, String> operands = wcli.parseCommand(args);
+    String action = operands.first();
+
+    if (action == "clear")
+    {
+        for (uint8_t slot = Maps::MAP_TRACK_REFERENCE; slot < TrackOverlay::MAX_TRACKS; slot++)
+            mapView.removeTrack(slot);
+    }
+    else if (!action.isEmpty())
+    {
+        uint8_t slot = Maps::MAP_TRACK_REFERENCE;
+        while (slot < TrackOverlay::MAX_TRACKS && mapView.trackPoints(slot) != 0)
+            slot++;
+        if (slot == TrackOverlay::MAX_TRACKS)
+        {
+            response->println("No free track slot, use trkshow clear");
+            return;
+        }
+
+        // Own index, the loaded track one belongs to the GUI task
+        TrackVector track, shown;
+        std::vector<TrackSegment> index;
+        TrackIndexMap shownToTrack;
+        GPXParser gpx(action.c_str());
+        if (!gpx.loadTrack(track, index) || track.size() < 2)
+        {
+            response->println("Track not loaded");
+            return;
+        }
+        simplifyTrack(track, {navSet.simplifyTolerance, 0.0f}, shown, shownToTrack);
+        mapView.setTrack(slot, shown.lat.data(), shown.lon.data(), shown.size(),
+                         palette[slot - Maps::MAP_TRACK_REFERENCE], 2);
+        response->printf("Track %u: %u points (%u shown)\r\n", slot, (unsigned)track.size(), (unsigned)shown.size());
+    }
+
+    for (uint8_t slot = 0; slot < TrackOverlay::MAX_TRACKS; slot++)
+        response->printf("Slot %u\t\t: %u points\r\n", slot, (unsigned)mapView.trackPoints(slot));
+}
+
 /**
  * @brief Initializes the CLI remote shell (e.g., Telnet).
  */
@@ -296,6 +577,13 @@ void initShell()
     wcli.add("klist", &wcli_klist, "\t\tlist of user preferences. ('all' param show all)");
     wcli.add("kset", &wcli_kset, "\t\tset an user extra preference");
     wcli.add("outnmea", &wcli_outnmea, "\ttoggle GPS NMEA output (or Ctrl+C to stop)");
+    wcli.add("tilebench", &wcli_tilebench, "\tbenchmark raster tile decode (Q565 vs PNG)");
+    wcli.add("mapstats", &wcli_mapstats, "\tshow last vector map frame statistics");
+    wcli.add("sdtrace", &wcli_sdtrace, "\tSD access trace (start|stop|clear|dump)");
+    wcli.add("trkrec", &wcli_trkrec, "\tGPX track recorder (start|stop)");
+    wcli.add("nmeacap", &wcli_nmeacap, "\tcapture GPS NMEA stream to SD (start|stop)");
+    wcli.add("wptdb", &wcli_wptdb, "\t\twaypoint store (export|compact|import <file>)");
+    wcli.add("trkshow", &wcli_trkshow, "\tshow GPX tracks on the map (<file>|clear)");
     wcli.shell->overrideAbortKey(&wcli_abort_handler);
     wcli.begin("IceNav");
 }
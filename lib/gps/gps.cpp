@@ -7,6 +7,7 @@
  */
 
 #include "gps.hpp"
+#include "nmeaCapture.hpp"
 #include "lvgl.h"
 #include "widgets.hpp"
 #include <freertos/FreeRTOS.h>
@@ -67,6 +68,7 @@ long gpsBaudDetected = 0;   	   /**< Detected GPS baud rate. */
 bool nmea_output_enable = false;   /**< Enables or disables NMEA output. */
 gps_fix fix;             	       /**< Latest parsed GPS fix data. */
 NMEAGPS GPS;              	       /**< NMEAGPS parser instance. */
+NmeaRing nmeaRing;                 /**< Complete NMEA sentences received from gpsPort. */
 Gps gps;                           /**< Global GPS instance */
 
 static const char* TAG = "GPS";
@@ -87,12 +89,46 @@ Gps::Gps()
     memset(&satTracker, 0, sizeof(satTracker));
 }
 
+/**
+ * @brief UART receive callback of gpsPort.
+ *
+ * @details Runs in the UART event task on each received burst (FIFO threshold or RX timeout).
+ *          Moves the bytes into nmeaRing (and the NMEA capture, if running) and wakes the GPS task
+ *          only if a sentence was completed.
+ */
+static void onGpsReceive()
+{
+    uint8_t buf[128];
+    size_t completed = 0;
+    size_t len;
+    while ((len = gpsPort.read(buf, sizeof(buf))) > 0)
+    {
+        nmeaCapture.add(buf, len, millis_idf());
+        completed += nmeaRing.write(buf, len);
+    }
+
+    if (completed != 0 && gpsTaskHandle != NULL)
+        xTaskNotifyGive(gpsTaskHandle);
+}
+
+/**
+ * @brief Attach the UART receive callback to gpsPort.
+ *
+ * @details Must be called after each gpsPort.begin(), end() removes the callback. The RX timeout
+ *          of a few symbols ends a burst soon after its last sentence.
+ */
+void Gps::startIngest()
+{
+    gpsPort.setRxTimeout(4);
+    gpsPort.onReceive(onGpsReceive, false);
+}
+
 /**
  * @brief Init GPS and custom NMEA parsing.
  *
  * @details Initializes the GPS port with the appropriate baud rate and buffer size.
  * 			If a specific baud rate is not set (gpsBaud != 4), it uses the predefined baud rate array.
- *			Otherwise, it attempts to auto-detect the baud rate.
+ *			Otherwise, it attempts to auto-detect the baud rate. Received sentences go to nmeaRing.
  */
 void Gps::init()
 {
@@ -107,6 +143,7 @@ void Gps::init()
         if (gpsBaudDetected != 0)
             gpsPort.begin(gpsBaudDetected, SERIAL_8N1, GPS_RX, GPS_TX);
     }
+    startIngest();
 
     #ifdef AT6558D_GPS
         // FACTORY RESET
@@ -191,6 +228,7 @@ float Gps::getLon()
  * @details Updates the GPS data structure with the latest parsed values from the GPS fix.
  * 			Handles fix status, satellite information, time/date updates, position, altitude, speed,
  * 			heading, dilution of precision values, and updates satellite tracker positions and status.
+ * 			The data itself is filled by fillGpsData(), shared with tools/nmea_replay.
  */
 void Gps::getGPSData()
 {
@@ -202,11 +240,7 @@ void Gps::getGPSData()
     if (fix.status == gps_fix::STATUS_NONE)
         isGpsFixed = false;
 
-    // Satellite Count
-    gpsData.satellites = fix.satellites;
-
-    // Fix Mode
-    gpsData.fixMode = fix.status;
+    fillGpsData(fix, GPS, gpsData, satTracker);
 
     // Time and Date
     if (fix.valid.time && fix.valid.date)
@@ -223,57 +257,6 @@ void Gps::getGPSData()
             lv_obj_send_event(sunriseLabel, LV_EVENT_VALUE_CHANGED, NULL);
         }
     }
-
-    // Altitude
-    if (fix.valid.altitude)
-        gpsData.altitude = fix.alt.whole;
-
-    // Speed
-    if (fix.valid.speed)
-        gpsData.speed = (uint16_t)fix.speed_kph();
-
-    // Latitude and Longitude
-    if (fix.valid.location)
-    {
-        gpsData.latitude = getLat();
-        gpsData.longitude = getLon();
-    }
-
-    // Heading
-    if (fix.valid.heading)
-        gpsData.heading = (uint16_t)fix.heading();
-
-    // HDOP , PDOP , VDOP
-    if (fix.valid.hdop)
-        gpsData.hdop = (float)fix.hdop / 1000;
-    if (fix.valid.pdop)
-        gpsData.pdop = (float)fix.pdop / 1000;
-    if (fix.valid.vdop)
-        gpsData.vdop = (float)fix.vdop / 1000;
-
-    // // Satellite info
-    gpsData.satInView = (uint8_t)GPS.sat_count;
-    for (uint8_t i = 0; i < gpsData.satInView; i++)
-    {
-        satTracker[i].satNum = (uint8_t)GPS.satellites[i].id;
-        satTracker[i].elev = (uint8_t)GPS.satellites[i].elevation;
-        satTracker[i].azim = (uint16_t)GPS.satellites[i].azimuth;
-        satTracker[i].snr = (uint8_t)GPS.satellites[i].snr;
-        satTracker[i].active = GPS.satellites[i].tracked;
-        strncpy(satTracker[i].talker_id, GPS.satellites[i].talker_id, 3);
-
-        // Clamp elevation between 0 and 90 degrees
-        int8_t clampedElev = std::max((int8_t)0, std::min((int8_t)90, (int8_t)satTracker[i].elev));
-        int H = canvasRadius * (90 - clampedElev) / 90;
-
-        float azimRad = DEG2RAD((float)satTracker[i].azim);
-        float sinAzim = lutInit ? sinLUT(azimRad) : sinf(azimRad);
-        float cosAzim = lutInit ? cosLUT(azimRad) : cosf(azimRad);
-
-        satTracker[i].posX = canvasCenter_X + H * sinAzim;
-        satTracker[i].posY = canvasCenter_Y - H * cosAzim;
-    }
-
 }
 
 /**
@@ -483,7 +466,7 @@ void Gps::setLocalTime(NeoGPS::time_t gpsTime, const char* tz)
  *          Applies random offset noise and smoothing to emulate realistic GPS signal behavior.
  *          Updates the simulated GPS data every second if the step distance is above a threshold.
  *
- * @param trackData Vector of wayPoints representing the preloaded GPX track.
+ * @param trackData Preloaded GPX track points.
  * @param speed Simulated speed in km/h to assign to the GPS data.
  * @param refresh Simulation update rate refresh in ms
  */
@@ -498,8 +481,8 @@ void Gps::simFakeGPS(const TrackVector& trackData, uint16_t speed, uint16_t refr
             if (simulationIndex == 0)
             {
                   // --- First point: initialize simulation state ---
-                smoothedLat = trackData[0].lat;
-                smoothedLon = trackData[0].lon;
+                smoothedLat = trackData.lat[0];
+                smoothedLon = trackData.lon[0];
                 lastSimLat = smoothedLat;
                 lastSimLon = smoothedLon;
                 filteredHeading = 0.0f;
@@ -512,8 +495,8 @@ void Gps::simFakeGPS(const TrackVector& trackData, uint16_t speed, uint16_t refr
             }
             else
             {
-                float rawLat = trackData[simulationIndex].lat;
-                float rawLon = trackData[simulationIndex].lon;
+                float rawLat = trackData.lat[simulationIndex];
+                float rawLon = trackData.lon[simulationIndex];
 
                 // Calculate expected distance based on speed and time
                 float expectedDist = (speed * 1000.0f) / 3600.0f;  // Convert km/h to m/s
@@ -530,8 +513,8 @@ void Gps::simFakeGPS(const TrackVector& trackData, uint16_t speed, uint16_t refr
                 while (currentIndex < (int)trackData.size() - 1 && pointsAdvanced < 10) 
                 { 
                     int nextIndex = currentIndex + 1;
-                    float segmentDist = calcDist(trackData[currentIndex].lat, trackData[currentIndex].lon,
-                                                trackData[nextIndex].lat, trackData[nextIndex].lon);
+                    float segmentDist = calcDist(trackData.lat[currentIndex], trackData.lon[currentIndex],
+                                                trackData.lat[nextIndex], trackData.lon[nextIndex]);
                     
                     // Skip unrealistic jumps or duplicate points
                     if (segmentDist > maxSegmentDist || segmentDist < 0.1f) 
@@ -555,8 +538,8 @@ void Gps::simFakeGPS(const TrackVector& trackData, uint16_t speed, uint16_t refr
                 simulationIndex = currentIndex;
                 
                 // Update position to the final point
-                rawLat = trackData[simulationIndex].lat;
-                rawLon = trackData[simulationIndex].lon;
+                rawLat = trackData.lat[simulationIndex];
+                rawLon = trackData.lon[simulationIndex];
 
                 // --- Apply smoothing BEFORE adding noise ---
                 smoothedLat = posAlpha * rawLat + (1.0f - posAlpha) * smoothedLat;
@@ -578,8 +561,8 @@ void Gps::simFakeGPS(const TrackVector& trackData, uint16_t speed, uint16_t refr
                 {
                     // Calculate heading towards future track point
                     float targetHeading = calcCourse(smoothedLat, smoothedLon,
-                                                    trackData[targetIdx].lat,
-                                                    trackData[targetIdx].lon);
+                                                    trackData.lat[targetIdx],
+                                                    trackData.lon[targetIdx]);
                     
                     if (simulationIndex > 1) 
                     {
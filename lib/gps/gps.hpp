@@ -12,21 +12,22 @@
 #include <NMEAGPS.h>
 #include <Streamers.h>
 #include "settings.hpp"
+#include "nmeaRing.hpp"
+#include "gpsFix.hpp"
 #include <vector>
 
 
 extern uint8_t GPS_TX; /**< GPS TX pin number. */
 extern uint8_t GPS_RX; /**< GPS RX pin number. */
 
-#define MAX_SATELLITES 120		   /**< Maximum number of satellites supported. */
-#define MAX_SATELLLITES_IN_VIEW 32 /**< Maximum number of satellites in view. */
-
 #define DEBUG_PORT Serial 		/**< Serial port used for debug output. */
 #define gpsPort Serial2			/**< Serial port used for GPS communication. */
 #define GPS_PORT_NAME "Serial2" /**< Name of the GPS serial port. */
 
 extern gps_fix fix; /**< Latest parsed GPS fix data. */
 extern NMEAGPS GPS; /**< NMEAGPS parser instance. */
+extern NmeaRing nmeaRing; /**< Complete NMEA sentences received from gpsPort, read by the GPS task. */
+extern TaskHandle_t gpsTaskHandle; /**< GPS task, notified when complete sentences are received. */
 
 extern bool setTime; /**< Indicates if time should be set from GPS. */
 void calculateSun(); /**< Calculates sunrise and sunset times based on current GPS data. */
@@ -44,16 +45,6 @@ static unsigned long GPS_BAUD[] = {4800, 9600, 19200, 0}; /**< Supported GPS bau
 static const char *GPS_BAUD_PCAS[] = {"$PCAS01,0*1C\r\n", "$PCAS01,1*1D\r\n", "$PCAS01,2*1E\r\n"}; /**< NMEA command strings to set baud rate for PCAS modules. */
 static const char *GPS_RATE_PCAS[] = {"$PCAS02,1000*2E\r\n", "$PCAS02,500*1A\r\n", "$PCAS02,250*18\r\n", "$PCAS02,200*1D\r\n", "$PCAS02,100*1E\r\n"}; /**< NMEA command strings to set update rate for PCAS modules. */
 
-/**
- * @brief Satellite Constellation Canvas Definition
- */
-static const uint8_t canvasOffset = 15;          					    /**< Offset from the edge to start drawing the satellite constellation canvas */
-static const uint8_t canvasSize = 180;							    /**< Total size (width and height) of the constellation canvas */
-static const uint8_t canvasCenter_X = canvasSize / 2;				/**< X coordinate of the canvas center */
-static const uint8_t canvasCenter_Y = canvasSize / 2;				/**< Y coordinate of the canvas center */
-static const uint8_t canvasRadius = canvasCenter_X - canvasOffset;	/**< Radius of the drawable area for the constellation */
-
-
 /**
  * @class Gps
  * @brief GPS management class using NeoGPS library.
@@ -63,6 +54,7 @@ class Gps
     public:
         Gps();
         void init();
+        void startIngest();
         void update();
         void setLocalTime(NeoGPS::time_t gpsTime, const char* tz);
         void simFakeGPS(const TrackVector& trackData, uint16_t speed, uint16_t refresh);
@@ -76,43 +68,11 @@ class Gps
         bool hasLocationChange();
         bool isDOPChanged();
 
-        /**
-        * @struct GPSDATA
-        * @brief Holds parsed GPS data for easy access.
-        */
-        struct GPSDATA
-        {
-            uint8_t satellites;   /**< Number of satellites used for fix. */
-            uint8_t fixMode;      /**< GPS fix mode. */
-            int16_t altitude;     /**< Altitude in meters. */
-            uint16_t speed;       /**< Speed in km/h or knots. */
-            float latitude;       /**< Latitude in decimal degrees. */
-            float longitude;      /**< Longitude in decimal degrees. */
-            uint16_t heading;     /**< Heading in degrees. */
-            float hdop;           /**< Horizontal dilution of precision. */
-            float pdop;           /**< Position dilution of precision. */
-            float vdop;           /**< Vertical dilution of precision. */
-            uint8_t satInView;    /**< Number of satellites in view. */
-            char sunriseHour[6];  /**< Sunrise time as string (HH:MM). */
-            char sunsetHour[6];   /**< Sunset time as string (HH:MM). */
-            int UTC;              /**< UTC offset. */
-        } gpsData;
+        typedef GpsData GPSDATA;            /**< Parsed GPS data (gpsFix.hpp) */
+        GPSDATA gpsData;
 
-        /**
-        * @struct SV
-        * @brief Holds information about a tracked satellite.
-        */
-        struct SV
-        {
-            bool active;          /**< True if the satellite is active. */
-            uint8_t satNum;       /**< Satellite number. */
-            uint8_t elev;         /**< Elevation in degrees. */
-            uint16_t azim;        /**< Azimuth in degrees. */
-            uint8_t snr;          /**< Signal-to-noise ratio. */
-            uint16_t posX;        /**< X position for display/map. */
-            uint16_t posY;        /**< Y position for display/map. */
-            char talker_id[3];    /**< NMEA talker ID. */
-        } satTracker[MAX_SATELLITES];
+        typedef GpsSatellite SV;            /**< Tracked satellite (gpsFix.hpp) */
+        SV satTracker[MAX_SATELLITES];
 
     private:
         uint16_t previousSpeed;      /**< Previous speed value for change detection. */
@@ -0,0 +1,82 @@
+/**
+ * @file gpsFix.cpp
+ * @author Jordi Gauchía (jgauchia@jgauchia.com)
+ * @brief  GPS data and satellite tracker filled from a NeoGPS fix
+ * @version 0.2.5
+ * @date 2026-04
+ */
+
+#include "gpsFix.hpp"
+#include "gpsMath.hpp"
+#include <algorithm>
+#include <cstring>
+
+/**
+ * @brief Update the GPS data and the satellite tracker with a parsed fix.
+ *
+ * @details Only the fields valid in the fix are updated, the others keep their last value.
+ * 			The satellites in view are placed on the constellation canvas.
+ *
+ * @param fix Parsed fix
+ * @param parser NMEA parser, holds the satellites in view
+ * @param data GPS data
+ * @param sats Satellite tracker, MAX_SATELLITES entries
+ */
+void fillGpsData(const gps_fix &fix, const NMEAGPS &parser, GpsData &data, GpsSatellite *sats)
+{
+    // Satellite Count
+    data.satellites = fix.satellites;
+
+    // Fix Mode
+    data.fixMode = fix.status;
+
+    // Altitude
+    if (fix.valid.altitude)
+        data.altitude = fix.alt.whole;
+
+    // Speed
+    if (fix.valid.speed)
+        data.speed = (uint16_t)fix.speed_kph();
+
+    // Latitude and Longitude
+    if (fix.valid.location)
+    {
+        data.latitude = fix.latitude();
+        data.longitude = fix.longitude();
+    }
+
+    // Heading
+    if (fix.valid.heading)
+        data.heading = (uint16_t)fix.heading();
+
+    // HDOP , PDOP , VDOP
+    if (fix.valid.hdop)
+        data.hdop = (float)fix.hdop / 1000;
+    if (fix.valid.pdop)
+        data.pdop = (float)fix.pdop / 1000;
+    if (fix.valid.vdop)
+        data.vdop = (float)fix.vdop / 1000;
+
+    // // Satellite info, no more than the tracker and the parser hold
+    data.satInView = (uint8_t)std::min<uint16_t>(parser.sat_count, std::min(MAX_SATELLITES, NMEAGPS_MAX_SATELLITES));
+    for (uint8_t i = 0; i < data.satInView; i++)
+    {
+        sats[i].satNum = (uint8_t)parser.satellites[i].id;
+        sats[i].elev = (uint8_t)parser.satellites[i].elevation;
+        sats[i].azim = (uint16_t)parser.satellites[i].azimuth;
+        sats[i].snr = (uint8_t)parser.satellites[i].snr;
+        sats[i].active = parser.satellites[i].tracked;
+        strncpy(sats[i].talker_id, parser.satellites[i].talker_id, 3);
+
+        // Clamp elevation between 0 and 90 degrees
+        int8_t clampedElev = std::max((int8_t)0, std::min((int8_t)90, (int8_t)sats[i].elev));
+        int H = canvasRadius * (90 - clampedElev) / 90;
+
+        float azimRad = DEG2RAD((float)sats[i].azim);
+        float sinAzim = lutInit ? sinLUT(azimRad) : sinf(azimRad);
+        float cosAzim = lutInit ? cosLUT(azimRad) : cosf(azimRad);
+
+        sats[i].posX = canvasCenter_X + H * sinAzim;
+        sats[i].posY = canvasCenter_Y - H * cosAzim;
+    }
+}
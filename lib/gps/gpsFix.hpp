@@ -0,0 +1,67 @@
+/**
+ * @file gpsFix.hpp
+ * @author Jordi Gauchía (jgauchia@jgauchia.com)
+ * @brief  GPS data and satellite tracker filled from a NeoGPS fix
+ * @version 0.2.5
+ * @date 2026-04
+ *
+ * Platform independent (NeoGPS only), also built by tools/nmea_replay, so recorded NMEA
+ * gives the same GPS data and satellite sequences on a PC as on the device.
+ */
+
+#pragma once
+
+#include <NMEAGPS.h>
+#include <cstdint>
+
+#define MAX_SATELLITES 120		   /**< Maximum number of satellites supported. */
+#define MAX_SATELLLITES_IN_VIEW 32 /**< Maximum number of satellites in view. */
+
+/**
+ * @brief Satellite Constellation Canvas Definition
+ */
+static const uint8_t canvasOffset = 15;          					    /**< Offset from the edge to start drawing the satellite constellation canvas */
+static const uint8_t canvasSize = 180;							    /**< Total size (width and height) of the constellation canvas */
+static const uint8_t canvasCenter_X = canvasSize / 2;				/**< X coordinate of the canvas center */
+static const uint8_t canvasCenter_Y = canvasSize / 2;				/**< Y coordinate of the canvas center */
+static const uint8_t canvasRadius = canvasCenter_X - canvasOffset;	/**< Radius of the drawable area for the constellation */
+
+/**
+ * @struct GpsData
+ * @brief Holds parsed GPS data for easy access.
+ */
+struct GpsData
+{
+    uint8_t satellites;   /**< Number of satellites used for fix. */
+    uint8_t fixMode;      /**< GPS fix mode. */
+    int16_t altitude;     /**< Altitude in meters. */
+    uint16_t speed;       /**< Speed in km/h or knots. */
+    float latitude;       /**< Latitude in decimal degrees. */
+    float longitude;      /**< Longitude in decimal degrees. */
+    uint16_t heading;     /**< Heading in degrees. */
+    float hdop;           /**< Horizontal dilution of precision. */
+    float pdop;           /**< Position dilution of precision. */
+    float vdop;           /**< Vertical dilution of precision. */
+    uint8_t satInView;    /**< Number of satellites in view. */
+    char sunriseHour[6];  /**< Sunrise time as string (HH:MM). */
+    char sunsetHour[6];   /**< Sunset time as string (HH:MM). */
+    int UTC;              /**< UTC offset. */
+};
+
+/**
+ * @struct GpsSatellite
+ * @brief Holds information about a tracked satellite.
+ */
+struct GpsSatellite
+{
+    bool active;          /**< True if the satellite is active. */
+    uint8_t satNum;       /**< Satellite number. */
+    uint8_t elev;         /**< Elevation in degrees. */
+    uint16_t azim;        /**< Azimuth in degrees. */
+    uint8_t snr;          /**< Signal-to-noise ratio. */
+    uint16_t posX;        /**< X position for display/map. */
+    uint16_t posY;        /**< Y position for display/map. */
+    char talker_id[3];    /**< NMEA talker ID. */
+};
+
+void fillGpsData(const gps_fix &fix, const NMEAGPS &parser, GpsData &data, GpsSatellite *sats);
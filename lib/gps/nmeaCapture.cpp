@@ -0,0 +1,252 @@
+/**
+ * @file nmeaCapture.cpp
+ * @author Jordi Gauchía (jgauchia@jgauchia.com)
+ * @brief  NMEA capture - timestamped raw GPS byte stream logging to /sdcard/NMEA
+ * @version 0.2.5
+ * @date 2026-04
+ */
+
+#include "nmeaCapture.hpp"
+#include "esp_heap_caps.h"
+#include "esp_log.h"
+#include <cstring>
+#include <time.h>
+
+extern Storage storage;
+
+NmeaCapture nmeaCapture;
+
+static const char* TAG = "NmeaCapture";
+
+constexpr char NmeaCapture::MAGIC[];
+
+/**
+ * @brief NmeaCapture constructor
+ */
+NmeaCapture::NmeaCapture() : bytesCaptured(0), bytesWritten(0), dropped(0), ring(nullptr), head(0), tail(0),
+                             file(nullptr), fileName{}, writerHandle(nullptr), writerDone(nullptr), addMutex(nullptr), capturing(false),
+                             stopRequest(false)
+{
+}
+
+/**
+ * @brief Build the capture file path
+ *
+ * @details Uses the local date and time once the clock was set from the GPS
+ *          (NMEA_YYYYMMDD_HHMMSS.nmc), or the first free NMEA_nnn.nmc otherwise.
+ */
+void NmeaCapture::makeFileName()
+{
+    time_t now = time(nullptr);
+    struct tm local;
+    localtime_r(&now, &local);
+
+    if (local.tm_year + 1900 >= 2024)
+    {
+        snprintf(fileName, sizeof(fileName), "%s/NMEA_%04d%02d%02d_%02d%02d%02d.nmc", nmeaFolder,
+                 local.tm_year + 1900, local.tm_mon + 1, local.tm_mday, local.tm_hour, local.tm_min, local.tm_sec);
+        return;
+    }
+
+    for (uint16_t i = 1; i < 1000; i++)
+    {
+        snprintf(fileName, sizeof(fileName), "%s/NMEA_%03u.nmc", nmeaFolder, i);
+        if (!storage.exists(fileName))
+            return;
+    }
+}
+
+/**
+ * @brief Start capturing into a new file
+ *
+ * @return true if capturing
+ */
+bool NmeaCapture::start()
+{
+    if (capturing || writerHandle)
+        return capturing;
+
+    if (!storage.getSdLoaded())
+        return false;
+
+    if (!ring)
+        ring = (uint8_t *)heap_caps_malloc(RING_SIZE, MALLOC_CAP_SPIRAM);
+    if (!writerDone)
+        writerDone = xSemaphoreCreateBinary();
+    if (!addMutex)
+        addMutex = xSemaphoreCreateMutex();
+    if (!ring || !writerDone || !addMutex)
+    {
+        ESP_LOGE(TAG, "Not enough memory for NMEA capture");
+        return false;
+    }
+
+    if (!storage.exists(nmeaFolder))
+        storage.mkdir(nmeaFolder);
+    makeFileName();
+    file = storage.open(fileName, "w");
+    if (!file || storage.write(file, (const uint8_t *)MAGIC, 8) != 8)
+    {
+        ESP_LOGE(TAG, "Can't create %s", fileName);
+        if (file)
+            storage.close(file);
+        file = nullptr;
+        return false;
+    }
+
+    head = 0;
+    tail = 0;
+    bytesCaptured = 0;
+    bytesWritten = 8;
+    dropped = 0;
+    stopRequest = false;
+
+    if (xTaskCreatePinnedToCore(writerTask, "NmeaWriter", 3072, this, 1, &writerHandle, tskNO_AFFINITY) != pdPASS)
+    {
+        writerHandle = nullptr;
+        storage.close(file);
+        storage.remove(fileName);
+        file = nullptr;
+        return false;
+    }
+
+    capturing = true;
+    ESP_LOGI(TAG, "Capturing %s", fileName);
+    return true;
+}
+
+/**
+ * @brief Stop capturing, write the queued bytes and close the file
+ *
+ * @details Waits for a burst being queued by add(), the writer task closes the file after
+ *          flushing it.
+ */
+void NmeaCapture::stop()
+{
+    if (!writerHandle)
+        return;
+
+    xSemaphoreTake(addMutex, portMAX_DELAY);
+    capturing = false;
+    xSemaphoreGive(addMutex);
+    stopRequest = true;
+    if (xSemaphoreTake(writerDone, pdMS_TO_TICKS(5000)) != pdTRUE)
+        ESP_LOGE(TAG, "NMEA writer did not finish");
+}
+
+/**
+ * @brief Check if the GPS stream is being captured
+ *
+ * @return true if capturing
+ */
+bool NmeaCapture::isCapturing() const
+{
+    return capturing;
+}
+
+/**
+ * @brief Queue a received burst. Called from the UART receive callback, never blocks.
+ *
+ * @details A burst received while stop() holds addMutex is not captured.
+ *
+ * @param data Received bytes
+ * @param len Bytes
+ * @param timeMs millis() of the reception
+ */
+void NmeaCapture::add(const uint8_t *data, size_t len, uint32_t timeMs)
+{
+    if (!capturing || len == 0 || len > UINT16_MAX)
+        return;
+    if (xSemaphoreTake(addMutex, 0) != pdTRUE)
+        return;
+    if (!capturing)
+    {
+        xSemaphoreGive(addMutex);
+        return;
+    }
+
+    const uint32_t start = head.load(std::memory_order_relaxed);
+    if (RING_SIZE - (start - tail.load(std::memory_order_acquire)) < RECORD_HEADER + len)
+    {
+        dropped++;
+        xSemaphoreGive(addMutex);
+        return;
+    }
+
+    uint8_t header[RECORD_HEADER];
+    memcpy(header, &timeMs, 4);
+    const uint16_t length = (uint16_t)len;
+    memcpy(header + 4, &length, 2);
+
+    uint32_t pos = start;
+    for (size_t i = 0; i < RECORD_HEADER; i++)
+        ring[pos++ & (RING_SIZE - 1)] = header[i];
+    for (size_t i = 0; i < len; i++)
+        ring[pos++ & (RING_SIZE - 1)] = data[i];
+
+    head.store(pos, std::memory_order_release);
+    bytesCaptured += len;
+    xSemaphoreGive(addMutex);
+}
+
+/**
+ * @brief Get the path of the current (or last) capture file
+ *
+ * @return Capture file path
+ */
+const char *NmeaCapture::getFileName() const
+{
+    return fileName;
+}
+
+/**
+ * @brief Append the queued records to the file. Runs on the writer task.
+ */
+void NmeaCapture::flush()
+{
+    const uint32_t end = head.load(std::memory_order_acquire);
+    const uint32_t start = tail.load(std::memory_order_relaxed);
+    if (end == start)
+        return;
+
+    const uint32_t pos = start & (RING_SIZE - 1);
+    const size_t len = end - start;
+    const size_t first = len < RING_SIZE - pos ? len : RING_SIZE - pos;
+    size_t written = storage.write(file, ring + pos, first);
+    if (written == first && len > first)
+        written += storage.write(file, ring, len - first);
+    storage.sync(file);
+
+    if (written != len)
+        ESP_LOGE(TAG, "NMEA capture write failed");
+    bytesWritten += written;
+    tail.store(end, std::memory_order_release);
+}
+
+/**
+ * @brief NMEA capture writer task
+ *
+ * @details Appends the ring to the file every FLUSH_MS. On stop it writes the rest and
+ *          closes the file.
+ */
+void NmeaCapture::writerTask(void *pvParameters)
+{
+    NmeaCapture *instance = (NmeaCapture *)pvParameters;
+
+    while (!instance->stopRequest)
+    {
+        vTaskDelay(pdMS_TO_TICKS(FLUSH_MS));
+        instance->flush();
+    }
+
+    instance->flush();
+    storage.close(instance->file);
+    instance->file = nullptr;
+
+    ESP_LOGI(TAG, "Capture %s closed, %lu bytes, %lu bursts dropped", instance->fileName,
+             (unsigned long)instance->bytesCaptured, (unsigned long)instance->dropped);
+
+    instance->writerHandle = nullptr;
+    xSemaphoreGive(instance->writerDone);
+    vTaskDelete(NULL);
+}
@@ -0,0 +1,74 @@
+/**
+ * @file nmeaCapture.hpp
+ * @author Jordi Gauchía (jgauchia@jgauchia.com)
+ * @brief  NMEA capture - timestamped raw GPS byte stream logging to /sdcard/NMEA
+ * @version 0.2.5
+ * @date 2026-04
+ *
+ * Capture file (.nmc), little endian, replayed on a PC by tools/nmea_replay:
+ *
+ *   "NMEACAP1"                          8 bytes
+ *   records until the end of the file:
+ *     uint32 time                       millis() when the bytes were received
+ *     uint16 length                     bytes in the record
+ *     uint8  bytes[length]              raw bytes of gpsPort, as received
+ */
+
+#pragma once
+
+#include <atomic>
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+#include "freertos/task.h"
+#include "storage.hpp"
+
+static const char* nmeaFolder = "/sdcard/NMEA";    /**< Path to the NMEA capture folder on the SD card. */
+
+/**
+ * @class NmeaCapture
+ * @brief Records the raw GPS byte stream into a capture file
+ *
+ * @details The UART receive callback queues each received burst into a PSRAM ring without
+ *          blocking. A low priority writer task appends the ring to the capture file once
+ *          per second. If the card is too slow the bursts that do not fit are dropped and
+ *          counted, the GPS is never slowed down. stop() waits for a burst being queued, so
+ *          the writer flushes it before closing the file and no burst is queued after.
+ */
+class NmeaCapture
+{
+    public:
+        static constexpr char MAGIC[] = "NMEACAP1";         /**< File header */
+        static constexpr size_t RECORD_HEADER = 6;          /**< Time and length of a record */
+
+        NmeaCapture();
+        bool start();
+        void stop();
+        bool isCapturing() const;
+        void add(const uint8_t *data, size_t len, uint32_t timeMs);
+        const char *getFileName() const;
+
+        uint32_t bytesCaptured;     /**< GPS bytes queued */
+        uint32_t bytesWritten;      /**< Bytes written to the card, headers included */
+        uint32_t dropped;           /**< Bursts dropped on a full ring */
+
+    private:
+        static constexpr uint32_t RING_SIZE = 32768;        /**< Byte ring in PSRAM, power of two */
+        static constexpr uint32_t FLUSH_MS = 1000;          /**< Writer period */
+
+        uint8_t *ring;                   /**< Ring storage */
+        std::atomic<uint32_t> head;      /**< Next byte to queue (UART callback) */
+        std::atomic<uint32_t> tail;      /**< Next byte to write (writer task) */
+        FILE *file;                      /**< Open capture file */
+        char fileName[64];               /**< Capture file path */
+        TaskHandle_t writerHandle;       /**< Writer task */
+        SemaphoreHandle_t writerDone;    /**< Given by the writer when the file is closed */
+        SemaphoreHandle_t addMutex;      /**< Held by add() while it queues, and by stop() */
+        volatile bool capturing;         /**< Bytes are being queued */
+        volatile bool stopRequest;       /**< Writer must close the file */
+
+        void makeFileName();
+        void flush();
+        static void writerTask(void *pvParameters);
+};
+
+extern NmeaCapture nmeaCapture;
@@ -0,0 +1,102 @@
+/**
+ * @file nmeaRing.cpp
+ * @author Jordi Gauchía (jgauchia@jgauchia.com)
+ * @brief  Sentence framed ring buffer between the GPS UART and the GPS task
+ * @version 0.2.5
+ * @date 2026-04
+ */
+
+#include "nmeaRing.hpp"
+#include <algorithm>
+#include <cstring>
+
+NmeaRing::NmeaRing() : sentences(0), dropped(0), head(0), discard(false), lineEnd(0), tail(0) {}
+
+/**
+ * @brief Add received bytes, called by the writer
+ *
+ * @param data Received bytes
+ * @param len Bytes
+ * @return Sentences completed by these bytes
+ */
+size_t NmeaRing::write(const uint8_t *data, size_t len)
+{
+    size_t completed = 0;
+    uint32_t end = lineEnd.load(std::memory_order_relaxed);
+    for (size_t i = 0; i < len; i++)
+    {
+        const uint8_t c = data[i];
+        if (discard)
+        {
+            if (c == '\n')
+                discard = false;
+            continue;
+        }
+
+        if (head - tail.load(std::memory_order_acquire) >= SIZE)
+        {
+            // Full: forget the partial sentence and skip the rest of it
+            head = end;
+            discard = c != '\n';
+            dropped++;
+            continue;
+        }
+
+        buf[head & (SIZE - 1)] = c;
+        head++;
+        if (c == '\n')
+        {
+            end = head;
+            completed++;
+        }
+    }
+
+    if (completed != 0)
+    {
+        sentences += completed;
+        lineEnd.store(end, std::memory_order_release);
+    }
+    return completed;
+}
+
+/**
+ * @brief Take complete sentences, called by the reader
+ *
+ * @param out Output bytes
+ * @param max Output size
+ * @return Bytes read, 0 if there is no complete sentence
+ */
+size_t NmeaRing::read(uint8_t *out, size_t max)
+{
+    const uint32_t end = lineEnd.load(std::memory_order_acquire);
+    const uint32_t start = tail.load(std::memory_order_relaxed);
+    const size_t n = std::min<size_t>(max, end - start);
+    if (n == 0)
+        return 0;
+
+    const uint32_t pos = start & (SIZE - 1);
+    const size_t first = std::min<size_t>(n, SIZE - pos);
+    memcpy(out, buf + pos, first);
+    memcpy(out + first, buf, n - first);
+    tail.store(start + (uint32_t)n, std::memory_order_release);
+    return n;
+}
+
+/**
+ * @brief Bytes of complete sentences not read yet
+ */
+size_t NmeaRing::pending() const
+{
+    return lineEnd.load(std::memory_order_acquire) - tail.load(std::memory_order_acquire);
+}
+
+/**
+ * @brief Empty the ring, only with the writer stopped
+ */
+void NmeaRing::clear()
+{
+    head = 0;
+    discard = false;
+    lineEnd.store(0);
+    tail.store(0);
+}
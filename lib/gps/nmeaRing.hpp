@@ -0,0 +1,49 @@
+/**
+ * @file nmeaRing.hpp
+ * @author Jordi Gauchía (jgauchia@jgauchia.com)
+ * @brief  Sentence framed ring buffer between the GPS UART and the GPS task
+ * @version 0.2.5
+ * @date 2026-04
+ *
+ * Platform independent, also built by tools/nmea_ingest.
+ *
+ * The UART receive callback writes the bytes of the GPS port into the ring as they arrive
+ * (one writer) and the GPS task reads them (one reader). The reader only sees complete
+ * sentences: bytes after the last '\n' written stay hidden until their sentence ends, so
+ * the GPS task is woken once per burst of complete sentences instead of polling the port
+ * every tick. When the ring is full the sentence being written is dropped whole, up to its
+ * '\n', so the parser never gets two sentences glued together.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * @class NmeaRing
+ * @brief Single writer, single reader ring of complete NMEA sentences
+ */
+class NmeaRing
+{
+public:
+    static constexpr uint32_t SIZE = 2048;     /**< Ring size (bytes), power of two */
+
+    NmeaRing();
+
+    size_t write(const uint8_t *data, size_t len);
+    size_t read(uint8_t *out, size_t max);
+    size_t pending() const;
+    void clear();
+
+    uint32_t sentences;     /**< Sentences written (writer side) */
+    uint32_t dropped;       /**< Sentences dropped on a full ring (writer side) */
+
+private:
+    uint8_t buf[SIZE];
+    uint32_t head;                      /**< Next byte to write (writer only) */
+    bool discard;                       /**< Dropping the rest of a sentence (writer only) */
+    std::atomic<uint32_t> lineEnd;      /**< End of the last complete sentence */
+    std::atomic<uint32_t> tail;         /**< Next byte to read */
+};
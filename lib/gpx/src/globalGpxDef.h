@@ -8,6 +8,7 @@
 
 #pragma once
 
+#include <stddef.h>
 #include <stdint.h>
 #include <vector>
 #include "PsramAllocator.hpp"
@@ -54,9 +55,66 @@ struct TrackSegment
 };
 
 /**
- * @brief Track Vector Type using PSRAM Allocator
+ * @brief Track column in PSRAM
  */
-typedef std::vector<wayPoint, PsramAllocator<wayPoint>> TrackVector;
+typedef std::vector<float, PsramAllocator<float>> TrackColumn;
+
+/**
+ * @brief Track points stored as one PSRAM column per field (structure of arrays)
+ *
+ * @details 16 bytes per point instead of a full wayPoint, which stays for waypoints only.
+ *          Searches over the track read just the lat/lon columns.
+ */
+struct TrackVector
+{
+    TrackColumn lat;        /**< Latitude (degrees). */
+    TrackColumn lon;        /**< Longitude (degrees). */
+    TrackColumn ele;        /**< Elevation (meters), 0 if the GPX has none. */
+    TrackColumn accumDist;  /**< Accumulated distance from start (meters). */
+
+    size_t size() const { return lat.size(); }
+    bool empty() const { return lat.empty(); }
+
+    void push_back(float pointLat, float pointLon, float pointEle)
+    {
+        lat.push_back(pointLat);
+        lon.push_back(pointLon);
+        ele.push_back(pointEle);
+        accumDist.push_back(0.0f);
+    }
+
+    void reserve(size_t n)
+    {
+        lat.reserve(n);
+        lon.reserve(n);
+        ele.reserve(n);
+        accumDist.reserve(n);
+    }
+
+    void resize(size_t n)
+    {
+        lat.resize(n);
+        lon.resize(n);
+        ele.resize(n);
+        accumDist.resize(n);
+    }
+
+    void clear()
+    {
+        lat.clear();
+        lon.clear();
+        ele.clear();
+        accumDist.clear();
+    }
+
+    void shrink_to_fit()
+    {
+        lat.shrink_to_fit();
+        lon.shrink_to_fit();
+        ele.shrink_to_fit();
+        accumDist.shrink_to_fit();
+    }
+};
 
 /**
  * @brief Waypoint action enum
@@ -0,0 +1,424 @@
+/**
+ * @file gpxIndex.cpp
+ * @author Jordi Gauchía (jgauchia@jgauchia.com)
+ * @brief  GPX folder index - per file metadata for the GPX list screens
+ * @version 0.2.5
+ * @date 2026-04
+ */
+
+#include "gpxIndex.hpp"
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <dirent.h>
+#include <sys/stat.h>
+#include "esp_log.h"
+#include "gpsMath.hpp"
+#include "gpxTokenizer.hpp"
+
+static const char* TAG = "GpxIndex";
+
+namespace
+{
+    /**
+     * @brief Index file header
+     */
+    struct IndexHeader
+    {
+        char magic[4];         /**< "GIX1" */
+        uint16_t version;      /**< GpxIndex::VERSION */
+        uint16_t headerSize;   /**< sizeof(IndexHeader) */
+        uint32_t files;        /**< File entries */
+        uint32_t payloadSize;  /**< Bytes after the header */
+        uint32_t checksum;     /**< FNV-1a of the payload */
+    };
+    static_assert(sizeof(IndexHeader) == 20, "GPX index header layout");
+
+    static const char INDEX_MAGIC[4] = {'G', 'I', 'X', '1'};
+    static constexpr uint32_t FNV_OFFSET = 2166136261u;
+    static constexpr uint32_t FNV_PRIME = 16777619u;
+
+    static uint32_t fnv1a(const uint8_t *data, size_t len)
+    {
+        uint32_t hash = FNV_OFFSET;
+        for (size_t i = 0; i < len; i++)
+            hash = (hash ^ data[i]) * FNV_PRIME;
+        return hash;
+    }
+
+    /**
+     * @brief Payload writer
+     */
+    struct Writer
+    {
+        std::vector<uint8_t> buf;
+
+        void put(const void *data, size_t len)
+        {
+            const uint8_t *src = (const uint8_t *)data;
+            buf.insert(buf.end(), src, src + len);
+        }
+
+        void str(const std::string &s)
+        {
+            const uint8_t len = (uint8_t)std::min<size_t>(s.size(), 255);
+            put(&len, 1);
+            put(s.data(), len);
+        }
+
+        void names(const std::vector<std::string> &list)
+        {
+            const uint16_t count = (uint16_t)std::min<size_t>(list.size(), 65535);
+            put(&count, sizeof(count));
+            for (uint16_t i = 0; i < count; i++)
+                str(list[i]);
+        }
+    };
+
+    /**
+     * @brief Bounds checked payload reader
+     */
+    struct Reader
+    {
+        const uint8_t *pos;
+        const uint8_t *end;
+
+        bool get(void *data, size_t len)
+        {
+            if ((size_t)(end - pos) < len)
+                return false;
+            memcpy(data, pos, len);
+            pos += len;
+            return true;
+        }
+
+        bool str(std::string &s)
+        {
+            uint8_t len;
+            if (!get(&len, 1) || (size_t)(end - pos) < len)
+                return false;
+            s.assign((const char *)pos, len);
+            pos += len;
+            return true;
+        }
+
+        bool names(std::vector<std::string> &list)
+        {
+            uint16_t count;
+            if (!get(&count, sizeof(count)))
+                return false;
+            list.resize(count);
+            for (std::string &s : list)
+            {
+                if (!str(s))
+                    return false;
+            }
+            return true;
+        }
+    };
+
+    static bool isGpxFile(const char *name)
+    {
+        const size_t len = strlen(name);
+        return len >= 4 && strcmp(name + len - 4, ".gpx") == 0;
+    }
+}
+
+/**
+ * @brief Constructs the index of a folder, call update() to fill it
+ *
+ * @param folder GPX folder path
+ */
+GpxIndex::GpxIndex(const char *folder) : scanned(0), reused(0), removed(0), folder(folder),
+                                         indexPath(std::string(folder) + "/" + INDEX_FILE) {}
+
+/**
+ * @brief Bring the index up to date with the folder contents
+ *
+ * @details Files whose name, size and modification time match the stored index are not
+ *          opened. New and changed files are parsed, entries of deleted files are dropped,
+ *          and the index file is rewritten only if something changed.
+ *
+ * @return true if the folder could be read
+ */
+bool GpxIndex::update()
+{
+    std::vector<GpxFileInfo> stored;
+    const bool loaded = load(stored);
+    files.clear();
+    scanned = 0;
+    reused = 0;
+    removed = 0;
+
+    DIR *dir = opendir(folder.c_str());
+    if (!dir)
+    {
+        ESP_LOGE(TAG, "Failed to open folder: %s", folder.c_str());
+        return false;
+    }
+
+    uint32_t changed = 0;
+    struct dirent *entry;
+    while ((entry = readdir(dir)) != nullptr)
+    {
+        if (entry->d_type != DT_REG || !isGpxFile(entry->d_name))
+            continue;
+        const std::string path = folder + "/" + entry->d_name;
+        struct stat st;
+        if (stat(path.c_str(), &st) != 0)
+            continue;
+
+        auto it = std::lower_bound(stored.begin(), stored.end(), entry->d_name,
+                                   [](const GpxFileInfo &info, const char *name) { return info.fileName < name; });
+        const bool known = it != stored.end() && it->fileName == entry->d_name;
+        if (known && it->size == (uint32_t)st.st_size && it->mtime == (int64_t)st.st_mtime)
+        {
+            files.push_back(*it);
+            reused++;
+            continue;
+        }
+        if (known)
+            changed++;
+
+        GpxFileInfo info;
+        if (!scanFile(path.c_str(), info))
+            continue;
+        info.fileName = entry->d_name;
+        info.size = (uint32_t)st.st_size;
+        info.mtime = (int64_t)st.st_mtime;
+        files.push_back(std::move(info));
+        scanned++;
+    }
+    closedir(dir);
+
+    std::sort(files.begin(), files.end(),
+              [](const GpxFileInfo &a, const GpxFileInfo &b) { return a.fileName < b.fileName; });
+    removed = stored.size() - reused - changed;
+    if (scanned > 0 || removed > 0 || !loaded)
+        save();
+    ESP_LOGI(TAG, "%s: %u files, %u parsed, %u removed", folder.c_str(), (unsigned)files.size(), (unsigned)scanned,
+             (unsigned)removed);
+    return true;
+}
+
+/**
+ * @brief Parse the metadata of one GPX file
+ *
+ * @details Names are the first <name> child of each <wpt> and <trk>, as the list screens
+ *          showed them before. The track length sums the distance between consecutive
+ *          <trkpt> of each <trkseg>.
+ *
+ * @param path GPX file path
+ * @param info Output metadata (file name, size and mtime are left to the caller)
+ * @return true if the file could be read
+ */
+bool GpxIndex::scanFile(const char *path, GpxFileInfo &info)
+{
+    GpxTokenizer tokenizer;
+    if (!tokenizer.open(path))
+        return false;
+
+    info.points = 0;
+    info.waypoints = 0;
+    info.minLat = 90.0f;
+    info.maxLat = -90.0f;
+    info.minLon = 180.0f;
+    info.maxLon = -180.0f;
+    info.length = 0.0f;
+    info.wptNames.clear();
+    info.trkNames.clear();
+
+    enum Owner { OWNER_NONE, OWNER_WPT, OWNER_TRK };
+    Owner owner = OWNER_NONE;
+    int depth = 0;
+    int ownerDepth = 0;
+    bool named = false;
+    bool inName = false;
+    bool hasPrev = false;
+    float prevLat = 0.0f;
+    float prevLon = 0.0f;
+
+    auto addName = [&](const char *text, size_t len)
+    {
+        (owner == OWNER_WPT ? info.wptNames : info.trkNames).emplace_back(text, len);
+        named = true;
+    };
+    auto addPoint = [&](float &lat, float &lon)
+    {
+        lat = lon = 0.0f;
+        if (!tokenizer.getAttrFloat("lat", lat) || !tokenizer.getAttrFloat("lon", lon))
+            return false;
+        info.minLat = std::min(info.minLat, lat);
+        info.maxLat = std::max(info.maxLat, lat);
+        info.minLon = std::min(info.minLon, lon);
+        info.maxLon = std::max(info.maxLon, lon);
+        return true;
+    };
+
+    GpxTokenizer::Token token;
+    while ((token = tokenizer.next()) != GpxTokenizer::TOKEN_EOF)
+    {
+        if (token == GpxTokenizer::TOKEN_OPEN)
+        {
+            const bool empty = tokenizer.isEmptyTag();
+            float lat, lon;
+            if (tokenizer.isTag("trkpt"))
+            {
+                if (addPoint(lat, lon))
+                {
+                    if (hasPrev)
+                        info.length += calcDist(prevLat, prevLon, lat, lon);
+                    prevLat = lat;
+                    prevLon = lon;
+                    hasPrev = true;
+                    info.points++;
+                }
+            }
+            else if (tokenizer.isTag("trkseg"))
+                hasPrev = false;
+            else if (tokenizer.isTag("wpt") || tokenizer.isTag("trk"))
+            {
+                const bool isWpt = tokenizer.isTag("wpt");
+                if (isWpt)
+                {
+                    addPoint(lat, lon);
+                    info.waypoints++;
+                }
+                if (!empty)
+                {
+                    owner = isWpt ? OWNER_WPT : OWNER_TRK;
+                    ownerDepth = depth;
+                    named = false;
+                }
+            }
+            else if (owner != OWNER_NONE && !named && depth == ownerDepth + 1 && tokenizer.isTag("name"))
+            {
+                if (empty)
+                    addName("", 0);
+                else
+                    inName = true;
+            }
+            if (!empty)
+                depth++;
+        }
+        else if (token == GpxTokenizer::TOKEN_TEXT && inName)
+        {
+            size_t len;
+            const char *text = tokenizer.getText(len);
+            addName(text, len);
+            inName = false;
+        }
+        else if (token == GpxTokenizer::TOKEN_CLOSE)
+        {
+            if (inName)
+            {
+                addName("", 0);
+                inName = false;
+            }
+            if (depth > 0)
+                depth--;
+            if (owner != OWNER_NONE && depth == ownerDepth)
+                owner = OWNER_NONE;
+        }
+    }
+    tokenizer.close();
+    return true;
+}
+
+/**
+ * @brief Read the stored index
+ *
+ * @param entries Output entries, sorted by file name
+ * @return true if a valid index was read
+ */
+bool GpxIndex::load(std::vector<GpxFileInfo> &entries)
+{
+    entries.clear();
+    FILE *file = fopen(indexPath.c_str(), "rb");
+    if (!file)
+        return false;
+
+    IndexHeader header;
+    std::vector<uint8_t> payload;
+    bool ok = fread(&header, 1, sizeof(header), file) == sizeof(header) &&
+              memcmp(header.magic, INDEX_MAGIC, 4) == 0 && header.version == VERSION &&
+              header.headerSize == sizeof(IndexHeader);
+    if (ok)
+    {
+        payload.resize(header.payloadSize);
+        ok = fread(payload.data(), 1, payload.size(), file) == payload.size() &&
+             fnv1a(payload.data(), payload.size()) == header.checksum;
+    }
+    fclose(file);
+
+    Reader reader = {payload.data(), payload.data() + payload.size()};
+    entries.resize(ok ? header.files : 0);
+    for (GpxFileInfo &info : entries)
+    {
+        ok = reader.str(info.fileName) && reader.get(&info.size, sizeof(info.size)) &&
+             reader.get(&info.mtime, sizeof(info.mtime)) && reader.get(&info.points, sizeof(info.points)) &&
+             reader.get(&info.waypoints, sizeof(info.waypoints)) && reader.get(&info.minLat, sizeof(float)) &&
+             reader.get(&info.maxLat, sizeof(float)) && reader.get(&info.minLon, sizeof(float)) &&
+             reader.get(&info.maxLon, sizeof(float)) && reader.get(&info.length, sizeof(float)) &&
+             reader.names(info.wptNames) && reader.names(info.trkNames);
+        if (!ok)
+            break;
+    }
+
+    if (!ok)
+    {
+        ESP_LOGW(TAG, "Rebuilding GPX index %s", indexPath.c_str());
+        entries.clear();
+    }
+    return ok;
+}
+
+/**
+ * @brief Write the index, to a temporary file renamed over the old one
+ */
+bool GpxIndex::save()
+{
+    Writer writer;
+    for (const GpxFileInfo &info : files)
+    {
+        writer.str(info.fileName);
+        writer.put(&info.size, sizeof(info.size));
+        writer.put(&info.mtime, sizeof(info.mtime));
+        writer.put(&info.points, sizeof(info.points));
+        writer.put(&info.waypoints, sizeof(info.waypoints));
+        writer.put(&info.minLat, sizeof(float));
+        writer.put(&info.maxLat, sizeof(float));
+        writer.put(&info.minLon, sizeof(float));
+        writer.put(&info.maxLon, sizeof(float));
+        writer.put(&info.length, sizeof(float));
+        writer.names(info.wptNames);
+        writer.names(info.trkNames);
+    }
+
+    IndexHeader header = {};
+    memcpy(header.magic, INDEX_MAGIC, 4);
+    header.version = VERSION;
+    header.headerSize = sizeof(IndexHeader);
+    header.files = (uint32_t)files.size();
+    header.payloadSize = (uint32_t)writer.buf.size();
+    header.checksum = fnv1a(writer.buf.data(), writer.buf.size());
+
+    const std::string tmpPath = indexPath + ".tmp";
+    FILE *file = fopen(tmpPath.c_str(), "wb");
+    if (!file)
+        return false;
+    bool ok = fwrite(&header, 1, sizeof(header), file) == sizeof(header) &&
+              fwrite(writer.buf.data(), 1, writer.buf.size(), file) == writer.buf.size();
+    ok = (fclose(file) == 0) && ok;
+    if (ok)
+    {
+        remove(indexPath.c_str());
+        ok = rename(tmpPath.c_str(), indexPath.c_str()) == 0;
+    }
+    if (!ok)
+    {
+        ESP_LOGE(TAG, "Failed to write GPX index %s", indexPath.c_str());
+        remove(tmpPath.c_str());
+    }
+    return ok;
+}
@@ -0,0 +1,72 @@
+/**
+ * @file gpxIndex.hpp
+ * @author Jordi Gauchía (jgauchia@jgauchia.com)
+ * @brief  GPX folder index - per file metadata for the GPX list screens
+ * @version 0.2.5
+ * @date 2026-04
+ *
+ * Platform independent, also built by tools/gpx_index.
+ *
+ * Each GPX folder keeps a small binary file (.gpxindex) with the metadata of its GPX
+ * files: waypoint and track names, point counts, bounding box and track length. Files
+ * are keyed by name, size and modification time, so opening a list only parses the
+ * GPX files added or changed since the last time.
+ *
+ * Index layout (little-endian):
+ *  - Header (20 bytes): magic "GIX1", version (u16), header size (u16), files (u32),
+ *    payload size (u32), FNV-1a of the payload (u32)
+ *  - Per file: name (u8 length + bytes), size (u32), mtime (i64), track points (u32),
+ *    waypoints (u32), min/max lat, min/max lon, track length (f32), waypoint names and
+ *    track names (u16 count, then u8 length + bytes each)
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/**
+ * @brief Metadata of one GPX file
+ */
+struct GpxFileInfo
+{
+    std::string fileName;                   /**< File name inside the folder */
+    uint32_t size;                          /**< File size */
+    int64_t mtime;                          /**< Modification time */
+    uint32_t points;                        /**< Track points */
+    uint32_t waypoints;                     /**< Waypoints */
+    float minLat, maxLat;                   /**< Bounding box of points and waypoints */
+    float minLon, maxLon;                   /**< Bounding box of points and waypoints */
+    float length;                           /**< Track length (m), sum over all segments */
+    std::vector<std::string> wptNames;      /**< <name> of each named waypoint */
+    std::vector<std::string> trkNames;      /**< <name> of each named track */
+};
+
+/**
+ * @class GpxIndex
+ * @brief Incrementally updated metadata index of a GPX folder
+ */
+class GpxIndex
+{
+public:
+    static constexpr uint16_t VERSION = 1;                  /**< Index layout version */
+    static constexpr const char *INDEX_FILE = ".gpxindex";  /**< Index file name inside the folder */
+
+    explicit GpxIndex(const char *folder);
+
+    bool update();
+    static bool scanFile(const char *path, GpxFileInfo &info);
+
+    std::vector<GpxFileInfo> files;    /**< GPX files, sorted by name */
+    uint32_t scanned;                  /**< Files parsed by the last update */
+    uint32_t reused;                   /**< Files taken from the index by the last update */
+    uint32_t removed;                  /**< Index entries of deleted files dropped by the last update */
+
+private:
+    std::string folder;                /**< Folder path */
+    std::string indexPath;             /**< Index file path */
+
+    bool load(std::vector<GpxFileInfo> &entries);
+    bool save();
+};
@@ -10,8 +10,10 @@
 #include <freertos/FreeRTOS.h>
 #include <freertos/task.h>
 #include "gpsMath.hpp"
+#include "gpxTokenizer.hpp"
+#include "trackCache.hpp"
+#include "turnScan.hpp"
 
-extern std::vector<TrackSegment> trackIndex;
 
 /**
  * @brief Helper function to format float values
@@ -36,83 +38,20 @@ GPXParser::GPXParser(const char* filePath) : filePath(filePath) {}
 GPXParser::GPXParser() : filePath("") {}
 GPXParser::~GPXParser() {}
 
-/**
- * @brief Retrieve tag elements value list from all GPX files in a folder.
- *
- * @param tag XML tag (e.g., "wpt").
- * @param element XML element (e.g., "name").
- * @param folderPath Folder path.
- * @return Map of filename to vector of values.
- */
-std::map<std::string, std::vector<std::string>> GPXParser::getTagElementList(const char* tag, const char* element, const std::string& folderPath)
-{
-    std::map<std::string, std::vector<std::string>> elementsByFile;
-    DIR* dir = opendir(folderPath.c_str());
-    if (!dir)
-    {
-        ESP_LOGE(TAGGPX, "Failed to open folder: %s", folderPath.c_str());
-        return elementsByFile;
-    }
-
-    struct dirent* entry;
-    while ((entry = readdir(dir)) != nullptr)
-    {
-        if (entry->d_type == DT_REG)
-        {
-            std::string fileName = entry->d_name;
-            if (fileName.size() >= 4 && fileName.substr(fileName.size() - 4) == ".gpx")
-            {
-                std::string filePath = folderPath + "/" + fileName;
-                std::vector<std::string> elementValue;
-
-                FILE* file = fopen(filePath.c_str(), "r");
-                if (file)
-                {
-                    char line[256];
-                    std::string startTag = "<" + std::string(tag);
-                    std::string searchElement = "<" + std::string(element) + ">";
-                    std::string endElement = "</" + std::string(element) + ">";
-                    bool inTargetTag = false;
-
-                    while (fgets(line, sizeof(line), file))
-                    {
-                        if (strstr(line, startTag.c_str()))
-                            inTargetTag = true;
-
-                        if (inTargetTag)
-                        {
-                            char* s = strstr(line, searchElement.c_str());
-                            if (s)
-                            {
-                                s += searchElement.length();
-                                char* e = strstr(s, endElement.c_str());
-                                if (e)
-                                {
-                                    elementValue.push_back(std::string(s, e - s));
-                                    inTargetTag = false; // Reset for next tag occurrence
-                                }
-                            }
-                        }
-                    }
-                    fclose(file);
-                }
-                elementsByFile[fileName] = elementValue;
-            }
-        }
-    }
-    closedir(dir);
-    return elementsByFile;
-}
-
 /**
  * @brief Delete a tag from the GPX file by name.
  *
+ * @details Waypoints of the file backed by the waypoint store are deleted from the store.
+ *
  * @param tag XML tag.
  * @param name Name to match.
  * @return true if successful.
  */
 bool GPXParser::deleteTagByName(const char* tag, const char* name)
 {
+    if (waypointStore.handles(filePath.c_str()) && strcmp(tag, gpxWaypointTag) == 0)
+        return waypointStore.remove(name);
+
     tinyxml2::XMLDocument doc;
     if (doc.LoadFile(filePath.c_str()) != tinyxml2::XML_SUCCESS)
     {
@@ -145,12 +84,19 @@ bool GPXParser::deleteTagByName(const char* tag, const char* name)
 /**
  * @brief Retrieve waypoint details for a given name.
  *
+ * @details Uses the waypoint store hash index when the file is backed by it.
+ *
  * @param name Waypoint name.
  * @return wayPoint structure.
  */
 wayPoint GPXParser::getWaypointInfo(const char* name)
 {
     wayPoint wp = {0};
+    if (waypointStore.handles(filePath.c_str()))
+    {
+        waypointStore.get(name, wp);
+        return wp;
+    }
     tinyxml2::XMLDocument doc;
     if (doc.LoadFile(filePath.c_str()) != tinyxml2::XML_SUCCESS) return wp;
     tinyxml2::XMLElement* root = doc.RootElement();
@@ -207,11 +153,16 @@ wayPoint GPXParser::getWaypointInfo(const char* name)
 /**
  * @brief Add a new waypoint to the GPX file
  *
+ * @details The file backed by the waypoint store gets a log record instead of a rewrite.
+ *
  * @param wp Waypoint structure.
  * @return true if successful.
  */
 bool GPXParser::addWaypoint(const wayPoint& wp)
 {
+    if (waypointStore.handles(filePath.c_str()))
+        return waypointStore.add(wp);
+
     time_t tUTCwpt = time(NULL);
     struct tm UTCwpt_tm;
     struct tm *tmUTCwpt = gmtime_r(&tUTCwpt, &UTCwpt_tm);
@@ -258,106 +209,95 @@ bool GPXParser::addWaypoint(const wayPoint& wp)
 }
 
 /**
-* @brief Load GPX track data using stream-based parsing.
+* @brief Load GPX track data using the streaming tokenizer, or its binary cache.
 *
 * @param trackData Vector to store points.
+* @param index Segment index of the track, rebuilt.
 * @return true if successful.
 */
-bool GPXParser::loadTrack(TrackVector& trackData)
+bool GPXParser::loadTrack(TrackVector& trackData, std::vector<TrackSegment>& index)
 {
-    FILE* file = fopen(filePath.c_str(), "r");
-    if (!file) 
+    if (TrackCache::load(filePath.c_str(), trackData, index))
+        return true;
+
+    GpxTokenizer tokenizer;
+    if (!tokenizer.open(filePath.c_str()))
         return false;
-    fseek(file, 0, SEEK_END);
-    long fileSize = ftell(file);
-    rewind(file);
-    size_t estimatedPoints = fileSize / 50;
+    size_t estimatedPoints = tokenizer.fileSize / 50;
     trackData.reserve(estimatedPoints);
-    trackIndex.clear();
-    char line[256];
-    while (fgets(line, sizeof(line), file))
+    index.clear();
+    GpxPoint gpxPoint;
+    while (tokenizer.nextPoint(gpxTrkptTag, gpxPoint))
+        trackData.push_back(gpxPoint.lat, gpxPoint.lon, gpxPoint.ele);
+    tokenizer.close();
+    trackData.shrink_to_fit();
+    if (!trackData.empty())
     {
-        if (strstr(line, "<trkpt"))
+        float totalDist = 0;
+        trackData.accumDist[0] = 0;
+        for (size_t i = 1; i < trackData.size(); ++i)
         {
-            wayPoint point = {0};
-            bool latFound = false, lonFound = false;
-            auto parseAttrs = [&](char* str) {
-                char* pLat = strstr(str, "lat=\"");
-                if (!pLat)
-                    pLat = strstr(str, "lat='");
-                if (pLat)
-                { 
-                    point.lat = strtof(pLat + 5, nullptr); 
-                    latFound = true; 
-                }
-                char* pLon = strstr(str, "lon=\"");
-                if (!pLon) 
-                    pLon = strstr(str, "lon='");
-                if (pLon) 
-                { 
-                    point.lon = strtof(pLon + 5, nullptr); 
-                    lonFound = true; 
-                }
-            };
-            parseAttrs(line);
-            while ((!latFound || !lonFound) && fgets(line, sizeof(line), file)) {
-                if (strstr(line, ">"))
-                    break;
-                parseAttrs(line);
-            }
-            if (latFound && lonFound) 
-                trackData.push_back(point);
+            float d = calcDist(trackData.lat[i-1], trackData.lon[i-1], trackData.lat[i], trackData.lon[i]);
+            totalDist += d;
+            trackData.accumDist[i] = totalDist;
         }
+        buildTrackIndex(trackData, index);
+        ESP_LOGI(TAGGPX, "Index built. Segments: %d, Total Dist: %.1f m", index.size(), totalDist);
+        TrackCache::save(filePath.c_str(), trackData, index);
     }
-    fclose(file);
-    if (!trackData.empty())
+    return true;
+}
+
+/**
+ * @brief Build the segment index used by the closest track point search
+ *
+ * @details Groups of SEGMENT_SIZE consecutive points with their bounding box, grown by
+ *          a small buffer.
+ *
+ * @param trackData Track points.
+ * @param index Output segment index.
+ */
+void GPXParser::buildTrackIndex(const TrackVector& trackData, std::vector<TrackSegment>& index)
+{
+    index.clear();
+    const int SEGMENT_SIZE = 100;
+    TrackSegment currentSeg;
+    currentSeg.startIdx = 0;
+    currentSeg.minLat = 90.0f; currentSeg.maxLat = -90.0f;
+    currentSeg.minLon = 180.0f; currentSeg.maxLon = -180.0f;
+    for (size_t i = 0; i < trackData.size(); ++i)
     {
-        float totalDist = 0;
-        trackData[0].accumDist = 0;
-        const int SEGMENT_SIZE = 100;
-        TrackSegment currentSeg;
-        currentSeg.startIdx = 0;
-        currentSeg.minLat = 90.0f; currentSeg.maxLat = -90.0f;
-        currentSeg.minLon = 180.0f; currentSeg.maxLon = -180.0f;
-        for (size_t i = 0; i < trackData.size(); ++i)
+        if (trackData.lat[i] < currentSeg.minLat) 
+            currentSeg.minLat = trackData.lat[i];
+        if (trackData.lat[i] > currentSeg.maxLat) 
+            currentSeg.maxLat = trackData.lat[i];
+        if (trackData.lon[i] < currentSeg.minLon) 
+            currentSeg.minLon = trackData.lon[i];
+        if (trackData.lon[i] > currentSeg.maxLon) 
+            currentSeg.maxLon = trackData.lon[i];
+        if ((i + 1) % SEGMENT_SIZE == 0 || i == trackData.size() - 1)
         {
-            if (i > 0)
-            {
-                float d = calcDist(trackData[i-1].lat, trackData[i-1].lon, trackData[i].lat, trackData[i].lon);
-                totalDist += d;
-                trackData[i].accumDist = totalDist;
-            }
-            if (trackData[i].lat < currentSeg.minLat) 
-                currentSeg.minLat = trackData[i].lat;
-            if (trackData[i].lat > currentSeg.maxLat) 
-                currentSeg.maxLat = trackData[i].lat;
-            if (trackData[i].lon < currentSeg.minLon) 
-                currentSeg.minLon = trackData[i].lon;
-            if (trackData[i].lon > currentSeg.maxLon) 
-                currentSeg.maxLon = trackData[i].lon;
-            if ((i + 1) % SEGMENT_SIZE == 0 || i == trackData.size() - 1)
+            currentSeg.endIdx = i;
+            const float BUFFER = 0.0005f; 
+            currentSeg.minLat -= BUFFER; currentSeg.maxLat += BUFFER;
+            currentSeg.minLon -= BUFFER; currentSeg.maxLon += BUFFER;
+            index.push_back(currentSeg);
+            if (i < trackData.size() - 1)
             {
-                currentSeg.endIdx = i;
-                const float BUFFER = 0.0005f; 
-                currentSeg.minLat -= BUFFER; currentSeg.maxLat += BUFFER;
-                currentSeg.minLon -= BUFFER; currentSeg.maxLon += BUFFER;
-                trackIndex.push_back(currentSeg);
-                if (i < trackData.size() - 1)
-                {
-                    currentSeg.startIdx = i + 1;
-                    currentSeg.minLat = 90.0f; currentSeg.maxLat = -90.0f;
-                    currentSeg.minLon = 180.0f; currentSeg.maxLon = -180.0f;
-                }
+                currentSeg.startIdx = i + 1;
+                currentSeg.minLat = 90.0f; currentSeg.maxLat = -90.0f;
+                currentSeg.minLon = 180.0f; currentSeg.maxLon = -180.0f;
             }
         }
-        ESP_LOGI(TAGGPX, "Index built. Segments: %d, Total Dist: %.1f m", trackIndex.size(), totalDist);
     }
-    return true;
 }
 
 /**
  * @brief Detects turn points using sliding window
  *
+ * @details Linear time, see TurnScan. Runs in the caller task, the track screen uses
+ *          the background TurnDetector instead.
+ *
  * @param thresholdDeg Min angle.
  * @param minDist Min distance.
  * @param sharpTurnDeg Sharp turn threshold.
@@ -369,37 +309,5 @@ std::vector<TurnPoint> GPXParser::getTurnPointsSlidingWindow(
     float thresholdDeg, float minDist, float sharpTurnDeg,
     int windowSize, const TrackVector& trackData)
 {
-    std::vector<TurnPoint> turnPoints;
-    if (trackData.size() < 2 * windowSize + 1) return turnPoints;
-    turnPoints.reserve(trackData.size() / 20);
-    for (size_t i = windowSize; i < trackData.size() - windowSize; ++i)
-    {
-        float distWindow = 0.0f;
-        bool skipWindow = false;
-        for (int j = int(i - windowSize); j < int(i + windowSize); ++j)
-        {
-            float d = calcDist(trackData[j].lat, trackData[j].lon, trackData[j + 1].lat, trackData[j + 1].lon);
-            if (d > 200.0f) 
-            { 
-                skipWindow = true; 
-                break; 
-            }
-            distWindow += d;
-        }
-        if (skipWindow) 
-            continue;
-        float brgStart = calcCourse(trackData[i - windowSize].lat, trackData[i - windowSize].lon, trackData[i].lat, trackData[i].lon);
-        float brgEnd   = calcCourse(trackData[i].lat, trackData[i].lon, trackData[i + windowSize].lat, trackData[i + windowSize].lon);
-        float diff = calcAngleDiff(brgEnd, brgStart);
-        if (std::fabs(diff) > sharpTurnDeg)
-        {
-            turnPoints.push_back({static_cast<int>(i), diff, trackData[i].accumDist});
-            continue;
-        }
-        if (distWindow < minDist) 
-            continue;
-        if (std::fabs(diff) > thresholdDeg) 
-            turnPoints.push_back({static_cast<int>(i), diff, trackData[i].accumDist});
-    }
-    return turnPoints;
+    return TurnScan::detect(trackData, {thresholdDeg, minDist, sharpTurnDeg, windowSize});
 }
\ No newline at end of file
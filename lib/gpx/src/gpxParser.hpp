@@ -19,11 +19,13 @@
 #include "tinyxml2.h"
 #include "globalGpxDef.h"
 #include "gpsMath.hpp"
+#include "waypointStore.hpp"
 
 static const char* TAGGPX = "GPXParser";
 
 static const char* gpxWaypointTag = "wpt";   /**< GPX waypoint tag. */
 static const char* gpxTrackTag    = "trk";   /**< GPX track tag. */
+static const char* gpxTrkptTag    = "trkpt"; /**< GPX track point tag. */
 static const char* gpxNameElem    = "name";  /**< GPX name element. */
 static const char* gpxLatElem     = "lat";   /**< GPX latitude attribute. */
 static const char* gpxLonElem     = "lon";   /**< GPX longitude attribute. */
@@ -55,11 +57,11 @@ class GPXParser
         template <typename T>
         bool insertTagAttrOrElem(const char* tag, const char* attribute, const char* element, const T& value);
 
-        static std::map<std::string, std::vector<std::string>> getTagElementList(const char* tag, const char* element, const std::string& folderPath);
         bool deleteTagByName(const char* tag, const char* name);
         wayPoint getWaypointInfo(const char* name);
         bool addWaypoint(const wayPoint& wp);
-        bool loadTrack(TrackVector& trackData);
+        bool loadTrack(TrackVector& trackData, std::vector<TrackSegment>& index);
+        static void buildTrackIndex(const TrackVector& trackData, std::vector<TrackSegment>& index);
         std::vector<TurnPoint> getTurnPointsSlidingWindow(float thresholdDeg, float minDist, float sharpTurnDeg,int windowSize, const TrackVector& trackData);
 
         std::string filePath;
@@ -68,6 +70,8 @@ class GPXParser
 /**
 * @brief Edit a tag, attribute, or element in the GPX file.
 *
+* @details Waypoint renames in the file backed by the waypoint store go to the store.
+*
 * @param tag XML tag name.
 * @param attribute XML attribute name (can be nullptr).
 * @param element XML element name (can be nullptr).
@@ -78,6 +82,14 @@ class GPXParser
 template <typename T>
 bool GPXParser::editTagAttrOrElem(const char* tag, const char* attribute, const char* element, const T& oldValue, const T& newValue)
 {
+    if (waypointStore.handles(filePath.c_str()) && strcmp(tag, gpxWaypointTag) == 0 && element && strcmp(element, gpxNameElem) == 0)
+    {
+        std::ostringstream oldName, newName;
+        oldName << oldValue;
+        newName << newValue;
+        return waypointStore.rename(oldName.str().c_str(), newName.str().c_str());
+    }
+
     tinyxml2::XMLDocument doc;
     tinyxml2::XMLError result = doc.LoadFile(filePath.c_str());
     if (result != tinyxml2::XML_SUCCESS)
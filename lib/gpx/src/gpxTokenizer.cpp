@@ -0,0 +1,500 @@
+/**
+ * @file gpxTokenizer.cpp
+ * @author Jordi Gauchía (jgauchia@jgauchia.com)
+ * @brief  Streaming GPX tokenizer - block reads, no line layout assumptions
+ * @version 0.2.5
+ * @date 2026-04
+ */
+
+#include "gpxTokenizer.hpp"
+#include <cstdlib>
+#include <cstring>
+#include "esp_heap_caps.h"
+
+static inline bool isSpace(char c) { return c == ' ' || c == '\n' || c == '\r' || c == '\t'; }
+
+/**
+ * @brief Find a character sequence in a memory range
+ *
+ * @return Start of the sequence, nullptr if not found
+ */
+static const char *findSeq(const char *from, const char *to, const char *seq, size_t len)
+{
+    while (from + len <= to)
+    {
+        const char *c = (const char *)memchr(from, seq[0], to - from - len + 1);
+        if (!c)
+            return nullptr;
+        if (memcmp(c, seq, len) == 0)
+            return c;
+        from = c + 1;
+    }
+    return nullptr;
+}
+
+/**
+ * @brief Parse a decimal number as written in GPX files ([-]ddd.ddddddd)
+ *
+ * @details Builds the integer mantissa and divides once by an exact power of ten, several
+ *          times faster than strtof. Exponents and very long mantissas go to strtof.
+ *
+ * @param s Number text, leading blanks allowed
+ * @param value Output value
+ * @return true if a number was parsed
+ */
+bool GpxTokenizer::parseFloat(const char *s, float &value)
+{
+    static const double pow10[] = {1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9,
+                                   1e10, 1e11, 1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18};
+    const char *p = s;
+    while (isSpace(*p))
+        p++;
+    const bool negative = *p == '-';
+    if (*p == '-' || *p == '+')
+        p++;
+
+    uint64_t mantissa = 0;
+    int digits = 0;
+    int decimals = 0;
+    while (*p >= '0' && *p <= '9')
+    {
+        mantissa = mantissa * 10 + (*p++ - '0');
+        digits++;
+    }
+    if (*p == '.')
+    {
+        p++;
+        while (*p >= '0' && *p <= '9')
+        {
+            mantissa = mantissa * 10 + (*p++ - '0');
+            digits++;
+            decimals++;
+        }
+    }
+
+    if (digits == 0)
+        return false;
+    if (digits > 18 || *p == 'e' || *p == 'E')
+    {
+        char *endPtr;
+        value = strtof(s, &endPtr);
+        return endPtr != s;
+    }
+
+    const double v = (double)mantissa / pow10[decimals];
+    value = (float)(negative ? -v : v);
+    return true;
+}
+
+/**
+ * @brief GpxTokenizer constructor
+ *
+ * @details The block buffer goes to internal RAM so unbuffered reads reach the FAT layer
+ *          directly, PSRAM is used if internal RAM is short.
+ *
+ * @param blockSize Block buffer size
+ */
+GpxTokenizer::GpxTokenizer(size_t blockSize) : fileSize(0), bytesRead(0), file(nullptr), buf(nullptr), cap(blockSize),
+                                               pos(0), end(0), eof(true), skipping(false), name(nullptr), nameLen(0),
+                                               attrs(nullptr), attrsLen(0), text(nullptr), textLen(0), emptyTag(false)
+{
+    buf = (char *)heap_caps_malloc(cap + 1, MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT);
+    if (!buf)
+        buf = (char *)heap_caps_malloc(cap + 1, MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT);
+}
+
+/**
+ * @brief GpxTokenizer destructor
+ */
+GpxTokenizer::~GpxTokenizer()
+{
+    close();
+    heap_caps_free(buf);
+}
+
+/**
+ * @brief Open a GPX file, the block buffer is reused
+ *
+ * @param path File path
+ * @return true if the file is open
+ */
+bool GpxTokenizer::open(const char *path)
+{
+    close();
+    if (!buf)
+        return false;
+
+    file = fopen(path, "r");
+    if (!file)
+        return false;
+    // Whole blocks are read, stdio buffering would only add a copy
+    setvbuf(file, nullptr, _IONBF, 0);
+
+    fseek(file, 0, SEEK_END);
+    fileSize = ftell(file);
+    rewind(file);
+
+    pos = 0;
+    end = 0;
+    buf[0] = '\0';
+    bytesRead = 0;
+    eof = false;
+    skipping = false;
+    return true;
+}
+
+/**
+ * @brief Close the open file
+ */
+void GpxTokenizer::close()
+{
+    if (file)
+        fclose(file);
+    file = nullptr;
+    eof = true;
+}
+
+/**
+ * @brief Move the unread bytes to the front of the buffer and read the next block behind them
+ *
+ * @return true if new bytes were read
+ */
+bool GpxTokenizer::refill()
+{
+    if (eof)
+        return false;
+
+    if (pos > 0)
+    {
+        memmove(buf, buf + pos, end - pos);
+        end -= pos;
+        pos = 0;
+    }
+    if (end == cap)
+        return false;
+
+    const size_t n = fread(buf + end, 1, cap - end, file);
+    if (n == 0)
+        eof = true;
+    end += n;
+    buf[end] = '\0';
+    bytesRead += n;
+    return n > 0;
+}
+
+/**
+ * @brief Split a complete tag into name, attributes and self-closing flag
+ *
+ * @param start Opening '<'
+ * @param gt Closing '>'
+ * @return TOKEN_OPEN or TOKEN_CLOSE
+ */
+GpxTokenizer::Token GpxTokenizer::parseTag(const char *start, const char *gt)
+{
+    Token token = TOKEN_OPEN;
+    const char *s = start + 1;
+    if (*s == '/')
+    {
+        token = TOKEN_CLOSE;
+        s++;
+    }
+
+    const char *e = s;
+    while (e < gt && !isSpace(*e) && *e != '/')
+        e++;
+    const char *colon = (const char *)memchr(s, ':', e - s);
+    if (colon)
+        s = colon + 1;
+
+    name = s;
+    nameLen = e - s;
+    emptyTag = token == TOKEN_OPEN && gt[-1] == '/';
+    attrs = e;
+    attrsLen = (gt - e) - (emptyTag ? 1 : 0);
+    return token;
+}
+
+/**
+ * @brief Read the next token
+ *
+ * @return Token type, TOKEN_EOF at the end of the file
+ */
+GpxTokenizer::Token GpxTokenizer::next()
+{
+    while (true)
+    {
+        if (pos == end && !refill())
+            return TOKEN_EOF;
+
+        const char *p = buf + pos;
+        size_t avail = end - pos;
+
+        if (skipping)
+        {
+            const char *gt = (const char *)memchr(p, '>', avail);
+            pos = gt ? gt + 1 - buf : end;
+            skipping = gt == nullptr;
+            continue;
+        }
+
+        if (*p != '<')
+        {
+            while (avail > 0 && isSpace(*p))
+            {
+                p++;
+                avail--;
+            }
+            pos = p - buf;
+            if (avail == 0 || *p == '<')
+                continue;
+
+            const char *lt = (const char *)memchr(p, '<', avail);
+            if (!lt)
+            {
+                // Text cut by the block end, or longer than the buffer
+                if (refill())
+                    continue;
+                p = buf + pos;
+                lt = buf + end;
+            }
+            text = p;
+            textLen = lt - p;
+            pos = lt - buf;
+            return TOKEN_TEXT;
+        }
+
+        if (!eof && (avail < 2 || (p[1] == '!' && avail < 9)))
+        {
+            refill();
+            continue;
+        }
+
+        const char *term = ">";
+        size_t termLen = 1;
+        size_t skip = 1;
+        bool markup = false;
+        bool cdata = false;
+        if (avail >= 2 && p[1] == '?')
+        {
+            term = "?>";
+            termLen = 2;
+            markup = true;
+        }
+        else if (avail >= 4 && memcmp(p, "<!--", 4) == 0)
+        {
+            term = "-->";
+            termLen = 3;
+            skip = 4;
+            markup = true;
+        }
+        else if (avail >= 9 && memcmp(p, "<![CDATA[", 9) == 0)
+        {
+            term = "]]>";
+            termLen = 3;
+            skip = 9;
+            cdata = true;
+        }
+        else if (avail >= 2 && p[1] == '!')
+            markup = true;
+
+        const char *found = skip <= avail ? findSeq(p + skip, buf + end, term, termLen) : nullptr;
+        if (!found)
+        {
+            if (refill())
+                continue;
+            if (eof)
+            {
+                pos = end;
+                return TOKEN_EOF;
+            }
+            // Tag longer than the buffer
+            pos = end;
+            skipping = true;
+            continue;
+        }
+
+        pos = found + termLen - buf;
+        if (markup)
+            continue;
+        if (cdata)
+        {
+            text = p + skip;
+            textLen = found - text;
+            if (textLen == 0)
+                continue;
+            return TOKEN_TEXT;
+        }
+        return parseTag(p, found);
+    }
+}
+
+/**
+ * @brief Read the next point with the given tag (trkpt, rtept, wpt)
+ *
+ * @details Takes lat/lon from the attributes, in any order and quoting, and the direct
+ *          <ele> and <time> children. Points without lat/lon are skipped.
+ *
+ * @param tag Point tag
+ * @param point Output point
+ * @return true if a point was read, false at the end of the file
+ */
+bool GpxTokenizer::nextPoint(const char *tag, GpxPoint &point)
+{
+    enum Child { CHILD_NONE, CHILD_ELE, CHILD_TIME };
+
+    while (true)
+    {
+        Token token = next();
+        if (token == TOKEN_EOF)
+            return false;
+        if (token != TOKEN_OPEN || !isTag(tag))
+            continue;
+
+        point.lat = 0.0f;
+        point.lon = 0.0f;
+        point.ele = 0.0f;
+        point.hasEle = false;
+        point.time[0] = '\0';
+        const bool valid = getAttrFloat("lat", point.lat) && getAttrFloat("lon", point.lon);
+
+        if (!emptyTag)
+        {
+            int depth = 0;
+            Child child = CHILD_NONE;
+            while ((token = next()) != TOKEN_EOF)
+            {
+                if (token == TOKEN_OPEN)
+                {
+                    child = CHILD_NONE;
+                    if (depth == 0 && !emptyTag)
+                        child = isTag("ele") ? CHILD_ELE : isTag("time") ? CHILD_TIME : CHILD_NONE;
+                    if (!emptyTag)
+                        depth++;
+                }
+                else if (token == TOKEN_CLOSE)
+                {
+                    if (depth == 0)
+                        break;
+                    depth--;
+                    child = CHILD_NONE;
+                }
+                else if (child == CHILD_ELE)
+                {
+                    point.hasEle = parseFloat(text, point.ele);
+                    child = CHILD_NONE;
+                }
+                else if (child == CHILD_TIME)
+                {
+                    const size_t len = textLen < sizeof(point.time) - 1 ? textLen : sizeof(point.time) - 1;
+                    memcpy(point.time, text, len);
+                    point.time[len] = '\0';
+                    child = CHILD_NONE;
+                }
+            }
+        }
+
+        if (valid)
+            return true;
+    }
+}
+
+/**
+ * @brief Check the name of the current tag, without namespace prefix
+ *
+ * @param tag Tag name
+ * @return true if the current tag has that name
+ */
+bool GpxTokenizer::isTag(const char *tag) const
+{
+    return strlen(tag) == nameLen && memcmp(name, tag, nameLen) == 0;
+}
+
+/**
+ * @brief Check if the current open tag is self-closing (<tag/>)
+ *
+ * @return true if self-closing
+ */
+bool GpxTokenizer::isEmptyTag() const
+{
+    return emptyTag;
+}
+
+/**
+ * @brief Get an attribute of the current open tag
+ *
+ * @param attr Attribute name
+ * @param value Output value, not terminated
+ * @param len Output value length
+ * @return true if the attribute was found
+ */
+bool GpxTokenizer::getAttr(const char *attr, const char *&value, size_t &len) const
+{
+    const char *p = attrs;
+    const char *e = attrs + attrsLen;
+    const size_t attrLen = strlen(attr);
+
+    while (p < e)
+    {
+        while (p < e && isSpace(*p))
+            p++;
+        const char *n = p;
+        while (p < e && *p != '=' && !isSpace(*p))
+            p++;
+        const size_t nLen = p - n;
+        while (p < e && isSpace(*p))
+            p++;
+        if (p >= e || *p != '=')
+        {
+            if (p < e && nLen == 0)
+                p++;
+            continue;
+        }
+        p++;
+        while (p < e && isSpace(*p))
+            p++;
+        if (p >= e || (*p != '"' && *p != '\''))
+            continue;
+
+        const char quote = *p++;
+        const char *v = p;
+        const char *ve = (const char *)memchr(p, quote, e - p);
+        if (!ve)
+            return false;
+        if (nLen == attrLen && memcmp(n, attr, attrLen) == 0)
+        {
+            value = v;
+            len = ve - v;
+            return true;
+        }
+        p = ve + 1;
+    }
+    return false;
+}
+
+/**
+ * @brief Get a numeric attribute of the current open tag
+ *
+ * @param attr Attribute name
+ * @param value Output value
+ * @return true if the attribute was found and is a number
+ */
+bool GpxTokenizer::getAttrFloat(const char *attr, float &value) const
+{
+    const char *v;
+    size_t len;
+    if (!getAttr(attr, v, len))
+        return false;
+    return parseFloat(v, value);
+}
+
+/**
+ * @brief Get the current text token
+ *
+ * @param len Output text length
+ * @return Text, not terminated
+ */
+const char *GpxTokenizer::getText(size_t &len) const
+{
+    len = textLen;
+    return text;
+}
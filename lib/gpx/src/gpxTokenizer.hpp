@@ -0,0 +1,95 @@
+/**
+ * @file gpxTokenizer.hpp
+ * @author Jordi Gauchía (jgauchia@jgauchia.com)
+ * @brief  Streaming GPX tokenizer - block reads, no line layout assumptions
+ * @version 0.2.5
+ * @date 2026-04
+ *
+ * Platform independent, also built by tools/gpx_bench.
+ *
+ * The file is read in large blocks into one reusable buffer and split into open tag,
+ * close tag and text tokens. A token cut by the end of a block is completed by moving
+ * it to the front of the buffer and reading the next block, so the layout of the file
+ * (one tag per line, minified, attributes over several lines) does not matter.
+ * Comments, processing instructions and DOCTYPE are skipped, CDATA is returned as text.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+
+/**
+ * @brief Point read by GpxTokenizer::nextPoint
+ */
+struct GpxPoint
+{
+    float lat;          /**< Latitude (degrees) */
+    float lon;          /**< Longitude (degrees) */
+    float ele;          /**< Elevation (m), valid if hasEle */
+    bool hasEle;        /**< <ele> child found */
+    char time[24];      /**< <time> child, ISO 8601, empty if missing */
+};
+
+/**
+ * @class GpxTokenizer
+ * @brief Block based XML tokenizer for GPX files
+ *
+ * @details Token names, attributes and text point into the block buffer and are valid
+ *          until the next call to next(). Names are compared without namespace prefix.
+ *          A tag longer than the buffer is skipped, a text longer than the buffer is
+ *          returned in buffer sized pieces.
+ */
+class GpxTokenizer
+{
+public:
+    enum Token
+    {
+        TOKEN_EOF,      /**< End of file */
+        TOKEN_OPEN,     /**< <tag ...> or <tag .../> */
+        TOKEN_CLOSE,    /**< </tag> */
+        TOKEN_TEXT,     /**< Text content, whitespace-only text is skipped */
+    };
+
+    static constexpr size_t BLOCK_SIZE = 8192;     /**< Default block size */
+
+    explicit GpxTokenizer(size_t blockSize = BLOCK_SIZE);
+    ~GpxTokenizer();
+
+    bool open(const char *path);
+    void close();
+    Token next();
+    bool nextPoint(const char *tag, GpxPoint &point);
+
+    bool isTag(const char *tag) const;
+    bool isEmptyTag() const;
+    bool getAttr(const char *attr, const char *&value, size_t &len) const;
+    bool getAttrFloat(const char *attr, float &value) const;
+    const char *getText(size_t &len) const;
+
+    static bool parseFloat(const char *s, float &value);
+
+    size_t fileSize;        /**< Size of the open file */
+    size_t bytesRead;       /**< Bytes read from the open file */
+
+private:
+    FILE *file;             /**< Open file */
+    char *buf;              /**< Block buffer, one extra byte for a terminator */
+    size_t cap;             /**< Block buffer size */
+    size_t pos;             /**< Next unread byte */
+    size_t end;             /**< End of valid data */
+    bool eof;               /**< No more data in the file */
+    bool skipping;          /**< Discarding a tag longer than the buffer */
+
+    const char *name;       /**< Current tag local name */
+    size_t nameLen;         /**< Current tag name length */
+    const char *attrs;      /**< Current tag attributes */
+    size_t attrsLen;        /**< Current tag attributes length */
+    const char *text;       /**< Current text */
+    size_t textLen;         /**< Current text length */
+    bool emptyTag;          /**< Current tag is self-closing */
+
+    bool refill();
+    Token parseTag(const char *start, const char *gt);
+};
@@ -0,0 +1,366 @@
+/**
+ * @file trackCache.cpp
+ * @author Jordi Gauchía (jgauchia@jgauchia.com)
+ * @brief  Binary track cache - parsed GPX track sidecar for fast reloads
+ * @version 0.2.5
+ * @date 2026-04
+ */
+
+#include "trackCache.hpp"
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <sys/stat.h>
+#include "esp_heap_caps.h"
+#include "esp_log.h"
+
+static const char* TAG = "TrackCache";
+
+namespace
+{
+    /**
+     * @brief Cache file header
+     */
+    struct CacheHeader
+    {
+        char magic[4];         /**< "TRC1" */
+        uint16_t version;      /**< TrackCache::VERSION */
+        uint16_t headerSize;   /**< sizeof(CacheHeader) */
+        uint32_t gpxSize;      /**< GPX file size the cache was built from */
+        uint32_t points;       /**< Track points */
+        int64_t gpxMtime;      /**< GPX modification time the cache was built from */
+        uint32_t segments;     /**< Segment index entries */
+        uint32_t coordBytes;   /**< Coordinate and elevation stream length */
+        uint32_t checksum;     /**< FNV-1a of the payload */
+        float totalDist;       /**< Track length (m) */
+    };
+    static_assert(sizeof(CacheHeader) == 40, "Track cache header layout");
+
+    static const char CACHE_MAGIC[4] = {'T', 'R', 'C', '1'};
+    static constexpr uint32_t FNV_OFFSET = 2166136261u;
+    static constexpr uint32_t FNV_PRIME = 16777619u;
+
+    static uint32_t fnv1a(uint32_t hash, const uint8_t *data, size_t len)
+    {
+        for (size_t i = 0; i < len; i++)
+            hash = (hash ^ data[i]) * FNV_PRIME;
+        return hash;
+    }
+
+    static uint8_t *allocChunk()
+    {
+        uint8_t *buf = (uint8_t *)heap_caps_malloc(TrackCache::CHUNK_SIZE, MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT);
+        if (!buf)
+            buf = (uint8_t *)heap_caps_malloc(TrackCache::CHUNK_SIZE, MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT);
+        return buf;
+    }
+
+    /**
+     * @brief Buffered sequential writer computing the payload checksum
+     */
+    struct ChunkWriter
+    {
+        FILE *file;
+        uint8_t *buf;
+        size_t used = 0;
+        uint32_t hash = FNV_OFFSET;
+        uint32_t total = 0;
+        bool ok = true;
+
+        ChunkWriter(FILE *file, uint8_t *buf) : file(file), buf(buf) {}
+
+        void flush()
+        {
+            if (used > 0 && fwrite(buf, 1, used, file) != used)
+                ok = false;
+            used = 0;
+        }
+
+        void put(const void *data, size_t len)
+        {
+            const uint8_t *src = (const uint8_t *)data;
+            hash = fnv1a(hash, src, len);
+            total += len;
+            while (len > 0)
+            {
+                if (used == TrackCache::CHUNK_SIZE)
+                    flush();
+                size_t n = TrackCache::CHUNK_SIZE - used;
+                if (n > len)
+                    n = len;
+                memcpy(buf + used, src, n);
+                used += n;
+                src += n;
+                len -= n;
+            }
+        }
+
+        void varint(uint32_t value)
+        {
+            uint8_t bytes[5];
+            size_t n = 0;
+            while (value >= 0x80)
+            {
+                bytes[n++] = (uint8_t)(value | 0x80);
+                value >>= 7;
+            }
+            bytes[n++] = (uint8_t)value;
+            put(bytes, n);
+        }
+    };
+
+    /**
+     * @brief Buffered sequential reader computing the payload checksum
+     */
+    struct ChunkReader
+    {
+        FILE *file;
+        uint8_t *buf;
+        size_t pos = 0;
+        size_t len = 0;
+        uint32_t hash = FNV_OFFSET;
+        uint32_t hashed = 0;
+
+        ChunkReader(FILE *file, uint8_t *buf) : file(file), buf(buf) {}
+
+        bool fill()
+        {
+            hash = fnv1a(hash, buf + hashed, len - hashed);
+            len = fread(buf, 1, TrackCache::CHUNK_SIZE, file);
+            pos = 0;
+            hashed = 0;
+            return len > 0;
+        }
+
+        uint32_t checksum()
+        {
+            hash = fnv1a(hash, buf + hashed, pos - hashed);
+            hashed = pos;
+            return hash;
+        }
+
+        bool get(void *data, size_t size)
+        {
+            uint8_t *dst = (uint8_t *)data;
+            while (size > 0)
+            {
+                if (pos == len && !fill())
+                    return false;
+                size_t n = len - pos;
+                if (n > size)
+                    n = size;
+                memcpy(dst, buf + pos, n);
+                pos += n;
+                dst += n;
+                size -= n;
+            }
+            return true;
+        }
+
+        bool varint(uint32_t &value)
+        {
+            value = 0;
+            for (uint8_t shift = 0; shift < 35; shift += 7)
+            {
+                if (pos == len && !fill())
+                    return false;
+                const uint8_t b = buf[pos++];
+                value |= (uint32_t)(b & 0x7F) << shift;
+                if (!(b & 0x80))
+                    return true;
+            }
+            return false;
+        }
+    };
+
+    static inline uint32_t zigzag(int32_t v) { return ((uint32_t)v << 1) ^ (uint32_t)(v >> 31); }
+    static inline int32_t unzigzag(uint32_t v) { return (int32_t)(v >> 1) ^ -(int32_t)(v & 1); }
+    static inline int32_t toE7(float deg) { return (int32_t)lrint((double)deg * 1e7); }
+}
+
+/**
+ * @brief Get the sidecar path of a GPX file
+ *
+ * @param gpxPath GPX file path
+ * @return Cache file path (GPX path + ".trc")
+ */
+std::string TrackCache::cachePath(const char *gpxPath)
+{
+    return std::string(gpxPath) + ".trc";
+}
+
+/**
+ * @brief Load a track from its cache
+ *
+ * @details Fails without touching the outputs if there is no cache or it was built from a
+ *          different GPX size or modification time, or an older layout. A cache that fails
+ *          the checksum (e.g. interrupted write) leaves the outputs empty.
+ *
+ * @param gpxPath GPX file path
+ * @param trackData Output track points
+ * @param index Output segment index
+ * @return true if the track was loaded from the cache
+ */
+bool TrackCache::load(const char *gpxPath, TrackVector &trackData, std::vector<TrackSegment> &index)
+{
+    struct stat st;
+    if (stat(gpxPath, &st) != 0)
+        return false;
+
+    const std::string path = cachePath(gpxPath);
+    FILE *file = fopen(path.c_str(), "rb");
+    if (!file)
+        return false;
+
+    CacheHeader header;
+    if (fread(&header, 1, sizeof(header), file) != sizeof(header) ||
+        memcmp(header.magic, CACHE_MAGIC, 4) != 0 || header.version != VERSION ||
+        header.headerSize != sizeof(CacheHeader) || header.gpxSize != (uint32_t)st.st_size ||
+        header.gpxMtime != (int64_t)st.st_mtime)
+    {
+        ESP_LOGI(TAG, "Stale track cache %s", path.c_str());
+        fclose(file);
+        return false;
+    }
+
+    uint8_t *buf = allocChunk();
+    if (!buf)
+    {
+        fclose(file);
+        return false;
+    }
+
+    trackData.clear();
+    trackData.resize(header.points);
+    index.resize(header.segments);
+
+    ChunkReader reader(file, buf);
+    bool ok = reader.get(index.data(), header.segments * sizeof(TrackSegment)) &&
+              reader.get(trackData.accumDist.data(), header.points * sizeof(float));
+
+    int32_t lat = 0;
+    int32_t lon = 0;
+    int32_t ele = 0;
+    for (uint32_t i = 0; ok && i < header.points; i++)
+    {
+        uint32_t dLat = 0;
+        uint32_t dLon = 0;
+        uint32_t dEle = 0;
+        ok = reader.varint(dLat) && reader.varint(dLon) && reader.varint(dEle);
+        lat += unzigzag(dLat);
+        lon += unzigzag(dLon);
+        ele += unzigzag(dEle);
+        trackData.lat[i] = (float)(lat * 1e-7);
+        trackData.lon[i] = (float)(lon * 1e-7);
+        trackData.ele[i] = ele * 0.1f;
+    }
+
+    ok = ok && reader.checksum() == header.checksum;
+    heap_caps_free(buf);
+    fclose(file);
+
+    if (!ok)
+    {
+        ESP_LOGE(TAG, "Corrupt track cache %s", path.c_str());
+        trackData.clear();
+        index.clear();
+        return false;
+    }
+
+    ESP_LOGI(TAG, "Track loaded from cache: %u points, %u segments, %.1f m", (unsigned)header.points,
+             (unsigned)header.segments, header.totalDist);
+    return true;
+}
+
+/**
+ * @brief Write the cache of a parsed track
+ *
+ * @details Written to a temporary file and renamed, so a power loss never leaves a
+ *          half-written cache under the final name.
+ *
+ * @param gpxPath GPX file path
+ * @param trackData Parsed track points
+ * @param index Segment index
+ * @return true if the cache was written
+ */
+bool TrackCache::save(const char *gpxPath, const TrackVector &trackData, const std::vector<TrackSegment> &index)
+{
+    struct stat st;
+    if (trackData.empty() || stat(gpxPath, &st) != 0)
+        return false;
+
+    const std::string path = cachePath(gpxPath);
+    const std::string tmpPath = path + ".tmp";
+    FILE *file = fopen(tmpPath.c_str(), "wb");
+    if (!file)
+        return false;
+
+    uint8_t *buf = allocChunk();
+    if (!buf)
+    {
+        fclose(file);
+        remove(tmpPath.c_str());
+        return false;
+    }
+
+    CacheHeader header = {};
+    memcpy(header.magic, CACHE_MAGIC, 4);
+    header.version = VERSION;
+    header.headerSize = sizeof(CacheHeader);
+    header.gpxSize = (uint32_t)st.st_size;
+    header.gpxMtime = (int64_t)st.st_mtime;
+    header.points = (uint32_t)trackData.size();
+    header.segments = (uint32_t)index.size();
+    header.totalDist = trackData.accumDist.back();
+    bool ok = fwrite(&header, 1, sizeof(header), file) == sizeof(header);
+
+    ChunkWriter writer(file, buf);
+    writer.put(index.data(), index.size() * sizeof(TrackSegment));
+    writer.put(trackData.accumDist.data(), trackData.size() * sizeof(float));
+
+    const uint32_t coordStart = writer.total;
+    int32_t lastLat = 0;
+    int32_t lastLon = 0;
+    int32_t lastEle = 0;
+    for (size_t i = 0; i < trackData.size(); i++)
+    {
+        const int32_t lat = toE7(trackData.lat[i]);
+        const int32_t lon = toE7(trackData.lon[i]);
+        const int32_t ele = (int32_t)lrintf(trackData.ele[i] * 10.0f);
+        writer.varint(zigzag(lat - lastLat));
+        writer.varint(zigzag(lon - lastLon));
+        writer.varint(zigzag(ele - lastEle));
+        lastLat = lat;
+        lastLon = lon;
+        lastEle = ele;
+    }
+    writer.flush();
+    heap_caps_free(buf);
+
+    header.coordBytes = writer.total - coordStart;
+    header.checksum = writer.hash;
+    ok = ok && writer.ok && fseek(file, 0, SEEK_SET) == 0 && fwrite(&header, 1, sizeof(header), file) == sizeof(header);
+    ok = (fclose(file) == 0) && ok;
+
+    if (ok)
+    {
+        remove(path.c_str());
+        ok = rename(tmpPath.c_str(), path.c_str()) == 0;
+    }
+    if (!ok)
+    {
+        ESP_LOGE(TAG, "Failed to write track cache %s", path.c_str());
+        remove(tmpPath.c_str());
+    }
+    return ok;
+}
+
+/**
+ * @brief Delete the cache of a GPX file
+ *
+ * @param gpxPath GPX file path
+ */
+void TrackCache::invalidate(const char *gpxPath)
+{
+    remove(cachePath(gpxPath).c_str());
+}
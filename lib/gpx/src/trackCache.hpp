@@ -0,0 +1,44 @@
+/**
+ * @file trackCache.hpp
+ * @author Jordi Gauchía (jgauchia@jgauchia.com)
+ * @brief  Binary track cache - parsed GPX track sidecar for fast reloads
+ * @version 0.2.5
+ * @date 2026-04
+ *
+ * The first load of a GPX track writes the parsed points, elevations, cumulative distances and
+ * segment index next to it (track.gpx -> track.gpx.trc). Later loads read the sidecar
+ * in one sequential pass instead of parsing XML and recomputing distances. The cache
+ * is keyed by the GPX size and modification time and is rebuilt when either changes.
+ *
+ * Layout (little-endian):
+ *  - Header (40 bytes): magic "TRC1", version (u16), header size (u16), GPX size (u32),
+ *    points (u32), GPX mtime (i64), segments (u32), point stream bytes (u32),
+ *    payload checksum (u32, FNV-1a), total distance (f32)
+ *  - TrackSegment[segments]
+ *  - accumDist (f32)[points]
+ *  - Points: lat/lon in 1e-7 degrees and elevation in decimeters, first point absolute,
+ *    then zigzag varint deltas
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "globalGpxDef.h"
+
+/**
+ * @class TrackCache
+ * @brief Reads and writes the binary track cache sidecar
+ */
+class TrackCache
+{
+public:
+    static constexpr uint16_t VERSION = 2;          /**< Layout version, older caches are rebuilt */
+    static constexpr size_t CHUNK_SIZE = 16384;     /**< Sequential read/write chunk */
+
+    static std::string cachePath(const char *gpxPath);
+    static bool load(const char *gpxPath, TrackVector &trackData, std::vector<TrackSegment> &index);
+    static bool save(const char *gpxPath, const TrackVector &trackData, const std::vector<TrackSegment> &index);
+    static void invalidate(const char *gpxPath);
+};
@@ -0,0 +1,301 @@
+/**
+ * @file trackGrid.cpp
+ * @author Jordi Gauchía (jgauchia@jgauchia.com)
+ * @brief  Spatial grid of track segments for position matching
+ * @version 0.2.5
+ * @date 2026-04
+ */
+
+#include "trackGrid.hpp"
+#include <algorithm>
+#include <cmath>
+#include <utility>
+#include "gpsMath.hpp"
+
+/**
+ * @brief Meters per degree of latitude
+ */
+static constexpr float METERS_PER_DEG = EARTH_RADIUS * M_PI / 180.0f;
+
+static constexpr float MIN_CELL = 50.0f;    /**< Smallest cell side (m) */
+static constexpr float MAX_CELL = 250.0f;   /**< Largest cell side (m) */
+
+/**
+ * @brief Longitude difference wrapped to [-180, 180]
+ */
+static inline float wrapLon(float dLon)
+{
+    if (dLon > 180.0f)
+        return dLon - 360.0f;
+    if (dLon < -180.0f)
+        return dLon + 360.0f;
+    return dLon;
+}
+
+TrackGrid::TrackGrid() : cellSize(MIN_CELL), entries(0), track(nullptr), lat0(0.0f), lon0(0.0f), kx(METERS_PER_DEG),
+                         bucketMask(0) {}
+
+/**
+ * @brief Index the segments of a track
+ *
+ * @details The cell side is four times the mean segment length, within MIN_CELL and MAX_CELL.
+ *          The track must not change while the grid is used.
+ *
+ * @param track Track points with cumulative distances
+ */
+void TrackGrid::build(const TrackVector &track)
+{
+    clear();
+    this->track = &track;
+    const size_t n = track.size();
+    if (n < 2)
+        return;
+
+    float minLat = track.lat[0], maxLat = track.lat[0];
+    for (size_t i = 1; i < n; i++)
+    {
+        minLat = std::min(minLat, track.lat[i]);
+        maxLat = std::max(maxLat, track.lat[i]);
+    }
+    lat0 = (minLat + maxLat) * 0.5f;
+    lon0 = track.lon[0];
+    kx = METERS_PER_DEG * cosf(DEG2RAD(lat0));
+    cellSize = std::min(MAX_CELL, std::max(MIN_CELL, 4.0f * track.accumDist[n - 1] / (n - 1)));
+
+    uint32_t buckets = 16;
+    while (buckets < n)
+        buckets <<= 1;
+    bucketMask = buckets - 1;
+
+    // Counting sort of the (segment, cell) pairs by bucket
+    bucketStart.assign(buckets + 1, 0);
+    for (size_t i = 0; i + 1 < n; i++)
+        forEachCell(i, [&](uint32_t bucket) { bucketStart[bucket + 1]++; });
+    for (uint32_t b = 0; b < buckets; b++)
+        bucketStart[b + 1] += bucketStart[b];
+    entries = bucketStart[buckets];
+
+    segments.resize(entries);
+    IndexColumn fill(bucketStart.begin(), bucketStart.end() - 1);
+    for (size_t i = 0; i + 1 < n; i++)
+        forEachCell(i, [&](uint32_t bucket) { segments[fill[bucket]++] = (uint32_t)i; });
+}
+
+/**
+ * @brief Drop the index
+ */
+void TrackGrid::clear()
+{
+    track = nullptr;
+    entries = 0;
+    bucketMask = 0;
+    bucketStart.clear();
+    bucketStart.shrink_to_fit();
+    segments.clear();
+    segments.shrink_to_fit();
+}
+
+/**
+ * @brief Check if the grid has no segments
+ */
+bool TrackGrid::empty() const
+{
+    return entries == 0;
+}
+
+/**
+ * @brief Nearest segment to a position and the other segments almost as near
+ *
+ * @details Visits rings of cells around the position and stops when the next ring is
+ *          farther than the radius, than the nearest segment plus the margin, or than
+ *          the last of maxOut segments found.
+ *
+ * @param lat Latitude
+ * @param lon Longitude
+ * @param radius Search radius (m)
+ * @param margin Segments up to this distance (m) farther than the nearest one are returned too
+ * @param out Output, matches sorted by distance, one per segment
+ * @param maxOut Max matches
+ * @return Matches found
+ */
+size_t TrackGrid::query(float lat, float lon, float radius, float margin, TrackMatch *out, size_t maxOut) const
+{
+    if (empty() || maxOut == 0)
+        return 0;
+
+    int32_t ucx, ucy;
+    toCell(lat, lon, ucx, ucy);
+    const float k = METERS_PER_DEG * cosf(DEG2RAD(lat));
+    const int32_t maxRing = (int32_t)(radius / cellSize) + 1;
+
+    // Distances first, full matches only for the segments kept
+    size_t found = 0;
+    float limit = radius;
+    for (int32_t ring = 0; ring <= maxRing; ring++)
+    {
+        const float ringDist = ring > 0 ? (ring - 1) * cellSize : 0.0f;
+        if (ringDist > limit || (found == maxOut && ringDist > out[found - 1].dist))
+            break;
+
+        for (int32_t dy = -ring; dy <= ring; dy++)
+        {
+            const bool edgeRow = dy == -ring || dy == ring;
+            for (int32_t dx = -ring; dx <= ring; dx += edgeRow ? 1 : 2 * ring)
+            {
+                const uint32_t bucket = bucketOf(ucx + dx, ucy + dy);
+                for (uint32_t e = bucketStart[bucket]; e < bucketStart[bucket + 1]; e++)
+                {
+                    const uint32_t seg = segments[e];
+                    const float dist = sqrtf(segmentDistSq(seg, lat, lon, k));
+                    if (dist > limit || (found == maxOut && dist >= out[found - 1].dist))
+                        continue;
+
+                    bool known = false;
+                    for (size_t i = 0; i < found && !known; i++)
+                        known = out[i].segIdx == (int)seg;
+                    if (known)
+                        continue;
+
+                    // Insert sorted, dropping the farthest when full
+                    size_t i = found < maxOut ? found++ : maxOut - 1;
+                    while (i > 0 && out[i - 1].dist > dist)
+                    {
+                        out[i] = out[i - 1];
+                        i--;
+                    }
+                    out[i].segIdx = (int)seg;
+                    out[i].dist = dist;
+                    limit = std::min(radius, out[0].dist + margin);
+                }
+                if (ring == 0)
+                    break;
+            }
+        }
+    }
+
+    while (found > 0 && out[found - 1].dist > limit)
+        found--;
+    for (size_t i = 0; i < found; i++)
+        out[i] = matchSegment(*track, out[i].segIdx, lat, lon);
+    return found;
+}
+
+/**
+ * @brief Squared distance (m^2) from a position to a segment
+ *
+ * @param seg Segment start index
+ * @param lat Latitude
+ * @param lon Longitude
+ * @param k Meters per degree of longitude at lat
+ */
+float TrackGrid::segmentDistSq(size_t seg, float lat, float lon, float k) const
+{
+    const float ax = wrapLon(track->lon[seg] - lon) * k;
+    const float ay = (track->lat[seg] - lat) * METERS_PER_DEG;
+    const float dx = wrapLon(track->lon[seg + 1] - track->lon[seg]) * k;
+    const float dy = (track->lat[seg + 1] - track->lat[seg]) * METERS_PER_DEG;
+    const float lenSq = dx * dx + dy * dy;
+    float t = lenSq > 0.0f ? -(ax * dx + ay * dy) / lenSq : 0.0f;
+    t = t < 0.0f ? 0.0f : (t > 1.0f ? 1.0f : t);
+    const float px = ax + t * dx;
+    const float py = ay + t * dy;
+    return px * px + py * py;
+}
+
+/**
+ * @brief Project a position on a track segment
+ *
+ * @details Local plane at the position. A one point track matches its point.
+ *
+ * @param track Track points
+ * @param seg Segment start index
+ * @param lat Latitude
+ * @param lon Longitude
+ * @return Projection, distance and segment course
+ */
+TrackMatch TrackGrid::matchSegment(const TrackVector &track, size_t seg, float lat, float lon)
+{
+    const size_t next = seg + 1 < track.size() ? seg + 1 : seg;
+    const float k = METERS_PER_DEG * cosf(DEG2RAD(lat));
+    const float ax = wrapLon(track.lon[seg] - lon) * k;
+    const float ay = (track.lat[seg] - lat) * METERS_PER_DEG;
+    const float dx = wrapLon(track.lon[next] - track.lon[seg]) * k;
+    const float dy = (track.lat[next] - track.lat[seg]) * METERS_PER_DEG;
+    const float lenSq = dx * dx + dy * dy;
+
+    float t = lenSq > 0.0f ? -(ax * dx + ay * dy) / lenSq : 0.0f;
+    t = t < 0.0f ? 0.0f : (t > 1.0f ? 1.0f : t);
+    const float px = ax + t * dx;
+    const float py = ay + t * dy;
+
+    TrackMatch match;
+    match.segIdx = (int)seg;
+    match.t = t;
+    match.dist = sqrtf(px * px + py * py);
+    float bearing = lenSq > 0.0f ? atan2f(dx, dy) * (180.0f / M_PI) : 0.0f;
+    match.bearing = bearing < 0.0f ? bearing + 360.0f : bearing;
+    match.projLat = lat + py / METERS_PER_DEG;
+    float projLon = lon + (k > 0.0f ? px / k : 0.0f);
+    match.projLon = projLon > 180.0f ? projLon - 360.0f : (projLon < -180.0f ? projLon + 360.0f : projLon);
+    return match;
+}
+
+/**
+ * @brief Grid cell of a position
+ */
+void TrackGrid::toCell(float lat, float lon, int32_t &cx, int32_t &cy) const
+{
+    cx = (int32_t)floorf(wrapLon(lon - lon0) * kx / cellSize);
+    cy = (int32_t)floorf((lat - lat0) * METERS_PER_DEG / cellSize);
+}
+
+/**
+ * @brief Bucket of a grid cell
+ */
+uint32_t TrackGrid::bucketOf(int32_t cx, int32_t cy) const
+{
+    const uint32_t h = (uint32_t)cx * 73856093u ^ (uint32_t)cy * 19349663u;
+    return (h ^ (h >> 16)) & bucketMask;
+}
+
+/**
+ * @brief Call visit with the bucket of each cell the segment passes through
+ *
+ * @details Row by row, so a long segment visits O(length / cellSize) cells instead of
+ *          its whole bounding box.
+ */
+template <typename F> void TrackGrid::forEachCell(size_t seg, F visit) const
+{
+    const float x0 = wrapLon(track->lon[seg] - lon0) * kx;
+    const float y0 = (track->lat[seg] - lat0) * METERS_PER_DEG;
+    const float x1 = wrapLon(track->lon[seg + 1] - lon0) * kx;
+    const float y1 = (track->lat[seg + 1] - lat0) * METERS_PER_DEG;
+    const float minY = std::min(y0, y1);
+    const float maxY = std::max(y0, y1);
+    const float slope = maxY - minY > 1e-3f ? (x1 - x0) / (y1 - y0) : 0.0f;
+    const int32_t cyA = (int32_t)floorf(minY / cellSize);
+    const int32_t cyB = (int32_t)floorf(maxY / cellSize);
+
+    for (int32_t cy = cyA; cy <= cyB; cy++)
+    {
+        float xa, xb;
+        if (maxY - minY <= 1e-3f)
+        {
+            xa = std::min(x0, x1);
+            xb = std::max(x0, x1);
+        }
+        else
+        {
+            const float ylo = std::max(minY, cy * cellSize);
+            const float yhi = std::min(maxY, (cy + 1) * cellSize);
+            xa = x0 + (ylo - y0) * slope;
+            xb = x0 + (yhi - y0) * slope;
+            if (xa > xb)
+                std::swap(xa, xb);
+        }
+        const int32_t cxA = (int32_t)floorf((xa - 0.01f) / cellSize);
+        const int32_t cxB = (int32_t)floorf((xb + 0.01f) / cellSize);
+        for (int32_t cx = cxA; cx <= cxB; cx++)
+            visit(bucketOf(cx, cy));
+    }
+}
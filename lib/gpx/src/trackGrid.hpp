@@ -0,0 +1,72 @@
+/**
+ * @file trackGrid.hpp
+ * @author Jordi Gauchía (jgauchia@jgauchia.com)
+ * @brief  Spatial grid of track segments for position matching
+ * @version 0.2.5
+ * @date 2026-04
+ *
+ * Platform independent, also built by tools/track_grid.
+ *
+ * Each segment of the navigation track (point i to point i + 1) is stored in the cells
+ * of a uniform grid, in meters of a local plane, that its bounding box covers. Cells are
+ * hashed into a bucket table sized to the track, so memory does not depend on the track
+ * extent. A query projects the position on the segments of the cells around it and
+ * returns the nearest one and those almost as near (other passes of the track), with
+ * the projected point and the segment course.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "globalGpxDef.h"
+
+/**
+ * @brief Position matched to a track segment
+ */
+struct TrackMatch
+{
+    int segIdx;         /**< Segment from point segIdx to point segIdx + 1 */
+    float t;            /**< Position along the segment (0-1) */
+    float dist;         /**< Distance from the position to the segment (m) */
+    float bearing;      /**< Segment course (degrees) */
+    float projLat;      /**< Projected latitude on the segment */
+    float projLon;      /**< Projected longitude on the segment */
+};
+
+/**
+ * @class TrackGrid
+ * @brief Hashed uniform grid over the segments of a track
+ */
+class TrackGrid
+{
+public:
+    TrackGrid();
+
+    void build(const TrackVector &track);
+    void clear();
+    bool empty() const;
+    size_t query(float lat, float lon, float radius, float margin, TrackMatch *out, size_t maxOut) const;
+
+    static TrackMatch matchSegment(const TrackVector &track, size_t seg, float lat, float lon);
+
+    float cellSize;     /**< Cell side (m) */
+    uint32_t entries;   /**< Segment references stored, a segment is stored once per covered cell */
+
+private:
+    typedef std::vector<uint32_t, PsramAllocator<uint32_t>> IndexColumn;
+
+    const TrackVector *track;   /**< Indexed track */
+    float lat0;                 /**< Local plane origin latitude */
+    float lon0;                 /**< Local plane origin longitude */
+    float kx;                   /**< Meters per degree of longitude */
+    uint32_t bucketMask;        /**< Bucket count - 1 */
+    IndexColumn bucketStart;    /**< First entry of each bucket, bucket count + 1 */
+    IndexColumn segments;       /**< Segment indices grouped by bucket */
+
+    void toCell(float lat, float lon, int32_t &cx, int32_t &cy) const;
+    uint32_t bucketOf(int32_t cx, int32_t cy) const;
+    float segmentDistSq(size_t seg, float lat, float lon, float k) const;
+    template <typename F> void forEachCell(size_t seg, F visit) const;
+};
@@ -0,0 +1,263 @@
+/**
+ * @file trackLog.cpp
+ * @author Jordi Gauchía (jgauchia@jgauchia.com)
+ * @brief  GPX track log buffer - lock-free fix queue and sector-aligned batch builder
+ * @version 0.2.5
+ * @date 2026-04
+ */
+
+#include "trackLog.hpp"
+#include <cstdio>
+#include <cstring>
+
+static const char trackHeader[] = "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n"
+                                  "<gpx\n"
+                                  " version=\"1.0\"\n"
+                                  " creator=\"IceNav\"\n"
+                                  " xmlns:xsi=\"http://www.w3.org/2001/XMLSchema-instance\"\n"
+                                  " xmlns=\"http://www.topografix.com/GPX/1/0\"\n"
+                                  " xsi:schemaLocation=\"http://www.topografix.com/GPX/1/0 http://www.topografix.com/GPX/1/0/gpx.xsd\">\n"
+                                  "<trk>\n"
+                                  "<name>%s</name>\n"
+                                  "<trkseg>\n";
+static const char trackSegment[] = "</trkseg>\n<trkseg>\n";
+static const char trackTail[] = "</trkseg>\n</trk>\n</gpx>\n";
+static constexpr size_t TRACK_TAIL_LEN = sizeof(trackTail) - 1;
+
+/**
+ * @brief TrackLog constructor
+ */
+TrackLog::TrackLog() : points(0), dropped(0), fileSize(0), lastFlushMs(0), ring(nullptr), ringMask(0),
+                       head(0), tail(0), carry{}, carryLen(0), batchData(0), batchBody(0), batchOut(nullptr)
+{
+}
+
+/**
+ * @brief Attach the line ring storage
+ *
+ * @param ringBuffer Ring storage (PSRAM on the device)
+ * @param ringSize Ring size in bytes, a power of two
+ * @return true if the ring size is valid
+ */
+bool TrackLog::init(char *ringBuffer, size_t ringSize)
+{
+    if (!ringBuffer || ringSize < 2 * MAX_LINE || (ringSize & (ringSize - 1)) != 0)
+        return false;
+
+    ring = ringBuffer;
+    ringMask = ringSize - 1;
+    return true;
+}
+
+/**
+ * @brief Start a new track file, queueing the GPX header
+ *
+ * @details Must be called before the producer starts feeding fixes.
+ *
+ * @param trackName Track name written in the <name> element
+ */
+void TrackLog::begin(const char *trackName)
+{
+    head.store(0);
+    tail.store(0);
+    points = 0;
+    dropped = 0;
+    fileSize = 0;
+    lastFlushMs = 0;
+    carryLen = 0;
+    batchData = 0;
+    batchBody = 0;
+
+    char header[sizeof(trackHeader) + 64];
+    int len = snprintf(header, sizeof(header), trackHeader, trackName);
+    if (len > 0)
+        push(header, (size_t)len < sizeof(header) ? len : sizeof(header) - 1);
+}
+
+/**
+ * @brief Queue a fix. Producer side, never blocks.
+ *
+ * @param fix Fix to log
+ * @return true if queued, false if the ring is full (the fix is counted as dropped)
+ */
+bool TrackLog::addFix(const TrackFix &fix)
+{
+    char line[MAX_LINE];
+    size_t len = formatFix(line, sizeof(line), fix);
+    if (len == 0 || !push(line, len))
+    {
+        dropped++;
+        return false;
+    }
+    points++;
+    return true;
+}
+
+/**
+ * @brief Close the current track segment and open a new one. Producer side.
+ *
+ * @return true if queued
+ */
+bool TrackLog::newSegment()
+{
+    return push(trackSegment, sizeof(trackSegment) - 1);
+}
+
+/**
+ * @brief Append whole lines to the ring. Producer side.
+ *
+ * @param data Lines to append
+ * @param len Length in bytes
+ * @return true if there was room for all of them
+ */
+bool TrackLog::push(const char *data, size_t len)
+{
+    if (!ring)
+        return false;
+
+    const uint32_t h = head.load(std::memory_order_relaxed);
+    const uint32_t t = tail.load(std::memory_order_acquire);
+    if (ringMask + 1 - (h - t) < len)
+        return false;
+
+    const size_t start = h & ringMask;
+    const size_t first = (len < ringMask + 1 - start) ? len : ringMask + 1 - start;
+    memcpy(ring + start, data, first);
+    memcpy(ring, data + first, len - first);
+    head.store(h + (uint32_t)len, std::memory_order_release);
+    return true;
+}
+
+/**
+ * @brief Copy queued bytes without consuming them. Consumer side.
+ *
+ * @param out Destination
+ * @param len Bytes to copy, at most pending()
+ * @return Bytes copied
+ */
+size_t TrackLog::peek(uint8_t *out, size_t len) const
+{
+    const size_t start = tail.load(std::memory_order_relaxed) & ringMask;
+    const size_t first = (len < ringMask + 1 - start) ? len : ringMask + 1 - start;
+    memcpy(out, ring + start, first);
+    memcpy(out + first, ring, len - first);
+    return len;
+}
+
+/**
+ * @brief Get the queued bytes not yet on the card
+ *
+ * @return Queued bytes
+ */
+size_t TrackLog::pending() const
+{
+    return head.load(std::memory_order_acquire) - tail.load(std::memory_order_relaxed);
+}
+
+/**
+ * @brief Check if the writer should flush
+ *
+ * @param nowMs Current time (ms)
+ * @param batchBytes Flush as soon as this many bytes are queued
+ * @param intervalMs Flush anything queued after this time since the last flush
+ * @return true if a batch should be written
+ */
+bool TrackLog::shouldFlush(uint32_t nowMs, size_t batchBytes, uint32_t intervalMs) const
+{
+    const size_t queued = pending();
+    return queued >= batchBytes || (queued > 0 && nowMs - lastFlushMs >= intervalMs);
+}
+
+/**
+ * @brief Build the next write. Consumer side.
+ *
+ * @details The batch is written at fileOffset, which is always sector aligned: it
+ *          rewrites the partial last sector, appends the queued lines (whole lines only)
+ *          and the closing tags. Unless final, blanks pad it to whole sectors so the card
+ *          never does a read-modify-write; trailing whitespace after </gpx> is valid XML.
+ *          The lines stay queued until commit(), so a failed write can be retried.
+ *
+ * @param out Batch buffer, at least 2 * SECTOR_SIZE + MAX_LINE bytes
+ * @param capacity Size of out
+ * @param final Last batch: no padding, the file must be truncated to offset + length
+ * @param fileOffset Output file offset to write the batch at
+ * @return Batch length in bytes, 0 if out is too small
+ */
+size_t TrackLog::buildBatch(uint8_t *out, size_t capacity, bool final, uint32_t &fileOffset)
+{
+    const size_t reserve = carryLen + TRACK_TAIL_LEN + SECTOR_SIZE;
+    if (capacity < reserve + MAX_LINE)
+        return 0;
+
+    fileOffset = fileSize - (uint32_t)carryLen;
+    memcpy(out, carry, carryLen);
+
+    const size_t queued = pending();
+    size_t len = peek(out + carryLen, queued < capacity - reserve ? queued : capacity - reserve);
+    if (len < queued)
+    {
+        // Cut at the last complete line
+        while (len > 0 && out[carryLen + len - 1] != '\n')
+            len--;
+    }
+
+    batchData = len;
+    batchBody = carryLen + len;
+    batchOut = out;
+
+    size_t total = batchBody;
+    memcpy(out + total, trackTail, TRACK_TAIL_LEN);
+    total += TRACK_TAIL_LEN;
+
+    if (!final && (total % SECTOR_SIZE) != 0)
+    {
+        const size_t padded = (total + SECTOR_SIZE - 1) & ~(SECTOR_SIZE - 1);
+        memset(out + total, ' ', padded - total);
+        out[padded - 1] = '\n';
+        total = padded;
+    }
+
+    return total;
+}
+
+/**
+ * @brief Mark the last built batch as written. Consumer side.
+ *
+ * @param nowMs Current time (ms)
+ */
+void TrackLog::commit(uint32_t nowMs)
+{
+    tail.store(tail.load(std::memory_order_relaxed) + (uint32_t)batchData, std::memory_order_release);
+    fileSize += (uint32_t)batchData;
+    carryLen = fileSize % SECTOR_SIZE;
+    memcpy(carry, batchOut + batchBody - carryLen, carryLen);
+    batchData = 0;
+    lastFlushMs = nowMs;
+}
+
+/**
+ * @brief Format a fix as a GPX 1.0 <trkpt> line
+ *
+ * @param line Output buffer
+ * @param len Output buffer size
+ * @param fix Fix to format
+ * @return Line length, 0 if it does not fit
+ */
+size_t TrackLog::formatFix(char *line, size_t len, const TrackFix &fix)
+{
+    int n = snprintf(line, len, "<trkpt lat=\"%.6f\" lon=\"%.6f\">", fix.lat, fix.lon);
+    if (fix.hasEle)
+        n += snprintf(line + n, n < (int)len ? len - n : 0, "<ele>%.1f</ele>", fix.ele);
+    if (fix.year != 0)
+        n += snprintf(line + n, n < (int)len ? len - n : 0, "<time>%04u-%02u-%02uT%02u:%02u:%02uZ</time>",
+                      fix.year, fix.month, fix.day, fix.hour, fix.minute, fix.second);
+    if (fix.hasSpeed)
+        n += snprintf(line + n, n < (int)len ? len - n : 0, "<speed>%.2f</speed>", fix.speed);
+    if (fix.sats != 0)
+        n += snprintf(line + n, n < (int)len ? len - n : 0, "<sat>%u</sat>", fix.sats);
+    if (fix.hasHdop)
+        n += snprintf(line + n, n < (int)len ? len - n : 0, "<hdop>%.1f</hdop>", fix.hdop);
+    n += snprintf(line + n, n < (int)len ? len - n : 0, "</trkpt>\n");
+
+    return (n > 0 && n < (int)len) ? (size_t)n : 0;
+}
@@ -0,0 +1,88 @@
+/**
+ * @file trackLog.hpp
+ * @author Jordi Gauchía (jgauchia@jgauchia.com)
+ * @brief  GPX track log buffer - lock-free fix queue and sector-aligned batch builder
+ * @version 0.2.5
+ * @date 2026-04
+ *
+ * Platform independent core of the track recorder, also built by tools/track_bench.
+ *
+ * The producer (GPS task) formats each fix as a <trkpt> line and appends it to a
+ * single-producer/single-consumer byte ring, never blocking. The consumer (writer
+ * task) builds batches that start on a sector boundary: the partial last sector
+ * already on the card, the queued lines and the closing tags, padded with blanks to
+ * a whole number of sectors. After every batch the file on the card is a complete
+ * GPX document, so a power loss costs at most the last unflushed batch.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * @brief Track point to log
+ */
+struct TrackFix
+{
+    float lat;          /**< Latitude (degrees) */
+    float lon;          /**< Longitude (degrees) */
+    float ele;          /**< Elevation (m) */
+    float speed;        /**< Speed (m/s) */
+    float hdop;         /**< Horizontal dilution of precision */
+    uint16_t year;      /**< UTC year, 0 = no time */
+    uint8_t month;      /**< UTC month */
+    uint8_t day;        /**< UTC day */
+    uint8_t hour;       /**< UTC hour */
+    uint8_t minute;     /**< UTC minute */
+    uint8_t second;     /**< UTC second */
+    uint8_t sats;       /**< Satellites used */
+    bool hasEle;        /**< Elevation is valid */
+    bool hasSpeed;      /**< Speed is valid */
+    bool hasHdop;       /**< HDOP is valid */
+};
+
+/**
+ * @class TrackLog
+ * @brief Fix queue and batch builder for the GPX track recorder
+ */
+class TrackLog
+{
+public:
+    static constexpr size_t SECTOR_SIZE = 512;     /**< Card sector size */
+    static constexpr size_t MAX_LINE = 256;        /**< Longest queued line */
+
+    TrackLog();
+    bool init(char *ringBuffer, size_t ringSize);
+    void begin(const char *trackName);
+
+    bool addFix(const TrackFix &fix);
+    bool newSegment();
+
+    size_t pending() const;
+    bool shouldFlush(uint32_t nowMs, size_t batchBytes, uint32_t intervalMs) const;
+    size_t buildBatch(uint8_t *out, size_t capacity, bool final, uint32_t &fileOffset);
+    void commit(uint32_t nowMs);
+
+    static size_t formatFix(char *line, size_t len, const TrackFix &fix);
+
+    uint32_t points;        /**< Fixes queued */
+    uint32_t dropped;       /**< Fixes dropped because the ring was full */
+    uint32_t fileSize;      /**< Committed GPX body size, without the closing tags */
+    uint32_t lastFlushMs;   /**< Time of the last commit */
+
+private:
+    bool push(const char *data, size_t len);
+    size_t peek(uint8_t *out, size_t len) const;
+
+    char *ring;                      /**< Line ring storage */
+    size_t ringMask;                 /**< Ring size - 1, size is a power of two */
+    std::atomic<uint32_t> head;      /**< Write position, owned by the producer */
+    std::atomic<uint32_t> tail;      /**< Read position, owned by the consumer */
+    uint8_t carry[SECTOR_SIZE];      /**< Bytes of the last partial sector on the card */
+    size_t carryLen;                 /**< Valid bytes in carry */
+    size_t batchData;                /**< Ring bytes in the last built batch */
+    size_t batchBody;                /**< Body bytes (carry + ring data) in the last built batch */
+    const uint8_t *batchOut;         /**< Last built batch */
+};
@@ -0,0 +1,270 @@
+/**
+ * @file trackProfile.cpp
+ * @author Jordi Gauchía (jgauchia@jgauchia.com)
+ * @brief  Min/max pyramid of a track value over distance, for profile plots
+ * @version 0.2.5
+ * @date 2026-04
+ */
+
+#include "trackProfile.hpp"
+#include <algorithm>
+#include <cmath>
+
+/**
+ * @brief Widen a span to hold a value
+ */
+static inline void include(ProfileSpan &span, float value)
+{
+    span.min = std::min(span.min, value);
+    span.max = std::max(span.max, value);
+}
+
+/**
+ * @brief Widen a span to hold another one
+ */
+static inline void include(ProfileSpan &span, const ProfileSpan &other)
+{
+    span.min = std::min(span.min, other.min);
+    span.max = std::max(span.max, other.max);
+}
+
+static const ProfileSpan EMPTY_SPAN = {INFINITY, -INFINITY};
+
+/**
+ * @brief First point from start whose distance is over d (or at least d), by doubling steps
+ *
+ * @details Costs the logarithm of the points skipped, not of the track length.
+ */
+static size_t gallop(const float *dist, size_t start, size_t count, float d, bool over)
+{
+    auto before = [&](size_t i) { return over ? dist[i] <= d : dist[i] < d; };
+    if (start >= count || !before(start))
+        return start;
+    size_t step = 1, lo = start;
+    while (lo + step < count && before(lo + step))
+    {
+        lo += step;
+        step *= 2;
+    }
+    const size_t hi = std::min(count, lo + step);
+    return over ? std::upper_bound(dist + lo + 1, dist + hi, d) - dist
+                : std::lower_bound(dist + lo + 1, dist + hi, d) - dist;
+}
+
+TrackProfile::TrackProfile() : dist(nullptr), values(nullptr), count(0) {}
+
+/**
+ * @brief Build the pyramid of a track value
+ *
+ * @details The columns must not change while the profile is used, clear() it before
+ *          the track is replaced.
+ *
+ * @param dist Cumulative distances (m), not decreasing
+ * @param values Value of each point, same size
+ */
+void TrackProfile::build(const TrackColumn &dist, const TrackColumn &values)
+{
+    clear();
+    if (dist.empty() || dist.size() != values.size())
+        return;
+    this->dist = dist.data();
+    this->values = values.data();
+    count = dist.size();
+
+    // Level 0 from the points, each next level from the previous one, up to a single block
+    size_t units = count;
+    while (units > 1)
+    {
+        const size_t blocks = (units + FANOUT - 1) / FANOUT;
+        SpanLevel level;
+        level.reserve(blocks);
+        for (size_t b = 0; b < blocks; b++)
+        {
+            ProfileSpan span = EMPTY_SPAN;
+            const size_t end = std::min(units, (b + 1) * FANOUT);
+            for (size_t i = b * FANOUT; i < end; i++)
+            {
+                if (levels.empty())
+                    include(span, this->values[i]);
+                else
+                    include(span, levels.back()[i]);
+            }
+            level.push_back(span);
+        }
+        levels.push_back(std::move(level));
+        units = blocks;
+    }
+}
+
+/**
+ * @brief Drop the profile
+ */
+void TrackProfile::clear()
+{
+    levels.clear();
+    levels.shrink_to_fit();
+    dist = nullptr;
+    values = nullptr;
+    count = 0;
+}
+
+/**
+ * @brief Check if a profile is built
+ */
+bool TrackProfile::empty() const
+{
+    return count == 0;
+}
+
+/**
+ * @brief Track length (m)
+ */
+float TrackProfile::length() const
+{
+    return count ? dist[count - 1] : 0.0f;
+}
+
+/**
+ * @brief Min and max of the whole track
+ */
+ProfileSpan TrackProfile::range() const
+{
+    if (count == 0)
+        return {NAN, NAN};
+    return levels.empty() ? ProfileSpan{values[0], values[0]} : levels.back()[0];
+}
+
+/**
+ * @brief Number of pyramid levels
+ */
+uint32_t TrackProfile::levelCount() const
+{
+    return (uint32_t)levels.size();
+}
+
+/**
+ * @brief PSRAM used by the pyramid (bytes)
+ */
+size_t TrackProfile::memoryBytes() const
+{
+    size_t bytes = 0;
+    for (const SpanLevel &level : levels)
+        bytes += level.capacity() * sizeof(ProfileSpan);
+    return bytes;
+}
+
+/**
+ * @brief Value at a distance on the segment ending at point i
+ */
+float TrackProfile::interpolate(size_t i, float d) const
+{
+    if (i == 0)
+        return values[0];
+    const float segment = dist[i] - dist[i - 1];
+    if (segment <= 0.0f)
+        return values[i];
+    const float t = (d - dist[i - 1]) / segment;
+    return values[i - 1] + (values[i] - values[i - 1]) * t;
+}
+
+/**
+ * @brief Value at a distance, interpolated between the points around it
+ *
+ * @param d Distance from the start (m)
+ * @return Value, NAN outside the track
+ */
+float TrackProfile::valueAt(float d) const
+{
+    if (count == 0 || d < 0.0f || d > dist[count - 1])
+        return NAN;
+    const size_t i = std::lower_bound(dist, dist + count, d) - dist;
+    return interpolate(i, d);
+}
+
+/**
+ * @brief Min and max of the points first to last (inclusive)
+ *
+ * @details Walks up the pyramid: the points and blocks before the first whole block of
+ *          the next level and after the last one are read at this level, the rest above.
+ */
+ProfileSpan TrackProfile::spanOf(size_t first, size_t last) const
+{
+    ProfileSpan span = EMPTY_SPAN;
+    size_t lo = first, hi = last + 1;
+    for (int level = -1; lo < hi; level++)
+    {
+        auto unit = [&](size_t u) {
+            if (level < 0)
+                include(span, values[u]);
+            else
+                include(span, levels[level][u]);
+        };
+        if (level + 1 >= (int)levels.size())
+        {
+            for (size_t u = lo; u < hi; u++)
+                unit(u);
+            break;
+        }
+        while (lo < hi && lo % FANOUT != 0)
+            unit(lo++);
+        while (hi > lo && hi % FANOUT != 0)
+            unit(--hi);
+        lo /= FANOUT;
+        hi /= FANOUT;
+    }
+    return span;
+}
+
+/**
+ * @brief Min and max per column of a distance window
+ *
+ * @details Column c covers the distances from fromDist + c * w to fromDist + (c + 1) * w,
+ *          w = (toDist - fromDist) / columns. It holds the points inside and the values
+ *          interpolated at both edges, so consecutive columns join even when zoomed in
+ *          between two points. Columns off the track are NAN.
+ *
+ * @param fromDist Window start (m)
+ * @param toDist Window end (m)
+ * @param columns Columns (pixels)
+ * @param out Columns result
+ * @return Columns with values
+ */
+size_t TrackProfile::query(float fromDist, float toDist, size_t columns, ProfileSpan *out) const
+{
+    if (count == 0 || columns == 0 || !(toDist > fromDist))
+    {
+        for (size_t c = 0; c < columns; c++)
+            out[c] = {NAN, NAN};
+        return 0;
+    }
+
+    const float width = (toDist - fromDist) / columns;
+    const float end = dist[count - 1];
+    size_t filled = 0;
+    size_t next = 0;        // First point at or after the column start
+    for (size_t c = 0; c < columns; c++)
+    {
+        const float a = fromDist + c * width;
+        const float b = c + 1 == columns ? toDist : a + width;
+        if (b < 0.0f || a > end)
+        {
+            out[c] = {NAN, NAN};
+            continue;
+        }
+
+        // Points only move forward from one column to the next
+        next = gallop(dist, next, count, a, false);
+        const size_t after = gallop(dist, next, count, b, true);
+
+        ProfileSpan span = EMPTY_SPAN;
+        if (after > next)
+            span = spanOf(next, after - 1);
+        if (a >= 0.0f)
+            include(span, interpolate(next < count ? next : count - 1, a));
+        if (b <= end && after < count)
+            include(span, interpolate(after, b));
+        out[c] = span;
+        filled++;
+    }
+    return filled;
+}
@@ -0,0 +1,68 @@
+/**
+ * @file trackProfile.hpp
+ * @author Jordi Gauchía (jgauchia@jgauchia.com)
+ * @brief  Min/max pyramid of a track value over distance, for profile plots
+ * @version 0.2.5
+ * @date 2026-04
+ *
+ * Platform independent, also built by tools/track_profile.
+ *
+ * A profile is built once per track from a value column (elevation, or any value per
+ * point) and the cumulative distances. Level 0 keeps the min and max of each block of
+ * FANOUT points, and each next level those of FANOUT blocks of the previous one, less
+ * than a third of the size of the values column in PSRAM. A plot asks for the min and
+ * max of the distance range of each pixel column: the points of a column are searched
+ * after those of the previous one, and their min and max are read from at most
+ * 2 * (FANOUT - 1) entries per level. The cost grows with the columns drawn and only
+ * with the logarithm of the points per column, not with the track length.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "globalGpxDef.h"
+
+/**
+ * @brief Min and max of the values in a distance range
+ */
+struct ProfileSpan
+{
+    float min;      /**< Lowest value, NAN where the track has no points */
+    float max;      /**< Highest value, NAN where the track has no points */
+};
+
+/**
+ * @class TrackProfile
+ * @brief Multi-level min/max decimation of a track value over distance
+ */
+class TrackProfile
+{
+public:
+    static constexpr size_t FANOUT = 8;     /**< Points or blocks merged per block */
+
+    TrackProfile();
+
+    void build(const TrackColumn &dist, const TrackColumn &values);
+    void clear();
+    bool empty() const;
+    float length() const;
+    ProfileSpan range() const;
+    float valueAt(float d) const;
+    size_t query(float fromDist, float toDist, size_t columns, ProfileSpan *out) const;
+    size_t memoryBytes() const;
+
+    uint32_t levelCount() const;
+
+private:
+    typedef std::vector<ProfileSpan, PsramAllocator<ProfileSpan>> SpanLevel;
+
+    const float *dist;          /**< Cumulative distances of the track */
+    const float *values;        /**< Values of the track */
+    size_t count;               /**< Track points */
+    std::vector<SpanLevel> levels;  /**< levels[k] holds blocks of FANOUT^(k+1) points */
+
+    ProfileSpan spanOf(size_t first, size_t last) const;
+    float interpolate(size_t i, float d) const;
+};
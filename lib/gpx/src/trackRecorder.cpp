@@ -0,0 +1,308 @@
+/**
+ * @file trackRecorder.cpp
+ * @author Jordi Gauchía (jgauchia@jgauchia.com)
+ * @brief  GPX track recorder - buffered breadcrumb logging to /sdcard/TRK
+ * @version 0.2.5
+ * @date 2026-04
+ */
+
+#include "trackRecorder.hpp"
+#include "esp_heap_caps.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include <time.h>
+
+extern Storage storage;
+
+TrackRecorder trackRecorder;
+
+static const char* TAG = "TrackRecorder";
+
+static inline uint32_t nowMs() { return (uint32_t)(esp_timer_get_time() / 1000); }
+
+/**
+ * @brief Asynchronous write completion, stores the bytes written
+ */
+static void writeDone(uint32_t id, size_t result, void *arg)
+{
+    *(size_t *)arg = result;
+}
+
+/**
+ * @brief TrackRecorder constructor
+ */
+TrackRecorder::TrackRecorder() : flushes(0), flushErrors(0), bytesWritten(0), maxFlushMs(0), ring(nullptr),
+                                 writeBuf(nullptr), file(nullptr), fileName{}, writerHandle(nullptr),
+                                 writerDone(nullptr), recording(false), stopRequest(false), segmentBreak(false)
+{
+}
+
+/**
+ * @brief Build the track file path
+ *
+ * @details Uses the local date and time once the clock was set from the GPS
+ *          (TRK_YYYYMMDD_HHMMSS.gpx), or the first free TRK_nnn.gpx otherwise.
+ */
+void TrackRecorder::makeFileName()
+{
+    time_t now = time(nullptr);
+    struct tm local;
+    localtime_r(&now, &local);
+
+    if (local.tm_year + 1900 >= 2024)
+    {
+        snprintf(fileName, sizeof(fileName), "%s/TRK_%04d%02d%02d_%02d%02d%02d.gpx", trkFolder,
+                 local.tm_year + 1900, local.tm_mon + 1, local.tm_mday, local.tm_hour, local.tm_min, local.tm_sec);
+        return;
+    }
+
+    for (uint16_t i = 1; i < 1000; i++)
+    {
+        snprintf(fileName, sizeof(fileName), "%s/TRK_%03u.gpx", trkFolder, i);
+        if (!storage.exists(fileName))
+            return;
+    }
+}
+
+/**
+ * @brief Start recording into a new track file
+ *
+ * @return true if recording
+ */
+bool TrackRecorder::start()
+{
+    if (recording || writerHandle)
+        return recording;
+
+    if (!storage.getSdLoaded())
+        return false;
+
+    if (!ring)
+        ring = (char *)heap_caps_malloc(RING_SIZE, MALLOC_CAP_SPIRAM);
+    if (!writeBuf)
+        writeBuf = (uint8_t *)heap_caps_malloc(WRITE_BUF_SIZE, MALLOC_CAP_DMA | MALLOC_CAP_INTERNAL);
+    if (!writerDone)
+        writerDone = xSemaphoreCreateBinary();
+    if (!ring || !writeBuf || !writerDone || !log.init(ring, RING_SIZE))
+    {
+        ESP_LOGE(TAG, "Not enough memory for track recorder");
+        return false;
+    }
+
+    makeFileName();
+    file = storage.open(fileName, "w");
+    if (!file)
+    {
+        ESP_LOGE(TAG, "Can't create %s", fileName);
+        return false;
+    }
+    // Batches are whole sectors, let them reach the FAT layer directly
+    setvbuf(file, nullptr, _IONBF, 0);
+
+    const char *name = strrchr(fileName, '/') + 1;
+    char trackName[32];
+    snprintf(trackName, sizeof(trackName), "%.*s", (int)(strlen(name) - 4), name);
+    log.begin(trackName);
+
+    flushes = 0;
+    flushErrors = 0;
+    bytesWritten = 0;
+    maxFlushMs = 0;
+    segmentBreak = false;
+    stopRequest = false;
+
+    if (xTaskCreatePinnedToCore(writerTask, "TrackWriter", 3072, this, 1, &writerHandle, tskNO_AFFINITY) != pdPASS)
+    {
+        writerHandle = nullptr;
+        storage.close(file);
+        storage.remove(fileName);
+        file = nullptr;
+        return false;
+    }
+
+    recording = true;
+    ESP_LOGI(TAG, "Recording %s", fileName);
+    return true;
+}
+
+/**
+ * @brief Stop recording, flush the queued fixes and finalize the file
+ *
+ * @details Waits up to 5 seconds for the writer. The file is already a valid GPX
+ *          document, the final batch only adds the last fixes and drops the padding.
+ */
+void TrackRecorder::stop()
+{
+    if (!writerHandle)
+        return;
+
+    recording = false;
+    stopRequest = true;
+    if (xSemaphoreTake(writerDone, pdMS_TO_TICKS(5000)) != pdTRUE)
+        ESP_LOGE(TAG, "Track writer did not finish");
+}
+
+/**
+ * @brief Check if a track is being recorded
+ *
+ * @return true if recording
+ */
+bool TrackRecorder::isRecording() const
+{
+    return recording;
+}
+
+/**
+ * @brief Queue a GPS fix. Called from the GPS task, never blocks.
+ *
+ * @details Fixes without location are skipped and open a new track segment.
+ *
+ * @param fix NeoGPS fix
+ */
+void TrackRecorder::addFix(const gps_fix &fix)
+{
+    if (!recording)
+        return;
+
+    if (!fix.valid.location)
+    {
+        segmentBreak = log.points > 0;
+        return;
+    }
+
+    if (segmentBreak && log.newSegment())
+        segmentBreak = false;
+
+    TrackFix point = {};
+    point.lat = fix.latitude();
+    point.lon = fix.longitude();
+    point.hasEle = fix.valid.altitude;
+    point.ele = fix.valid.altitude ? fix.altitude() : 0.0f;
+    point.hasSpeed = fix.valid.speed;
+    point.speed = fix.valid.speed ? fix.speed_kph() / 3.6f : 0.0f;
+    point.hasHdop = fix.valid.hdop;
+    point.hdop = (float)fix.hdop / 1000;
+    point.sats = fix.valid.satellites ? fix.satellites : 0;
+    if (fix.valid.time && fix.valid.date)
+    {
+        point.year = 2000 + fix.dateTime.year;
+        point.month = fix.dateTime.month;
+        point.day = fix.dateTime.date;
+        point.hour = fix.dateTime.hours;
+        point.minute = fix.dateTime.minutes;
+        point.second = fix.dateTime.seconds;
+    }
+
+    log.addFix(point);
+}
+
+/**
+ * @brief Get the fix queue and its counters
+ *
+ * @return Track log
+ */
+const TrackLog &TrackRecorder::getLog() const
+{
+    return log;
+}
+
+/**
+ * @brief Get the path of the current (or last) track file
+ *
+ * @return Track file path
+ */
+const char *TrackRecorder::getFileName() const
+{
+    return fileName;
+}
+
+/**
+ * @brief Write one batch. Runs on the writer task.
+ *
+ * @param final Last batch, written without padding
+ * @return true if the batch is on the card
+ */
+bool TrackRecorder::flush(bool final)
+{
+    uint32_t offset = 0;
+    const size_t len = log.buildBatch(writeBuf, WRITE_BUF_SIZE, final, offset);
+    if (len == 0)
+        return false;
+
+    const uint32_t start = nowMs();
+    size_t written = 0;
+    if (storage.seek(file, offset, SEEK_SET) == 0)
+    {
+        if (storage.submitWrite(file, writeBuf, len, IO_PRIO_BACKGROUND, writeDone, &written, xTaskGetCurrentTaskHandle()) != 0)
+            ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+        else
+            written = storage.write(file, writeBuf, len);
+    }
+
+    if (written != len || storage.sync(file) != 0)
+    {
+        flushErrors++;
+        ESP_LOGE(TAG, "Track batch write failed at %lu", (unsigned long)offset);
+        return false;
+    }
+
+    const uint32_t elapsed = nowMs() - start;
+    if (elapsed > maxFlushMs)
+        maxFlushMs = elapsed;
+    flushes++;
+    bytesWritten += len;
+    log.commit(nowMs());
+
+    if (final)
+    {
+        storage.close(file);
+        file = nullptr;
+        storage.truncate(fileName, offset + len);
+    }
+    return true;
+}
+
+/**
+ * @brief Track writer task
+ *
+ * @details Flushes when BATCH_BYTES are queued or FLUSH_INTERVAL_MS have passed since the
+ *          last batch. On stop it drains the ring, writes the final batch and closes the file.
+ */
+void TrackRecorder::writerTask(void *pvParameters)
+{
+    TrackRecorder *instance = (TrackRecorder *)pvParameters;
+    TrackLog &log = instance->log;
+    log.lastFlushMs = nowMs();
+
+    while (!instance->stopRequest)
+    {
+        vTaskDelay(pdMS_TO_TICKS(POLL_MS));
+        if (log.shouldFlush(nowMs(), BATCH_BYTES, FLUSH_INTERVAL_MS))
+            instance->flush(false);
+    }
+
+    // Drain, then finalize
+    uint8_t retries = 0;
+    while (log.pending() > BATCH_BYTES && retries < 3)
+    {
+        if (!instance->flush(false))
+            retries++;
+    }
+    while (instance->file && retries < 3)
+    {
+        if (!instance->flush(true))
+            retries++;
+    }
+    if (instance->file)
+    {
+        storage.close(instance->file);
+        instance->file = nullptr;
+    }
+
+    ESP_LOGI(TAG, "Track %s closed, %lu points, %lu dropped", instance->fileName,
+             (unsigned long)log.points, (unsigned long)log.dropped);
+
+    instance->writerHandle = nullptr;
+    xSemaphoreGive(instance->writerDone);
+    vTaskDelete(NULL);
+}
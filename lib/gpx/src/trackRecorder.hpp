@@ -0,0 +1,67 @@
+/**
+ * @file trackRecorder.hpp
+ * @author Jordi Gauchía (jgauchia@jgauchia.com)
+ * @brief  GPX track recorder - buffered breadcrumb logging to /sdcard/TRK
+ * @version 0.2.5
+ * @date 2026-04
+ */
+
+#pragma once
+
+#include <NMEAGPS.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+#include "freertos/task.h"
+#include "globalGpxDef.h"
+#include "storage.hpp"
+#include "trackLog.hpp"
+
+/**
+ * @class TrackRecorder
+ * @brief Records GPS fixes into a GPX track file
+ *
+ * @details The GPS task queues each fix into a PSRAM ring (TrackLog) without blocking.
+ *          A low priority writer task flushes the ring in sector-aligned batches through
+ *          the background priority of the asynchronous I/O queue, so map reads are served
+ *          first. The file is a complete GPX document after every batch.
+ */
+class TrackRecorder
+{
+    public:
+        TrackRecorder();
+        bool start();
+        void stop();
+        bool isRecording() const;
+        void addFix(const gps_fix &fix);
+        const TrackLog &getLog() const;
+        const char *getFileName() const;
+
+        uint32_t flushes;       /**< Batches written */
+        uint32_t flushErrors;   /**< Batches that failed and were retried */
+        uint32_t bytesWritten;  /**< Bytes written to the card, padding included */
+        uint32_t maxFlushMs;    /**< Slowest batch write (ms) */
+
+    private:
+        static constexpr size_t RING_SIZE = 32768;          /**< Fix ring in PSRAM */
+        static constexpr size_t BATCH_BYTES = 4096;         /**< Queued bytes that trigger a flush */
+        static constexpr size_t WRITE_BUF_SIZE = 8192;      /**< Batch buffer, internal RAM */
+        static constexpr uint32_t FLUSH_INTERVAL_MS = 10000; /**< Longest time a fix stays queued */
+        static constexpr uint32_t POLL_MS = 250;            /**< Writer poll period */
+
+        TrackLog log;                    /**< Fix queue and batch builder */
+        char *ring;                      /**< Ring storage */
+        uint8_t *writeBuf;               /**< Batch buffer */
+        FILE *file;                      /**< Open track file */
+        char fileName[64];               /**< Track file path */
+        TaskHandle_t writerHandle;       /**< Writer task */
+        SemaphoreHandle_t writerDone;    /**< Given by the writer when the file is closed */
+        volatile bool recording;         /**< Fixes are being logged */
+        volatile bool stopRequest;       /**< Writer must finalize the file */
+        bool segmentBreak;               /**< Fix was lost, start a new segment on the next one */
+
+        void makeFileName();
+        bool flush(bool final);
+        static void writerTask(void *pvParameters);
+};
+
+extern TrackRecorder trackRecorder;
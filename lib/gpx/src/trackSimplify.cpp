@@ -0,0 +1,194 @@
+/**
+ * @file trackSimplify.cpp
+ * @author Jordi Gauchía (jgauchia@jgauchia.com)
+ * @brief  Douglas-Peucker track simplification for navigation and drawing
+ * @version 0.2.5
+ * @date 2026-04
+ */
+
+#include "trackSimplify.hpp"
+#include <algorithm>
+#include <cmath>
+#include <utility>
+#include "gpsMath.hpp"
+
+/**
+ * @brief Meters per degree of latitude
+ */
+static constexpr float METERS_PER_DEG = EARTH_RADIUS * M_PI / 180.0f;
+
+/**
+ * @brief Longitude difference wrapped to [-180, 180]
+ */
+static inline float wrapLon(float dLon)
+{
+    if (dLon > 180.0f)
+        return dLon - 360.0f;
+    if (dLon < -180.0f)
+        return dLon + 360.0f;
+    return dLon;
+}
+
+/**
+ * @brief Point of the range (first, last) farthest from the chord first-last
+ *
+ * @details Distances to the chord segment, in a local plane at the first point.
+ *
+ * @param full Full track
+ * @param first Range start
+ * @param last Range end
+ * @param maxDistSq Output, squared distance (m^2) of the farthest point
+ * @return Index of the farthest point
+ */
+static size_t farthestPoint(const TrackVector &full, size_t first, size_t last, float &maxDistSq)
+{
+    const float lat0 = full.lat[first];
+    const float lon0 = full.lon[first];
+    const float kx = METERS_PER_DEG * cosf(DEG2RAD(lat0));
+    const float ky = METERS_PER_DEG;
+    const float bx = wrapLon(full.lon[last] - lon0) * kx;
+    const float by = (full.lat[last] - lat0) * ky;
+    const float lenSq = bx * bx + by * by;
+    const float invLenSq = lenSq > 0.0f ? 1.0f / lenSq : 0.0f;
+
+    size_t farthest = first + 1;
+    maxDistSq = -1.0f;
+    for (size_t i = first + 1; i < last; i++)
+    {
+        const float px = wrapLon(full.lon[i] - lon0) * kx;
+        const float py = (full.lat[i] - lat0) * ky;
+        float t = (px * bx + py * by) * invLenSq;
+        t = t < 0.0f ? 0.0f : (t > 1.0f ? 1.0f : t);
+        const float dx = px - t * bx;
+        const float dy = py - t * by;
+        const float distSq = dx * dx + dy * dy;
+        if (distSq > maxDistSq)
+        {
+            maxDistSq = distSq;
+            farthest = i;
+        }
+    }
+    return farthest;
+}
+
+/**
+ * @brief Simplify a track with the Douglas-Peucker algorithm
+ *
+ * @details Iterative, the range stack lives in the heap. A range is split at its farthest
+ *          point while that point is over the tolerance, or at its middle distance while
+ *          it is longer than maxSpacing. The first and last points are always kept.
+ *
+ * @param full Full track, with cumulative distances
+ * @param params Tolerance and max spacing
+ * @param nav Output, simplified track
+ * @param navToFull Output, full track index of each simplified point
+ * @return Simplified points
+ */
+size_t simplifyTrack(const TrackVector &full, const SimplifyParams &params, TrackVector &nav, TrackIndexMap &navToFull)
+{
+    nav.clear();
+    navToFull.clear();
+    const size_t n = full.size();
+    if (n == 0)
+        return 0;
+
+    if (params.tolerance <= 0.0f)
+    {
+        nav = full;
+        navToFull.resize(n);
+        for (size_t i = 0; i < n; i++)
+            navToFull[i] = (uint32_t)i;
+        return n;
+    }
+
+    const float toleranceSq = params.tolerance * params.tolerance;
+    navToFull.push_back(0);
+
+    // Ranges are popped left to right, so the kept ends come out in track order
+    std::vector<std::pair<uint32_t, uint32_t>> ranges;
+    if (n > 1)
+        ranges.push_back({0, (uint32_t)(n - 1)});
+    while (!ranges.empty())
+    {
+        const size_t first = ranges.back().first;
+        const size_t last = ranges.back().second;
+        ranges.pop_back();
+
+        size_t split = 0;
+        if (last - first > 1)
+        {
+            float maxDistSq;
+            const size_t farthest = farthestPoint(full, first, last, maxDistSq);
+            if (maxDistSq > toleranceSq)
+                split = farthest;
+            else if (params.maxSpacing > 0.0f && full.accumDist[last] - full.accumDist[first] > params.maxSpacing)
+            {
+                const float middle = (full.accumDist[first] + full.accumDist[last]) * 0.5f;
+                split = std::lower_bound(full.accumDist.begin() + first + 1, full.accumDist.begin() + last, middle) -
+                        full.accumDist.begin();
+                split = std::min(split, last - 1);
+            }
+        }
+
+        if (split == 0)
+        {
+            navToFull.push_back((uint32_t)last);
+            continue;
+        }
+        ranges.push_back({(uint32_t)split, (uint32_t)last});
+        ranges.push_back({(uint32_t)first, (uint32_t)split});
+    }
+
+    const size_t kept = navToFull.size();
+    nav.resize(kept);
+    for (size_t i = 0; i < kept; i++)
+    {
+        const uint32_t idx = navToFull[i];
+        nav.lat[i] = full.lat[idx];
+        nav.lon[i] = full.lon[idx];
+        nav.ele[i] = full.ele[idx];
+        nav.accumDist[i] = full.accumDist[idx];
+    }
+    navToFull.shrink_to_fit();
+    return kept;
+}
+
+/**
+ * @brief Simplified point at or before a full track point
+ *
+ * @param navToFull Map from simplifyTrack
+ * @param fullIdx Full track index
+ * @return Index of the last simplified point whose full index is not greater than fullIdx
+ */
+size_t fullToNavIdx(const TrackIndexMap &navToFull, size_t fullIdx)
+{
+    const auto it = std::upper_bound(navToFull.begin(), navToFull.end(), (uint32_t)fullIdx);
+    return it == navToFull.begin() ? 0 : (size_t)(it - navToFull.begin()) - 1;
+}
+
+/**
+ * @brief Move turns detected on the full track to the nearest simplified point
+ *
+ * @details The turn angle and its full track distance are kept. Turns stay in track order,
+ *          two close turns can land on the same simplified point.
+ *
+ * @param nav Simplified track
+ * @param navToFull Map from simplifyTrack
+ * @param turns Turns with full track indices, replaced with simplified track indices
+ */
+void turnsToNav(const TrackVector &nav, const TrackIndexMap &navToFull, std::vector<TurnPoint> &turns)
+{
+    if (nav.empty())
+    {
+        turns.clear();
+        return;
+    }
+
+    for (TurnPoint &turn : turns)
+    {
+        size_t idx = fullToNavIdx(navToFull, (size_t)turn.idx);
+        if (idx + 1 < nav.size() && nav.accumDist[idx + 1] - turn.distance < turn.distance - nav.accumDist[idx])
+            idx++;
+        turn.idx = (int)idx;
+    }
+}
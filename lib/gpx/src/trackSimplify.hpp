@@ -0,0 +1,42 @@
+/**
+ * @file trackSimplify.hpp
+ * @author Jordi Gauchía (jgauchia@jgauchia.com)
+ * @brief  Douglas-Peucker track simplification for navigation and drawing
+ * @version 0.2.5
+ * @date 2026-04
+ *
+ * Platform independent, also built by tools/track_simplify.
+ *
+ * Recorded tracks often have a point every meter or two. Navigation and drawing run on
+ * a simplified copy that keeps the points needed to stay within a
+ * cross-track tolerance of the full track, plus a point at least every maxSpacing
+ * meters along the track. The simplified points keep the elevation and cumulative
+ * distance of their full track point, and a map gives the full track index of each
+ * one, so distance and elevation statistics still use the full data. Turns are detected
+ * on the full track and moved to the nearest simplified point.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "globalGpxDef.h"
+
+/**
+ * @brief Full track index of each simplified point, increasing
+ */
+typedef std::vector<uint32_t, PsramAllocator<uint32_t>> TrackIndexMap;
+
+/**
+ * @brief Simplification settings
+ */
+struct SimplifyParams
+{
+    float tolerance;        /**< Max distance (m) from a dropped point to the simplified track, 0 keeps all points */
+    float maxSpacing;       /**< Max distance (m) along the track between kept points, 0 for no limit */
+};
+
+size_t simplifyTrack(const TrackVector &full, const SimplifyParams &params, TrackVector &nav, TrackIndexMap &navToFull);
+size_t fullToNavIdx(const TrackIndexMap &navToFull, size_t fullIdx);
+void turnsToNav(const TrackVector &nav, const TrackIndexMap &navToFull, std::vector<TurnPoint> &turns);
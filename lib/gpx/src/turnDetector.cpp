@@ -0,0 +1,182 @@
+/**
+ * @file turnDetector.cpp
+ * @author Jordi Gauchía (jgauchia@jgauchia.com)
+ * @brief  Background turn detection of the loaded track
+ * @version 0.2.5
+ * @date 2026-04
+ */
+
+#include "turnDetector.hpp"
+#include "esp_log.h"
+#include "esp_timer.h"
+
+TurnDetector turnDetector;
+
+static const char* TAG = "TurnDetector";
+
+/**
+ * @brief TurnDetector constructor
+ */
+TurnDetector::TurnDetector() : nav(nullptr), navToFull(nullptr), taskHandle(nullptr), taskDone(nullptr), resultMutex(nullptr), resultReady(false),
+                               cancelRequest(false), progress(0), generation(0), collected(0)
+{
+}
+
+/**
+ * @brief Start detecting the turns of a track
+ *
+ * @details A running scan is cancelled first. The tracks must not change until the scan
+ *          is done or cancel() returns.
+ *
+ * @param track Loaded track
+ * @param params Thresholds
+ * @param nav Simplified copy of the track, the turns get its indices (nullptr for the track ones)
+ * @param navToFull Map from simplifyTrack between nav and track
+ * @return true if the task was started
+ */
+bool TurnDetector::start(const TrackVector &track, const TurnParams &params, const TrackVector *nav,
+                         const TrackIndexMap *navToFull)
+{
+    cancel();
+
+    if (!taskDone)
+        taskDone = xSemaphoreCreateBinary();
+    if (!resultMutex)
+        resultMutex = xSemaphoreCreateMutex();
+    if (!taskDone || !resultMutex)
+        return false;
+
+    xSemaphoreTake(resultMutex, portMAX_DELAY);
+    result.clear();
+    resultReady = false;
+    xSemaphoreGive(resultMutex);
+
+    scan.begin(track, params);
+    this->nav = nav;
+    this->navToFull = navToFull;
+    progress = 0;
+    generation = generation + 1;
+    cancelRequest = false;
+
+    if (xTaskCreatePinnedToCore(detectorTask, "TurnDetector", 4096, this, 1, &taskHandle, tskNO_AFFINITY) != pdPASS)
+    {
+        taskHandle = nullptr;
+        ESP_LOGE(TAG, "Can't start turn detector");
+        return false;
+    }
+    return true;
+}
+
+/**
+ * @brief Stop a running scan and drop its result
+ *
+ * @details Blocks until the task has stopped, call it before the track is cleared.
+ */
+void TurnDetector::cancel()
+{
+    if (taskHandle)
+    {
+        cancelRequest = true;
+        xSemaphoreTake(taskDone, portMAX_DELAY);
+    }
+
+    if (resultMutex)
+    {
+        xSemaphoreTake(resultMutex, portMAX_DELAY);
+        result.clear();
+        resultReady = false;
+        xSemaphoreGive(resultMutex);
+    }
+}
+
+/**
+ * @brief Hand over the turns of a finished scan, called from the main loop
+ *
+ * @details The turns of the previous track are dropped as soon as a new scan starts.
+ *
+ * @param turns Cleared when a new scan started, replaced with the detected turns when
+ *              a result is ready
+ * @return true if turns changed
+ */
+bool TurnDetector::collect(std::vector<TurnPoint> &turns)
+{
+    bool changed = false;
+    if (collected != generation)
+    {
+        collected = generation;
+        turns.clear();
+        changed = true;
+    }
+
+    if (!resultReady || !resultMutex)
+        return changed;
+
+    xSemaphoreTake(resultMutex, portMAX_DELAY);
+    if (resultReady)
+    {
+        turns.swap(result);
+        result.clear();
+        resultReady = false;
+        changed = true;
+    }
+    xSemaphoreGive(resultMutex);
+    return changed;
+}
+
+/**
+ * @brief Check if a scan is running
+ *
+ * @return true if running
+ */
+bool TurnDetector::isRunning() const
+{
+    return taskHandle != nullptr;
+}
+
+/**
+ * @brief Progress of the running or last scan
+ *
+ * @return Progress (0-100)
+ */
+uint8_t TurnDetector::getProgress() const
+{
+    return progress;
+}
+
+/**
+ * @brief Turn detector task
+ *
+ * @details Scans STEP_POINTS points at a time and yields between steps. A cancelled scan
+ *          publishes nothing.
+ */
+void TurnDetector::detectorTask(void *pvParameters)
+{
+    TurnDetector *instance = (TurnDetector *)pvParameters;
+    TurnScan &scan = instance->scan;
+    const int64_t start = esp_timer_get_time();
+
+    while (!instance->cancelRequest && !scan.step(STEP_POINTS))
+    {
+        instance->progress = scan.progress();
+        vTaskDelay(1);
+    }
+
+    if (!instance->cancelRequest)
+    {
+        if (instance->nav && instance->navToFull)
+            turnsToNav(*instance->nav, *instance->navToFull, scan.turns);
+        const size_t count = scan.turns.size();
+        xSemaphoreTake(instance->resultMutex, portMAX_DELAY);
+        instance->result.swap(scan.turns);
+        instance->resultReady = true;
+        xSemaphoreGive(instance->resultMutex);
+        instance->progress = 100;
+        ESP_LOGI(TAG, "%u turns in %lu ms", (unsigned)count,
+                 (unsigned long)((esp_timer_get_time() - start) / 1000));
+    }
+    scan.turns.clear();
+
+    instance->taskHandle = nullptr;
+    xSemaphoreGive(instance->taskDone);
+    vTaskDelete(NULL);
+}
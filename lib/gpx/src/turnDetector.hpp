@@ -0,0 +1,57 @@
+/**
+ * @file turnDetector.hpp
+ * @author Jordi Gauchía (jgauchia@jgauchia.com)
+ * @brief  Background turn detection of the loaded track
+ * @version 0.2.5
+ * @date 2026-04
+ */
+
+#pragma once
+
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+#include "freertos/task.h"
+#include "globalGpxDef.h"
+#include "turnScan.hpp"
+#include "trackSimplify.hpp"
+
+/**
+ * @class TurnDetector
+ * @brief Runs TurnScan in a low priority task after a track is loaded
+ *
+ * @details The track is shown and followed right away, the turn list is handed over to
+ *          the main loop with collect() once the scan is done. Turns can be detected on
+ *          the full track and handed over with the indices of its simplified copy. The scan yields every
+ *          STEP_POINTS points so the UI and GPS tasks keep running.
+ */
+class TurnDetector
+{
+    public:
+        TurnDetector();
+        bool start(const TrackVector &track, const TurnParams &params, const TrackVector *nav = nullptr,
+                   const TrackIndexMap *navToFull = nullptr);
+        void cancel();
+        bool collect(std::vector<TurnPoint> &turns);
+        bool isRunning() const;
+        uint8_t getProgress() const;
+
+    private:
+        static constexpr size_t STEP_POINTS = 2048;     /**< Points tested between yields */
+
+        TurnScan scan;                   /**< Scan state, owned by the task while running */
+        const TrackVector *nav;          /**< Simplified track the turns are handed over for */
+        const TrackIndexMap *navToFull;  /**< Full track index of each nav point */
+        TaskHandle_t taskHandle;         /**< Detector task */
+        SemaphoreHandle_t taskDone;      /**< Given by the task when it ends */
+        SemaphoreHandle_t resultMutex;   /**< Guards result and resultReady */
+        std::vector<TurnPoint> result;   /**< Turns of the last finished scan */
+        volatile bool resultReady;       /**< result not collected yet */
+        volatile bool cancelRequest;     /**< Task must stop */
+        volatile uint8_t progress;       /**< Scan progress (0-100) */
+        volatile uint32_t generation;    /**< Incremented by each start() */
+        uint32_t collected;              /**< Generation last seen by collect() */
+
+        static void detectorTask(void *pvParameters);
+};
+
+extern TurnDetector turnDetector;
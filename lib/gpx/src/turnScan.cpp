@@ -0,0 +1,196 @@
+/**
+ * @file turnScan.cpp
+ * @author Jordi Gauchía (jgauchia@jgauchia.com)
+ * @brief  Linear-time turn detection over a loaded track
+ * @version 0.2.5
+ * @date 2026-04
+ */
+
+#include "turnScan.hpp"
+#include <algorithm>
+#include <cmath>
+#include "gpsMath.hpp"
+
+/**
+ * @brief Margin on the unit vector dot product, points inside it take the exact path
+ */
+static constexpr float COS_MARGIN = 1e-3f;
+
+/**
+ * @brief Margin (m) on the running window length, windows inside it are summed again
+ */
+static constexpr double DIST_MARGIN = 1e-2;
+
+TurnScan::TurnScan() : track(nullptr), params{}, window(0), first(0), next(0), end(0), windowDist(0.0), gaps(0),
+                       cosSharp(0.0f), cosAny(0.0f) {}
+
+/**
+ * @brief Prepare a scan of a track
+ *
+ * @details The track must not change until the scan is done.
+ *
+ * @param track Track points with cumulative distances
+ * @param params Thresholds
+ */
+void TurnScan::begin(const TrackVector &track, const TurnParams &params)
+{
+    this->track = &track;
+    this->params = params;
+    turns.clear();
+    window = params.windowSize > 0 ? (size_t)params.windowSize : 0;
+    first = next = end = 0;
+    if (window == 0 || track.size() < 2 * window + 1)
+        return;
+
+    turns.reserve(track.size() / 20);
+    first = next = window;
+    end = track.size() - window;
+    cosSharp = cosf(DEG2RAD(params.sharpTurnDeg));
+    cosAny = cosf(DEG2RAD(std::min(params.thresholdDeg, params.sharpTurnDeg)));
+
+    chords.resize(window + 1);
+    for (size_t k = 0; k < window; k++)
+        computeChord(k);
+
+    dists.resize(2 * window);
+    windowDist = 0.0;
+    gaps = 0;
+    for (size_t j = 0; j < 2 * window; j++)
+    {
+        const float d = segmentDist(j);
+        dists[j] = d;
+        windowDist += d;
+        gaps += d > GAP_DIST;
+    }
+}
+
+/**
+ * @brief Test the next points
+ *
+ * @param count Max points to test
+ * @return true when the whole track has been scanned
+ */
+bool TurnScan::step(size_t count)
+{
+    for (; count > 0 && next < end; count--, next++)
+    {
+        computeChord(next);
+        testPoint(next);
+
+        // Slide the window: segment next - window leaves, segment next + window enters
+        if (next + 1 < end)
+        {
+            const size_t out = (next - window) % (2 * window);
+            const float d = segmentDist(next + window);
+            windowDist += (double)d - dists[out];
+            gaps += (d > GAP_DIST) - (dists[out] > GAP_DIST);
+            dists[out] = d;
+        }
+    }
+    return done();
+}
+
+/**
+ * @brief Check if the scan is complete
+ */
+bool TurnScan::done() const
+{
+    return next >= end;
+}
+
+/**
+ * @brief Scan progress (0-100)
+ */
+uint8_t TurnScan::progress() const
+{
+    if (done())
+        return 100;
+    return (uint8_t)((next - first) * 100 / (end - first));
+}
+
+/**
+ * @brief Detect the turns of a track in one call
+ *
+ * @param track Track points with cumulative distances
+ * @param params Thresholds
+ * @return Detected turns
+ */
+std::vector<TurnPoint> TurnScan::detect(const TrackVector &track, const TurnParams &params)
+{
+    TurnScan scan;
+    scan.begin(track, params);
+    scan.step(SIZE_MAX);
+    return std::move(scan.turns);
+}
+
+/**
+ * @brief Compute the course of the chord from point k to point k + window
+ */
+void TurnScan::computeChord(size_t k)
+{
+    Chord &c = chords[k % (window + 1)];
+    calcCourseVector(track->lat[k], track->lon[k], track->lat[k + window], track->lon[k + window], c.y, c.x);
+    const float norm = sqrtf(c.y * c.y + c.x * c.x);
+    if (norm > 0.0f)
+    {
+        c.uy = c.y / norm;
+        c.ux = c.x / norm;
+    }
+    else
+    {
+        // Same point: calcCourse gives north
+        c.uy = 0.0f;
+        c.ux = 1.0f;
+    }
+}
+
+/**
+ * @brief Length of the segment from point j to point j + 1
+ */
+float TurnScan::segmentDist(size_t j) const
+{
+    return calcDistUncached(track->lat[j], track->lon[j], track->lat[j + 1], track->lon[j + 1]);
+}
+
+/**
+ * @brief Test point i, its chords and the window length must be up to date
+ *
+ * @details Points whose course change is clearly under the threshold that applies are
+ *          rejected with the dot product. The others are decided with the same float
+ *          operations as the former per-point search, so the turn list is identical.
+ */
+void TurnScan::testPoint(size_t i)
+{
+    if (gaps > 0)
+        return;
+
+    const Chord &in = chords[(i - window) % (window + 1)];
+    const Chord &out = chords[i % (window + 1)];
+    const bool mayBeShort = windowDist < params.minDist + DIST_MARGIN;
+    const bool surelyShort = windowDist < params.minDist - DIST_MARGIN;
+    const float cosDiff = in.ux * out.ux + in.uy * out.uy;
+    if (cosDiff > (surelyShort ? cosSharp : cosAny) + COS_MARGIN)
+        return;
+
+    float distWindow = (float)windowDist;
+    if (mayBeShort && !surelyShort)
+    {
+        // Near the limit: sum the window in the original order
+        distWindow = 0.0f;
+        for (size_t j = i - window; j < i + window; j++)
+            distWindow += dists[j % (2 * window)];
+    }
+
+    const float brgStart = courseFromVector(in.y, in.x);
+    const float brgEnd = courseFromVector(out.y, out.x);
+    const float diff = calcAngleDiff(brgEnd, brgStart);
+    if (std::fabs(diff) > params.sharpTurnDeg)
+    {
+        turns.push_back({(int)i, diff, track->accumDist[i]});
+        return;
+    }
+    if (distWindow < params.minDist)
+        return;
+    if (std::fabs(diff) > params.thresholdDeg)
+        turns.push_back({(int)i, diff, track->accumDist[i]});
+}
@@ -0,0 +1,85 @@
+/**
+ * @file turnScan.hpp
+ * @author Jordi Gauchía (jgauchia@jgauchia.com)
+ * @brief  Linear-time turn detection over a loaded track
+ * @version 0.2.5
+ * @date 2026-04
+ *
+ * Platform independent, also built by tools/turn_bench.
+ *
+ * Same turns as the former sliding window search: for each point, the course change
+ * between the chord from windowSize points before and the chord to windowSize points
+ * after. Each chord course is computed once as a direction vector (calcCourseVector)
+ * and reused as the outgoing chord of one point and the incoming chord of another.
+ * The window length and the count of gaps over 200 m are running sums updated in O(1)
+ * per point. The course change is tested with a dot product of the unit vectors, and
+ * atan2 only runs for the few points close to or over a threshold.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "globalGpxDef.h"
+
+/**
+ * @brief Turn detection thresholds
+ */
+struct TurnParams
+{
+    float thresholdDeg;     /**< Min course change of a turn */
+    float minDist;          /**< Min window length (m) for non-sharp turns */
+    float sharpTurnDeg;     /**< Course change reported regardless of the window length */
+    int windowSize;         /**< Points on each side of the turn point */
+};
+
+/**
+ * @class TurnScan
+ * @brief Incremental turn detector, can be run in steps from a background task
+ */
+class TurnScan
+{
+public:
+    static constexpr float GAP_DIST = 200.0f;   /**< Segment length (m) that makes a window invalid */
+
+    TurnScan();
+
+    void begin(const TrackVector &track, const TurnParams &params);
+    bool step(size_t count);
+    bool done() const;
+    uint8_t progress() const;
+
+    static std::vector<TurnPoint> detect(const TrackVector &track, const TurnParams &params);
+
+    std::vector<TurnPoint> turns;   /**< Detected turns, in track order */
+
+private:
+    /**
+     * @brief Chord course from calcCourseVector and its unit vector
+     */
+    struct Chord
+    {
+        float y;            /**< East component */
+        float x;            /**< North component */
+        float uy;           /**< Unit vector east component */
+        float ux;           /**< Unit vector north component */
+    };
+
+    const TrackVector *track;       /**< Track being scanned */
+    TurnParams params;              /**< Thresholds */
+    size_t window;                  /**< Points on each side */
+    size_t first;                   /**< First point tested */
+    size_t next;                    /**< Next point to test */
+    size_t end;                     /**< One past the last point tested */
+    std::vector<Chord> chords;      /**< Ring of the last window + 1 chords */
+    std::vector<float> dists;       /**< Ring of the 2 * window segment lengths */
+    double windowDist;              /**< Running window length (m) */
+    uint32_t gaps;                  /**< Segments over GAP_DIST in the window */
+    float cosSharp;                 /**< cos(sharpTurnDeg) */
+    float cosAny;                   /**< cos(min(thresholdDeg, sharpTurnDeg)) */
+
+    void computeChord(size_t k);
+    float segmentDist(size_t j) const;
+    void testPoint(size_t i);
+};
@@ -0,0 +1,1205 @@
+/**
+ * @file waypointStore.cpp
+ * @author Jordi Gauchía (jgauchia@jgauchia.com)
+ * @brief  Waypoint database - append-only log with name and spatial index
+ * @version 0.2.5
+ * @date 2026-04
+ */
+
+#include "waypointStore.hpp"
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "esp_heap_caps.h"
+#include "esp_log.h"
+#include "gpxTokenizer.hpp"
+
+static const char* TAG = "WaypointStore";
+
+WaypointStore waypointStore;
+
+namespace
+{
+    /**
+     * @brief Log file header
+     */
+    struct LogHeader
+    {
+        char magic[4];         /**< "WDB1" */
+        uint16_t version;      /**< WaypointStore::VERSION */
+        uint16_t headerSize;   /**< sizeof(LogHeader) */
+        uint32_t gpxSize;      /**< GPX file size at the last import or export */
+        uint32_t flags;        /**< LOG_DIRTY */
+        int64_t gpxMtime;      /**< GPX modification time at the last import or export */
+        uint64_t reserved;     /**< Zero */
+    };
+    static_assert(sizeof(LogHeader) == 32, "Waypoint log header layout");
+
+    /**
+     * @brief Log record header, followed by the payload
+     */
+    struct RecordHeader
+    {
+        uint32_t checksum;     /**< FNV-1a of length, op, reserved and payload */
+        uint16_t length;       /**< Payload length */
+        uint8_t op;            /**< OP_PUT or OP_DEL */
+        uint8_t reserved;      /**< Zero */
+    };
+    static_assert(sizeof(RecordHeader) == 8, "Waypoint log record layout");
+
+    /**
+     * @brief Fixed part of a PUT payload, followed by the strings
+     */
+    struct PutFixed
+    {
+        float lat;
+        float lon;
+        float ele;
+        float hdop;
+        float vdop;
+        float pdop;
+        uint8_t sat;
+        uint8_t reserved[3];
+    };
+    static_assert(sizeof(PutFixed) == 28, "Waypoint log PUT layout");
+
+    static const char LOG_MAGIC[4] = {'W', 'D', 'B', '1'};
+    static constexpr uint32_t LOG_DIRTY = 0x01;
+    static constexpr uint8_t OP_PUT = 1;
+    static constexpr uint8_t OP_DEL = 2;
+    static constexpr size_t PUT_STRINGS = 6;
+    static constexpr size_t RECORD_MAX = sizeof(RecordHeader) + sizeof(PutFixed) +
+                                         PUT_STRINGS * (1 + WaypointStore::MAX_STRING);
+    static constexpr int32_t SLOT_EMPTY = -1;
+    static constexpr int32_t SLOT_DELETED = -2;
+    static constexpr int32_t LAT_CELLS = 1800;
+    static constexpr int32_t LON_CELLS = 3600;
+    static constexpr int32_t MAX_QUERY_CELLS = 4096;
+    static constexpr uint32_t FNV_OFFSET = 2166136261u;
+    static constexpr uint32_t FNV_PRIME = 16777619u;
+
+    static uint32_t fnv1a(uint32_t hash, const uint8_t *data, size_t len)
+    {
+        for (size_t i = 0; i < len; i++)
+            hash = (hash ^ data[i]) * FNV_PRIME;
+        return hash;
+    }
+
+    static uint32_t recordChecksum(const RecordHeader &header, const uint8_t *payload)
+    {
+        uint32_t hash = fnv1a(FNV_OFFSET, (const uint8_t *)&header.length, sizeof(RecordHeader) - sizeof(uint32_t));
+        return fnv1a(hash, payload, header.length);
+    }
+
+    static uint8_t *putString(uint8_t *out, const char *s)
+    {
+        size_t len = s ? strlen(s) : 0;
+        if (len > WaypointStore::MAX_STRING)
+            len = WaypointStore::MAX_STRING;
+        *out++ = (uint8_t)len;
+        if (len > 0)
+            memcpy(out, s, len);
+        return out + len;
+    }
+
+    static int32_t latCell(float lat)
+    {
+        int32_t cell = (int32_t)floorf(lat / WaypointStore::CELL_DEG);
+        return cell < -LAT_CELLS / 2 ? -LAT_CELLS / 2 : (cell > LAT_CELLS / 2 ? LAT_CELLS / 2 : cell);
+    }
+
+    static int32_t lonCell(float lon)
+    {
+        int32_t cell = (int32_t)floorf(lon / WaypointStore::CELL_DEG);
+        return cell < -LON_CELLS / 2 ? -LON_CELLS / 2 : (cell > LON_CELLS / 2 ? LON_CELLS / 2 : cell);
+    }
+
+    static int32_t cellKey(int32_t latIdx, int32_t lonIdx)
+    {
+        return (latIdx + LAT_CELLS / 2) * (LON_CELLS + 1) + (lonIdx + LON_CELLS / 2);
+    }
+
+    static void writeEscaped(FILE *file, const char *s)
+    {
+        for (; *s; s++)
+        {
+            switch (*s)
+            {
+                case '&': fputs("&amp;", file); break;
+                case '<': fputs("&lt;", file); break;
+                case '>': fputs("&gt;", file); break;
+                case '"': fputs("&quot;", file); break;
+                default: fputc(*s, file); break;
+            }
+        }
+    }
+
+    /**
+     * @brief Copy a tokenizer text into a string, resolving the predefined XML entities
+     */
+    static void copyText(std::string &out, const char *text, size_t len)
+    {
+        static const struct { const char *entity; char c; } entities[] = {
+            {"&amp;", '&'}, {"&lt;", '<'}, {"&gt;", '>'}, {"&quot;", '"'}, {"&apos;", '\''}};
+        out.clear();
+        for (size_t i = 0; i < len && out.size() < WaypointStore::MAX_STRING; i++)
+        {
+            char c = text[i];
+            if (c == '&')
+            {
+                for (const auto &e : entities)
+                {
+                    const size_t n = strlen(e.entity);
+                    if (i + n <= len && memcmp(text + i, e.entity, n) == 0)
+                    {
+                        c = e.c;
+                        i += n - 1;
+                        break;
+                    }
+                }
+            }
+            out.push_back(c);
+        }
+    }
+
+    static char *dupString(const char *s, size_t len)
+    {
+        if (len == 0)
+            return nullptr;
+        char *out = (char *)malloc(len + 1);
+        if (out)
+        {
+            memcpy(out, s, len);
+            out[len] = '\0';
+        }
+        return out;
+    }
+
+    /**
+     * @brief Finish a file replacement cut by a power loss
+     *
+     * @details Compaction and export write path.tmp, sync it, remove path and rename the
+     *          temporary file. A .tmp without the file it replaces is complete and takes
+     *          its place. Next to the file it may be partial and is removed.
+     *
+     * @param path File replaced through path.tmp
+     */
+    void recoverReplace(const std::string &path)
+    {
+        const std::string tmpPath = path + ".tmp";
+        struct stat st;
+        if (stat(tmpPath.c_str(), &st) != 0)
+            return;
+        if (stat(path.c_str(), &st) == 0)
+        {
+            std::remove(tmpPath.c_str());
+            return;
+        }
+        if (std::rename(tmpPath.c_str(), path.c_str()) == 0)
+            ESP_LOGW(TAG, "Recovered %s after a power loss", path.c_str());
+    }
+}
+
+/**
+ * @brief Constructs an empty, closed store
+ */
+WaypointStore::WaypointStore() : liveCount(0), deadCount(0), logSize(0), dirty(false), generation(0), logFile(nullptr),
+                                 recordBuf(nullptr), nameSlotsUsed(0), cellCount(0) {}
+
+WaypointStore::~WaypointStore()
+{
+    if (logFile)
+        fclose(logFile);
+    if (recordBuf)
+        heap_caps_free(recordBuf);
+}
+
+/**
+ * @brief Open the store of a waypoint GPX file
+ *
+ * @details Replays the log if it was written for the current GPX file, otherwise (no log,
+ *          other layout, GPX changed outside IceNav) imports the GPX into a new log.
+ *          A record cut by a power loss at the end of the log is dropped, and a compaction
+ *          or export cut between removing the old file and renaming the new one is finished.
+ *          If the GPX file is missing, a valid log is kept and exported to a new GPX file.
+ *
+ * @param path Waypoint GPX file path
+ * @return true if the store is open
+ */
+bool WaypointStore::open(const char *path)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    if (logFile)
+    {
+        fclose(logFile);
+        logFile = nullptr;
+    }
+    if (!recordBuf)
+    {
+        recordBuf = (uint8_t *)heap_caps_malloc(2 * RECORD_MAX, MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT);
+        if (!recordBuf)
+            recordBuf = (uint8_t *)heap_caps_malloc(2 * RECORD_MAX, MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT);
+        if (!recordBuf)
+            return false;
+    }
+
+    gpxPath = path;
+    logPath = gpxPath + ".wdb";
+    recoverReplace(logPath);
+    recoverReplace(gpxPath);
+
+    struct stat st;
+    const bool hasGpx = stat(path, &st) == 0;
+    if (openLog(false))
+    {
+        LogHeader header;
+        const bool valid = fseek(logFile, 0, SEEK_SET) == 0 &&
+                           fread(&header, 1, sizeof(header), logFile) == sizeof(header) &&
+                           memcmp(header.magic, LOG_MAGIC, 4) == 0 && header.version == VERSION &&
+                           header.headerSize == sizeof(LogHeader);
+        if (valid && hasGpx && header.gpxSize == (uint32_t)st.st_size && header.gpxMtime == (int64_t)st.st_mtime &&
+            replay())
+        {
+            dirty = (header.flags & LOG_DIRTY) != 0;
+            ESP_LOGI(TAG, "Waypoints loaded from log: %u (%u dead records)", (unsigned)liveCount, (unsigned)deadCount);
+            return true;
+        }
+        if (valid && !hasGpx)
+        {
+            // The log is the only copy left, never replace it with an empty import
+            if (!replay())
+            {
+                ESP_LOGE(TAG, "%s missing and waypoint log unreadable, left untouched", path);
+                fclose(logFile);
+                logFile = nullptr;
+                return false;
+            }
+            ESP_LOGW(TAG, "%s missing, exporting %u waypoints from the log", path, (unsigned)liveCount);
+            dirty = true;
+            exportLocked();
+            return true;
+        }
+        ESP_LOGI(TAG, "Stale waypoint log %s", logPath.c_str());
+        fclose(logFile);
+        logFile = nullptr;
+    }
+
+    return importLocked(path);
+}
+
+/**
+ * @brief Export pending changes to the GPX file and close the log
+ */
+void WaypointStore::close()
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    if (!logFile)
+        return;
+    if (dirty)
+        exportLocked();
+    fclose(logFile);
+    logFile = nullptr;
+    clearIndex();
+}
+
+/**
+ * @brief Check if the store is open
+ */
+bool WaypointStore::isOpen() const
+{
+    return logFile != nullptr;
+}
+
+/**
+ * @brief Check if a GPX file is the one backed by this store
+ *
+ * @param path GPX file path
+ * @return true if edits of this file must go through the store
+ */
+bool WaypointStore::handles(const char *path) const
+{
+    return logFile != nullptr && path != nullptr && gpxPath == path;
+}
+
+/**
+ * @brief Add a waypoint, replacing any waypoint with the same name
+ *
+ * @param wp Waypoint, a missing time is set to the current UTC time and a missing source to "IceNav"
+ * @return true if the record was written
+ */
+bool WaypointStore::add(const wayPoint &wp)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    if (!logFile || !wp.name)
+        return false;
+
+    char timeText[24];
+    wayPoint rec = wp;
+    if (!rec.time || !rec.time[0])
+    {
+        time_t now = time(nullptr);
+        struct tm utc;
+        strftime(timeText, sizeof(timeText), "%Y-%m-%dT%H:%M:%SZ", gmtime_r(&now, &utc));
+        rec.time = timeText;
+    }
+    if (!rec.src || !rec.src[0])
+        rec.src = (char *)"IceNav";
+
+    const size_t len = encodePut(recordBuf, rec, rec.name);
+    const uint32_t offset = logSize;
+    if (!append(recordBuf, len))
+        return false;
+    const uint8_t *name = recordBuf + sizeof(RecordHeader) + sizeof(PutFixed);
+    indexPut((const char *)name + 1, name[0], rec.lat, rec.lon, offset);
+    maybeCompact();
+    return true;
+}
+
+/**
+ * @brief Rename a waypoint
+ *
+ * @details Writes a PUT with the new name and a DEL of the old one in a single append.
+ *
+ * @param oldName Current name
+ * @param newName New name, a waypoint already using it is replaced
+ * @return true if the waypoint was renamed
+ */
+bool WaypointStore::rename(const char *oldName, const char *newName)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    if (!logFile || !oldName || !newName)
+        return false;
+    const int32_t slot = findSlot(oldName, strlen(oldName));
+    if (slot < 0)
+        return false;
+
+    const WaypointEntry entry = entries[nameTable[slot]];
+    uint8_t op;
+    const uint8_t *payload;
+    uint16_t payloadLen;
+    wayPoint wp = {};
+    if (!readRecord(entry.offset, op, payload, payloadLen) || op != OP_PUT || !decodePut(payload, payloadLen, wp))
+        return false;
+
+    const size_t putLen = encodePut(recordBuf + RECORD_MAX, wp, newName);
+    free(wp.name); free(wp.time); free(wp.desc); free(wp.src); free(wp.sym); free(wp.type);
+    memmove(recordBuf, recordBuf + RECORD_MAX, putLen);
+    const size_t delLen = encodeDel(recordBuf + putLen, oldName);
+
+    const uint32_t offset = logSize;
+    if (!append(recordBuf, putLen + delLen))
+        return false;
+    const uint8_t *name = recordBuf + sizeof(RecordHeader) + sizeof(PutFixed);
+    indexDel(oldName, strlen(oldName));
+    indexPut((const char *)name + 1, name[0], entry.lat, entry.lon, offset);
+    maybeCompact();
+    return true;
+}
+
+/**
+ * @brief Delete a waypoint
+ *
+ * @param name Waypoint name
+ * @return true if the waypoint existed and the record was written
+ */
+bool WaypointStore::remove(const char *name)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    if (!logFile || !name || findSlot(name, strlen(name)) < 0)
+        return false;
+    const size_t len = encodeDel(recordBuf, name);
+    if (!append(recordBuf, len))
+        return false;
+    indexDel(name, strlen(name));
+    maybeCompact();
+    return true;
+}
+
+/**
+ * @brief Get a waypoint by name
+ *
+ * @details Strings are allocated with strdup semantics, as GPXParser::getWaypointInfo did.
+ *          Empty fields are left as nullptr.
+ *
+ * @param name Waypoint name
+ * @param wp Output waypoint
+ * @return true if found
+ */
+bool WaypointStore::get(const char *name, wayPoint &wp)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    if (!logFile || !name)
+        return false;
+    const int32_t slot = findSlot(name, strlen(name));
+    if (slot < 0)
+        return false;
+    uint8_t op;
+    const uint8_t *payload;
+    uint16_t len;
+    return readRecord(entries[nameTable[slot]].offset, op, payload, len) && op == OP_PUT &&
+           decodePut(payload, len, wp);
+}
+
+/**
+ * @brief Get the names of all waypoints, in insertion order
+ */
+std::vector<std::string> WaypointStore::getNames()
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    std::vector<std::string> result;
+    result.reserve(liveCount);
+    for (const WaypointEntry &entry : entries)
+    {
+        if (entry.alive)
+            result.emplace_back(names.data() + entry.nameOffset, entry.nameLen);
+    }
+    return result;
+}
+
+/**
+ * @brief Find the waypoints inside a bounding box
+ *
+ * @details Walks the grid cells covered by the box. Boxes over many cells, or crossing the
+ *          antimeridian (minLon > maxLon), scan all entries instead.
+ *          Returned ids are valid until the next change of the store.
+ *
+ * @param minLat Minimum latitude
+ * @param maxLat Maximum latitude
+ * @param minLon Minimum longitude
+ * @param maxLon Maximum longitude
+ * @param ids Output entry ids (cleared first)
+ */
+void WaypointStore::query(float minLat, float maxLat, float minLon, float maxLon, std::vector<uint32_t> &ids)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    ids.clear();
+    const bool wraps = minLon > maxLon;
+    const int32_t latLo = latCell(minLat);
+    const int32_t latHi = latCell(maxLat);
+    const int32_t lonLo = lonCell(minLon);
+    const int32_t lonHi = lonCell(maxLon);
+
+    if (wraps || (int64_t)(latHi - latLo + 1) * (lonHi - lonLo + 1) > MAX_QUERY_CELLS)
+    {
+        for (uint32_t i = 0; i < entries.size(); i++)
+        {
+            const WaypointEntry &e = entries[i];
+            const bool inLon = wraps ? (e.lon >= minLon || e.lon <= maxLon) : (e.lon >= minLon && e.lon <= maxLon);
+            if (e.alive && e.lat >= minLat && e.lat <= maxLat && inLon)
+                ids.push_back(i);
+        }
+        return;
+    }
+
+    for (int32_t la = latLo; la <= latHi; la++)
+    {
+        for (int32_t lo = lonLo; lo <= lonHi; lo++)
+        {
+            const int32_t *head = cellHead(cellKey(la, lo), false);
+            for (int32_t i = head ? *head : -1; i >= 0; i = entries[i].nextInCell)
+            {
+                const WaypointEntry &e = entries[i];
+                if (e.alive && e.lat >= minLat && e.lat <= maxLat && e.lon >= minLon && e.lon <= maxLon)
+                    ids.push_back((uint32_t)i);
+            }
+        }
+    }
+}
+
+/**
+ * @brief Get an indexed entry returned by query()
+ */
+const WaypointEntry &WaypointStore::getEntry(uint32_t id) const
+{
+    return entries[id];
+}
+
+/**
+ * @brief Get the name of an entry returned by query()
+ */
+std::string WaypointStore::getName(uint32_t id) const
+{
+    return std::string(names.data() + entries[id].nameOffset, entries[id].nameLen);
+}
+
+/**
+ * @brief Copy the positions of the live waypoints
+ *
+ * @param out Positions
+ * @return Generation of the index they were copied from
+ */
+uint32_t WaypointStore::getPositions(std::vector<WaypointPosition> &out)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    out.clear();
+    out.reserve(liveCount);
+    for (uint32_t i = 0; i < entries.size(); i++)
+    {
+        if (entries[i].alive)
+            out.push_back({entries[i].lat, entries[i].lon, i});
+    }
+    return generation;
+}
+
+/**
+ * @brief Rewrite the log with the live records only
+ */
+bool WaypointStore::compact()
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    return logFile && compactLocked();
+}
+
+/**
+ * @brief Write the waypoints to the GPX file
+ */
+bool WaypointStore::exportGpx()
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    return logFile && exportLocked();
+}
+
+/**
+ * @brief Replace the store contents with the waypoints of a GPX file
+ *
+ * @param path GPX file path, the store keeps exporting to the file it was opened with
+ */
+bool WaypointStore::importGpx(const char *path)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    if (!logFile || !importLocked(path))
+        return false;
+    if (gpxPath != path)
+    {
+        dirty = true;
+        return exportLocked();
+    }
+    return true;
+}
+
+/**
+ * @brief Open the log file for reading and appending
+ *
+ * @param create Truncate or create the file
+ */
+bool WaypointStore::openLog(bool create)
+{
+    logFile = fopen(logPath.c_str(), create ? "w+b" : "r+b");
+    return logFile != nullptr;
+}
+
+/**
+ * @brief Drop the in-memory index
+ */
+void WaypointStore::clearIndex()
+{
+    entries.clear();
+    names.clear();
+    nameTable.assign(16, SLOT_EMPTY);
+    cellTable.assign(16, Cell{-1, -1});
+    nameSlotsUsed = 0;
+    cellCount = 0;
+    liveCount = 0;
+    deadCount = 0;
+    logSize = 0;
+    generation++;
+}
+
+/**
+ * @brief Rebuild the index from the records following the log header
+ *
+ * @details Stops at the first incomplete record or bad checksum and truncates the log there.
+ */
+bool WaypointStore::replay()
+{
+    clearIndex();
+    uint32_t offset = sizeof(LogHeader);
+    if (fseek(logFile, offset, SEEK_SET) != 0)
+        return false;
+
+    RecordHeader header;
+    while (fread(&header, 1, sizeof(header), logFile) == sizeof(header))
+    {
+        uint8_t *payload = recordBuf + sizeof(RecordHeader);
+        if (header.length > RECORD_MAX - sizeof(RecordHeader) ||
+            fread(payload, 1, header.length, logFile) != header.length ||
+            recordChecksum(header, payload) != header.checksum)
+            break;
+
+        const uint8_t *name = payload + (header.op == OP_PUT ? sizeof(PutFixed) : 0);
+        if (name >= payload + header.length || name + 1 + name[0] > payload + header.length)
+            break;
+        if (header.op == OP_PUT)
+        {
+            PutFixed fixed;
+            memcpy(&fixed, payload, sizeof(fixed));
+            indexPut((const char *)name + 1, name[0], fixed.lat, fixed.lon, offset);
+        }
+        else if (header.op == OP_DEL)
+        {
+            if (!indexDel((const char *)payload + 1, payload[0]))
+                deadCount++;
+        }
+        else
+            break;
+        offset += sizeof(RecordHeader) + header.length;
+    }
+
+    fseek(logFile, 0, SEEK_END);
+    const long end = ftell(logFile);
+    if (end > (long)offset)
+    {
+        ESP_LOGW(TAG, "Dropping %ld bytes of incomplete records at the end of %s", end - (long)offset, logPath.c_str());
+        fflush(logFile);
+        if (ftruncate(fileno(logFile), offset) != 0)
+            return false;
+    }
+    logSize = offset;
+    return true;
+}
+
+/**
+ * @brief Write the log header with the current GPX file stamp and dirty flag
+ */
+bool WaypointStore::writeHeader()
+{
+    LogHeader header = {};
+    memcpy(header.magic, LOG_MAGIC, 4);
+    header.version = VERSION;
+    header.headerSize = sizeof(LogHeader);
+    header.flags = dirty ? LOG_DIRTY : 0;
+    struct stat st;
+    if (stat(gpxPath.c_str(), &st) == 0)
+    {
+        header.gpxSize = (uint32_t)st.st_size;
+        header.gpxMtime = (int64_t)st.st_mtime;
+    }
+    return fseek(logFile, 0, SEEK_SET) == 0 && fwrite(&header, 1, sizeof(header), logFile) == sizeof(header);
+}
+
+/**
+ * @brief Append records to the log and sync them to the card
+ *
+ * @details The first change after an export also sets the dirty flag in the header, so
+ *          a reset before the next export still exports at the following boot.
+ */
+bool WaypointStore::append(const uint8_t *data, size_t len)
+{
+    bool ok = true;
+    if (!dirty)
+    {
+        dirty = true;
+        ok = writeHeader();
+    }
+    ok = ok && fseek(logFile, logSize, SEEK_SET) == 0 && fwrite(data, 1, len, logFile) == len &&
+         fflush(logFile) == 0 && fsync(fileno(logFile)) == 0;
+    if (!ok)
+    {
+        ESP_LOGE(TAG, "Failed to write waypoint log %s", logPath.c_str());
+        return false;
+    }
+    logSize += len;
+    return true;
+}
+
+/**
+ * @brief Read one record into the record buffer
+ */
+bool WaypointStore::readRecord(uint32_t offset, uint8_t &op, const uint8_t *&payload, uint16_t &len)
+{
+    RecordHeader header;
+    uint8_t *data = recordBuf + sizeof(RecordHeader);
+    if (fseek(logFile, offset, SEEK_SET) != 0 || fread(recordBuf, 1, sizeof(header), logFile) != sizeof(header))
+        return false;
+    memcpy(&header, recordBuf, sizeof(header));
+    if (header.length > RECORD_MAX - sizeof(RecordHeader) || fread(data, 1, header.length, logFile) != header.length ||
+        recordChecksum(header, data) != header.checksum)
+    {
+        ESP_LOGE(TAG, "Bad waypoint record at %u", (unsigned)offset);
+        return false;
+    }
+    op = header.op;
+    payload = data;
+    len = header.length;
+    return true;
+}
+
+/**
+ * @brief Encode a PUT record
+ *
+ * @param out Output, RECORD_MAX bytes
+ * @param wp Waypoint fields
+ * @param name Waypoint name (may differ from wp.name when renaming)
+ * @return Record size
+ */
+size_t WaypointStore::encodePut(uint8_t *out, const wayPoint &wp, const char *name)
+{
+    PutFixed fixed = {wp.lat, wp.lon, wp.ele, wp.hdop, wp.vdop, wp.pdop, wp.sat, {0, 0, 0}};
+    uint8_t *payload = out + sizeof(RecordHeader);
+    memcpy(payload, &fixed, sizeof(fixed));
+    uint8_t *p = payload + sizeof(fixed);
+    p = putString(p, name);
+    p = putString(p, wp.time);
+    p = putString(p, wp.desc);
+    p = putString(p, wp.src);
+    p = putString(p, wp.sym);
+    p = putString(p, wp.type);
+
+    RecordHeader header = {0, (uint16_t)(p - payload), OP_PUT, 0};
+    header.checksum = recordChecksum(header, payload);
+    memcpy(out, &header, sizeof(header));
+    return p - out;
+}
+
+/**
+ * @brief Encode a DEL record
+ *
+ * @param out Output, RECORD_MAX bytes
+ * @param name Waypoint name
+ * @return Record size
+ */
+size_t WaypointStore::encodeDel(uint8_t *out, const char *name)
+{
+    uint8_t *payload = out + sizeof(RecordHeader);
+    uint8_t *p = putString(payload, name);
+    RecordHeader header = {0, (uint16_t)(p - payload), OP_DEL, 0};
+    header.checksum = recordChecksum(header, payload);
+    memcpy(out, &header, sizeof(header));
+    return p - out;
+}
+
+/**
+ * @brief Find the name table slot of a live waypoint
+ *
+ * @return Slot index, -1 if not found
+ */
+int32_t WaypointStore::findSlot(const char *name, size_t len) const
+{
+    const size_t mask = nameTable.size() - 1;
+    for (size_t i = fnv1a(FNV_OFFSET, (const uint8_t *)name, len) & mask;; i = (i + 1) & mask)
+    {
+        const int32_t id = nameTable[i];
+        if (id == SLOT_EMPTY)
+            return -1;
+        if (id >= 0 && entries[id].nameLen == len && memcmp(names.data() + entries[id].nameOffset, name, len) == 0)
+            return (int32_t)i;
+    }
+}
+
+/**
+ * @brief Index a PUT record, replacing the live waypoint with the same name
+ */
+void WaypointStore::indexPut(const char *name, size_t len, float lat, float lon, uint32_t offset)
+{
+    const int32_t id = (int32_t)entries.size();
+    int32_t slot = findSlot(name, len);
+    if (slot >= 0)
+    {
+        entries[nameTable[slot]].alive = false;
+        deadCount++;
+        liveCount--;
+    }
+    else
+    {
+        if ((nameSlotsUsed + 1) * 2 > nameTable.size())
+            rehashNames(liveCount * 4 > nameTable.size() ? nameTable.size() * 2 : nameTable.size());
+        const size_t mask = nameTable.size() - 1;
+        size_t i = fnv1a(FNV_OFFSET, (const uint8_t *)name, len) & mask;
+        while (nameTable[i] >= 0)
+            i = (i + 1) & mask;
+        if (nameTable[i] == SLOT_EMPTY)
+            nameSlotsUsed++;
+        slot = (int32_t)i;
+    }
+    nameTable[slot] = id;
+
+    WaypointEntry entry = {lat, lon, offset, (uint32_t)names.size(), (uint8_t)len, true, -1};
+    names.insert(names.end(), name, name + len);
+    int32_t *head = cellHead(cellKey(latCell(lat), lonCell(lon)), true);
+    entry.nextInCell = *head;
+    *head = id;
+    entries.push_back(entry);
+    generation++;
+    liveCount++;
+}
+
+/**
+ * @brief Index a DEL record
+ *
+ * @return true if a live waypoint was deleted
+ */
+bool WaypointStore::indexDel(const char *name, size_t len)
+{
+    const int32_t slot = findSlot(name, len);
+    if (slot < 0)
+        return false;
+    entries[nameTable[slot]].alive = false;
+    nameTable[slot] = SLOT_DELETED;
+    liveCount--;
+    deadCount += 2;
+    generation++;
+    return true;
+}
+
+/**
+ * @brief Rebuild the name table from the live entries, dropping deleted slots
+ */
+void WaypointStore::rehashNames(size_t capacity)
+{
+    nameTable.assign(capacity, SLOT_EMPTY);
+    nameSlotsUsed = 0;
+    const size_t mask = capacity - 1;
+    for (size_t id = 0; id < entries.size(); id++)
+    {
+        if (!entries[id].alive)
+            continue;
+        size_t i = fnv1a(FNV_OFFSET, (const uint8_t *)names.data() + entries[id].nameOffset, entries[id].nameLen) & mask;
+        while (nameTable[i] != SLOT_EMPTY)
+            i = (i + 1) & mask;
+        nameTable[i] = (int32_t)id;
+        nameSlotsUsed++;
+    }
+}
+
+/**
+ * @brief Grow the grid cell table
+ */
+void WaypointStore::rehashCells(size_t capacity)
+{
+    std::vector<Cell, PsramAllocator<Cell>> old;
+    old.swap(cellTable);
+    cellTable.assign(capacity, Cell{-1, -1});
+    const size_t mask = capacity - 1;
+    for (const Cell &cell : old)
+    {
+        if (cell.key < 0)
+            continue;
+        size_t i = ((uint32_t)cell.key * 2654435761u) & mask;
+        while (cellTable[i].key >= 0)
+            i = (i + 1) & mask;
+        cellTable[i] = cell;
+    }
+}
+
+/**
+ * @brief Find the first entry of a grid cell
+ *
+ * @param key Cell key
+ * @param create Add the cell if missing
+ * @return Pointer to the cell chain head, nullptr if missing and not created
+ */
+int32_t *WaypointStore::cellHead(int32_t key, bool create)
+{
+    if (create && (cellCount + 1) * 2 > cellTable.size())
+        rehashCells(cellTable.size() * 2);
+    const size_t mask = cellTable.size() - 1;
+    for (size_t i = ((uint32_t)key * 2654435761u) & mask;; i = (i + 1) & mask)
+    {
+        if (cellTable[i].key == key)
+            return &cellTable[i].head;
+        if (cellTable[i].key < 0)
+        {
+            if (!create)
+                return nullptr;
+            cellTable[i].key = key;
+            cellCount++;
+            return &cellTable[i].head;
+        }
+    }
+}
+
+/**
+ * @brief Decode a PUT payload into a waypoint, strings are allocated
+ */
+bool WaypointStore::decodePut(const uint8_t *payload, uint16_t len, wayPoint &wp)
+{
+    if (len < sizeof(PutFixed) + PUT_STRINGS)
+        return false;
+    PutFixed fixed;
+    memcpy(&fixed, payload, sizeof(fixed));
+    wp.lat = fixed.lat;
+    wp.lon = fixed.lon;
+    wp.ele = fixed.ele;
+    wp.hdop = fixed.hdop;
+    wp.vdop = fixed.vdop;
+    wp.pdop = fixed.pdop;
+    wp.sat = fixed.sat;
+
+    char **fields[PUT_STRINGS] = {&wp.name, &wp.time, &wp.desc, &wp.src, &wp.sym, &wp.type};
+    const uint8_t *p = payload + sizeof(PutFixed);
+    const uint8_t *end = payload + len;
+    for (size_t i = 0; i < PUT_STRINGS; i++)
+    {
+        if (p >= end || p + 1 + *p > end)
+            return false;
+        *fields[i] = dupString((const char *)p + 1, *p);
+        p += 1 + *p;
+    }
+    if (!wp.name)
+        wp.name = strdup("");
+    return true;
+}
+
+/**
+ * @brief Rewrite the log with the live records, in insertion order
+ *
+ * @details Written to a temporary file, synced, then renamed over the log. After a power
+ *          loss open() finds either the old log or the complete new one (recoverReplace).
+ */
+bool WaypointStore::compactLocked()
+{
+    const std::string tmpPath = logPath + ".tmp";
+    FILE *out = fopen(tmpPath.c_str(), "wb");
+    if (!out)
+        return false;
+
+    LogHeader header;
+    bool ok = fseek(logFile, 0, SEEK_SET) == 0 && fread(&header, 1, sizeof(header), logFile) == sizeof(header) &&
+              fwrite(&header, 1, sizeof(header), out) == sizeof(header);
+    for (const WaypointEntry &entry : entries)
+    {
+        if (!ok)
+            break;
+        if (!entry.alive)
+            continue;
+        uint8_t op;
+        const uint8_t *payload;
+        uint16_t len;
+        ok = readRecord(entry.offset, op, payload, len) &&
+             fwrite(recordBuf, 1, sizeof(RecordHeader) + len, out) == sizeof(RecordHeader) + len;
+    }
+    ok = (fflush(out) == 0 && fsync(fileno(out)) == 0 && fclose(out) == 0) && ok;
+    if (!ok)
+    {
+        ESP_LOGE(TAG, "Failed to compact waypoint log %s", logPath.c_str());
+        std::remove(tmpPath.c_str());
+        return false;
+    }
+
+    const uint32_t before = logSize;
+    fclose(logFile);
+    logFile = nullptr;
+    std::remove(logPath.c_str());
+    if (std::rename(tmpPath.c_str(), logPath.c_str()) != 0 || !openLog(false) || !replay())
+    {
+        ESP_LOGE(TAG, "Failed to reopen waypoint log %s", logPath.c_str());
+        if (logFile)
+            fclose(logFile);
+        logFile = nullptr;
+        return false;
+    }
+    ESP_LOGI(TAG, "Waypoint log compacted: %u -> %u bytes", (unsigned)before, (unsigned)logSize);
+    return true;
+}
+
+/**
+ * @brief Write the live waypoints to the GPX file and stamp the log with it
+ *
+ * @details Written to a temporary file, synced, then renamed over the GPX file. After a
+ *          power loss open() finds either GPX file (recoverReplace).
+ */
+bool WaypointStore::exportLocked()
+{
+    const std::string tmpPath = gpxPath + ".tmp";
+    FILE *out = fopen(tmpPath.c_str(), "w");
+    if (!out)
+        return false;
+
+    static const char gpxEnd[] = "</gpx>";
+    const size_t headerLen = strlen(gpxHeader) - (sizeof(gpxEnd) - 1);
+    bool ok = fwrite(gpxHeader, 1, headerLen, out) == headerLen;
+
+    for (const WaypointEntry &entry : entries)
+    {
+        if (!ok)
+            break;
+        if (!entry.alive)
+            continue;
+        uint8_t op;
+        const uint8_t *payload;
+        uint16_t len;
+        wayPoint wp = {};
+        ok = readRecord(entry.offset, op, payload, len) && decodePut(payload, len, wp);
+        if (!ok)
+            break;
+        fprintf(out, "<wpt lat=\"%.6f\" lon=\"%.6f\">\n", wp.lat, wp.lon);
+        fprintf(out, " <ele>%g</ele>\n", wp.ele);
+        const char *texts[] = {wp.time, wp.name, wp.desc, wp.src, wp.sym, wp.type};
+        static const char *tags[] = {"time", "name", "desc", "src", "sym", "type"};
+        for (size_t i = 0; i < PUT_STRINGS; i++)
+        {
+            if (!texts[i] && i != 1)
+                continue;
+            fprintf(out, " <%s>", tags[i]);
+            writeEscaped(out, texts[i] ? texts[i] : "");
+            fprintf(out, "</%s>\n", tags[i]);
+        }
+        fprintf(out, " <sat>%u</sat>\n <hdop>%g</hdop>\n <vdop>%g</vdop>\n <pdop>%g</pdop>\n</wpt>\n",
+                (unsigned)wp.sat, wp.hdop, wp.vdop, wp.pdop);
+        free(wp.name); free(wp.time); free(wp.desc); free(wp.src); free(wp.sym); free(wp.type);
+    }
+    ok = fputs(gpxEnd, out) >= 0 && fputc('\n', out) != EOF && ok;
+    ok = (fflush(out) == 0 && fsync(fileno(out)) == 0 && fclose(out) == 0) && ok;
+
+    if (ok)
+    {
+        std::remove(gpxPath.c_str());
+        ok = std::rename(tmpPath.c_str(), gpxPath.c_str()) == 0;
+    }
+    if (!ok)
+    {
+        ESP_LOGE(TAG, "Failed to export waypoints to %s", gpxPath.c_str());
+        std::remove(tmpPath.c_str());
+        return false;
+    }
+
+    dirty = false;
+    ok = writeHeader() && fflush(logFile) == 0;
+    ESP_LOGI(TAG, "Exported %u waypoints to %s", (unsigned)liveCount, gpxPath.c_str());
+    return ok;
+}
+
+/**
+ * @brief Build a new log from the waypoints of a GPX file
+ *
+ * @details Waypoints without a name get "WPTnnn", a repeated name keeps the last waypoint.
+ */
+bool WaypointStore::importLocked(const char *path)
+{
+    if (logFile)
+        fclose(logFile);
+    logFile = nullptr;
+    if (!openLog(true))
+    {
+        ESP_LOGE(TAG, "Failed to create waypoint log %s", logPath.c_str());
+        return false;
+    }
+    clearIndex();
+    dirty = false;
+    bool ok = writeHeader();
+    logSize = sizeof(LogHeader);
+
+    GpxTokenizer tokenizer;
+    if (ok && tokenizer.open(path))
+    {
+        static const char *tags[] = {"name", "time", "desc", "src", "sym", "type", "ele", "sat", "hdop", "vdop", "pdop"};
+        static constexpr int TAG_COUNT = sizeof(tags) / sizeof(tags[0]);
+        std::string values[TAG_COUNT];
+        bool inWpt = false;
+        int field = -1;
+        float lat = 0;
+        float lon = 0;
+
+        auto importWaypoint = [&]() -> bool
+        {
+            inWpt = false;
+            char unnamed[12];
+            if (values[0].empty())
+            {
+                snprintf(unnamed, sizeof(unnamed), "WPT%03u", (unsigned)(entries.size() + 1));
+                values[0] = unnamed;
+            }
+            float number[4] = {0, 0, 0, 0};
+            for (int i = 0; i < 4; i++)
+                GpxTokenizer::parseFloat(values[7 + i].c_str(), number[i]);
+            float ele = 0;
+            GpxTokenizer::parseFloat(values[6].c_str(), ele);
+
+            wayPoint wp = {};
+            wp.lat = lat;
+            wp.lon = lon;
+            wp.ele = ele;
+            wp.sat = (uint8_t)number[0];
+            wp.hdop = number[1];
+            wp.vdop = number[2];
+            wp.pdop = number[3];
+            char *strings[PUT_STRINGS];
+            for (size_t i = 0; i < PUT_STRINGS; i++)
+                strings[i] = values[i].empty() ? nullptr : (char *)values[i].c_str();
+            wp.time = strings[1];
+            wp.desc = strings[2];
+            wp.src = strings[3];
+            wp.sym = strings[4];
+            wp.type = strings[5];
+
+            const size_t len = encodePut(recordBuf, wp, strings[0]);
+            if (fwrite(recordBuf, 1, len, logFile) != len)
+                return false;
+            const uint8_t *name = recordBuf + sizeof(RecordHeader) + sizeof(PutFixed);
+            indexPut((const char *)name + 1, name[0], lat, lon, logSize);
+            logSize += len;
+            return true;
+        };
+
+        GpxTokenizer::Token token;
+        while (ok && (token = tokenizer.next()) != GpxTokenizer::TOKEN_EOF)
+        {
+            if (token == GpxTokenizer::TOKEN_OPEN)
+            {
+                if (tokenizer.isTag("wpt"))
+                {
+                    inWpt = true;
+                    lat = lon = 0;
+                    tokenizer.getAttrFloat("lat", lat);
+                    tokenizer.getAttrFloat("lon", lon);
+                    for (std::string &v : values)
+                        v.clear();
+                    field = -1;
+                    if (tokenizer.isEmptyTag())
+                        ok = importWaypoint();
+                }
+                else if (inWpt)
+                {
+                    field = -1;
+                    for (int i = 0; i < TAG_COUNT && !tokenizer.isEmptyTag(); i++)
+                    {
+                        if (tokenizer.isTag(tags[i]))
+                            field = i;
+                    }
+                }
+            }
+            else if (token == GpxTokenizer::TOKEN_TEXT && inWpt && field >= 0)
+            {
+                size_t len;
+                const char *text = tokenizer.getText(len);
+                copyText(values[field], text, len);
+                field = -1;
+            }
+            else if (token == GpxTokenizer::TOKEN_CLOSE)
+            {
+                field = -1;
+                if (inWpt && tokenizer.isTag("wpt"))
+                    ok = importWaypoint();
+            }
+        }
+        tokenizer.close();
+    }
+
+    ok = ok && fflush(logFile) == 0 && fsync(fileno(logFile)) == 0;
+    if (!ok)
+    {
+        ESP_LOGE(TAG, "Failed to import %s", path);
+        fclose(logFile);
+        logFile = nullptr;
+        std::remove(logPath.c_str());
+        clearIndex();
+        return false;
+    }
+    if (deadCount > 0)
+        compactLocked();
+    ESP_LOGI(TAG, "Imported %u waypoints from %s", (unsigned)liveCount, path);
+    return true;
+}
+
+/**
+ * @brief Compact the log once most of it is dead records
+ */
+void WaypointStore::maybeCompact()
+{
+    if (deadCount > COMPACT_MIN_DEAD && deadCount > liveCount)
+        compactLocked();
+}
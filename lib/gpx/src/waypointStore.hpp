@@ -0,0 +1,148 @@
+/**
+ * @file waypointStore.hpp
+ * @author Jordi Gauchía (jgauchia@jgauchia.com)
+ * @brief  Waypoint database - append-only log with name and spatial index
+ * @version 0.2.5
+ * @date 2026-04
+ *
+ * Platform independent, also built by tools/waypoint_bench.
+ *
+ * The user waypoint file (waypoint.gpx) is backed by a binary log next to it
+ * (waypoint.gpx.wdb). Adding, renaming or deleting a waypoint appends one record to
+ * the log instead of rewriting the GPX document. At open the log is replayed into an
+ * in-memory index: a hash table by name and a grid of 0.1 degree cells for area
+ * queries, both in PSRAM.
+ *
+ * The GPX file stays the exchange format. It is imported when the log is missing or
+ * the GPX was changed outside IceNav (size or mtime differ from the last export),
+ * and exported again when the log has changes not yet written to it. Compaction
+ * rewrites the log with the live records once most of it is dead.
+ *
+ * Log layout (little-endian):
+ *  - Header (32 bytes): magic "WDB1", version (u16), header size (u16), GPX size (u32),
+ *    flags (u32, bit 0 = not exported), GPX mtime (i64), reserved (u64)
+ *  - Records: checksum (u32, FNV-1a of length, op and payload), payload length (u16),
+ *    op (u8), reserved (u8), payload
+ *  - PUT payload: lat, lon, ele, hdop, vdop, pdop (f32), sat (u8), 3 reserved bytes,
+ *    then name, time, desc, src, sym, type as u8 length + bytes
+ *  - DEL payload: name as u8 length + bytes
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <vector>
+#include "globalGpxDef.h"
+
+/**
+ * @brief Indexed waypoint, the rest of the fields stay in the log
+ */
+struct WaypointEntry
+{
+    float lat;              /**< Latitude (degrees) */
+    float lon;              /**< Longitude (degrees) */
+    uint32_t offset;        /**< PUT record offset in the log */
+    uint32_t nameOffset;    /**< Name offset in the name arena */
+    uint8_t nameLen;        /**< Name length */
+    bool alive;             /**< Not deleted or replaced */
+    int32_t nextInCell;     /**< Next entry in the same grid cell, -1 = last */
+};
+
+/**
+ * @brief Position of a live waypoint, for map overlays
+ */
+struct WaypointPosition
+{
+    float lat;              /**< Latitude (degrees) */
+    float lon;              /**< Longitude (degrees) */
+    uint32_t id;            /**< Entry id, see getEntry() */
+};
+
+/**
+ * @class WaypointStore
+ * @brief Waypoint database backing the user waypoint GPX file
+ */
+class WaypointStore
+{
+public:
+    static constexpr uint16_t VERSION = 1;              /**< Log layout version */
+    static constexpr float CELL_DEG = 0.1f;             /**< Spatial grid cell (degrees) */
+    static constexpr uint32_t COMPACT_MIN_DEAD = 64;    /**< Dead records before compaction is considered */
+    static constexpr size_t MAX_STRING = 255;           /**< Longest stored string */
+
+    WaypointStore();
+    ~WaypointStore();
+
+    bool open(const char *gpxPath);
+    void close();
+    bool isOpen() const;
+    bool handles(const char *path) const;
+
+    bool add(const wayPoint &wp);
+    bool rename(const char *oldName, const char *newName);
+    bool remove(const char *name);
+    bool get(const char *name, wayPoint &wp);
+    std::vector<std::string> getNames();
+    void query(float minLat, float maxLat, float minLon, float maxLon, std::vector<uint32_t> &ids);
+    const WaypointEntry &getEntry(uint32_t id) const;
+    std::string getName(uint32_t id) const;
+    uint32_t getPositions(std::vector<WaypointPosition> &out);
+
+    bool compact();
+    bool exportGpx();
+    bool importGpx(const char *path);
+
+    uint32_t liveCount;     /**< Waypoints in the store */
+    uint32_t deadCount;     /**< Replaced or deleted records in the log */
+    uint32_t logSize;       /**< Log file size */
+    bool dirty;             /**< Log has changes not exported to the GPX file */
+    uint32_t generation;    /**< Changes on every index update, entry ids are only valid within one */
+
+private:
+    typedef std::vector<int32_t, PsramAllocator<int32_t>> SlotTable;
+
+    /**
+     * @brief Grid cell hash slot
+     */
+    struct Cell
+    {
+        int32_t key;        /**< Cell key, -1 = empty slot */
+        int32_t head;       /**< First entry in the cell */
+    };
+
+    std::string gpxPath;                                         /**< Waypoint GPX file */
+    std::string logPath;                                         /**< Log file */
+    FILE *logFile;                                               /**< Open log */
+    uint8_t *recordBuf;                                          /**< One record */
+    std::vector<WaypointEntry, PsramAllocator<WaypointEntry>> entries; /**< Indexed waypoints, log order */
+    std::vector<char, PsramAllocator<char>> names;               /**< Name arena */
+    SlotTable nameTable;                                         /**< Name hash table, entry ids */
+    size_t nameSlotsUsed;                                        /**< Name table slots not empty */
+    std::vector<Cell, PsramAllocator<Cell>> cellTable;           /**< Grid cell hash table */
+    uint32_t cellCount;                                          /**< Cells in use */
+    std::mutex mutex;                                            /**< Serializes GUI and CLI access */
+
+    bool openLog(bool create);
+    void clearIndex();
+    bool replay();
+    bool writeHeader();
+    bool append(const uint8_t *data, size_t len);
+    bool readRecord(uint32_t offset, uint8_t &op, const uint8_t *&payload, uint16_t &len);
+    size_t encodePut(uint8_t *out, const wayPoint &wp, const char *name);
+    size_t encodeDel(uint8_t *out, const char *name);
+    int32_t findSlot(const char *name, size_t len) const;
+    void indexPut(const char *name, size_t len, float lat, float lon, uint32_t offset);
+    bool indexDel(const char *name, size_t len);
+    void rehashNames(size_t capacity);
+    void rehashCells(size_t capacity);
+    int32_t *cellHead(int32_t key, bool create);
+    bool decodePut(const uint8_t *payload, uint16_t len, wayPoint &wp);
+    bool compactLocked();
+    bool exportLocked();
+    bool importLocked(const char *path);
+    void maybeCompact();
+};
+
+extern WaypointStore waypointStore;
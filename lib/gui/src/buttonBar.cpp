@@ -74,6 +74,8 @@ void buttonBarEvent(lv_event_t *event)
             loadOptions();
         } 
     }
+    if (strcmp(option,"search") == 0)
+        loadSearchScreen();
     if (strcmp(option,"settings") == 0)
     {
         isMainScreen = false;
@@ -246,6 +248,14 @@ void createButtonBarScr()
     lv_obj_set_style_size(imgBtn,48 * scaleBut, 48 * scaleBut, 0);
     lv_obj_add_flag(imgBtn, LV_OBJ_FLAG_CLICKABLE);
     lv_obj_add_event_cb(imgBtn, buttonBarEvent, LV_EVENT_PRESSED, (char*)"track");
+    // Search Button
+    imgBtn = lv_img_create(buttonBar);
+    lv_img_set_src(imgBtn, searchIconFile);
+    lv_img_set_zoom(imgBtn,buttonScale);
+    lv_obj_update_layout(imgBtn);
+    lv_obj_set_style_size(imgBtn,48 * scaleBut, 48 * scaleBut, 0);
+    lv_obj_add_flag(imgBtn, LV_OBJ_FLAG_CLICKABLE);
+    lv_obj_add_event_cb(imgBtn, buttonBarEvent, LV_EVENT_PRESSED, (char*)"search");
     // Settings Button
     imgBtn = lv_img_create(buttonBar);
     lv_img_set_src(imgBtn, settingsIconFile);
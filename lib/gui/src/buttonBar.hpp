@@ -12,6 +12,7 @@
 #include "mainScr.hpp"
 #include "gpxDetailScr.hpp"
 #include "gpxScr.hpp"
+#include "searchScr.hpp"
 
 static const char *waypointIconFile = "/wpt.bin";      /**< Waypoint icon file path. */
 static const char *trackIconFile = "/track.bin";       /**< Track icon file path. */
@@ -23,6 +24,7 @@ static const char *deleteIconFile = "/delete.bin";     /**< Delete icon file pat
 static const char *menuIconFile = "/menu.bin";         /**< Menu icon file path. */
 static const char *addWptIconFile = "/addwpt.bin";     /**< Add Waypoint icon file path. */
 static const char *exitIconFile = "/exit.bin";         /**< Exit icon file path. */
+static const char *searchIconFile = "/search.bin";     /**< Search icon file path. */
 
 static lv_obj_t *option; /**< Pointer to the currently selected option object (LVGL). */
 
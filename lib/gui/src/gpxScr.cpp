@@ -8,6 +8,9 @@
 
 #include "gpxScr.hpp"
 #include "esp_log.h"
+#include "turnDetector.hpp"
+#include "trackSimplify.hpp"
+#include "trackGrid.hpp"
 
 extern Maps mapView;
 extern Storage storage;
@@ -19,7 +22,12 @@ bool gpxTrack = false;
 bool isTrackLoaded = false;
 
 extern TrackVector trackData;   /**< Vector containing track waypoints */
-extern std::vector<TurnPoint> turnPoints; /**< Vector containing turn points */
+extern std::vector<TrackSegment> trackIndex; /**< Segment index of trackData */
+extern TrackVector navTrack;    /**< Simplified track for navigation and drawing */
+extern TrackIndexMap navTrackMap; /**< Full track index of each navTrack point */
+extern TrackGrid trackGrid;     /**< Spatial grid of navTrack segments */
+extern TrackProfile trackProfile; /**< Elevation profile of trackData */
+extern xSemaphoreHandle navMutex; /**< Navigation task lock on the tracks */
 
 lv_obj_t *listGPXScreen;                /**< Add Waypoint screen */
 
@@ -85,15 +93,30 @@ void gpxListEvent(lv_event_t *event)
 
                         if (gpxTrack)
                         {
+                            // The navigation task must not run on a track being replaced
+                            xSemaphoreTake(navMutex, portMAX_DELAY);
                             isTrackLoaded = false;
+                            turnDetector.cancel();
+                            trackProfile.clear();
                             trackData.clear();
                             trackData.shrink_to_fit();
-                            gpx.loadTrack(trackData);
-                            turnPoints = gpx.getTurnPointsSlidingWindow(18.0f, 10, 70.0f, 5, trackData);
-                            isTrackLoaded = !trackData.empty();
+                            trackGrid.clear();
+                            navTrack.clear();
+                            navTrack.shrink_to_fit();
+                            gpx.loadTrack(trackData, trackIndex);
+                            // A point at least every 25 m keeps the closest point search local
+                            simplifyTrack(trackData, {navSet.simplifyTolerance, 25.0f}, navTrack, navTrackMap);
+                            trackGrid.build(navTrack);
+                            trackProfile.build(trackData.accumDist, trackData.ele);
+                            ESP_LOGI(TAG, "Track simplified: %u -> %u points", (unsigned)trackData.size(),
+                                     (unsigned)navTrack.size());
+                            turnDetector.start(trackData, {18.0f, 10, 70.0f, 5}, &navTrack, &navTrackMap);
+                            isTrackLoaded = !navTrack.empty();
+                            xSemaphoreGive(navMutex);
                             lv_obj_clear_flag(turnByTurn,LV_OBJ_FLAG_HIDDEN);
-                            mapView.updateMap();
-                            mapView.redrawTrack();
+                            showProfile();
+                            mapView.setTrack(Maps::MAP_TRACK_ROUTE, navTrack.lat.data(), navTrack.lon.data(), navTrack.size(),
+                                             TFT_BLUE, 3);
                             lv_obj_send_event(mapTile, LV_EVENT_REFRESH, NULL);
                         }
                         closeMsg();
@@ -193,11 +216,14 @@ void updateGpxListScreen()
         gpxWaypoint = true;
         gpxTrack = false;
         uint16_t totalGpx = 1;
-        std::map<std::string, std::vector<std::string>> waypointByFile = GPXParser::getTagElementList(gpxWaypointTag, gpxNameElem, wptFolder);
-        for (std::map<std::string, std::vector<std::string>>::const_iterator it = waypointByFile.begin(); it != waypointByFile.end(); ++it)
+        GpxIndex wptIndex(wptFolder);
+        wptIndex.update();
+        for (const GpxFileInfo& gpxInfo : wptIndex.files)
         {
-            const std::string& fileName = it->first;
-            const std::vector<std::string>& waypointNames = it->second;
+            const std::string& fileName = gpxInfo.fileName;
+            // The user waypoint file is listed from the waypoint store index
+            const bool fromStore = waypointStore.isOpen() && fileName == strrchr(wptFile, '/') + 1;
+            const std::vector<std::string>& waypointNames = fromStore ? waypointStore.getNames() : gpxInfo.wptNames;
             for (const std::string& gpxTagValue : waypointNames)
             {
                 lv_table_set_cell_value_fmt(listGPXScreen, totalGpx, 0, LV_SYMBOL_GPS " - %s", gpxTagValue.c_str());
@@ -211,12 +237,12 @@ void updateGpxListScreen()
         gpxWaypoint = false;
         gpxTrack = true;
         uint16_t totalGpx = 1;
-        std::map<std::string, std::vector<std::string>> tracksByFile = GPXParser::getTagElementList(gpxTrackTag, gpxNameElem, trkFolder);
-        for (std::map<std::string, std::vector<std::string>>::const_iterator it = tracksByFile.begin(); it != tracksByFile.end(); ++it)
+        GpxIndex trkIndex(trkFolder);
+        trkIndex.update();
+        for (const GpxFileInfo& gpxInfo : trkIndex.files)
         {
-            const std::string& fileName = it->first;
-            const std::vector<std::string>& trackNames = it->second;
-            for (const std::string& trackName : trackNames)
+            const std::string& fileName = gpxInfo.fileName;
+            for (const std::string& trackName : gpxInfo.trkNames)
             {
                 lv_table_set_cell_value_fmt(listGPXScreen, totalGpx, 0, LV_SYMBOL_SHUFFLE " - %s", trackName.c_str());
                 lv_table_set_cell_value_fmt(listGPXScreen, totalGpx, 1, "%s", fileName.c_str());
@@ -8,6 +8,8 @@
 
 #include "mainScr.hpp"
 #include "tasks.hpp"
+#include "positionPredictor.hpp"
+#include "trackRecorder.hpp"
 
 bool isMainScreen = false;    
 bool isScrolled = true;      
@@ -40,6 +42,10 @@ lv_obj_t *btnZoomOut;
 lv_obj_t *mapCanvas;
 extern Maps mapView;
 
+PositionPredictor positionPredictor;   /**< Map position between GPS fixes */
+static bool positionGliding = false;   /**< Predicted position still moving, redraw the map every frame */
+static bool breadcrumbActive = false;  /**< Recorded fixes are drawn on the map */
+
 /**
  * @brief Update compass screen event
  *
@@ -172,10 +178,42 @@ void scrollTile(lv_event_t *event)
 /**
  * @brief Update Main Screen.
  *
- * @details Periodically updates the active main screen tiles and its widgets 
+ * @details Periodically updates the active main screen tiles and its widgets, applies
+ *          the latest result of the navigation task to the Turn By Turn and profile widgets, moves
+ *          the map position between GPS fixes (PositionPredictor) and draws the recorded breadcrumb.
  */
 void updateMainScreen(lv_timer_t *t)
 {
+    NavResult nav;
+    if (getNavResult(nav))
+    {
+        updateTurnByTurn(nav);
+        updateProfile(nav);
+    }
+
+    FixSample sample;
+    if (getFixSample(sample))
+    {
+        positionPredictor.onFix(sample.lat, sample.lon, sample.speed, sample.course, sample.time);
+        if (trackRecorder.isRecording())
+        {
+            // A new recording starts a new breadcrumb
+            if (!breadcrumbActive)
+                mapView.removeTrack(Maps::MAP_TRACK_BREADCRUMB);
+            breadcrumbActive = true;
+            mapView.addTrackPoint(Maps::MAP_TRACK_BREADCRUMB, sample.lat, sample.lon, TFT_RED, 2);
+        }
+        else
+            breadcrumbActive = false;
+    }
+    #ifdef ENABLE_COMPASS
+        positionPredictor.onHeading(globalSensorData.heading, millis());
+    #endif
+    float followLat, followLon;
+    positionGliding = positionPredictor.predict(millis(), followLat, followLon);
+    if (positionPredictor.hasFix())
+        mapView.setFollowPosition(followLat, followLon);
+
     if (isScrolled && isMainScreen || isScrollingMap)
     {
         #ifdef ENABLE_COMPASS
@@ -229,6 +267,8 @@ void updateMainScreen(lv_timer_t *t)
                     screenState.lastHeading = heading;
                     screenState.needsRedraw = true;
                 }
+                if (positionGliding && mapView.followGps)
+                    screenState.needsRedraw = true;
                 if (screenState.needsRedraw)
                 {
                     lv_obj_send_event(mapTile, LV_EVENT_VALUE_CHANGED, NULL);
@@ -303,7 +343,7 @@ void updateMap(lv_event_t *event)
         uint32_t now = millis();
         if (!(xEventGroupGetBits(mapView.mapEventGroup) & Maps::MAP_EVENT_START))
         {
-            if (gps.hasLocationChange() || (now - lastRotTime > 50 && abs(currHead - lastRotHeading) > 1.0f))
+            if (gps.hasLocationChange() || positionGliding || (now - lastRotTime > 50 && abs(currHead - lastRotHeading) > 1.0f))
             {
                 mapView.redrawMap = true;
                 xEventGroupSetBits(mapView.mapEventGroup, Maps::MAP_EVENT_DONE);
@@ -316,7 +356,8 @@ void updateMap(lv_event_t *event)
         xEventGroupSetBits(mapView.mapEventGroup, Maps::MAP_EVENT_DONE);
 
     static int16_t lastDispX = -32768, lastDispY = -32768;
-    if (mapView.offsetX != lastDispX || mapView.offsetY != lastDispY || (xEventGroupGetBits(mapView.mapEventGroup) & Maps::MAP_EVENT_DONE))
+    if (mapView.offsetX != lastDispX || mapView.offsetY != lastDispY || mapView.waypointsChanged() ||
+        (xEventGroupGetBits(mapView.mapEventGroup) & Maps::MAP_EVENT_DONE))
     {
         lastDispX = mapView.offsetX;
         lastDispY = mapView.offsetY;
@@ -587,6 +628,7 @@ void createMainScr()
     mapCompassWidget(mapTile);
     mapScaleWidget(mapTile);
     turnByTurnWidget(mapTile);
+    profileWidget(mapTile);
     btnZoomOut = lv_img_create(mapTile);
     lv_img_set_src(btnZoomOut, zoomOutIconFile);
     lv_img_set_zoom(btnZoomOut,buttonScale);
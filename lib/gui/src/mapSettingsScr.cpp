@@ -122,6 +122,20 @@ static void mapSettingsEvents(lv_event_t *event)
         else
             lv_obj_add_flag(scaleWidget,LV_OBJ_FLAG_HIDDEN);
     }
+
+    if (obj == checkWaypoints)
+    {
+        mapSet.showWaypoints = lv_obj_has_state(obj, LV_STATE_CHECKED);
+        cfg.saveBool(PKEYS::KMAP_WPTS, mapSet.showWaypoints);
+        xEventGroupSetBits(mapView.mapEventGroup, Maps::MAP_EVENT_DONE);
+    }
+
+    if (obj == checkPerf)
+    {
+        cfg.saveBool(PKEYS::KMAP_PERF, lv_obj_has_state(obj, LV_STATE_CHECKED));
+        loadMapProfile();
+        mapView.setFeatureFilter(mapSet.visibleGeoms, mapSet.visibleLayers);
+    }
 }
 
 /**
@@ -242,6 +256,32 @@ void createMapSettingsScr()
     else
         lv_obj_remove_state(checkScale, LV_STATE_CHECKED);
     lv_obj_add_event_cb(checkScale, mapSettingsEvents, LV_EVENT_VALUE_CHANGED, NULL);
+    // Show Waypoints
+    list = lv_list_add_btn(mapSettingsOptions, NULL, "Show Waypoints");
+    lv_obj_set_style_text_font(list, fontOptions, 0);
+    lv_obj_clear_flag(list, LV_OBJ_FLAG_CLICKABLE);
+    lv_obj_set_align(list, LV_ALIGN_LEFT_MID);
+    checkWaypoints = lv_checkbox_create(list);
+    lv_obj_align_to(checkWaypoints, list, LV_ALIGN_RIGHT_MID, 0, 0);
+    lv_checkbox_set_text(checkWaypoints, " ");
+    if (mapSet.showWaypoints)
+        lv_obj_add_state(checkWaypoints, LV_STATE_CHECKED);
+    else
+        lv_obj_remove_state(checkWaypoints, LV_STATE_CHECKED);
+    lv_obj_add_event_cb(checkWaypoints, mapSettingsEvents, LV_EVENT_VALUE_CHANGED, NULL);
+    // Performance Profile
+    list = lv_list_add_btn(mapSettingsOptions, NULL, "Performance Profile");
+    lv_obj_set_style_text_font(list, fontOptions, 0);
+    lv_obj_clear_flag(list, LV_OBJ_FLAG_CLICKABLE);
+    lv_obj_set_align(list, LV_ALIGN_LEFT_MID);
+    checkPerf = lv_checkbox_create(list);
+    lv_obj_align_to(checkPerf, list, LV_ALIGN_RIGHT_MID, 0, 0);
+    lv_checkbox_set_text(checkPerf, " ");
+    if (mapSet.perfProfile)
+        lv_obj_add_state(checkPerf, LV_STATE_CHECKED);
+    else
+        lv_obj_remove_state(checkPerf, LV_STATE_CHECKED);
+    lv_obj_add_event_cb(checkPerf, mapSettingsEvents, LV_EVENT_VALUE_CHANGED, NULL);
     // Back button
     btnBack = lv_btn_create(mapSettingsScreen);
     lv_obj_set_size(btnBack, TFT_WIDTH - 30, 40 * scale);
@@ -43,6 +43,8 @@ static lv_obj_t *checkCompass;         /**< Checkbox for enabling compass displa
 static lv_obj_t *checkCompassRot;      /**< Checkbox for enabling compass rotation. */
 static lv_obj_t *checkSpeed;           /**< Checkbox for displaying speed on the map. */
 static lv_obj_t *checkScale;           /**< Checkbox for displaying map scale. */
+static lv_obj_t *checkWaypoints;       /**< Checkbox for displaying the user waypoints. */
+static lv_obj_t *checkPerf;            /**< Checkbox for the vector map performance profile. */
 static lv_obj_t *checkFullScreen;      /**< Checkbox for enabling fullscreen map display. */
 
 
@@ -0,0 +1,208 @@
+/**
+ * @file searchScr.cpp
+ * @author Jordi Gauchía (jgauchia@jgauchia.com)
+ * @brief  LVGL - Place search screen
+ * @version 0.2.5
+ * @date 2026-04
+ */
+
+#include "searchScr.hpp"
+#include "mapVars.h"
+
+extern Maps mapView;
+extern Gps gps;
+extern wayPoint loadWpt;
+
+NameIndex nameIndex;
+
+lv_obj_t *searchScreen;        /**< Place search screen */
+static lv_obj_t *searchText;   /**< Query text area */
+static lv_obj_t *searchList;   /**< Places found */
+static std::vector<PlaceResult> searchResults;
+
+/**
+ * @brief Leave the search screen back to the map
+ */
+static void closeSearch()
+{
+    isMainScreen = true;
+    mapView.redrawMap = true;
+    lv_refr_now(display);
+    loadMainScreen();
+}
+
+/**
+ * @brief Go to a place found: shown as the navigation waypoint and centered on the map
+ *
+ * @param place Place selected
+ */
+static void goToPlace(const PlaceResult &place)
+{
+    loadWpt.name = strdup(place.name);
+    loadWpt.lat = place.lat;
+    loadWpt.lon = place.lon;
+
+    LV_IMG_DECLARE(navup);
+    lv_img_set_src(arrowNav, &navup);
+    lv_obj_clear_flag(navTile, LV_OBJ_FLAG_HIDDEN);
+    lv_label_set_text_fmt(latNav, "%s", latFormatString(loadWpt.lat));
+    lv_label_set_text_fmt(lonNav, "%s", lonFormatString(loadWpt.lon));
+    lv_label_set_text_fmt(nameNav, "%s", loadWpt.name);
+
+    // Streets are labelled at higher zooms than towns
+    if (zoom < place.zoom)
+    {
+        zoom = place.zoom > maxZoom ? maxZoom : place.zoom;
+        lv_label_set_text_fmt(zoomLabel, "%2d", zoom);
+    }
+    mapView.setWaypoint(loadWpt.lat, loadWpt.lon);
+    mapView.centerOn(loadWpt.lat, loadWpt.lon);
+    mapView.updateMap();
+    lv_obj_send_event(mapTile, LV_EVENT_REFRESH, NULL);
+    closeSearch();
+}
+
+/**
+ * @brief Search the places starting with the query and list them
+ *
+ * @details The nearest places come first among the same size, from the GPS position,
+ *          or from the map center without a fix.
+ */
+static void updateResults()
+{
+    lv_obj_clean(searchList);
+    searchResults.clear();
+    const char *query = lv_textarea_get_text(searchText);
+    if (strlen(query) < SEARCH_MIN_CHARS)
+        return;
+
+    float refLat = gps.gpsData.latitude;
+    float refLon = gps.gpsData.longitude;
+    if (!mapView.followGps || (refLat == 0 && refLon == 0))
+    {
+        refLat = mapView.currentMapTile.lat;
+        refLon = mapView.currentMapTile.lon;
+    }
+    nameIndex.search(query, refLat, refLon, SEARCH_MAX_RESULTS, searchResults);
+
+    if (searchResults.empty())
+    {
+        lv_list_add_text(searchList, "No places found");
+        return;
+    }
+    for (size_t i = 0; i < searchResults.size(); i++)
+    {
+        lv_obj_t *btn = lv_list_add_button(searchList, LV_SYMBOL_GPS, searchResults[i].name);
+        lv_obj_set_style_text_font(btn, fontOptions, 0);
+        lv_obj_add_event_cb(btn, searchResultEvent, LV_EVENT_CLICKED, (void *)(uintptr_t)i);
+    }
+}
+
+/**
+ * @brief Query text area event handler. Searches as the query changes, goes to the first place on enter.
+ *
+ * @param event LVGL event pointer.
+ */
+static void searchTextEvent(lv_event_t *event)
+{
+    lv_event_code_t code = lv_event_get_code(event);
+
+    if (code == LV_EVENT_VALUE_CHANGED)
+        updateResults();
+
+    #ifdef TDECK_ESP32S3
+        if (code == LV_EVENT_KEY && lv_indev_get_key(lv_indev_active()) == 35) // # Key (ESCAPE)
+            closeSearch();
+    #endif
+
+    if (code == LV_EVENT_READY)
+    {
+        if (!searchResults.empty())
+            goToPlace(searchResults[0]);
+        else
+            closeSearch();
+    }
+
+    if (code == LV_EVENT_CANCEL)
+        closeSearch();
+}
+
+/**
+ * @brief Place list event handler.
+ *
+ * @param event LVGL event pointer.
+ */
+static void searchResultEvent(lv_event_t *event)
+{
+    const size_t i = (size_t)(uintptr_t)lv_event_get_user_data(event);
+    if (i < searchResults.size())
+        goToPlace(searchResults[i]);
+}
+
+/**
+ * @brief Back label event handler.
+ *
+ * @param event LVGL event pointer.
+ */
+static void searchBackEvent(lv_event_t *event)
+{
+    closeSearch();
+}
+
+/**
+ * @brief Open the place search screen
+ *
+ * @details The index is opened the first time, the screen shows a message if the map has none.
+ */
+void loadSearchScreen()
+{
+    isMainScreen = false;
+    mapView.redrawMap = false;
+    if (!nameIndex.isOpen())
+        nameIndex.open(mapNameIndexFile);
+    lv_textarea_set_text(searchText, "");
+    lv_obj_clean(searchList);
+    searchResults.clear();
+    if (!nameIndex.isOpen())
+        lv_list_add_text(searchList, "No place index on the SD card");
+    lv_screen_load(searchScreen);
+}
+
+/**
+ * @brief Create Place search screen
+ *
+ * @details Text area for the query, the list of places found and the keyboard
+ *          (if not TDECK_ESP32S3).
+ */
+void createSearchScreen()
+{
+    searchScreen = lv_obj_create(NULL);
+    lv_obj_t *title = lv_label_create(searchScreen);
+    lv_obj_set_style_text_font(title, fontOptions, 0);
+    lv_label_set_text_static(title, LV_SYMBOL_LEFT " Search Place:");
+    lv_obj_align(title, LV_ALIGN_TOP_LEFT, 10, 10);
+    lv_obj_add_flag(title, LV_OBJ_FLAG_CLICKABLE);
+    lv_obj_add_event_cb(title, searchBackEvent, LV_EVENT_CLICKED, NULL);
+
+    searchText = lv_textarea_create(searchScreen);
+    lv_textarea_set_one_line(searchText, true);
+    lv_obj_align(searchText, LV_ALIGN_TOP_MID, 0, 40);
+    lv_obj_set_width(searchText, tft.width() - 10);
+    lv_obj_add_state(searchText, LV_STATE_FOCUSED);
+    lv_obj_add_event_cb(searchText, searchTextEvent, LV_EVENT_ALL, NULL);
+
+    searchList = lv_list_create(searchScreen);
+    lv_obj_set_width(searchList, tft.width() - 10);
+    lv_obj_align_to(searchList, searchText, LV_ALIGN_OUT_BOTTOM_MID, 0, 5);
+    #ifndef TDECK_ESP32S3
+        lv_obj_t *keyboard = lv_keyboard_create(searchScreen);
+        lv_keyboard_set_mode(keyboard, LV_KEYBOARD_MODE_TEXT_LOWER);
+        lv_keyboard_set_textarea(keyboard, searchText);
+        lv_obj_update_layout(searchScreen);
+        lv_obj_set_height(searchList, lv_obj_get_y(keyboard) - lv_obj_get_y(searchList) - 5);
+    #endif
+    #ifdef TDECK_ESP32S3
+        lv_obj_set_height(searchList, tft.height() - 100);
+        lv_group_add_obj(scrGroup, searchText);
+    #endif
+}
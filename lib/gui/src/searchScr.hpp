@@ -0,0 +1,26 @@
+/**
+ * @file searchScr.hpp
+ * @author Jordi Gauchía (jgauchia@jgauchia.com)
+ * @brief  LVGL - Place search screen
+ * @version 0.2.5
+ * @date 2026-04
+ */
+
+#pragma once
+
+#include "mainScr.hpp"
+#include "name_index.hpp"
+
+#define SEARCH_MIN_CHARS 2     /**< Query length that starts a search */
+#define SEARCH_MAX_RESULTS 20  /**< Places listed */
+
+extern NameIndex nameIndex;    /**< Place name search index */
+
+void loadMainScreen();
+
+static void searchTextEvent(lv_event_t *event);
+static void searchResultEvent(lv_event_t *event);
+static void searchBackEvent(lv_event_t *event);
+
+void loadSearchScreen();
+void createSearchScreen();
@@ -28,6 +28,17 @@ lv_obj_t *scaleLabel;
 lv_obj_t *turnByTurn;
 lv_obj_t *turnDistLabel;
 lv_obj_t *turnImg;
+lv_obj_t *profileCanvas;
+
+extern TrackVector navTrack;
+extern TrackProfile trackProfile;
+
+static const int32_t profileWidth = 160;          /**< Profile canvas width (px) */
+static const int32_t profileHeight = 48;          /**< Profile canvas height (px) */
+static const float profileBehind = 1000.0f;       /**< Track shown behind the position (m) */
+static const float profileAhead = 4000.0f;        /**< Track shown ahead of the position (m) */
+static uint16_t *profileBuffer = nullptr;         /**< Profile canvas RGB565 buffer */
+static int profileIdx = -1;                       /**< Track segment of the profile drawn */
 
 LV_IMG_DECLARE(straight);
 LV_IMG_DECLARE(slleft);
@@ -37,6 +48,7 @@ LV_IMG_DECLARE(tright);
 LV_IMG_DECLARE(uleft);
 LV_IMG_DECLARE(uright);
 LV_IMG_DECLARE(finish);
+LV_IMG_DECLARE(outtrack);
 
 extern Gps gps;
 
@@ -391,4 +403,128 @@ void turnByTurnWidget(lv_obj_t *screen)
     lv_obj_set_style_text_font(obj, &lv_font_montserrat_18, 0);
     lv_label_set_text_static(obj,"m.");
     lv_obj_add_flag(turnByTurn,LV_OBJ_FLAG_HIDDEN);
-}
\ No newline at end of file
+}
+
+/**
+ * @brief Apply a navigation result to the Turn By Turn widget, GUI task only
+ *
+ * @details The image and the label are only set when they change.
+ *
+ * @param nav Result published by the navigation task
+ */
+void updateTurnByTurn(const NavResult &nav)
+{
+    static const lv_img_dsc_t *const icons[] = { &straight, &slleft, &slright, &tleft, &tright, &finish, &outtrack };
+    static NavIcon lastIcon = NAV_ICON_STRAIGHT;
+    static int lastDist = 0;
+
+    if (nav.icon != lastIcon)
+    {
+        lv_img_set_src(turnImg, icons[nav.icon]);
+        lastIcon = nav.icon;
+    }
+
+    if (nav.turnDist >= 0 && nav.turnDist != lastDist)
+    {
+        lv_label_set_text_fmt(turnDistLabel, "%4d", nav.turnDist);
+        lastDist = nav.turnDist;
+    }
+}
+
+/**
+ * @brief Track elevation profile widget
+ *
+ * @details Canvas drawn from the track profile pyramid (TrackProfile), hidden until a
+ *          track with elevation is loaded.
+ *
+ * @param screen Pointer to the LVGL screen object where the profile widget will be created.
+ */
+void profileWidget(lv_obj_t *screen)
+{
+    profileBuffer = (uint16_t *)heap_caps_aligned_alloc(16, profileWidth * profileHeight * sizeof(uint16_t),
+                                                        MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT);
+    profileCanvas = lv_canvas_create(screen);
+    // Without a buffer the canvas stays hidden, showProfile() checks it
+    if (profileBuffer != nullptr)
+    {
+        lv_canvas_set_buffer(profileCanvas, profileBuffer, profileWidth, profileHeight, LV_COLOR_FORMAT_RGB565);
+        lv_canvas_fill_bg(profileCanvas, lv_color_black(), LV_OPA_100);
+    }
+    lv_obj_align(profileCanvas, LV_ALIGN_TOP_RIGHT, 0, 164);
+    lv_obj_add_flag(profileCanvas, LV_OBJ_FLAG_HIDDEN);
+}
+
+/**
+ * @brief Show the profile widget if the loaded track has elevation, GUI task only
+ *
+ * @details GPX tracks without elevation load it as 0, a flat profile is not shown.
+ */
+void showProfile()
+{
+    const ProfileSpan range = trackProfile.range();
+    if (profileBuffer == nullptr || trackProfile.empty() || !(range.max - range.min > 1.0f))
+    {
+        lv_obj_add_flag(profileCanvas, LV_OBJ_FLAG_HIDDEN);
+        return;
+    }
+    profileIdx = -1;
+    lv_obj_clear_flag(profileCanvas, LV_OBJ_FLAG_HIDDEN);
+}
+
+/**
+ * @brief Draw the elevation profile around the matched track position, GUI task only
+ *
+ * @details Each column is a vertical line from the min to the max elevation of its
+ *          distance range, scaled to the range of the window. Only the columns drawn
+ *          are queried, whatever the track length.
+ *
+ * @param nav Result published by the navigation task
+ */
+void updateProfile(const NavResult &nav)
+{
+    static ProfileSpan columns[profileWidth];
+
+    if (lv_obj_has_flag(profileCanvas, LV_OBJ_FLAG_HIDDEN))
+        return;
+    // The result may be from the track loaded before. While rerouting, trackIdx is on the route
+    if (nav.loadedIdx < 0 || (size_t)nav.loadedIdx >= navTrack.size() || nav.loadedIdx == profileIdx)
+        return;
+    profileIdx = nav.loadedIdx;
+
+    const float position = navTrack.accumDist[nav.loadedIdx];
+    trackProfile.query(position - profileBehind, position + profileAhead, profileWidth, columns);
+
+    float low = INFINITY, high = -INFINITY;
+    for (int32_t x = 0; x < profileWidth; x++)
+    {
+        if (std::isnan(columns[x].min))
+            continue;
+        low = std::min(low, columns[x].min);
+        high = std::max(high, columns[x].max);
+    }
+    // At least 10 m of height, so small steps on flat ground stay small
+    const float scale = (profileHeight - 1) / std::max(high - low, 10.0f);
+
+    // Min to max span of each column, the ground below it darker, the position in red
+    const lv_color_t ground = lv_palette_main(LV_PALETTE_LIGHT_BLUE);
+    const uint16_t back = lv_color_to_u16(lv_color_black());
+    const uint16_t span = lv_color_to_u16(ground);
+    const uint16_t below = lv_color_to_u16(lv_color_darken(ground, LV_OPA_50));
+    const uint16_t marker = lv_color_to_u16(lv_palette_main(LV_PALETTE_RED));
+    const int32_t markerX = (int32_t)(profileBehind * profileWidth / (profileBehind + profileAhead));
+    for (int32_t x = 0; x < profileWidth; x++)
+    {
+        int32_t top = profileHeight, bottom = profileHeight;
+        if (!std::isnan(columns[x].min))
+        {
+            top = profileHeight - 1 - (int32_t)((columns[x].max - low) * scale);
+            bottom = profileHeight - 1 - (int32_t)((columns[x].min - low) * scale);
+        }
+        for (int32_t y = 0; y < profileHeight; y++)
+        {
+            const uint16_t color = y < top ? back : y <= bottom ? span : below;
+            profileBuffer[y * profileWidth + x] = x == markerX ? marker : color;
+        }
+    }
+    lv_obj_invalidate(profileCanvas);
+}
@@ -13,6 +13,8 @@
 #include "settings.hpp"
 #include "mapVars.h"
 #include "styles.hpp"
+#include "navigation.hpp"
+#include "trackProfile.hpp"
 
 extern lv_obj_t *latitude;         /**< Latitude label */
 extern lv_obj_t *longitude;        /**< Longitude label */
@@ -34,6 +36,7 @@ extern lv_obj_t *scaleLabel;       /**< Scale label */
 extern lv_obj_t *turnByTurn;       /**< Turn-by-Turn navigation widget*/
 extern lv_obj_t *turnDistLabel;    /**< Label object showing turn distance */
 extern lv_obj_t *turnImg;          /**< Image object for turn indication */
+extern lv_obj_t *profileCanvas;    /**< Track elevation profile canvas */
 
 void editWidget(lv_event_t *event);
 void dragWidget(lv_event_t *event);
@@ -67,4 +70,8 @@ void mapZoomWidget(lv_obj_t *screen);
 void mapSpeedWidget(lv_obj_t *screen);
 void mapCompassWidget(lv_obj_t *screen);
 void mapScaleWidget(lv_obj_t *screen);
-void turnByTurnWidget(lv_obj_t *screen);
\ No newline at end of file
+void turnByTurnWidget(lv_obj_t *screen);
+void updateTurnByTurn(const NavResult &nav);
+void profileWidget(lv_obj_t *screen);
+void showProfile();
+void updateProfile(const NavResult &nav);
\ No newline at end of file
@@ -489,6 +489,7 @@ void initLVGL()
     createButtonBarScr();
     createGpxDetailScreen();
     createGpxListScreen();
+    createSearchScreen();
 
     // Create and start a periodic timer interrupt to call lv_tick_inc 
     const esp_timer_create_args_t periodic_timer_args = { .callback = &lv_tick_task, .name = "periodic_gui" };
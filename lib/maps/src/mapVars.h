@@ -9,7 +9,10 @@
 #pragma once
 
 static const char *mapRenderFolder = "/sdcard/MAP/%u/%u/%u.png"; /**< Render Maps file folder */
+static const char *mapQ565Folder = "/sdcard/MAP/%u/%u/%u.q565"; /**< Q565 Render Maps file folder */
 static const char *mapVectorFolder = "/sdcard/NAVMAP/Z%u.nav"; /**< Vector Maps file folder */
+static const char *mapNameIndexFile = "/sdcard/NAVMAP/names.idx"; /**< Place name search index */
+static const uint8_t wptClusterZoom = 15;                         /**< Waypoints are clustered below this zoom */
 static const char *noMapFile = "/spiffs/NOMAP.png";              /**< No map image file */
 static const char *map_scale[] = {"5000 Km", "2500 Km", "1500 Km",
                                         "700 Km", "350 Km", "150 Km",
@@ -13,6 +13,7 @@
 #include <cmath>
 #include <climits>
 #include <cstdint>
+#include <new>
 #include "esp_task_wdt.h"
 #include "tasks.hpp"
 #include "mainScr.hpp"
@@ -34,7 +35,6 @@
 extern Compass compass;
 extern Gps gps;
 extern Storage storage;
-extern TrackVector trackData;
 const char* TAG = "Maps";
 
 /**
@@ -58,7 +58,9 @@ Maps::Maps() : navLastZoom_(0),
     ringEndsCache.reserve(1024);
     placedLabelsCache.reserve(1024);
     navDataCache.reserve(NAV_DATA_CACHE_SIZE);
+    rasterTileBuf.reserve(mapTileSize * mapTileSize);
     mapMutex = xSemaphoreCreateMutex();
+    setFeatureFilter(0xFF, 0xFFFF);
     mapEventGroup = xEventGroupCreate();
     xTaskCreatePinnedToCore(mapRenderTask, "MapRenderTask", 16384, this, 1, &mapRenderTaskHandle, 0);
 }
@@ -276,11 +278,8 @@ void Maps::initMap(uint16_t mapHeight, uint16_t mapWidth)
     Maps::mapTempSprite.loadFont("/spiffs/font.vlw");
     Maps::mapSprite.createSprite(mapWidth, mapHeight);
     Maps::mapBuffer = Maps::mapSprite.getBuffer();
-    Maps::preloadSprite.deleteSprite();
-    Maps::preloadSprite.createSprite(mapTileSize * 2, mapTileSize * 2);
     Maps::oldMapTile = {};
     Maps::currentMapTile = {};
-    Maps::roundMapTile = {};
     Maps::navArrowPosition = {0, 0};
     Maps::totalBounds = {90.0f, -90.0f, 180.0f, -180.0f};
 }
@@ -290,8 +289,9 @@ void Maps::initMap(uint16_t mapHeight, uint16_t mapWidth)
  */
 void Maps::deleteMapScrSprites()
 {
-    NavReader::closePack();
-    Maps::preloadSprite.deleteSprite();
+    // Prefetch reads given up on still use the pack, it is closed on the next pack switch
+    if (navFetchesInFlight.load() == 0)
+        NavReader::closePack();
 }
 
 /**
@@ -303,25 +303,111 @@ void Maps::createMapScrSprites()
 }
 
 /**
- * @brief Draw current track on map
+ * @brief Draw the tracks on map
+ *
+ * @details Draws the runs of the track overlay crossing the temp sprite, each track with
+ *          its own style, skipping points that fall on the previous pixel. Called with
+ *          mapMutex taken.
  */
 void Maps::drawTrack(TFT_eSprite &map)
 {
-    for (size_t i = 1; i < trackData.size(); ++i)
+    if (navTlTileX_ < 0 || navTlTileY_ < 0)
+        return;
+
+    const int32_t originX = (int32_t)(navTlTileX_ * mapTileSize);
+    const int32_t originY = (int32_t)(navTlTileY_ * mapTileSize);
+    const int32_t margin = 8;
+    trackOverlay.query(navLastZoom_, originX - margin, originY - margin, tileWidth + 2 * margin, tileHeight + 2 * margin,
+                       trackRuns);
+
+    for (const TrackRun &run : trackRuns)
     {
-        const auto &p1 = trackData[i - 1];
-        const auto &p2 = trackData[i];
-        int16_t x1;
-        int16_t y1;
-        int16_t x2;
-        int16_t y2;
-        latLonToPixel(p1.lat, p1.lon, x1, y1);
-        latLonToPixel(p2.lat, p2.lon, x2, y2);
-        if ((x1 >= 0 && x1 < tileWidth && y1 >= 0 && y1 < tileHeight) || (x2 >= 0 && x2 < tileWidth && y2 >= 0 && y2 < tileHeight))
-            map.drawWideLine(x1, y1, x2, y2, 3, TFT_BLUE);
+        const TrackStyle style = trackOverlay.style(run.track);
+        int32_t x1, y1;
+        trackOverlay.vertex(run.track, run.first, navLastZoom_, x1, y1);
+        for (uint32_t i = run.first + 1; i <= run.last; i++)
+        {
+            int32_t x2, y2;
+            trackOverlay.vertex(run.track, i, navLastZoom_, x2, y2);
+            if (x2 == x1 && y2 == y1 && i != run.last)
+                continue;
+            map.drawWideLine(x1 - originX, y1 - originY, x2 - originX, y2 - originY, style.width, style.color);
+            x1 = x2;
+            y1 = y2;
+        }
     }
 }
 
+/**
+ * @brief Show a track on the map, replacing the one in its slot
+ *
+ * @param slot Track slot (MAP_TRACK_ROUTE, MAP_TRACK_BREADCRUMB or a reference slot)
+ * @param lat Latitudes (degrees)
+ * @param lon Longitudes (degrees)
+ * @param count Points
+ * @param color RGB565 line color
+ * @param width Line width (pixels)
+ */
+void Maps::setTrack(uint8_t slot, const float *lat, const float *lon, size_t count, uint16_t color, uint8_t width)
+{
+    xSemaphoreTake(mapMutex, portMAX_DELAY);
+    trackOverlay.set(slot, lat, lon, count, {color, width});
+    if (slot == MAP_TRACK_BREADCRUMB)
+        breadcrumbPending.clear();
+    xSemaphoreGive(mapMutex);
+    updateMap();
+    redrawTrack();
+}
+
+/**
+ * @brief Add a point at the end of a track (recorded breadcrumb)
+ *
+ * @details Called by the GUI task on each fix. If the render task holds the map, the
+ *          point waits for the next call, the GUI task never blocks on a render.
+ *
+ * @param slot Track slot
+ * @param lat Latitude (degrees)
+ * @param lon Longitude (degrees)
+ * @param color RGB565 line color
+ * @param width Line width (pixels)
+ */
+void Maps::addTrackPoint(uint8_t slot, float lat, float lon, uint16_t color, uint8_t width)
+{
+    breadcrumbPending.push_back({lat, lon});
+    if (xSemaphoreTake(mapMutex, 0) != pdTRUE)
+        return;
+    for (const PendingPoint &p : breadcrumbPending)
+        trackOverlay.append(slot, p.lat, p.lon, {color, width});
+    breadcrumbPending.clear();
+    xSemaphoreGive(mapMutex);
+    redrawTrack();
+}
+
+/**
+ * @brief Remove a track from the map
+ *
+ * @param slot Track slot
+ */
+void Maps::removeTrack(uint8_t slot)
+{
+    xSemaphoreTake(mapMutex, portMAX_DELAY);
+    trackOverlay.remove(slot);
+    if (slot == MAP_TRACK_BREADCRUMB)
+        breadcrumbPending.clear();
+    xSemaphoreGive(mapMutex);
+    updateMap();
+}
+
+/**
+ * @brief Points of a track on the map
+ *
+ * @param slot Track slot
+ */
+size_t Maps::trackPoints(uint8_t slot) const
+{
+    return trackOverlay.points(slot);
+}
+
 /**
  * @brief Request track redraw
  */
@@ -346,8 +432,10 @@ void Maps::generateMap(uint8_t zoom)
         resetScrollState();
     }
 
-    const float lat = Maps::followGps ? gps.gpsData.latitude : Maps::currentMapTile.lat;
-    const float lon = Maps::followGps ? gps.gpsData.longitude : Maps::currentMapTile.lon;
+    float lat = Maps::currentMapTile.lat;
+    float lon = Maps::currentMapTile.lon;
+    if (Maps::followGps)
+        getFollowPosition(lat, lon);
 
     if (mapSet.vectorMap)
     {
@@ -382,7 +470,11 @@ void Maps::generateMap(uint8_t zoom)
         navLastZoom_ = zoom;
         navNeedsRender_ = false;
         latLonToPixel(destLat, destLon, (int16_t&)wptPosX, (int16_t&)wptPosY);
-        drawTrack(mapTempSprite);
+        if (xSemaphoreTake(mapMutex, pdMS_TO_TICKS(100)) == pdTRUE)
+        {
+            drawTrack(mapTempSprite);
+            xSemaphoreGive(mapMutex);
+        }
         Maps::redrawMap = true;
         return;
     }
@@ -392,6 +484,13 @@ void Maps::generateMap(uint8_t zoom)
 
     if (centerTileIdxX != Maps::oldMapTile.tilex || centerTileIdxY != Maps::oldMapTile.tiley || zoom != Maps::oldMapTile.zoom)
     {
+        if (xSemaphoreTake(mapMutex, pdMS_TO_TICKS(100)) != pdTRUE)
+            return;
+
+        const int32_t shiftX = (int32_t)centerTileIdxX - (int32_t)Maps::oldMapTile.tilex;
+        const int32_t shiftY = (int32_t)centerTileIdxY - (int32_t)Maps::oldMapTile.tiley;
+        const bool isShift = Maps::isMapFound && zoom == Maps::oldMapTile.zoom && abs(shiftX) <= 1 && abs(shiftY) <= 1;
+
         Maps::oldMapTile.tilex = centerTileIdxX;
         Maps::oldMapTile.tiley = centerTileIdxY;
         Maps::oldMapTile.zoom = zoom;
@@ -401,88 +500,26 @@ void Maps::generateMap(uint8_t zoom)
         navTlTileX_ = (float)tlX;
         navTlTileY_ = (float)tlY;
         navLastZoom_ = zoom;
-        Maps::mapTempSprite.fillSprite(TFT_WHITE);
-        Maps::totalBounds = {90.0f, -90.0f, 180.0f, -180.0f};
-        bool centerFound = false;
+        rasterCenterX_ = centerTileIdxX;
+        rasterCenterY_ = centerTileIdxY;
 
-        if (tilesGrid == 3)
+        if (isShift)
         {
-            static const int8_t spiralOrder[9][2] = {{1,1}, {0,1}, {1,0}, {2,1}, {1,2}, {0,0}, {2,0}, {0,2}, {2,2}};
-            for (int i = 0; i < 9; i++)
-            {
-                int gx = spiralOrder[i][0];
-                int gy = spiralOrder[i][1];
-                uint32_t tx = tlX + gx;
-                uint32_t ty = tlY + gy;
-                int16_t sx = gx * mapTileSize;
-                int16_t sy = gy * mapTileSize;
-                char tilePath[128];
-                snprintf(tilePath, sizeof(tilePath), mapRenderFolder, zoom, tx, ty);
-
-                if (mapTempSprite.drawPngFile(tilePath, sx, sy))
-                {
-                    if (tx == centerTileIdxX && ty == centerTileIdxY)
-                        centerFound = true;
-
-                    const tileBounds currentBounds = Maps::getTileBounds(tx, ty, zoom);
-                    if (currentBounds.lat_min < Maps::totalBounds.lat_min)
-                        Maps::totalBounds.lat_min = currentBounds.lat_min;
-                    if (currentBounds.lat_max > Maps::totalBounds.lat_max)
-                        Maps::totalBounds.lat_max = currentBounds.lat_max;
-                    if (currentBounds.lon_min < Maps::totalBounds.lon_min)
-                        Maps::totalBounds.lon_min = currentBounds.lon_min;
-                    if (currentBounds.lon_max > Maps::totalBounds.lon_max)
-                        Maps::totalBounds.lon_max = currentBounds.lon_max;
-                }
-                else
-                {
-                    mapTempSprite.fillRect(sx, sy, 256, 256, TFT_BLACK);
-                    mapTempSprite.drawPngFile(noMapFile, sx + 256 / 2 - 50, sy + 256 / 2 - 50);
-                }
-            }
+            // Keep the tiles still in view, only the exposed edge has to be decoded
+            Maps::mapTempSprite.scroll(-shiftX * mapTileSize, -shiftY * mapTileSize);
+            queueRasterGrid(tlX, tlY, shiftX, shiftY, !pendingTiles.empty());
         }
         else
         {
-            for (int gy = 0; gy < tilesGrid; gy++)
-            {
-                for (int gx = 0; gx < tilesGrid; gx++)
-                {
-                    uint32_t tx = tlX + gx;
-                    uint32_t ty = tlY + gy;
-                    int16_t sx = gx * mapTileSize;
-                    int16_t sy = gy * mapTileSize;
-                    char tilePath[128];
-                    snprintf(tilePath, sizeof(tilePath), mapRenderFolder, zoom, tx, ty);
-
-                    if (mapTempSprite.drawPngFile(tilePath, sx, sy))
-                    {
-                        if (tx == centerTileIdxX && ty == centerTileIdxY)
-                            centerFound = true;
-
-                        const tileBounds currentBounds = Maps::getTileBounds(tx, ty, zoom);
-                        if (currentBounds.lat_min < Maps::totalBounds.lat_min)
-                            Maps::totalBounds.lat_min = currentBounds.lat_min;
-                        if (currentBounds.lat_max > Maps::totalBounds.lat_max)
-                            Maps::totalBounds.lat_max = currentBounds.lat_max;
-                        if (currentBounds.lon_min < Maps::totalBounds.lon_min)
-                            Maps::totalBounds.lon_min = currentBounds.lon_min;
-                        if (currentBounds.lon_max > Maps::totalBounds.lon_max)
-                            Maps::totalBounds.lon_max = currentBounds.lon_max;
-                    }
-                    else
-                    {
-                        mapTempSprite.fillRect(sx, sy, 256, 256, TFT_BLACK);
-                        mapTempSprite.drawPngFile(noMapFile, sx + 256 / 2 - 50, sy + 256 / 2 - 50);
-                    }
-                }
-            }
+            Maps::mapTempSprite.fillSprite(TFT_WHITE);
+            queueRasterGrid(tlX, tlY, 0, 0, true);
         }
 
-        Maps::isMapFound = centerFound;
-        if (!centerFound)
-            showNoMap(mapTempSprite);
+        const tileBounds tlBounds = Maps::getTileBounds(tlX, tlY, zoom);
+        const tileBounds brBounds = Maps::getTileBounds(tlX + tilesGrid - 1, tlY + tilesGrid - 1, zoom);
+        Maps::totalBounds = {brBounds.lat_min, tlBounds.lat_max, tlBounds.lon_min, brBounds.lon_max};
 
-        if (Maps::isMapFound && Maps::isCoordInBounds(Maps::destLat, Maps::destLon, Maps::totalBounds))
+        if (Maps::isCoordInBounds(Maps::destLat, Maps::destLon, Maps::totalBounds))
             Maps::coords2map(Maps::destLat, Maps::destLon, Maps::totalBounds, &wptPosX, &wptPosY);
         else
         {
@@ -490,9 +527,50 @@ void Maps::generateMap(uint8_t zoom)
             Maps::wptPosY = -1;
         }
 
-        drawTrack(mapTempSprite);
-        redrawMap = true;
-        xEventGroupSetBits(mapEventGroup, MAP_EVENT_DONE);
+        xSemaphoreGive(mapMutex);
+    }
+}
+
+/**
+ * @brief Queue the raster tiles of the grid for the render task
+ *
+ * @details Tiles are pushed from the outer ring inwards, so the render task (which pops
+ *          from the back) decodes the center tile first. With a shift only the tiles that
+ *          were not on the previous grid are queued, unless a full reload is requested. The
+ *          center tile is always queued, as it sets isMapFound for the new grid.
+ *          Must be called with mapMutex held.
+ *
+ * @param tlX Top-left X tile of the grid
+ * @param tlY Top-left Y tile of the grid
+ * @param shiftX Grid shift in tiles since the previous grid
+ * @param shiftY Grid shift in tiles since the previous grid
+ * @param fullGrid Queue every tile of the grid
+ */
+void Maps::queueRasterGrid(int32_t tlX, int32_t tlY, int32_t shiftX, int32_t shiftY, bool fullGrid)
+{
+    const int8_t gridCenter = tilesGrid / 2;
+    pendingTiles.clear();
+
+    for (int8_t ring = gridCenter; ring >= 0; ring--)
+    {
+        for (int8_t gy = 0; gy < tilesGrid; gy++)
+        {
+            for (int8_t gx = 0; gx < tilesGrid; gx++)
+            {
+                if (std::max(abs(gx - gridCenter), abs(gy - gridCenter)) != ring)
+                    continue;
+
+                if (!fullGrid && ring != 0)
+                {
+                    const int32_t oldGx = gx + shiftX;
+                    const int32_t oldGy = gy + shiftY;
+                    if (oldGx >= 0 && oldGx < tilesGrid && oldGy >= 0 && oldGy < tilesGrid)
+                        continue;
+                }
+
+                pendingTiles.push_back({(uint32_t)(tlX + gx), (uint32_t)(tlY + gy), (int16_t)(gx * mapTileSize), (int16_t)(gy * mapTileSize), TILE_PNG});
+            }
+        }
     }
 }
 
@@ -510,6 +588,7 @@ void Maps::mapRenderTask(void* pvParameters)
         {
             if (xSemaphoreTake(instance->mapMutex, pdMS_TO_TICKS(200)) == pdTRUE)
             {
+                const uint32_t jobStart = millis();
                 bool fullReset = (instance->zoomLevel != lastZoom) || (instance->pendingTiles.size() >= (tilesGrid * tilesGrid));
                 lastZoom = instance->zoomLevel;
 
@@ -532,6 +611,16 @@ void Maps::mapRenderTask(void* pvParameters)
                         instance->layers[i].clear();
                 }
 
+                // The card wait is not part of the frame times
+                const uint32_t fetchStart = millis();
+                if (mapSet.vectorMap && !instance->prefetchNavTiles(instance->zoomLevel))
+                {
+                    xEventGroupClearBits(instance->mapEventGroup, MAP_EVENT_START);
+                    continue;
+                }
+                const uint32_t fetchMs = millis() - fetchStart;
+
+                bool holdsMutex = true;
                 while (!instance->pendingTiles.empty())
                 {
                     PendingTile t = instance->pendingTiles.back();
@@ -540,14 +629,36 @@ void Maps::mapRenderTask(void* pvParameters)
                         instance->renderNavTile(t.x, t.y, instance->zoomLevel, t.screenX, t.screenY, instance->mapTempSprite);
                     else if (t.type == TILE_PNG)
                     {
-                        instance->renderPngTile(t.x, t.y, instance->zoomLevel, t.screenX, t.screenY, instance->mapTempSprite);
+                        const bool found = instance->renderPngTile(t.x, t.y, instance->zoomLevel, t.screenX, t.screenY, instance->mapTempSprite);
+                        if (t.x == instance->rasterCenterX_ && t.y == instance->rasterCenterY_)
+                        {
+                            instance->isMapFound = found;
+                            if (!found)
+                            {
+                                instance->pendingTiles.clear();
+                                instance->showNoMap(instance->mapTempSprite);
+                            }
+                        }
+
+                        // Publish every decoded tile, the grid fills in progressively
+                        instance->redrawMap = true;
+                        xEventGroupSetBits(instance->mapEventGroup, MAP_EVENT_DONE);
                         xSemaphoreGive(instance->mapMutex);
                         vTaskDelay(1);
                         if (xSemaphoreTake(instance->mapMutex, pdMS_TO_TICKS(100)) != pdTRUE)
+                        {
+                            holdsMutex = false;
                             break;
+                        }
                     }
                 }
 
+                if (!holdsMutex)
+                {
+                    xEventGroupClearBits(instance->mapEventGroup, MAP_EVENT_START);
+                    continue;
+                }
+
                 if (!mapSet.vectorMap)
                 {
                     instance->drawTrack(instance->mapTempSprite);
@@ -558,44 +669,44 @@ void Maps::mapRenderTask(void* pvParameters)
                     continue;
                 }
 
-                instance->placedLabelsCache.clear();
-                instance->mapTempSprite.startWrite();
-                uint32_t lastYield = millis();
-                uint32_t loopCounter = 0;
+                // The budget covers the layers only, the tiles are decoded whatever it is
+                const uint16_t deferredLayers = instance->renderNavLayers(millis(), mapSet.renderBudget);
+                instance->renderStats.layersDeferred = __builtin_popcount(deferredLayers);
+                instance->renderStats.features = instance->featurePool.size();
+                instance->renderStats.fetchMs = fetchMs;
+                instance->renderStats.firstFrameMs = millis() - jobStart - fetchMs;
+                instance->renderStats.slices = 1;
 
-                for (uint8_t pass = 1; pass <= 2; pass++)
+                if (deferredLayers != 0)
                 {
-                    for (int i = 0; i < 16; i++)
+                    // Publish the essential layers, then complete the frame in a later slice
+                    instance->drawTrack(instance->mapTempSprite);
+                    instance->redrawMap = true;
+                    xEventGroupSetBits(instance->mapEventGroup, MAP_EVENT_DONE);
+                    xSemaphoreGive(instance->mapMutex);
+                    vTaskDelay(pdMS_TO_TICKS(10));
+                    if (xSemaphoreTake(instance->mapMutex, pdMS_TO_TICKS(200)) != pdTRUE)
                     {
-                        const auto& layer = instance->layers[i];
-                        if (layer.empty())
-                            continue;
-
-                        for (uint16_t idx : layer)
-                        {
-                            if ((++loopCounter & 15) == 0)
-                            {
-                                uint32_t now = millis();
-                                if (now - lastYield > 20)
-                                {
-                                    instance->mapTempSprite.endWrite();
-                                    vTaskDelay(1);
-                                    instance->mapTempSprite.startWrite();
-                                    lastYield = millis();
-                                }
-                            }
+                        xEventGroupClearBits(instance->mapEventGroup, MAP_EVENT_START);
+                        continue;
+                    }
 
-                            const auto& feat = instance->featurePool[idx];
-                            instance->renderNavFeature(feat, instance->mapTempSprite, pass, instance->placedLabelsCache);
-                        }
-                        esp_task_wdt_reset();
+                    // A new viewport repaints every layer anyway
+                    if (instance->pendingTiles.empty())
+                    {
+                        instance->renderNavLayers(millis(), 0);
+                        instance->renderStats.slices++;
                     }
                 }
 
-                instance->mapTempSprite.endWrite();
                 for (auto& entry : instance->navDataCache)
                     entry.isPinned = false;
 
+                instance->renderStats.frameMs = millis() - jobStart - fetchMs;
+                ESP_LOGD(TAG, "Frame %lu ms (first %lu ms), %u features, %u layers deferred",
+                         (unsigned long)instance->renderStats.frameMs, (unsigned long)instance->renderStats.firstFrameMs,
+                         instance->renderStats.features, instance->renderStats.layersDeferred);
+
                 instance->drawTrack(instance->mapTempSprite);
                 instance->redrawMap = true;
                 xEventGroupSetBits(instance->mapEventGroup, MAP_EVENT_DONE);
@@ -607,6 +718,70 @@ void Maps::mapRenderTask(void* pvParameters)
     }
 }
 
+/**
+ * @brief Render the NAV feature layers in draw order
+ *
+ * @details Layers are drawn from priority 0 upwards in two passes. With a frame budget, the
+ *          low-priority layers (below NAV_DEFER_LAYERS: background areas, buildings, minor
+ *          POIs) are skipped once the budget since the start of the job is spent, so roads
+ *          and labels reach the screen first. Skipped layers are returned as a bitmask and
+ *          the caller repaints the whole stack later to keep the draw order.
+ *
+ * @param startMs Start time of the render job (ms)
+ * @param budgetMs Frame budget in ms, 0 renders every layer
+ * @return Bitmask of the deferred layers
+ */
+uint16_t Maps::renderNavLayers(uint32_t startMs, uint16_t budgetMs)
+{
+    uint16_t deferredLayers = 0;
+    uint32_t lastYield = millis();
+    uint32_t loopCounter = 0;
+
+    placedLabelsCache.clear();
+    mapTempSprite.startWrite();
+
+    for (uint8_t pass = 1; pass <= 2; pass++)
+    {
+        for (int i = 0; i < 16; i++)
+        {
+            const auto& layer = layers[i];
+            if (layer.empty())
+                continue;
+
+            if (i < NAV_DEFER_LAYERS && budgetMs > 0)
+            {
+                if ((deferredLayers & (1 << i)) || millis() - startMs > budgetMs)
+                {
+                    deferredLayers |= (1 << i);
+                    continue;
+                }
+            }
+
+            for (uint16_t idx : layer)
+            {
+                if ((++loopCounter & 15) == 0)
+                {
+                    uint32_t now = millis();
+                    if (now - lastYield > 20)
+                    {
+                        mapTempSprite.endWrite();
+                        vTaskDelay(1);
+                        mapTempSprite.startWrite();
+                        lastYield = millis();
+                    }
+                }
+
+                const auto& feat = featurePool[idx];
+                renderNavFeature(feat, mapTempSprite, pass, placedLabelsCache);
+            }
+            esp_task_wdt_reset();
+        }
+    }
+
+    mapTempSprite.endWrite();
+    return deferredLayers;
+}
+
 /**
  * @brief Render a single PNG tile
  * 
@@ -616,16 +791,76 @@ void Maps::mapRenderTask(void* pvParameters)
  * @param screenX X PNG position on sprite
  * @param screenY Y PNG position on sprite
  * @param map Map sprite
+ * @return true if the tile was found
  */
-void Maps::renderPngTile(uint32_t tileX, uint32_t tileY, uint8_t zoom, int16_t screenX, int16_t screenY, TFT_eSprite &map)
+bool Maps::renderPngTile(uint32_t tileX, uint32_t tileY, uint8_t zoom, int16_t screenX, int16_t screenY, TFT_eSprite &map)
+{
+    if (drawRasterTile(tileX, tileY, zoom, screenX, screenY, map))
+        return true;
+
+    map.fillRect(screenX, screenY, mapTileSize, mapTileSize, TFT_BLACK);
+    map.drawPngFile(noMapFile, screenX + mapTileSize / 2 - 50, screenY + mapTileSize / 2 - 50);
+    return false;
+}
+
+/**
+ * @brief Draw a raster tile, preferring the Q565 encoding over PNG
+ *
+ * @details Decided per tile, so a partly converted tile set uses every Q565 tile it has.
+ *
+ * @param tileX X Tile
+ * @param tileY Y Tile
+ * @param zoom Zoom level
+ * @param screenX X tile position on sprite
+ * @param screenY Y tile position on sprite
+ * @param map Map sprite
+ * @return true if the tile was drawn
+ */
+bool Maps::drawRasterTile(uint32_t tileX, uint32_t tileY, uint8_t zoom, int16_t screenX, int16_t screenY, TFT_eSprite &map)
 {
     char tilePath[128];
+    snprintf(tilePath, sizeof(tilePath), mapQ565Folder, zoom, tileX, tileY);
+    if (drawQ565File(tilePath, map, screenX, screenY, rasterTileBuf))
+        return true;
+
     snprintf(tilePath, sizeof(tilePath), mapRenderFolder, zoom, tileX, tileY);
-    if (!map.drawPngFile(tilePath, screenX, screenY))
+    return map.drawPngFile(tilePath, screenX, screenY);
+}
+
+/**
+ * @brief Draw a Q565 encoded tile file
+ *
+ * @details Reads the whole tile into a reusable PSRAM buffer and decodes it straight
+ *          into the sprite framebuffer. Each task needs its own buffer, the render task
+ *          uses rasterTileBuf.
+ *
+ * @param path Tile file path
+ * @param map Target sprite
+ * @param screenX X tile position on sprite
+ * @param screenY Y tile position on sprite
+ * @param buffer File buffer, resized to the tile
+ * @return true if the tile was decoded
+ */
+bool Maps::drawQ565File(const char* path, TFT_eSprite &map, int16_t screenX, int16_t screenY, TileBuffer &buffer)
+{
+    FILE* file = storage.open(path, "rb");
+    if (!file)
+        return false;
+
+    const size_t fileSize = storage.fileAvailable(file);
+    if (fileSize < Q565_HEADER_SIZE)
     {
-        map.fillRect(screenX, screenY, mapTileSize, mapTileSize, TFT_BLACK);
-        map.drawPngFile(noMapFile, screenX + mapTileSize / 2 - 50, screenY + mapTileSize / 2 - 50);
+        storage.close(file);
+        return false;
     }
+
+    buffer.resize(fileSize);
+    const size_t bytesRead = storage.read(file, buffer.data(), fileSize);
+    storage.close(file);
+    if (bytesRead != fileSize)
+        return false;
+
+    return RasterTile::decode(buffer.data(), fileSize, (uint16_t*)map.getBuffer(), map.width(), map.height(), screenX, screenY);
 }
 
 /**
@@ -654,8 +889,8 @@ void Maps::displayMap()
 
     if (Maps::followGps)
     {
-        const float lat = gps.gpsData.latitude;
-        const float lon = gps.gpsData.longitude;
+        float lat, lon;
+        getFollowPosition(lat, lon);
         const int8_t gridOffset = tilesGrid / 2;
         Maps::navArrowPosition = Maps::coord2ScreenPos(lon, lat, Maps::zoomLevel, Maps::mapTileSize);
         
@@ -668,6 +903,9 @@ void Maps::displayMap()
         
         // Rotate and crop directly to mapSprite
         Maps::mapTempSprite.pushRotated(&mapSprite, 360 - mapHeading, TFT_TRANSPARENT);
+        drawWaypoints((int32_t)(navTlTileX_ * mapTileSize) + gridOffset * mapTileSize + Maps::navArrowPosition.posX,
+                      (int32_t)(navTlTileY_ * mapTileSize) + gridOffset * mapTileSize + Maps::navArrowPosition.posY,
+                      (360 - mapHeading) % 360);
     }
     else
     {
@@ -675,12 +913,80 @@ void Maps::displayMap()
         int16_t cropX = (tileWidth - mapScrWidth) / 2 + offsetX;
         int16_t cropY = (tileHeight - mapScrHeight) / 2 + offsetY;
         mapTempSprite.pushSprite(&mapSprite, -cropX, -cropY);
+        drawWaypoints((int32_t)(navTlTileX_ * mapTileSize) + cropX + mapScrWidth / 2,
+                      (int32_t)(navTlTileY_ * mapTileSize) + cropY + mapScrHeight / 2, 0);
     }
 
     tft.endWrite();
     xSemaphoreGive(mapMutex);
 }
 
+/**
+ * @brief Draw the user waypoints over the screen map
+ *
+ * @details Drawn on the screen sprite after the map is cropped, so adding or deleting a
+ *          waypoint only needs the map to be displayed again, not rendered. The overlay
+ *          snapshot is taken again when the waypoint store changes. Below wptClusterZoom
+ *          the waypoints close on screen are one mark with their count.
+ *
+ * @param centerX World pixel X of the screen center
+ * @param centerY World pixel Y of the screen center
+ * @param angle Map rotation (degrees clockwise)
+ */
+void Maps::drawWaypoints(int32_t centerX, int32_t centerY, uint16_t angle)
+{
+    if (!mapSet.showWaypoints)
+        return;
+
+    if (!wptOverlay.built || wptOverlay.generation != waypointStore.generation)
+    {
+        std::vector<WaypointPosition> positions;
+        const uint32_t generation = waypointStore.getPositions(positions);
+        wptOverlay.build(positions, generation);
+    }
+    if (wptOverlay.size() == 0)
+        return;
+
+    // A rotated screen covers the square around its diagonal, plus the mark size
+    int32_t halfW = mapScrWidth / 2 + 16;
+    int32_t halfH = mapScrHeight / 2 + 16;
+    if (angle != 0)
+        halfW = halfH = (int32_t)hypotf(mapScrWidth, mapScrHeight) / 2 + 16;
+    wptOverlay.query(navLastZoom_, centerX - halfW, centerY - halfH, 2 * halfW, 2 * halfH,
+                     navLastZoom_ < wptClusterZoom, wptMarks);
+
+    const float rad = angle * (float)M_PI / 180.0f;
+    const float c = cosf(rad);
+    const float s = sinf(rad);
+    Maps::mapSprite.setTextDatum(lgfx::middle_center);
+    Maps::mapSprite.setTextColor(TFT_WHITE);
+    for (const OverlayMark &mark : wptMarks)
+    {
+        const float dx = (float)(mark.x - centerX);
+        const float dy = (float)(mark.y - centerY);
+        const int16_t x = (int16_t)(mapScrWidth / 2 + dx * c - dy * s);
+        const int16_t y = (int16_t)(mapScrHeight / 2 + dx * s + dy * c);
+        if (mark.count == 1)
+        {
+            Maps::mapSprite.pushImage(x - 8, y - 8, 16, 16, (uint16_t *)waypoint, TFT_BLACK);
+            continue;
+        }
+        const int16_t radius = mark.count < 10 ? 8 : mark.count < 100 ? 10 : mark.count < 1000 ? 12 : 15;
+        Maps::mapSprite.fillCircle(x, y, radius, TFT_ORANGE);
+        Maps::mapSprite.drawCircle(x, y, radius, TFT_WHITE);
+        Maps::mapSprite.drawNumber(mark.count, x, y);
+    }
+    Maps::mapSprite.setTextDatum(lgfx::top_left);
+}
+
+/**
+ * @brief Check if the waypoints on the map have to be drawn again
+ */
+bool Maps::waypointsChanged() const
+{
+    return mapSet.showWaypoints && wptOverlay.built && wptOverlay.generation != waypointStore.generation;
+}
+
 /**
  * @brief Set waypoint coordinates
  * 
@@ -733,6 +1039,43 @@ void Maps::centerOnGps(float lat, float lon)
     resetScrollState();
 }
 
+/**
+ * @brief Center map on a position and stop following the GPS
+ * 
+ * @param lat Latitude
+ * @param lon Longitude
+ */
+void Maps::centerOn(float lat, float lon)
+{
+    centerOnGps(lat, lon);
+    Maps::followGps = false;
+}
+
+/**
+ * @brief Set the position followed by the map, predicted between GPS fixes
+ *
+ * @param lat Latitude
+ * @param lon Longitude
+ */
+void Maps::setFollowPosition(float lat, float lon)
+{
+    Maps::followLat = lat;
+    Maps::followLon = lon;
+    Maps::hasFollowPosition = true;
+}
+
+/**
+ * @brief Position followed by the map, the GPS one until the GUI sets it
+ *
+ * @param lat Latitude
+ * @param lon Longitude
+ */
+void Maps::getFollowPosition(float &lat, float &lon) const
+{
+    lat = Maps::hasFollowPosition ? Maps::followLat : gps.gpsData.latitude;
+    lon = Maps::hasFollowPosition ? Maps::followLon : gps.gpsData.longitude;
+}
+
 /**
  * @brief Reset all scroll offsets
  */
@@ -820,8 +1163,6 @@ void Maps::scrollMap(int16_t dx, int16_t dy)
         const int8_t deltaTileX = tileX - lastTileX;
         const int8_t deltaTileY = tileY - lastTileY;
         Maps::panMap(deltaTileX, deltaTileY);
-        if (!mapSet.vectorMap)
-            Maps::preloadTiles(deltaTileX, deltaTileY);
 
         generateMap(zoomLevel);
         lastTileX = tileX;
@@ -830,53 +1171,6 @@ void Maps::scrollMap(int16_t dx, int16_t dy)
     }
 }
 
- /**
-  * @brief Preload PNG tiles
-  * 
-  * @param dirX X direction 
-  * @param dirY Y direction
-  */
-void Maps::preloadTiles(int8_t dirX, int8_t dirY)
-{
-    const int16_t tileSize = mapTileSize;
-    const int16_t preloadWidth = (dirX != 0) ? tileSize : tileSize * 2;
-    const int16_t preloadHeight = (dirY != 0) ? tileSize : tileSize * 2;
-    if (!preloadSprite.getBuffer())
-        preloadSprite.createSprite(mapTileSize * 2, mapTileSize * 2);
-
-    const int16_t startX = tileX + dirX;
-    const int16_t startY = tileY + dirY;
-
-    for (int8_t i = 0; i < 2; ++i)
-    {
-        const int16_t tileToLoadX = startX + ((dirX == 0) ? i - 1 : 0);
-        const int16_t tileToLoadY = startY + ((dirY == 0) ? i - 1 : 0);
-        float tileLon = (tileToLoadX / (1 << Maps::zoomLevel)) * 360.0f - 180.0f;
-        float tileLat = 90.0f - (tileToLoadY / (1 << Maps::zoomLevel)) * 180.0f;
-        Maps::roundMapTile = Maps::getMapTile(tileLon, tileLat, Maps::zoomLevel, tileToLoadX, tileToLoadY);
-        const int16_t offsetX = (dirX != 0) ? i * tileSize : 0;
-        const int16_t offsetY = (dirY != 0) ? i * tileSize : 0;
-        bool foundTile = false;
-        if (!mapSet.vectorMap)
-            foundTile = preloadSprite.drawPngFile(Maps::roundMapTile.file, offsetX, offsetY);
-        if (!foundTile)
-            preloadSprite.fillRect(offsetX, offsetY, tileSize, tileSize, TFT_LIGHTGREY);
-    }
-
-    if (dirX != 0)
-    {
-        mapTempSprite.scroll(dirX * tileSize, 0);
-        const int16_t pushX = (dirX > 0) ? tileSize * 2 : 0;
-        mapTempSprite.pushImage(pushX, 0, preloadWidth, preloadHeight, preloadSprite.frameBuffer(0));
-    }
-    else if (dirY != 0)
-    {
-        mapTempSprite.scroll(0, dirY * tileSize);
-        const int16_t pushY = (dirY > 0) ? tileSize * 2 : 0;
-        mapTempSprite.pushImage(0, pushY, preloadWidth, preloadHeight, preloadSprite.frameBuffer(0));
-    }
-}
-
 /**
  * @brief Darken a color
  * 
@@ -1504,6 +1798,239 @@ bool Maps::renderNavViewport(float centerLat, float centerLon, uint8_t zoom, TFT
     return true;
 }
 
+/**
+ * @brief Set the visible vector feature classes
+ *
+ * @details Compiles the geometry type and priority layer masks into a per-geometry layer
+ *          bitmask, checked in the renderNavTile header walk before the feature payload
+ *          is touched. Hidden features never reach the feature pool. Waits for the frame
+ *          being rendered, the render task reads the mask under mapMutex.
+ *
+ * @param visibleGeoms Visible geometry types, bit n = NavGeomType n
+ * @param visibleLayers Visible priority layers, bit n = layer n
+ */
+void Maps::setFeatureFilter(uint8_t visibleGeoms, uint16_t visibleLayers)
+{
+    xSemaphoreTake(mapMutex, portMAX_DELAY);
+    for (uint8_t geom = 0; geom < 8; geom++)
+        featureFilter_[geom] = (visibleGeoms & (1 << geom)) ? visibleLayers : 0;
+    navNeedsRender_ = true;
+    xSemaphoreGive(mapMutex);
+}
+
+/**
+ * @brief Cache key of a NAV tile
+ *
+ * @param tileX X Tile
+ * @param tileY Y Tile
+ * @param zoom Zoom level
+ * @return Tile hash
+ */
+uint32_t Maps::navTileHash(uint32_t tileX, uint32_t tileY, uint8_t zoom)
+{
+    return (uint32_t(zoom) << 28) | (uint32_t(tileX & 0x3FFF) << 14) | uint32_t(tileY & 0x3FFF);
+}
+
+/**
+ * @brief Add loaded NAV tile data to the LRU cache, pinned for the current frame
+ *
+ * @param tileHash Tile hash
+ * @param data Tile data in PSRAM, owned by the cache afterwards
+ * @param size Tile data size
+ */
+void Maps::cacheNavTile(uint32_t tileHash, uint8_t* data, size_t size)
+{
+    if (navDataCache.size() >= NAV_DATA_CACHE_SIZE)
+    {
+        int lru = -1;
+        for (int i = 0; i < (int)navDataCache.size(); i++)
+            if (!navDataCache[i].isPinned && (lru == -1 || navDataCache[i].lastAccess < navDataCache[lru].lastAccess)) lru = i;
+        if (lru != -1) { heap_caps_free(navDataCache[lru].data); navDataCache.erase(navDataCache.begin() + lru); }
+    }
+    navDataCache.push_back({data, size, tileHash, ++cacheCounter, true});
+}
+
+/**
+ * @brief Open the NAV pack of a zoom level for a synchronous tile read
+ *
+ * @details The open pack is not switched while prefetch reads given up on are still queued
+ *          on it, the I/O task would read a closed file. The tile is skipped instead.
+ *
+ * @param zoom Zoom level
+ * @return true if the pack is open
+ */
+bool Maps::openNavPack(uint8_t zoom)
+{
+    if (navFetchesInFlight.load() != 0 && !NavReader::isPackOpen(zoom))
+        return false;
+    return NavReader::openPack(zoom);
+}
+
+namespace
+{
+    enum NavFetchState : uint8_t
+    {
+        FETCH_PENDING,      /**< Read queued */
+        FETCH_DONE,         /**< Read completed, owned by the render task */
+        FETCH_ABANDONED     /**< Given up by the render task, freed on completion */
+    };
+
+    /**
+     * @brief Prefetched NAV tile read, shared between the render task and the I/O task
+     */
+    struct NavFetch
+    {
+        uint32_t tileHash;                  /**< Tile hash */
+        uint32_t offset;                    /**< Offset in the pack */
+        uint32_t size;                      /**< Tile size */
+        uint8_t* data;                      /**< Tile data in PSRAM */
+        size_t result;                      /**< Bytes read */
+        std::atomic<uint8_t> state;         /**< NavFetchState */
+        EventGroupHandle_t events;          /**< Map event group, MAP_EVENT_FETCH on completion */
+        std::atomic<uint8_t>* inFlight;     /**< Abandoned reads counter */
+    };
+
+    /**
+     * @brief Completion of a prefetch read, runs on the I/O task
+     */
+    void onNavFetch(uint32_t id, size_t result, void* arg)
+    {
+        NavFetch* fetch = (NavFetch*)arg;
+        fetch->result = result;
+        EventGroupHandle_t events = fetch->events;
+        std::atomic<uint8_t>* inFlight = fetch->inFlight;
+
+        if (fetch->state.exchange(FETCH_DONE) == FETCH_ABANDONED)
+        {
+            heap_caps_free(fetch->data);
+            delete fetch;
+            (*inFlight)--;
+            return;
+        }
+        xEventGroupSetBits(events, Maps::MAP_EVENT_FETCH);
+    }
+}
+
+/**
+ * @brief Read the missing NAV tiles of the pending queue through the async I/O queue
+ *
+ * @details All index lookups are done first, then every tile read is submitted at map
+ *          priority, so the I/O task can serve them in pack offset order and ahead of
+ *          background writes. mapMutex is released while the reads complete, each one marks
+ *          its tile ready and sets MAP_EVENT_FETCH. Reads still queued after
+ *          NAV_FETCH_TIMEOUT_MS are given up: their buffer is freed when they complete, and
+ *          renderNavTile loads those tiles itself. The pack is read with Storage::seekRead
+ *          on both sides, so those loads and the queued reads never share a file position.
+ *          Completed tiles land pinned in the cache. Must be called with mapMutex held.
+ *
+ * @param zoom Zoom level
+ * @return true if mapMutex is held again, false if it could not be taken back
+ */
+bool Maps::prefetchNavTiles(uint8_t zoom)
+{
+    // Don't stack reads on a queue that did not serve the previous ones
+    if (navFetchesInFlight.load() != 0 || !NavReader::openPack(zoom))
+        return true;
+
+    NavFetch* fetches[tilesGrid * tilesGrid];
+    uint8_t fetchCount = 0;
+
+    for (const PendingTile& t : pendingTiles)
+    {
+        if (t.type != TILE_NAV || fetchCount >= tilesGrid * tilesGrid)
+            continue;
+
+        const uint32_t tileHash = navTileHash(t.x, t.y, zoom);
+        bool cached = false;
+        for (const auto& entry : navDataCache)
+        {
+            if (entry.tileHash == tileHash)
+            {
+                cached = true;
+                break;
+            }
+        }
+
+        uint32_t offset, size;
+        if (cached || !NavReader::findTileInPack(t.x, t.y, offset, size))
+            continue;
+
+        NavFetch* fetch = new (std::nothrow) NavFetch();
+        if (!fetch)
+            break;
+        fetch->data = (uint8_t*)heap_caps_aligned_alloc(512, size, MALLOC_CAP_SPIRAM);
+        if (!fetch->data)
+        {
+            delete fetch;
+            break;
+        }
+        fetch->tileHash = tileHash;
+        fetch->offset = offset;
+        fetch->size = size;
+        fetch->result = 0;
+        fetch->state = FETCH_PENDING;
+        fetch->events = mapEventGroup;
+        fetch->inFlight = &navFetchesInFlight;
+        fetches[fetchCount++] = fetch;
+    }
+
+    if (fetchCount == 0)
+        return true;
+
+    xEventGroupClearBits(mapEventGroup, MAP_EVENT_FETCH);
+    uint8_t submitted = 0;
+    for (; submitted < fetchCount; submitted++)
+    {
+        NavFetch* fetch = fetches[submitted];
+        if (storage.submitSeekRead(NavReader::packFile, fetch->offset, fetch->data, fetch->size, IO_PRIO_MAP, onNavFetch, fetch) == 0)
+            break;
+    }
+    for (uint8_t i = submitted; i < fetchCount; i++)
+    {
+        heap_caps_free(fetches[i]->data);
+        delete fetches[i];
+    }
+
+    // Let the GUI use the map while the card is busy
+    xSemaphoreGive(mapMutex);
+    const uint32_t start = millis();
+    while (true)
+    {
+        uint8_t done = 0;
+        for (uint8_t i = 0; i < submitted; i++)
+            if (fetches[i]->state.load() == FETCH_DONE)
+                done++;
+        const uint32_t elapsed = millis() - start;
+        if (done == submitted || elapsed >= NAV_FETCH_TIMEOUT_MS)
+            break;
+        xEventGroupWaitBits(mapEventGroup, MAP_EVENT_FETCH, pdTRUE, pdFALSE, pdMS_TO_TICKS(NAV_FETCH_TIMEOUT_MS - elapsed));
+    }
+    const bool holdsMutex = xSemaphoreTake(mapMutex, pdMS_TO_TICKS(200)) == pdTRUE;
+
+    uint8_t abandoned = 0;
+    for (uint8_t i = 0; i < submitted; i++)
+    {
+        NavFetch* fetch = fetches[i];
+        navFetchesInFlight++;
+        if (fetch->state.exchange(FETCH_ABANDONED) != FETCH_DONE)
+        {
+            abandoned++;
+            continue;
+        }
+        navFetchesInFlight--;
+
+        if (holdsMutex && fetch->result == fetch->size)
+            cacheNavTile(fetch->tileHash, fetch->data, fetch->size);
+        else
+            heap_caps_free(fetch->data);
+        delete fetch;
+    }
+
+    if (abandoned != 0)
+        ESP_LOGE(TAG, "%u NAV tile reads not served in %lu ms", abandoned, (unsigned long)NAV_FETCH_TIMEOUT_MS);
+    return holdsMutex;
+}
+
 /**
  * @brief Fetches and decodes a single NAV tile from cache or storage.
  * 
@@ -1522,8 +2049,7 @@ bool Maps::renderNavViewport(float centerLat, float centerLon, uint8_t zoom, TFT
  */
 void Maps::renderNavTile(uint32_t tileX, uint32_t tileY, uint8_t zoom, int16_t screenX, int16_t screenY, TFT_eSprite &map)
 {
-    uint64_t tStart = esp_timer_get_time();
-    uint32_t tileHash = (uint32_t(zoom) << 28) | (uint32_t(tileX & 0x3FFF) << 14) | uint32_t(tileY & 0x3FFF);
+    uint32_t tileHash = navTileHash(tileX, tileY, zoom);
     uint8_t* data = nullptr;
     size_t dataSize = 0;
     int cacheIdx = -1;
@@ -1546,7 +2072,7 @@ void Maps::renderNavTile(uint32_t tileX, uint32_t tileY, uint8_t zoom, int16_t s
     else
     {
         cacheMisses++;
-        if (!NavReader::openPack(zoom))
+        if (!openNavPack(zoom))
             return;
         uint32_t offset;
         uint32_t size;
@@ -1561,21 +2087,13 @@ void Maps::renderNavTile(uint32_t tileX, uint32_t tileY, uint8_t zoom, int16_t s
             if (!data)
                 return;
         }
-        storage.seek(NavReader::packFile, offset, SEEK_SET);
-        if (storage.read(NavReader::packFile, data, size) != size)
+        if (storage.seekRead(NavReader::packFile, offset, data, size) != size)
         {
             heap_caps_free(data);
             return;
         }
         dataSize = size;
-        if (navDataCache.size() >= NAV_DATA_CACHE_SIZE)
-        {
-            int lru = -1;
-            for (int i = 0; i < (int)navDataCache.size(); i++)
-                if (!navDataCache[i].isPinned && (lru == -1 || navDataCache[i].lastAccess < navDataCache[lru].lastAccess)) lru = i;
-            if (lru != -1) { heap_caps_free(navDataCache[lru].data); navDataCache.erase(navDataCache.begin() + lru); }
-        }
-        navDataCache.push_back({data, size, tileHash, ++cacheCounter, true});
+        cacheNavTile(tileHash, data, size);
     }
 
     if (dataSize < 22)
@@ -1589,6 +2107,15 @@ void Maps::renderNavTile(uint32_t tileX, uint32_t tileY, uint8_t zoom, int16_t s
             break;
         uint8_t geomType = p[0];
         uint8_t zp = p[3];
+        uint16_t ps;
+        memcpy(&ps, p + 11, 2);
+        if (p + 13 + ps > data + dataSize)
+            break;
+        if (!(featureFilter_[geomType & 0x07] & (1 << (zp & 0x0F))))
+        {
+            p += 13 + ps;
+            continue;
+        }
         uint8_t wp = p[4];
         uint8_t bx1 = p[5];
         uint8_t by1 = p[6];
@@ -1596,12 +2123,8 @@ void Maps::renderNavTile(uint32_t tileX, uint32_t tileY, uint8_t zoom, int16_t s
         uint8_t by2 = p[8];
         uint16_t colorRgb565;
         uint16_t cc;
-        uint16_t ps;
         memcpy(&colorRgb565, p + 1, 2);
         memcpy(&cc, p + 9, 2);
-        memcpy(&ps, p + 11, 2);
-        if (p + 13 + ps > data + dataSize)
-            break;
         if ((zp >> 4) <= zoom)
         {
             if (screenX + bx2 < 0 || screenX + bx1 > (int)tileWidth || screenY + by2 < 0 || screenY + by1 > (int)tileHeight)
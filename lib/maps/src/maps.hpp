@@ -8,6 +8,7 @@
 
 #pragma once
 
+#include <atomic>
 #include <cstdint>
 #include <vector>
 #include <algorithm>
@@ -23,6 +24,9 @@
 #include "mapVars.h"
 #include "storage.hpp"
 #include "nav_reader.hpp"
+#include "raster_tile.hpp"
+#include "waypoint_overlay.hpp"
+#include "track_overlay.hpp"
 #include "PsramAllocator.hpp"
 
 /**
@@ -70,7 +74,6 @@ private:
     uint16_t wptPosY;
     TFT_eSprite mapTempSprite = TFT_eSprite(&tft);
     TFT_eSprite mapSprite = TFT_eSprite(&tft);
-    TFT_eSprite preloadSprite = TFT_eSprite(&tft);
     float destLat;
     float destLon;
     uint8_t zoomLevel;
@@ -111,7 +114,6 @@ public:
     bool isMapFound = false;
     MapTile oldMapTile;
     MapTile currentMapTile;
-    MapTile roundMapTile;
     int16_t tileX = 0;
     int16_t tileY = 0;
     int16_t lastTileX = 0;
@@ -123,10 +125,25 @@ public:
     const float friction = 0.95f;
     bool scrollUpdated = false;
 
+    /**
+     * @brief Statistics of the last vector frame
+     */
+    struct RenderStats
+    {
+        uint32_t frameMs;           /**< Time to the complete frame */
+        uint32_t firstFrameMs;      /**< Time to the first published frame */
+        uint32_t fetchMs;           /**< Wait for the prefetched NAV tiles, not in the frame times */
+        uint16_t features;          /**< Features in the feature pool */
+        uint8_t layersDeferred;     /**< Low-priority layers deferred past the frame budget */
+        uint8_t slices;             /**< Render slices used for the frame */
+    };
+    RenderStats renderStats = {};
+
     EventGroupHandle_t mapEventGroup;
     static const uint32_t MAP_EVENT_START = (1 << 0);
     static const uint32_t MAP_EVENT_DONE  = (1 << 1);
     static const uint32_t MAP_EVENT_ERROR = (1 << 2);
+    static const uint32_t MAP_EVENT_FETCH = (1 << 3);   /**< A prefetched NAV tile read completed */
 
     Maps();
     MapTile getMapTile(float lon, float lat, uint8_t zoomLevel, int8_t offsetX, int8_t offsetY);
@@ -138,11 +155,24 @@ public:
     void setWaypoint(float wptLat, float wptLon);
     void updateMap();
     void centerOnGps(float lat, float lon);
+    void centerOn(float lat, float lon);
+    void setFollowPosition(float lat, float lon);
     void scrollMap(int16_t dx, int16_t dy);
-    void preloadTiles(int8_t dirX, int8_t dirY);
     void resetScrollState();
     bool renderNavViewport(float centerLat, float centerLon, uint8_t zoom, TFT_eSprite &map);
     void renderNavTile(uint32_t tileX, uint32_t tileY, uint8_t zoom, int16_t screenX, int16_t screenY, TFT_eSprite &map);
+    typedef std::vector<uint8_t, PsramAllocator<uint8_t>> TileBuffer;   /**< Raster tile file buffer */
+    static bool drawQ565File(const char* path, TFT_eSprite &map, int16_t screenX, int16_t screenY, TileBuffer &buffer);
+    void setFeatureFilter(uint8_t visibleGeoms, uint16_t visibleLayers);
+    bool waypointsChanged() const;
+    void setTrack(uint8_t slot, const float *lat, const float *lon, size_t count, uint16_t color, uint8_t width);
+    void addTrackPoint(uint8_t slot, float lat, float lon, uint16_t color, uint8_t width);
+    void removeTrack(uint8_t slot);
+    size_t trackPoints(uint8_t slot) const;
+
+    static const uint8_t MAP_TRACK_ROUTE = 0;        /**< Loaded GPX track (navigation) */
+    static const uint8_t MAP_TRACK_BREADCRUMB = 1;   /**< Track being recorded */
+    static const uint8_t MAP_TRACK_REFERENCE = 2;    /**< First slot of the reference tracks */
 
 private:
     struct FeatureRef
@@ -177,6 +207,7 @@ private:
     uint32_t cacheCounter = 0;
 
     static const uint16_t MAX_POLYGON_POINTS = 1024;
+    static const uint8_t NAV_DEFER_LAYERS = 4;
     static const uint32_t MAX_FEATURE_POOL_SIZE = 16384;
 
     std::vector<int, PsramAllocator<int>> projBuf32X;
@@ -187,13 +218,39 @@ private:
     std::vector<uint16_t, PsramAllocator<uint16_t>> ringEndsCache;
     std::vector<LabelRect, PsramAllocator<LabelRect>> placedLabelsCache;
 
+    uint16_t renderNavLayers(uint32_t startMs, uint16_t budgetMs);
     void renderNavFeature(const FeatureRef& ref, TFT_eSprite& map, uint8_t pass, std::vector<LabelRect, PsramAllocator<LabelRect>>& placedLabels);
     void renderNavLineString(const FeatureRef& ref, TFT_eSprite& map, bool isCasing = false);
     void renderNavPolygon(const FeatureRef& ref, TFT_eSprite& map);
     void renderNavPoint(const FeatureRef& ref, TFT_eSprite& map);
     void renderNavText(const FeatureRef& ref, TFT_eSprite& map, std::vector<LabelRect, PsramAllocator<LabelRect>>& placedLabels);
     void latLonToPixel(float lat, float lon, int16_t& px, int16_t& py);
+    static uint32_t navTileHash(uint32_t tileX, uint32_t tileY, uint8_t zoom);
+    void cacheNavTile(uint32_t tileHash, uint8_t* data, size_t size);
+    bool openNavPack(uint8_t zoom);
+    bool prefetchNavTiles(uint8_t zoom);
+    static const uint32_t NAV_FETCH_TIMEOUT_MS = 2000;     /**< Wait for the prefetched tiles before rendering without them */
+    std::atomic<uint8_t> navFetchesInFlight{0};            /**< Prefetch reads given up on, still in the I/O queue */
     void drawTrack(TFT_eSprite &map);
+    void drawWaypoints(int32_t centerX, int32_t centerY, uint16_t angle);
+    void getFollowPosition(float &lat, float &lon) const;
+
+    bool hasFollowPosition = false;     /**< followLat/followLon set by the GUI */
+    float followLat = 0.0f;             /**< Position the map follows (predicted between fixes) */
+    float followLon = 0.0f;             /**< Position the map follows (predicted between fixes) */
+
+    WaypointOverlay wptOverlay;                 /**< Snapshot of the user waypoints */
+    std::vector<OverlayMark> wptMarks;          /**< Waypoint marks of the last frame */
+
+    struct PendingPoint
+    {
+        float lat;
+        float lon;
+    };
+
+    TrackOverlay trackOverlay;                  /**< Tracks shown on the map */
+    std::vector<TrackRun> trackRuns;            /**< Track runs of the last frame */
+    std::vector<PendingPoint> breadcrumbPending;    /**< Breadcrumb points not yet in the overlay (GUI task) */
 
 public:
     bool trackNeedsRedraw = false;
@@ -220,7 +277,15 @@ private:
     SemaphoreHandle_t mapMutex;
     TaskHandle_t mapRenderTaskHandle;
     static void mapRenderTask(void* pvParameters);
-    void renderPngTile(uint32_t tileX, uint32_t tileY, uint8_t zoom, int16_t screenX, int16_t screenY, TFT_eSprite &map);
+    bool renderPngTile(uint32_t tileX, uint32_t tileY, uint8_t zoom, int16_t screenX, int16_t screenY, TFT_eSprite &map);
+    void queueRasterGrid(int32_t tlX, int32_t tlY, int32_t shiftX, int32_t shiftY, bool fullGrid);
+    bool drawRasterTile(uint32_t tileX, uint32_t tileY, uint8_t zoom, int16_t screenX, int16_t screenY, TFT_eSprite &map);
+
+    TileBuffer rasterTileBuf;
+    uint32_t rasterCenterX_ = 0;
+    uint32_t rasterCenterY_ = 0;
+
+    uint16_t featureFilter_[8];
 
     uint8_t navLastZoom_;
     bool navNeedsRender_;
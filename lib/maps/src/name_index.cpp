@@ -0,0 +1,459 @@
+/**
+ * @file name_index.cpp
+ * @author Jordi Gauchía (jgauchia@jgauchia.com)
+ * @brief  Place name search index - prefix search over the NAV map labels
+ * @version 0.2.5
+ * @date 2026-04
+ */
+
+#include "name_index.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include "esp_log.h"
+
+static const char* TAG = "NameIndex";
+
+namespace
+{
+    /**
+     * @brief Index header
+     */
+    struct IndexHeader
+    {
+        char magic[4];          /**< "NIX1" */
+        uint16_t version;       /**< NameIndex::VERSION */
+        uint16_t headerSize;    /**< sizeof(IndexHeader) */
+        uint32_t entries;       /**< Keys */
+        uint32_t blocks;        /**< Blocks */
+        uint16_t blockEntries;  /**< Keys per block (the last one may have fewer) */
+        uint16_t keyPrefix;     /**< NameIndex::KEY_PREFIX */
+        uint32_t indexOffset;   /**< Block index offset */
+        uint32_t checksum;      /**< FNV-1a of the block index */
+        uint32_t reserved;      /**< Zero */
+    };
+    static_assert(sizeof(IndexHeader) == 32, "Name index header layout");
+
+    /**
+     * @brief Latin-1 letters (U+00C0-U+00FF) folded to ASCII
+     */
+    static const char *const LATIN1_FOLD[64] = {
+        "a", "a", "a", "a", "a", "a", "ae", "c", "e", "e", "e", "e", "i", "i", "i", "i",
+        "d", "n", "o", "o", "o", "o", "o", " ", "o", "u", "u", "u", "u", "y", "th", "ss",
+        "a", "a", "a", "a", "a", "a", "ae", "c", "e", "e", "e", "e", "i", "i", "i", "i",
+        "d", "n", "o", "o", "o", "o", "o", " ", "o", "u", "u", "u", "u", "y", "th", "y"};
+
+    /**
+     * @brief Latin Extended-A letters (U+0100-U+017F) folded to ASCII, '*' for ij and '#' for oe
+     */
+    static const char LATIN_EXT_FOLD[] =
+        "aaaaaaccccccccddddeeeeeeeeeegggggggghhhhiiiiiiiiii**jjkkkllllllllllnnnnnnnnnoooooo##rrrrrrssssssssttttttuuuuuuuuuuuuwwyyyzzzzzzs";
+    static_assert(sizeof(LATIN_EXT_FOLD) == 129, "Latin Extended-A fold table");
+
+    static constexpr uint32_t FNV_OFFSET = 2166136261u;
+    static constexpr uint32_t FNV_PRIME = 16777619u;
+    static constexpr uint32_t NO_BLOCK = 0xFFFFFFFF;
+    static constexpr float METERS_PER_DEG = 111319.49f;
+
+    static uint32_t fnv1a(const uint8_t *data, size_t len)
+    {
+        uint32_t hash = FNV_OFFSET;
+        for (size_t i = 0; i < len; i++)
+            hash = (hash ^ data[i]) * FNV_PRIME;
+        return hash;
+    }
+
+    /**
+     * @brief Decode one UTF-8 sequence
+     * @return Bytes used, 0 if the sequence is invalid
+     */
+    static size_t decodeUtf8(const uint8_t *s, uint32_t &cp)
+    {
+        if (s[0] < 0x80)
+        {
+            cp = s[0];
+            return 1;
+        }
+        size_t len = (s[0] & 0xE0) == 0xC0 ? 2 : (s[0] & 0xF0) == 0xE0 ? 3 : (s[0] & 0xF8) == 0xF0 ? 4 : 0;
+        if (len == 0)
+            return 0;
+        cp = s[0] & (0x7F >> len);
+        for (size_t i = 1; i < len; i++)
+        {
+            if ((s[i] & 0xC0) != 0x80)
+                return 0;
+            cp = (cp << 6) | (s[i] & 0x3F);
+        }
+        return len;
+    }
+
+    static size_t encodeUtf8(uint32_t cp, char *out)
+    {
+        if (cp < 0x800)
+        {
+            out[0] = (char)(0xC0 | (cp >> 6));
+            out[1] = (char)(0x80 | (cp & 0x3F));
+            return 2;
+        }
+        if (cp < 0x10000)
+        {
+            out[0] = (char)(0xE0 | (cp >> 12));
+            out[1] = (char)(0x80 | ((cp >> 6) & 0x3F));
+            out[2] = (char)(0x80 | (cp & 0x3F));
+            return 3;
+        }
+        out[0] = (char)(0xF0 | (cp >> 18));
+        out[1] = (char)(0x80 | ((cp >> 12) & 0x3F));
+        out[2] = (char)(0x80 | ((cp >> 6) & 0x3F));
+        out[3] = (char)(0x80 | (cp & 0x3F));
+        return 4;
+    }
+
+    /**
+     * @brief Search match being ranked
+     */
+    struct Candidate
+    {
+        PlaceResult place;
+        bool exact;         /**< Key equal to the query */
+        float dist2;        /**< Squared distance to the reference position */
+    };
+}
+
+NameIndex::NameIndex() : blockReads(0), file(nullptr), entries(0), useCounter(0)
+{
+    for (Slot &slot : slots)
+        slot.block = NO_BLOCK;
+}
+
+NameIndex::~NameIndex()
+{
+    close();
+}
+
+/**
+ * @brief Normalize a name or a query into a search key
+ *
+ * @details Lowercase, Latin accents folded to ASCII (ß to ss, œ to oe), punctuation as
+ *          spaces, spaces collapsed and trimmed. Greek and Cyrillic capitals are lowered,
+ *          other scripts are kept as they are.
+ *
+ * @param text Name (UTF-8)
+ * @param out Key, always terminated
+ * @param outSize Size of out
+ * @return Key length
+ */
+size_t NameIndex::normalize(const char *text, char *out, size_t outSize)
+{
+    size_t len = 0;
+    bool space = true;      // Drops leading spaces
+    const uint8_t *s = (const uint8_t *)text;
+    while (*s && outSize > 0)
+    {
+        uint32_t cp;
+        size_t used = decodeUtf8(s, cp);
+        if (used == 0)
+        {
+            cp = ' ';
+            used = 1;
+        }
+        s += used;
+
+        char buf[4];
+        const char *piece = buf;
+        size_t pieceLen = 1;
+        if (cp < 0x80)
+        {
+            if (cp >= 'A' && cp <= 'Z')
+                buf[0] = (char)(cp + 32);
+            else if ((cp >= 'a' && cp <= 'z') || (cp >= '0' && cp <= '9'))
+                buf[0] = (char)cp;
+            else
+                buf[0] = ' ';
+        }
+        else if (cp >= 0xC0 && cp <= 0xFF)
+        {
+            piece = LATIN1_FOLD[cp - 0xC0];
+            pieceLen = strlen(piece);
+        }
+        else if (cp >= 0x100 && cp <= 0x17F)
+        {
+            const char c = LATIN_EXT_FOLD[cp - 0x100];
+            piece = c == '*' ? "ij" : c == '#' ? "oe" : buf;
+            buf[0] = c;
+            pieceLen = piece == buf ? 1 : 2;
+        }
+        else if (cp < 0xC0)
+            buf[0] = ' ';   // Latin-1 symbols and spaces
+        else
+        {
+            if ((cp >= 0x391 && cp <= 0x3A9) || (cp >= 0x410 && cp <= 0x42F))
+                cp += 0x20;
+            else if (cp >= 0x400 && cp <= 0x40F)
+                cp += 0x50;
+            pieceLen = encodeUtf8(cp, buf);
+        }
+
+        if (pieceLen == 1 && piece[0] == ' ')
+        {
+            if (!space && len + 1 < outSize)
+                out[len++] = ' ';
+            space = true;
+            continue;
+        }
+        if (len + pieceLen >= outSize)
+            break;
+        memcpy(out + len, piece, pieceLen);
+        len += pieceLen;
+        space = false;
+    }
+    while (len > 0 && out[len - 1] == ' ')
+        len--;
+    if (outSize > 0)
+        out[len] = 0;
+    return len;
+}
+
+/**
+ * @brief Open an index and read its block index
+ *
+ * @param path Index path
+ * @return true if the index is valid
+ */
+bool NameIndex::open(const char *path)
+{
+    close();
+    file = fopen(path, "rb");
+    if (!file)
+        return false;
+
+    IndexHeader header;
+    bool ok = fread(&header, sizeof(header), 1, file) == 1 && memcmp(header.magic, NAME_INDEX_MAGIC, 4) == 0 &&
+              header.version == VERSION && header.headerSize == sizeof(IndexHeader) &&
+              header.keyPrefix == KEY_PREFIX && header.blockEntries > 0 &&
+              header.blocks == (header.entries + header.blockEntries - 1) / header.blockEntries;
+    if (ok)
+    {
+        index.resize(header.blocks);
+        ok = fseek(file, header.indexOffset, SEEK_SET) == 0 &&
+             fread(index.data(), sizeof(BlockInfo), index.size(), file) == index.size() &&
+             fnv1a((const uint8_t *)index.data(), index.size() * sizeof(BlockInfo)) == header.checksum;
+    }
+    if (!ok)
+    {
+        ESP_LOGE(TAG, "Invalid name index %s", path);
+        close();
+        return false;
+    }
+
+    entries = header.entries;
+    ESP_LOGI(TAG, "%s: %u names, %u blocks", path, (unsigned)entries, (unsigned)header.blocks);
+    return true;
+}
+
+/**
+ * @brief Close the index and free the block cache
+ */
+void NameIndex::close()
+{
+    if (file)
+        fclose(file);
+    file = nullptr;
+    entries = 0;
+    index.clear();
+    index.shrink_to_fit();
+    for (Slot &slot : slots)
+    {
+        slot.block = NO_BLOCK;
+        slot.data.clear();
+        slot.data.shrink_to_fit();
+    }
+    blockReads = 0;
+}
+
+/**
+ * @brief Check if an index is open
+ */
+bool NameIndex::isOpen() const
+{
+    return file != nullptr;
+}
+
+/**
+ * @brief Number of keys in the index
+ */
+uint32_t NameIndex::nameCount() const
+{
+    return entries;
+}
+
+/**
+ * @brief Cached block payload, read if needed
+ *
+ * @param block Block
+ * @return Slot, nullptr on a read error
+ */
+const NameIndex::Slot *NameIndex::loadBlock(uint32_t block)
+{
+    Slot *victim = &slots[0];
+    for (Slot &slot : slots)
+    {
+        if (slot.block == block)
+        {
+            slot.lastUse = ++useCounter;
+            return &slot;
+        }
+        if (slot.block == NO_BLOCK || (victim->block != NO_BLOCK && slot.lastUse < victim->lastUse))
+            victim = &slot;
+    }
+
+    const BlockInfo &info = index[block];
+    victim->block = NO_BLOCK;
+    victim->data.resize(info.size);
+    if (info.size < 2 || fseek(file, info.offset, SEEK_SET) != 0 ||
+        fread(victim->data.data(), 1, info.size, file) != info.size)
+    {
+        ESP_LOGE(TAG, "Can't read block %u", (unsigned)block);
+        return nullptr;
+    }
+    blockReads++;
+    victim->block = block;
+    victim->lastUse = ++useCounter;
+    return victim;
+}
+
+/**
+ * @brief First block that can hold keys starting with a prefix
+ *
+ * @details Last block whose first key is lower than the prefix, compared on KEY_PREFIX
+ *          bytes. A tie starts one block earlier, the scan skips the lower keys.
+ */
+uint32_t NameIndex::firstBlock(const char *key, size_t len) const
+{
+    char padded[KEY_PREFIX];
+    memset(padded, 0, sizeof(padded));
+    memcpy(padded, key, std::min(len, KEY_PREFIX));
+
+    uint32_t low = 0, high = (uint32_t)index.size();
+    while (low < high)
+    {
+        const uint32_t mid = low + (high - low) / 2;
+        if (memcmp(index[mid].firstKey, padded, KEY_PREFIX) < 0)
+            low = mid + 1;
+        else
+            high = mid;
+    }
+    return low > 0 ? low - 1 : 0;
+}
+
+/**
+ * @brief Places whose name, or a word of it, starts with a query
+ *
+ * @details Exact names come first, then bigger places (shown at lower zooms), then the
+ *          nearest to the reference position, ties by name. At most MAX_CANDIDATES matches
+ *          are ranked.
+ *
+ * @param query Query, normalized like the names
+ * @param refLat Reference latitude (current position)
+ * @param refLon Reference longitude (current position)
+ * @param maxResults Max places returned
+ * @param out Places found
+ * @return Number of places found
+ */
+size_t NameIndex::search(const char *query, float refLat, float refLon, size_t maxResults,
+                         std::vector<PlaceResult> &out)
+{
+    out.clear();
+    char q[MAX_KEY + 1];
+    const size_t qLen = normalize(query, q, sizeof(q));
+    if (!file || qLen == 0 || index.empty())
+        return 0;
+
+    const float kLon = cosf(refLat * (float)M_PI / 180.0f);
+    std::vector<Candidate> candidates;
+    char key[MAX_KEY + 1];
+    bool done = false;
+
+    for (uint32_t b = firstBlock(q, qLen); b < index.size() && !done; b++)
+    {
+        const Slot *slot = loadBlock(b);
+        if (!slot)
+            break;
+        const uint8_t *p = slot->data.data();
+        const uint8_t *end = p + slot->data.size();
+        uint16_t count;
+        memcpy(&count, p, 2);
+        p += 2;
+
+        size_t keyLen = 0;
+        for (uint16_t i = 0; i < count && !done; i++)
+        {
+            if (end - p < 2)
+                return 0;
+            const size_t shared = p[0], suffix = p[1];
+            p += 2;
+            if (shared > keyLen || shared + suffix > MAX_KEY || (size_t)(end - p) < suffix + 1)
+                return 0;
+            memcpy(key + shared, p, suffix);
+            keyLen = shared + suffix;
+            p += suffix;
+            const size_t nameLen = *p++;
+            if ((size_t)(end - p) < nameLen + 10)
+                return 0;
+            const uint8_t *name = p;
+            p += nameLen;
+            int32_t lat, lon;
+            memcpy(&lat, p, 4);
+            memcpy(&lon, p + 4, 4);
+            const uint8_t zoom = p[8];
+            p += 10;
+
+            const int cmp = memcmp(key, q, std::min(keyLen, qLen));
+            if (cmp < 0 || (cmp == 0 && keyLen < qLen))
+                continue;
+            if (cmp > 0)
+            {
+                done = true;
+                break;
+            }
+
+            Candidate c;
+            const size_t copy = std::min(nameLen, sizeof(c.place.name) - 1);
+            memcpy(c.place.name, name, copy);
+            c.place.name[copy] = 0;
+            c.place.lat = lat * 1e-7f;
+            c.place.lon = lon * 1e-7f;
+            c.place.zoom = zoom;
+            c.exact = keyLen == qLen;
+            const float dy = (c.place.lat - refLat) * METERS_PER_DEG;
+            const float dx = (c.place.lon - refLon) * METERS_PER_DEG * kLon;
+            c.dist2 = dx * dx + dy * dy;
+            candidates.push_back(c);
+            done = candidates.size() >= MAX_CANDIDATES;
+        }
+    }
+
+    std::sort(candidates.begin(), candidates.end(), [](const Candidate &a, const Candidate &b) {
+        if (a.exact != b.exact)
+            return a.exact;
+        if (a.place.zoom != b.place.zoom)
+            return a.place.zoom < b.place.zoom;
+        if (a.dist2 != b.dist2)
+            return a.dist2 < b.dist2;
+        const int byName = strcmp(a.place.name, b.place.name);
+        return byName != 0 ? byName < 0 : a.place.lat < b.place.lat;
+    });
+
+    // A name matched by its first word and by another word is listed once
+    for (const Candidate &c : candidates)
+    {
+        if (out.size() >= maxResults)
+            break;
+        const bool seen = std::any_of(out.begin(), out.end(), [&](const PlaceResult &r) {
+            return r.lat == c.place.lat && r.lon == c.place.lon && strcmp(r.name, c.place.name) == 0;
+        });
+        if (!seen)
+            out.push_back(c.place);
+    }
+    return out.size();
+}
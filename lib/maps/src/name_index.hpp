@@ -0,0 +1,103 @@
+/**
+ * @file name_index.hpp
+ * @brief Place name search index - prefix search over the NAV map labels
+ * @version 0.2.5
+ * @date 2026-04
+ *
+ * Platform independent, also built by tools/name_index.
+ *
+ * The index (/sdcard/NAVMAP/names.idx) is written by tools/name_index from the Text
+ * features of the NAV packs. Names are normalized (lowercase, accents folded, punctuation
+ * as spaces) into keys, and every word of 3 or more letters after the first one gives
+ * one more key, so "Carrer de Balmes" is found by "carrer" and by "balm". Keys are sorted
+ * and stored front coded in blocks. Only the block index stays in memory, blocks are
+ * read from SD while a search scans them.
+ *
+ * Layout (little-endian):
+ *  - Header (32 bytes): magic "NIX1", version (u16), header size (u16), entries (u32),
+ *    blocks (u32), entries per block (u16), key prefix size (u16), block index offset
+ *    (u32), FNV-1a of the block index (u32), reserved (u32)
+ *  - Block index: per block payload offset and size (u32), first key (KEY_PREFIX bytes,
+ *    zero padded)
+ *  - Block payload: entries (u16), then per entry: shared key bytes with the previous
+ *    entry (u8), key suffix length (u8) and bytes, name length (u8) and bytes (UTF-8),
+ *    lat and lon (i32, 1e-7 deg), min zoom (u8), flags (u8, bit 0: word key)
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <vector>
+#include "PsramAllocator.hpp"
+
+static constexpr uint8_t NAME_INDEX_MAGIC[4] = {'N', 'I', 'X', '1'};
+
+/**
+ * @brief Place found by a search
+ */
+struct PlaceResult
+{
+    char name[64];      /**< Label as shown on the map */
+    float lat;          /**< Latitude */
+    float lon;          /**< Longitude */
+    uint8_t zoom;       /**< Min zoom where the label is shown, lower for bigger places */
+};
+
+/**
+ * @brief Place name search index reader
+ */
+class NameIndex
+{
+public:
+    static constexpr uint16_t VERSION = 1;          /**< Index layout version */
+    static constexpr size_t KEY_PREFIX = 24;        /**< Key bytes kept in the block index */
+    static constexpr size_t MAX_KEY = 63;           /**< Max key length */
+    static constexpr size_t MAX_CANDIDATES = 512;   /**< Matches ranked per search */
+    static constexpr size_t CACHE_BLOCKS = 4;       /**< Blocks kept in PSRAM */
+
+    NameIndex();
+    ~NameIndex();
+
+    bool open(const char *path);
+    void close();
+    bool isOpen() const;
+    uint32_t nameCount() const;
+
+    size_t search(const char *query, float refLat, float refLon, size_t maxResults, std::vector<PlaceResult> &out);
+
+    static size_t normalize(const char *text, char *out, size_t outSize);
+
+    uint32_t blockReads;    /**< Blocks read from the file since open */
+
+private:
+    /**
+     * @brief Block index entry
+     */
+    struct BlockInfo
+    {
+        uint32_t offset;            /**< Payload offset in the file */
+        uint32_t size;              /**< Payload size */
+        char firstKey[KEY_PREFIX];  /**< First key of the block, zero padded */
+    };
+
+    /**
+     * @brief Cached block payload
+     */
+    struct Slot
+    {
+        uint32_t block;                                     /**< Cached block, UINT32_MAX if free */
+        uint32_t lastUse;                                   /**< Use counter for LRU */
+        std::vector<uint8_t, PsramAllocator<uint8_t>> data; /**< Payload */
+    };
+
+    FILE *file;                                             /**< Open index */
+    uint32_t entries;                                       /**< Keys in the index */
+    std::vector<BlockInfo, PsramAllocator<BlockInfo>> index;    /**< Block index */
+    Slot slots[CACHE_BLOCKS];                               /**< Block cache */
+    uint32_t useCounter;                                    /**< LRU clock */
+
+    const Slot *loadBlock(uint32_t block);
+    uint32_t firstBlock(const char *key, size_t len) const;
+};
@@ -108,21 +108,22 @@ bool NavReader::findTileInPack(uint32_t tileX, uint32_t tileY, uint32_t& offset,
     while (low <= high)
     {
         int32_t mid = low + (high - low) / 2;
-        storage.seek(packFile, indexOff + (mid * 16), SEEK_SET);
 
-        uint64_t entryH;
-        if (storage.read(packFile, (uint8_t*)&entryH, 8) != 8)
+        // Hilbert index, offset and size in one locked read, the I/O task reads this file too
+        uint8_t entry[16];
+        if (storage.seekRead(packFile, indexOff + (mid * 16), entry, sizeof(entry)) != sizeof(entry))
             return false;
 
+        uint64_t entryH;
+        memcpy(&entryH, entry, 8);
         if (entryH < targetH)
             low = mid + 1;
         else if (entryH > targetH)
             high = mid - 1;
         else
         {
-            if (storage.read(packFile, (uint8_t*)&offset, 4) != 4 || storage.read(packFile, (uint8_t*)&size, 4) != 4)
-                return false;
-
+            memcpy(&offset, entry + 8, 4);
+            memcpy(&size, entry + 12, 4);
             return true;
         }
     }
@@ -43,6 +43,15 @@ public:
     static FILE* packFile;
     static void closePack();
     static bool openPack(uint8_t zoom);
+
+    /**
+     * @brief Check if the pack of a zoom level is the open one
+     */
+    static bool isPackOpen(uint8_t zoom)
+    {
+        return packFile && currentZoom == zoom;
+    }
+
     static bool findTileInPack(uint32_t tileX, uint32_t tileY, uint32_t& offset, uint32_t& size);
 
     /**
@@ -0,0 +1,136 @@
+/**
+ * @file raster_tile.cpp
+ * @author Jordi Gauchía (jgauchia@jgauchia.com)
+ * @brief  Q565 raster tile decoder
+ * @version 0.2.5
+ * @date 2026-04
+ */
+
+#include "raster_tile.hpp"
+#include <cstring>
+
+/**
+ * @brief Validate a Q565 header and get the tile dimensions.
+ *
+ * @param data Tile file contents.
+ * @param size Size of the tile data in bytes.
+ * @param width Output tile width.
+ * @param height Output tile height.
+ * @return True if the header is valid.
+ */
+bool RasterTile::readHeader(const uint8_t* data, size_t size, uint16_t& width, uint16_t& height)
+{
+    if (!data || size < Q565_HEADER_SIZE || memcmp(data, Q565_MAGIC, 4) != 0)
+        return false;
+
+    width = data[4] | (data[5] << 8);
+    height = data[6] | (data[7] << 8);
+    return width != 0 && height != 0;
+}
+
+/**
+ * @brief Decode a Q565 tile into a 16-bit sprite framebuffer.
+ *
+ * @details Pixels are written byte-swapped, the order used by LovyanGFX 16-bit sprites,
+ *          so no per-pixel conversion is needed when the sprite is pushed. Spans outside
+ *          the destination are clipped; tiles fully inside take the unclipped path.
+ *
+ * @param data Tile file contents.
+ * @param size Size of the tile data in bytes.
+ * @param dst Destination framebuffer.
+ * @param dstWidth Framebuffer width in pixels.
+ * @param dstHeight Framebuffer height in pixels.
+ * @param posX X position of the tile on the framebuffer.
+ * @param posY Y position of the tile on the framebuffer.
+ * @return True if the whole tile was decoded.
+ */
+bool RasterTile::decode(const uint8_t* data, size_t size, uint16_t* dst, int32_t dstWidth, int32_t dstHeight, int32_t posX, int32_t posY)
+{
+    uint16_t width;
+    uint16_t height;
+    if (!dst || !readHeader(data, size, width, height))
+        return false;
+
+    const bool clipped = posX < 0 || posY < 0 || posX + width > dstWidth || posY + height > dstHeight;
+    const uint8_t* p = data + Q565_HEADER_SIZE;
+    const uint8_t* end = data + size;
+    uint16_t cache[64];
+    memset(cache, 0, sizeof(cache));
+    uint16_t px = 0;
+    uint16_t pxSwapped = 0;
+    int32_t col = 0;
+    int32_t row = 0;
+
+    while (row < height)
+    {
+        if (p >= end)
+            return false;
+
+        const uint8_t op = *p++;
+        uint32_t count = 1;
+
+        if (op == OP_RGB565)
+        {
+            if (p + 2 > end)
+                return false;
+            px = (p[0] << 8) | p[1];
+            p += 2;
+            pxSwapped = (px >> 8) | (px << 8);
+            cache[hash(px)] = px;
+        }
+        else if ((op & OP_MASK) == OP_INDEX)
+        {
+            px = cache[op];
+            pxSwapped = (px >> 8) | (px << 8);
+        }
+        else if ((op & OP_MASK) == OP_DIFF)
+        {
+            const uint16_t r = (((px >> 11) & 0x1F) + ((op >> 4) & 0x03) - 2) & 0x1F;
+            const uint16_t g = (((px >> 5) & 0x3F) + ((op >> 2) & 0x03) - 2) & 0x3F;
+            const uint16_t b = ((px & 0x1F) + (op & 0x03) - 2) & 0x1F;
+            px = (r << 11) | (g << 5) | b;
+            pxSwapped = (px >> 8) | (px << 8);
+            cache[hash(px)] = px;
+        }
+        else if ((op & OP_MASK) == OP_RUN)
+            count = (op & 0x3F) + 1;
+        else
+            return false;
+
+        while (count > 0 && row < height)
+        {
+            uint32_t span = width - col;
+            if (span > count)
+                span = count;
+
+            if (!clipped)
+            {
+                uint16_t* out = dst + (posY + row) * dstWidth + posX + col;
+                for (uint32_t i = 0; i < span; i++)
+                    out[i] = pxSwapped;
+            }
+            else if (posY + row >= 0 && posY + row < dstHeight)
+            {
+                int32_t x0 = posX + col;
+                int32_t x1 = x0 + (int32_t)span;
+                if (x0 < 0)
+                    x0 = 0;
+                if (x1 > dstWidth)
+                    x1 = dstWidth;
+                uint16_t* out = dst + (posY + row) * dstWidth;
+                for (int32_t x = x0; x < x1; x++)
+                    out[x] = pxSwapped;
+            }
+
+            col += span;
+            count -= span;
+            if (col == width)
+            {
+                col = 0;
+                row++;
+            }
+        }
+    }
+
+    return true;
+}
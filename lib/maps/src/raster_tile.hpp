@@ -0,0 +1,51 @@
+/**
+ * @file raster_tile.hpp
+ * @brief Q565 raster tile decoder - IceNav fast-decode rendered tiles
+ * @version 0.2.5
+ * @date 2026-04
+ *
+ * Q565 is a QOI-style byte stream over RGB565 pixels. Rendered map tiles are
+ * made of flat areas and antialiased edges, so a 64-entry color cache, small
+ * channel deltas and pixel runs give PNG-like sizes with a decoder that needs
+ * no inflate window and writes straight into the sprite framebuffer.
+ *
+ * Layout:
+ *  - Header (12 bytes): magic "Q565", width (u16 LE), height (u16 LE), reserved (u32)
+ *  - Stream (until width * height pixels are produced):
+ *      00iiiiii          INDEX  pixel from color cache slot i
+ *      01rrggbb          DIFF   r,g,b delta in [-2..1] (bias 2, wraps per channel)
+ *      10nnnnnn          RUN    repeat previous pixel n + 1 times
+ *      11111110 hi lo    RGB565 literal color (big-endian)
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+
+static constexpr uint8_t Q565_MAGIC[4] = {'Q', '5', '6', '5'};
+static constexpr size_t Q565_HEADER_SIZE = 12;
+
+/**
+ * @brief Q565 raster tile decoder
+ */
+class RasterTile
+{
+public:
+    static constexpr uint8_t OP_INDEX = 0x00;
+    static constexpr uint8_t OP_DIFF = 0x40;
+    static constexpr uint8_t OP_RUN = 0x80;
+    static constexpr uint8_t OP_RGB565 = 0xFE;
+    static constexpr uint8_t OP_MASK = 0xC0;
+
+    static bool readHeader(const uint8_t* data, size_t size, uint16_t& width, uint16_t& height);
+    static bool decode(const uint8_t* data, size_t size, uint16_t* dst, int32_t dstWidth, int32_t dstHeight, int32_t posX, int32_t posY);
+
+    /**
+     * @brief Color cache slot for an RGB565 pixel.
+     */
+    static inline uint8_t hash(uint16_t px)
+    {
+        return (uint8_t)((((px >> 11) & 0x1F) * 3 + ((px >> 5) & 0x3F) * 5 + (px & 0x1F) * 7) & 0x3F);
+    }
+};
@@ -0,0 +1,409 @@
+/**
+ * @file track_overlay.cpp
+ * @brief Track map overlay - several styled tracks over one shared segment index
+ * @version 0.2.5
+ * @date 2026-04
+ */
+
+#include "track_overlay.hpp"
+#include <algorithm>
+#include <cmath>
+
+namespace
+{
+    constexpr uint8_t GRID_BITS = TrackOverlay::WORLD_ZOOM + 8 - TrackOverlay::CELL_BITS;  /**< Cells per axis, log2 */
+    constexpr uint32_t WIDE_CELLS = 64;     /**< Chunks covering more cells are tested on every query */
+
+    /**
+     * @brief Cell key of a cell position
+     */
+    inline int32_t cellKey(uint32_t cx, uint32_t cy)
+    {
+        return (int32_t)((cy << GRID_BITS) | cx);
+    }
+}
+
+TrackOverlay::TrackOverlay() : chunksVisited(0), cellCount(0), queryStamp(0)
+{
+    for (uint8_t i = 0; i < MAX_TRACKS; i++)
+    {
+        tracks[i].style = {0, 1};
+        tracks[i].openChunk = -1;
+    }
+}
+
+/**
+ * @brief World pixel of a position at a zoom (Web Mercator, 256 pixel tiles)
+ *
+ * @param lat Latitude (degrees), clamped to the Mercator limits
+ * @param lon Longitude (degrees)
+ * @param zoom Zoom level, up to WORLD_ZOOM
+ * @param x World pixel X
+ * @param y World pixel Y
+ */
+void TrackOverlay::project(float lat, float lon, uint8_t zoom, int32_t &x, int32_t &y)
+{
+    const double size = (double)(256u << zoom);
+    const double latRad = std::max(-85.0511, std::min(85.0511, (double)lat)) * M_PI / 180.0;
+    const double fx = ((double)lon + 180.0) / 360.0;
+    const double fy = (1.0 - log(tan(latRad) + 1.0 / cos(latRad)) / M_PI) / 2.0;
+    x = (int32_t)std::max(0.0, std::min(size - 1.0, fx * size));
+    y = (int32_t)std::max(0.0, std::min(size - 1.0, fy * size));
+}
+
+/**
+ * @brief Replace a track
+ *
+ * @details The shared index is rebuilt, so this is meant for loading a track, not for
+ *          every point of a recording (see append()).
+ *
+ * @param track Track slot
+ * @param lat Latitudes (degrees)
+ * @param lon Longitudes (degrees)
+ * @param count Points
+ * @param style Drawing style
+ */
+void TrackOverlay::set(uint8_t track, const float *lat, const float *lon, size_t count, TrackStyle style)
+{
+    if (track >= MAX_TRACKS)
+        return;
+
+    Track &t = tracks[track];
+    t.x.resize(count);
+    t.y.resize(count);
+    for (size_t i = 0; i < count; i++)
+    {
+        int32_t x, y;
+        project(lat[i], lon[i], WORLD_ZOOM, x, y);
+        t.x[i] = (uint32_t)x;
+        t.y[i] = (uint32_t)y;
+    }
+    t.style = style;
+    rebuildIndex();
+}
+
+/**
+ * @brief Add a point at the end of a track
+ *
+ * @details Only the last chunk of the track is touched; it joins the index when full.
+ *
+ * @param track Track slot
+ * @param lat Latitude (degrees)
+ * @param lon Longitude (degrees)
+ * @param style Drawing style
+ */
+void TrackOverlay::append(uint8_t track, float lat, float lon, TrackStyle style)
+{
+    if (track >= MAX_TRACKS)
+        return;
+
+    Track &t = tracks[track];
+    int32_t x, y;
+    project(lat, lon, WORLD_ZOOM, x, y);
+    t.x.push_back((uint32_t)x);
+    t.y.push_back((uint32_t)y);
+    t.style = style;
+
+    const uint32_t last = (uint32_t)t.x.size() - 1;
+    if (last == 0)
+        return;
+    if (t.openChunk < 0)
+    {
+        addChunk(track, last - 1, last);
+        return;
+    }
+
+    Chunk &c = chunks[t.openChunk];
+    c.last = last;
+    c.minX = std::min(c.minX, (uint32_t)x);
+    c.minY = std::min(c.minY, (uint32_t)y);
+    c.maxX = std::max(c.maxX, (uint32_t)x);
+    c.maxY = std::max(c.maxY, (uint32_t)y);
+    if (c.last - c.first >= CHUNK)
+        closeChunk(track);
+}
+
+/**
+ * @brief Remove a track
+ *
+ * @param track Track slot
+ */
+void TrackOverlay::remove(uint8_t track)
+{
+    if (track >= MAX_TRACKS || tracks[track].x.empty())
+        return;
+
+    tracks[track].x.clear();
+    tracks[track].x.shrink_to_fit();
+    tracks[track].y.clear();
+    tracks[track].y.shrink_to_fit();
+    rebuildIndex();
+}
+
+/**
+ * @brief Remove all the tracks
+ */
+void TrackOverlay::clear()
+{
+    for (uint8_t i = 0; i < MAX_TRACKS; i++)
+    {
+        tracks[i].x.clear();
+        tracks[i].x.shrink_to_fit();
+        tracks[i].y.clear();
+        tracks[i].y.shrink_to_fit();
+    }
+    rebuildIndex();
+}
+
+/**
+ * @brief Points of a track
+ */
+size_t TrackOverlay::points(uint8_t track) const
+{
+    return track < MAX_TRACKS ? tracks[track].x.size() : 0;
+}
+
+/**
+ * @brief Drawing style of a track
+ */
+TrackStyle TrackOverlay::style(uint8_t track) const
+{
+    return track < MAX_TRACKS ? tracks[track].style : TrackStyle{0, 1};
+}
+
+/**
+ * @brief PSRAM used by the tracks and the index (bytes)
+ */
+size_t TrackOverlay::memoryBytes() const
+{
+    size_t bytes = chunks.capacity() * sizeof(Chunk) + refs.capacity() * sizeof(CellRef) +
+                   cellTable.capacity() * sizeof(Cell);
+    for (uint8_t i = 0; i < MAX_TRACKS; i++)
+        bytes += (tracks[i].x.capacity() + tracks[i].y.capacity()) * sizeof(uint32_t);
+    return bytes;
+}
+
+/**
+ * @brief Add a chunk of a track, open (out of the index)
+ */
+void TrackOverlay::addChunk(uint8_t track, uint32_t first, uint32_t last)
+{
+    const Track &t = tracks[track];
+    Chunk c = {track, first, last, UINT32_MAX, UINT32_MAX, 0, 0, 0};
+    for (uint32_t i = first; i <= last; i++)
+    {
+        c.minX = std::min(c.minX, t.x[i]);
+        c.minY = std::min(c.minY, t.y[i]);
+        c.maxX = std::max(c.maxX, t.x[i]);
+        c.maxY = std::max(c.maxY, t.y[i]);
+    }
+    chunks.push_back(c);
+    tracks[track].openChunk = (int32_t)chunks.size() - 1;
+}
+
+/**
+ * @brief Move the open chunk of a track to the index
+ */
+void TrackOverlay::closeChunk(uint8_t track)
+{
+    if (tracks[track].openChunk < 0)
+        return;
+    indexChunk((uint32_t)tracks[track].openChunk);
+    tracks[track].openChunk = -1;
+}
+
+/**
+ * @brief Store a chunk in the cells its bounding box covers
+ *
+ * @details A chunk spanning many cells (a long straight segment, a gap in a recording)
+ *          would fill the grid with references, so it is kept in the wide list and
+ *          tested on every query instead.
+ */
+void TrackOverlay::indexChunk(uint32_t chunk)
+{
+    const Chunk &c = chunks[chunk];
+    const uint32_t cx0 = c.minX >> CELL_BITS, cx1 = c.maxX >> CELL_BITS;
+    const uint32_t cy0 = c.minY >> CELL_BITS, cy1 = c.maxY >> CELL_BITS;
+    if ((cx1 - cx0 + 1) * (cy1 - cy0 + 1) > WIDE_CELLS)
+    {
+        wideChunks.push_back(chunk);
+        return;
+    }
+
+    for (uint32_t cy = cy0; cy <= cy1; cy++)
+        for (uint32_t cx = cx0; cx <= cx1; cx++)
+        {
+            int32_t *head = cellHead(cellKey(cx, cy), true);
+            refs.push_back({chunk, *head});
+            *head = (int32_t)refs.size() - 1;
+        }
+}
+
+/**
+ * @brief Rebuild the chunks and the index of all the tracks
+ */
+void TrackOverlay::rebuildIndex()
+{
+    chunks.clear();
+    refs.clear();
+    wideChunks.clear();
+    cellTable.assign(cellTable.empty() ? 256 : cellTable.size(), {-1, -1});
+    cellCount = 0;
+
+    size_t segments = 0;
+    for (uint8_t i = 0; i < MAX_TRACKS; i++)
+        segments += tracks[i].x.empty() ? 0 : tracks[i].x.size() - 1;
+    chunks.reserve(segments / CHUNK + MAX_TRACKS);
+    refs.reserve(segments / CHUNK * 2);
+
+    for (uint8_t i = 0; i < MAX_TRACKS; i++)
+    {
+        tracks[i].openChunk = -1;
+        const uint32_t n = (uint32_t)tracks[i].x.size();
+        for (uint32_t first = 0; first + 1 < n; first += CHUNK)
+        {
+            addChunk(i, first, std::min(first + CHUNK, n - 1));
+            if (chunks.back().last - first >= CHUNK)
+                closeChunk(i);
+        }
+    }
+}
+
+/**
+ * @brief Head of the reference list of a cell
+ *
+ * @param key Cell key
+ * @param create Add the cell if missing
+ * @return Head, nullptr if the cell is missing and create is false
+ */
+int32_t *TrackOverlay::cellHead(int32_t key, bool create)
+{
+    if (create && (cellCount + 1) * 10 > cellTable.size() * 7)
+        rehashCells(cellTable.size() * 2);
+
+    const size_t mask = cellTable.size() - 1;
+    size_t slot = ((uint32_t)key * 2654435761u) & mask;
+    while (cellTable[slot].key != -1)
+    {
+        if (cellTable[slot].key == key)
+            return &cellTable[slot].head;
+        slot = (slot + 1) & mask;
+    }
+    if (!create)
+        return nullptr;
+
+    cellTable[slot].key = key;
+    cellTable[slot].head = -1;
+    cellCount++;
+    return &cellTable[slot].head;
+}
+
+/**
+ * @brief Grow the cell hash table
+ *
+ * @param capacity New slots, power of two
+ */
+void TrackOverlay::rehashCells(size_t capacity)
+{
+    std::vector<Cell, PsramAllocator<Cell>> old(capacity, {-1, -1});
+    old.swap(cellTable);
+    const size_t mask = capacity - 1;
+    for (const Cell &cell : old)
+    {
+        if (cell.key == -1)
+            continue;
+        size_t slot = ((uint32_t)cell.key * 2654435761u) & mask;
+        while (cellTable[slot].key != -1)
+            slot = (slot + 1) & mask;
+        cellTable[slot] = cell;
+    }
+}
+
+/**
+ * @brief Track runs to draw in a viewport
+ *
+ * @details The viewport should be wider than the drawing area by half the widest line,
+ *          so segments partly inside are drawn. Runs come sorted by track slot, so
+ *          lower slots are drawn below higher ones.
+ *
+ * @param zoom Map zoom, up to WORLD_ZOOM
+ * @param left Viewport left (world pixels at zoom)
+ * @param top Viewport top (world pixels at zoom)
+ * @param width Viewport width (pixels)
+ * @param height Viewport height (pixels)
+ * @param out Runs
+ * @return Runs found
+ */
+size_t TrackOverlay::query(uint8_t zoom, int32_t left, int32_t top, int32_t width, int32_t height,
+                           std::vector<TrackRun> &out)
+{
+    out.clear();
+    visible.clear();
+    chunksVisited = 0;
+    if (chunks.empty() || zoom > WORLD_ZOOM || width <= 0 || height <= 0)
+        return 0;
+
+    const uint8_t up = WORLD_ZOOM - zoom;
+    const int64_t worldMax = ((int64_t)256 << WORLD_ZOOM) - 1;
+    const uint32_t minX = (uint32_t)std::max<int64_t>(0, (int64_t)left << up);
+    const uint32_t minY = (uint32_t)std::max<int64_t>(0, (int64_t)top << up);
+    const int64_t maxX = std::min<int64_t>(worldMax, (((int64_t)left + width) << up) - 1);
+    const int64_t maxY = std::min<int64_t>(worldMax, (((int64_t)top + height) << up) - 1);
+    if (maxX < (int64_t)minX || maxY < (int64_t)minY)
+        return 0;
+
+    if (++queryStamp == 0)
+    {
+        for (Chunk &c : chunks)
+            c.stamp = 0;
+        queryStamp = 1;
+    }
+
+    auto test = [&](uint32_t chunk)
+    {
+        Chunk &c = chunks[chunk];
+        if (c.stamp == queryStamp)
+            return;
+        c.stamp = queryStamp;
+        chunksVisited++;
+        if (c.maxX >= minX && c.minX <= (uint32_t)maxX && c.maxY >= minY && c.minY <= (uint32_t)maxY)
+            visible.push_back(chunk);
+    };
+
+    const uint32_t cx0 = minX >> CELL_BITS, cx1 = (uint32_t)maxX >> CELL_BITS;
+    const uint32_t cy0 = minY >> CELL_BITS, cy1 = (uint32_t)maxY >> CELL_BITS;
+    if ((uint64_t)(cx1 - cx0 + 1) * (cy1 - cy0 + 1) > cellCount)
+    {
+        for (uint32_t i = 0; i < chunks.size(); i++)
+            test(i);
+    }
+    else
+    {
+        for (uint32_t cy = cy0; cy <= cy1; cy++)
+            for (uint32_t cx = cx0; cx <= cx1; cx++)
+            {
+                const int32_t *head = cellHead(cellKey(cx, cy), false);
+                for (int32_t r = head ? *head : -1; r != -1; r = refs[r].next)
+                    test(refs[r].chunk);
+            }
+        for (uint32_t chunk : wideChunks)
+            test(chunk);
+        for (uint8_t i = 0; i < MAX_TRACKS; i++)
+            if (tracks[i].openChunk >= 0)
+                test((uint32_t)tracks[i].openChunk);
+    }
+
+    std::sort(visible.begin(), visible.end(), [this](uint32_t a, uint32_t b)
+    {
+        return chunks[a].track != chunks[b].track ? chunks[a].track < chunks[b].track : chunks[a].first < chunks[b].first;
+    });
+    for (uint32_t chunk : visible)
+    {
+        const Chunk &c = chunks[chunk];
+        if (!out.empty() && out.back().track == c.track && out.back().last == c.first)
+            out.back().last = c.last;
+        else
+            out.push_back({c.track, c.first, c.last});
+    }
+    return out.size();
+}
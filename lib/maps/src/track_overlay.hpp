@@ -0,0 +1,147 @@
+/**
+ * @file track_overlay.hpp
+ * @brief Track map overlay - several styled tracks over one shared segment index
+ * @version 0.2.5
+ * @date 2026-04
+ *
+ * Platform independent, also built by tools/track_overlay.
+ *
+ * Each track is kept projected once, as Web Mercator world pixels at zoom WORLD_ZOOM,
+ * so its vertices at any zoom are a shift away and a render never projects latitudes
+ * and longitudes again. The segments of every track are grouped in chunks of CHUNK
+ * consecutive segments with their bounding box, and the chunks are stored in the cells
+ * they cover of one hashed grid shared by all the tracks (cells of 2^CELL_BITS world
+ * pixels). A render asks for the chunks crossing its viewport: through the cells of
+ * the viewport, or through the chunk list when the viewport covers more cells than
+ * there are chunks (low zooms). Consecutive visible chunks of a track are merged into
+ * runs, drawn as one polyline. The cost grows with the segments in view, not with the
+ * points of all the tracks.
+ *
+ * Points appended to a track (recorded breadcrumb) extend its last chunk, which stays
+ * out of the grid and is tested on its own until it is full.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "PsramAllocator.hpp"
+
+/**
+ * @brief Drawing style of a track
+ */
+struct TrackStyle
+{
+    uint16_t color;     /**< RGB565 color */
+    uint8_t width;      /**< Line width (pixels) */
+};
+
+/**
+ * @brief Visible points of a track, from first to last (inclusive)
+ */
+struct TrackRun
+{
+    uint8_t track;      /**< Track slot */
+    uint32_t first;     /**< First point */
+    uint32_t last;      /**< Last point */
+};
+
+/**
+ * @class TrackOverlay
+ * @brief Projected tracks with a shared spatial index of their segments
+ */
+class TrackOverlay
+{
+public:
+    static constexpr uint8_t MAX_TRACKS = 8;    /**< Track slots */
+    static constexpr uint8_t WORLD_ZOOM = 22;   /**< Zoom of the stored world pixels */
+    static constexpr uint8_t CELL_BITS = 16;    /**< Grid cell of 2^16 world pixels (256 pixels at zoom 14) */
+    static constexpr uint32_t CHUNK = 16;       /**< Segments per chunk */
+
+    TrackOverlay();
+
+    void set(uint8_t track, const float *lat, const float *lon, size_t count, TrackStyle style);
+    void append(uint8_t track, float lat, float lon, TrackStyle style);
+    void remove(uint8_t track);
+    void clear();
+    size_t points(uint8_t track) const;
+    TrackStyle style(uint8_t track) const;
+    size_t query(uint8_t zoom, int32_t left, int32_t top, int32_t width, int32_t height, std::vector<TrackRun> &out);
+    size_t memoryBytes() const;
+
+    /**
+     * @brief Vertex of a track as world pixels at a zoom
+     */
+    inline void vertex(uint8_t track, uint32_t i, uint8_t zoom, int32_t &x, int32_t &y) const
+    {
+        const uint8_t down = WORLD_ZOOM - zoom;
+        x = (int32_t)(tracks[track].x[i] >> down);
+        y = (int32_t)(tracks[track].y[i] >> down);
+    }
+
+    static void project(float lat, float lon, uint8_t zoom, int32_t &x, int32_t &y);
+
+    uint32_t chunksVisited;     /**< Chunks tested by the last query */
+
+private:
+    typedef std::vector<uint32_t, PsramAllocator<uint32_t>> Column;
+
+    /**
+     * @brief Projected track
+     */
+    struct Track
+    {
+        Column x;               /**< World X of each point */
+        Column y;               /**< World Y of each point */
+        TrackStyle style;       /**< Drawing style */
+        int32_t openChunk;      /**< Last chunk, not full and not in the grid, -1 = none */
+    };
+
+    /**
+     * @brief Consecutive segments of a track with their bounding box
+     */
+    struct Chunk
+    {
+        uint8_t track;          /**< Track slot */
+        uint32_t first;         /**< First point */
+        uint32_t last;          /**< Last point */
+        uint32_t minX, minY;    /**< Bounding box (world pixels) */
+        uint32_t maxX, maxY;    /**< Bounding box (world pixels) */
+        uint32_t stamp;         /**< Query that last visited it */
+    };
+
+    /**
+     * @brief Chunk stored in a cell
+     */
+    struct CellRef
+    {
+        uint32_t chunk;         /**< Chunk index */
+        int32_t next;           /**< Next reference of the cell, -1 = last */
+    };
+
+    /**
+     * @brief Grid cell hash slot
+     */
+    struct Cell
+    {
+        int32_t key;            /**< Cell key, -1 = empty slot */
+        int32_t head;           /**< First reference of the cell */
+    };
+
+    Track tracks[MAX_TRACKS];
+    std::vector<Chunk, PsramAllocator<Chunk>> chunks;
+    std::vector<CellRef, PsramAllocator<CellRef>> refs;
+    std::vector<Cell, PsramAllocator<Cell>> cellTable;
+    std::vector<uint32_t> wideChunks;   /**< Chunks too large for the grid */
+    uint32_t cellCount;                 /**< Cells in use */
+    uint32_t queryStamp;                /**< Current query */
+    std::vector<uint32_t> visible;      /**< Visible chunks of the current query */
+
+    void addChunk(uint8_t track, uint32_t first, uint32_t last);
+    void closeChunk(uint8_t track);
+    void indexChunk(uint32_t chunk);
+    void rebuildIndex();
+    int32_t *cellHead(int32_t key, bool create);
+    void rehashCells(size_t capacity);
+};
@@ -0,0 +1,208 @@
+/**
+ * @file waypoint_overlay.cpp
+ * @brief Waypoint map overlay - viewport culling and screen-space clustering
+ * @version 0.2.5
+ * @date 2026-04
+ */
+
+#include "waypoint_overlay.hpp"
+#include <algorithm>
+#include <cmath>
+#include <utility>
+
+namespace
+{
+    /**
+     * @brief Spread the bits of a 32 bit value to the even bits of a 64 bit one
+     */
+    inline uint64_t spreadBits(uint32_t v)
+    {
+        uint64_t x = v;
+        x = (x | (x << 16)) & 0x0000FFFF0000FFFFull;
+        x = (x | (x << 8)) & 0x00FF00FF00FF00FFull;
+        x = (x | (x << 4)) & 0x0F0F0F0F0F0F0F0Full;
+        x = (x | (x << 2)) & 0x3333333333333333ull;
+        x = (x | (x << 1)) & 0x5555555555555555ull;
+        return x;
+    }
+
+    /**
+     * @brief Gather the even bits of a 64 bit value, inverse of spreadBits()
+     */
+    inline uint32_t compactBits(uint64_t x)
+    {
+        x &= 0x5555555555555555ull;
+        x = (x | (x >> 1)) & 0x3333333333333333ull;
+        x = (x | (x >> 2)) & 0x0F0F0F0F0F0F0F0Full;
+        x = (x | (x >> 4)) & 0x00FF00FF00FF00FFull;
+        x = (x | (x >> 8)) & 0x0000FFFF0000FFFFull;
+        x = (x | (x >> 16)) & 0x00000000FFFFFFFFull;
+        return (uint32_t)x;
+    }
+
+    /**
+     * @brief Morton code of a cell or pixel, X in the even bits
+     */
+    inline uint64_t morton(uint32_t x, uint32_t y)
+    {
+        return spreadBits(x) | (spreadBits(y) << 1);
+    }
+}
+
+WaypointOverlay::WaypointOverlay() : generation(0), built(false) {}
+
+/**
+ * @brief World pixel of a position at a zoom (Web Mercator, 256 pixel tiles)
+ *
+ * @param lat Latitude (degrees), clamped to the Mercator limits
+ * @param lon Longitude (degrees)
+ * @param zoom Zoom level, up to WORLD_ZOOM
+ * @param x World pixel X
+ * @param y World pixel Y
+ */
+void WaypointOverlay::project(float lat, float lon, uint8_t zoom, int32_t &x, int32_t &y)
+{
+    const double size = (double)(256u << zoom);
+    const double latRad = std::max(-85.0511, std::min(85.0511, (double)lat)) * M_PI / 180.0;
+    const double fx = ((double)lon + 180.0) / 360.0;
+    const double fy = (1.0 - log(tan(latRad) + 1.0 / cos(latRad)) / M_PI) / 2.0;
+    x = (int32_t)std::max(0.0, std::min(size - 1.0, fx * size));
+    y = (int32_t)std::max(0.0, std::min(size - 1.0, fy * size));
+}
+
+/**
+ * @brief Take a snapshot of the waypoint positions
+ *
+ * @param points Live waypoints (WaypointStore::getPositions)
+ * @param generation Store generation of the positions
+ */
+void WaypointOverlay::build(const std::vector<WaypointPosition> &points, uint32_t generation)
+{
+    const size_t n = points.size();
+    std::vector<std::pair<uint64_t, uint32_t>, PsramAllocator<std::pair<uint64_t, uint32_t>>> order(n);
+    for (size_t i = 0; i < n; i++)
+    {
+        int32_t x, y;
+        project(points[i].lat, points[i].lon, WORLD_ZOOM, x, y);
+        order[i] = {morton((uint32_t)x, (uint32_t)y), points[i].id};
+    }
+    std::sort(order.begin(), order.end());
+
+    keys.resize(n);
+    ids.resize(n);
+    sumX.resize(n + 1);
+    sumY.resize(n + 1);
+    sumX[0] = 0;
+    sumY[0] = 0;
+    for (size_t i = 0; i < n; i++)
+    {
+        keys[i] = order[i].first;
+        ids[i] = order[i].second;
+        sumX[i + 1] = sumX[i] + compactBits(order[i].first);
+        sumY[i + 1] = sumY[i] + compactBits(order[i].first >> 1);
+    }
+    this->generation = generation;
+    built = true;
+}
+
+/**
+ * @brief Drop the snapshot
+ */
+void WaypointOverlay::clear()
+{
+    keys.clear();
+    keys.shrink_to_fit();
+    ids.clear();
+    ids.shrink_to_fit();
+    sumX.clear();
+    sumX.shrink_to_fit();
+    sumY.clear();
+    sumY.shrink_to_fit();
+    built = false;
+}
+
+/**
+ * @brief Waypoints in the snapshot
+ */
+size_t WaypointOverlay::size() const
+{
+    return keys.size();
+}
+
+/**
+ * @brief PSRAM used by the snapshot (bytes)
+ */
+size_t WaypointOverlay::memoryBytes() const
+{
+    return (keys.capacity() + sumX.capacity() + sumY.capacity()) * sizeof(uint64_t) + ids.capacity() * sizeof(uint32_t);
+}
+
+/**
+ * @brief Marks of one cell
+ *
+ * @details The waypoints of the cell are the keys with its Morton code as prefix.
+ */
+void WaypointOverlay::emitCell(uint8_t zoom, uint32_t cx, uint32_t cy, int32_t left, int32_t top, int32_t right,
+                               int32_t bottom, bool cluster, std::vector<OverlayMark> &out) const
+{
+    const uint8_t down = WORLD_ZOOM - zoom;
+    const uint8_t shift = 2 * (down + CELL_SHIFT);
+    const uint64_t prefix = morton(cx, cy);
+    const size_t first = std::lower_bound(keys.begin(), keys.end(), prefix << shift) - keys.begin();
+    const size_t last = std::lower_bound(keys.begin() + first, keys.end(), (prefix + 1) << shift) - keys.begin();
+    if (last == first)
+        return;
+
+    if (cluster && last - first > 1)
+    {
+        const uint32_t count = (uint32_t)(last - first);
+        const int32_t x = (int32_t)(((sumX[last] - sumX[first]) / count) >> down);
+        const int32_t y = (int32_t)(((sumY[last] - sumY[first]) / count) >> down);
+        out.push_back({x, y, count, ids[first]});
+        return;
+    }
+
+    for (size_t i = first; i < last; i++)
+    {
+        const int32_t x = (int32_t)((sumX[i + 1] - sumX[i]) >> down);
+        const int32_t y = (int32_t)((sumY[i + 1] - sumY[i]) >> down);
+        if (x >= left && x < right && y >= top && y < bottom)
+            out.push_back({x, y, 1, ids[i]});
+    }
+}
+
+/**
+ * @brief Marks to draw in a viewport
+ *
+ * @details The viewport should be wider than the screen by the mark size, so marks
+ *          partly inside are drawn.
+ *
+ * @param zoom Map zoom, up to WORLD_ZOOM
+ * @param left Viewport left (world pixels at zoom)
+ * @param top Viewport top (world pixels at zoom)
+ * @param width Viewport width (pixels)
+ * @param height Viewport height (pixels)
+ * @param cluster Group the waypoints of each cell into one mark
+ * @param out Marks
+ * @return Marks found
+ */
+size_t WaypointOverlay::query(uint8_t zoom, int32_t left, int32_t top, int32_t width, int32_t height, bool cluster,
+                              std::vector<OverlayMark> &out) const
+{
+    out.clear();
+    if (keys.empty() || zoom > WORLD_ZOOM || width <= 0 || height <= 0)
+        return 0;
+
+    const int64_t worldSize = (int64_t)256 << zoom;
+    const int32_t right = (int32_t)std::min<int64_t>(worldSize, (int64_t)left + width);
+    const int32_t bottom = (int32_t)std::min<int64_t>(worldSize, (int64_t)top + height);
+    left = std::max(0, left);
+    top = std::max(0, top);
+    if (left >= right || top >= bottom)
+        return 0;
+
+    for (uint32_t cy = (uint32_t)top >> CELL_SHIFT; cy <= (uint32_t)(bottom - 1) >> CELL_SHIFT; cy++)
+        for (uint32_t cx = (uint32_t)left >> CELL_SHIFT; cx <= (uint32_t)(right - 1) >> CELL_SHIFT; cx++)
+            emitCell(zoom, cx, cy, left, top, right, bottom, cluster, out);
+    return out.size();
+}
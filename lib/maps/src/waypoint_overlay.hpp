@@ -0,0 +1,75 @@
+/**
+ * @file waypoint_overlay.hpp
+ * @brief Waypoint map overlay - viewport culling and screen-space clustering
+ * @version 0.2.5
+ * @date 2026-04
+ *
+ * Platform independent, also built by tools/waypoint_overlay.
+ *
+ * The overlay keeps a snapshot of the waypoint positions as Web Mercator world pixels
+ * at zoom WORLD_ZOOM, sorted by their Morton (Z-order) code. At any zoom the map is cut
+ * in world-aligned cells of 2^CELL_SHIFT pixels, and the waypoints of one cell are a
+ * contiguous range of the snapshot, found by two binary searches. A frame visits the
+ * cells covering the viewport only: below the cluster zoom a cell with several
+ * waypoints is one mark at their centroid (prefix sums of the coordinates), above it
+ * every waypoint inside the viewport is a mark. The cost grows with the cells of the
+ * viewport and the marks drawn, not with the waypoints stored.
+ *
+ * Cells are aligned to the world, not to the screen, so clusters do not change while
+ * the map is panned.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "waypointStore.hpp"
+#include "PsramAllocator.hpp"
+
+/**
+ * @brief Waypoint or cluster of waypoints to draw
+ */
+struct OverlayMark
+{
+    int32_t x;          /**< World pixel X at the query zoom */
+    int32_t y;          /**< World pixel Y at the query zoom */
+    uint32_t count;     /**< Waypoints in the mark, 1 for a single waypoint */
+    uint32_t id;        /**< Store entry id of a single waypoint */
+};
+
+/**
+ * @class WaypointOverlay
+ * @brief Morton ordered waypoint snapshot for map drawing
+ */
+class WaypointOverlay
+{
+public:
+    static constexpr uint8_t WORLD_ZOOM = 22;   /**< Zoom of the stored world pixels */
+    static constexpr uint8_t CELL_SHIFT = 6;    /**< Cluster cells of 64 pixels */
+
+    WaypointOverlay();
+
+    void build(const std::vector<WaypointPosition> &points, uint32_t generation);
+    void clear();
+    size_t size() const;
+    size_t query(uint8_t zoom, int32_t left, int32_t top, int32_t width, int32_t height, bool cluster,
+                 std::vector<OverlayMark> &out) const;
+    size_t memoryBytes() const;
+
+    static void project(float lat, float lon, uint8_t zoom, int32_t &x, int32_t &y);
+
+    uint32_t generation;    /**< Store generation of the snapshot */
+    bool built;             /**< Snapshot taken at least once */
+
+private:
+    typedef std::vector<uint64_t, PsramAllocator<uint64_t>> Column64;
+
+    Column64 keys;                                  /**< Morton codes, sorted */
+    Column64 sumX;                                  /**< Prefix sums of the world X, size + 1 */
+    Column64 sumY;                                  /**< Prefix sums of the world Y, size + 1 */
+    std::vector<uint32_t, PsramAllocator<uint32_t>> ids;   /**< Store entry ids, key order */
+
+    void emitCell(uint8_t zoom, uint32_t cx, uint32_t cy, int32_t left, int32_t top, int32_t right, int32_t bottom,
+                  bool cluster, std::vector<OverlayMark> &out) const;
+};
@@ -9,6 +9,8 @@
 #include "power.hpp"
 
 #include "storage.hpp"
+#include "trackRecorder.hpp"
+#include "waypointStore.hpp"
 
 extern const uint8_t BOARD_BOOT_PIN; /**< External declaration for the board's boot pin number. */
 extern Storage storage;
@@ -128,6 +130,8 @@ void Power::deviceSuspend()
  */
 void Power::deviceShutdown()
 {
+    trackRecorder.stop();
+    waypointStore.close();
     powerOffPeripherals();
     powerDeepSleep();
 }
@@ -20,9 +20,15 @@
   X(KMAP_VECTOR, "vectMap", BOOL)        \
   X(KMAP_SPEED, "mapSpeed", BOOL)        \
   X(KMAP_SCALE, "mapScale", BOOL)        \
+  X(KMAP_WPTS, "mapWpts", BOOL)          \
+  X(KMAP_BUDGET, "mapBudget", UINT)      \
+  X(KMAP_PERF, "mapPerf", BOOL)          \
+  X(KMAP_GEOMS, "mapGeoms", UINT)        \
+  X(KMAP_LAYERS, "mapLayers", UINT)      \
   X(KMAP_COMPASS, "mapComp", BOOL)       \
   X(KMAP_COMP_ROT, "mapCompRot", BOOL)   \
   X(KSIM_NAV, "simNav", BOOL)            \
+  X(KNAV_SIMPL, "navSimpl", FLOAT)       \
   X(KGPS_TX, "gpsTX", UINT)              \
   X(KGPS_RX, "gpsRX", UINT)              \
   X(KLAT_DFL, "defLAT", FLOAT)          \
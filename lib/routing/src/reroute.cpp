@@ -0,0 +1,150 @@
+/**
+ * @file reroute.cpp
+ * @author Jordi Gauchía (jgauchia@jgauchia.com)
+ * @brief  Route back to the loaded track when off track
+ * @version 0.2.5
+ * @date 2026-04
+ */
+
+#include "reroute.hpp"
+#include <algorithm>
+#include "esp_log.h"
+
+static const char* TAG = "Reroute";
+
+Rerouter::Rerouter(const char *folder) : lastStatus(ROUTE_NO_GRAPH), folder(folder), offTrack(false),
+                                         offTrackSince(0), attempted(false), lastAttempt(0) {}
+
+/**
+ * @brief Drop the route and close the region pack
+ */
+void Rerouter::reset()
+{
+    dropRoute();
+    graph.close();
+    offTrack = false;
+    attempted = false;
+}
+
+/**
+ * @brief Check if the instructions come from a route
+ */
+bool Rerouter::active() const
+{
+    return !routeTrack.empty();
+}
+
+/**
+ * @brief Forget the current route
+ */
+void Rerouter::dropRoute()
+{
+    routeTrack.clear();
+    routeTrack.shrink_to_fit();
+    routeTurns.clear();
+    routeGrid.clear();
+    routeState = NavState{};
+}
+
+/**
+ * @brief Search a route from the position back to the loaded track
+ *
+ * @param lat Latitude
+ * @param lon Longitude
+ * @param track Loaded track
+ * @param trackIdx Matched track segment
+ * @param timeMs Time (ms)
+ * @return true if a route was found
+ */
+bool Rerouter::search(float lat, float lon, const TrackVector &track, int trackIdx, uint32_t timeMs)
+{
+    attempted = true;
+    lastAttempt = timeMs;
+    dropRoute();
+
+    if (!graph.contains(lat, lon))
+    {
+        std::string path;
+        if (!RoadGraph::findRegion(folder.c_str(), lat, lon, path) || !graph.open(path.c_str()))
+        {
+            graph.close();
+            lastStatus = ROUTE_NO_GRAPH;
+            return false;
+        }
+    }
+
+    size_t target = (size_t)std::max(trackIdx, 0);
+    const float rejoin = track.accumDist[std::min(target, track.size() - 1)] + REJOIN_AHEAD;
+    while (target < track.size() - 1 && track.accumDist[target] < rejoin)
+        target++;
+
+    lastStatus = router.route(graph, lat, lon, track.lat[target], track.lon[target], params, routeTrack, routeTurns);
+    router.release();
+    if (lastStatus != ROUTE_OK)
+    {
+        ESP_LOGW(TAG, "No route back to the track (%u)", (unsigned)lastStatus);
+        dropRoute();
+        return false;
+    }
+    routeGrid.build(routeTrack);
+    return true;
+}
+
+/**
+ * @brief Update after a navigation update on the loaded track
+ *
+ * @param lat Latitude
+ * @param lon Longitude
+ * @param heading Heading (deg)
+ * @param speed Speed (km/h)
+ * @param track Loaded track
+ * @param trackResult Result of the update on the loaded track
+ * @param config Navigation configuration
+ * @param timeMs Time (ms)
+ * @param result Instruction on the route
+ * @return true if result replaces trackResult
+ */
+bool Rerouter::update(float lat, float lon, float heading, float speed, const TrackVector &track,
+                      const NavResult &trackResult, const NavConfig &config, uint32_t timeMs, NavResult &result)
+{
+    if (trackResult.icon != NAV_ICON_OFF_TRACK || track.empty())
+    {
+        if (offTrack)
+            reset();
+        return false;
+    }
+
+    if (!offTrack)
+    {
+        offTrack = true;
+        offTrackSince = timeMs;
+        attempted = false;
+    }
+
+    if (active())
+    {
+        result = updateNavigation(lat, lon, heading, speed, routeTrack, routeGrid, routeTurns, routeState, 20, 200,
+                                  config);
+        if (result.icon != NAV_ICON_OFF_TRACK)
+        {
+            // The route ends on the track, where the track instructions take over
+            if (result.icon == NAV_ICON_FINISH)
+                result.icon = NAV_ICON_STRAIGHT;
+            result.loadedIdx = trackResult.loadedIdx;
+            return true;
+        }
+        // Left the route too
+        dropRoute();
+    }
+
+    if (timeMs - offTrackSince < REROUTE_DELAY || (attempted && timeMs - lastAttempt < RETRY_PERIOD))
+        return false;
+    if (!search(lat, lon, track, trackResult.trackIdx, timeMs))
+        return false;
+
+    result = updateNavigation(lat, lon, heading, speed, routeTrack, routeGrid, routeTurns, routeState, 20, 200, config);
+    if (result.icon == NAV_ICON_FINISH)
+        result.icon = NAV_ICON_STRAIGHT;
+    result.loadedIdx = trackResult.loadedIdx;
+    return true;
+}
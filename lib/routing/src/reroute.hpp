@@ -0,0 +1,62 @@
+/**
+ * @file reroute.hpp
+ * @author Jordi Gauchía (jgauchia@jgauchia.com)
+ * @brief  Route back to the loaded track when off track
+ * @version 0.2.5
+ * @date 2026-04
+ *
+ * Platform independent, also built by tools/road_graph.
+ *
+ * Run by the navigation task after each update on the loaded track. When the position
+ * stays off the track for REROUTE_DELAY, the region pack that covers it is opened and a
+ * route is searched to the track point REJOIN_AHEAD meters past the matched one. While
+ * the route exists the instructions come from it, and it is dropped when the position
+ * is back on the track. Failed or left routes are retried every RETRY_PERIOD.
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "navigation.hpp"
+#include "roadGraph.hpp"
+#include "router.hpp"
+
+/**
+ * @class Rerouter
+ * @brief Off track rerouting over the region road graph
+ */
+class Rerouter
+{
+public:
+    static constexpr uint32_t REROUTE_DELAY = 10000;    /**< Time off track before routing (ms) */
+    static constexpr uint32_t RETRY_PERIOD = 30000;     /**< Time between routing attempts (ms) */
+    static constexpr float REJOIN_AHEAD = 300.0f;       /**< Rejoin distance past the matched track point (m) */
+
+    explicit Rerouter(const char *folder = RoadGraph::ROUTE_FOLDER);
+
+    bool update(float lat, float lon, float heading, float speed, const TrackVector &track,
+                const NavResult &trackResult, const NavConfig &config, uint32_t timeMs, NavResult &result);
+    void reset();
+    bool active() const;
+
+    RouteStatus lastStatus;             /**< Result of the last routing attempt */
+    RouteParams params;                 /**< Route query limits */
+    TrackVector routeTrack;             /**< Current route */
+    std::vector<TurnPoint> routeTurns;  /**< Turns of the current route */
+    RoadGraph graph;                    /**< Region road graph */
+
+private:
+    std::string folder;                 /**< Folder of the region packs */
+    Router router;                      /**< Route search */
+    TrackGrid routeGrid;                /**< Spatial grid of the route */
+    NavState routeState;                /**< Navigation state on the route */
+    bool offTrack;                      /**< Off the loaded track */
+    uint32_t offTrackSince;             /**< Time it left the track (ms) */
+    bool attempted;                     /**< A route has been searched since it left the track */
+    uint32_t lastAttempt;               /**< Time of the last routing attempt (ms) */
+
+    bool search(float lat, float lon, const TrackVector &track, int trackIdx, uint32_t timeMs);
+    void dropRoute();
+};
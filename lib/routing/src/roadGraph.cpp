@@ -0,0 +1,422 @@
+/**
+ * @file roadGraph.cpp
+ * @author Jordi Gauchía (jgauchia@jgauchia.com)
+ * @brief  Road graph pack - block cached reader of a region road network on SD
+ * @version 0.2.5
+ * @date 2026-04
+ */
+
+#include "roadGraph.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <dirent.h>
+#include "esp_log.h"
+
+static const char* TAG = "RoadGraph";
+
+namespace
+{
+    /**
+     * @brief Pack header
+     */
+    struct GraphHeader
+    {
+        char magic[4];          /**< "RGR1" */
+        uint16_t version;       /**< RoadGraph::VERSION */
+        uint16_t headerSize;    /**< sizeof(GraphHeader) */
+        uint32_t nodes;         /**< Nodes */
+        uint32_t edges;         /**< Directed edges */
+        uint32_t blocks;        /**< Blocks */
+        uint16_t blockNodes;    /**< Nodes per block (the last one may have fewer) */
+        uint16_t reserved;      /**< Zero */
+        int32_t minLat, minLon; /**< Bounding box (1e-7 deg) */
+        int32_t maxLat, maxLon; /**< Bounding box (1e-7 deg) */
+        uint32_t indexOffset;   /**< Block index offset */
+        uint32_t checksum;      /**< FNV-1a of the block index */
+    };
+    static_assert(sizeof(GraphHeader) == 48, "Road graph header layout");
+
+    /**
+     * @brief Block payload header
+     */
+    struct BlockHeader
+    {
+        uint16_t nodes;         /**< Nodes in the block */
+        uint16_t reserved;      /**< Zero */
+        uint32_t outEdges;      /**< Outgoing edges */
+        uint32_t inEdges;       /**< Incoming edges */
+    };
+    static_assert(sizeof(BlockHeader) == 12, "Road graph block header layout");
+
+    static const char GRAPH_MAGIC[4] = {'R', 'G', 'R', '1'};
+    static constexpr uint32_t FNV_OFFSET = 2166136261u;
+    static constexpr uint32_t FNV_PRIME = 16777619u;
+    static constexpr float METERS_PER_DEG = 111319.49f;
+
+    static uint32_t fnv1a(const uint8_t *data, size_t len)
+    {
+        uint32_t hash = FNV_OFFSET;
+        for (size_t i = 0; i < len; i++)
+            hash = (hash ^ data[i]) * FNV_PRIME;
+        return hash;
+    }
+
+    static bool readHeader(FILE *f, GraphHeader &header)
+    {
+        return fseek(f, 0, SEEK_SET) == 0 && fread(&header, sizeof(header), 1, f) == 1 &&
+               memcmp(header.magic, GRAPH_MAGIC, 4) == 0 && header.version == RoadGraph::VERSION &&
+               header.headerSize == sizeof(GraphHeader) && header.blockNodes > 0 &&
+               header.blocks == (header.nodes + header.blockNodes - 1) / header.blockNodes;
+    }
+
+    static bool isGraphFile(const char *name)
+    {
+        const size_t len = strlen(name);
+        return len >= 4 && strcmp(name + len - 4, ".rgr") == 0;
+    }
+}
+
+RoadGraph::RoadGraph() : blockLoads(0), blockHits(0), file(nullptr), nodes(0), blockNodes(0), bounds{0, 0, 0, 0},
+                         useCounter(0) {}
+
+RoadGraph::~RoadGraph()
+{
+    close();
+}
+
+/**
+ * @brief Open a graph pack and read its block index
+ *
+ * @param path Pack path
+ * @param maxBlocks Blocks kept in PSRAM (at least 2)
+ * @return true if the pack is valid
+ */
+bool RoadGraph::open(const char *path, size_t maxBlocks)
+{
+    close();
+    file = fopen(path, "rb");
+    if (!file)
+    {
+        ESP_LOGE(TAG, "Can't open %s", path);
+        return false;
+    }
+
+    GraphHeader header;
+    bool ok = readHeader(file, header);
+    if (ok)
+    {
+        index.resize(header.blocks);
+        ok = fseek(file, header.indexOffset, SEEK_SET) == 0 &&
+             fread(index.data(), sizeof(BlockInfo), index.size(), file) == index.size() &&
+             fnv1a((const uint8_t *)index.data(), index.size() * sizeof(BlockInfo)) == header.checksum;
+    }
+    if (!ok)
+    {
+        ESP_LOGE(TAG, "Invalid road graph %s", path);
+        close();
+        return false;
+    }
+
+    nodes = header.nodes;
+    blockNodes = header.blockNodes;
+    bounds[0] = header.minLat;
+    bounds[1] = header.minLon;
+    bounds[2] = header.maxLat;
+    bounds[3] = header.maxLon;
+    blockSlot.assign(index.size(), -1);
+    slots.resize(std::max<size_t>(maxBlocks, 2));
+    for (Slot &slot : slots)
+        slot.block = NO_NODE;
+    ESP_LOGI(TAG, "%s: %u nodes, %u edges, %u blocks", path, (unsigned)header.nodes, (unsigned)header.edges,
+             (unsigned)header.blocks);
+    return true;
+}
+
+/**
+ * @brief Close the pack and free the block cache
+ */
+void RoadGraph::close()
+{
+    if (file)
+        fclose(file);
+    file = nullptr;
+    nodes = 0;
+    index.clear();
+    index.shrink_to_fit();
+    blockSlot.clear();
+    blockSlot.shrink_to_fit();
+    slots.clear();
+    slots.shrink_to_fit();
+    blockLoads = blockHits = 0;
+}
+
+/**
+ * @brief Check if a pack is open
+ */
+bool RoadGraph::isOpen() const
+{
+    return file != nullptr;
+}
+
+/**
+ * @brief Check if a position is inside the pack bounding box
+ */
+bool RoadGraph::contains(float lat, float lon) const
+{
+    const int32_t la = (int32_t)lroundf(lat * 1e7f), lo = (int32_t)lroundf(lon * 1e7f);
+    return isOpen() && la >= bounds[0] && la <= bounds[2] && lo >= bounds[1] && lo <= bounds[3];
+}
+
+/**
+ * @brief Number of nodes
+ */
+uint32_t RoadGraph::nodeCount() const
+{
+    return nodes;
+}
+
+/**
+ * @brief Read a block payload into a cache slot and set its arrays
+ *
+ * @param blockId Block
+ * @param slot Slot to fill
+ * @return true if the payload is consistent
+ */
+bool RoadGraph::loadBlock(uint32_t blockId, Slot &slot)
+{
+    const BlockInfo &info = index[blockId];
+    if (slot.data.capacity() < info.size)
+    {
+        // Exact size, so the cache stays within maxBlocks of the largest block
+        slot.data = {};
+        slot.data.reserve(info.size);
+    }
+    slot.data.resize(info.size);
+    if (info.size < sizeof(BlockHeader) || fseek(file, info.offset, SEEK_SET) != 0 ||
+        fread(slot.data.data(), 1, info.size, file) != info.size)
+        return false;
+
+    BlockHeader header;
+    memcpy(&header, slot.data.data(), sizeof(header));
+    const size_t n = header.nodes;
+    const size_t expected = sizeof(BlockHeader) + n * 8 + (n + 1) * 8 +
+                            ((size_t)header.outEdges + header.inEdges) * sizeof(Edge);
+    if (n == 0 || n > blockNodes || expected != info.size)
+        return false;
+
+    const uint8_t *p = slot.data.data() + sizeof(BlockHeader);
+    slot.nodes = (uint16_t)n;
+    slot.lat = (const int32_t *)p;
+    slot.lon = slot.lat + n;
+    slot.outStart = (const uint32_t *)(slot.lon + n);
+    slot.inStart = slot.outStart + n + 1;
+    slot.outEdges = (const Edge *)(slot.inStart + n + 1);
+    slot.inEdges = slot.outEdges + header.outEdges;
+    if (slot.outStart[0] != 0 || slot.inStart[0] != 0 || slot.outStart[n] != header.outEdges ||
+        slot.inStart[n] != header.inEdges)
+        return false;
+    for (size_t i = 0; i < n; i++)
+    {
+        if (slot.outStart[i] > slot.outStart[i + 1] || slot.inStart[i] > slot.inStart[i + 1])
+            return false;
+    }
+    return true;
+}
+
+/**
+ * @brief Cached block of a node, loaded if needed
+ *
+ * @param node Node
+ * @param local Index of the node in the block
+ * @return Slot, nullptr on a read error
+ */
+RoadGraph::Slot *RoadGraph::block(uint32_t node, uint16_t &local)
+{
+    if (!file || node >= nodes)
+        return nullptr;
+    const uint32_t blockId = node / blockNodes;
+    local = (uint16_t)(node % blockNodes);
+
+    const int16_t cached = blockSlot[blockId];
+    if (cached >= 0)
+    {
+        blockHits++;
+        slots[cached].lastUse = ++useCounter;
+        return &slots[cached];
+    }
+
+    // Free slot or least recently used one
+    size_t victim = 0;
+    for (size_t i = 0; i < slots.size(); i++)
+    {
+        if (slots[i].block == NO_NODE)
+        {
+            victim = i;
+            break;
+        }
+        if (slots[i].lastUse < slots[victim].lastUse)
+            victim = i;
+    }
+    Slot &slot = slots[victim];
+    if (slot.block != NO_NODE)
+        blockSlot[slot.block] = -1;
+    slot.block = NO_NODE;
+
+    if (!loadBlock(blockId, slot))
+    {
+        ESP_LOGE(TAG, "Invalid block %u", (unsigned)blockId);
+        return nullptr;
+    }
+    blockLoads++;
+    slot.block = blockId;
+    slot.lastUse = ++useCounter;
+    blockSlot[blockId] = (int16_t)victim;
+    return &slot;
+}
+
+/**
+ * @brief Coordinates of a node
+ *
+ * @param node Node
+ * @param lat Latitude (1e-7 deg)
+ * @param lon Longitude (1e-7 deg)
+ * @return false if the node can't be read
+ */
+bool RoadGraph::coords(uint32_t node, int32_t &lat, int32_t &lon)
+{
+    uint16_t local;
+    const Slot *slot = block(node, local);
+    if (!slot || local >= slot->nodes)
+        return false;
+    lat = slot->lat[local];
+    lon = slot->lon[local];
+    return true;
+}
+
+/**
+ * @brief Edges of a node, copied out of the block cache
+ *
+ * @param node Node
+ * @param incoming Incoming edges instead of outgoing ones
+ * @param out Edges
+ * @return false if the node can't be read
+ */
+bool RoadGraph::edges(uint32_t node, bool incoming, std::vector<Edge> &out)
+{
+    out.clear();
+    uint16_t local;
+    const Slot *slot = block(node, local);
+    if (!slot || local >= slot->nodes)
+        return false;
+    const uint32_t *start = incoming ? slot->inStart : slot->outStart;
+    const Edge *list = incoming ? slot->inEdges : slot->outEdges;
+    out.assign(list + start[local], list + start[local + 1]);
+    return true;
+}
+
+/**
+ * @brief Nearest node with edges in the given direction
+ *
+ * @details Only the blocks whose bounding box is within maxDist are read.
+ *
+ * @param lat Latitude
+ * @param lon Longitude
+ * @param maxDist Search radius (m)
+ * @param incoming Look for a node with incoming edges (route end) instead of outgoing ones
+ * @return Node, NO_NODE if there is none within maxDist
+ */
+uint32_t RoadGraph::nearestNode(float lat, float lon, float maxDist, bool incoming)
+{
+    const float cosLat = cosf(lat * (float)M_PI / 180.0f);
+    const int32_t la = (int32_t)lroundf(lat * 1e7f), lo = (int32_t)lroundf(lon * 1e7f);
+    const int32_t marginLat = (int32_t)(maxDist / METERS_PER_DEG * 1e7f);
+    const int32_t marginLon = (int32_t)(maxDist / (METERS_PER_DEG * std::max(cosLat, 0.01f)) * 1e7f);
+    const float scaleLat = METERS_PER_DEG * 1e-7f, scaleLon = scaleLat * cosLat;
+
+    uint32_t best = NO_NODE;
+    float bestDist2 = maxDist * maxDist;
+    for (uint32_t b = 0; b < index.size(); b++)
+    {
+        const BlockInfo &info = index[b];
+        if (la < info.minLat - marginLat || la > info.maxLat + marginLat ||
+            lo < info.minLon - marginLon || lo > info.maxLon + marginLon)
+            continue;
+
+        uint16_t local;
+        const Slot *slot = block(b * blockNodes, local);
+        if (!slot)
+            continue;
+        const uint32_t *start = incoming ? slot->inStart : slot->outStart;
+        for (uint16_t i = 0; i < slot->nodes; i++)
+        {
+            if (start[i] == start[i + 1])
+                continue;
+            const float dy = (slot->lat[i] - la) * scaleLat;
+            const float dx = (slot->lon[i] - lo) * scaleLon;
+            const float d2 = dx * dx + dy * dy;
+            if (d2 < bestDist2)
+            {
+                bestDist2 = d2;
+                best = b * blockNodes + i;
+            }
+        }
+    }
+    return best;
+}
+
+/**
+ * @brief Find the pack of a folder that covers a position
+ *
+ * @details When several packs cover it, the one with the smallest bounding box wins.
+ *
+ * @param folder Folder of the packs
+ * @param lat Latitude
+ * @param lon Longitude
+ * @param path Path of the pack found
+ * @return true if a pack covers the position
+ */
+bool RoadGraph::findRegion(const char *folder, float lat, float lon, std::string &path)
+{
+    DIR *dir = opendir(folder);
+    if (!dir)
+        return false;
+
+    const int32_t la = (int32_t)lroundf(lat * 1e7f), lo = (int32_t)lroundf(lon * 1e7f);
+    double bestArea = -1.0;
+    struct dirent *entry;
+    while ((entry = readdir(dir)) != nullptr)
+    {
+        if (!isGraphFile(entry->d_name))
+            continue;
+        const std::string candidate = std::string(folder) + "/" + entry->d_name;
+        FILE *f = fopen(candidate.c_str(), "rb");
+        if (!f)
+            continue;
+        GraphHeader header;
+        if (readHeader(f, header) && la >= header.minLat && la <= header.maxLat && lo >= header.minLon &&
+            lo <= header.maxLon)
+        {
+            const double area = (double)(header.maxLat - header.minLat) * (double)(header.maxLon - header.minLon);
+            if (bestArea < 0.0 || area < bestArea)
+            {
+                bestArea = area;
+                path = candidate;
+            }
+        }
+        fclose(f);
+    }
+    closedir(dir);
+    return bestArea >= 0.0;
+}
+
+/**
+ * @brief PSRAM used by the cached blocks
+ */
+size_t RoadGraph::cacheBytes() const
+{
+    size_t bytes = 0;
+    for (const Slot &slot : slots)
+        bytes += slot.data.capacity();
+    return bytes;
+}
@@ -0,0 +1,119 @@
+/**
+ * @file roadGraph.hpp
+ * @author Jordi Gauchía (jgauchia@jgauchia.com)
+ * @brief  Road graph pack - block cached reader of a region road network on SD
+ * @version 0.2.5
+ * @date 2026-04
+ *
+ * Platform independent, also built by tools/road_graph.
+ *
+ * Each region is one file (/sdcard/ROUTE/<region>.rgr) written by tools/road_graph. Nodes
+ * are sorted along a Hilbert curve and stored in blocks of up to blockNodes nodes, so the
+ * nodes of a block are close to each other. A block holds the coordinates of its nodes and
+ * their outgoing and incoming edges (adjacency arrays), and is read from SD with one read
+ * when a node in it is first needed. At most maxBlocks blocks stay in PSRAM, the least
+ * recently used is dropped.
+ *
+ * Pack layout (little-endian):
+ *  - Header (48 bytes): magic "RGR1", version (u16), header size (u16), nodes (u32),
+ *    edges (u32), blocks (u32), block nodes (u16), reserved (u16), min/max lat/lon (i32,
+ *    1e-7 deg), block index offset (u32), FNV-1a of the block index (u32)
+ *  - Block index: per block payload offset and size (u32), min/max lat/lon (i32)
+ *  - Block payload: nodes (u16), reserved (u16), outgoing and incoming edge counts (u32),
+ *    lat[nodes] and lon[nodes] (i32), out and in edge starts[nodes + 1] (u32), outgoing
+ *    edges then incoming edges, each other node (u32) and cost (u32, decimeters)
+ *
+ * Edge costs are the edge length weighted by the road class, never under the length, so
+ * the straight line distance is a lower bound for the router.
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <vector>
+#include "PsramAllocator.hpp"
+
+/**
+ * @class RoadGraph
+ * @brief Road network of a region, read in blocks from a graph pack
+ */
+class RoadGraph
+{
+public:
+    static constexpr uint16_t VERSION = 1;                      /**< Pack layout version */
+    static constexpr const char *ROUTE_FOLDER = "/sdcard/ROUTE"; /**< Folder of the region packs */
+    static constexpr uint32_t NO_NODE = 0xFFFFFFFF;             /**< Invalid node id */
+    static constexpr size_t DEFAULT_BLOCKS = 48;                /**< Default cached blocks */
+
+    /**
+     * @brief Edge of the adjacency arrays
+     */
+    struct Edge
+    {
+        uint32_t node;      /**< Target node (outgoing) or source node (incoming) */
+        uint32_t cost;      /**< Weighted length (dm) */
+    };
+
+    RoadGraph();
+    ~RoadGraph();
+
+    bool open(const char *path, size_t maxBlocks = DEFAULT_BLOCKS);
+    void close();
+    bool isOpen() const;
+    bool contains(float lat, float lon) const;
+
+    uint32_t nodeCount() const;
+    bool coords(uint32_t node, int32_t &lat, int32_t &lon);
+    bool edges(uint32_t node, bool incoming, std::vector<Edge> &out);
+    uint32_t nearestNode(float lat, float lon, float maxDist, bool incoming);
+
+    static bool findRegion(const char *folder, float lat, float lon, std::string &path);
+
+    size_t cacheBytes() const;
+
+    uint32_t blockLoads;    /**< Blocks read from the file since open */
+    uint32_t blockHits;     /**< Node lookups served by a cached block */
+
+private:
+    /**
+     * @brief Block index entry
+     */
+    struct BlockInfo
+    {
+        uint32_t offset;            /**< Payload offset in the file */
+        uint32_t size;              /**< Payload size */
+        int32_t minLat, minLon;     /**< Bounding box (1e-7 deg) */
+        int32_t maxLat, maxLon;     /**< Bounding box (1e-7 deg) */
+    };
+
+    /**
+     * @brief Cached block, arrays point into data
+     */
+    struct Slot
+    {
+        uint32_t block;                                 /**< Cached block, NO_NODE if free */
+        uint32_t lastUse;                               /**< Use counter for LRU */
+        std::vector<uint8_t, PsramAllocator<uint8_t>> data;   /**< Block payload */
+        uint16_t nodes;                                 /**< Nodes in the block */
+        const int32_t *lat;                             /**< Node latitudes */
+        const int32_t *lon;                             /**< Node longitudes */
+        const uint32_t *outStart;                       /**< Outgoing edge starts, nodes + 1 */
+        const uint32_t *inStart;                        /**< Incoming edge starts, nodes + 1 */
+        const Edge *outEdges;                           /**< Outgoing edges */
+        const Edge *inEdges;                            /**< Incoming edges */
+    };
+
+    FILE *file;                                         /**< Open pack */
+    uint32_t nodes;                                     /**< Nodes */
+    uint16_t blockNodes;                                /**< Nodes per block */
+    int32_t bounds[4];                                  /**< min lat, min lon, max lat, max lon */
+    std::vector<BlockInfo> index;                       /**< Block index */
+    std::vector<int16_t> blockSlot;                     /**< Slot of each cached block, -1 if not cached */
+    std::vector<Slot> slots;                            /**< Block cache */
+    uint32_t useCounter;                                /**< LRU clock */
+
+    Slot *block(uint32_t node, uint16_t &local);
+    bool loadBlock(uint32_t blockId, Slot &slot);
+};
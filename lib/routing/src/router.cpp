@@ -0,0 +1,310 @@
+/**
+ * @file router.cpp
+ * @author Jordi Gauchía (jgauchia@jgauchia.com)
+ * @brief  Bidirectional A* over a road graph pack
+ * @version 0.2.5
+ * @date 2026-04
+ */
+
+#include "router.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include "gpsMath.hpp"
+#include "turnScan.hpp"
+#include "esp_log.h"
+
+static const char* TAG = "Router";
+
+/**
+ * @brief Meters per degree of latitude
+ */
+static constexpr float METERS_PER_DEG = 111319.49f;
+
+/**
+ * @brief Share of the straight line distance used as lower bound, covers the local plane error
+ */
+static constexpr float BOUND_FACTOR = 0.99f;
+
+/**
+ * @brief Queue entries allowed per working set node (a node can be queued more than once)
+ */
+static constexpr size_t QUEUE_FACTOR = 4;
+
+/**
+ * @brief Min-heap order of the queues
+ */
+struct QueueOrder
+{
+    template <class T> bool operator()(const T &a, const T &b) const { return a.key > b.key; }
+};
+
+Router::Router() : settled(0), reached(0), cost(0), tableMask(0), maxNodes(0), sLat(0), sLon(0), tLat(0), tLon(0),
+                   kLat(0.0f), kLon(0.0f) {}
+
+/**
+ * @brief Free the working set
+ */
+void Router::release()
+{
+    states.clear();
+    states.shrink_to_fit();
+    table.clear();
+    table.shrink_to_fit();
+    for (auto &q : queue)
+    {
+        q.clear();
+        q.shrink_to_fit();
+    }
+    edgeBuf.clear();
+    edgeBuf.shrink_to_fit();
+    tableMask = 0;
+}
+
+/**
+ * @brief PSRAM held by the working set
+ */
+size_t Router::workingBytes() const
+{
+    return states.capacity() * sizeof(NodeState) + table.capacity() * sizeof(uint32_t) +
+           (queue[0].capacity() + queue[1].capacity()) * sizeof(QueueItem);
+}
+
+/**
+ * @brief Forward potential of a position, (πt - πs) / 2
+ *
+ * @param lat Latitude (1e-7 deg)
+ * @param lon Longitude (1e-7 deg)
+ * @return Potential (dm)
+ */
+int32_t Router::potential(int32_t lat, int32_t lon) const
+{
+    const float ty = (float)(lat - tLat) * kLat, tx = (float)(lon - tLon) * kLon;
+    const float sy = (float)(lat - sLat) * kLat, sx = (float)(lon - sLon) * kLon;
+    return (int32_t)lroundf((sqrtf(ty * ty + tx * tx) - sqrtf(sy * sy + sx * sx)) * 0.5f);
+}
+
+/**
+ * @brief Slot of a node, added to the working set when first reached
+ *
+ * @param graph Road graph
+ * @param node Node
+ * @param full Set when the working set limit is reached
+ * @return Slot, NONE if the node can't be added
+ */
+uint32_t Router::slotOf(RoadGraph &graph, uint32_t node, bool &full)
+{
+    full = false;
+    uint32_t h = (node * 0x9E3779B1u) & tableMask;
+    while (table[h] != NONE)
+    {
+        if (states[table[h]].node == node)
+            return table[h];
+        h = (h + 1) & tableMask;
+    }
+
+    if (states.size() >= maxNodes)
+    {
+        full = true;
+        return NONE;
+    }
+    int32_t lat, lon;
+    if (!graph.coords(node, lat, lon))
+        return NONE;
+
+    const uint32_t slot = (uint32_t)states.size();
+    states.push_back({node, {NONE, NONE}, {NONE, NONE}, potential(lat, lon)});
+    table[h] = slot;
+    reached++;
+    return slot;
+}
+
+/**
+ * @brief Queue a node on one side
+ */
+void Router::push(int side, int32_t key, uint32_t slot)
+{
+    queue[side].push_back({key, slot});
+    std::push_heap(queue[side].begin(), queue[side].end(), QueueOrder());
+}
+
+/**
+ * @brief Shortest route between two positions
+ *
+ * @details The positions are snapped to the nearest nodes with outgoing (start) and
+ *          incoming (end) edges. The track starts and ends at the given positions,
+ *          with points every pointSpacing meters at most, and its turns are detected
+ *          with the GPX track thresholds.
+ *
+ * @param graph Open road graph
+ * @param fromLat Start latitude
+ * @param fromLon Start longitude
+ * @param toLat End latitude
+ * @param toLon End longitude
+ * @param params Query limits
+ * @param track Route track, cleared if there is no route
+ * @param turns Route turns
+ * @return Query result
+ */
+RouteStatus Router::route(RoadGraph &graph, float fromLat, float fromLon, float toLat, float toLon,
+                          const RouteParams &params, TrackVector &track, std::vector<TurnPoint> &turns)
+{
+    settled = reached = cost = 0;
+    track.clear();
+    turns.clear();
+    if (!graph.isOpen())
+        return ROUTE_NO_GRAPH;
+
+    const uint32_t start = graph.nearestNode(fromLat, fromLon, params.snapDist, false);
+    if (start == RoadGraph::NO_NODE)
+        return ROUTE_NO_START;
+    const uint32_t end = graph.nearestNode(toLat, toLon, params.snapDist, true);
+    if (end == RoadGraph::NO_NODE)
+        return ROUTE_NO_END;
+    if (!graph.coords(start, sLat, sLon) || !graph.coords(end, tLat, tLon))
+        return ROUTE_NO_GRAPH;
+
+    // Lower bound scale, longitude degrees measured at the highest latitude of the route area
+    const float maxLat = std::min(std::max(std::abs(sLat), std::abs(tLat)) * 1e-7f + 0.5f, 89.0f);
+    kLat = BOUND_FACTOR * METERS_PER_DEG * 1e-6f;
+    kLon = kLat * cosf(DEG2RAD(maxLat));
+
+    // Working set, the hash table is kept between queries of the same size
+    maxNodes = std::max<uint32_t>(params.maxNodes, 2);
+    uint32_t tableSize = 1;
+    while (tableSize < maxNodes * 2)
+        tableSize <<= 1;
+    table.assign(tableSize, NONE);
+    tableMask = tableSize - 1;
+    states.clear();
+    states.reserve(maxNodes);
+    queue[0].clear();
+    queue[1].clear();
+
+    bool full;
+    const uint32_t s = slotOf(graph, start, full);
+    const uint32_t t = slotOf(graph, end, full);
+    if (s == NONE || t == NONE)
+        return ROUTE_NO_GRAPH;
+    states[s].dist[0] = 0;
+    push(0, states[s].pot, s);
+    states[t].dist[1] = 0;
+    push(1, -states[t].pot, t);
+
+    int64_t best = s == t ? 0 : INT64_MAX;
+    uint32_t meet = s == t ? s : NONE;
+    const size_t maxQueued = (size_t)maxNodes * QUEUE_FACTOR;
+
+    while (!queue[0].empty() && !queue[1].empty())
+    {
+        if ((int64_t)queue[0].front().key + queue[1].front().key >= best)
+            break;
+        if (queue[0].size() + queue[1].size() > maxQueued)
+            return ROUTE_LIMIT;
+
+        const int side = queue[0].size() <= queue[1].size() ? 0 : 1;
+        const int other = 1 - side;
+        auto &q = queue[side];
+        std::pop_heap(q.begin(), q.end(), QueueOrder());
+        const QueueItem item = q.back();
+        q.pop_back();
+
+        const uint32_t dist = states[item.slot].dist[side];
+        const int32_t pot = side == 0 ? states[item.slot].pot : -states[item.slot].pot;
+        if (item.key != (int32_t)dist + pot)
+            continue;
+        settled++;
+
+        if (!graph.edges(states[item.slot].node, side == 1, edgeBuf))
+            return ROUTE_NO_GRAPH;
+        for (const RoadGraph::Edge &edge : edgeBuf)
+        {
+            const uint32_t w = slotOf(graph, edge.node, full);
+            if (w == NONE)
+            {
+                ESP_LOGW(TAG, "Search stopped after %u nodes", (unsigned)reached);
+                return full ? ROUTE_LIMIT : ROUTE_NO_GRAPH;
+            }
+
+            NodeState &next = states[w];
+            const uint32_t newDist = dist + edge.cost;
+            if (newDist >= next.dist[side])
+                continue;
+            next.dist[side] = newDist;
+            next.parent[side] = item.slot;
+            push(side, (int32_t)newDist + (side == 0 ? next.pot : -next.pot), w);
+            if (next.dist[other] != NONE && (int64_t)newDist + next.dist[other] < best)
+            {
+                best = (int64_t)newDist + next.dist[other];
+                meet = w;
+            }
+        }
+    }
+
+    if (meet == NONE)
+        return ROUTE_NOT_FOUND;
+
+    cost = (uint32_t)best;
+    buildTrack(graph, meet, fromLat, fromLon, toLat, toLon, params.pointSpacing, track);
+    turns = TurnScan::detect(track, {18.0f, 10, 70.0f, 5});
+    ESP_LOGI(TAG, "Route %.0f m, %u points, %u turns, %u nodes settled", cost / 10.0f, (unsigned)track.size(),
+             (unsigned)turns.size(), (unsigned)settled);
+    return ROUTE_OK;
+}
+
+/**
+ * @brief Route track through the meeting node of both searches
+ *
+ * @param graph Road graph
+ * @param meet Meeting node slot
+ * @param fromLat Start latitude
+ * @param fromLon Start longitude
+ * @param toLat End latitude
+ * @param toLon End longitude
+ * @param spacing Max distance between points (m)
+ * @param track Route track
+ */
+void Router::buildTrack(RoadGraph &graph, uint32_t meet, float fromLat, float fromLon, float toLat, float toLon,
+                        float spacing, TrackVector &track)
+{
+    std::vector<uint32_t> path;
+    for (uint32_t slot = meet; slot != NONE; slot = states[slot].parent[0])
+        path.push_back(states[slot].node);
+    std::reverse(path.begin(), path.end());
+    for (uint32_t slot = states[meet].parent[1]; slot != NONE; slot = states[slot].parent[1])
+        path.push_back(states[slot].node);
+
+    std::vector<float> lat, lon;
+    lat.push_back(fromLat);
+    lon.push_back(fromLon);
+    for (uint32_t node : path)
+    {
+        int32_t la, lo;
+        if (graph.coords(node, la, lo))
+        {
+            lat.push_back(la * 1e-7f);
+            lon.push_back(lo * 1e-7f);
+        }
+    }
+    lat.push_back(toLat);
+    lon.push_back(toLon);
+
+    track.reserve(lat.size() * 2);
+    track.push_back(lat[0], lon[0], 0.0f);
+    float total = 0.0f;
+    for (size_t i = 1; i < lat.size(); i++)
+    {
+        const float prevLat = track.lat[track.size() - 1], prevLon = track.lon[track.size() - 1];
+        const float d = calcDistUncached(prevLat, prevLon, lat[i], lon[i]);
+        if (d < 0.5f)
+            continue;
+        const int steps = (int)ceilf(d / spacing);
+        for (int k = 1; k <= steps; k++)
+        {
+            const float f = (float)k / steps;
+            track.push_back(prevLat + (lat[i] - prevLat) * f, prevLon + (lon[i] - prevLon) * f, 0.0f);
+            track.accumDist[track.size() - 1] = total + d * f;
+        }
+        total += d;
+    }
+}
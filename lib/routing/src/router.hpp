@@ -0,0 +1,108 @@
+/**
+ * @file router.hpp
+ * @author Jordi Gauchía (jgauchia@jgauchia.com)
+ * @brief  Bidirectional A* over a road graph pack
+ * @version 0.2.5
+ * @date 2026-04
+ *
+ * Platform independent, also built by tools/road_graph.
+ *
+ * Both searches use the average potential pF = (πt - πs) / 2, where πs and πt are lower
+ * bounds of the distance from the start and to the end (straight line in a local plane
+ * with some margin). With the same potential on both sides the two searches can stop as
+ * soon as the sum of their smallest keys reaches the best meeting cost, and the route is
+ * still the shortest one. The side with the smaller queue is expanded first.
+ *
+ * The working set (node states, hash and queues) is in PSRAM and bounded by maxNodes,
+ * a search that needs more nodes stops with ROUTE_LIMIT. The road graph reads its blocks
+ * from SD as the search reaches them.
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <vector>
+#include "globalGpxDef.h"
+#include "roadGraph.hpp"
+
+/**
+ * @brief Route query limits
+ */
+struct RouteParams
+{
+    uint32_t maxNodes = 40000;  /**< Max nodes reached by the search (working set bound) */
+    float snapDist = 500.0f;    /**< Max distance (m) from the start and end to the road graph */
+    float pointSpacing = 20.0f; /**< Max distance (m) between route track points */
+};
+
+/**
+ * @brief Route query result
+ */
+enum RouteStatus : uint8_t
+{
+    ROUTE_OK,           /**< Route found */
+    ROUTE_NO_GRAPH,     /**< No open pack or read error */
+    ROUTE_NO_START,     /**< No road near the start */
+    ROUTE_NO_END,       /**< No road near the end */
+    ROUTE_NOT_FOUND,    /**< End not reachable from the start */
+    ROUTE_LIMIT         /**< Working set limit reached */
+};
+
+/**
+ * @class Router
+ * @brief Shortest route between two positions, as a track with its turns
+ */
+class Router
+{
+public:
+    Router();
+
+    RouteStatus route(RoadGraph &graph, float fromLat, float fromLon, float toLat, float toLon,
+                      const RouteParams &params, TrackVector &track, std::vector<TurnPoint> &turns);
+    void release();
+    size_t workingBytes() const;
+
+    uint32_t settled;   /**< Nodes settled by the last query */
+    uint32_t reached;   /**< Nodes reached by the last query */
+    uint32_t cost;      /**< Cost of the last route (dm) */
+
+private:
+    static constexpr uint32_t NONE = 0xFFFFFFFF;    /**< No slot / infinite distance */
+
+    /**
+     * @brief Search state of a reached node
+     */
+    struct NodeState
+    {
+        uint32_t node;      /**< Graph node */
+        uint32_t dist[2];   /**< Forward and reverse distance (dm), NONE if not reached */
+        uint32_t parent[2]; /**< Forward and reverse parent slot */
+        int32_t pot;        /**< Forward potential pF (dm), the reverse one is -pF */
+    };
+
+    /**
+     * @brief Queue entry, stale when key is no longer the node key
+     */
+    struct QueueItem
+    {
+        int32_t key;        /**< dist + potential */
+        uint32_t slot;      /**< Node state */
+    };
+
+    template <class T> using PsramVector = std::vector<T, PsramAllocator<T>>;
+
+    PsramVector<NodeState> states;          /**< Reached nodes */
+    PsramVector<uint32_t> table;            /**< Open addressing hash, node to slot */
+    PsramVector<QueueItem> queue[2];        /**< Forward and reverse queues (min heaps) */
+    std::vector<RoadGraph::Edge> edgeBuf;   /**< Edges of the node being expanded */
+    uint32_t tableMask;                     /**< Hash table size - 1 */
+    uint32_t maxNodes;                      /**< Working set limit */
+    int32_t sLat, sLon, tLat, tLon;         /**< Start and end nodes (1e-7 deg) */
+    float kLat, kLon;                       /**< dm per 1e-7 deg, lower bound scale */
+
+    uint32_t slotOf(RoadGraph &graph, uint32_t node, bool &full);
+    int32_t potential(int32_t lat, int32_t lon) const;
+    void push(int side, int32_t key, uint32_t slot);
+    void buildTrack(RoadGraph &graph, uint32_t meet, float fromLat, float fromLon, float toLat, float toLon,
+                    float spacing, TrackVector &track);
+};
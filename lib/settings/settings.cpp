@@ -29,6 +29,21 @@ uint8_t zoom = 0;            /**< Current Zoom Level */
     static const float scale = 0.75f;  /**< Scale factor for small screens */
 #endif
 
+/**
+ * @brief Vector map performance profile preset
+ *
+ * @details Defaults used when the performance profile is enabled and the user has not set
+ *          the key. ILI9341 SPI boards (CYD) start with the profile enabled.
+ */
+#if defined(ILI9341_NOTOUCH_SPI) || defined(ILI9341_XPT2046_SPI)
+    static const bool perfProfileDefault = true;     /**< Performance profile enabled by default */
+#else
+    static const bool perfProfileDefault = false;    /**< Performance profile disabled by default */
+#endif
+static const uint8_t  perfVisibleGeoms  = 0x1C;      /**< Lines, polygons and text, no POI points */
+static const uint16_t perfVisibleLayers = 0xFFFC;    /**< All layers but the background layers 0-1 */
+static const uint16_t perfRenderBudget  = 120;       /**< Frame budget in ms */
+
 /**
  * @brief Global variables definition for device preferences & config.
  */
@@ -78,7 +93,10 @@ void loadPreferences()
     mapSet.showMapSpeed = cfg.getBool(PKEYS::KMAP_SPEED, true);
     mapSet.vectorMap = cfg.getBool(PKEYS::KMAP_VECTOR, false);
     mapSet.showMapScale = cfg.getBool(PKEYS::KMAP_SCALE, true);
+    mapSet.showWaypoints = cfg.getBool(PKEYS::KMAP_WPTS, true);
+    loadMapProfile();
     navSet.simNavigation = cfg.getBool(PKEYS::KSIM_NAV, false);
+    navSet.simplifyTolerance = cfg.getFloat(PKEYS::KNAV_SIMPL, 2.0f);
     gpsBaud = cfg.getShort(PKEYS::KGPS_SPEED, 4);
     gpsUpdate = cfg.getShort(PKEYS::KGPS_RATE, 3);
     compassPosX = cfg.getInt(PKEYS::KCOMP_X, (TFT_WIDTH / 2) - (100 * scale));
@@ -119,6 +137,20 @@ void loadPreferences()
     printSettings();
 }
 
+/**
+ * @brief Load vector map rendering preferences
+ *
+ * @details Loads the performance profile and the feature visibility masks. Keys that are not
+ *          set take the profile preset, so the profile can be fine tuned with kset.
+ */
+void loadMapProfile()
+{
+    mapSet.perfProfile = cfg.getBool(PKEYS::KMAP_PERF, perfProfileDefault);
+    mapSet.visibleGeoms = cfg.getUInt(PKEYS::KMAP_GEOMS, mapSet.perfProfile ? perfVisibleGeoms : 0xFF);
+    mapSet.visibleLayers = cfg.getUInt(PKEYS::KMAP_LAYERS, mapSet.perfProfile ? perfVisibleLayers : 0xFFFF);
+    mapSet.renderBudget = cfg.getUInt(PKEYS::KMAP_BUDGET, mapSet.perfProfile ? perfRenderBudget : 0);
+}
+
 /**
  * @brief Save GPS baud rate setting
  *
@@ -148,6 +180,7 @@ void saveGPSBaud(uint16_t gpsBaud)
         vTaskDelay(pdMS_TO_TICKS(500));
         gpsPort.setRxBufferSize(1024);
         gpsPort.begin(GPS_BAUD[gpsBaud], SERIAL_8N1, GPS_RX, GPS_TX);
+        gps.startIngest();
         vTaskDelay(pdMS_TO_TICKS(500));
     }
     else
@@ -161,6 +194,7 @@ void saveGPSBaud(uint16_t gpsBaud)
             vTaskDelay(pdMS_TO_TICKS(500));
             gpsPort.setRxBufferSize(1024);
             gpsPort.begin(gpsBaudDetected, SERIAL_8N1, GPS_RX, GPS_TX);
+            gps.startIngest();
             vTaskDelay(pdMS_TO_TICKS(500));
         }
   }
@@ -71,6 +71,11 @@ struct MAP
     bool showMapSpeed;      /**< Show speed in map screen */
     bool vectorMap;         /**< Map type: true for vector, false for rendered */
     bool showMapScale;      /**< Show map scale on screen */
+    bool showWaypoints;     /**< Show the user waypoints on the map */
+    uint16_t renderBudget;  /**< Vector frame budget in ms before low-priority layers are deferred (0 = off) */
+    bool perfProfile;       /**< Performance profile preset for slow boards */
+    uint8_t visibleGeoms;   /**< Visible vector geometry types, bit n = NavGeomType n */
+    uint16_t visibleLayers; /**< Visible vector priority layers, bit n = layer n */
 };
 extern MAP mapSet; /**< Global instance for map settings */
 
@@ -82,10 +87,12 @@ extern MAP mapSet; /**< Global instance for map settings */
 struct NAVIGATION 
 {
     bool simNavigation;     /**< Indicates whether navigation simulation mode is enabled or disabled. */
+    float simplifyTolerance; /**< Track simplification tolerance in meters for navigation and drawing (0 = off) */
 };
 extern NAVIGATION navSet; /**< Global instance for navigation settings */
 
 void loadPreferences();
+void loadMapProfile();
 
 void saveGPSBaud(uint16_t gpsBaud);
 void saveGPSUpdateRate(uint16_t gpsUpdateRate);
@@ -0,0 +1,253 @@
+/**
+ * @file readPipeline.cpp
+ * @author Jordi Gauchía (jgauchia@jgauchia.com)
+ * @brief  Bounce buffer engine for file reads into non DMA-capable (PSRAM) memory
+ * @version 0.2.5
+ * @date 2026-04
+ */
+
+#include "readPipeline.hpp"
+#include "esp_heap_caps.h"
+#include "esp_log.h"
+#include <cstring>
+
+static const char *TAG = "ReadPipeline";
+
+/**
+ * @brief ReadPipeline constructor
+ *
+ * @param readFn Card read, fread() by default
+ * @param copyFn Bounce buffer to destination copy, memcpy() by default
+ */
+ReadPipeline::ReadPipeline(ReadFn readFn, CopyFn copyFn) : buffers{}, bufferFree{}, busy(nullptr), copyExit(nullptr),
+                                                           copyQueue(nullptr), bufSize(0), bufCount(0), readFn(readFn),
+                                                           copyFn(copyFn)
+{
+}
+
+/**
+ * @brief Allocate the bounce buffers and start the copy task
+ *
+ * @details If the buffers for the pipelined reads can't be allocated, everything allocated
+ *          so far is freed and a single bounce buffer is tried instead.
+ *
+ * @param size Size of each bounce buffer
+ * @param count Bounce buffers, 1 for serial reads (up to MAX_BUFFERS)
+ * @return true if at least one bounce buffer is available
+ */
+bool ReadPipeline::init(size_t size, uint8_t count)
+{
+    if (bufCount != 0)
+        return true;
+
+    if (count > MAX_BUFFERS)
+        count = MAX_BUFFERS;
+
+    if (count > 1)
+    {
+        if (allocate(size, count))
+            return true;
+        release();
+        ESP_LOGE(TAG, "Not enough DMA memory for %u read buffers, using one", count);
+    }
+
+    if (allocate(size, 1))
+        return true;
+    release();
+    ESP_LOGE(TAG, "Not enough DMA memory for a read buffer, PSRAM reads go straight to the card");
+    return false;
+}
+
+/**
+ * @brief Allocate the buffers and, for more than one buffer, the copy task
+ *
+ * @param size Size of each bounce buffer
+ * @param count Bounce buffers
+ * @return true on success, false leaves a partial allocation for release()
+ */
+bool ReadPipeline::allocate(size_t size, uint8_t count)
+{
+    busy = xSemaphoreCreateMutex();
+    if (!busy)
+        return false;
+
+    for (uint8_t i = 0; i < count; i++)
+    {
+        buffers[i] = (uint8_t *)heap_caps_aligned_alloc(64, size, MALLOC_CAP_DMA | MALLOC_CAP_INTERNAL);
+        bufferFree[i] = xSemaphoreCreateBinary();
+        if (!buffers[i] || !bufferFree[i])
+            return false;
+        xSemaphoreGive(bufferFree[i]);
+    }
+
+    if (count > 1)
+    {
+        copyQueue = xQueueCreate(count, sizeof(CopyJob));
+        copyExit = xSemaphoreCreateBinary();
+        if (!copyQueue || !copyExit)
+            return false;
+        if (xTaskCreatePinnedToCore(copyTask, "StorageCopy", 2048, this, 3, NULL, tskNO_AFFINITY) != pdPASS)
+            return false;
+    }
+
+    bufSize = size;
+    bufCount = count;
+    return true;
+}
+
+/**
+ * @brief Free the buffers and the synchronization objects (the copy task must not run)
+ */
+void ReadPipeline::release()
+{
+    for (uint8_t i = 0; i < MAX_BUFFERS; i++)
+    {
+        if (buffers[i])
+            heap_caps_free(buffers[i]);
+        if (bufferFree[i])
+            vSemaphoreDelete(bufferFree[i]);
+        buffers[i] = nullptr;
+        bufferFree[i] = nullptr;
+    }
+    if (copyQueue)
+        vQueueDelete(copyQueue);
+    if (copyExit)
+        vSemaphoreDelete(copyExit);
+    if (busy)
+        vSemaphoreDelete(busy);
+    copyQueue = nullptr;
+    copyExit = nullptr;
+    busy = nullptr;
+    bufSize = 0;
+    bufCount = 0;
+}
+
+/**
+ * @brief Stop the copy task and free the bounce buffers. No read may be in progress.
+ */
+void ReadPipeline::deinit()
+{
+    if (bufCount == 0)
+        return;
+
+    if (bufCount > 1)
+    {
+        const CopyJob stop = {nullptr, nullptr, 0, nullptr};
+        xQueueSend(copyQueue, &stop, portMAX_DELAY);
+        xSemaphoreTake(copyExit, portMAX_DELAY);
+    }
+    release();
+}
+
+/**
+ * @brief Number of bounce buffers, 0 if none could be allocated
+ */
+uint8_t ReadPipeline::bufferCount() const
+{
+    return bufCount;
+}
+
+/**
+ * @brief Task copying filled bounce buffers to their PSRAM destination
+ */
+void ReadPipeline::copyTask(void *pvParameters)
+{
+    ReadPipeline *instance = (ReadPipeline *)pvParameters;
+    CopyJob job;
+
+    while (1)
+    {
+        if (xQueueReceive(instance->copyQueue, &job, portMAX_DELAY) != pdTRUE)
+            continue;
+
+        if (!job.dst)
+        {
+            xSemaphoreGive(instance->copyExit);
+            vTaskDelete(NULL);
+        }
+
+        instance->copyFn(job.dst, job.src, job.len);
+        xSemaphoreGive(job.done);
+    }
+}
+
+/**
+ * @brief Read from a file into a non DMA-capable buffer
+ *
+ * @details Reads through the bounce buffers, pipelined when there are several of them and
+ *          the read spans more than one buffer. Without buffers, or if another read keeps
+ *          them busy for a second, the file is read straight into the destination (the
+ *          card driver then bounces each sector itself, slower but never failing).
+ *
+ * @param file   FILE* pointer to the open file.
+ * @param buffer Pointer to the destination buffer.
+ * @param size   Number of bytes to read.
+ * @return size_t Number of bytes successfully read.
+ */
+size_t ReadPipeline::read(FILE *file, uint8_t *buffer, size_t size)
+{
+    if (bufCount == 0 || xSemaphoreTake(busy, pdMS_TO_TICKS(1000)) != pdTRUE)
+        return readFn(buffer, 1, size, file);
+
+    const size_t totalRead = (bufCount > 1 && size > bufSize) ? readPipelined(file, buffer, size)
+                                                              : readSerial(file, buffer, size);
+    xSemaphoreGive(busy);
+    return totalRead;
+}
+
+/**
+ * @brief Read and copy back to back through the first bounce buffer
+ */
+size_t ReadPipeline::readSerial(FILE *file, uint8_t *buffer, size_t size)
+{
+    size_t totalRead = 0;
+    while (totalRead < size)
+    {
+        const size_t toRead = (size - totalRead > bufSize) ? bufSize : (size - totalRead);
+        const size_t r = readFn(buffers[0], 1, toRead, file);
+        copyFn(buffer + totalRead, buffers[0], r);
+        totalRead += r;
+        if (r < toRead)
+            break;
+    }
+    return totalRead;
+}
+
+/**
+ * @brief Pipelined read: cycles through the bounce buffers, while the copy task moves one
+ *        filled buffer to PSRAM the next chunk is read into another one. A buffer is reused
+ *        only after its copy has finished.
+ */
+size_t ReadPipeline::readPipelined(FILE *file, uint8_t *buffer, size_t size)
+{
+    size_t totalRead = 0;
+    uint8_t current = 0;
+    while (totalRead < size)
+    {
+        xSemaphoreTake(bufferFree[current], portMAX_DELAY);
+
+        const size_t toRead = (size - totalRead > bufSize) ? bufSize : (size - totalRead);
+        const size_t r = readFn(buffers[current], 1, toRead, file);
+        if (r == 0)
+        {
+            xSemaphoreGive(bufferFree[current]);
+            break;
+        }
+
+        const CopyJob job = {buffer + totalRead, buffers[current], r, bufferFree[current]};
+        xQueueSend(copyQueue, &job, portMAX_DELAY);
+        totalRead += r;
+        current = (current + 1) % bufCount;
+
+        if (r < toRead)
+            break;
+    }
+
+    // Wait for the copies still in flight
+    for (uint8_t i = 0; i < bufCount; i++)
+    {
+        xSemaphoreTake(bufferFree[i], portMAX_DELAY);
+        xSemaphoreGive(bufferFree[i]);
+    }
+    return totalRead;
+}
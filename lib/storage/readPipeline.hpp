@@ -0,0 +1,78 @@
+/**
+ * @file readPipeline.hpp
+ * @author Jordi Gauchía (jgauchia@jgauchia.com)
+ * @brief  Bounce buffer engine for file reads into non DMA-capable (PSRAM) memory
+ * @version 0.2.5
+ * @date 2026-04
+ *
+ * Platform independent (FreeRTOS and heap caps only), also built by tools/storage_bench.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+#include "freertos/queue.h"
+#include "freertos/task.h"
+
+/**
+ * @class ReadPipeline
+ * @brief Reads a file into PSRAM through internal DMA-capable bounce buffers
+ *
+ * @details With two or more bounce buffers, a copy task moves each filled buffer to its
+ *          PSRAM destination while the next chunk is read from the card. With one buffer
+ *          (or if the buffers could not be allocated) the read and the copy run back to
+ *          back. One read at a time uses the buffers; without buffers, or if they stay
+ *          busy, the file is read straight into the destination.
+ *
+ *          The card read and the PSRAM copy functions can be replaced, tools/storage_bench
+ *          uses them to model the SD bus and the PSRAM bandwidth.
+ */
+class ReadPipeline
+{
+    public:
+        static constexpr size_t BUF_SIZE = 16384;    /**< Size of each bounce buffer */
+        static constexpr uint8_t BUF_COUNT = 2;      /**< Bounce buffers (32 KB of internal DMA RAM) */
+        static constexpr uint8_t MAX_BUFFERS = 4;    /**< Bounce buffers supported */
+
+        typedef size_t (*ReadFn)(void *dst, size_t size, size_t count, FILE *file);   /**< fread() */
+        typedef void *(*CopyFn)(void *dst, const void *src, size_t len);              /**< memcpy() */
+
+        ReadPipeline(ReadFn readFn = fread, CopyFn copyFn = memcpy);
+        bool init(size_t size = BUF_SIZE, uint8_t count = BUF_COUNT);
+        void deinit();
+        uint8_t bufferCount() const;
+        size_t read(FILE *file, uint8_t *buffer, size_t size);
+
+    private:
+        /**
+         * @brief Bounce buffer to PSRAM copy job, a null destination ends the copy task
+         */
+        struct CopyJob
+        {
+            uint8_t *dst;              /**< PSRAM destination */
+            const uint8_t *src;        /**< Bounce buffer */
+            size_t len;                /**< Bytes to copy */
+            SemaphoreHandle_t done;    /**< Given when the copy is done */
+        };
+
+        uint8_t *buffers[MAX_BUFFERS];               /**< Internal DMA-capable bounce buffers */
+        SemaphoreHandle_t bufferFree[MAX_BUFFERS];   /**< Given when the buffer copy is done */
+        SemaphoreHandle_t busy;                      /**< Held by the read using the buffers */
+        SemaphoreHandle_t copyExit;                  /**< Given by the copy task when it ends */
+        QueueHandle_t copyQueue;                     /**< Pending copy jobs */
+        size_t bufSize;                              /**< Size of each bounce buffer */
+        uint8_t bufCount;                            /**< Bounce buffers allocated */
+        ReadFn readFn;                               /**< Card read */
+        CopyFn copyFn;                               /**< Bounce buffer to destination copy */
+
+        bool allocate(size_t size, uint8_t count);
+        void release();
+        size_t readSerial(FILE *file, uint8_t *buffer, size_t size);
+        size_t readPipelined(FILE *file, uint8_t *buffer, size_t size);
+        static void copyTask(void *pvParameters);
+};
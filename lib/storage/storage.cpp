@@ -11,6 +11,7 @@
 #include "esp_log.h"
 #include "esp_vfs_fat.h"
 #include "driver/sdspi_host.h"
+#include "esp_timer.h"
 #include <cmath>
 #include <sstream>
 #include <iomanip>
@@ -57,7 +58,10 @@ namespace
 /**
  * @brief Storage Class constructor
  */
-Storage::Storage() : isSdLoaded(false), card(nullptr), dmaBuffer(nullptr), readMutex(nullptr) 
+Storage::Storage() : isSdLoaded(false), card(nullptr), readMutex(nullptr), ioQueue{},
+					 ioMutex(nullptr), ioTaskHandle(nullptr), ioNextId(1), ioLastFile(nullptr), ioLastOffset(0),
+					 traceEvents(nullptr), tracePaths(nullptr), tracePathCount(0), traceFiles{}, traceTotal(0),
+					 traceStartUs(0), traceEnabled(false), traceMutex(nullptr)
 {
 }
 
@@ -72,12 +76,14 @@ Storage::Storage() : isSdLoaded(false), card(nullptr), dmaBuffer(nullptr), readM
  */
 esp_err_t Storage::initSD()
 {
-	if (!dmaBuffer)
-		dmaBuffer = (uint8_t *)heap_caps_aligned_alloc(64, DMA_BUF_SIZE, MALLOC_CAP_DMA | MALLOC_CAP_INTERNAL);
-	
 	if (!readMutex)
 		readMutex = xSemaphoreCreateMutex();
 
+	readPipeline.init();
+
+	if (!initIoQueue())
+		ESP_LOGE(TAG, "Asynchronous I/O not available");
+
 	#ifndef SPI_SHARED
 		esp_err_t ret;
 
@@ -94,7 +100,7 @@ esp_err_t Storage::initSD()
 			.sclk_io_num = (gpio_num_t)SD_CLK,
 			.quadwp_io_num = -1,
 			.quadhd_io_num = -1,
-			.max_transfer_sz = DMA_BUF_SIZE,
+			.max_transfer_sz = SPI_MAX_TRANSFER,
 			.flags = SPICOMMON_BUSFLAG_MASTER,
 			.intr_flags = 0
 		};
@@ -300,8 +306,12 @@ FILE *Storage::open(const char *path, const char *mode)
 	if (xSemaphoreTake(readMutex, pdMS_TO_TICKS(1000)) != pdTRUE)
 		return nullptr;
 
+	const int64_t start = traceEnabled ? esp_timer_get_time() : 0;
 	FILE *file = fopen(path, mode);
 	xSemaphoreGive(readMutex);
+
+	if (traceEnabled)
+		traceRecord(TRACE_OPEN, file, 0, 0, start, file == nullptr, path);
 	return file;
 }
 
@@ -316,8 +326,13 @@ int Storage::close(FILE *file)
 	if (xSemaphoreTake(readMutex, pdMS_TO_TICKS(1000)) != pdTRUE)
 		return EOF;
 
+	const int64_t start = traceEnabled ? esp_timer_get_time() : 0;
 	int res = fclose(file);
 	xSemaphoreGive(readMutex);
+
+	// Also drops the file from the trace table when not recording
+	if (traceMutex)
+		traceRecord(TRACE_CLOSE, file, 0, 0, start, res != 0);
  	return res;
 }
 
@@ -342,11 +357,40 @@ size_t Storage::size(const char *path)
 }
 
 /**
- * @brief Read from a file into a uint8_t buffer
+ * @brief Read from a file into a uint8_t buffer. Must be called with readMutex held.
  *
  * @details Optimized read operation that detects if the target buffer is DMA-capable (SRAM).
  *          If it is, it performs a direct read using fread. For non-DMA buffers (like PSRAM),
- *          it falls back to a chunked read using an intermediate internal DMA buffer.
+ *          the read goes through the bounce buffers of readPipeline (two 16 KB buffers, the
+ *          copy to PSRAM of one overlaps the card read of the other).
+ *
+ * @param file   FILE* pointer to the open file.
+ * @param buffer Pointer to the destination buffer.
+ * @param size   Number of bytes to read.
+ * @return size_t Number of bytes successfully read.
+ */
+size_t Storage::readLocked(FILE *file, uint8_t *buffer, size_t size)
+{
+    const bool tracing = traceEnabled;
+    const uint32_t offset = tracing ? (uint32_t)ftell(file) : 0;
+    const int64_t start = tracing ? esp_timer_get_time() : 0;
+
+    size_t totalRead = 0;
+    if (esp_ptr_internal(buffer))
+        totalRead = fread(buffer, 1, size, file);
+    else
+        totalRead = readPipeline.read(file, buffer, size);
+
+    if (tracing)
+        traceRecord(TRACE_READ, file, offset, size, start, totalRead < size);
+    return totalRead;
+}
+
+/**
+ * @brief Read from a file into a uint8_t buffer
+ *
+ * @details See readLocked(). The read continues from the file position, a task sharing the
+ *          FILE* with another one must use seekRead() instead of seek() and read().
  *
  * @param file   FILE* pointer to the open file.
  * @param buffer Pointer to the destination buffer.
@@ -358,36 +402,40 @@ size_t Storage::read(FILE *file, uint8_t *buffer, size_t size)
     if (!file || !buffer)
         return 0;
 
-    size_t totalRead = 0;
+    if (xSemaphoreTake(readMutex, pdMS_TO_TICKS(1000)) != pdTRUE)
+        return 0;
+    const size_t totalRead = readLocked(file, buffer, size);
+    xSemaphoreGive(readMutex);
+    return totalRead;
+}
+
+/**
+ * @brief Read from a file at an absolute offset
+ *
+ * @details The seek and the read run under one lock, so no other task can move the file
+ *          position in between. Use it for every read of a FILE* shared between tasks.
+ *
+ * @param file   FILE* pointer to the open file.
+ * @param offset Absolute file offset.
+ * @param buffer Pointer to the destination buffer.
+ * @param size   Number of bytes to read.
+ * @return size_t Number of bytes successfully read, 0 if the seek failed.
+ */
+size_t Storage::seekRead(FILE *file, long offset, uint8_t *buffer, size_t size)
+{
+    if (!file || !buffer)
+        return 0;
 
     if (xSemaphoreTake(readMutex, pdMS_TO_TICKS(1000)) != pdTRUE)
         return 0;
 
-    if (esp_ptr_internal(buffer))
-    {
-        totalRead = fread(buffer, 1, size, file);
-    }
-    else
-    {
-        if (!dmaBuffer)
-        {
-            xSemaphoreGive(readMutex);
-            return 0;
-        }
-
-        while (totalRead < size)
-        {
-            size_t toRead = (size - totalRead > DMA_BUF_SIZE) ? DMA_BUF_SIZE : (size - totalRead);
-            size_t r = fread(dmaBuffer, 1, toRead, file);
-
-            if (r == 0)
-                break;
-
-            memcpy(buffer + totalRead, dmaBuffer, r);
-            totalRead += r;
-        }
-    }
+    const bool tracing = traceEnabled;
+    const int64_t start = tracing ? esp_timer_get_time() : 0;
+    const int res = fseek(file, offset, SEEK_SET);
+    if (tracing)
+        traceRecord(TRACE_SEEK, file, (uint32_t)offset, 0, start, res != 0);
 
+    const size_t totalRead = res == 0 ? readLocked(file, buffer, size) : 0;
     xSemaphoreGive(readMutex);
     return totalRead;
 }
@@ -421,8 +469,14 @@ size_t Storage::write(FILE *file, const uint8_t *buffer, size_t size)
 	if (xSemaphoreTake(readMutex, pdMS_TO_TICKS(1000)) != pdTRUE)
 		return 0;
 
+	const bool tracing = traceEnabled;
+	const uint32_t offset = tracing ? (uint32_t)ftell(file) : 0;
+	const int64_t start = tracing ? esp_timer_get_time() : 0;
 	size_t res = fwrite(buffer, 1, size, file);
 	xSemaphoreGive(readMutex);
+
+	if (tracing)
+		traceRecord(TRACE_WRITE, file, offset, size, start, res < size);
 	return res;
 }
 
@@ -436,15 +490,7 @@ size_t Storage::write(FILE *file, const uint8_t *buffer, size_t size)
  */
 size_t Storage::write(FILE *file, const char *buffer, size_t size)
 {
-	if (!file)
-		return 0;
-
-	if (xSemaphoreTake(readMutex, pdMS_TO_TICKS(1000)) != pdTRUE)
-		return 0;
-
-	size_t res = fwrite(buffer, 1, size, file);
-	xSemaphoreGive(readMutex);
-	return res;
+	return write(file, reinterpret_cast<const uint8_t *>(buffer), size);
 }
 
 /**
@@ -528,8 +574,14 @@ int Storage::seek(FILE *file, long offset, int whence)
 	if (xSemaphoreTake(readMutex, pdMS_TO_TICKS(1000)) != pdTRUE)
 		return -1;
 
+	const bool tracing = traceEnabled;
+	const int64_t start = tracing ? esp_timer_get_time() : 0;
 	int res = fseek(file, offset, whence);
+	const uint32_t position = tracing ? (uint32_t)ftell(file) : 0;
 	xSemaphoreGive(readMutex);
+
+	if (tracing)
+		traceRecord(TRACE_SEEK, file, position, 0, start, res != 0);
 	return res;
 }
 
@@ -594,3 +646,550 @@ size_t Storage::fileAvailable(FILE *file)
 	xSemaphoreGive(readMutex);
 	return end_pos - current_pos;
 }
+
+/**
+ * @brief Commit the buffered data and the directory entry of a file to the card
+ *
+ * @param file FILE* pointer
+ * @return 0 on success, -1 on error
+ */
+int Storage::sync(FILE *file)
+{
+	if (!file)
+		return -1;
+
+	if (xSemaphoreTake(readMutex, pdMS_TO_TICKS(1000)) != pdTRUE)
+		return -1;
+
+	int res = fflush(file);
+	if (res == 0)
+		res = fsync(fileno(file));
+	xSemaphoreGive(readMutex);
+	return res;
+}
+
+/**
+ * @brief Truncate a file
+ *
+ * @param path File path
+ * @param size New file size in bytes
+ * @return true on success, false on failure
+ */
+bool Storage::truncate(const char *path, size_t size)
+{
+	if (xSemaphoreTake(readMutex, pdMS_TO_TICKS(1000)) != pdTRUE)
+		return false;
+
+	int res = ::truncate(path, (off_t)size);
+	xSemaphoreGive(readMutex);
+	return res == 0;
+}
+
+/**
+ * @brief Initialize the asynchronous I/O queue and its task
+ *
+ * @return true if the I/O task is running
+ */
+bool Storage::initIoQueue()
+{
+	if (ioTaskHandle)
+		return true;
+
+	ioMutex = xSemaphoreCreateMutex();
+	if (!ioMutex)
+		return false;
+
+	return xTaskCreatePinnedToCore(ioTask, "StorageIO", 4096, this, 2, &ioTaskHandle, tskNO_AFFINITY) == pdPASS;
+}
+
+/**
+ * @brief Queue an asynchronous I/O request
+ *
+ * @param request Request to queue, id and progress are assigned here
+ * @return Request id, 0 if the queue is full or not running
+ */
+uint32_t Storage::submit(const IoRequest &request)
+{
+	if (!ioTaskHandle || !request.file || request.size == 0)
+		return 0;
+
+	if (xSemaphoreTake(ioMutex, pdMS_TO_TICKS(1000)) != pdTRUE)
+		return 0;
+
+	uint32_t id = 0;
+	for (uint8_t i = 0; i < IO_QUEUE_SIZE; i++)
+	{
+		if (ioQueue[i].id == 0)
+		{
+			ioQueue[i] = request;
+			ioQueue[i].done = 0;
+			id = ioNextId++;
+			if (ioNextId == 0)
+				ioNextId = 1;
+			ioQueue[i].id = id;
+			break;
+		}
+	}
+	xSemaphoreGive(ioMutex);
+
+	if (id != 0)
+		xTaskNotifyGive(ioTaskHandle);
+	return id;
+}
+
+/**
+ * @brief Queue an asynchronous read from the current file position
+ *
+ * @details The buffer must stay valid until the request completes. Completion is reported
+ *          through the callback (on the I/O task) and/or a task notification.
+ *
+ * @param file FILE* pointer
+ * @param buffer Buffer to read into
+ * @param size Number of bytes to read
+ * @param priority Request priority
+ * @param callback Completion callback, optional
+ * @param arg Callback argument
+ * @param notifyTask Task notified with xTaskNotifyGive on completion, optional
+ * @return Request id, 0 if the request was not queued
+ */
+uint32_t Storage::submitRead(FILE *file, uint8_t *buffer, size_t size, IoPriority priority,
+							 IoCallback callback, void *arg, TaskHandle_t notifyTask)
+{
+	IoRequest request = {0, file, buffer, nullptr, size, 0, 0, IO_READ, priority, callback, arg, notifyTask};
+	return submit(request);
+}
+
+/**
+ * @brief Queue an asynchronous read from an absolute file offset
+ *
+ * @details Seek-reads on the same file may be reordered by offset to reduce seeking.
+ *
+ * @param file FILE* pointer
+ * @param offset Absolute file offset
+ * @param buffer Buffer to read into
+ * @param size Number of bytes to read
+ * @param priority Request priority
+ * @param callback Completion callback, optional
+ * @param arg Callback argument
+ * @param notifyTask Task notified with xTaskNotifyGive on completion, optional
+ * @return Request id, 0 if the request was not queued
+ */
+uint32_t Storage::submitSeekRead(FILE *file, long offset, uint8_t *buffer, size_t size, IoPriority priority,
+								 IoCallback callback, void *arg, TaskHandle_t notifyTask)
+{
+	IoRequest request = {0, file, buffer, nullptr, size, 0, offset, IO_SEEK_READ, priority, callback, arg, notifyTask};
+	return submit(request);
+}
+
+/**
+ * @brief Queue an asynchronous write at the current file position
+ *
+ * @details The buffer must stay valid until the request completes. Writes to a file keep
+ *          their submission order.
+ *
+ * @param file FILE* pointer
+ * @param buffer Buffer to write from
+ * @param size Number of bytes to write
+ * @param priority Request priority
+ * @param callback Completion callback, optional
+ * @param arg Callback argument
+ * @param notifyTask Task notified with xTaskNotifyGive on completion, optional
+ * @return Request id, 0 if the request was not queued
+ */
+uint32_t Storage::submitWrite(FILE *file, const uint8_t *buffer, size_t size, IoPriority priority,
+							  IoCallback callback, void *arg, TaskHandle_t notifyTask)
+{
+	IoRequest request = {0, file, nullptr, buffer, size, 0, 0, IO_WRITE, priority, callback, arg, notifyTask};
+	return submit(request);
+}
+
+/**
+ * @brief Pick the next request to serve. Must be called with ioMutex held.
+ *
+ * @details Requests are served by priority. Within a priority, seek-reads on the file of
+ *          the last slice continue forward from the current offset (elevator order), the
+ *          rest in submission order. Only seek-reads may overtake an earlier request on
+ *          the same file, so reads and writes that rely on the file position stay ordered.
+ *
+ * @return Index in ioQueue, -1 if there is nothing to serve
+ */
+int Storage::selectIoRequest()
+{
+	int best = -1;
+	uint64_t bestRank = UINT64_MAX;
+
+	for (uint8_t i = 0; i < IO_QUEUE_SIZE; i++)
+	{
+		const IoRequest &req = ioQueue[i];
+		if (req.id == 0)
+			continue;
+
+		bool blocked = false;
+		for (uint8_t j = 0; j < IO_QUEUE_SIZE && !blocked; j++)
+		{
+			const IoRequest &other = ioQueue[j];
+			if (other.id != 0 && other.file == req.file && (int32_t)(other.id - req.id) < 0 &&
+				(other.op != IO_SEEK_READ || req.op != IO_SEEK_READ))
+				blocked = true;
+		}
+		if (blocked)
+			continue;
+
+		// Rank: priority, then forward seek-reads by distance, then submission order
+		const long position = req.offset + (long)req.done;
+		uint64_t rank = (uint64_t)req.priority << 40;
+		if (req.op == IO_SEEK_READ && req.file == ioLastFile && position >= ioLastOffset)
+			rank |= (uint64_t)(position - ioLastOffset) & 0x7FFFFFFF;
+		else
+			rank |= (1ULL << 32) | (uint64_t)(req.id - ioNextId);
+
+		if (rank < bestRank)
+		{
+			bestRank = rank;
+			best = i;
+		}
+	}
+
+	return best;
+}
+
+/**
+ * @brief Asynchronous I/O task
+ *
+ * @details Serves the queue one slice of up to IO_SLICE bytes at a time, picking the next
+ *          request after every slice, so a map tile read pre-empts a long background write.
+ */
+void Storage::ioTask(void *pvParameters)
+{
+	Storage *instance = (Storage *)pvParameters;
+
+	while (1)
+	{
+		ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+
+		while (1)
+		{
+			if (xSemaphoreTake(instance->ioMutex, portMAX_DELAY) != pdTRUE)
+				break;
+			int idx = instance->selectIoRequest();
+			IoRequest req = {};
+			if (idx >= 0)
+				req = instance->ioQueue[idx];
+			xSemaphoreGive(instance->ioMutex);
+
+			if (idx < 0)
+				break;
+
+			size_t chunk = req.size - req.done;
+			if (chunk > IO_SLICE)
+				chunk = IO_SLICE;
+
+			size_t transferred = 0;
+			if (req.op == IO_WRITE)
+				transferred = instance->write(req.file, req.source + req.done, chunk);
+			else if (req.op == IO_SEEK_READ)
+				transferred = instance->seekRead(req.file, req.offset + (long)req.done, req.buffer + req.done, chunk);
+			else
+				transferred = instance->read(req.file, req.buffer + req.done, chunk);
+
+			req.done += transferred;
+			instance->ioLastFile = req.file;
+			instance->ioLastOffset = req.offset + (long)req.done;
+			const bool finished = transferred < chunk || chunk == 0 || req.done >= req.size;
+
+			xSemaphoreTake(instance->ioMutex, portMAX_DELAY);
+			if (finished)
+				instance->ioQueue[idx].id = 0;
+			else
+				instance->ioQueue[idx].done = req.done;
+			xSemaphoreGive(instance->ioMutex);
+
+			if (finished)
+			{
+				if (req.callback)
+					req.callback(req.id, req.done, req.arg);
+				if (req.notifyTask)
+					xTaskNotifyGive(req.notifyTask);
+			}
+		}
+	}
+}
+
+/**
+ * @brief Get the trace id of an open file. Must be called with traceMutex held.
+ *
+ * @details Files opened before the trace was started get an id of their own, with a
+ *          placeholder path, on their first traced operation.
+ *
+ * @param file FILE* pointer
+ * @return Trace file id, 0xFFFF if the path table is full
+ */
+uint16_t Storage::traceFileId(FILE *file)
+{
+	int freeEntry = -1;
+	for (uint8_t i = 0; i < TRACE_OPEN_FILES; i++)
+	{
+		if (traceFiles[i].file == file)
+			return traceFiles[i].id;
+		if (!traceFiles[i].file && freeEntry < 0)
+			freeEntry = i;
+	}
+
+	if (tracePathCount >= TRACE_PATHS)
+		return 0xFFFF;
+
+	uint16_t id = tracePathCount++;
+	snprintf(tracePaths[id], TRACE_PATH_LEN, "<opened before trace %p>", file);
+	if (freeEntry >= 0)
+		traceFiles[freeEntry] = {file, id};
+	return id;
+}
+
+/**
+ * @brief Append an event to the trace ring
+ *
+ * @details The oldest events are overwritten when the ring is full. Opening a path already
+ *          seen reuses its id, so reopening an index file shows up in the trace.
+ *
+ * @param op Operation
+ * @param file FILE* pointer, nullptr for a failed open
+ * @param offset File offset
+ * @param size Bytes requested
+ * @param startUs Operation start time (esp_timer)
+ * @param error Operation failed or was short
+ * @param path Opened path, TRACE_OPEN only
+ */
+void Storage::traceRecord(TraceOp op, FILE *file, uint32_t offset, uint32_t size, int64_t startUs, bool error, const char *path)
+{
+	const int64_t now = esp_timer_get_time();
+
+	if (xSemaphoreTake(traceMutex, portMAX_DELAY) != pdTRUE)
+		return;
+
+	if (traceEnabled)
+	{
+		uint16_t id = 0xFFFF;
+		if (path)
+		{
+			for (uint16_t i = 0; i < tracePathCount && id == 0xFFFF; i++)
+			{
+				if (strncmp(tracePaths[i], path, TRACE_PATH_LEN - 1) == 0)
+					id = i;
+			}
+			if (id == 0xFFFF && tracePathCount < TRACE_PATHS)
+			{
+				id = tracePathCount++;
+				strncpy(tracePaths[id], path, TRACE_PATH_LEN - 1);
+				tracePaths[id][TRACE_PATH_LEN - 1] = '\0';
+			}
+			for (uint8_t i = 0; i < TRACE_OPEN_FILES && file; i++)
+			{
+				if (!traceFiles[i].file)
+				{
+					traceFiles[i] = {file, id};
+					break;
+				}
+			}
+		}
+		else
+			id = traceFileId(file);
+
+		TraceEvent &event = traceEvents[traceTotal % TRACE_EVENTS];
+		event.timeUs = (uint32_t)(startUs - traceStartUs);
+		event.durationUs = (uint32_t)(now - startUs);
+		event.offset = offset;
+		event.size = size;
+		event.fileId = id;
+		event.op = op;
+		event.flags = (error ? TRACE_FLAG_ERROR : 0) |
+					  (ioTaskHandle && xTaskGetCurrentTaskHandle() == ioTaskHandle ? TRACE_FLAG_ASYNC : 0);
+		traceTotal++;
+	}
+
+	if (op == TRACE_CLOSE)
+	{
+		for (uint8_t i = 0; i < TRACE_OPEN_FILES; i++)
+		{
+			if (traceFiles[i].file == file)
+				traceFiles[i].file = nullptr;
+		}
+	}
+
+	xSemaphoreGive(traceMutex);
+}
+
+/**
+ * @brief Start recording SD accesses
+ *
+ * @details The trace ring (TRACE_EVENTS events) and the path table are allocated in PSRAM
+ *          on first use. Recording resumes after a stop, keeping the recorded events and
+ *          the time origin.
+ *
+ * @return true if recording
+ */
+bool Storage::startTrace()
+{
+	if (!traceMutex)
+		traceMutex = xSemaphoreCreateMutex();
+	if (!traceEvents)
+		traceEvents = (TraceEvent *)heap_caps_malloc(TRACE_EVENTS * sizeof(TraceEvent), MALLOC_CAP_SPIRAM);
+	if (!tracePaths)
+		tracePaths = (char (*)[TRACE_PATH_LEN])heap_caps_malloc(TRACE_PATHS * TRACE_PATH_LEN, MALLOC_CAP_SPIRAM);
+
+	if (!traceMutex || !traceEvents || !tracePaths)
+	{
+		ESP_LOGE(TAG, "Not enough memory for SD trace");
+		return false;
+	}
+
+	if (traceTotal == 0)
+		traceStartUs = esp_timer_get_time();
+	traceEnabled = true;
+	return true;
+}
+
+/**
+ * @brief Stop recording SD accesses
+ */
+void Storage::stopTrace()
+{
+	traceEnabled = false;
+}
+
+/**
+ * @brief Discard the recorded events and restart the trace time origin
+ *
+ * @details The path table is emptied too, keeping only the paths of the files still open,
+ *          renumbered from 0, so a long session does not run out of trace file ids.
+ */
+void Storage::clearTrace()
+{
+	if (!traceMutex)
+		return;
+
+	xSemaphoreTake(traceMutex, portMAX_DELAY);
+	uint16_t oldIds[TRACE_OPEN_FILES];
+	for (uint8_t i = 0; i < TRACE_OPEN_FILES; i++)
+	{
+		if (traceFiles[i].file && traceFiles[i].id >= tracePathCount)
+			traceFiles[i].file = nullptr;
+		oldIds[i] = traceFiles[i].id;
+	}
+
+	// Kept paths move down in increasing id order, never over one still to be moved
+	uint16_t count = 0;
+	uint16_t last = 0xFFFF;
+	while (true)
+	{
+		uint16_t next = 0xFFFF;
+		for (uint8_t i = 0; i < TRACE_OPEN_FILES; i++)
+		{
+			if (traceFiles[i].file && (last == 0xFFFF || oldIds[i] > last) && oldIds[i] < next)
+				next = oldIds[i];
+		}
+		if (next == 0xFFFF)
+			break;
+
+		if (next != count)
+			memcpy(tracePaths[count], tracePaths[next], TRACE_PATH_LEN);
+		for (uint8_t i = 0; i < TRACE_OPEN_FILES; i++)
+		{
+			if (traceFiles[i].file && oldIds[i] == next)
+				traceFiles[i].id = count;
+		}
+		count++;
+		last = next;
+	}
+	tracePathCount = count;
+	traceTotal = 0;
+	traceStartUs = esp_timer_get_time();
+	xSemaphoreGive(traceMutex);
+}
+
+/**
+ * @brief Check if SD accesses are being recorded
+ *
+ * @return true if recording
+ */
+bool Storage::isTracing() const
+{
+	return traceEnabled;
+}
+
+/**
+ * @brief Get the number of events held in the trace ring
+ *
+ * @return Events available for dumping
+ */
+uint32_t Storage::getTraceCount() const
+{
+	return traceTotal < TRACE_EVENTS ? traceTotal : TRACE_EVENTS;
+}
+
+/**
+ * @brief Dump the trace as text
+ *
+ * @details Recording is paused during the dump. Output format, one record per line:
+ *          "F <id> <path>" for each traced path, then
+ *          "<time_us> <op> <file> <offset> <size> <duration_us> <flags>" for each event,
+ *          op being one of O(pen) R(ead) W(rite) S(eek) C(lose).
+ *          This is the input format of tools/sdtrace/sdtrace_replay.py.
+ *
+ * @param writer Output callback, called with blocks of whole lines
+ * @param arg Callback argument
+ */
+void Storage::dumpTrace(TraceWriter writer, void *arg)
+{
+	static const char opCodes[] = "ORWSC";
+	const bool wasEnabled = traceEnabled;
+	traceEnabled = false;
+
+	char block[512];
+	size_t used = 0;
+	auto emit = [&](const char *line, int len)
+	{
+		if (len <= 0)
+			return;
+		if (used + len > sizeof(block))
+		{
+			writer(block, used, arg);
+			used = 0;
+		}
+		memcpy(block + used, line, len);
+		used += len;
+	};
+
+	char line[TRACE_PATH_LEN + 16];
+	if (!traceMutex || !traceEvents)
+	{
+		emit(line, snprintf(line, sizeof(line), "# no SD trace recorded\n"));
+	}
+	else
+	{
+		// Wait for an event being recorded
+		xSemaphoreTake(traceMutex, portMAX_DELAY);
+		xSemaphoreGive(traceMutex);
+
+		const uint32_t count = getTraceCount();
+		emit(line, snprintf(line, sizeof(line), "# IceNav SD trace, %lu events, %lu lost\n",
+						   (unsigned long)count, (unsigned long)(traceTotal - count)));
+		emit(line, snprintf(line, sizeof(line), "# time_us op file offset size duration_us flags\n"));
+
+		for (uint16_t i = 0; i < tracePathCount; i++)
+			emit(line, snprintf(line, sizeof(line), "F %u %s\n", i, tracePaths[i]));
+
+		for (uint32_t i = traceTotal - count; i != traceTotal; i++)
+		{
+			const TraceEvent &event = traceEvents[i % TRACE_EVENTS];
+			emit(line, snprintf(line, sizeof(line), "%lu %c %u %lu %lu %lu %u\n",
+								(unsigned long)event.timeUs, opCodes[event.op], event.fileId,
+								(unsigned long)event.offset, (unsigned long)event.size,
+								(unsigned long)event.durationUs, event.flags));
+		}
+	}
+
+	if (used > 0)
+		writer(block, used, arg);
+
+	traceEnabled = wasEnabled;
+}
@@ -16,6 +16,9 @@
 #include "Stream.h"
 #include "freertos/FreeRTOS.h"
 #include "freertos/semphr.h"
+#include "freertos/queue.h"
+#include "freertos/task.h"
+#include "readPipeline.hpp"
 #include <stdio.h>
 #include <sys/stat.h>
 #include <sys/types.h>
@@ -47,6 +50,73 @@ struct SDCardInfo
     std::string used_space;   /**< Used space as a string */
 };
 
+/**
+ * @brief Asynchronous I/O operation
+ */
+enum IoOp : uint8_t
+{
+    IO_READ,        /**< Read from the current file position */
+    IO_WRITE,       /**< Write at the current file position */
+    IO_SEEK_READ    /**< Read from an absolute offset */
+};
+
+/**
+ * @brief Asynchronous I/O priority, lower value is served first
+ */
+enum IoPriority : uint8_t
+{
+    IO_PRIO_MAP = 0,          /**< Map tile reads, on the render path */
+    IO_PRIO_NORMAL = 1,       /**< User triggered file access */
+    IO_PRIO_BACKGROUND = 2    /**< Logs and recorders */
+};
+
+/**
+ * @brief Asynchronous I/O completion callback, runs on the I/O task
+ *
+ * @param id Request id returned by the submit call
+ * @param result Bytes transferred
+ * @param arg User argument
+ */
+typedef void (*IoCallback)(uint32_t id, size_t result, void *arg);
+
+/**
+ * @brief Traced storage operation
+ */
+enum TraceOp : uint8_t
+{
+    TRACE_OPEN,     /**< File opened */
+    TRACE_READ,     /**< Read at offset */
+    TRACE_WRITE,    /**< Write at offset */
+    TRACE_SEEK,     /**< Seek, offset is the resulting position */
+    TRACE_CLOSE     /**< File closed */
+};
+
+static constexpr uint8_t TRACE_FLAG_ERROR = 0x01;  /**< Operation failed or transferred less than requested */
+static constexpr uint8_t TRACE_FLAG_ASYNC = 0x02;  /**< Issued by the asynchronous I/O task */
+
+/**
+ * @brief SD access trace event (20 bytes)
+ */
+struct TraceEvent
+{
+    uint32_t timeUs;      /**< Start time since the trace was started (us) */
+    uint32_t durationUs;  /**< Operation duration (us) */
+    uint32_t offset;      /**< File offset before the operation (after it for seeks) */
+    uint32_t size;        /**< Bytes requested */
+    uint16_t fileId;      /**< Traced file id, one per distinct path */
+    TraceOp op;           /**< Operation */
+    uint8_t flags;        /**< TRACE_FLAG_* */
+};
+
+/**
+ * @brief Trace dump output callback
+ *
+ * @param data Text to output
+ * @param len Text length
+ * @param arg User argument
+ */
+typedef void (*TraceWriter)(const char *data, size_t len, void *arg);
+
 /**
  * @class Storage
  * @brief Storage class for SD and SPIFFS operations
@@ -59,9 +129,71 @@ class Storage
     private:
         bool isSdLoaded;           /**< Indicates if the SD card is loaded */
         sdmmc_card_t *card;        /**< Pointer to the SD card descriptor */
-        uint8_t *dmaBuffer;        /**< Persistent buffer for DMA-safe reads */
-        static constexpr size_t DMA_BUF_SIZE = 32768; 
-        SemaphoreHandle_t readMutex; /**< Mutex to protect dmaBuffer */
+        static constexpr size_t SPI_MAX_TRANSFER = 32768;  /**< SPI bus max transfer size */
+        SemaphoreHandle_t readMutex; /**< Mutex to serialize file operations */
+        ReadPipeline readPipeline;   /**< Bounce buffers for PSRAM reads */
+
+        static constexpr uint8_t IO_QUEUE_SIZE = 16;   /**< Pending asynchronous requests */
+        static constexpr size_t IO_SLICE = 16384;      /**< Bytes transferred before rescheduling */
+
+        /**
+         * @brief Pending asynchronous I/O request
+         */
+        struct IoRequest
+        {
+            uint32_t id;               /**< Request id, 0 = free entry */
+            FILE *file;                /**< Target file */
+            uint8_t *buffer;           /**< Read destination */
+            const uint8_t *source;     /**< Write source */
+            size_t size;               /**< Bytes to transfer */
+            size_t done;               /**< Bytes transferred so far */
+            long offset;               /**< Absolute offset for IO_SEEK_READ */
+            IoOp op;                   /**< Operation */
+            IoPriority priority;       /**< Priority */
+            IoCallback callback;       /**< Completion callback */
+            void *arg;                 /**< Callback argument */
+            TaskHandle_t notifyTask;   /**< Task notified on completion */
+        };
+
+        IoRequest ioQueue[IO_QUEUE_SIZE];  /**< Pending asynchronous requests */
+        SemaphoreHandle_t ioMutex;         /**< Mutex to protect ioQueue */
+        TaskHandle_t ioTaskHandle;         /**< Asynchronous I/O task */
+        uint32_t ioNextId;                 /**< Next request id */
+        FILE *ioLastFile;                  /**< File of the last served slice */
+        long ioLastOffset;                 /**< File offset after the last served slice */
+
+        size_t readLocked(FILE *file, uint8_t *buffer, size_t size);
+        bool initIoQueue();
+        uint32_t submit(const IoRequest &request);
+        int selectIoRequest();
+        static void ioTask(void *pvParameters);
+
+        static constexpr uint16_t TRACE_EVENTS = 8192;     /**< Trace ring capacity */
+        static constexpr uint16_t TRACE_PATHS = 256;       /**< Distinct traced paths */
+        static constexpr uint8_t TRACE_PATH_LEN = 96;      /**< Stored path length */
+        static constexpr uint8_t TRACE_OPEN_FILES = 20;    /**< Tracked open files (FAT max_files) */
+
+        /**
+         * @brief Open file to trace id mapping
+         */
+        struct TraceFile
+        {
+            FILE *file;           /**< Open file, nullptr = free entry */
+            uint16_t id;          /**< Trace file id */
+        };
+
+        TraceEvent *traceEvents;                    /**< Trace ring in PSRAM */
+        char (*tracePaths)[TRACE_PATH_LEN];         /**< Path of each trace file id, in PSRAM */
+        uint16_t tracePathCount;                    /**< Trace file ids in use */
+        TraceFile traceFiles[TRACE_OPEN_FILES];     /**< Open traced files */
+        uint32_t traceTotal;                        /**< Events recorded since the last clear */
+        int64_t traceStartUs;                       /**< Trace time origin */
+        volatile bool traceEnabled;                 /**< Recording is active */
+        SemaphoreHandle_t traceMutex;               /**< Mutex to protect the trace ring */
+
+        uint16_t traceFileId(FILE *file);
+        void traceRecord(TraceOp op, FILE *file, uint32_t offset, uint32_t size, int64_t startUs, bool error,
+                         const char *path = nullptr);
 
     public:
         Storage();
@@ -79,12 +211,29 @@ class Storage
         size_t size(const char *path);
         size_t read(FILE* file, uint8_t* buffer, size_t size);
         size_t read(FILE* file, char* buffer, size_t size);
+        size_t seekRead(FILE* file, long offset, uint8_t* buffer, size_t size);
         size_t write(FILE* file, const uint8_t* buffer, size_t size);
         size_t write(FILE* file, const char* buffer, size_t size);
         int seek(FILE* file, long offset, int whence);
         int print(FILE* file, const char* str);
         int println(FILE* file, const char* str);
         size_t fileAvailable(FILE* file);
+        int sync(FILE* file);
+        bool truncate(const char *path, size_t size);
+
+        uint32_t submitRead(FILE *file, uint8_t *buffer, size_t size, IoPriority priority,
+                            IoCallback callback = nullptr, void *arg = nullptr, TaskHandle_t notifyTask = nullptr);
+        uint32_t submitSeekRead(FILE *file, long offset, uint8_t *buffer, size_t size, IoPriority priority,
+                                IoCallback callback = nullptr, void *arg = nullptr, TaskHandle_t notifyTask = nullptr);
+        uint32_t submitWrite(FILE *file, const uint8_t *buffer, size_t size, IoPriority priority,
+                             IoCallback callback = nullptr, void *arg = nullptr, TaskHandle_t notifyTask = nullptr);
+
+        bool startTrace();
+        void stopTrace();
+        void clearTrace();
+        bool isTracing() const;
+        uint32_t getTraceCount() const;
+        void dumpTrace(TraceWriter writer, void *arg);
 };
 
 /**
@@ -11,20 +11,52 @@
 
 #include "tasks.hpp"
 #include "mainScr.hpp"
+#include "trackRecorder.hpp"
+#include "turnDetector.hpp"
+#include "reroute.hpp"
+#include "settings.hpp"
 
 xSemaphoreHandle gpsMutex;         /**< Mutex for GPS resource protection */
+xSemaphoreHandle navMutex;         /**< Mutex for the navigation track, turns and state */
+TaskHandle_t navTaskHandle = NULL; /**< Navigation task, notified by the GPS task on each new fix */
+TaskHandle_t gpsTaskHandle = NULL; /**< GPS task, notified by the UART receive callback on complete sentences */
+static QueueHandle_t navQueue;     /**< Latest navigation result for the GUI (one slot, overwritten) */
+static QueueHandle_t fixQueue;     /**< Latest GPS fix for the position predictor (one slot, overwritten) */
 extern Gps gps;                    /**< Global GPS instance for data processing */
 SensorData globalSensorData;       /**< Global sensor data instance */
 
 static const char* TAG = "Task"; /**< Logging tag for task operations */
 
+/**
+ * @brief Publish the current GPS position for the map position predictor
+ */
+static void publishFix()
+{
+    const FixSample sample = { gps.gpsData.latitude, gps.gpsData.longitude, (float)gps.gpsData.speed,
+                               (float)gps.gpsData.heading, (uint32_t)millis() };
+    xQueueOverwrite(fixQueue, &sample);
+}
+
+/**
+ * @brief Take the latest GPS fix, called from the GUI task
+ *
+ * @param sample Latest fix
+ * @return true if there is a fix not taken yet
+ */
+bool getFixSample(FixSample &sample)
+{
+    return fixQueue != NULL && xQueueReceive(fixQueue, &sample, 0) == pdTRUE;
+}
+
 /**
  * @brief GPS data processing task
  *
- * @details Continuously reads GPS data from the serial port, processes NMEA sentences,
- *          and updates the global GPS fix structure. Handles optional NMEA output to
- *          serial console and ensures thread-safe access using gpsMutex. The task runs
- *          on core 0 with high priority to ensure real-time GPS data processing.
+ * @details Sleeps until the UART receive callback has put complete NMEA sentences in nmeaRing
+ *          (one wakeup per burst, not per tick), then parses them, updates the global GPS fix
+ *          structure, feeds the track recorder and the map position predictor, and wakes the
+ *          navigation task. Handles optional NMEA output to serial console and ensures
+ *          thread-safe access using gpsMutex. The task runs on core 0 with high priority to
+ *          ensure real-time GPS data processing.
  *
  * @param pvParameters Task parameters (unused in current implementation)
  */
@@ -32,28 +64,39 @@ void gpsTask(void *pvParameters)
 {
     ESP_LOGV(TAG, "GPS Task - running on core %d", xPortGetCoreID());
     ESP_LOGV(TAG, "Stack size: %d", uxTaskGetStackHighWaterMark(NULL));
+    uint8_t buf[128];
     while (1)
     {
+        // The timeout only guards against a missed notification
+        ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(1000));
         if ( xSemaphoreTake(gpsMutex, portMAX_DELAY) == pdTRUE )
         {
-            if (nmea_output_enable)
+            bool newFix = false;
+            size_t len;
+            while ((len = nmeaRing.read(buf, sizeof(buf))) > 0)
             {
-                while (gpsPort.available())
+                if (nmea_output_enable)
+                    Serial.write(buf, len);
+
+                for (size_t i = 0; i < len; i++)
+                    GPS.handle(buf[i]);
+
+                while (GPS.available())
                 {
-                    char c = gpsPort.read();
-                    Serial.print(c);
+                    fix = GPS.read();
+                    gps.getGPSData();
+                    trackRecorder.addFix(fix);
+                    newFix = true;
                 }
-            } 
-
-            while (GPS.available( gpsPort )) 
-            {
-                fix = GPS.read();
-                gps.getGPSData();
             }
 
+            if (newFix && isGpsFixed)
+                publishFix();
+
             xSemaphoreGive(gpsMutex);
 
-            vTaskDelay(1); /// portTICK_PERIOD_MS);
+            if (newFix && navTaskHandle != NULL)
+                xTaskNotifyGive(navTaskHandle);
         }
     }
 }
@@ -61,16 +104,119 @@ void gpsTask(void *pvParameters)
 /**
  * @brief Initialize GPS processing task
  *
- * @details Creates and starts the GPS task on core 0 with 8KB stack size and priority 1.
+ * @details Creates and starts the GPS task on core 0 with 4KB stack size and priority 2.
  *          Includes a 500ms delay after task creation to ensure proper initialization
  *          before other system components attempt to access GPS data.
  */
 void initGpsTask()
 {
-    xTaskCreatePinnedToCore(gpsTask, PSTR("GPS Task"), 4096, NULL, 2, NULL, 0);
+    fixQueue = xQueueCreate(1, sizeof(FixSample));
+    xTaskCreatePinnedToCore(gpsTask, PSTR("GPS Task"), 4096, NULL, 2, &gpsTaskHandle, 0);
     vTaskDelay(pdMS_TO_TICKS(500));
 }
 
+extern TrackVector trackData;                 /**< Full track, used by the navigation simulation */
+extern TrackVector navTrack;                  /**< Simplified track for navigation */
+extern TrackGrid trackGrid;                   /**< Spatial grid of navTrack segments */
+extern std::vector<TurnPoint> turnPoints;     /**< Turns of navTrack */
+extern NavState navState;                     /**< Turn-by-turn navigation state */
+static Rerouter rerouter;                     /**< Route back to navTrack when off track */
+
+/**
+ * @brief Turn-by-turn navigation task
+ *
+ * @details Sleeps until the GPS task notifies a new fix, then matches the position to the
+ *          loaded track and publishes a NavResult for the GUI task (getNavResult). It never
+ *          touches LVGL objects. In navigation simulation mode there is no fix to wait for, so
+ *          it wakes every 100 ms and moves the simulated position along the track. Without fixes
+ *          it still wakes every second to pick up the turns of a newly loaded track. When the
+ *          position stays off the track, the instructions come from a route back to it over the
+ *          region road graph (Rerouter), searched in this task.
+ *
+ * @param pvParameters Task parameters (unused)
+ */
+void navTask(void *pvParameters)
+{
+    ESP_LOGV(TAG, "Navigation Task - running on core %d", xPortGetCoreID());
+    NavConfig navConfig;
+    navConfig.searchWindow = 150;
+    navConfig.offTrackThreshold = 75.0f;
+    navConfig.maxBackwardJump = 10;
+
+    while (1)
+    {
+        const bool simulate = navSet.simNavigation && isTrackLoaded;
+        ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(simulate ? 100 : 1000));
+
+        if (xSemaphoreTake(navMutex, portMAX_DELAY) != pdTRUE)
+            continue;
+
+        if (isTrackLoaded)
+        {
+            if (turnDetector.collect(turnPoints))
+            {
+                navState.nextTurnIdx = 0;
+                navState.lastValidTurnIdx = 0;
+                rerouter.reset();
+            }
+
+            if (navSet.simNavigation)
+            {
+                const float simLat = gps.gpsData.latitude, simLon = gps.gpsData.longitude;
+                gps.simFakeGPS(trackData, 120, 1000);
+                if (gps.gpsData.latitude != simLat || gps.gpsData.longitude != simLon)
+                    publishFix();
+            }
+
+            float lat = 0, lon = 0, heading = 0, speed = 0;
+            if (xSemaphoreTake(gpsMutex, portMAX_DELAY) == pdTRUE)
+            {
+                lat = gps.gpsData.latitude;
+                lon = gps.gpsData.longitude;
+                heading = gps.gpsData.heading;
+                speed = gps.gpsData.speed;
+                xSemaphoreGive(gpsMutex);
+            }
+
+            if (speed != 0)
+            {
+                NavResult result = updateNavigation(lat, lon, heading, speed, navTrack, trackGrid, turnPoints, navState,
+                                                    20, 200, navConfig);
+                NavResult routeResult;
+                if (rerouter.update(lat, lon, heading, speed, navTrack, result, navConfig, millis(), routeResult))
+                    result = routeResult;
+                xQueueOverwrite(navQueue, &result);
+            }
+        }
+
+        xSemaphoreGive(navMutex);
+    }
+}
+
+/**
+ * @brief Initialize navigation task
+ *
+ * @details Creates the result mailbox and starts the navigation task on core 0 with 6KB stack
+ *          (road graph reads from SD while rerouting) and priority 1, below the GPS task that wakes it.
+ */
+void initNavTask()
+{
+    navMutex = xSemaphoreCreateMutex();
+    navQueue = xQueueCreate(1, sizeof(NavResult));
+    xTaskCreatePinnedToCore(navTask, "Nav Task", 6144, NULL, 1, &navTaskHandle, 0);
+}
+
+/**
+ * @brief Take the latest navigation result, called from the GUI task
+ *
+ * @param result Latest result
+ * @return true if there is a result not taken yet
+ */
+bool getNavResult(NavResult &result)
+{
+    return navQueue != NULL && xQueueReceive(navQueue, &result, 0) == pdTRUE;
+}
+
 /**
  * @brief Command-line interface processing task
  *
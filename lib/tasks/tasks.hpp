@@ -1,7 +1,7 @@
 /**
  * @file tasks.hpp
  * @author Jordi Gauchía (jgauchia@jgauchia.com)
- * @brief  Core Tasks header definitions for GPS and CLI management
+ * @brief  Core Tasks header definitions for GPS, navigation and CLI management
  * @version 0.2.5
  * @date 2026-04
  * @details This header defines the interface for FreeRTOS tasks used for GPS data processing
@@ -19,6 +19,7 @@
 #include "cli.hpp"
 #include "globalGpxDef.h"
 #include "lvglFuncs.hpp"
+#include "navigation.hpp"
 
 /**
  * @struct SensorData
@@ -36,10 +37,32 @@ struct SensorData
 
 extern SensorData globalSensorData;
 
+/**
+ * @struct FixSample
+ * @brief GPS fix passed from the GPS task to the map position predictor
+ */
+struct FixSample
+{
+    float lat;          /**< Latitude */
+    float lon;          /**< Longitude */
+    float speed;        /**< Speed (km/h) */
+    float course;       /**< Course over ground (deg) */
+    uint32_t time;      /**< millis() when the fix was read */
+};
+extern xSemaphoreHandle navMutex;
+
 void gpsTask(void *pvParameters);
 
 void initGpsTask();
 
+bool getFixSample(FixSample &sample);
+
+void navTask(void *pvParameters);
+
+void initNavTask();
+
+bool getNavResult(NavResult &result);
+
 void sensorTask(void *pvParameters);
 
 void initSensorTask();
@@ -72,6 +72,27 @@ float calcDist(float lat1, float lon1, float lat2, float lon2)
     if (lat1 == last_lat1 && lon1 == last_lon1 && lat2 == last_lat2 && lon2 == last_lon2)
         return last_dist;
 
+    last_dist = calcDistUncached(lat1, lon1, lat2, lon2);
+    
+    // Update cache
+    last_lat1 = lat1; last_lon1 = lon1; last_lat2 = lat2; last_lon2 = lon2;
+
+    return last_dist;
+}
+
+/**
+ * @brief Haversine distance without the last value cache of calcDist
+ *
+ * @details Same result as calcDist, safe to call from background tasks.
+ *
+ * @param lat1 Latitude of point 1 (in degrees)
+ * @param lon1 Longitude of point 1 (in degrees)
+ * @param lat2 Latitude of point 2 (in degrees)
+ * @param lon2 Longitude of point 2 (in degrees)
+ * @return Distance in meters between the two points
+ */
+float calcDistUncached(float lat1, float lon1, float lat2, float lon2)
+{
 	float lat1_rad = DEG2RAD(lat1);
 	float lon1_rad = DEG2RAD(lon1);
 	float lat2_rad = DEG2RAD(lat2);
@@ -95,12 +116,7 @@ float calcDist(float lat1, float lon1, float lat2, float lon2)
     }
 
     c = 2.0f * atan2f(sqrtf(a), sqrtf(1.0f - a));
-    last_dist = EARTH_RADIUS * c;
-    
-    // Update cache
-    last_lat1 = lat1; last_lon1 = lon1; last_lat2 = lat2; last_lon2 = lon2;
-
-    return last_dist;
+    return EARTH_RADIUS * c;
 }
 
 /**
@@ -137,6 +153,27 @@ float calcDistSq(float lat1_rad, float lon1_rad, float lat2_rad, float lon2_rad)
  * @return Initial heading (degrees from North, 0-360)
  */
 float calcCourse(float lat1, float lon1, float lat2, float lon2)
+{
+    float y, x;
+    calcCourseVector(lat1, lon1, lat2, lon2, y, x);
+    return courseFromVector(y, x);
+}
+
+/**
+ * @brief Initial great-circle course between two coordinates as a direction vector
+ *
+ * @details East (y) and north (x) components used by calcCourse, before the atan2.
+ *          Normalized, they give the course as a unit vector, which can be compared
+ *          with dot and cross products without trigonometry.
+ *
+ * @param lat1 Latitude of point 1 (in degrees)
+ * @param lon1 Longitude of point 1 (in degrees)
+ * @param lat2 Latitude of point 2 (in degrees)
+ * @param lon2 Longitude of point 2 (in degrees)
+ * @param y Output east component
+ * @param x Output north component
+ */
+void calcCourseVector(float lat1, float lon1, float lat2, float lon2, float &y, float &x)
 {
     lat1 = DEG2RAD(lat1);
     lat2 = DEG2RAD(lat2);
@@ -164,8 +201,19 @@ float calcCourse(float lat1, float lon1, float lat2, float lon2)
         cos_lat2 = cosf(lat2);
     }
 
-    float y = sin_dLon * cos_lat2;
-    float x = cos_lat1 * sin_lat2 - sin_lat1 * cos_lat2 * cos_dLon;
+    y = sin_dLon * cos_lat2;
+    x = cos_lat1 * sin_lat2 - sin_lat1 * cos_lat2 * cos_dLon;
+}
+
+/**
+ * @brief Course of a direction vector from calcCourseVector
+ *
+ * @param y East component
+ * @param x North component
+ * @return Heading (degrees from North, 0-360)
+ */
+float courseFromVector(float y, float x)
+{
     float course = atan2f(y, x) * (180.0f / M_PI);
 
     if (course < 0.0f)
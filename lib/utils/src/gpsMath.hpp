@@ -109,8 +109,11 @@ static inline __attribute__((always_inline)) float cosLUT(float rad)
 
 
 float calcDist(float lat1, float lon1, float lat2, float lon2);
+float calcDistUncached(float lat1, float lon1, float lat2, float lon2);
 float calcDistSq(float lat1, float lon1, float lat2, float lon2);
 float calcCourse(float lat1, float lon1, float lat2, float lon2);
+void calcCourseVector(float lat1, float lon1, float lat2, float lon2, float &y, float &x);
+float courseFromVector(float y, float x);
 float calcAngleDiff(float a, float b);
 char *latFormatString(float lat);
 char *lonFormatString(float lon);
@@ -4,6 +4,9 @@
  * @brief Navigation functions
  * @version 0.2.5
  * @date 2026-04
+ *
+ * Platform independent, also built by tools/nav_replay. The navigation task runs the
+ * engine on each new fix and the GUI task applies the resulting NavResult.
  */
 
 #pragma once
@@ -12,7 +15,7 @@
 #include <vector>
 #include "globalGpxDef.h"
 #include "gpsMath.hpp"
-#include "lvgl.h"
+#include "trackGrid.hpp"
 
 /**
  * @brief Navigation configuration parameters
@@ -22,11 +25,14 @@
  */
 struct NavConfig 
 {
-    int searchWindow = 100;          /**< Window size for local search in findClosestTrackPoint */
+    int searchWindow = 100;          /**< Window size for local search in matchTrackPosition */
     float offTrackThreshold = 50.0f; /**< Distance threshold for off-track detection (meters) */
     float minTurnDistance = 5.0f;    /**< Minimum distance for valid turn detection (meters) */
     float maxTurnDistance = 2000.0f; /**< Maximum distance for suspicious turn filtering (meters) */
     int maxBackwardJump = 8;         /**< Maximum backward positions to prevent GPS noise jumps */
+    float reacquireRadius = 500.0f;  /**< Spatial grid search radius when the local search fails (meters) */
+    float directionMargin = 15.0f;   /**< Extra distance allowed to a match in the direction of travel (meters) */
+    float headingMinSpeed = 3.0f;    /**< Minimum speed to use the GPS heading for matching (km/h) */
 };
 
 /**
@@ -53,15 +59,47 @@ struct NavState
     float projLon = 0;    /**< Projected longitude on the track segment. */
 };
 
-int findClosestTrackPoint(float userLat, float userLon, const TrackVector& track, int lastIdx, const NavConfig& config = NavConfig{});
+/**
+ * @brief Turn-by-turn instruction icon
+ */
+enum NavIcon : uint8_t
+{
+    NAV_ICON_STRAIGHT,
+    NAV_ICON_SLIGHT_LEFT,
+    NAV_ICON_SLIGHT_RIGHT,
+    NAV_ICON_TURN_LEFT,
+    NAV_ICON_TURN_RIGHT,
+    NAV_ICON_FINISH,
+    NAV_ICON_OFF_TRACK
+};
+
+/**
+ * @brief Result of one navigation update, published by the navigation task to the GUI
+ */
+struct NavResult
+{
+    NavIcon icon;         /**< Instruction icon */
+    int turnDist;         /**< Distance to the next turn rounded to 5 m, -1 when there is none */
+    int nextTurn;         /**< Index of the next turn, -1 when there is none */
+    int trackIdx;         /**< Matched track segment, of the route back while rerouting */
+    int loadedIdx;        /**< Matched segment of the loaded track, also while rerouting */
+    float distToTrack;    /**< Distance to the track (m) */
+    float projLat;        /**< Projected latitude on the track segment */
+    float projLon;        /**< Projected longitude on the track segment */
+};
+
+TrackMatch matchTrackPosition(float userLat, float userLon, float userHeading, bool headingValid,
+                              const TrackVector& track, const TrackGrid& grid, int lastIdx,
+                              const NavConfig& config = NavConfig{});
 void handleOffTrackCondition(float distToTrack, NavState& state, int closestIdx, const NavConfig& config = NavConfig{});
 void advanceTurnIndex(const std::vector<TurnPoint>& turns, NavState& state, int closestIdx);
 int findNextValidTurn(const TrackVector& track, const std::vector<TurnPoint>& turns, 
                       float userLat, float userLon, int closestIdx, NavState& state, const NavConfig& config = NavConfig{});
-void updateNavigation
+NavResult updateNavigation
 (
     float userLat, float userLon, float userHeading, float speed_kmh,
     const TrackVector& track,
+    const TrackGrid& grid,
     const std::vector<TurnPoint>& turns,
     NavState& state,
     float minAngleForCurve,
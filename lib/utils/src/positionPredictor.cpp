@@ -0,0 +1,199 @@
+/**
+ * @file positionPredictor.cpp
+ * @author Jordi Gauchía (jgauchia@jgauchia.com)
+ * @brief  Dead reckoning of the displayed position between GPS fixes
+ * @version 0.2.5
+ * @date 2026-04
+ */
+
+#include "positionPredictor.hpp"
+#include <algorithm>
+#include <cmath>
+#include "gpsMath.hpp"
+
+/**
+ * @brief Meters per degree of latitude
+ */
+static constexpr float METERS_PER_DEG = (float)(EARTH_RADIUS * M_PI / 180.0);
+
+/**
+ * @brief Corrections under this length (m) are finished
+ */
+static constexpr float CORRECTION_DONE = 0.05f;
+
+PositionPredictor::PositionPredictor()
+{
+    reset();
+}
+
+/**
+ * @brief Forget the fixes and the compass
+ */
+void PositionPredictor::reset()
+{
+    valid = false;
+    fixLat = fixLon = 0.0f;
+    speed = course = 0.0f;
+    fixTime = 0;
+    gpsYawRate = compassYawRate = 0.0f;
+    lastHeading = 0.0f;
+    headingTime = 0;
+    corrNorth = corrEast = 0.0f;
+}
+
+/**
+ * @brief New GPS fix
+ *
+ * @details The gap between the position shown at this time and the fix becomes the
+ *          correction that fades out, unless it is longer than SNAP_DIST.
+ *
+ * @param lat Latitude
+ * @param lon Longitude
+ * @param speedKmh Speed (km/h)
+ * @param course Course over ground (deg)
+ * @param timeMs Time of the fix (ms)
+ */
+void PositionPredictor::onFix(float lat, float lon, float speedKmh, float course, uint32_t timeMs)
+{
+    const float newSpeed = speedKmh / 3.6f;
+    float errNorth = 0.0f, errEast = 0.0f;
+    gpsYawRate = 0.0f;
+
+    if (valid)
+    {
+        float shownLat, shownLon;
+        predict(timeMs, shownLat, shownLon);
+        float dLon = shownLon - lon;
+        if (dLon > 180.0f)
+            dLon -= 360.0f;
+        else if (dLon < -180.0f)
+            dLon += 360.0f;
+        errNorth = (shownLat - lat) * METERS_PER_DEG;
+        errEast = dLon * METERS_PER_DEG * cosf(DEG2RAD(lat));
+        if (errNorth * errNorth + errEast * errEast > SNAP_DIST * SNAP_DIST)
+            errNorth = errEast = 0.0f;
+
+        // Course is only meaningful while moving
+        const float dt = (timeMs - fixTime) / 1000.0f;
+        const float minSpeed = MIN_SPEED / 3.6f;
+        if (speed >= minSpeed && newSpeed >= minSpeed && dt > 0.0f && dt <= 3.0f)
+            gpsYawRate = std::clamp(calcAngleDiff(course, this->course) / dt, -MAX_YAW_RATE, MAX_YAW_RATE);
+    }
+
+    valid = true;
+    fixLat = lat;
+    fixLon = lon;
+    speed = newSpeed;
+    this->course = course;
+    fixTime = timeMs;
+    corrNorth = errNorth;
+    corrEast = errEast;
+}
+
+/**
+ * @brief New compass heading, gives the yaw rate between fixes
+ *
+ * @param heading Heading (deg)
+ * @param timeMs Time of the reading (ms)
+ */
+void PositionPredictor::onHeading(float heading, uint32_t timeMs)
+{
+    const uint32_t elapsed = timeMs - headingTime;
+    if (headingTime == 0 || elapsed >= COMPASS_TIMEOUT)
+        compassYawRate = 0.0f;
+    else if (elapsed > 0)
+    {
+        // Low-pass over about 250 ms, compass headings come in whole degrees
+        const float dt = elapsed / 1000.0f;
+        const float rate = std::clamp(calcAngleDiff(heading, lastHeading) / dt, -MAX_YAW_RATE, MAX_YAW_RATE);
+        compassYawRate += (rate - compassYawRate) * dt / (dt + 0.25f);
+    }
+    else
+        return;
+
+    lastHeading = heading;
+    headingTime = timeMs != 0 ? timeMs : 1;
+}
+
+/**
+ * @brief Yaw rate to extrapolate with, the compass one while it is fed
+ */
+float PositionPredictor::yawRate(uint32_t timeMs) const
+{
+    if (headingTime != 0 && timeMs - headingTime < COMPASS_TIMEOUT)
+        return compassYawRate;
+    return gpsYawRate;
+}
+
+/**
+ * @brief Distance moved since the last fix at constant speed and turn rate
+ *
+ * @param timeMs Time (ms)
+ * @param north North offset (m)
+ * @param east East offset (m)
+ */
+void PositionPredictor::offset(uint32_t timeMs, float &north, float &east) const
+{
+    north = east = 0.0f;
+    if (speed < MIN_SPEED / 3.6f)
+        return;
+
+    const float dt = std::min((int32_t)(timeMs - fixTime) / 1000.0f, MAX_HORIZON);
+    if (dt <= 0.0f)
+        return;
+
+    const float c0 = DEG2RAD(course);
+    const float w = DEG2RAD(yawRate(timeMs));
+    if (fabsf(w * dt) < 1e-3f)
+    {
+        north = speed * dt * cosf(c0);
+        east = speed * dt * sinf(c0);
+    }
+    else
+    {
+        // Arc of radius speed / w, course measured clockwise from north
+        const float c1 = c0 + w * dt;
+        north = speed / w * (sinf(c1) - sinf(c0));
+        east = speed / w * (cosf(c0) - cosf(c1));
+    }
+}
+
+/**
+ * @brief Position to show at a given time
+ *
+ * @param timeMs Time (ms), not before the last fix
+ * @param lat Latitude, unchanged before the first fix
+ * @param lon Longitude, unchanged before the first fix
+ * @return true while the position is still changing (moving or correcting)
+ */
+bool PositionPredictor::predict(uint32_t timeMs, float &lat, float &lon) const
+{
+    if (!valid)
+        return false;
+
+    float north, east;
+    offset(timeMs, north, east);
+    const float elapsed = std::max((int32_t)(timeMs - fixTime), 0) / 1000.0f;
+    const float fade = expf(-elapsed / CORRECTION_TAU);
+    north += corrNorth * fade;
+    east += corrEast * fade;
+
+    lat = fixLat + north / METERS_PER_DEG;
+    lon = fixLon + east / (METERS_PER_DEG * cosf(DEG2RAD(fixLat)));
+    if (lon > 180.0f)
+        lon -= 360.0f;
+    else if (lon < -180.0f)
+        lon += 360.0f;
+
+    const bool moving = speed >= MIN_SPEED / 3.6f && elapsed < MAX_HORIZON;
+    const float corr2 = (corrNorth * corrNorth + corrEast * corrEast) * fade * fade;
+    return moving || corr2 > CORRECTION_DONE * CORRECTION_DONE;
+}
+
+/**
+ * @brief Check if a fix has been received
+ */
+bool PositionPredictor::hasFix() const
+{
+    return valid;
+}
@@ -0,0 +1,59 @@
+/**
+ * @file positionPredictor.hpp
+ * @author Jordi Gauchía (jgauchia@jgauchia.com)
+ * @brief  Dead reckoning of the displayed position between GPS fixes
+ * @version 0.2.5
+ * @date 2026-04
+ *
+ * Platform independent, also built by tools/dead_reckoning.
+ *
+ * The GPS gives a position 1 to 5 times per second, the map is drawn every 30 ms. Between
+ * fixes the position is moved from the last fix with its speed and course, turning at the
+ * yaw rate of the compass (or of the last two GPS courses without one). When a fix arrives,
+ * the gap between the predicted and the new position is not applied at once: it fades out
+ * in CORRECTION_TAU, so the map glides to the fix instead of jumping.
+ */
+
+#pragma once
+
+#include <cstdint>
+
+/**
+ * @class PositionPredictor
+ * @brief Constant speed and turn rate extrapolation of the last GPS fix
+ */
+class PositionPredictor
+{
+public:
+    static constexpr float MIN_SPEED = 2.0f;            /**< Below this speed (km/h) the fix is shown as is */
+    static constexpr float MAX_HORIZON = 2.0f;          /**< Max extrapolation after a fix (s), then the position holds */
+    static constexpr float CORRECTION_TAU = 0.35f;      /**< Time constant of the correction fade (s) */
+    static constexpr float SNAP_DIST = 40.0f;           /**< Corrections longer than this (m) are applied at once */
+    static constexpr float MAX_YAW_RATE = 60.0f;        /**< Yaw rate limit (deg/s) */
+    static constexpr uint32_t COMPASS_TIMEOUT = 1000;   /**< Compass yaw rate is used while fed within this time (ms) */
+
+    PositionPredictor();
+
+    void reset();
+    void onFix(float lat, float lon, float speedKmh, float course, uint32_t timeMs);
+    void onHeading(float heading, uint32_t timeMs);
+    bool predict(uint32_t timeMs, float &lat, float &lon) const;
+    bool hasFix() const;
+
+private:
+    bool valid;                 /**< A fix has been received */
+    float fixLat;               /**< Last fix latitude */
+    float fixLon;               /**< Last fix longitude */
+    float speed;                /**< Last fix speed (m/s) */
+    float course;               /**< Last fix course (deg) */
+    uint32_t fixTime;           /**< Time of the last fix (ms) */
+    float gpsYawRate;           /**< Yaw rate from the last two GPS courses (deg/s) */
+    float compassYawRate;       /**< Filtered compass yaw rate (deg/s) */
+    float lastHeading;          /**< Last compass heading (deg) */
+    uint32_t headingTime;       /**< Time of the last compass heading (ms), 0 if none */
+    float corrNorth;            /**< Prediction error at the last fix, north (m) */
+    float corrEast;             /**< Prediction error at the last fix, east (m) */
+
+    float yawRate(uint32_t timeMs) const;
+    void offset(uint32_t timeMs, float &north, float &east) const;
+};
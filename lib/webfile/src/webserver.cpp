@@ -646,6 +646,26 @@ static esp_err_t del_handler(httpd_req_t *req) { return sendSpiffsImage(req, "/s
 static esp_err_t reb_handler(httpd_req_t *req) { return sendSpiffsImage(req, "/spiffs/reboot.png"); }
 static esp_err_t list_handler(httpd_req_t *req) { return sendSpiffsImage(req, "/spiffs/list.png"); }
 
+/**
+ * @brief SD trace dump output to the HTTP response
+ */
+static void sdtraceWriter(const char *data, size_t len, void *arg)
+{
+    httpd_resp_send_chunk((httpd_req_t *)arg, data, len);
+}
+
+/**
+ * @brief SD access trace download handler
+ */
+static esp_err_t sdtrace_handler(httpd_req_t *req)
+{
+    httpd_resp_set_type(req, "text/plain");
+    httpd_resp_set_hdr(req, "Content-Disposition", "attachment; filename=\"sdtrace.txt\"");
+    storage.dumpTrace(sdtraceWriter, req);
+    httpd_resp_send_chunk(req, NULL, 0);
+    return ESP_OK;
+}
+
 /**
  * @brief Find byte sequence in buffer (like memmem but portable)
  */
@@ -962,6 +982,7 @@ void configureWebServer()
     httpd_uri_t uri_del = { .uri = "/del", .method = HTTP_GET, .handler = del_handler };
     httpd_uri_t uri_reb = { .uri = "/reb", .method = HTTP_GET, .handler = reb_handler };
     httpd_uri_t uri_list = { .uri = "/list", .method = HTTP_GET, .handler = list_handler };
+    httpd_uri_t uri_sdtrace = { .uri = "/sdtrace", .method = HTTP_GET, .handler = sdtrace_handler };
 
     httpd_register_uri_handler(webServer, &uri_root);
     httpd_register_uri_handler(webServer, &uri_status);
@@ -978,6 +999,7 @@ void configureWebServer()
     httpd_register_uri_handler(webServer, &uri_del);
     httpd_register_uri_handler(webServer, &uri_reb);
     httpd_register_uri_handler(webServer, &uri_list);
+    httpd_register_uri_handler(webServer, &uri_sdtrace);
 
     httpd_register_err_handler(webServer, HTTPD_404_NOT_FOUND, notfound_handler);
 
@@ -42,6 +42,9 @@ extern xSemaphoreHandle gpsMutex;
 #include "battery.hpp"
 #include "power.hpp"
 #include "gpxParser.hpp"
+#include "trackSimplify.hpp"
+#include "trackGrid.hpp"
+#include "trackProfile.hpp"
 #include "maps.hpp"
 
 extern Storage storage;
@@ -53,6 +56,10 @@ extern Maps mapView;
 #endif
 
 TrackVector trackData;
+TrackVector navTrack;
+TrackIndexMap navTrackMap;
+TrackGrid trackGrid;
+TrackProfile trackProfile;
 std::vector<TrackSegment> trackIndex;
 std::vector<TurnPoint> turnPoints;
 
@@ -133,13 +140,16 @@ void setup()
     #endif
     initTFT();
     createGpxFolders();
+    waypointStore.open(wptFile);
     mapView.initMap(tft.height() - 27, tft.width());
     loadPreferences();
+    mapView.setFeatureFilter(mapSet.visibleGeoms, mapSet.visibleLayers);
     gps.init();
     initLVGL();
     gps.gpsData.latitude = gps.getLat();
     gps.gpsData.longitude = gps.getLon();
     initGpsTask();
+    initNavTask();
     initSensorTask();
     initGuiTask();
     #ifndef DISABLE_CLI
@@ -175,27 +185,5 @@ void loop()
     if (enableWeb)
         processWebServerTasks();
 
-    if (isTrackLoaded)
-    {
-        if (navSet.simNavigation)
-            gps.simFakeGPS(trackData, 120, 1000);
-
-        if (gps.gpsData.speed != 0)
-        {
-            NavConfig simConfig;
-            simConfig.searchWindow = 150;
-            simConfig.offTrackThreshold = 75.0f;
-            simConfig.maxBackwardJump = 10;
-            static unsigned long lastNavUpdate = 0;
-
-            if (millis() - lastNavUpdate > 100)
-            {
-                lastNavUpdate = millis();
-                updateNavigation(gps.gpsData.latitude, gps.gpsData.longitude, gps.gpsData.heading, gps.gpsData.speed,
-                                trackData, turnPoints, navState, 20, 200, simConfig);
-            }
-        }
-    }
-
     vTaskDelay(pdMS_TO_TICKS(10));
 }
@@ -0,0 +1,362 @@
+/**
+ * @file dead_reckoning_bench.cpp
+ * @brief  Host replay of NMEA recordings through the position predictor
+ *
+ * Replays the RMC sentences of an NMEA recording through lib/utils/src/positionPredictor.cpp
+ * and measures, at the 30 ms frame rate of the map, what the map would show: the position
+ * held at the last fix (before) or the predicted one.
+ *
+ * With no arguments it writes a synthetic recording of a drive (curves, a roundabout, a
+ * stop) at 1 Hz with 2 m of noise, together with 50 Hz compass headings, replays it and
+ * checks the error against the true position and the motion between frames. Also checks
+ * that a stopped receiver does not drift, that a far fix is applied at once and that the
+ * position holds when the fixes stop.
+ *
+ * Build: g++ -O2 -std=c++17 -I../host -I../../lib/utils/src dead_reckoning_bench.cpp
+ *        ../../lib/utils/src/positionPredictor.cpp ../../lib/utils/src/gpsMath.cpp -o dead_reckoning_bench
+ */
+
+#include "positionPredictor.hpp"
+#include "gpsMath.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <string>
+#include <vector>
+
+static uint32_t failures = 0;
+
+static void check(bool condition, const char *what)
+{
+    printf("  %-44s %s\n", what, condition ? "ok" : "FAIL");
+    if (!condition)
+        failures++;
+}
+
+static const float METERS_PER_DEG = 111319.49f;
+static const uint32_t FRAME_MS = 30;     /**< UPDATE_MAINSCR_PERIOD */
+
+/**
+ * @brief Fix read from a RMC sentence
+ */
+struct Fix
+{
+    uint32_t timeMs;
+    float lat;
+    float lon;
+    float speedKmh;
+    float course;
+};
+
+/**
+ * @brief True position of the synthetic drive
+ */
+struct Truth
+{
+    uint32_t timeMs;
+    double lat;
+    double lon;
+    float heading;
+};
+
+/**
+ * @brief Distance in meters between two close positions
+ */
+static float meters(double lat1, double lon1, double lat2, double lon2)
+{
+    const double n = (lat2 - lat1) * METERS_PER_DEG;
+    const double e = (lon2 - lon1) * METERS_PER_DEG * cos(lat1 * M_PI / 180.0);
+    return (float)sqrt(n * n + e * e);
+}
+
+/**
+ * @brief NMEA checksum of the characters between '$' and '*'
+ */
+static uint8_t checksum(const char *s)
+{
+    uint8_t cs = 0;
+    for (s++; *s && *s != '*'; s++)
+        cs ^= (uint8_t)*s;
+    return cs;
+}
+
+/**
+ * @brief Parse a RMC sentence with a valid fix
+ */
+static bool parseRmc(const char *line, Fix &fix)
+{
+    if (line[0] != '$' || strncmp(line + 3, "RMC,", 4) != 0)
+        return false;
+    const char *star = strchr(line, '*');
+    if (!star || (uint8_t)strtoul(star + 1, nullptr, 16) != checksum(line))
+        return false;
+
+    std::vector<std::string> f;
+    std::string field;
+    for (const char *p = line + 7; p < star; p++)
+    {
+        if (*p == ',')
+        {
+            f.push_back(field);
+            field.clear();
+        }
+        else
+            field += *p;
+    }
+    f.push_back(field);
+    if (f.size() < 8 || f[1] != "A" || f[0].size() < 6 || f[2].empty() || f[4].empty())
+        return false;
+
+    const double t = atof(f[0].c_str());
+    const int hms = (int)t;
+    fix.timeMs = (uint32_t)(((hms / 10000) * 3600 + (hms / 100 % 100) * 60 + hms % 100) * 1000 +
+                            lround((t - hms) * 1000));
+    const double lat = atof(f[2].c_str());
+    const double lon = atof(f[4].c_str());
+    fix.lat = (float)((int)(lat / 100) + fmod(lat, 100.0) / 60.0) * (f[3] == "S" ? -1.0f : 1.0f);
+    fix.lon = (float)((int)(lon / 100) + fmod(lon, 100.0) / 60.0) * (f[5] == "W" ? -1.0f : 1.0f);
+    fix.speedKmh = (float)atof(f[6].c_str()) * 1.852f;
+    fix.course = (float)atof(f[7].c_str());
+    return true;
+}
+
+/**
+ * @brief Read the RMC fixes of a NMEA file
+ */
+static bool readNmea(const char *path, std::vector<Fix> &fixes)
+{
+    FILE *f = fopen(path, "r");
+    if (!f)
+        return false;
+    char line[256];
+    Fix fix;
+    while (fgets(line, sizeof(line), f))
+        if (parseRmc(line, fix))
+        {
+            // Past midnight
+            if (!fixes.empty() && fix.timeMs < fixes.back().timeMs)
+                fix.timeMs += 86400000;
+            fixes.push_back(fix);
+        }
+    fclose(f);
+    return true;
+}
+
+/**
+ * @brief Write a RMC sentence
+ */
+static void writeRmc(FILE *f, const Fix &fix)
+{
+    const uint32_t s = fix.timeMs / 1000;
+    const double alat = fabs(fix.lat), alon = fabs(fix.lon);
+    char body[160];
+    snprintf(body, sizeof(body), "$GPRMC,%02u%02u%02u.%02u,A,%02d%09.6f,%c,%03d%09.6f,%c,%.2f,%.1f,180326,,,A",
+             s / 3600 % 24, s / 60 % 60, s % 60, fix.timeMs % 1000 / 10, (int)alat, (alat - (int)alat) * 60.0,
+             fix.lat < 0 ? 'S' : 'N', (int)alon, (alon - (int)alon) * 60.0, fix.lon < 0 ? 'W' : 'E',
+             fix.speedKmh / 1.852f, fix.course);
+    fprintf(f, "%s*%02X\r\n", body, checksum(body));
+}
+
+/**
+ * @brief Synthetic drive sampled every 10 ms: straight, curves, a roundabout, a stop, a straight
+ */
+static std::vector<Truth> drive(uint32_t startMs)
+{
+    std::vector<Truth> truth;
+    double lat = 41.38, lon = 2.17;
+    float heading = 30.0f, speed = 0.0f;
+    for (uint32_t t = 0; t <= 150000; t += 10)
+    {
+        const float s = t / 1000.0f;
+        float target = 50.0f, yaw = 0.0f;
+        if (s > 20.0f && s < 35.0f)
+            yaw = 8.0f * sinf((s - 20.0f) * 0.8f);          // S curves
+        else if (s > 45.0f && s < 60.0f)
+            target = 25.0f, yaw = s > 48.0f && s < 57.0f ? -30.0f : 0.0f;   // roundabout
+        else if (s > 80.0f && s < 100.0f)
+            target = 0.0f;                                   // stop
+        else if (s > 110.0f && s < 125.0f)
+            yaw = 12.0f;                                     // long bend
+        speed += std::clamp(target - speed, -0.08f, 0.04f); // km/h per 10 ms
+        heading = fmodf(heading + yaw * 0.01f + 360.0f, 360.0f);
+        truth.push_back({startMs + t, lat, lon, heading});
+        const double d = speed / 3.6 * 0.01;
+        lat += d * cos(heading * M_PI / 180.0) / METERS_PER_DEG;
+        lon += d * sin(heading * M_PI / 180.0) / (METERS_PER_DEG * cos(lat * M_PI / 180.0));
+    }
+    return truth;
+}
+
+/**
+ * @brief Display error of a replay
+ */
+struct Stats
+{
+    double meanErr = 0;     /**< Mean distance to the true position (m) */
+    float maxErr = 0;       /**< Max distance to the true position (m) */
+    float maxStep = 0;      /**< Max motion between two frames (m) */
+    double nextFixErr = 0;  /**< Mean distance between the position shown just before a fix and the fix (m) */
+};
+
+/**
+ * @brief Replay fixes at the frame rate, with the predictor or holding the last fix
+ *
+ * @param truth True positions (empty for a recording)
+ * @param compass Feed the true heading to the compass input, in whole degrees with an offset
+ */
+static Stats replay(const std::vector<Fix> &fixes, const std::vector<Truth> &truth, bool predict, bool compass)
+{
+    Stats st;
+    if (fixes.size() < 2)
+        return st;
+    PositionPredictor predictor;
+    std::mt19937 rng(3);
+    std::normal_distribution<float> compassNoise(0.0f, 1.0f);
+    size_t next = 0, ti = 0, frames = 0, nextFixCount = 0;
+    float lastLat = 0, lastLon = 0, shownLat = 0, shownLon = 0;
+    bool first = true;
+
+    for (uint32_t t = fixes.front().timeMs; t <= fixes.back().timeMs; t += FRAME_MS)
+    {
+        for (; next < fixes.size() && fixes[next].timeMs <= t; next++)
+        {
+            const Fix &fix = fixes[next];
+            if (next > 0)
+            {
+                float lat = lastLat, lon = lastLon;
+                if (predict)
+                    predictor.predict(fix.timeMs, lat, lon);
+                st.nextFixErr += meters(lat, lon, fix.lat, fix.lon);
+                nextFixCount++;
+            }
+            predictor.onFix(fix.lat, fix.lon, fix.speedKmh, fix.course, fix.timeMs);
+            lastLat = fix.lat;
+            lastLon = fix.lon;
+        }
+
+        while (ti + 1 < truth.size() && truth[ti + 1].timeMs <= t)
+            ti++;
+        if (compass && !truth.empty())
+            predictor.onHeading(roundf(fmodf(truth[ti].heading + 7.0f + compassNoise(rng) + 360.0f, 360.0f)), t);
+
+        float lat = lastLat, lon = lastLon;
+        if (predict)
+            predictor.predict(t, lat, lon);
+        if (!first)
+            st.maxStep = std::max(st.maxStep, meters(shownLat, shownLon, lat, lon));
+        first = false;
+        shownLat = lat;
+        shownLon = lon;
+
+        if (!truth.empty())
+        {
+            const float err = meters(truth[ti].lat, truth[ti].lon, lat, lon);
+            st.meanErr += err;
+            st.maxErr = std::max(st.maxErr, err);
+        }
+        frames++;
+    }
+    st.meanErr /= frames;
+    st.nextFixErr /= std::max<size_t>(nextFixCount, 1);
+    return st;
+}
+
+static void printStats(const char *name, const Stats &st, bool withTruth)
+{
+    if (withTruth)
+        printf("  %-20s error mean %5.2f m max %5.2f m, frame step max %5.2f m, at next fix %5.2f m\n", name,
+               st.meanErr, st.maxErr, st.maxStep, st.nextFixErr);
+    else
+        printf("  %-20s frame step max %5.2f m, at next fix %5.2f m\n", name, st.maxStep, st.nextFixErr);
+}
+
+int main(int argc, char **argv)
+{
+    if (argc > 1)
+    {
+        std::vector<Fix> fixes;
+        if (!readNmea(argv[1], fixes))
+        {
+            perror(argv[1]);
+            return 1;
+        }
+        printf("%s: %u RMC fixes, %.0f s\n", argv[1], (unsigned)fixes.size(),
+               fixes.size() > 1 ? (fixes.back().timeMs - fixes.front().timeMs) / 1000.0 : 0.0);
+        printStats("hold last fix", replay(fixes, {}, false, false), false);
+        printStats("predicted", replay(fixes, {}, true, false), false);
+        return 0;
+    }
+
+    // Synthetic recording at 1 Hz, written and read back as NMEA
+    const std::vector<Truth> truth = drive(12 * 3600000);
+    const char *path = "dead_reckoning_bench.nmea";
+    FILE *f = fopen(path, "w");
+    std::mt19937 rng(11);
+    std::normal_distribution<float> noise(0.0f, 2.0f);
+    for (size_t i = 0; i < truth.size(); i += 100)
+    {
+        const Truth &p = truth[i];
+        const Truth &prev = truth[i > 0 ? i - 1 : 0];
+        const float speed = meters(prev.lat, prev.lon, p.lat, p.lon) / 0.01f * 3.6f;
+        Fix fix = {p.timeMs, (float)(p.lat + noise(rng) / METERS_PER_DEG),
+                   (float)(p.lon + noise(rng) / (METERS_PER_DEG * cos(p.lat * M_PI / 180.0))), speed,
+                   speed > 1.0f ? p.heading : 0.0f};
+        writeRmc(f, fix);
+    }
+    fclose(f);
+
+    std::vector<Fix> fixes;
+    readNmea(path, fixes);
+    remove(path);
+    printf("Synthetic drive: %u RMC fixes at 1 Hz, frames every %u ms\n", (unsigned)fixes.size(), FRAME_MS);
+    const Stats hold = replay(fixes, truth, false, false);
+    const Stats gpsOnly = replay(fixes, truth, true, false);
+    const Stats withCompass = replay(fixes, truth, true, true);
+    printStats("hold last fix", hold, true);
+    printStats("predicted", gpsOnly, true);
+    printStats("predicted + compass", withCompass, true);
+
+    printf("Replay\n");
+    check(fixes.size() == 151, "RMC sentences read back");
+    check(gpsOnly.meanErr < hold.meanErr * 0.5, "mean error halved");
+    check(gpsOnly.maxStep < hold.maxStep * 0.35f, "no jump at the fixes");
+    check(withCompass.meanErr <= gpsOnly.meanErr * 1.05, "compass yaw rate not worse");
+    check(withCompass.nextFixErr < hold.nextFixErr * 0.5, "prediction close to the next fix");
+
+    printf("Edge cases\n");
+    PositionPredictor p;
+    float lat, lon;
+    check(!p.predict(1000, lat, lon), "nothing before the first fix");
+    p.onFix(41.0f, 2.0f, 0.0f, 90.0f, 1000);
+    const bool moving = p.predict(1900, lat, lon);
+    check(!moving && lat == 41.0f && lon == 2.0f, "no drift when stopped");
+
+    p.onFix(41.0f, 2.0f, 36.0f, 90.0f, 2000);
+    p.predict(3000, lat, lon);
+    check(fabsf(meters(41.0, 2.0, lat, lon) - 10.0f) < 0.1f, "10 m east after 1 s at 36 km/h");
+    p.predict(2000 + 10000, lat, lon);
+    const float held = meters(41.0, 2.0, lat, lon);
+    check(fabsf(held - 20.0f) < 0.1f && !p.predict(2000 + 10000, lat, lon), "position holds after the horizon");
+
+    p.onFix(41.001f, 2.0f, 36.0f, 90.0f, 3000);
+    p.predict(3000, lat, lon);
+    check(lat == 41.001f && lon == 2.0f, "far fix applied at once");
+
+    p.onFix(41.001f, 2.00015f, 36.0f, 90.0f, 4000);
+    p.predict(4000, lat, lon);
+    const float before = meters(41.001f, 2.00015f, lat, lon);
+    p.predict(4000 + 3000, lat, lon);
+    check(before > 1.0f && fabsf(meters(41.001f, 2.00015f, lat, lon) - 20.0f) < 0.1f, "near fix corrected smoothly");
+
+    PositionPredictor wrap;
+    wrap.onFix(0.0f, 179.99995f, 36.0f, 90.0f, 0);
+    wrap.predict(1000, lat, lon);
+    check(lon < -179.9999f, "across the antimeridian");
+
+    printf("%s\n", failures ? "FAILED" : "All checks passed");
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,362 @@
+/**
+ * @file gpx_bench.cpp
+ * @brief  Host throughput benchmark and layout checks for the streaming GPX tokenizer
+ *
+ * Writes the same track in the GPX layouts found in the wild and reads each one with
+ * the line parser GPXParser::loadTrack used before (fgets + strstr) and with
+ * lib/gpx/src/gpxTokenizer.cpp. Reports the points found and MB/s, checks that the
+ * tokenizer returns every point with its coordinates, elevation and time for any
+ * block size, and that element text (waypoint names, CDATA, entities) is read back.
+ *
+ * Real GPX files given on the command line are added to the throughput table.
+ *
+ * Build: g++ -O2 -std=c++17 -I../host -I../../lib/gpx/src gpx_bench.cpp ../../lib/gpx/src/gpxTokenizer.cpp -o gpx_bench
+ */
+
+#include "gpxTokenizer.hpp"
+
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <sys/stat.h>
+#include <vector>
+
+using Clock = std::chrono::steady_clock;
+
+static uint32_t failures = 0;
+
+static void check(bool condition, const char *what)
+{
+    printf("  %-52s %s\n", what, condition ? "ok" : "FAIL");
+    if (!condition)
+        failures++;
+}
+
+/**
+ * @brief Reference point as written to the generated files
+ */
+struct RefPoint
+{
+    char lat[16];
+    char lon[16];
+    char ele[16];
+    char time[24];
+};
+
+static std::vector<RefPoint> makeTrack(uint32_t points)
+{
+    std::vector<RefPoint> track(points);
+    double lat = 41.3851;
+    double lon = 2.1734;
+    for (uint32_t i = 0; i < points; i++)
+    {
+        lat += 0.00004 * std::sin(i * 0.002);
+        lon -= 0.00004 * std::cos(i * 0.0031);
+        snprintf(track[i].lat, sizeof(track[i].lat), "%.7f", lat);
+        snprintf(track[i].lon, sizeof(track[i].lon), "%.7f", lon);
+        snprintf(track[i].ele, sizeof(track[i].ele), "%.1f", 120.0 + (i % 300) * 0.5);
+        snprintf(track[i].time, sizeof(track[i].time), "2026-10-18T%02u:%02u:%02uZ", 8 + i / 3600 % 12, i / 60 % 60, i % 60);
+    }
+    return track;
+}
+
+enum Layout
+{
+    LAYOUT_LINES,      /**< One tag per line, as written by IceNav and most apps */
+    LAYOUT_MINIFIED,   /**< Whole document on one line, route planners */
+    LAYOUT_GARMIN,     /**< Indented, CRLF, namespaces and extensions */
+    LAYOUT_SPLIT,      /**< lon before lat, single quotes, attributes over several lines */
+    LAYOUT_COMPACT,    /**< One point per line, comments, CDATA and self-closing waypoints */
+    LAYOUT_COUNT
+};
+
+static const char *layoutNames[LAYOUT_COUNT] = {"lines", "minified", "garmin", "split", "compact"};
+
+/**
+ * @brief Write a track and three named waypoints in the given layout
+ */
+static bool writeGpx(const std::string &path, Layout layout, const std::vector<RefPoint> &track)
+{
+    FILE *f = fopen(path.c_str(), "w");
+    if (!f)
+        return false;
+
+    const char *nl = layout == LAYOUT_MINIFIED ? "" : layout == LAYOUT_GARMIN ? "\r\n" : "\n";
+    const char *in1 = layout == LAYOUT_GARMIN ? "  " : "";
+    const char *in2 = layout == LAYOUT_GARMIN ? "    " : "";
+    const char *in3 = layout == LAYOUT_GARMIN ? "      " : "";
+
+    fprintf(f, "<?xml version=\"1.0\" encoding=\"UTF-8\"?>%s", nl);
+    if (layout == LAYOUT_COMPACT)
+        fprintf(f, "<!-- track_bench <trkpt lat=\"0\" lon=\"0\"/> in a comment -->\n");
+    fprintf(f, "<gpx version=\"1.1\" creator=\"bench\" xmlns=\"http://www.topografix.com/GPX/1/1\" "
+               "xmlns:gpxtpx=\"http://www.garmin.com/xmlschemas/TrackPointExtension/v1\">%s", nl);
+
+    static const char *names[] = {"Start", "Fuente &amp; Mirador", "End"};
+    for (int w = 0; w < 3; w++)
+    {
+        const RefPoint &p = track[w * (track.size() - 1) / 2];
+        if (layout == LAYOUT_COMPACT)
+            fprintf(f, "<wpt lat=\"%s\" lon=\"%s\"><name><![CDATA[%s]]></name><sym/></wpt>\n", p.lat, p.lon, names[w]);
+        else
+            fprintf(f, "%s<wpt lat=\"%s\" lon=\"%s\">%s%s<ele>%s</ele>%s%s<name>%s</name>%s%s</wpt>%s", in1, p.lat, p.lon, nl, in2,
+                    p.ele, nl, in2, names[w], nl, in1, nl);
+    }
+
+    fprintf(f, "%s<trk>%s%s<name>bench</name>%s%s<trkseg>%s", in1, nl, in2, nl, in2, nl);
+    if (layout == LAYOUT_COMPACT)
+        fprintf(f, "<desc><![CDATA[Generated track with <trkpt> text inside CDATA]]></desc>\n");
+    for (const RefPoint &p : track)
+    {
+        switch (layout)
+        {
+        case LAYOUT_LINES:
+            fprintf(f, "<trkpt lat=\"%s\" lon=\"%s\">\n<ele>%s</ele>\n<time>%s</time>\n</trkpt>\n", p.lat, p.lon, p.ele, p.time);
+            break;
+        case LAYOUT_MINIFIED:
+            fprintf(f, "<trkpt lat=\"%s\" lon=\"%s\"><ele>%s</ele><time>%s</time></trkpt>", p.lat, p.lon, p.ele, p.time);
+            break;
+        case LAYOUT_GARMIN:
+            fprintf(f, "%s<trkpt lat=\"%s\" lon=\"%s\">\r\n%s<ele>%s</ele>\r\n%s<time>%s</time>\r\n%s<extensions>\r\n"
+                       "%s  <gpxtpx:TrackPointExtension><gpxtpx:hr>128</gpxtpx:hr><gpxtpx:cad>80</gpxtpx:cad>"
+                       "</gpxtpx:TrackPointExtension>\r\n%s</extensions>\r\n%s</trkpt>\r\n",
+                    in2, p.lat, p.lon, in3, p.ele, in3, p.time, in3, in3, in3, in2);
+            break;
+        case LAYOUT_SPLIT:
+            fprintf(f, "<trkpt\n   lon='%s'\n   lat='%s'\n>\n<ele>%s</ele>\n<time>%s</time>\n</trkpt>\n", p.lon, p.lat, p.ele, p.time);
+            break;
+        case LAYOUT_COMPACT:
+            fprintf(f, "<trkpt lon=\"%s\" lat=\"%s\"><ele>%s</ele><time>%s</time></trkpt>\n", p.lon, p.lat, p.ele, p.time);
+            break;
+        default:
+            break;
+        }
+    }
+    fprintf(f, "%s</trkseg>%s%s</trk>%s</gpx>%s", in2, nl, in1, nl, nl);
+    return fclose(f) == 0;
+}
+
+/**
+ * @brief Track point parser of GPXParser::loadTrack before the tokenizer
+ */
+static size_t lineParser(const std::string &path, std::vector<GpxPoint> &out)
+{
+    out.clear();
+    FILE *file = fopen(path.c_str(), "r");
+    if (!file)
+        return 0;
+    char line[256];
+    while (fgets(line, sizeof(line), file))
+    {
+        if (strstr(line, "<trkpt"))
+        {
+            GpxPoint point = {};
+            bool latFound = false, lonFound = false;
+            auto parseAttrs = [&](char *str) {
+                char *pLat = strstr(str, "lat=\"");
+                if (!pLat)
+                    pLat = strstr(str, "lat='");
+                if (pLat)
+                {
+                    point.lat = strtof(pLat + 5, nullptr);
+                    latFound = true;
+                }
+                char *pLon = strstr(str, "lon=\"");
+                if (!pLon)
+                    pLon = strstr(str, "lon='");
+                if (pLon)
+                {
+                    point.lon = strtof(pLon + 5, nullptr);
+                    lonFound = true;
+                }
+            };
+            parseAttrs(line);
+            while ((!latFound || !lonFound) && fgets(line, sizeof(line), file))
+            {
+                if (strstr(line, ">"))
+                    break;
+                parseAttrs(line);
+            }
+            if (latFound && lonFound)
+                out.push_back(point);
+        }
+    }
+    fclose(file);
+    return out.size();
+}
+
+static size_t tokenizerParser(GpxTokenizer &tokenizer, const std::string &path, std::vector<GpxPoint> &out)
+{
+    out.clear();
+    if (!tokenizer.open(path.c_str()))
+        return 0;
+    GpxPoint point;
+    while (tokenizer.nextPoint("trkpt", point))
+        out.push_back(point);
+    tokenizer.close();
+    return out.size();
+}
+
+/**
+ * @brief List the text of an element inside every occurrence of a tag
+ */
+static std::vector<std::string> elementList(GpxTokenizer &tokenizer, const std::string &path, const char *tag, const char *element)
+{
+    std::vector<std::string> values;
+    if (!tokenizer.open(path.c_str()))
+        return values;
+    bool inTargetTag = false;
+    bool inElement = false;
+    GpxTokenizer::Token token;
+    while ((token = tokenizer.next()) != GpxTokenizer::TOKEN_EOF)
+    {
+        if (token == GpxTokenizer::TOKEN_OPEN)
+        {
+            if (tokenizer.isTag(tag))
+                inTargetTag = true;
+            else if (inTargetTag && tokenizer.isTag(element))
+            {
+                if (tokenizer.isEmptyTag())
+                {
+                    values.push_back(std::string());
+                    inTargetTag = false;
+                }
+                else
+                    inElement = true;
+            }
+        }
+        else if (token == GpxTokenizer::TOKEN_TEXT && inElement)
+        {
+            size_t len;
+            const char *value = tokenizer.getText(len);
+            values.push_back(std::string(value, len));
+            inElement = false;
+            inTargetTag = false;
+        }
+        else if (token == GpxTokenizer::TOKEN_CLOSE && inElement)
+        {
+            values.push_back(std::string());
+            inElement = false;
+            inTargetTag = false;
+        }
+    }
+    tokenizer.close();
+    return values;
+}
+
+static bool samePoints(const std::vector<GpxPoint> &got, const std::vector<RefPoint> &ref)
+{
+    if (got.size() != ref.size())
+        return false;
+    for (size_t i = 0; i < ref.size(); i++)
+    {
+        if (got[i].lat != strtof(ref[i].lat, nullptr) || got[i].lon != strtof(ref[i].lon, nullptr))
+            return false;
+        if (!got[i].hasEle || got[i].ele != strtof(ref[i].ele, nullptr) || strcmp(got[i].time, ref[i].time) != 0)
+            return false;
+    }
+    return true;
+}
+
+static long fileSize(const std::string &path)
+{
+    struct stat st;
+    return stat(path.c_str(), &st) == 0 ? (long)st.st_size : -1;
+}
+
+/**
+ * @brief Best of several runs, in MB/s
+ */
+template <typename F> static double throughput(const std::string &path, int runs, F parse)
+{
+    double best = 1e9;
+    for (int r = 0; r < runs; r++)
+    {
+        auto t0 = Clock::now();
+        parse();
+        best = std::fmin(best, std::chrono::duration<double>(Clock::now() - t0).count());
+    }
+    return fileSize(path) / 1e6 / best;
+}
+
+int main(int argc, char **argv)
+{
+    uint32_t points = 50000;
+    int runs = 5;
+    std::vector<std::string> realFiles;
+    for (int i = 1; i < argc; i++)
+    {
+        std::string arg = argv[i];
+        if (arg == "-n" && i + 1 < argc)
+            points = strtoul(argv[++i], nullptr, 10);
+        else if (arg == "-r" && i + 1 < argc)
+            runs = atoi(argv[++i]);
+        else if (arg == "-h" || arg == "--help")
+        {
+            printf("Usage: %s [-n points] [-r runs] [file.gpx ...]\n", argv[0]);
+            return 0;
+        }
+        else
+            realFiles.push_back(arg);
+    }
+
+    const std::vector<RefPoint> track = makeTrack(points);
+    GpxTokenizer tokenizer;
+    std::vector<GpxPoint> oldPoints;
+    std::vector<GpxPoint> newPoints;
+
+    printf("%-10s %10s %12s %12s %12s %12s\n", "Layout", "Size (KB)", "Old points", "Old MB/s", "New points", "New MB/s");
+    std::vector<std::string> generated;
+    for (int l = 0; l < LAYOUT_COUNT; l++)
+    {
+        const std::string path = std::string("gpx_bench_") + layoutNames[l] + ".gpx";
+        if (!writeGpx(path, (Layout)l, track))
+        {
+            perror(path.c_str());
+            return 1;
+        }
+        generated.push_back(path);
+        const double oldMBs = throughput(path, runs, [&] { lineParser(path, oldPoints); });
+        const double newMBs = throughput(path, runs, [&] { tokenizerParser(tokenizer, path, newPoints); });
+        printf("%-10s %10ld %12zu %12.1f %12zu %12.1f\n", layoutNames[l], fileSize(path) / 1024, oldPoints.size(), oldMBs,
+               newPoints.size(), newMBs);
+    }
+    for (const std::string &path : realFiles)
+    {
+        const double oldMBs = throughput(path, runs, [&] { lineParser(path, oldPoints); });
+        const double newMBs = throughput(path, runs, [&] { tokenizerParser(tokenizer, path, newPoints); });
+        const size_t slash = path.find_last_of('/');
+        printf("%-10.10s %10ld %12zu %12.1f %12zu %12.1f\n", path.substr(slash == std::string::npos ? 0 : slash + 1).c_str(),
+               fileSize(path) / 1024, oldPoints.size(), oldMBs, newPoints.size(), newMBs);
+        if (newPoints.size() < oldPoints.size())
+            printf("  %s: tokenizer found fewer points than the line parser\n", path.c_str());
+    }
+
+    static const size_t blockSizes[] = {GpxTokenizer::BLOCK_SIZE, 4096, 1000, 257, 160};
+    static const char *waypointNames[] = {"Start", "Fuente &amp; Mirador", "End"};
+    for (int l = 0; l < LAYOUT_COUNT; l++)
+    {
+        printf("Layout %s\n", layoutNames[l]);
+        bool allBlocks = true;
+        for (size_t block : blockSizes)
+        {
+            GpxTokenizer small(block);
+            tokenizerParser(small, generated[l], newPoints);
+            allBlocks = allBlocks && samePoints(newPoints, track);
+        }
+        check(allBlocks, "every point, lat/lon/ele/time, any block size");
+
+        const std::vector<std::string> names = elementList(tokenizer, generated[l], "wpt", "name");
+        check(names.size() == 3 && names[0] == waypointNames[0] && names[1] == waypointNames[1] && names[2] == waypointNames[2],
+              "waypoint names");
+        const std::vector<std::string> trackNames = elementList(tokenizer, generated[l], "trk", "name");
+        check(trackNames.size() == 1 && trackNames[0] == "bench", "track name");
+        remove(generated[l].c_str());
+    }
+
+    printf("%s\n", failures ? "FAILED" : "All checks passed");
+    return failures ? 1 : 0;
+}
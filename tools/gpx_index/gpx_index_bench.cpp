@@ -0,0 +1,143 @@
+/**
+ * @file gpx_index_bench.cpp
+ * @brief  Host benchmark and consistency checks for the GPX folder index
+ *
+ * Fills a folder with GPX tracks and times the GPX list update of
+ * lib/gpx/src/gpxIndex.cpp with no index (every file parsed, the cost of each list
+ * opening before the index) and with an up to date index.
+ *
+ * Then checks that only changed or new files are parsed again, that deleted files are
+ * dropped and that a corrupt index is rebuilt.
+ *
+ * Build: g++ -O2 -std=c++17 -I../host -I../../lib/gpx/src -I../../lib/utils/src gpx_index_bench.cpp
+ *        ../../lib/gpx/src/gpxIndex.cpp ../../lib/gpx/src/gpxTokenizer.cpp ../../lib/utils/src/gpsMath.cpp -o gpx_index_bench
+ */
+
+#include "gpxIndex.hpp"
+
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <utime.h>
+
+using Clock = std::chrono::steady_clock;
+
+static uint32_t failures = 0;
+
+static void check(bool condition, const char *what)
+{
+    printf("  %-44s %s\n", what, condition ? "ok" : "FAIL");
+    if (!condition)
+        failures++;
+}
+
+static double elapsedMs(Clock::time_point t0)
+{
+    return std::chrono::duration<double, std::milli>(Clock::now() - t0).count();
+}
+
+/**
+ * @brief Write a GPX file with one named track of two segments and a waypoint
+ */
+static bool writeTrack(const std::string &path, uint32_t id, uint32_t points)
+{
+    FILE *f = fopen(path.c_str(), "w");
+    if (!f)
+        return false;
+    fprintf(f, "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n<gpx version=\"1.1\" creator=\"IceNav\">\n");
+    fprintf(f, "<wpt lat=\"41.0\" lon=\"2.0\"><name>Start %u</name></wpt>\n", id);
+    fprintf(f, "<trk>\n<name>Track %u</name>\n<trkseg>\n", id);
+    for (uint32_t i = 0; i < points; i++)
+    {
+        if (i == points / 2)
+            fprintf(f, "</trkseg>\n<trkseg>\n");
+        fprintf(f, "<trkpt lat=\"%.6f\" lon=\"%.6f\">\n<ele>%u</ele>\n</trkpt>\n", 41.0 + i * 0.0001, 2.0 + id * 0.01,
+                100 + i % 50);
+    }
+    fprintf(f, "</trkseg>\n</trk>\n</gpx>\n");
+    return fclose(f) == 0;
+}
+
+int main(int argc, char **argv)
+{
+    const uint32_t tracks = argc > 1 ? strtoul(argv[1], nullptr, 10) : 200;
+    const uint32_t points = argc > 2 ? strtoul(argv[2], nullptr, 10) : 2000;
+    const std::string folder = "gpx_index_bench_data";
+    const std::string indexPath = folder + "/" + GpxIndex::INDEX_FILE;
+
+    mkdir(folder.c_str(), 0755);
+    remove(indexPath.c_str());
+    for (uint32_t i = 0; i < tracks; i++)
+    {
+        char name[64];
+        snprintf(name, sizeof(name), "%s/track%04u.gpx", folder.c_str(), i);
+        if (!writeTrack(name, i, points))
+        {
+            perror(name);
+            return 1;
+        }
+    }
+
+    GpxIndex index(folder.c_str());
+    auto t0 = Clock::now();
+    index.update();
+    const double buildMs = elapsedMs(t0);
+    const uint32_t firstScanned = index.scanned;
+
+    t0 = Clock::now();
+    index.update();
+    const double cachedMs = elapsedMs(t0);
+
+    struct stat st;
+    stat(indexPath.c_str(), &st);
+    printf("Folder\t\t: %u GPX files of %u points\n", (unsigned)tracks, (unsigned)points);
+    printf("Full scan\t: %.1f ms\n", buildMs);
+    printf("Indexed\t\t: %.2f ms (x%.0f faster), index %ld bytes\n", cachedMs, buildMs / cachedMs, (long)st.st_size);
+
+    printf("Contents\n");
+    check(firstScanned == tracks && index.files.size() == tracks, "all files parsed on the first update");
+    check(index.scanned == 0 && index.reused == tracks, "no file parsed with an up to date index");
+    const GpxFileInfo &first = index.files.front();
+    const float expectedLength = (points - 2) * 0.0001f * 111195.0f;
+    check(first.fileName == "track0000.gpx" && first.points == points && first.waypoints == 1, "file name and counts");
+    check(first.trkNames.size() == 1 && first.trkNames[0] == "Track 0" && first.wptNames.size() == 1 &&
+              first.wptNames[0] == "Start 0",
+          "track and waypoint names");
+    check(std::fabs(first.length - expectedLength) < expectedLength * 0.01f, "track length without segment gap");
+    check(std::fabs(first.minLat - 41.0f) < 1e-5f && std::fabs(first.maxLat - (41.0f + (points - 1) * 0.0001f)) < 1e-4f,
+          "bounding box");
+
+    printf("Incremental\n");
+    writeTrack(folder + "/track0001.gpx", 1, points + 10);
+    const std::string changed = folder + "/track0002.gpx";
+    stat(changed.c_str(), &st);
+    struct utimbuf times = {st.st_mtime + 10, st.st_mtime + 10};
+    utime(changed.c_str(), &times);
+    writeTrack(folder + "/new.gpx", 9999, 100);
+    remove((folder + "/track0003.gpx").c_str());
+    index.update();
+    check(index.scanned == 3 && index.removed == 1 && index.files.size() == tracks, "changed, touched and new files parsed");
+    check(index.files[1].points == points + 10 || index.files[2].points == points + 10, "changed file metadata updated");
+
+    GpxIndex other(folder.c_str());
+    other.update();
+    check(other.scanned == 0 && other.files.size() == index.files.size(), "index file read by a new instance");
+
+    FILE *f = fopen(indexPath.c_str(), "r+b");
+    fseek(f, 40, SEEK_SET);
+    fputc(0x5A, f);
+    fclose(f);
+    other.update();
+    check(other.scanned == other.files.size(), "corrupt index rebuilt");
+
+    for (const GpxFileInfo &info : other.files)
+        remove((folder + "/" + info.fileName).c_str());
+    remove(indexPath.c_str());
+    rmdir(folder.c_str());
+    printf("%s\n", failures ? "FAILED" : "All checks passed");
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,124 @@
+/**
+ * @file Arduino.h
+ * @brief  Host stand-in for the parts of the Arduino core used by NeoGPS, used by tools/nmea_replay
+ */
+
+#pragma once
+
+#include <chrono>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+typedef bool boolean;
+typedef uint8_t byte;
+
+#define PROGMEM
+#define PGM_P const char *
+#define PSTR(s) (s)
+#define pgm_read_byte(addr) (*(const uint8_t *)(addr))
+#define pgm_read_word(addr) (*(const uint16_t *)(addr))
+#define pgm_read_dword(addr) (*(const uint32_t *)(addr))
+#define pgm_read_float(addr) (*(const float *)(addr))
+#define pgm_read_ptr(addr) (*(void *const *)(addr))
+#define strlen_P strlen
+#define strcmp_P strcmp
+#define strncmp_P strncmp
+#define strcpy_P strcpy
+#define strncpy_P strncpy
+#define memcpy_P memcpy
+
+class __FlashStringHelper;
+#define F(s) (reinterpret_cast<const __FlashStringHelper *>(s))
+
+#define DEC 10
+#define HEX 16
+#define OCT 8
+#define BIN 2
+
+inline unsigned long micros()
+{
+    static const auto start = std::chrono::steady_clock::now();
+    return (unsigned long)std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count();
+}
+
+inline unsigned long millis()
+{
+    return micros() / 1000;
+}
+
+/**
+ * @class Print
+ * @brief Character output, as the Arduino core Print
+ */
+class Print
+{
+public:
+    virtual ~Print() {}
+    virtual size_t write(uint8_t c) = 0;
+    virtual size_t write(const uint8_t *buffer, size_t size)
+    {
+        size_t n = 0;
+        while (size--)
+            n += write(*buffer++);
+        return n;
+    }
+    size_t write(const char *str) { return str ? write((const uint8_t *)str, strlen(str)) : 0; }
+    size_t write(const char *buffer, size_t size) { return write((const uint8_t *)buffer, size); }
+
+    size_t print(const __FlashStringHelper *str) { return write((const char *)str); }
+    size_t print(const char str[]) { return write(str); }
+    size_t print(char c) { return write((uint8_t)c); }
+    size_t print(unsigned char n, int base = DEC) { return printNumber((unsigned long)n, base); }
+    size_t print(int n, int base = DEC) { return print((long)n, base); }
+    size_t print(unsigned int n, int base = DEC) { return printNumber((unsigned long)n, base); }
+    size_t print(long n, int base = DEC)
+    {
+        if (base == DEC && n < 0)
+            return write('-') + printNumber((unsigned long)-n, base);
+        return printNumber((unsigned long)n, base);
+    }
+    size_t print(unsigned long n, int base = DEC) { return printNumber(n, base); }
+    size_t print(double n, int digits = 2)
+    {
+        char buf[48];
+        snprintf(buf, sizeof(buf), "%.*f", digits, n);
+        return write(buf);
+    }
+
+    size_t println() { return write("\r\n"); }
+    template <typename T> size_t println(T value) { return print(value) + println(); }
+    template <typename T> size_t println(T value, int format) { return print(value, format) + println(); }
+
+private:
+    size_t printNumber(unsigned long n, int base)
+    {
+        char buf[8 * sizeof(long) + 1];
+        char *str = &buf[sizeof(buf) - 1];
+        *str = '\0';
+        if (base < 2)
+            base = 10;
+        do
+        {
+            const char c = (char)(n % base);
+            n /= base;
+            *--str = c < 10 ? c + '0' : c + 'A' - 10;
+        } while (n);
+        return write(str);
+    }
+};
+
+/**
+ * @class Stream
+ * @brief Character input, as the Arduino core Stream
+ */
+class Stream : public Print
+{
+public:
+    virtual int available() = 0;
+    virtual int read() = 0;
+    virtual int peek() = 0;
+};
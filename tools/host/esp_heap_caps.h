@@ -0,0 +1,21 @@
+/**
+ * @file esp_heap_caps.h
+ * @brief  Host stand-in for the ESP-IDF heap capabilities API, used by the tools benchmarks
+ */
+
+#pragma once
+
+#include <cstdlib>
+
+#define MALLOC_CAP_SPIRAM   (1 << 10)
+#define MALLOC_CAP_INTERNAL (1 << 11)
+#define MALLOC_CAP_DMA      (1 << 3)
+#define MALLOC_CAP_8BIT     (1 << 2)
+
+static inline void *heap_caps_malloc(size_t size, unsigned int) { return malloc(size); }
+static inline void *heap_caps_calloc(size_t n, size_t size, unsigned int) { return calloc(n, size); }
+static inline void *heap_caps_aligned_alloc(size_t alignment, size_t size, unsigned int)
+{
+    return aligned_alloc(alignment, (size + alignment - 1) / alignment * alignment);
+}
+static inline void heap_caps_free(void *ptr) { free(ptr); }
@@ -0,0 +1,15 @@
+/**
+ * @file esp_log.h
+ * @brief  Host stand-in for the ESP-IDF logging macros, used by the tools benchmarks
+ */
+
+#pragma once
+
+#include <cstdio>
+
+#define ESP_LOGE(tag, fmt, ...) fprintf(stderr, "E (%s) " fmt "\n", tag, ##__VA_ARGS__)
+#define ESP_LOGW(tag, fmt, ...) fprintf(stderr, "W (%s) " fmt "\n", tag, ##__VA_ARGS__)
+#define ESP_LOGI(tag, fmt, ...) do { } while (0)
+#define ESP_LOGD(tag, fmt, ...) do { } while (0)
+#define ESP_LOGV(tag, fmt, ...) do { } while (0)
+#define log_v(fmt, ...) do { } while (0)
@@ -0,0 +1,82 @@
+/**
+ * @file FreeRTOS.h
+ * @brief  Host stand-in for the FreeRTOS queues, semaphores and tasks, used by the tools benchmarks
+ *
+ * Queues and semaphores are built on std::mutex and std::condition_variable, tasks are
+ * detached threads. One tick is one millisecond.
+ */
+
+#pragma once
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <cstring>
+#include <deque>
+#include <mutex>
+#include <vector>
+
+typedef uint32_t TickType_t;
+typedef int BaseType_t;
+typedef unsigned int UBaseType_t;
+
+#define pdTRUE 1
+#define pdFALSE 0
+#define pdPASS 1
+#define pdFAIL 0
+#define portMAX_DELAY 0xFFFFFFFFu
+#define pdMS_TO_TICKS(ms) ((TickType_t)(ms))
+#define tskNO_AFFINITY 0x7FFFFFFF
+
+/**
+ * @brief Fixed size item queue, also used as semaphore (items of 0 bytes)
+ */
+struct HostQueue
+{
+    HostQueue(UBaseType_t length, UBaseType_t itemSize) : length(length), itemSize(itemSize) {}
+
+    BaseType_t send(const void *item, TickType_t ticks)
+    {
+        std::unique_lock<std::mutex> lock(m);
+        if (!wait(lock, ticks, [this] { return count < length; }))
+            return pdFALSE;
+        const uint8_t *p = (const uint8_t *)item;
+        if (itemSize)
+            items.insert(items.end(), p, p + itemSize);
+        count++;
+        cv.notify_all();
+        return pdTRUE;
+    }
+
+    BaseType_t receive(void *item, TickType_t ticks)
+    {
+        std::unique_lock<std::mutex> lock(m);
+        if (!wait(lock, ticks, [this] { return count > 0; }))
+            return pdFALSE;
+        if (itemSize)
+        {
+            memcpy(item, items.data(), itemSize);
+            items.erase(items.begin(), items.begin() + itemSize);
+        }
+        count--;
+        cv.notify_all();
+        return pdTRUE;
+    }
+
+    template <typename Pred> bool wait(std::unique_lock<std::mutex> &lock, TickType_t ticks, Pred ready)
+    {
+        if (ticks == portMAX_DELAY)
+        {
+            cv.wait(lock, ready);
+            return true;
+        }
+        return cv.wait_for(lock, std::chrono::milliseconds(ticks), ready);
+    }
+
+    const UBaseType_t length;
+    const UBaseType_t itemSize;
+    UBaseType_t count = 0;
+    std::vector<uint8_t> items;
+    std::mutex m;
+    std::condition_variable cv;
+};
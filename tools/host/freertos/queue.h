@@ -0,0 +1,15 @@
+/**
+ * @file queue.h
+ * @brief  Host stand-in for the FreeRTOS queues, used by the tools benchmarks
+ */
+
+#pragma once
+
+#include "FreeRTOS.h"
+
+typedef HostQueue *QueueHandle_t;
+
+static inline QueueHandle_t xQueueCreate(UBaseType_t length, UBaseType_t itemSize) { return new HostQueue(length, itemSize); }
+static inline BaseType_t xQueueSend(QueueHandle_t q, const void *item, TickType_t ticks) { return q->send(item, ticks); }
+static inline BaseType_t xQueueReceive(QueueHandle_t q, void *item, TickType_t ticks) { return q->receive(item, ticks); }
+static inline void vQueueDelete(QueueHandle_t q) { delete q; }
@@ -0,0 +1,21 @@
+/**
+ * @file semphr.h
+ * @brief  Host stand-in for the FreeRTOS semaphores, used by the tools benchmarks
+ */
+
+#pragma once
+
+#include "FreeRTOS.h"
+
+typedef HostQueue *SemaphoreHandle_t;
+
+static inline SemaphoreHandle_t xSemaphoreCreateBinary() { return new HostQueue(1, 0); }
+static inline SemaphoreHandle_t xSemaphoreCreateMutex()
+{
+    SemaphoreHandle_t s = new HostQueue(1, 0);
+    s->send(nullptr, 0);
+    return s;
+}
+static inline BaseType_t xSemaphoreTake(SemaphoreHandle_t s, TickType_t ticks) { return s->receive(nullptr, ticks); }
+static inline BaseType_t xSemaphoreGive(SemaphoreHandle_t s) { return s->send(nullptr, 0); }
+static inline void vSemaphoreDelete(SemaphoreHandle_t s) { delete s; }
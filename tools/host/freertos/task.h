@@ -0,0 +1,30 @@
+/**
+ * @file task.h
+ * @brief  Host stand-in for the FreeRTOS tasks, used by the tools benchmarks
+ */
+
+#pragma once
+
+#include "FreeRTOS.h"
+#include <pthread.h>
+#include <thread>
+
+typedef std::thread::native_handle_type TaskHandle_t;
+typedef void (*TaskFunction_t)(void *);
+
+static inline BaseType_t xTaskCreatePinnedToCore(TaskFunction_t task, const char *, uint32_t, void *param,
+                                                 UBaseType_t, TaskHandle_t *handle, BaseType_t)
+{
+    std::thread t(task, param);
+    if (handle)
+        *handle = t.native_handle();
+    t.detach();
+    return pdPASS;
+}
+
+/**
+ * @brief Only vTaskDelete(NULL) is supported: the calling task ends
+ */
+static inline void vTaskDelete(void *) { pthread_exit(nullptr); }
+
+static inline void vTaskDelay(TickType_t ticks) { std::this_thread::sleep_for(std::chrono::milliseconds(ticks)); }
@@ -0,0 +1,505 @@
+/**
+ * @file name_index_bench.cpp
+ * @brief  Host benchmark and checks for the place name search index
+ *
+ * Writes synthetic NAV packs (towns with accented and Cyrillic names, streets labelled in
+ * several tiles, other features and labels hidden at their pack zoom), builds the index
+ * with name_index_builder.hpp and checks the scanned places. Then random prefix queries
+ * through lib/maps/src/name_index.cpp are compared with a scan of all the places, and the
+ * query times and block reads are reported. It also checks the name normalization, the
+ * word keys, the ranking and a corrupt index.
+ *
+ * Build: g++ -O2 -std=c++17 -I../host -I../../lib/utils/src -I../../lib/maps/src
+ *        name_index_bench.cpp ../../lib/maps/src/name_index.cpp -o name_index_bench
+ */
+
+#include "name_index_builder.hpp"
+
+#include <chrono>
+#include <cstdlib>
+#include <map>
+#include <random>
+#include <set>
+#include <sys/stat.h>
+
+using Clock = std::chrono::steady_clock;
+
+static uint32_t failures = 0;
+
+static void check(bool condition, const char *what)
+{
+    printf("  %-44s %s\n", what, condition ? "ok" : "FAIL");
+    if (!condition)
+        failures++;
+}
+
+static double elapsedMs(Clock::time_point t0)
+{
+    return std::chrono::duration<double, std::milli>(Clock::now() - t0).count();
+}
+
+static const uint8_t PACK_ZOOMS[] = {8, 10, 12, 14, 16};
+static const uint8_t TOWN_ZOOM = 8;
+static const uint8_t STREET_ZOOM = 14;
+static const double TOWN_SPACING = 0.1;    /**< Town grid (deg) */
+
+/**
+ * @brief Label written in the packs
+ */
+struct Label
+{
+    std::string name;
+    double lat;
+    double lon;
+    uint8_t minZoom;        /**< Min zoom nibble of the feature */
+};
+
+/**
+ * @brief Place expected in the index
+ */
+struct Expected
+{
+    std::string name;
+    double lat;
+    double lon;
+    uint8_t zoom;
+    double tolerance;       /**< Position tolerance (m) */
+};
+
+template <typename T> static void put(std::vector<uint8_t> &out, T value)
+{
+    const uint8_t *b = (const uint8_t *)&value;
+    out.insert(out.end(), b, b + sizeof(T));
+}
+
+/**
+ * @brief Write one NPK2 pack with the labels shown at a zoom and a line per tile
+ */
+static bool writePack(const std::string &path, uint8_t zoom, const std::vector<Label> &labels)
+{
+    const double worldPx = 256.0 * (double)(1u << zoom);
+    std::map<std::pair<uint32_t, uint32_t>, std::vector<std::vector<uint8_t>>> tiles;
+    for (const Label &l : labels)
+    {
+        const double px = (l.lon + 180.0) / 360.0 * worldPx;
+        const double latRad = l.lat * M_PI / 180.0;
+        const double py = (1.0 - log(tan(latRad) + 1.0 / cos(latRad)) / M_PI) / 2.0 * worldPx;
+        const uint32_t x = (uint32_t)(px / 256.0), y = (uint32_t)(py / 256.0);
+        std::vector<uint8_t> f;
+        f.push_back((uint8_t)NavGeomType::Text);
+        put(f, (uint16_t)0);
+        f.push_back((uint8_t)((l.minZoom << 4) | 12));
+        f.push_back(0);
+        f.insert(f.end(), {0, 0, 255, 255});
+        put(f, (uint16_t)1);
+        put(f, (uint16_t)(5 + l.name.size()));
+        put(f, (int16_t)lround((px - x * 256.0) * 16.0));
+        put(f, (int16_t)lround((py - y * 256.0) * 16.0));
+        f.push_back((uint8_t)l.name.size());
+        f.insert(f.end(), l.name.begin(), l.name.end());
+        tiles[{x, y}].push_back(f);
+    }
+
+    struct Entry
+    {
+        uint64_t hilbert;
+        uint32_t offset;
+        uint32_t size;
+    };
+    std::vector<Entry> entries;
+    std::vector<uint8_t> body;
+    const uint32_t headerSize = 32;
+    for (auto &tile : tiles)
+    {
+        // A road before the labels, skipped by the scan
+        std::vector<uint8_t> line = {(uint8_t)NavGeomType::LineString, 0, 0, 0x5A, 2, 0, 0, 10, 10};
+        put(line, (uint16_t)2);
+        put(line, (uint16_t)8);
+        line.insert(line.end(), 8, 0);
+        tile.second.insert(tile.second.begin(), line);
+
+        std::vector<uint8_t> data = {'N', 'A', 'V', '1'};
+        put(data, (uint16_t)tile.second.size());
+        data.resize(22, 0);
+        for (const std::vector<uint8_t> &f : tile.second)
+            data.insert(data.end(), f.begin(), f.end());
+        entries.push_back({NavReader::xyToHilbert(tile.first.first, tile.first.second, zoom),
+                           (uint32_t)(headerSize + body.size()), (uint32_t)data.size()});
+        body.insert(body.end(), data.begin(), data.end());
+    }
+    std::sort(entries.begin(), entries.end(), [](const Entry &a, const Entry &b) { return a.hilbert < b.hilbert; });
+
+    std::vector<uint8_t> header = {'N', 'P', 'K', '2', zoom};
+    put(header, (uint32_t)entries.size());
+    put(header, (uint32_t)(headerSize + body.size()));
+    header.resize(headerSize, 0);
+
+    FILE *f = fopen(path.c_str(), "wb");
+    if (!f)
+        return false;
+    fwrite(header.data(), 1, header.size(), f);
+    fwrite(body.data(), 1, body.size(), f);
+    fwrite(entries.data(), sizeof(Entry), entries.size(), f);
+    return fclose(f) == 0;
+}
+
+/**
+ * @brief Synthetic region: towns on a grid, streets around each town
+ */
+static void makeRegion(int towns, int streetsPerTown, std::vector<Label> &labels, std::vector<Expected> &expected)
+{
+    static const char *const FIXED[] = {"L'Hospitalet de Llobregat", "Àvila", "Málaga", "Köln", "Zürich",
+                                        "Saint-Étienne", "Łódź", "Москва", "Санкт-Петербург", "Sant Cugat del Vallès",
+                                        "Sant Boi", "Sant Feliu", "Santa Coloma", "Cœur-sur-Mer", "Großbach"};
+    static const char *const HEADS[] = {"Sant ", "Santa ", "Vila", "Torre", "Castell", "Mont", "Font", "Riu", "Pla ", ""};
+    static const char *const ROOTS[] = {"bo", "ra", "ller", "lles", "gat", "vent", "pol", "nou", "marí", "ès",
+                                        "cal", "deu", "sol", "vall", "roc", "mar", "fort", "blanc", "negre", "alt"};
+    static const char *const TYPES[] = {"Carrer de ", "Carrer del ", "Avinguda ", "Calle ", "Passeig de ", "Plaça "};
+    static const char *const STREETS[] = {"Balmes", "Major", "Mallorca", "Aragó", "Sant Joan", "Sant Pere", "Pau Casals",
+                                          "la Pau", "Sol", "Lluna", "Mar", "Muntanya", "Riera", "Església", "Estació",
+                                          "Moli", "Font", "Indústria", "Comerç", "Santa Anna", "Verdaguer", "Mossèn Cinto"};
+
+    std::mt19937 rng(7);
+    const int side = (int)ceil(sqrt((double)towns));
+    for (int t = 0; t < towns; t++)
+    {
+        const double lat = 40.5 + (t / side) * TOWN_SPACING + std::uniform_real_distribution<double>(-0.02, 0.02)(rng);
+        const double lon = 0.5 + (t % side) * TOWN_SPACING + std::uniform_real_distribution<double>(-0.02, 0.02)(rng);
+        std::string town;
+        if (t < (int)(sizeof(FIXED) / sizeof(FIXED[0])))
+            town = FIXED[t];
+        else
+        {
+            town = HEADS[rng() % 10];
+            for (int s = 0; s < 1 + (int)(rng() % 2); s++)
+                town += ROOTS[rng() % 20];
+            if (town[0] >= 'a')
+                town[0] -= 32;
+        }
+        labels.push_back({town, lat, lon, TOWN_ZOOM});
+        expected.push_back({town, lat, lon, TOWN_ZOOM, 30.0});
+
+        std::set<std::string> used;
+        if (t < 2)
+        {
+            // Carrer de Balmes in the first two towns, for the ranking check
+            used.insert("Carrer de Balmes");
+            labels.push_back({"Carrer de Balmes", lat + 0.003, lon + 0.003, STREET_ZOOM});
+            expected.push_back({"Carrer de Balmes", lat + 0.003, lon + 0.003, STREET_ZOOM, 5.0});
+        }
+        for (int s = 0; s < streetsPerTown; s++)
+        {
+            std::string street = TYPES[rng() % 6];
+            if (rng() % 4 == 0)
+                street += STREETS[rng() % 22];
+            else
+            {
+                std::string name = ROOTS[rng() % 20];
+                for (int r = 0; r < 1 + (int)(rng() % 2); r++)
+                    name += ROOTS[rng() % 20];
+                name[0] -= 32;
+                street += name;
+            }
+            if (!used.insert(street).second)
+                continue;
+            const double sLat = lat + std::uniform_real_distribution<double>(-0.006, 0.006)(rng);
+            const double sLon = lon + std::uniform_real_distribution<double>(-0.006, 0.006)(rng);
+            labels.push_back({street, sLat, sLon, STREET_ZOOM});
+            // Long streets are labelled twice, 300 m apart
+            const bool twice = rng() % 3 == 0;
+            if (twice)
+                labels.push_back({street, sLat + 0.0027, sLon, STREET_ZOOM});
+            expected.push_back({street, sLat, sLon, STREET_ZOOM, twice ? 350.0 : 5.0});
+        }
+    }
+}
+
+/**
+ * @brief Search by scanning all the places, ranked like NameIndex::search
+ */
+static std::vector<PlaceResult> bruteSearch(const std::vector<NameIndexBuilder::Place> &places, const char *query,
+                                            float refLat, float refLon, size_t &matches)
+{
+    char q[NameIndex::MAX_KEY + 1];
+    const size_t qLen = NameIndex::normalize(query, q, sizeof(q));
+    struct Match
+    {
+        PlaceResult place;
+        bool exact;
+        float dist2;
+    };
+    std::vector<Match> found;
+    const float kLon = cosf(refLat * (float)M_PI / 180.0f);
+    for (const NameIndexBuilder::Place &p : places)
+    {
+        bool match = false, exact = false;
+        for (const std::string &key : NameIndexBuilder::placeKeys(p.key))
+        {
+            if (qLen > 0 && key.compare(0, qLen, q) == 0)
+            {
+                match = true;
+                exact |= key.size() == qLen;
+            }
+        }
+        if (!match)
+            continue;
+        Match m;
+        snprintf(m.place.name, sizeof(m.place.name), "%s", p.name.c_str());
+        m.place.lat = p.lat * 1e-7f;
+        m.place.lon = p.lon * 1e-7f;
+        m.place.zoom = p.zoom;
+        m.exact = exact;
+        const float dy = (m.place.lat - refLat) * 111319.49f;
+        const float dx = (m.place.lon - refLon) * 111319.49f * kLon;
+        m.dist2 = dx * dx + dy * dy;
+        found.push_back(m);
+    }
+    std::sort(found.begin(), found.end(), [](const Match &a, const Match &b) {
+        if (a.exact != b.exact)
+            return a.exact;
+        if (a.place.zoom != b.place.zoom)
+            return a.place.zoom < b.place.zoom;
+        if (a.dist2 != b.dist2)
+            return a.dist2 < b.dist2;
+        const int byName = strcmp(a.place.name, b.place.name);
+        return byName != 0 ? byName < 0 : a.place.lat < b.place.lat;
+    });
+    matches = found.size();
+    std::vector<PlaceResult> out;
+    for (const Match &m : found)
+        out.push_back(m.place);
+    return out;
+}
+
+static bool sameResults(const std::vector<PlaceResult> &a, const std::vector<PlaceResult> &b)
+{
+    if (a.size() != b.size())
+        return false;
+    for (size_t i = 0; i < a.size(); i++)
+        if (strcmp(a[i].name, b[i].name) != 0 || a[i].lat != b[i].lat || a[i].lon != b[i].lon || a[i].zoom != b[i].zoom)
+            return false;
+    return true;
+}
+
+static bool normalizes(const char *text, const char *key)
+{
+    char out[NameIndex::MAX_KEY + 1];
+    NameIndex::normalize(text, out, sizeof(out));
+    if (strcmp(out, key) != 0)
+        printf("    \"%s\" -> \"%s\", expected \"%s\"\n", text, out, key);
+    return strcmp(out, key) == 0;
+}
+
+static bool finds(NameIndex &index, const char *query, const char *name)
+{
+    std::vector<PlaceResult> out;
+    index.search(query, 40.5f, 0.5f, 50, out);
+    return std::any_of(out.begin(), out.end(), [&](const PlaceResult &r) { return strcmp(r.name, name) == 0; });
+}
+
+int main(int argc, char **argv)
+{
+    const int towns = argc > 1 ? atoi(argv[1]) : 1500;
+    const int queries = argc > 2 ? atoi(argv[2]) : 3000;
+    const std::string folder = "/tmp/name_index_bench";
+    mkdir(folder.c_str(), 0755);
+    const std::string indexPath = folder + "/names.idx";
+
+    printf("Checks\n");
+    {
+        std::mt19937 rng(3);
+        bool roundTrip = true;
+        for (int i = 0; i < 20000 && roundTrip; i++)
+        {
+            const uint8_t z = (uint8_t)(rng() % 21);
+            const uint32_t x = z ? rng() % (1u << z) : 0, y = z ? rng() % (1u << z) : 0;
+            uint32_t bx, by;
+            NameIndexBuilder::hilbertToXY(NavReader::xyToHilbert(x, y, z), z, bx, by);
+            roundTrip = bx == x && by == y;
+        }
+        check(roundTrip, "Hilbert index to tile x,y");
+    }
+    check(normalizes("  Sant Cugat   del Vallès ", "sant cugat del valles") && normalizes("Àvila", "avila") &&
+              normalizes("L'Hospitalet de Llobregat", "l hospitalet de llobregat") &&
+              normalizes("Großbach", "grossbach") && normalizes("Cœur-sur-Mer", "coeur sur mer") &&
+              normalizes("Łódź", "lodz") && normalizes("Saint-Étienne", "saint etienne") &&
+              normalizes("Москва", "москва") && normalizes("ΑΘΗΝΑ", "αθηνα") && normalizes("C/ Major, 12", "c major 12") &&
+              normalizes("!?", ""),
+          "name normalization");
+    {
+        char small[8];
+        const size_t len = NameIndex::normalize("Москва", small, sizeof(small));
+        check(len == 6 && strcmp(small, "мос") == 0, "normalization cut on a character");
+    }
+
+    std::vector<Label> labels;
+    std::vector<Expected> expected;
+    makeRegion(towns, 40, labels, expected);
+    labels.push_back({"Hidden Place", 40.52, 0.52, 15});
+
+    bool written = true;
+    for (uint8_t z : PACK_ZOOMS)
+    {
+        std::vector<Label> shown;
+        for (const Label &l : labels)
+            if (l.minZoom == 15 ? z == 14 : l.minZoom <= z)
+                shown.push_back(l);
+        written &= writePack(folder + "/Z" + std::to_string(z) + ".nav", z, shown);
+    }
+    check(written, "packs written");
+
+    NameIndexBuilder builder;
+    NameIndexBuilder::Stats stats;
+    std::string error;
+    Clock::time_point t0 = Clock::now();
+    builder.scanFolder(folder, stats, error);
+    const bool built = error.empty() && builder.write(indexPath.c_str(), 64, stats);
+    const double buildMs = elapsedMs(t0);
+    check(built, "index built");
+    printf("    %u packs, %u tiles, %u labels, %zu places, %u keys, %u blocks, %zu bytes in %.0f ms\n", stats.packs,
+           stats.tiles, stats.labels, builder.places.size(), stats.keys, stats.blocks, stats.bytes, buildMs);
+
+    {
+        std::map<std::string, std::vector<const NameIndexBuilder::Place *>> byName;
+        for (const NameIndexBuilder::Place &p : builder.places)
+            byName[p.name].push_back(&p);
+        uint32_t missing = 0;
+        for (const Expected &e : expected)
+        {
+            bool found = false;
+            for (const NameIndexBuilder::Place *p : byName[e.name])
+                found |= p->zoom == e.zoom &&
+                         NameIndexBuilder::distance(e.lat, e.lon, p->lat * 1e-7, p->lon * 1e-7) < e.tolerance;
+            if (!found && missing++ < 5)
+                printf("    missing %s\n", e.name.c_str());
+        }
+        check(builder.places.size() == expected.size() && missing == 0, "places scanned once at their lowest zoom");
+        check(byName.count("Hidden Place") == 0, "label hidden at its pack zoom skipped");
+    }
+
+    NameIndex index;
+    check(index.open(indexPath.c_str()) && index.nameCount() == stats.keys, "index opened");
+
+    {
+        std::mt19937 rng(5);
+        uint32_t compared = 0, capped = 0, mismatches = 0;
+        for (int i = 0; i < queries; i++)
+        {
+            const NameIndexBuilder::Place &p = builder.places[rng() % builder.places.size()];
+            const std::vector<std::string> keys = NameIndexBuilder::placeKeys(p.key);
+            const std::string &key = keys[rng() % keys.size()];
+            size_t len = std::min<size_t>(key.size(), 2 + rng() % 8);
+            while (len < key.size() && ((uint8_t)key[len] & 0xC0) == 0x80)
+                len++;
+            const std::string query = key.substr(0, len);
+            const float refLat = 40.5f + (rng() % 1000) * 0.004f, refLon = 0.5f + (rng() % 1000) * 0.004f;
+
+            size_t matches;
+            const std::vector<PlaceResult> expect = bruteSearch(builder.places, query.c_str(), refLat, refLon, matches);
+            if (matches > NameIndex::MAX_CANDIDATES)
+            {
+                capped++;
+                continue;
+            }
+            std::vector<PlaceResult> out;
+            index.search(query.c_str(), refLat, refLon, NameIndex::MAX_CANDIDATES, out);
+            compared++;
+            if (!sameResults(out, expect))
+            {
+                if (mismatches++ < 5)
+                    printf("    \"%s\": %zu results, expected %zu\n", query.c_str(), out.size(), expect.size());
+            }
+        }
+        printf("    %u queries compared, %u over %zu matches\n", compared, capped, NameIndex::MAX_CANDIDATES);
+        check(mismatches == 0 && compared > 0, "random prefixes match the scan of all places");
+    }
+
+    check(finds(index, "balm", "Carrer de Balmes") && finds(index, "hospitalet", "L'Hospitalet de Llobregat") &&
+              finds(index, "AVILA", "Àvila") && finds(index, "МОСК", "Москва") &&
+              finds(index, "петер", "Санкт-Петербург") && finds(index, "sant cugat del", "Sant Cugat del Vallès"),
+          "word keys and folded queries");
+    {
+        std::vector<PlaceResult> out;
+        index.search("carrer de balmes", 40.503f, 0.5f + (float)TOWN_SPACING, 10, out);
+        const bool nearest = out.size() >= 2 && strcmp(out[0].name, "Carrer de Balmes") == 0 &&
+                             fabsf(out[0].lon - (0.5f + (float)TOWN_SPACING)) < 0.03f;
+        index.search("sant", 40.5f, 0.5f, 10, out);
+        const bool towns = out.size() == 10 && out[0].zoom == TOWN_ZOOM;
+        index.search("balmes", 40.5f, 0.5f, 10, out);
+        const bool exact = !out.empty() && strcmp(out[0].name, "Carrer de Balmes") == 0;
+        check(nearest && towns && exact, "ranking: bigger, then nearest places");
+    }
+    {
+        std::vector<PlaceResult> out;
+        const bool empty = index.search("", 40.5f, 0.5f, 10, out) == 0 && index.search("'-", 40.5f, 0.5f, 10, out) == 0 &&
+                           index.search("zzzz", 40.5f, 0.5f, 10, out) == 0;
+        check(empty && index.search("c", 40.5f, 0.5f, 7, out) == 7, "empty queries and max results");
+    }
+
+    {
+        std::mt19937 rng(9);
+        std::vector<PlaceResult> out;
+        const uint32_t reads0 = index.blockReads;
+        double worstMs = 0;
+        t0 = Clock::now();
+        const int timed = 2000;
+        for (int i = 0; i < timed; i++)
+        {
+            const NameIndexBuilder::Place &p = builder.places[rng() % builder.places.size()];
+            const std::string query = p.key.substr(0, std::min<size_t>(p.key.size(), 3 + rng() % 5));
+            const Clock::time_point q0 = Clock::now();
+            index.search(query.c_str(), 40.5f, 0.5f, 10, out);
+            worstMs = std::max(worstMs, elapsedMs(q0));
+        }
+        printf("    %d searches: %.3f ms average, %.3f ms worst, %.2f blocks read per search\n", timed,
+               elapsedMs(t0) / timed, worstMs, (double)(index.blockReads - reads0) / timed);
+
+        NameIndex cold;
+        cold.open(indexPath.c_str());
+        cold.search("carrer de balmes", 40.5f, 0.5f, 10, out);
+        printf("    cold exact search: %u blocks read of %u\n", cold.blockReads, stats.blocks);
+        check(cold.blockReads <= 3, "exact search reads few blocks");
+    }
+
+    {
+        std::vector<uint8_t> bytes;
+        FILE *f = fopen(indexPath.c_str(), "rb");
+        fseek(f, 0, SEEK_END);
+        bytes.resize(ftell(f));
+        fseek(f, 0, SEEK_SET);
+        fread(bytes.data(), 1, bytes.size(), f);
+        fclose(f);
+        uint32_t indexOffset;
+        memcpy(&indexOffset, bytes.data() + 20, 4);
+
+        const std::string bad = folder + "/bad.idx";
+        auto writeBad = [&](const std::vector<uint8_t> &data) {
+            FILE *out = fopen(bad.c_str(), "wb");
+            fwrite(data.data(), 1, data.size(), out);
+            fclose(out);
+        };
+        NameIndex corrupt;
+        std::vector<uint8_t> copy = bytes;
+        copy[indexOffset + 12] ^= 0x20;
+        writeBad(copy);
+        const bool badIndex = !corrupt.open(bad.c_str());
+        writeBad(std::vector<uint8_t>(bytes.begin(), bytes.begin() + indexOffset + 10));
+        const bool truncated = !corrupt.open(bad.c_str());
+        check(badIndex && truncated && !corrupt.open((folder + "/none.idx").c_str()), "corrupt or missing index rejected");
+
+        // Shared key bytes beyond the previous key in the first entry of each block
+        copy = bytes;
+        for (size_t b = 0; b < stats.blocks; b++)
+        {
+            uint32_t offset;
+            memcpy(&offset, bytes.data() + indexOffset + b * 32, 4);
+            copy[offset + 2] = 60;
+        }
+        writeBad(copy);
+        std::vector<PlaceResult> out;
+        check(corrupt.open(bad.c_str()) && corrupt.search("carrer", 40.5f, 0.5f, 10, out) == 0, "corrupt block not used");
+    }
+
+    printf("%s\n", failures ? "FAILED" : "All checks passed");
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,44 @@
+/**
+ * @file name_index_build.cpp
+ * @brief  Build the place name search index of a NAVMAP folder
+ *
+ * Build: g++ -O2 -std=c++17 -I../host -I../../lib/utils/src -I../../lib/maps/src name_index_build.cpp ../../lib/maps/src/name_index.cpp -o name_index_build
+ */
+
+#include "name_index_builder.hpp"
+
+#include <cstdlib>
+
+int main(int argc, char **argv)
+{
+    if (argc < 2)
+    {
+        fprintf(stderr, "Usage: %s <NAVMAP folder> [names.idx] [block entries]\n", argv[0]);
+        return 2;
+    }
+    const std::string folder = argv[1];
+    const std::string out = argc > 2 ? argv[2] : folder + "/names.idx";
+    const int blockEntries = argc > 3 ? atoi(argv[3]) : 64;
+    if (blockEntries < 1 || blockEntries > 65535)
+    {
+        fprintf(stderr, "Block entries must be 1-65535\n");
+        return 2;
+    }
+
+    NameIndexBuilder builder;
+    NameIndexBuilder::Stats stats;
+    std::string error;
+    if (builder.scanFolder(folder, stats, error) == 0 || !error.empty())
+    {
+        fprintf(stderr, "%s\n", error.empty() ? (folder + ": no Z<zoom>.nav packs").c_str() : error.c_str());
+        return 1;
+    }
+    if (!builder.write(out.c_str(), (uint16_t)blockEntries, stats))
+    {
+        perror(out.c_str());
+        return 1;
+    }
+    printf("%s: %u packs, %u tiles, %u labels, %zu places, %u keys, %u blocks, %zu bytes\n", out.c_str(),
+           stats.packs, stats.tiles, stats.labels, builder.places.size(), stats.keys, stats.blocks, stats.bytes);
+    return 0;
+}
@@ -0,0 +1,368 @@
+/**
+ * @file name_index_builder.hpp
+ * @brief  Host builder of the place name search index (lib/maps/src/name_index.hpp) from NAV packs
+ *
+ * Scans the Text features of the packs of a NAVMAP folder (Z<zoom>.nav, NPK2). A label
+ * found at several zooms or in neighbour tiles is one place, kept with the lowest zoom it
+ * is shown at and its position at that zoom.
+ */
+
+#pragma once
+
+#include "name_index.hpp"
+#include "nav_reader.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+class NameIndexBuilder
+{
+public:
+    static constexpr double SAME_PLACE_DIST = 1000.0;  /**< Labels of a name closer than this are one place (m) */
+    static constexpr uint8_t MAX_ZOOM = 20;             /**< Highest pack zoom scanned */
+    static constexpr size_t MIN_WORD = 3;               /**< Shortest word with its own key */
+
+    /**
+     * @brief Place found in the packs
+     */
+    struct Place
+    {
+        std::string name;   /**< Label, UTF-8 */
+        std::string key;    /**< Normalized name */
+        int32_t lat;        /**< 1e-7 deg */
+        int32_t lon;        /**< 1e-7 deg */
+        uint8_t zoom;       /**< Lowest zoom the label is shown at */
+    };
+
+    /**
+     * @brief Scan and index counters
+     */
+    struct Stats
+    {
+        uint32_t packs = 0;
+        uint32_t tiles = 0;
+        uint32_t labels = 0;
+        uint32_t keys = 0;
+        uint32_t blocks = 0;
+        size_t bytes = 0;
+    };
+
+    std::vector<Place> places;
+
+    /**
+     * @brief Tile x,y of a Hilbert index, inverse of NavReader::xyToHilbert
+     */
+    static void hilbertToXY(uint64_t d, uint8_t z, uint32_t &x, uint32_t &y)
+    {
+        x = y = 0;
+        for (uint32_t s = 1; s < (1u << z); s *= 2)
+        {
+            const uint32_t rx = 1 & (uint32_t)(d / 2);
+            const uint32_t ry = 1 & (uint32_t)(d ^ rx);
+            if (ry == 0)
+            {
+                if (rx == 1)
+                {
+                    x = s - 1 - x;
+                    y = s - 1 - y;
+                }
+                std::swap(x, y);
+            }
+            x += s * rx;
+            y += s * ry;
+            d /= 4;
+        }
+    }
+
+    /**
+     * @brief Scan the packs of a NAVMAP folder
+     * @return Packs scanned
+     */
+    uint32_t scanFolder(const std::string &folder, Stats &stats, std::string &error)
+    {
+        for (uint8_t z = 0; z <= MAX_ZOOM; z++)
+        {
+            char path[512];
+            snprintf(path, sizeof(path), "%s/Z%u.nav", folder.c_str(), z);
+            FILE *f = fopen(path, "rb");
+            if (!f)
+                continue;
+            const bool ok = scanPack(f, z, stats);
+            fclose(f);
+            if (!ok)
+            {
+                error = std::string(path) + ": invalid pack";
+                return stats.packs;
+            }
+            stats.packs++;
+        }
+        return stats.packs;
+    }
+
+    /**
+     * @brief Scan the Text features of a pack
+     * @return false if the pack is invalid
+     */
+    bool scanPack(FILE *f, uint8_t zoom, Stats &stats)
+    {
+        char magic[4];
+        uint8_t fileZoom;
+        uint32_t tileCount, indexOff;
+        if (fread(magic, 4, 1, f) != 1 || memcmp(magic, "NPK2", 4) != 0 || fread(&fileZoom, 1, 1, f) != 1 ||
+            fileZoom != zoom || fread(&tileCount, 4, 1, f) != 1 || fread(&indexOff, 4, 1, f) != 1)
+            return false;
+
+        struct Entry
+        {
+            uint64_t hilbert;
+            uint32_t offset;
+            uint32_t size;
+        };
+        std::vector<Entry> entries(tileCount);
+        if (fseek(f, indexOff, SEEK_SET) != 0 || fread(entries.data(), sizeof(Entry), tileCount, f) != tileCount)
+            return false;
+
+        std::vector<uint8_t> data;
+        for (const Entry &e : entries)
+        {
+            data.resize(e.size);
+            if (fseek(f, e.offset, SEEK_SET) != 0 || fread(data.data(), 1, e.size, f) != e.size)
+                return false;
+            uint32_t x, y;
+            hilbertToXY(e.hilbert, zoom, x, y);
+            scanTile(data, x, y, zoom, stats);
+            stats.tiles++;
+        }
+        return true;
+    }
+
+    /**
+     * @brief Add a label shown from a zoom
+     */
+    void addLabel(const char *name, double lat, double lon, uint8_t zoom)
+    {
+        char key[NameIndex::MAX_KEY + 1];
+        if (NameIndex::normalize(name, key, sizeof(key)) == 0)
+            return;
+
+        std::vector<uint32_t> &same = byKey[key];
+        for (uint32_t i : same)
+        {
+            Place &p = places[i];
+            if (distance(lat, lon, p.lat * 1e-7, p.lon * 1e-7) < SAME_PLACE_DIST)
+            {
+                if (zoom < p.zoom)
+                {
+                    p.lat = (int32_t)llround(lat * 1e7);
+                    p.lon = (int32_t)llround(lon * 1e7);
+                    p.zoom = zoom;
+                }
+                return;
+            }
+        }
+        same.push_back((uint32_t)places.size());
+        places.push_back({utf8Prefix(name, sizeof(PlaceResult::name) - 1), key, (int32_t)llround(lat * 1e7),
+                          (int32_t)llround(lon * 1e7), zoom});
+    }
+
+    /**
+     * @brief Search keys of a place: the name, then the name from each word of MIN_WORD or more bytes
+     */
+    static std::vector<std::string> placeKeys(const std::string &key)
+    {
+        std::vector<std::string> keys{key};
+        for (size_t start = key.find(' '); start != std::string::npos; start = key.find(' ', start))
+        {
+            start++;
+            const size_t end = key.find(' ', start);
+            const size_t len = (end == std::string::npos ? key.size() : end) - start;
+            if (len >= MIN_WORD)
+                keys.push_back(key.substr(start));
+        }
+        return keys;
+    }
+
+    /**
+     * @brief Write the index
+     * @return false on a write error
+     */
+    bool write(const char *path, uint16_t blockEntries, Stats &stats)
+    {
+        struct Key
+        {
+            std::string key;
+            uint32_t place;
+            bool word;
+        };
+        std::vector<Key> keys;
+        for (uint32_t i = 0; i < places.size(); i++)
+        {
+            const std::vector<std::string> k = placeKeys(places[i].key);
+            for (size_t j = 0; j < k.size(); j++)
+                keys.push_back({k[j], i, j > 0});
+        }
+        std::sort(keys.begin(), keys.end(), [&](const Key &a, const Key &b) {
+            if (a.key != b.key)
+                return a.key < b.key;
+            if (places[a.place].zoom != places[b.place].zoom)
+                return places[a.place].zoom < places[b.place].zoom;
+            return places[a.place].name < places[b.place].name;
+        });
+
+        FILE *f = fopen(path, "wb");
+        if (!f)
+            return false;
+
+        struct BlockInfo
+        {
+            uint32_t offset;
+            uint32_t size;
+            char firstKey[NameIndex::KEY_PREFIX];
+        };
+        std::vector<BlockInfo> index;
+        std::vector<uint8_t> block;
+        uint8_t header[32] = {};
+        fwrite(header, sizeof(header), 1, f);
+        uint32_t offset = sizeof(header);
+
+        for (size_t first = 0; first < keys.size(); first += blockEntries)
+        {
+            const size_t count = std::min<size_t>(blockEntries, keys.size() - first);
+            BlockInfo info = {};
+            info.offset = offset;
+            memcpy(info.firstKey, keys[first].key.data(), std::min(keys[first].key.size(), NameIndex::KEY_PREFIX));
+
+            block.clear();
+            put(block, (uint16_t)count);
+            const std::string *prev = nullptr;
+            for (size_t i = first; i < first + count; i++)
+            {
+                const std::string &key = keys[i].key;
+                const Place &p = places[keys[i].place];
+                size_t shared = 0;
+                while (prev && shared < prev->size() && shared < key.size() && (*prev)[shared] == key[shared])
+                    shared++;
+                block.push_back((uint8_t)shared);
+                block.push_back((uint8_t)(key.size() - shared));
+                block.insert(block.end(), key.begin() + shared, key.end());
+                block.push_back((uint8_t)p.name.size());
+                block.insert(block.end(), p.name.begin(), p.name.end());
+                put(block, p.lat);
+                put(block, p.lon);
+                block.push_back(p.zoom);
+                block.push_back(keys[i].word ? 1 : 0);
+                prev = &key;
+            }
+            info.size = (uint32_t)block.size();
+            fwrite(block.data(), 1, block.size(), f);
+            offset += info.size;
+            index.push_back(info);
+        }
+
+        const uint32_t indexOffset = offset;
+        fwrite(index.data(), sizeof(BlockInfo), index.size(), f);
+        uint32_t checksum = 2166136261u;
+        const uint8_t *raw = (const uint8_t *)index.data();
+        for (size_t i = 0; i < index.size() * sizeof(BlockInfo); i++)
+            checksum = (checksum ^ raw[i]) * 16777619u;
+
+        std::vector<uint8_t> h;
+        h.insert(h.end(), NAME_INDEX_MAGIC, NAME_INDEX_MAGIC + 4);
+        put(h, NameIndex::VERSION);
+        put(h, (uint16_t)sizeof(header));
+        put(h, (uint32_t)keys.size());
+        put(h, (uint32_t)index.size());
+        put(h, blockEntries);
+        put(h, (uint16_t)NameIndex::KEY_PREFIX);
+        put(h, indexOffset);
+        put(h, checksum);
+        put(h, (uint32_t)0);
+        fseek(f, 0, SEEK_SET);
+        fwrite(h.data(), 1, h.size(), f);
+        const bool ok = ferror(f) == 0;
+        fclose(f);
+
+        stats.keys = (uint32_t)keys.size();
+        stats.blocks = (uint32_t)index.size();
+        stats.bytes = indexOffset + index.size() * sizeof(BlockInfo);
+        return ok;
+    }
+
+    /**
+     * @brief Distance between two positions (m), equirectangular
+     */
+    static double distance(double lat1, double lon1, double lat2, double lon2)
+    {
+        const double k = M_PI / 180.0;
+        const double dx = (lon2 - lon1) * k * cos((lat1 + lat2) * 0.5 * k);
+        const double dy = (lat2 - lat1) * k;
+        return sqrt(dx * dx + dy * dy) * 6378137.0;
+    }
+
+private:
+    std::unordered_map<std::string, std::vector<uint32_t>> byKey;   /**< Places of a key */
+
+    template <typename T> static void put(std::vector<uint8_t> &out, T value)
+    {
+        const uint8_t *b = (const uint8_t *)&value;
+        out.insert(out.end(), b, b + sizeof(T));
+    }
+
+    /**
+     * @brief Name cut to a size without splitting a UTF-8 character
+     */
+    static std::string utf8Prefix(const char *name, size_t maxLen)
+    {
+        size_t len = strlen(name);
+        if (len <= maxLen)
+            return name;
+        len = maxLen;
+        while (len > 0 && ((uint8_t)name[len] & 0xC0) == 0x80)
+            len--;
+        return std::string(name, len);
+    }
+
+    /**
+     * @brief Add the labels of a tile shown at its zoom
+     */
+    void scanTile(const std::vector<uint8_t> &data, uint32_t x, uint32_t y, uint8_t zoom, Stats &stats)
+    {
+        if (data.size() < 22)
+            return;
+        uint16_t featureCount;
+        memcpy(&featureCount, data.data() + 4, 2);
+        const uint8_t *p = data.data() + 22;
+        const uint8_t *end = data.data() + data.size();
+        const double worldPx = 256.0 * (double)(1u << zoom);
+        for (uint16_t i = 0; i < featureCount && p + 13 <= end; i++)
+        {
+            const uint8_t geomType = p[0] & 0x07;
+            const uint8_t minZoom = p[3] >> 4;
+            uint16_t ps;
+            memcpy(&ps, p + 11, 2);
+            const uint8_t *payload = p + 13;
+            p = payload + ps;
+            if (p > end)
+                return;
+            if (geomType != (uint8_t)NavGeomType::Text || minZoom > zoom || ps < 5)
+                continue;
+
+            int16_t tx, ty;
+            memcpy(&tx, payload, 2);
+            memcpy(&ty, payload + 2, 2);
+            const size_t len = std::min<size_t>(payload[4], ps - 5);
+            const std::string text((const char *)payload + 5, len);
+
+            const double px = x * 256.0 + tx / 16.0;
+            const double py = y * 256.0 + ty / 16.0;
+            const double lon = px / worldPx * 360.0 - 180.0;
+            const double lat = atan(sinh(M_PI * (1.0 - 2.0 * py / worldPx))) * 180.0 / M_PI;
+            addLabel(text.c_str(), lat, lon, zoom);
+            stats.labels++;
+        }
+    }
+};
@@ -0,0 +1,266 @@
+/**
+ * @file nav_replay.cpp
+ * @brief  Host replay of GPS fixes through the turn-by-turn navigation engine
+ *
+ * Runs lib/utils/src/navigation.cpp the way the navigation task does: the turns of the
+ * track are detected once (TurnScan, same thresholds as the GPX screen), then each fix
+ * goes through updateNavigation with the navigation task configuration and gives one
+ * NavResult, the snapshot the GUI task shows.
+ *
+ * With no arguments it replays a synthetic drive (a right turn, a slight left, a detour
+ * off the track and the finish) and checks the instructions. With a track and a fixes
+ * file it prints one result per recorded fix.
+ *
+ * Build: g++ -O2 -std=c++17 -I../host -I../../lib/gpx/src -I../../lib/utils/src nav_replay.cpp
+ *        ../../lib/utils/src/navigation.cpp ../../lib/gpx/src/trackGrid.cpp ../../lib/gpx/src/turnScan.cpp
+ *        ../../lib/utils/src/gpsMath.cpp -o nav_replay
+ */
+
+#include "navigation.hpp"
+#include "turnScan.hpp"
+
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <vector>
+
+using Clock = std::chrono::steady_clock;
+
+static uint32_t failures = 0;
+
+static void check(bool condition, const char *what)
+{
+    printf("  %-44s %s\n", what, condition ? "ok" : "FAIL");
+    if (!condition)
+        failures++;
+}
+
+static const float METERS_PER_DEG = 111319.49f;
+static const char *ICON_NAMES[] = {"straight", "slight-left", "slight-right", "left", "right", "finish", "off-track"};
+
+/**
+ * @brief One recorded fix
+ */
+struct Fix
+{
+    float lat;
+    float lon;
+    float heading;
+    float speed;
+};
+
+/**
+ * @brief Fill the cumulative distances like GPXParser::loadTrack
+ */
+static void accumulate(TrackVector &track)
+{
+    float total = 0.0f;
+    for (size_t i = 0; i < track.size(); i++)
+    {
+        if (i > 0)
+            total += calcDist(track.lat[i - 1], track.lon[i - 1], track.lat[i], track.lon[i]);
+        track.accumDist[i] = total;
+    }
+}
+
+/**
+ * @brief Move a position by north and east offsets (m)
+ */
+static void offset(float &lat, float &lon, float north, float east)
+{
+    lat += north / METERS_PER_DEG;
+    lon += east / (METERS_PER_DEG * cosf(DEG2RAD(lat)));
+}
+
+/**
+ * @brief Navigation task setup: the same configuration, thresholds and turn detection
+ */
+struct Engine
+{
+    NavConfig config;
+    NavState state;
+    TrackGrid grid;
+    std::vector<TurnPoint> turns;
+
+    explicit Engine(const TrackVector &track)
+    {
+        config.searchWindow = 150;
+        config.offTrackThreshold = 75.0f;
+        config.maxBackwardJump = 10;
+        grid.build(track);
+        turns = TurnScan::detect(track, {18.0f, 10, 70.0f, 5});
+    }
+
+    NavResult update(const TrackVector &track, const Fix &fix)
+    {
+        return updateNavigation(fix.lat, fix.lon, fix.heading, fix.speed, track, grid, turns, state, 20, 200, config);
+    }
+};
+
+/**
+ * @brief Read "lat,lon" lines (track) or "lat,lon,heading,speed" lines (fixes)
+ */
+static bool readCsv(const char *path, std::vector<Fix> &rows)
+{
+    FILE *f = fopen(path, "r");
+    if (!f)
+        return false;
+    char line[256];
+    while (fgets(line, sizeof(line), f))
+    {
+        Fix fix = {0, 0, 0, 0};
+        if (sscanf(line, "%f,%f,%f,%f", &fix.lat, &fix.lon, &fix.heading, &fix.speed) >= 2)
+            rows.push_back(fix);
+    }
+    fclose(f);
+    return true;
+}
+
+/**
+ * @brief Replay recorded fixes against a track and print the results
+ */
+static int replayFiles(const char *trackPath, const char *fixesPath)
+{
+    std::vector<Fix> points, fixes;
+    if (!readCsv(trackPath, points) || !readCsv(fixesPath, fixes))
+    {
+        perror("nav_replay");
+        return 1;
+    }
+
+    TrackVector track;
+    for (const Fix &p : points)
+        track.push_back(p.lat, p.lon, 0.0f);
+    accumulate(track);
+
+    Engine engine(track);
+    printf("# %u track points, %u turns, %u fixes\n", (unsigned)track.size(), (unsigned)engine.turns.size(),
+           (unsigned)fixes.size());
+    printf("fix,icon,turnDist,nextTurn,trackIdx,distToTrack\n");
+    for (size_t i = 0; i < fixes.size(); i++)
+    {
+        if (fixes[i].speed == 0)
+            continue;
+        const NavResult r = engine.update(track, fixes[i]);
+        printf("%u,%s,%d,%d,%d,%.1f\n", (unsigned)i, ICON_NAMES[r.icon], r.turnDist, r.nextTurn, r.trackIdx,
+               r.distToTrack);
+    }
+    return 0;
+}
+
+int main(int argc, char **argv)
+{
+    if (argc == 3)
+        return replayFiles(argv[1], argv[2]);
+
+    // Navigation track, a point every 20 m: 1 km north, right 90°, 600 m east, slight left 45°, 600 m
+    TrackVector track;
+    float lat = 41.38f, lon = 2.17f;
+    const struct { float course; int points; } legs[] = {{0.0f, 50}, {90.0f, 30}, {45.0f, 31}};
+    for (const auto &leg : legs)
+        for (int i = 0; i < leg.points; i++)
+        {
+            track.push_back(lat, lon, 0.0f);
+            offset(lat, lon, 20.0f * cosf(DEG2RAD(leg.course)), 20.0f * sinf(DEG2RAD(leg.course)));
+        }
+    accumulate(track);
+    const float corner1 = track.accumDist[50];
+    const float corner2 = track.accumDist[80];
+    const float trackEnd = track.accumDist[track.size() - 1];
+
+    // Drive it at 36 km/h, a fix every 10 m with 3 m of noise, leaving the track for 200 m east at 400 m
+    std::mt19937 rng(7);
+    std::normal_distribution<float> noise(0.0f, 3.0f);
+    std::vector<Fix> fixes;
+    std::vector<float> along;       /**< Distance along the track of each fix, -1 on the detour */
+    for (float d = 0.0f; d <= trackEnd; d += 10.0f)
+    {
+        size_t i = 1;
+        while (i < track.size() - 1 && track.accumDist[i] < d)
+            i++;
+        const float t = (d - track.accumDist[i - 1]) / (track.accumDist[i] - track.accumDist[i - 1]);
+        float fLat = track.lat[i - 1] + t * (track.lat[i] - track.lat[i - 1]);
+        float fLon = track.lon[i - 1] + t * (track.lon[i] - track.lon[i - 1]);
+        const float course = calcCourse(track.lat[i - 1], track.lon[i - 1], track.lat[i], track.lon[i]);
+        offset(fLat, fLon, noise(rng), noise(rng));
+        fixes.push_back({fLat, fLon, course, 36.0f});
+        along.push_back(d);
+
+        if (d == 400.0f)
+        {
+            for (int k = 1; k <= 40; k++)
+            {
+                Fix detour = fixes.back();
+                offset(detour.lat, detour.lon, 0.0f, 10.0f * (k <= 20 ? k : 40 - k));
+                detour.heading = k <= 20 ? 90.0f : 270.0f;
+                fixes.push_back(detour);
+                along.push_back(-1.0f);
+            }
+        }
+    }
+
+    Engine engine(track);
+    printf("Track\t\t: %u points, %.0f m, %u turn points\n", (unsigned)track.size(), trackEnd,
+           (unsigned)engine.turns.size());
+
+    std::vector<NavResult> results;
+    const auto t0 = Clock::now();
+    for (const Fix &fix : fixes)
+        results.push_back(engine.update(track, fix));
+    const double us = std::chrono::duration<double, std::micro>(Clock::now() - t0).count() / fixes.size();
+    printf("Replay\t\t: %u fixes, %.2f us per update\n", (unsigned)fixes.size(), us);
+
+    bool straightFar = true, rounded = true, rightAtCorner1 = false, leftAtCorner2 = true, slightLeftSeen = false;
+    bool offTrack = false, turnKept = true, finishAtEnd = false;
+    int turnBeforeDetour = -1;
+    for (size_t i = 0; i < results.size(); i++)
+    {
+        const NavResult &r = results[i];
+        const float d = along[i];
+        if (r.turnDist >= 0 && r.turnDist % 5 != 0)
+            rounded = false;
+        if (d < 0.0f)
+        {
+            offTrack |= r.icon == NAV_ICON_OFF_TRACK;
+            continue;
+        }
+        if (d == 400.0f)
+            turnBeforeDetour = r.nextTurn;
+        if (d > 400.0f && d < 450.0f && along[i - 1] < 0.0f && r.nextTurn != turnBeforeDetour)
+            turnKept = false;
+        if (d < corner1 - 300.0f && r.icon != NAV_ICON_STRAIGHT)
+            straightFar = false;
+        if (d > corner1 - 200.0f && d < corner1)
+            rightAtCorner1 |= r.icon == NAV_ICON_TURN_RIGHT;
+        if (d > corner2 - 150.0f && d < corner2)
+        {
+            slightLeftSeen |= r.icon == NAV_ICON_SLIGHT_LEFT;
+            leftAtCorner2 &= r.icon != NAV_ICON_SLIGHT_RIGHT && r.icon != NAV_ICON_TURN_RIGHT;
+        }
+        if (d > trackEnd - 100.0f)
+            finishAtEnd = r.icon == NAV_ICON_FINISH;
+    }
+
+    Engine again(track);
+    bool deterministic = true;
+    for (size_t i = 0; i < fixes.size(); i++)
+    {
+        const NavResult r = again.update(track, fixes[i]);
+        deterministic &= r.icon == results[i].icon && r.turnDist == results[i].turnDist &&
+                         r.trackIdx == results[i].trackIdx;
+    }
+
+    printf("Instructions\n");
+    check(straightFar, "straight far from the turns");
+    check(rounded, "turn distance rounded to 5 m");
+    check(rightAtCorner1, "right turn before the 90 degree corner");
+    check(slightLeftSeen && leftAtCorner2, "slight left before the 45 degree bend");
+    check(offTrack, "off track on the detour");
+    check(turnKept, "next turn restored back on the track");
+    check(finishAtEnd, "finish after the last turn");
+    check(deterministic, "same results on a second replay");
+    printf("%s\n", failures ? "FAILED" : "All checks passed");
+    return failures ? 1 : 0;
+}
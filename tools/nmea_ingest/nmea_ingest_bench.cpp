@@ -0,0 +1,364 @@
+/**
+ * @file nmea_ingest_bench.cpp
+ * @brief  Host benchmark and checks for the GPS NMEA ingestion ring
+ *
+ * Feeds NMEA sentences (synthetic, or a recorded file) through lib/gps/nmeaRing.cpp the way
+ * the GPS UART does: the bytes arrive at the baud rate, the receive callback runs when the
+ * UART FIFO reaches its threshold or the line stays idle for the RX timeout, and the GPS task
+ * is woken only when a sentence was completed. Counts the GPS task wakeups and the latency from
+ * the end of a sentence on the wire to the GPS task, against polling every tick, and checks
+ * that every sentence reaches the parser whole and in order, also with a reader on another
+ * thread and with a full ring.
+ *
+ * The parser here only splits the sentences and checks their checksum; on the device the same
+ * bytes go to NMEAGPS::handle().
+ *
+ * Build: g++ -O2 -std=c++17 -pthread -I../host -I../../lib/gps nmea_ingest_bench.cpp
+ *        ../../lib/gps/nmeaRing.cpp -o nmea_ingest_bench
+ */
+
+#include "nmeaRing.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+static uint32_t failures = 0;
+
+static void check(bool condition, const char *what)
+{
+    printf("  %-44s %s\n", what, condition ? "ok" : "FAIL");
+    if (!condition)
+        failures++;
+}
+
+static const uint32_t FIFO_FULL = 120;      /**< UART FIFO threshold of the Arduino driver (bytes) */
+static const uint32_t RX_TIMEOUT = 4;       /**< RX timeout set by Gps::startIngest (symbols) */
+static const uint32_t TICK_HZ = 1000;       /**< FreeRTOS tick rate, the old polling rate */
+
+/**
+ * @brief Sentence with its checksum and line end
+ */
+static std::string sentence(const std::string &body)
+{
+    uint8_t sum = 0;
+    for (char c : body)
+        sum ^= (uint8_t)c;
+    char tail[8];
+    snprintf(tail, sizeof(tail), "*%02X\r\n", sum);
+    return "$" + body + tail;
+}
+
+/**
+ * @brief One epoch of a typical receiver: GGA, GSA, three GSV, RMC and VTG
+ */
+static std::string makeEpoch(uint32_t n)
+{
+    char body[128];
+    std::string out;
+    const uint32_t s = n % 60, m = (n / 60) % 60;
+    snprintf(body, sizeof(body), "GNGGA,10%02u%02u.00,4123.%04u,N,00210.%04u,E,1,09,0.9,%u.0,M,49.0,M,,", m, s,
+             n % 10000, (n * 7) % 10000, 100 + n % 50);
+    out += sentence(body);
+    out += sentence("GNGSA,A,3,02,05,12,15,18,24,25,29,31,,,,1.6,0.9,1.3");
+    for (int g = 1; g <= 3; g++)
+    {
+        snprintf(body, sizeof(body), "GPGSV,3,%d,11,%02d,45,%03u,40,%02d,30,120,35,%02d,15,200,28,%02d,60,310,42", g,
+                 g * 4, (n + g * 40) % 360, g * 4 + 1, g * 4 + 2, g * 4 + 3);
+        out += sentence(body);
+    }
+    snprintf(body, sizeof(body), "GNRMC,10%02u%02u.00,A,4123.%04u,N,00210.%04u,E,%u.5,%u.0,181026,,,A", m, s, n % 10000,
+             (n * 7) % 10000, n % 20, (n * 3) % 360);
+    out += sentence(body);
+    snprintf(body, sizeof(body), "GNVTG,%u.0,T,,M,%u.5,N,%u.0,K,A", (n * 3) % 360, n % 20, n % 37);
+    out += sentence(body);
+    return out;
+}
+
+/**
+ * @brief Stand-in parser: splits the bytes into sentences and checks them
+ */
+struct Parser
+{
+    std::string line;
+    std::vector<std::string> sentences;
+    uint32_t bad = 0;
+
+    void handle(const uint8_t *data, size_t len)
+    {
+        for (size_t i = 0; i < len; i++)
+        {
+            line += (char)data[i];
+            if (data[i] != '\n')
+                continue;
+            const size_t star = line.rfind('*');
+            uint8_t sum = 0;
+            for (size_t k = 1; k < star && star != std::string::npos; k++)
+                sum ^= (uint8_t)line[k];
+            if (line[0] != '$' || star == std::string::npos || strtoul(line.c_str() + star + 1, nullptr, 16) != sum)
+                bad++;
+            sentences.push_back(line);
+            line.clear();
+        }
+    }
+};
+
+/**
+ * @brief Result of a simulated UART stream
+ */
+struct StreamStats
+{
+    uint32_t callbacks;         /**< UART receive callbacks */
+    uint32_t wakeups;           /**< GPS task wakeups */
+    double meanLatencyMs;       /**< Sentence end on the wire to GPS task */
+    double maxLatencyMs;
+    double seconds;             /**< Length of the stream */
+};
+
+/**
+ * @brief Bytes arriving at a baud rate in bursts of one epoch, through the UART callback and the ring
+ *
+ * @details The callback runs when the FIFO reaches FIFO_FULL bytes or after RX_TIMEOUT idle
+ *          symbols; the GPS task is woken right after a callback that completed sentences and
+ *          drains the ring (the GPS task has the higher priority).
+ */
+static StreamStats simulate(const std::vector<std::string> &epochs, uint32_t baud, uint32_t rateHz, Parser &parser)
+{
+    NmeaRing ring;
+    StreamStats st = {};
+    const double byteMs = 10000.0 / baud;       // 10 bits per byte
+    std::vector<uint8_t> fifo;
+    std::vector<double> ends;                   // Wire time of each '\n' in the FIFO
+    double latencySum = 0.0;
+    uint32_t latencyCount = 0;
+    uint8_t buf[128];
+
+    auto callback = [&](double now)
+    {
+        st.callbacks++;
+        if (ring.write(fifo.data(), fifo.size()) == 0)
+        {
+            fifo.clear();
+            return;
+        }
+        fifo.clear();
+        st.wakeups++;
+        size_t len;
+        while ((len = ring.read(buf, sizeof(buf))) > 0)
+            parser.handle(buf, len);
+        for (double t : ends)
+        {
+            latencySum += now - t;
+            st.maxLatencyMs = std::max(st.maxLatencyMs, now - t);
+            latencyCount++;
+        }
+        ends.clear();
+    };
+
+    double now = 0.0;
+    for (size_t e = 0; e < epochs.size(); e++)
+    {
+        now = std::max(now, e * 1000.0 / rateHz);
+        for (char c : epochs[e])
+        {
+            now += byteMs;
+            fifo.push_back((uint8_t)c);
+            if (c == '\n')
+                ends.push_back(now);
+            if (fifo.size() >= FIFO_FULL)
+                callback(now);
+        }
+        callback(now + RX_TIMEOUT * byteMs);
+    }
+    st.meanLatencyMs = latencyCount ? latencySum / latencyCount : 0.0;
+    st.seconds = epochs.size() / (double)rateHz;
+    return st;
+}
+
+/**
+ * @brief Read a recorded NMEA file, one epoch per RMC sentence
+ */
+static bool loadFile(const char *path, std::vector<std::string> &epochs)
+{
+    FILE *f = fopen(path, "rb");
+    if (!f)
+        return false;
+    char line[256];
+    std::string epoch;
+    while (fgets(line, sizeof(line), f))
+    {
+        if (line[0] != '$')
+            continue;
+        epoch += line;
+        if (epoch.back() != '\n')
+            epoch += '\n';
+        if (strncmp(line + 3, "RMC", 3) == 0)
+        {
+            epochs.push_back(epoch);
+            epoch.clear();
+        }
+    }
+    if (!epoch.empty())
+        epochs.push_back(epoch);
+    fclose(f);
+    return !epochs.empty();
+}
+
+int main(int argc, char **argv)
+{
+    std::vector<std::string> epochs;
+    if (argc > 1)
+    {
+        if (!loadFile(argv[1], epochs))
+        {
+            printf("Cannot read %s\n", argv[1]);
+            return 1;
+        }
+    }
+    else
+        for (uint32_t n = 0; n < 600; n++)
+            epochs.push_back(makeEpoch(n));
+
+    std::string all;
+    uint32_t total = 0;
+    for (const std::string &e : epochs)
+    {
+        all += e;
+        total += (uint32_t)std::count(e.begin(), e.end(), '\n');
+    }
+    printf("Epochs: %zu, %u sentences, %zu bytes%s\n", epochs.size(), total, all.size(), argc > 1 ? "" : " (synthetic)");
+
+    printf("Streams\n");
+    const struct { uint32_t baud, rate; } modes[] = {{9600, 1}, {38400, 5}, {115200, 10}};
+    bool whole = true;
+    for (const auto &mode : modes)
+    {
+        // Skip rates the baud rate cannot carry
+        if (all.size() * 10.0 / epochs.size() * mode.rate > mode.baud * 0.9)
+            continue;
+        Parser parser;
+        const StreamStats st = simulate(epochs, mode.baud, mode.rate, parser);
+        whole &= parser.sentences.size() == total && parser.bad == 0 && parser.line.empty();
+        const double polls = st.seconds * TICK_HZ;
+        printf("  %6u baud %2u Hz  %6u wakeups (%4.1f/s, polling %5.0f/s)  latency mean %.2f ms  max %.2f ms\n",
+               mode.baud, mode.rate, st.wakeups, st.wakeups / st.seconds, polls / st.seconds, st.meanLatencyMs,
+               st.maxLatencyMs);
+        whole &= st.wakeups <= total && st.wakeups * 20 < polls;
+    }
+
+    printf("Checks\n");
+    check(whole, "streams parsed whole, far fewer wakeups");
+
+    {
+        // Random chunks: the reader only ever gets complete sentences, in order
+        NmeaRing ring;
+        Parser parser;
+        std::mt19937 rng(49);
+        uint8_t buf[200];
+        bool framed = true;
+        size_t pos = 0;
+        while (pos < all.size())
+        {
+            const size_t len = std::min<size_t>(1 + rng() % 150, all.size() - pos);
+            ring.write((const uint8_t *)all.data() + pos, len);
+            pos += len;
+            size_t got;
+            while ((got = ring.read(buf, 1 + rng() % sizeof(buf))) > 0)
+            {
+                parser.handle(buf, got);
+                framed &= ring.pending() != 0 || buf[got - 1] == '\n';
+            }
+        }
+        std::string joined;
+        for (const std::string &s : parser.sentences)
+            joined += s;
+        check(framed && joined == all && ring.sentences == total && ring.dropped == 0, "random chunks give the same sentences");
+    }
+
+    {
+        // Partial sentence stays hidden
+        NmeaRing ring;
+        uint8_t buf[64];
+        const std::string s = sentence("GNRMC,,V,,,,,,,,,,N");
+        ring.write((const uint8_t *)s.data(), s.size() - 3);
+        const bool hidden = ring.read(buf, sizeof(buf)) == 0 && ring.pending() == 0;
+        const size_t done = ring.write((const uint8_t *)s.data() + s.size() - 3, 3);
+        check(hidden && done == 1 && ring.read(buf, sizeof(buf)) == s.size(), "partial sentence hidden until its end");
+    }
+
+    {
+        // Full ring: whole sentences are dropped, the others stay intact
+        NmeaRing ring;
+        Parser parser;
+        std::vector<uint8_t> out(NmeaRing::SIZE);
+        const size_t n = all.rfind('\n', NmeaRing::SIZE * 3) + 1;
+        ring.write((const uint8_t *)all.data(), n);
+        size_t got;
+        while ((got = ring.read(out.data(), out.size())) > 0)
+            parser.handle(out.data(), got);
+        const size_t sent = std::count(all.begin(), all.begin() + n, '\n');
+        check(parser.bad == 0 && parser.sentences.size() + ring.dropped == sent && ring.dropped > 0 &&
+              parser.sentences[0] == all.substr(0, parser.sentences[0].size()), "full ring drops whole sentences");
+        ring.write((const uint8_t *)all.data(), n);
+        got = ring.read(out.data(), out.size());
+        check(got > 0 && out[0] == '$' && out[got - 1] == '\n', "ring recovers after dropping");
+    }
+
+    {
+        // Writer and reader on two threads
+        NmeaRing ring;
+        Parser parser;
+        std::atomic<bool> done(false);
+        std::atomic<uint32_t> notified(0);
+        std::thread reader([&]
+        {
+            uint8_t buf[128];
+            while (true)
+            {
+                const bool last = done.load();
+                size_t got;
+                while ((got = ring.read(buf, sizeof(buf))) > 0)
+                    parser.handle(buf, got);
+                if (last)
+                    break;
+                std::this_thread::yield();
+            }
+        });
+        std::mt19937 rng(7);
+        size_t pos = 0;
+        for (int rep = 0; rep < 4; rep++)
+            for (pos = 0; pos < all.size();)
+            {
+                const size_t len = std::min<size_t>(1 + rng() % 120, all.size() - pos);
+                // Wait for room like a UART FIFO would hold the bytes
+                while (ring.pending() > NmeaRing::SIZE - 256)
+                    std::this_thread::yield();
+                notified += (uint32_t)ring.write((const uint8_t *)all.data() + pos, len);
+                pos += len;
+            }
+        done = true;
+        reader.join();
+        bool same = parser.sentences.size() == total * 4 && parser.bad == 0;
+        for (size_t i = 0; same && i < parser.sentences.size(); i++)
+            same = parser.sentences[i] == parser.sentences[i % total];
+        check(same && notified == total * 4 && ring.dropped == 0, "writer and reader threads");
+    }
+
+    {
+        NmeaRing ring;
+        uint8_t buf[16];
+        ring.write((const uint8_t *)"$GP", 3);
+        ring.clear();
+        check(ring.read(buf, sizeof(buf)) == 0 && ring.write(nullptr, 0) == 0, "empty ring");
+    }
+
+    printf("%s\n", failures ? "FAILED" : "All checks passed");
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,366 @@
+/**
+ * @file nmea_replay.cpp
+ * @brief  Host replay of recorded NMEA through the NeoGPS parser and the GPS data fill
+ *
+ * Feeds a capture of the GPS serial stream (nmeacap .nmc file, or plain NMEA text) byte
+ * by byte to NMEAGPS::handle, configured by the lib/gps *_cfg.h headers as on the
+ * device, and each fix to fillGpsData (lib/gps/gpsFix.cpp), the GPS data and satellite
+ * tracker fill of Gps::getGPSData. It reports the parse throughput and the mean cost
+ * of each sentence type, and can write the GPS data sequence so two builds can be
+ * compared.
+ *
+ * Build: g++ -O2 -std=c++17 -I../host -I../../lib/gps -I../../lib/utils/src -I$NEOGPS nmea_replay.cpp
+ *        ../../lib/gps/gpsFix.cpp ../../lib/utils/src/gpsMath.cpp $NEOGPS/NMEAGPS.cpp $NEOGPS/GPSTime.cpp
+ *        $NEOGPS/Location.cpp $NEOGPS/NeoTime.cpp $NEOGPS/DMS.cpp -o nmea_replay
+ *        (NEOGPS=../../.pio/libdeps/<env>/NeoGPS/src)
+ */
+
+#include "gpsFix.hpp"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <map>
+#include <string>
+#include <thread>
+#include <vector>
+
+using Clock = std::chrono::steady_clock;
+
+static const char CAPTURE_MAGIC[] = "NMEACAP1";     /**< NmeaCapture::MAGIC (lib/gps/nmeaCapture.hpp) */
+static const size_t RECORD_HEADER = 6;              /**< Time and length of a record */
+
+/**
+ * @brief Burst of bytes received by the UART callback
+ */
+struct Record
+{
+    uint32_t timeMs;            /**< Capture time (ms since boot) */
+    std::vector<uint8_t> bytes; /**< Received bytes */
+};
+
+/**
+ * @brief Parse cost of one sentence type
+ */
+struct SentenceCost
+{
+    uint32_t count = 0;         /**< Sentences */
+    uint64_t bytes = 0;         /**< Bytes of the sentences */
+    double ns = 0.0;            /**< Total parse time (ns) */
+};
+
+/**
+ * @brief Load a capture: nmeacap records, or plain NMEA text as one record per line
+ */
+static bool loadCapture(const char *path, std::vector<Record> &records, bool &timed)
+{
+    FILE *f = fopen(path, "rb");
+    if (!f)
+        return false;
+    std::vector<uint8_t> data;
+    uint8_t buf[4096];
+    size_t n;
+    while ((n = fread(buf, 1, sizeof(buf), f)) > 0)
+        data.insert(data.end(), buf, buf + n);
+    fclose(f);
+
+    const size_t magicLen = strlen(CAPTURE_MAGIC);
+    timed = data.size() >= magicLen && memcmp(data.data(), CAPTURE_MAGIC, magicLen) == 0;
+    if (timed)
+    {
+        size_t pos = magicLen;
+        while (pos + RECORD_HEADER <= data.size())
+        {
+            Record r;
+            r.timeMs = data[pos] | (data[pos + 1] << 8) | (data[pos + 2] << 16) | ((uint32_t)data[pos + 3] << 24);
+            const uint16_t len = data[pos + 4] | (data[pos + 5] << 8);
+            pos += RECORD_HEADER;
+            if (pos + len > data.size())
+                break;      // record cut by a power loss
+            r.bytes.assign(data.begin() + pos, data.begin() + pos + len);
+            pos += len;
+            records.push_back(std::move(r));
+        }
+        return true;
+    }
+
+    size_t start = 0;
+    for (size_t i = 0; i < data.size(); i++)
+    {
+        if (data[i] != '\n' && i + 1 < data.size())
+            continue;
+        Record r;
+        r.timeMs = 0;
+        r.bytes.assign(data.begin() + start, data.begin() + i + 1);
+        records.push_back(std::move(r));
+        start = i + 1;
+    }
+    return true;
+}
+
+/**
+ * @brief One line of the GPS data sequence: the fix time, the GPS data and the satellites
+ */
+static void writeSequence(FILE *out, const gps_fix &fix, const GpsData &data, const GpsSatellite *sats)
+{
+    if (fix.valid.time)
+        fprintf(out, "%02u:%02u:%02u", fix.dateTime.hours, fix.dateTime.minutes, fix.dateTime.seconds);
+    fprintf(out, ",%u,%u,%d,%u,%.6f,%.6f,%u,%.2f,%.2f,%.2f,%u,", data.satellites, data.fixMode, data.altitude,
+            data.speed, data.latitude, data.longitude, data.heading, data.hdop, data.pdop, data.vdop, data.satInView);
+    for (uint8_t i = 0; i < data.satInView; i++)
+        fprintf(out, "%s%.2s%u/%u/%u/%u/%c/%u/%u", i ? ";" : "", sats[i].talker_id, sats[i].satNum, sats[i].elev,
+                sats[i].azim, sats[i].snr, sats[i].active ? 'A' : '-', sats[i].posX, sats[i].posY);
+    fputc('\n', out);
+}
+
+/**
+ * @brief Split a sequence line at the commas
+ */
+static std::vector<std::string> splitFields(const std::string &line)
+{
+    std::vector<std::string> fields;
+    size_t start = 0;
+    for (;;)
+    {
+        const size_t comma = line.find(',', start);
+        fields.push_back(line.substr(start, comma - start));
+        if (comma == std::string::npos)
+            return fields;
+        start = comma + 1;
+    }
+}
+
+static bool readLine(FILE *f, std::string &line)
+{
+    line.clear();
+    int c;
+    while ((c = fgetc(f)) != EOF && c != '\n')
+        line += (char)c;
+    return c != EOF || !line.empty();
+}
+
+/**
+ * @brief Compare the GPS data sequences of two builds, field by field
+ */
+static int diffSequences(const char *pathA, const char *pathB)
+{
+    static const char *FIELDS[] = {"time", "satellites", "fixMode", "altitude", "speed", "latitude", "longitude",
+                                   "heading", "hdop", "pdop", "vdop", "satInView", "satTracker"};
+    static const size_t FIELD_COUNT = sizeof(FIELDS) / sizeof(FIELDS[0]);
+
+    FILE *a = fopen(pathA, "r");
+    FILE *b = fopen(pathB, "r");
+    if (!a || !b)
+    {
+        fprintf(stderr, "Cannot open %s\n", a ? pathB : pathA);
+        return 2;
+    }
+
+    uint32_t lines = 0, differing = 0, shown = 0;
+    uint32_t fieldDiffs[FIELD_COUNT] = {};
+    std::string lineA, lineB;
+    bool moreA = readLine(a, lineA), moreB = readLine(b, lineB);
+    while (moreA && moreB)
+    {
+        lines++;
+        if (lineA != lineB)
+        {
+            differing++;
+            const std::vector<std::string> fa = splitFields(lineA), fb = splitFields(lineB);
+            for (size_t i = 0; i < FIELD_COUNT; i++)
+            {
+                const bool inA = i < fa.size(), inB = i < fb.size();
+                if (inA != inB || (inA && fa[i] != fb[i]))
+                {
+                    fieldDiffs[i]++;
+                    if (shown < 5)
+                        printf("  fix %-6u %-10s %s -> %s\n", lines, FIELDS[i], inA ? fa[i].c_str() : "-",
+                               inB ? fb[i].c_str() : "-");
+                }
+            }
+            shown++;
+        }
+        moreA = readLine(a, lineA);
+        moreB = readLine(b, lineB);
+    }
+    uint32_t onlyA = 0, onlyB = 0;
+    while (moreA)
+    {
+        onlyA++;
+        moreA = readLine(a, lineA);
+    }
+    while (moreB)
+    {
+        onlyB++;
+        moreB = readLine(b, lineB);
+    }
+    fclose(a);
+    fclose(b);
+
+    printf("Fixes compared:   %u (%u only in %s, %u only in %s)\n", lines, onlyA, pathA, onlyB, pathB);
+    printf("Fixes differing:  %u\n", differing);
+    for (size_t i = 0; i < FIELD_COUNT; i++)
+        if (fieldDiffs[i])
+            printf("  %-12s %u\n", FIELDS[i], fieldDiffs[i]);
+    return (differing || onlyA || onlyB) ? 1 : 0;
+}
+
+static void usage()
+{
+    fprintf(stderr, "Usage: nmea_replay <capture.nmc|file.nmea> [--realtime] [--out sequence.csv]\n"
+                    "       nmea_replay --diff old.csv new.csv\n");
+}
+
+int main(int argc, char **argv)
+{
+    if (argc == 4 && strcmp(argv[1], "--diff") == 0)
+        return diffSequences(argv[2], argv[3]);
+
+    const char *capturePath = nullptr;
+    const char *outPath = nullptr;
+    bool realtime = false;
+    for (int i = 1; i < argc; i++)
+    {
+        if (strcmp(argv[i], "--realtime") == 0)
+            realtime = true;
+        else if (strcmp(argv[i], "--out") == 0 && i + 1 < argc)
+            outPath = argv[++i];
+        else if (argv[i][0] != '-' && !capturePath)
+            capturePath = argv[i];
+        else
+        {
+            usage();
+            return 2;
+        }
+    }
+    if (!capturePath)
+    {
+        usage();
+        return 2;
+    }
+
+    std::vector<Record> records;
+    bool timed = false;
+    if (!loadCapture(capturePath, records, timed))
+    {
+        fprintf(stderr, "Cannot open %s\n", capturePath);
+        return 2;
+    }
+    if (records.empty())
+    {
+        fprintf(stderr, "No data in %s\n", capturePath);
+        return 2;
+    }
+    if (realtime && !timed)
+        fprintf(stderr, "Plain NMEA has no timestamps, replaying as fast as possible\n");
+
+    FILE *out = nullptr;
+    if (outPath)
+    {
+        out = fopen(outPath, "w");
+        if (!out)
+        {
+            fprintf(stderr, "Cannot create %s\n", outPath);
+            return 2;
+        }
+    }
+
+    static NMEAGPS parser;
+    static GpsData data;
+    static GpsSatellite sats[MAX_SATELLITES];
+    std::map<std::string, SentenceCost> costs;
+
+    uint64_t bytes = 0;
+    uint32_t sentences = 0, fixes = 0;
+    double parseNs = 0.0, fillNs = 0.0;
+
+    // Sentence being received: its type and the time spent in handle() on its bytes
+    char type[8] = "";
+    uint8_t typeLen = 0;
+    uint32_t sentenceBytes = 0;
+    double sentenceNs = 0.0;
+    bool inSentence = false;
+
+    const Clock::time_point replayStart = Clock::now();
+    const uint32_t firstMs = records.front().timeMs;
+
+    for (const Record &r : records)
+    {
+        if (realtime && timed)
+            std::this_thread::sleep_until(replayStart + std::chrono::milliseconds(r.timeMs - firstMs));
+
+        for (const uint8_t c : r.bytes)
+        {
+            if (c == '$')
+            {
+                inSentence = true;
+                typeLen = 0;
+                sentenceBytes = 0;
+                sentenceNs = 0.0;
+            }
+            else if (inSentence && c != ',' && typeLen < 5 && typeLen == sentenceBytes - 1)
+                type[typeLen++] = (char)c;
+
+            const Clock::time_point t0 = Clock::now();
+            parser.handle(c);
+            const double ns = std::chrono::duration<double, std::nano>(Clock::now() - t0).count();
+            parseNs += ns;
+            bytes++;
+
+            if (inSentence)
+            {
+                sentenceNs += ns;
+                sentenceBytes++;
+                if (c == '\n')
+                {
+                    // Type without the talker ID ("GPGGA" -> "GGA"), proprietary sentences as a whole
+                    type[typeLen] = '\0';
+                    const char *name = (type[0] == 'P' || typeLen < 5) ? type : type + 2;
+                    SentenceCost &cost = costs[name];
+                    cost.count++;
+                    cost.bytes += sentenceBytes;
+                    cost.ns += sentenceNs;
+                    sentences++;
+                    inSentence = false;
+                }
+            }
+
+            while (parser.available())
+            {
+                const Clock::time_point f0 = Clock::now();
+                const gps_fix fix = parser.read();
+                fillGpsData(fix, parser, data, sats);
+                fillNs += std::chrono::duration<double, std::nano>(Clock::now() - f0).count();
+                fixes++;
+                if (out)
+                    writeSequence(out, fix, data, sats);
+            }
+        }
+    }
+    const double wallS = std::chrono::duration<double>(Clock::now() - replayStart).count();
+    if (out)
+        fclose(out);
+
+    printf("Capture:          %s (%s, %zu records)\n", capturePath, timed ? "nmeacap" : "plain NMEA", records.size());
+    if (timed)
+        printf("Capture span:     %.1f s\n", (records.back().timeMs - firstMs) / 1000.0);
+    printf("Bytes:            %llu\n", (unsigned long long)bytes);
+    printf("Sentences:        %u (parser ok %lu, errors %lu)\n", sentences, (unsigned long)parser.statistics.ok,
+           (unsigned long)parser.statistics.errors);
+    printf("Fixes:            %u\n", fixes);
+    printf("Replay:           %.3f s (%s)\n", wallS, realtime && timed ? "real time" : "as fast as possible");
+    printf("Parse time:       %.3f ms, %.0f sentences/s, %.1f ns/byte\n", parseNs / 1e6,
+           parseNs > 0.0 ? sentences / (parseNs / 1e9) : 0.0, bytes ? parseNs / bytes : 0.0);
+    printf("GPS data fill:    %.3f ms, %.2f us/fix\n", fillNs / 1e6, fixes ? fillNs / fixes / 1000.0 : 0.0);
+    printf("\n%-10s %8s %10s %12s %10s\n", "sentence", "count", "bytes", "mean (us)", "ns/byte");
+    for (const auto &entry : costs)
+    {
+        const SentenceCost &cost = entry.second;
+        printf("%-10s %8u %10llu %12.2f %10.1f\n", entry.first.c_str(), cost.count, (unsigned long long)cost.bytes,
+               cost.ns / cost.count / 1000.0, cost.bytes ? cost.ns / cost.bytes : 0.0);
+    }
+    if (outPath)
+        printf("\nGPS data sequence written to %s\n", outPath);
+    return 0;
+}
@@ -0,0 +1,185 @@
+#!/usr/bin/env python3
+# IceNav Project
+# Q565 raster tile converter
+#
+# Converts a rendered PNG tile tree (MAP/zoom/x/y.png) into Q565 tiles
+# (MAP/zoom/x/y.q565), the fast-decode format read by Maps::drawRasterTile.
+# See lib/maps/src/raster_tile.hpp for the stream layout.
+
+import argparse
+import os
+import struct
+import sys
+import time
+from multiprocessing import Pool
+
+try:
+    from PIL import Image
+except ImportError:
+    print("Pillow is required: pip install pillow")
+    sys.exit(1)
+
+MAGIC = b"Q565"
+OP_INDEX = 0x00
+OP_DIFF = 0x40
+OP_RUN = 0x80
+OP_RGB565 = 0xFE
+MAX_RUN = 64
+
+
+def q565_hash(px):
+    return ((((px >> 11) & 0x1F) * 3) + (((px >> 5) & 0x3F) * 5) + ((px & 0x1F) * 7)) & 0x3F
+
+
+def wrap_diff(a, b, mask):
+    """Signed channel delta a - b wrapped to the channel width."""
+    half = (mask + 1) >> 1
+    return ((a - b + half) & mask) - half
+
+
+def encode_pixels(pixels, width, height):
+    """Encode a flat list of RGB565 pixels into a Q565 byte stream."""
+    out = bytearray(MAGIC)
+    out += struct.pack("<HHI", width, height, 0)
+    cache = [0] * 64
+    prev = 0
+    run = 0
+
+    for px in pixels:
+        if px == prev:
+            run += 1
+            if run == MAX_RUN:
+                out.append(OP_RUN | (run - 1))
+                run = 0
+            continue
+
+        if run:
+            out.append(OP_RUN | (run - 1))
+            run = 0
+
+        idx = q565_hash(px)
+        if cache[idx] == px:
+            out.append(OP_INDEX | idx)
+        else:
+            cache[idx] = px
+            dr = wrap_diff((px >> 11) & 0x1F, (prev >> 11) & 0x1F, 0x1F)
+            dg = wrap_diff((px >> 5) & 0x3F, (prev >> 5) & 0x3F, 0x3F)
+            db = wrap_diff(px & 0x1F, prev & 0x1F, 0x1F)
+            if -2 <= dr <= 1 and -2 <= dg <= 1 and -2 <= db <= 1:
+                out.append(OP_DIFF | ((dr + 2) << 4) | ((dg + 2) << 2) | (db + 2))
+            else:
+                out.append(OP_RGB565)
+                out += struct.pack(">H", px)
+        prev = px
+
+    if run:
+        out.append(OP_RUN | (run - 1))
+    return bytes(out)
+
+
+def decode_pixels(data):
+    """Reference decoder, mirrors RasterTile::decode."""
+    if data[:4] != MAGIC:
+        raise ValueError("bad magic")
+    width, height, _ = struct.unpack("<HHI", data[4:12])
+    total = width * height
+    pixels = []
+    cache = [0] * 64
+    prev = 0
+    pos = 12
+    while len(pixels) < total:
+        op = data[pos]
+        pos += 1
+        if op == OP_RGB565:
+            prev = struct.unpack(">H", data[pos:pos + 2])[0]
+            pos += 2
+            cache[q565_hash(prev)] = prev
+            pixels.append(prev)
+        elif op & 0xC0 == OP_INDEX:
+            prev = cache[op]
+            pixels.append(prev)
+        elif op & 0xC0 == OP_DIFF:
+            r = (((prev >> 11) & 0x1F) + ((op >> 4) & 3) - 2) & 0x1F
+            g = (((prev >> 5) & 0x3F) + ((op >> 2) & 3) - 2) & 0x3F
+            b = ((prev & 0x1F) + (op & 3) - 2) & 0x1F
+            prev = (r << 11) | (g << 5) | b
+            cache[q565_hash(prev)] = prev
+            pixels.append(prev)
+        elif op & 0xC0 == OP_RUN:
+            pixels.extend([prev] * ((op & 0x3F) + 1))
+        else:
+            raise ValueError("bad op 0x%02x" % op)
+    return width, height, pixels[:total]
+
+
+def load_png_rgb565(path):
+    img = Image.open(path).convert("RGB")
+    width, height = img.size
+    pixels = [((r >> 3) << 11) | ((g >> 2) << 5) | (b >> 3) for r, g, b in img.getdata()]
+    return width, height, pixels
+
+
+def convert_tile(job):
+    src, dst, verify = job
+    width, height, pixels = load_png_rgb565(src)
+    data = encode_pixels(pixels, width, height)
+    if verify and decode_pixels(data)[2] != pixels:
+        return src, 0, 0, "verify failed"
+    os.makedirs(os.path.dirname(dst), exist_ok=True)
+    with open(dst, "wb") as f:
+        f.write(data)
+    return src, os.path.getsize(src), len(data), None
+
+
+def collect_jobs(source, dest, verify, force):
+    jobs = []
+    for root, _, files in os.walk(source):
+        for name in files:
+            if not name.endswith(".png"):
+                continue
+            src = os.path.join(root, name)
+            dst = os.path.join(dest, os.path.relpath(src, source))[:-4] + ".q565"
+            if not force and os.path.exists(dst) and os.path.getmtime(dst) >= os.path.getmtime(src):
+                continue
+            jobs.append((src, dst, verify))
+    return jobs
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Convert IceNav PNG map tiles to Q565")
+    parser.add_argument("source", help="PNG tile root (MAP folder)")
+    parser.add_argument("dest", nargs="?", help="Q565 tile root (default: next to PNG files)")
+    parser.add_argument("-j", "--jobs", type=int, default=os.cpu_count(), help="parallel workers")
+    parser.add_argument("--verify", action="store_true", help="decode every tile and compare with the PNG")
+    parser.add_argument("--force", action="store_true", help="convert tiles that are already up to date")
+    args = parser.parse_args()
+
+    dest = args.dest or args.source
+    jobs = collect_jobs(args.source, dest, args.verify, args.force)
+    if not jobs:
+        print("Nothing to convert")
+        return
+
+    start = time.time()
+    png_bytes = 0
+    q565_bytes = 0
+    errors = 0
+    with Pool(args.jobs) as pool:
+        for i, (src, png_size, q565_size, err) in enumerate(pool.imap_unordered(convert_tile, jobs, chunksize=16), 1):
+            if err:
+                errors += 1
+                print("%s: %s" % (src, err))
+                continue
+            png_bytes += png_size
+            q565_bytes += q565_size
+            if i % 1000 == 0:
+                print("%d/%d tiles" % (i, len(jobs)))
+
+    elapsed = time.time() - start
+    print("Converted %d tiles in %.1f s (%d errors)" % (len(jobs) - errors, elapsed, errors))
+    if png_bytes:
+        print("PNG %.1f MB -> Q565 %.1f MB (%.2fx)" % (png_bytes / 1e6, q565_bytes / 1e6, q565_bytes / png_bytes))
+
+
+if __name__ == "__main__":
+    main()
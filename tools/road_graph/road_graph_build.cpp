@@ -0,0 +1,51 @@
+/**
+ * @file road_graph_build.cpp
+ * @brief  Build a road graph pack for /sdcard/ROUTE from an edge list
+ *
+ * Build: g++ -O2 -std=c++17 road_graph_build.cpp -o road_graph_build
+ */
+
+#include "road_graph_builder.hpp"
+
+#include <cstdlib>
+
+int main(int argc, char **argv)
+{
+    if (argc < 3)
+    {
+        fprintf(stderr, "Usage: %s <edges.txt> <region.rgr> [block nodes]\n", argv[0]);
+        return 2;
+    }
+    const int blockNodes = argc > 3 ? atoi(argv[3]) : 256;
+    if (blockNodes < 1 || blockNodes > 65535)
+    {
+        fprintf(stderr, "Block nodes must be 1-65535\n");
+        return 2;
+    }
+
+    FILE *f = fopen(argv[1], "r");
+    if (!f)
+    {
+        perror(argv[1]);
+        return 1;
+    }
+    GraphBuilder builder;
+    std::string error;
+    const bool parsed = builder.parse(f, error);
+    fclose(f);
+    if (!parsed)
+    {
+        fprintf(stderr, "%s: %s\n", argv[1], error.c_str());
+        return 1;
+    }
+
+    GraphBuilder::Stats stats;
+    if (!builder.write(argv[2], (uint16_t)blockNodes, stats))
+    {
+        perror(argv[2]);
+        return 1;
+    }
+    printf("%s: %u nodes, %u edges, %u blocks, %zu bytes (largest block %zu bytes)\n", argv[2], stats.nodes,
+           stats.edges, stats.blocks, stats.bytes, stats.maxBlockBytes);
+    return 0;
+}
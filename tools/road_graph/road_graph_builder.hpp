@@ -0,0 +1,319 @@
+/**
+ * @file road_graph_builder.hpp
+ * @brief  Host builder of road graph packs (lib/routing/src/roadGraph.hpp) from an edge list
+ *
+ * Edge list text format, one item per line, '#' starts a comment:
+ *
+ *   N <id> <lat> <lon>                  node, any integer id
+ *   E <from> <to> [oneway] [factor]     road between two nodes
+ *
+ * oneway is 1 for a road that can only be driven from -> to (default 0). factor (>= 1,
+ * default 1) weights the length by road class, e.g. 1 for main roads and 1.5 for
+ * residential streets, so the router prefers main roads.
+ *
+ * Nodes are sorted along a Hilbert curve over the bounding box, so that the nodes of a
+ * block and the blocks a route crosses are few.
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+class GraphBuilder
+{
+public:
+    /**
+     * @brief Directed edge, node indices in input order
+     */
+    struct Arc
+    {
+        uint32_t from;
+        uint32_t to;
+        uint32_t cost;      /**< Weighted length (dm) */
+    };
+
+    /**
+     * @brief Pack written by write()
+     */
+    struct Stats
+    {
+        uint32_t nodes;
+        uint32_t edges;
+        uint32_t blocks;
+        size_t bytes;
+        size_t maxBlockBytes;
+    };
+
+    std::vector<int32_t> lat;           /**< Node latitude (1e-7 deg), input order */
+    std::vector<int32_t> lon;           /**< Node longitude (1e-7 deg), input order */
+    std::vector<Arc> arcs;              /**< Directed edges */
+    std::vector<uint32_t> packId;       /**< Node id in the pack, set by write() */
+
+    /**
+     * @brief Add a node
+     * @return false if the id is already used
+     */
+    bool addNode(int64_t id, double nodeLat, double nodeLon)
+    {
+        if (!ids.emplace(id, (uint32_t)lat.size()).second)
+            return false;
+        lat.push_back((int32_t)llround(nodeLat * 1e7));
+        lon.push_back((int32_t)llround(nodeLon * 1e7));
+        return true;
+    }
+
+    /**
+     * @brief Add a road, two arcs unless one-way
+     * @return false if a node is unknown or the factor is under 1
+     */
+    bool addEdge(int64_t fromId, int64_t toId, bool oneway, double factor)
+    {
+        const auto from = ids.find(fromId), to = ids.find(toId);
+        if (from == ids.end() || to == ids.end() || factor < 1.0 || from->second == to->second)
+            return false;
+        const uint32_t cost = edgeCost(from->second, to->second, factor);
+        arcs.push_back({from->second, to->second, cost});
+        if (!oneway)
+            arcs.push_back({to->second, from->second, cost});
+        return true;
+    }
+
+    /**
+     * @brief Read an edge list
+     * @param error Line and reason of the first error
+     */
+    bool parse(FILE *f, std::string &error)
+    {
+        char line[256];
+        unsigned number = 0;
+        while (fgets(line, sizeof(line), f))
+        {
+            number++;
+            char *comment = strchr(line, '#');
+            if (comment)
+                *comment = 0;
+            char kind = 0;
+            if (sscanf(line, " %c", &kind) != 1)
+                continue;
+
+            bool ok = false;
+            if (kind == 'N')
+            {
+                long long id;
+                double nodeLat, nodeLon;
+                ok = sscanf(line, " N %lld %lf %lf", &id, &nodeLat, &nodeLon) == 3 && fabs(nodeLat) <= 90.0 &&
+                     fabs(nodeLon) <= 180.0 && addNode(id, nodeLat, nodeLon);
+            }
+            else if (kind == 'E')
+            {
+                long long from, to;
+                int oneway = 0;
+                double factor = 1.0;
+                ok = sscanf(line, " E %lld %lld %d %lf", &from, &to, &oneway, &factor) >= 2 &&
+                     addEdge(from, to, oneway != 0, factor);
+            }
+            if (!ok)
+            {
+                error = "line " + std::to_string(number) + ": invalid or unknown node";
+                return false;
+            }
+        }
+        if (lat.empty())
+        {
+            error = "no nodes";
+            return false;
+        }
+        return true;
+    }
+
+    /**
+     * @brief Write the pack
+     * @param blockNodes Nodes per block
+     */
+    bool write(const char *path, uint16_t blockNodes, Stats &stats)
+    {
+        const uint32_t n = (uint32_t)lat.size();
+        if (n == 0 || blockNodes == 0)
+            return false;
+
+        // Hilbert order over the bounding box
+        int32_t bounds[4] = {lat[0], lon[0], lat[0], lon[0]};
+        for (uint32_t i = 0; i < n; i++)
+        {
+            bounds[0] = std::min(bounds[0], lat[i]);
+            bounds[1] = std::min(bounds[1], lon[i]);
+            bounds[2] = std::max(bounds[2], lat[i]);
+            bounds[3] = std::max(bounds[3], lon[i]);
+        }
+        const double spanLat = std::max<double>(bounds[2] - bounds[0], 1.0);
+        const double spanLon = std::max<double>(bounds[3] - bounds[1], 1.0);
+        std::vector<std::pair<uint64_t, uint32_t>> order(n);
+        for (uint32_t i = 0; i < n; i++)
+        {
+            const uint32_t x = (uint32_t)((lon[i] - bounds[1]) / spanLon * 65535.0);
+            const uint32_t y = (uint32_t)((lat[i] - bounds[0]) / spanLat * 65535.0);
+            order[i] = {hilbert(x, y), i};
+        }
+        std::sort(order.begin(), order.end());
+        packId.assign(n, 0);
+        for (uint32_t i = 0; i < n; i++)
+            packId[order[i].second] = i;
+
+        // Adjacency in pack ids
+        std::vector<Arc> out(arcs.size()), in(arcs.size());
+        for (size_t i = 0; i < arcs.size(); i++)
+        {
+            out[i] = {packId[arcs[i].from], packId[arcs[i].to], arcs[i].cost};
+            in[i] = out[i];
+        }
+        std::sort(out.begin(), out.end(), [](const Arc &a, const Arc &b) { return a.from != b.from ? a.from < b.from : a.to < b.to; });
+        std::sort(in.begin(), in.end(), [](const Arc &a, const Arc &b) { return a.to != b.to ? a.to < b.to : a.from < b.from; });
+
+        const uint32_t blocks = (n + blockNodes - 1) / blockNodes;
+        std::vector<uint8_t> index, payload;
+        const uint32_t indexOffset = 48;
+        uint32_t offset = indexOffset + blocks * 24;
+        size_t outPos = 0, inPos = 0;
+        stats.maxBlockBytes = 0;
+        for (uint32_t b = 0; b < blocks; b++)
+        {
+            const uint32_t first = b * blockNodes, count = std::min<uint32_t>(blockNodes, n - first);
+            std::vector<int32_t> bLat(count), bLon(count);
+            std::vector<uint32_t> outStart(count + 1), inStart(count + 1), outEdges, inEdges;
+            int32_t box[4] = {INT32_MAX, INT32_MAX, INT32_MIN, INT32_MIN};
+            for (uint32_t k = 0; k < count; k++)
+            {
+                const uint32_t src = order[first + k].second;
+                bLat[k] = lat[src];
+                bLon[k] = lon[src];
+                box[0] = std::min(box[0], lat[src]);
+                box[1] = std::min(box[1], lon[src]);
+                box[2] = std::max(box[2], lat[src]);
+                box[3] = std::max(box[3], lon[src]);
+                outStart[k] = (uint32_t)outEdges.size() / 2;
+                for (; outPos < out.size() && out[outPos].from == first + k; outPos++)
+                {
+                    outEdges.push_back(out[outPos].to);
+                    outEdges.push_back(out[outPos].cost);
+                }
+                inStart[k] = (uint32_t)inEdges.size() / 2;
+                for (; inPos < in.size() && in[inPos].to == first + k; inPos++)
+                {
+                    inEdges.push_back(in[inPos].from);
+                    inEdges.push_back(in[inPos].cost);
+                }
+            }
+            outStart[count] = (uint32_t)outEdges.size() / 2;
+            inStart[count] = (uint32_t)inEdges.size() / 2;
+
+            const size_t start = payload.size();
+            put16(payload, (uint16_t)count);
+            put16(payload, 0);
+            put32(payload, outStart[count]);
+            put32(payload, inStart[count]);
+            for (int32_t v : bLat) put32(payload, (uint32_t)v);
+            for (int32_t v : bLon) put32(payload, (uint32_t)v);
+            for (uint32_t v : outStart) put32(payload, v);
+            for (uint32_t v : inStart) put32(payload, v);
+            for (uint32_t v : outEdges) put32(payload, v);
+            for (uint32_t v : inEdges) put32(payload, v);
+            const uint32_t size = (uint32_t)(payload.size() - start);
+            stats.maxBlockBytes = std::max<size_t>(stats.maxBlockBytes, size);
+
+            put32(index, offset);
+            put32(index, size);
+            for (int32_t v : box) put32(index, (uint32_t)v);
+            offset += size;
+        }
+
+        std::vector<uint8_t> header;
+        header.insert(header.end(), {'R', 'G', 'R', '1'});
+        put16(header, 1);
+        put16(header, 48);
+        put32(header, n);
+        put32(header, (uint32_t)arcs.size());
+        put32(header, blocks);
+        put16(header, blockNodes);
+        put16(header, 0);
+        for (int32_t v : bounds) put32(header, (uint32_t)v);
+        put32(header, indexOffset);
+        put32(header, fnv1a(index));
+
+        FILE *f = fopen(path, "wb");
+        if (!f)
+            return false;
+        const bool ok = fwrite(header.data(), 1, header.size(), f) == header.size() &&
+                        fwrite(index.data(), 1, index.size(), f) == index.size() &&
+                        fwrite(payload.data(), 1, payload.size(), f) == payload.size();
+        fclose(f);
+
+        stats.nodes = n;
+        stats.edges = (uint32_t)arcs.size();
+        stats.blocks = blocks;
+        stats.bytes = header.size() + index.size() + payload.size();
+        return ok;
+    }
+
+private:
+    std::unordered_map<int64_t, uint32_t> ids;  /**< Input id to node index */
+
+    /**
+     * @brief Haversine length (dm) weighted by the road class, at least 1
+     */
+    uint32_t edgeCost(uint32_t a, uint32_t b, double factor) const
+    {
+        const double rad = M_PI / 180.0 * 1e-7;
+        const double lat1 = lat[a] * rad, lat2 = lat[b] * rad;
+        const double dLat = lat2 - lat1, dLon = (lon[b] - lon[a]) * rad;
+        const double h = sin(dLat / 2) * sin(dLat / 2) + cos(lat1) * cos(lat2) * sin(dLon / 2) * sin(dLon / 2);
+        const double meters = 2.0 * 6378137.0 * asin(std::min(1.0, sqrt(h)));
+        return std::max<uint32_t>(1, (uint32_t)ceil(meters * 10.0 * factor));
+    }
+
+    static uint64_t hilbert(uint32_t x, uint32_t y)
+    {
+        uint64_t d = 0;
+        for (uint32_t s = 1u << 15; s > 0; s >>= 1)
+        {
+            const uint32_t rx = (x & s) ? 1 : 0, ry = (y & s) ? 1 : 0;
+            d += (uint64_t)s * s * ((3 * rx) ^ ry);
+            if (ry == 0)
+            {
+                if (rx == 1)
+                {
+                    x = 0xFFFF - x;
+                    y = 0xFFFF - y;
+                }
+                std::swap(x, y);
+            }
+        }
+        return d;
+    }
+
+    static uint32_t fnv1a(const std::vector<uint8_t> &data)
+    {
+        uint32_t hash = 2166136261u;
+        for (uint8_t c : data)
+            hash = (hash ^ c) * 16777619u;
+        return hash;
+    }
+
+    static void put16(std::vector<uint8_t> &buf, uint16_t v)
+    {
+        buf.push_back(v & 0xFF);
+        buf.push_back(v >> 8);
+    }
+
+    static void put32(std::vector<uint8_t> &buf, uint32_t v)
+    {
+        for (int i = 0; i < 4; i++)
+            buf.push_back((v >> (8 * i)) & 0xFF);
+    }
+};
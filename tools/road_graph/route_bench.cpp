@@ -0,0 +1,490 @@
+/**
+ * @file route_bench.cpp
+ * @brief  Host benchmark and checks for the road graph pack and the bidirectional A* router
+ *
+ * Generates a synthetic city (grid of streets with main roads every 10 blocks, one-way
+ * streets, missing links and an island without road to it) as an edge list, builds the
+ * pack with road_graph_builder.hpp and runs random queries through lib/routing. Each
+ * route cost is checked against a Dijkstra search over the whole graph in memory, and
+ * the settled nodes, block reads and query times are reported. Then it checks the
+ * limits, a corrupt pack, the region lookup and a reroute back to a track.
+ *
+ * Build: g++ -O2 -std=c++17 -I../host -I../../lib/gpx/src -I../../lib/utils/src -I../../lib/routing/src
+ *        route_bench.cpp ../../lib/routing/src/roadGraph.cpp ../../lib/routing/src/router.cpp
+ *        ../../lib/routing/src/reroute.cpp ../../lib/utils/src/navigation.cpp ../../lib/gpx/src/trackGrid.cpp
+ *        ../../lib/gpx/src/turnScan.cpp ../../lib/utils/src/gpsMath.cpp -o route_bench
+ */
+
+#include "road_graph_builder.hpp"
+#include "roadGraph.hpp"
+#include "router.hpp"
+#include "reroute.hpp"
+#include "turnScan.hpp"
+
+#include <chrono>
+#include <cstdlib>
+#include <queue>
+#include <random>
+#include <sys/stat.h>
+
+using Clock = std::chrono::steady_clock;
+
+static uint32_t failures = 0;
+
+static void check(bool condition, const char *what)
+{
+    printf("  %-44s %s\n", what, condition ? "ok" : "FAIL");
+    if (!condition)
+        failures++;
+}
+
+static double elapsedMs(Clock::time_point t0)
+{
+    return std::chrono::duration<double, std::milli>(Clock::now() - t0).count();
+}
+
+static const uint32_t INF = 0xFFFFFFFF;
+static const double ORIGIN_LAT = 41.35, ORIGIN_LON = 2.10;
+static const double SPACING = 80.0;     /**< Street block (m) */
+
+/**
+ * @brief Synthetic city edge list
+ *
+ * @param size Streets per side
+ * @return Edge list text
+ */
+static std::string makeCity(int size)
+{
+    std::mt19937 rng(11);
+    std::uniform_real_distribution<double> jitter(-15.0, 15.0);
+    std::uniform_real_distribution<double> unit(0.0, 1.0);
+    const double degLat = SPACING / 111319.49, degLon = degLat / cos(ORIGIN_LAT * M_PI / 180.0);
+
+    std::string text = "# synthetic city\n";
+    char line[128];
+    for (int r = 0; r < size; r++)
+        for (int c = 0; c < size; c++)
+        {
+            snprintf(line, sizeof(line), "N %d %.7f %.7f\n", r * size + c + 1000,
+                     ORIGIN_LAT + (r + jitter(rng) / SPACING) * degLat, ORIGIN_LON + (c + jitter(rng) / SPACING) * degLon);
+            text += line;
+        }
+
+    for (int r = 0; r < size; r++)
+        for (int c = 0; c < size; c++)
+        {
+            const int id = r * size + c + 1000;
+            // East street: main road every 10 rows, one-way east or west on odd rows
+            if (c + 1 < size)
+            {
+                const bool main = r % 10 == 0;
+                if (main || unit(rng) > 0.04)
+                {
+                    if (!main && r % 4 == 3)
+                        snprintf(line, sizeof(line), "E %d %d 1 1.5\n", id + 1, id);
+                    else
+                        snprintf(line, sizeof(line), "E %d %d %d %.1f\n", id, id + 1, !main && r % 4 == 1,
+                                 main ? 1.0 : 1.5);
+                    text += line;
+                }
+            }
+            // North street: main road every 10 columns, one-way north on some columns
+            if (r + 1 < size)
+            {
+                const bool main = c % 10 == 0;
+                if (main || unit(rng) > 0.04)
+                {
+                    snprintf(line, sizeof(line), "E %d %d %d %.1f\n", id, id + size, !main && c % 4 == 2,
+                             main ? 1.0 : 1.5);
+                    text += line;
+                }
+            }
+        }
+
+    // Island 3 km north, no road to it
+    for (int k = 0; k < 9; k++)
+    {
+        snprintf(line, sizeof(line), "N %d %.7f %.7f\n", 900000 + k, ORIGIN_LAT + (size + 40 + k / 3) * degLat,
+                 ORIGIN_LON + (k % 3) * degLon);
+        text += line;
+    }
+    for (int k = 0; k < 9; k++)
+    {
+        if (k % 3 < 2)
+        {
+            snprintf(line, sizeof(line), "E %d %d\n", 900000 + k, 900001 + k);
+            text += line;
+        }
+        if (k < 6)
+        {
+            snprintf(line, sizeof(line), "E %d %d\n", 900000 + k, 900003 + k);
+            text += line;
+        }
+    }
+    return text;
+}
+
+static bool writeText(const std::string &path, const std::string &text)
+{
+    FILE *f = fopen(path.c_str(), "w");
+    if (!f)
+        return false;
+    const bool ok = fwrite(text.data(), 1, text.size(), f) == text.size();
+    fclose(f);
+    return ok;
+}
+
+static bool buildPack(const std::string &text, const std::string &path, uint16_t blockNodes, GraphBuilder &builder,
+                      GraphBuilder::Stats &stats)
+{
+    const std::string listPath = path + ".txt";
+    std::string error;
+    if (!writeText(listPath, text))
+        return false;
+    FILE *f = fopen(listPath.c_str(), "r");
+    const bool ok = f && builder.parse(f, error) && builder.write(path.c_str(), blockNodes, stats);
+    if (f)
+        fclose(f);
+    remove(listPath.c_str());
+    if (!error.empty())
+        fprintf(stderr, "%s\n", error.c_str());
+    return ok;
+}
+
+/**
+ * @brief Reference: Dijkstra over the whole graph in memory
+ */
+struct Reference
+{
+    std::vector<uint32_t> start;
+    std::vector<GraphBuilder::Arc> arcs;
+
+    explicit Reference(const GraphBuilder &builder) : start(builder.lat.size() + 1, 0), arcs(builder.arcs)
+    {
+        std::sort(arcs.begin(), arcs.end(), [](const GraphBuilder::Arc &a, const GraphBuilder::Arc &b) { return a.from < b.from; });
+        for (const auto &a : arcs)
+            start[a.from + 1]++;
+        for (size_t i = 1; i < start.size(); i++)
+            start[i] += start[i - 1];
+    }
+
+    uint32_t cost(uint32_t from, uint32_t to, uint32_t &settled) const
+    {
+        std::vector<uint32_t> dist(start.size() - 1, INF);
+        typedef std::pair<uint32_t, uint32_t> Item;
+        std::priority_queue<Item, std::vector<Item>, std::greater<Item>> q;
+        dist[from] = 0;
+        q.push({0, from});
+        settled = 0;
+        while (!q.empty())
+        {
+            const Item top = q.top();
+            q.pop();
+            if (top.first != dist[top.second])
+                continue;
+            settled++;
+            if (top.second == to)
+                return top.first;
+            for (uint32_t e = start[top.second]; e < start[top.second + 1]; e++)
+            {
+                const uint32_t d = top.first + arcs[e].cost;
+                if (d < dist[arcs[e].to])
+                {
+                    dist[arcs[e].to] = d;
+                    q.push({d, arcs[e].to});
+                }
+            }
+        }
+        return INF;
+    }
+};
+
+static float nodeLat(const GraphBuilder &b, uint32_t i) { return b.lat[i] * 1e-7f; }
+static float nodeLon(const GraphBuilder &b, uint32_t i) { return b.lon[i] * 1e-7f; }
+
+/**
+ * @brief Nearest distance from a position to the points of a track
+ */
+static float distToPoints(const TrackVector &track, float lat, float lon)
+{
+    float best = 1e9f;
+    for (size_t i = 0; i < track.size(); i++)
+        best = std::min(best, calcDistUncached(lat, lon, track.lat[i], track.lon[i]));
+    return best;
+}
+
+int main(int argc, char **argv)
+{
+    const int size = argc > 1 ? atoi(argv[1]) : 150;
+    const int queries = argc > 2 ? atoi(argv[2]) : 300;
+    const std::string dir = "/tmp/route_bench";
+    const std::string folder = dir + "/ROUTE";
+    mkdir(dir.c_str(), 0755);
+    mkdir(folder.c_str(), 0755);
+    const std::string packPath = folder + "/city.rgr";
+
+    const std::string city = makeCity(size);
+    GraphBuilder builder;
+    GraphBuilder::Stats stats;
+    const auto tb = Clock::now();
+    if (!buildPack(city, packPath, 256, builder, stats))
+    {
+        fprintf(stderr, "Can't build %s\n", packPath.c_str());
+        return 1;
+    }
+    printf("Pack\t\t: %u nodes, %u edges, %u blocks, %zu KB (largest block %zu bytes), built in %.0f ms\n",
+           stats.nodes, stats.edges, stats.blocks, stats.bytes / 1024, stats.maxBlockBytes, elapsedMs(tb));
+
+    std::vector<uint32_t> outDeg(builder.lat.size(), 0), inDeg(builder.lat.size(), 0);
+    for (const auto &a : builder.arcs)
+    {
+        outDeg[a.from]++;
+        inDeg[a.to]++;
+    }
+    const uint32_t gridNodes = (uint32_t)(size * size);
+    std::mt19937 rng(5);
+    std::uniform_int_distribution<uint32_t> pick(0, gridNodes - 1);
+    auto randomNode = [&](bool incoming) {
+        uint32_t n;
+        do
+            n = pick(rng);
+        while ((incoming ? inDeg[n] : outDeg[n]) == 0);
+        return n;
+    };
+
+    Reference reference(builder);
+    RoadGraph graph;
+    check(graph.open(packPath.c_str()), "pack opens");
+
+    Router router;
+    RouteParams params;
+    TrackVector track;
+    std::vector<TurnPoint> turns;
+    std::vector<double> times;
+    uint64_t routerSettled = 0, dijkstraSettled = 0;
+    uint32_t optimal = 0, found = 0, unreachable = 0, limited = 0, mismatched = 0, withTurns = 0;
+    bool trackOk = true;
+    size_t maxWorking = 0;
+
+    for (int q = 0; q < queries; q++)
+    {
+        const uint32_t from = randomNode(false), to = randomNode(true);
+        uint32_t refSettled;
+        const uint32_t refCost = reference.cost(from, to, refSettled);
+        const float fLat = nodeLat(builder, from), fLon = nodeLon(builder, from);
+        const float tLat = nodeLat(builder, to), tLon = nodeLon(builder, to);
+
+        const auto t0 = Clock::now();
+        const RouteStatus status = router.route(graph, fLat, fLon, tLat, tLon, params, track, turns);
+        times.push_back(elapsedMs(t0));
+        maxWorking = std::max(maxWorking, router.workingBytes());
+
+        // Long queries on a large city may need more than the working set
+        if (status == ROUTE_LIMIT)
+        {
+            limited++;
+            continue;
+        }
+        if (refCost == INF)
+        {
+            unreachable++;
+            if (status != ROUTE_NOT_FOUND)
+                mismatched++;
+            continue;
+        }
+        if (status != ROUTE_OK)
+        {
+            mismatched++;
+            continue;
+        }
+        found++;
+        routerSettled += router.settled;
+        dijkstraSettled += refSettled;
+        if (router.cost == refCost)
+            optimal++;
+        else
+            printf("  query %d: cost %u, reference %u\n", q, router.cost, refCost);
+        withTurns += !turns.empty();
+
+        // Track from the start to the end, points every 20 m at most, cost between 1 and 1.5 times its length
+        const float length = track.accumDist[track.size() - 1];
+        trackOk &= track.lat[0] == fLat && track.lon[0] == fLon && track.lat[track.size() - 1] == tLat &&
+                   track.lon[track.size() - 1] == tLon;
+        trackOk &= length * 10.0f <= router.cost + 10.0f && length * 15.0f >= router.cost * 0.99f;
+        for (size_t i = 1; i < track.size(); i++)
+            trackOk &= track.accumDist[i] > track.accumDist[i - 1] && track.accumDist[i] - track.accumDist[i - 1] <= 20.01f;
+    }
+
+    std::sort(times.begin(), times.end());
+    double total = 0.0;
+    for (double t : times)
+        total += t;
+    printf("Queries\t\t: %d (%u routes, %u unreachable, %u over %u nodes)\n", queries, found, unreachable, limited,
+           params.maxNodes);
+    printf("Query time\t: %.2f ms mean, %.2f ms p95, %.2f ms max\n", total / times.size(),
+           times[times.size() * 95 / 100], times.back());
+    printf("Settled nodes\t: %.0f bidirectional A*, %.0f Dijkstra\n", (double)routerSettled / std::max(found, 1u),
+           (double)dijkstraSettled / std::max(found, 1u));
+    printf("Block cache\t: %u reads, %u hits, %zu KB of %u blocks, working set %zu KB\n", graph.blockLoads,
+           graph.blockHits, graph.cacheBytes() / 1024, (unsigned)RoadGraph::DEFAULT_BLOCKS, maxWorking / 1024);
+
+    printf("Routes\n");
+    check(optimal == found && mismatched == 0, "same cost as Dijkstra on every query");
+    check(routerSettled < dijkstraSettled / 2, "settles less than half the Dijkstra nodes");
+    check(trackOk, "track from start to end, 20 m spacing");
+    check(withTurns > 0, "turns detected on the routes");
+    check(graph.cacheBytes() <= RoadGraph::DEFAULT_BLOCKS * stats.maxBlockBytes, "block cache bounded");
+
+    // Small cache: blocks are read again, routes stay the same
+    RoadGraph small;
+    small.open(packPath.c_str(), 4);
+    bool smallOk = true;
+    for (int q = 0; q < 20; q++)
+    {
+        const uint32_t from = randomNode(false), to = randomNode(true);
+        uint32_t refSettled;
+        const uint32_t refCost = reference.cost(from, to, refSettled);
+        const RouteStatus status = router.route(small, nodeLat(builder, from), nodeLon(builder, from),
+                                                nodeLat(builder, to), nodeLon(builder, to), params, track, turns);
+        smallOk &= refCost == INF ? status == ROUTE_NOT_FOUND : status == ROUTE_OK && router.cost == refCost;
+    }
+    check(smallOk && small.blockLoads > stats.blocks, "4 block cache gives the same routes");
+    check(small.cacheBytes() <= 4 * stats.maxBlockBytes, "4 block cache bounded");
+
+    printf("Limits\n");
+    const uint32_t island = gridNodes + 4;
+    RouteStatus status = router.route(graph, nodeLat(builder, 0), nodeLon(builder, 0), nodeLat(builder, island),
+                                      nodeLon(builder, island), params, track, turns);
+    check(status == ROUTE_NOT_FOUND && router.settled < 100, "island not reachable, found quickly");
+    check(track.empty() && turns.empty(), "no track without route");
+
+    RouteParams tight;
+    tight.maxNodes = 200;
+    status = router.route(graph, nodeLat(builder, 0), nodeLon(builder, 0), nodeLat(builder, gridNodes - 1),
+                          nodeLon(builder, gridNodes - 1), tight, track, turns);
+    check(status == ROUTE_LIMIT, "working set limit");
+
+    status = router.route(graph, 40.0f, 1.0f, nodeLat(builder, 0), nodeLon(builder, 0), params, track, turns);
+    check(status == ROUTE_NO_START, "start far from the roads");
+    status = router.route(graph, nodeLat(builder, 0), nodeLon(builder, 0), 40.0f, 1.0f, params, track, turns);
+    check(status == ROUTE_NO_END, "end far from the roads");
+    RoadGraph closed;
+    status = router.route(closed, 41.36f, 2.11f, 41.37f, 2.12f, params, track, turns);
+    check(status == ROUTE_NO_GRAPH, "no open pack");
+
+    printf("Pack files\n");
+    std::vector<uint8_t> pack;
+    {
+        FILE *f = fopen(packPath.c_str(), "rb");
+        uint8_t buf[65536];
+        size_t n;
+        while ((n = fread(buf, 1, sizeof(buf), f)) > 0)
+            pack.insert(pack.end(), buf, buf + n);
+        fclose(f);
+    }
+    const std::string corrupt = dir + "/corrupt.rgr";
+    std::vector<uint8_t> bad = pack;
+    bad[48 + 8] ^= 0x40;    // first block bounding box
+    writeText(corrupt, std::string(bad.begin(), bad.end()));
+    RoadGraph badGraph;
+    check(!badGraph.open(corrupt.c_str()), "corrupt block index rejected");
+
+    bad = pack;
+    uint32_t firstBlock;
+    memcpy(&firstBlock, &pack[48], 4);
+    bad[firstBlock] = 0xFF;  // first block node count
+    bad[firstBlock + 1] = 0xFF;
+    writeText(corrupt, std::string(bad.begin(), bad.end()));
+    int32_t lat0, lon0;
+    graph.coords(0, lat0, lon0);
+    RouteParams snap;
+    snap.snapDist = 5.0f;
+    bool badOk = badGraph.open(corrupt.c_str());
+    status = router.route(badGraph, lat0 * 1e-7f, lon0 * 1e-7f, nodeLat(builder, gridNodes / 2),
+                          nodeLon(builder, gridNodes / 2), snap, track, turns);
+    check(badOk && status != ROUTE_OK, "corrupt block not used");
+    remove(corrupt.c_str());
+
+    GraphBuilder wide;
+    GraphBuilder::Stats wideStats;
+    buildPack(city + "N 1 40.8 1.6\nN 2 41.9 2.7\n", folder + "/wide.rgr", 256, wide, wideStats);
+    std::string path;
+    check(RoadGraph::findRegion(folder.c_str(), nodeLat(builder, 0), nodeLon(builder, 0), path) && path == packPath,
+          "region lookup picks the smallest pack");
+    check(RoadGraph::findRegion(folder.c_str(), 41.7f, 2.5f, path) && path == folder + "/wide.rgr",
+          "region lookup outside the city");
+    check(!RoadGraph::findRegion(folder.c_str(), 10.0f, 10.0f, path), "no region for a far position");
+
+    GraphBuilder invalid;
+    std::string error;
+    writeText(dir + "/invalid.txt", "N 1 41.0 2.0\nE 1 2\n");
+    FILE *f = fopen((dir + "/invalid.txt").c_str(), "r");
+    check(!invalid.parse(f, error) && error.find("line 2") == 0, "edge list error reported with its line");
+    fclose(f);
+    remove((dir + "/invalid.txt").c_str());
+
+    printf("Reroute\n");
+    // Track along the main road of row 40, columns 10 to 120
+    const int row = 40, c0 = 10, c1 = std::min(120, size - 1);
+    TrackVector main;
+    for (int c = c0; c <= c1; c++)
+    {
+        const uint32_t n = row * size + c;
+        main.push_back(nodeLat(builder, n), nodeLon(builder, n), 0.0f);
+        if (main.size() > 1)
+            main.accumDist[main.size() - 1] = main.accumDist[main.size() - 2] +
+                calcDistUncached(main.lat[main.size() - 2], main.lon[main.size() - 2], main.lat[main.size() - 1],
+                                 main.lon[main.size() - 1]);
+    }
+    TrackGrid mainGrid;
+    mainGrid.build(main);
+    const std::vector<TurnPoint> mainTurns = TurnScan::detect(main, {18.0f, 10, 70.0f, 5});
+    NavConfig config;
+    config.searchWindow = 150;
+    config.offTrackThreshold = 75.0f;
+    config.maxBackwardJump = 10;
+    NavState state;
+    Rerouter rerouter(folder.c_str());
+    NavResult onTrack;
+    auto step = [&](uint32_t n, uint32_t timeMs, NavResult &result) {
+        const float lat = nodeLat(builder, n), lon = nodeLon(builder, n);
+        onTrack = updateNavigation(lat, lon, 90.0f, 30.0f, main, mainGrid, mainTurns, state, 20, 200, config);
+        result = onTrack;
+        return rerouter.update(lat, lon, 90.0f, 30.0f, main, onTrack, config, timeMs, result);
+    };
+
+    NavResult result;
+    const bool startOn = !step(row * size + 30, 0, result) && result.icon != NAV_ICON_OFF_TRACK;
+    const uint32_t away = (row + 6) * size + 32;
+    const bool waits = !step(away, 1000, result) && result.icon == NAV_ICON_OFF_TRACK && !step(away, 10000, result);
+    const bool routed = step(away, 11000, result) && rerouter.active() && result.icon != NAV_ICON_OFF_TRACK;
+    check(startOn && waits, "no route before 10 s off the track");
+    check(routed && rerouter.lastStatus == ROUTE_OK, "route after 10 s off the track");
+    check(routed && result.loadedIdx == onTrack.trackIdx, "loaded track segment kept on the route");
+    if (routed)
+    {
+        const TrackVector &r = rerouter.routeTrack;
+        const float endLat = r.lat[r.size() - 1], endLon = r.lon[r.size() - 1];
+        check(distToPoints(main, endLat, endLon) < 1.0f, "route ends on the track");
+        check(calcDistUncached(r.lat[0], r.lon[0], nodeLat(builder, away), nodeLon(builder, away)) < 1.0f,
+              "route starts at the position");
+        const uint32_t half = (row + 3) * size + 34;
+        check(distToPoints(r, nodeLat(builder, half), nodeLon(builder, half)) > 75.0f ||
+              (step(half, 14000, result) && result.icon != NAV_ICON_OFF_TRACK), "instructions along the route");
+    }
+    check(!step(row * size + 40, 20000, result) && !rerouter.active(), "route dropped back on the track");
+
+    Rerouter noPacks((dir + "/none").c_str());
+    state = NavState{};
+    {
+        const float lat = nodeLat(builder, away), lon = nodeLon(builder, away);
+        const NavResult off = updateNavigation(lat, lon, 90.0f, 30.0f, main, mainGrid, mainTurns, state, 20, 200, config);
+        NavResult r;
+        noPacks.update(lat, lon, 90.0f, 30.0f, main, off, config, 0, r);
+        check(!noPacks.update(lat, lon, 90.0f, 30.0f, main, off, config, 11000, r) &&
+              noPacks.lastStatus == ROUTE_NO_GRAPH, "no pack for the region");
+    }
+
+    printf("%s\n", failures ? "FAILED" : "All checks passed");
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,322 @@
+#!/usr/bin/env python3
+# IceNav Project
+# SD access trace replay simulator
+#
+# Replays a trace dumped by Storage::dumpTrace (CLI `sdtrace dump` or the
+# web server /sdtrace endpoint) against a configurable SD card latency model,
+# with and without caching, readahead and coalescing policies, so they can be
+# evaluated offline against real map access patterns.
+
+import argparse
+import re
+import sys
+from collections import OrderedDict, defaultdict
+
+OPS = {"O": "open", "R": "read", "W": "write", "S": "seek", "C": "close"}
+FLAG_ERROR = 0x01
+FLAG_ASYNC = 0x02
+
+
+class Event:
+    __slots__ = ("time", "op", "file", "offset", "size", "duration", "flags")
+
+    def __init__(self, time, op, file, offset, size, duration, flags):
+        self.time = time
+        self.op = op
+        self.file = file
+        self.offset = offset
+        self.size = size
+        self.duration = duration
+        self.flags = flags
+
+
+def load_trace(path):
+    """Parse a trace dump into (paths, events)."""
+    paths = {}
+    events = []
+    with open(path, "r", errors="replace") as f:
+        for line_no, line in enumerate(f, 1):
+            line = line.strip()
+            if not line or line.startswith("#"):
+                continue
+            if line.startswith("F "):
+                _, file_id, name = line.split(" ", 2)
+                paths[int(file_id)] = name
+                continue
+            fields = line.split()
+            if len(fields) != 7 or fields[1] not in OPS:
+                print("%s:%d: skipped malformed line" % (path, line_no), file=sys.stderr)
+                continue
+            events.append(Event(int(fields[0]), fields[1], int(fields[2]), int(fields[3]),
+                                int(fields[4]), int(fields[5]), int(fields[6])))
+    return paths, events
+
+
+class Model:
+    """SD card latency model."""
+
+    def __init__(self, args):
+        self.op_overhead = args.op_overhead
+        self.open_cost = args.open_cost
+        self.seek_cost = args.seek_cost
+        self.read_mbs = args.mbps
+        self.write_mbs = args.write_mbps or args.mbps
+        self.sector = args.sector
+
+    def transfer_us(self, offset, size, mbs):
+        # The card moves whole sectors
+        start = offset - offset % self.sector
+        end = -(-(offset + size) // self.sector) * self.sector
+        return (end - start) / mbs
+
+
+class Policy:
+    """Access policies under evaluation."""
+
+    def __init__(self, args, enabled):
+        self.cache_bytes = args.cache * 1024 if enabled else 0
+        self.readahead = args.readahead * 1024 if enabled else 0
+        self.coalesce_us = args.coalesce if enabled else -1
+        self.block = args.block
+        self.cache_files = re.compile(args.cache_files) if args.cache_files else None
+        if self.readahead and self.cache_bytes < 2 * self.readahead:
+            # Readahead lands in the block cache, give it room for two windows
+            self.cache_bytes = 2 * self.readahead
+
+    def describe(self):
+        parts = []
+        if self.cache_bytes:
+            parts.append("cache %d KB/%d B blocks%s" % (self.cache_bytes // 1024, self.block,
+                                                        " (%s)" % self.cache_files.pattern if self.cache_files else ""))
+        if self.readahead:
+            parts.append("readahead %d KB" % (self.readahead // 1024))
+        if self.coalesce_us >= 0:
+            parts.append("coalesce %d us" % self.coalesce_us)
+        return ", ".join(parts) if parts else "none"
+
+
+class Simulator:
+    def __init__(self, model, policy, paths):
+        self.model = model
+        self.policy = policy
+        self.paths = paths
+        self.cache = OrderedDict()
+        self.last_file = None
+        self.last_end = -1
+        self.last_read_time = -1
+        self.total_us = 0.0
+        self.device_ops = 0
+        self.device_bytes = 0
+        self.seeks = 0
+        self.hits = 0
+        self.lookups = 0
+        self.per_op = defaultdict(lambda: [0, 0, 0.0])
+        self.per_file = defaultdict(lambda: [0, 0, 0.0])
+
+    def cacheable(self, file_id):
+        if not self.policy.cache_bytes:
+            return False
+        if not self.policy.cache_files:
+            return True
+        return bool(self.policy.cache_files.search(self.paths.get(file_id, "")))
+
+    def device(self, file_id, offset, size, write, time):
+        """Cost of one card command."""
+        us = self.model.op_overhead
+        contiguous = file_id == self.last_file and offset == self.last_end
+        if not write and contiguous and self.policy.coalesce_us >= 0 and \
+                0 <= time - self.last_read_time <= self.policy.coalesce_us:
+            # Merged with the previous read command
+            us = 0.0
+        elif not contiguous:
+            us += self.model.seek_cost
+            self.seeks += 1
+        us += self.model.transfer_us(offset, size, self.model.write_mbs if write else self.model.read_mbs)
+        self.last_file = file_id
+        self.last_end = offset + size
+        if not write:
+            self.last_read_time = time
+        self.device_ops += 1
+        self.device_bytes += size
+        return us
+
+    def cache_insert(self, key):
+        self.cache[key] = True
+        self.cache.move_to_end(key)
+        while len(self.cache) * self.policy.block > self.policy.cache_bytes:
+            self.cache.popitem(last=False)
+
+    def read(self, ev):
+        if not self.cacheable(ev.file):
+            return self.device(ev.file, ev.offset, ev.size, False, ev.time)
+
+        block = self.policy.block
+        first = ev.offset // block
+        last = (ev.offset + max(ev.size, 1) - 1) // block
+        us = 0.0
+        run_start = None
+        for b in range(first, last + 2):
+            missing = b <= last and (ev.file, b) not in self.cache
+            if b <= last:
+                self.lookups += 1
+                if not missing:
+                    self.hits += 1
+                    self.cache.move_to_end((ev.file, b))
+            if missing and run_start is None:
+                run_start = b
+            elif not missing and run_start is not None:
+                end = b
+                if b > last and self.policy.readahead:
+                    end = b + self.policy.readahead // block
+                us += self.device(ev.file, run_start * block, (end - run_start) * block, False, ev.time)
+                for k in range(run_start, end):
+                    self.cache_insert((ev.file, k))
+                run_start = None
+        return us
+
+    def write(self, ev):
+        if self.policy.cache_bytes:
+            block = self.policy.block
+            for b in range(ev.offset // block, (ev.offset + max(ev.size, 1) - 1) // block + 1):
+                self.cache.pop((ev.file, b), None)
+        return self.device(ev.file, ev.offset, ev.size, True, ev.time)
+
+    def run(self, events):
+        for ev in events:
+            if ev.op == "O":
+                us = self.model.open_cost
+            elif ev.op == "R":
+                us = self.read(ev)
+            elif ev.op == "W":
+                us = self.write(ev)
+            elif ev.op == "C":
+                us = self.model.op_overhead
+            else:
+                # Seeks only move the file position, the cost shows up on the next access
+                us = 0.0
+            self.total_us += us
+            stats = self.per_op[ev.op]
+            stats[0] += 1
+            stats[1] += ev.size
+            stats[2] += us
+            stats = self.per_file[ev.file]
+            stats[0] += 1
+            stats[1] += ev.size
+            stats[2] += us
+
+
+def calibrate(events):
+    """Fit duration = overhead + size / MBs over the traced reads, split by access pattern."""
+    reads = [ev for ev in events if ev.op == "R" and not ev.flags & FLAG_ERROR and ev.size > 0]
+    if len(reads) < 2:
+        return None
+    n = len(reads)
+    sx = sum(ev.size for ev in reads)
+    sy = sum(ev.duration for ev in reads)
+    sxx = sum(ev.size * ev.size for ev in reads)
+    sxy = sum(ev.size * ev.duration for ev in reads)
+    den = n * sxx - sx * sx
+    if den == 0:
+        return None
+    slope = (n * sxy - sx * sy) / den
+    overhead = (sy - slope * sx) / n
+    mbs = 1.0 / slope if slope > 0 else 0.0
+
+    # Residual of reads that do not continue the previous access on the card
+    fitted = set(id(ev) for ev in reads)
+    last = (None, -1)
+    random_res = []
+    seq_res = []
+    for ev in events:
+        if ev.op not in "RW":
+            continue
+        if id(ev) in fitted:
+            residual = ev.duration - overhead - ev.size * slope
+            (seq_res if (ev.file, ev.offset) == last else random_res).append(residual)
+        last = (ev.file, ev.offset + ev.size)
+    seek = 0.0
+    if random_res and seq_res:
+        seek = sum(random_res) / len(random_res) - sum(seq_res) / len(seq_res)
+    return overhead, mbs, seek, len(random_res), len(seq_res)
+
+
+def print_run(title, sim, paths, measured_us, top):
+    print("== %s: %s" % (title, sim.policy.describe()))
+    print("Simulated %.1f ms (traced %.1f ms), %d card commands, %.1f KB, %d seeks" %
+          (sim.total_us / 1000, measured_us / 1000, sim.device_ops, sim.device_bytes / 1024, sim.seeks))
+    if sim.lookups:
+        print("Cache hits %d/%d blocks (%.1f%%)" % (sim.hits, sim.lookups, 100.0 * sim.hits / sim.lookups))
+    print("%-6s %8s %10s %12s" % ("op", "count", "KB", "sim ms"))
+    for op in "ORWSC":
+        if op in sim.per_op:
+            count, size, us = sim.per_op[op]
+            print("%-6s %8d %10.1f %12.1f" % (OPS[op], count, size / 1024, us / 1000))
+    print("%-12s %8s %10s %12s  %s" % ("file", "ops", "KB", "sim ms", "path"))
+    ranked = sorted(sim.per_file.items(), key=lambda item: -item[1][2])
+    for file_id, (count, size, us) in ranked[:top]:
+        print("%-12d %8d %10.1f %12.1f  %s" % (file_id, count, size / 1024, us / 1000, paths.get(file_id, "?")))
+    print()
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Replay an IceNav SD access trace against a latency model")
+    parser.add_argument("trace", help="trace dump (sdtrace dump / http://icenav.local/sdtrace)")
+    model = parser.add_argument_group("latency model")
+    model.add_argument("--op-overhead", type=float, default=300.0, help="per command overhead, us (default 300)")
+    model.add_argument("--open-cost", type=float, default=2000.0, help="file open cost, us (default 2000)")
+    model.add_argument("--seek-cost", type=float, default=500.0,
+                       help="extra cost of a non sequential access, us (default 500)")
+    model.add_argument("--mbps", type=float, default=2.2, help="read bandwidth, MB/s (default 2.2, SDSPI 20 MHz)")
+    model.add_argument("--write-mbps", type=float, default=0.0, help="write bandwidth, MB/s (default: --mbps)")
+    model.add_argument("--sector", type=int, default=512, help="sector size, bytes (default 512)")
+    model.add_argument("--calibrate", action="store_true", help="fit the model to the traced durations and use it")
+    policy = parser.add_argument_group("policies")
+    policy.add_argument("--cache", type=int, default=0, help="LRU block cache size, KB")
+    policy.add_argument("--block", type=int, default=4096, help="cache block size, bytes (default 4096)")
+    policy.add_argument("--cache-files", help="regex, only cache matching paths (e.g. index files)")
+    policy.add_argument("--readahead", type=int, default=0, help="read ahead on cache misses, KB")
+    policy.add_argument("--coalesce", type=int, default=-1,
+                        help="merge sequential reads issued within this many us into one command")
+    parser.add_argument("--top", type=int, default=10, help="files listed (default 10)")
+    args = parser.parse_args()
+
+    paths, events = load_trace(args.trace)
+    if not events:
+        print("No events in %s" % args.trace)
+        return 1
+
+    measured_us = sum(ev.duration for ev in events)
+    span_ms = (events[-1].time + events[-1].duration - events[0].time) / 1000
+    async_ops = sum(1 for ev in events if ev.flags & FLAG_ASYNC)
+    print("Trace %s: %d events over %.1f ms, %d files, %d async" %
+          (args.trace, len(events), span_ms, len(paths), async_ops))
+
+    fit = calibrate(events)
+    if fit:
+        overhead, mbs, seek, random_count, seq_count = fit
+        print("Card fit: overhead %.0f us, %.2f MB/s, seek %.0f us (%d random / %d sequential reads)" %
+              (overhead, mbs, seek, random_count, seq_count))
+        if args.calibrate and mbs > 0:
+            args.op_overhead = max(overhead, 0.0)
+            args.mbps = mbs
+            args.seek_cost = max(seek, 0.0)
+    print("Model: overhead %.0f us, open %.0f us, seek %.0f us, read %.2f MB/s, write %.2f MB/s\n" %
+          (args.op_overhead, args.open_cost, args.seek_cost, args.mbps, args.write_mbps or args.mbps))
+
+    latency = Model(args)
+    baseline = Simulator(latency, Policy(args, False), paths)
+    baseline.run(events)
+    print_run("Baseline", baseline, paths, measured_us, args.top)
+
+    tuned_policy = Policy(args, True)
+    if tuned_policy.describe() != "none":
+        tuned = Simulator(latency, tuned_policy, paths)
+        tuned.run(events)
+        print_run("Policy", tuned, paths, measured_us, args.top)
+        saved = baseline.total_us - tuned.total_us
+        print("Policy saves %.1f ms (%.1f%%)" % (saved / 1000, 100.0 * saved / baseline.total_us if baseline.total_us else 0))
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
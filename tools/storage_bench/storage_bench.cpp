@@ -0,0 +1,234 @@
+/**
+ * @file storage_bench.cpp
+ * @brief  Host throughput benchmark for the Storage PSRAM read engine
+ *
+ * Runs lib/storage/readPipeline.cpp, the bounce buffer engine of Storage::read, over a
+ * host file backend:
+ *  - serial:    one bounce buffer, fread and memcpy back to back
+ *  - pipelined: N bounce buffers, the copy task moves filled buffers to the
+ *               destination while the next chunk is read
+ *
+ * The card read and the PSRAM copy of the pipeline can model the SD card (per-command
+ * latency and bus bandwidth) and the PSRAM copy bandwidth, so the overlap gain can be
+ * estimated before flashing. A bus mutex stands in for the FAT volume lock when several
+ * readers run at once.
+ *
+ * Build: g++ -O2 -std=c++17 -pthread -I../host -I../../lib/storage storage_bench.cpp
+ *        ../../lib/storage/readPipeline.cpp -o storage_bench
+ */
+
+#include "readPipeline.hpp"
+
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+using Clock = std::chrono::steady_clock;
+
+static const size_t READ_CALL = 65536;     /**< Bytes per Storage::read call of a reader */
+
+/**
+ * @brief SD card and PSRAM timing model
+ */
+struct Model
+{
+    double cmdLatencyUs = 0.0;  /**< Per read command latency (us) */
+    double busMBs = 0.0;        /**< SD bus bandwidth (MB/s), 0 = host speed */
+    double psramMBs = 0.0;      /**< PSRAM copy bandwidth (MB/s), 0 = host speed */
+};
+
+static Model model;
+static std::mutex busMutex;
+
+static void waitModel(size_t bytes, double latencyUs, double mbs)
+{
+    double us = latencyUs;
+    if (mbs > 0.0)
+        us += bytes / mbs;
+    if (us > 0.0)
+        std::this_thread::sleep_for(std::chrono::microseconds((long)us));
+}
+
+/**
+ * @brief Card read of the pipeline: host file read, serialized on the bus like the FAT volume
+ */
+static size_t modelRead(void *dst, size_t size, size_t count, FILE *file)
+{
+    std::lock_guard<std::mutex> lock(busMutex);
+    const size_t r = fread(dst, size, count, file);
+    waitModel(r * size, model.cmdLatencyUs, model.busMBs);
+    return r;
+}
+
+/**
+ * @brief PSRAM copy of the pipeline
+ */
+static void *modelCopy(void *dst, const void *src, size_t len)
+{
+    memcpy(dst, src, len);
+    waitModel(len, 0.0, model.psramMBs);
+    return dst;
+}
+
+struct Result
+{
+    double mbs;
+    bool ok;
+};
+
+/**
+ * @brief Read the file with several concurrent readers and report the aggregate throughput
+ */
+static Result runCase(const std::string& path, size_t fileSize, const std::vector<uint8_t>& reference, size_t bufSize, int bufCount, int readers)
+{
+    ReadPipeline pipeline(modelRead, modelCopy);
+    if (!pipeline.init(bufSize, bufCount) || pipeline.bufferCount() != bufCount)
+        return {0.0, false};
+
+    std::vector<std::vector<uint8_t>> dst(readers, std::vector<uint8_t>(fileSize));
+    std::vector<std::thread> threads;
+    std::vector<size_t> got(readers, 0);
+
+    auto start = Clock::now();
+    for (int i = 0; i < readers; i++)
+    {
+        threads.emplace_back([&, i] {
+            FILE* file = fopen(path.c_str(), "rb");
+            if (!file)
+                return;
+            while (got[i] < fileSize)
+            {
+                const size_t toRead = std::min(READ_CALL, fileSize - got[i]);
+                const size_t r = pipeline.read(file, dst[i].data() + got[i], toRead);
+                got[i] += r;
+                if (r < toRead)
+                    break;
+            }
+            fclose(file);
+        });
+    }
+    for (auto& t : threads)
+        t.join();
+    double secs = std::chrono::duration<double>(Clock::now() - start).count();
+    pipeline.deinit();
+
+    bool ok = true;
+    for (int i = 0; i < readers; i++)
+        ok = ok && got[i] == fileSize && memcmp(dst[i].data(), reference.data(), fileSize) == 0;
+
+    return {(double)fileSize * readers / secs / 1e6, ok};
+}
+
+static void usage(const char* name)
+{
+    printf("Usage: %s [options] [file]\n", name);
+    printf("  -s MB        size of the generated test file (default 4)\n");
+    printf("  -l us        SD read command latency (default 0)\n");
+    printf("  -b MB/s      SD bus bandwidth (default 0 = host speed)\n");
+    printf("  -p MB/s      PSRAM copy bandwidth (default 0 = host speed)\n");
+    printf("  --sd         SDSPI 20 MHz model: -l 150 -b 2.2 -p 40\n");
+}
+
+int main(int argc, char** argv)
+{
+    std::string path;
+    size_t sizeMB = 4;
+
+    for (int i = 1; i < argc; i++)
+    {
+        std::string arg = argv[i];
+        if (arg == "-s" && i + 1 < argc)
+            sizeMB = strtoul(argv[++i], nullptr, 10);
+        else if (arg == "-l" && i + 1 < argc)
+            model.cmdLatencyUs = atof(argv[++i]);
+        else if (arg == "-b" && i + 1 < argc)
+            model.busMBs = atof(argv[++i]);
+        else if (arg == "-p" && i + 1 < argc)
+            model.psramMBs = atof(argv[++i]);
+        else if (arg == "--sd")
+            model = {150.0, 2.2, 40.0};
+        else if (arg == "-h" || arg == "--help")
+        {
+            usage(argv[0]);
+            return 0;
+        }
+        else
+            path = arg;
+    }
+
+    bool generated = false;
+    if (path.empty())
+    {
+        path = "storage_bench.bin";
+        FILE* f = fopen(path.c_str(), "wb");
+        if (!f)
+        {
+            perror(path.c_str());
+            return 1;
+        }
+        std::vector<uint8_t> block(65536);
+        uint32_t seed = 0x12345678;
+        for (size_t done = 0; done < sizeMB * 1024 * 1024; done += block.size())
+        {
+            for (auto& b : block)
+            {
+                seed = seed * 1664525 + 1013904223;
+                b = seed >> 24;
+            }
+            fwrite(block.data(), 1, block.size(), f);
+        }
+        fclose(f);
+        generated = true;
+    }
+
+    FILE* f = fopen(path.c_str(), "rb");
+    if (!f)
+    {
+        perror(path.c_str());
+        return 1;
+    }
+    fseek(f, 0, SEEK_END);
+    size_t fileSize = ftell(f);
+    fseek(f, 0, SEEK_SET);
+    std::vector<uint8_t> reference(fileSize);
+    fileSize = fread(reference.data(), 1, fileSize, f);
+    fclose(f);
+
+    printf("File %s, %zu bytes\n", path.c_str(), fileSize);
+    printf("Model: latency %.0f us, bus %.1f MB/s, PSRAM %.1f MB/s, reads of %zu bytes\n\n", model.cmdLatencyUs, model.busMBs, model.psramMBs, READ_CALL);
+    printf("%-10s %8s %5s %8s %10s\n", "engine", "buffer", "count", "readers", "MB/s");
+
+    struct Case
+    {
+        size_t bufSize;
+        int bufCount;
+        int readers;
+    };
+    static const Case cases[] = {
+        {32768, 1, 1},
+        {16384, 1, 1},
+        {8192, 2, 1},
+        {16384, 2, 1},
+        {16384, 3, 1},
+        {32768, 1, 2},
+        {16384, 2, 2},
+    };
+
+    bool allOk = true;
+    for (const Case& c : cases)
+    {
+        Result r = runCase(path, fileSize, reference, c.bufSize, c.bufCount, c.readers);
+        allOk = allOk && r.ok;
+        printf("%-10s %8zu %5d %8d %10.2f%s\n", c.bufCount > 1 ? "pipelined" : "serial", c.bufSize, c.bufCount, c.readers, r.mbs, r.ok ? "" : "  DATA MISMATCH");
+    }
+
+    if (generated)
+        remove(path.c_str());
+    return allOk ? 0 : 1;
+}
@@ -0,0 +1,312 @@
+/**
+ * @file track_bench.cpp
+ * @brief  Host throughput and latency benchmark for the GPX track recorder
+ *
+ * Runs lib/gpx/src/trackLog.cpp, the recorder core, with the same threading
+ * as the firmware:
+ *  - producer: the GPS task, queues one fix per GPS epoch and must never block
+ *  - writer:   polls the ring, writes sector-aligned batches at their file offset
+ *
+ * The card backend can model the SD command latency, the write busy time and the
+ * bus bandwidth. After every batch the file is checked to be a complete GPX
+ * document, which is what a power loss at that moment would leave on the card.
+ *
+ * Build: g++ -O2 -std=c++17 -pthread -I../../lib/gpx/src track_bench.cpp ../../lib/gpx/src/trackLog.cpp -o track_bench
+ */
+
+#include "trackLog.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+using Clock = std::chrono::steady_clock;
+
+/**
+ * @brief SD card write timing model
+ */
+struct Model
+{
+    double cmdLatencyUs = 0.0;  /**< Per command latency (us) */
+    double busyUs = 0.0;        /**< Card busy time after each write command (us) */
+    double busMBs = 0.0;        /**< SD bus bandwidth (MB/s), 0 = host speed */
+    double rmwUs = 0.0;         /**< Extra cost of each partial sector (read-modify-write) (us) */
+};
+
+static Model model;
+static Clock::time_point startTime;
+
+static uint32_t elapsedMs(double speedup)
+{
+    return (uint32_t)(std::chrono::duration<double, std::milli>(Clock::now() - startTime).count() * speedup);
+}
+
+static void waitUs(double us)
+{
+    if (us > 0.0)
+        std::this_thread::sleep_for(std::chrono::microseconds((long)us));
+}
+
+/**
+ * @brief Write at an offset through the card model
+ */
+static bool cardWrite(FILE* file, uint32_t offset, const uint8_t* data, size_t len)
+{
+    if (fseek(file, offset, SEEK_SET) != 0 || fwrite(data, 1, len, file) != len || fflush(file) != 0)
+        return false;
+
+    double us = model.cmdLatencyUs + model.busyUs;
+    if (model.busMBs > 0.0)
+        us += len / model.busMBs;
+    if (offset % TrackLog::SECTOR_SIZE)
+        us += model.rmwUs;
+    if ((offset + len) % TrackLog::SECTOR_SIZE)
+        us += model.rmwUs;
+    waitUs(us);
+    return true;
+}
+
+/**
+ * @brief Check that the file on disk is a complete GPX document
+ *
+ * @return Number of complete track points, -1 if the document is broken
+ */
+static long checkFile(const std::string& path, bool exactEnd)
+{
+    FILE* f = fopen(path.c_str(), "rb");
+    if (!f)
+        return -1;
+    std::string content;
+    char buf[4096];
+    size_t r;
+    while ((r = fread(buf, 1, sizeof(buf), f)) > 0)
+        content.append(buf, r);
+    fclose(f);
+
+    size_t end = content.find_last_not_of(" \n");
+    static const char tail[] = "</trkseg>\n</trk>\n</gpx>";
+    if (end == std::string::npos || end + 1 < strlen(tail))
+        return -1;
+    if (content.compare(end + 1 - strlen(tail), strlen(tail), tail) != 0)
+        return -1;
+    if (exactEnd && end + 2 != content.size())
+        return -1;
+
+    uint32_t points = 0;
+    for (size_t pos = content.find("<trkpt "); pos != std::string::npos; pos = content.find("<trkpt ", pos + 1))
+        points++;
+    uint32_t closes = 0;
+    for (size_t pos = content.find("</trkpt>"); pos != std::string::npos; pos = content.find("</trkpt>", pos + 1))
+        closes++;
+    return points == closes ? (long)points : -1;
+}
+
+struct Options
+{
+    double rateHz = 10.0;
+    double seconds = 600.0;
+    double speedup = 20.0;
+    size_t ringKB = 32;
+    size_t batchBytes = 4096;
+    size_t writeBuf = 8192;
+    uint32_t intervalMs = 10000;
+    uint32_t pollMs = 250;
+    bool check = true;
+};
+
+static void usage(const char* name)
+{
+    printf("Usage: %s [options]\n", name);
+    printf("  -r Hz        GPS fix rate (default 10)\n");
+    printf("  -t s         simulated recording time (default 600)\n");
+    printf("  -x N         run N times faster than real time (default 20)\n");
+    printf("  --ring KB    fix ring size, power of two (default 32)\n");
+    printf("  --batch B    queued bytes that trigger a flush (default 4096)\n");
+    printf("  --buf B      batch buffer size (default 8192)\n");
+    printf("  -l us        SD write command latency (default 0)\n");
+    printf("  -w us        SD busy time after each write (default 0)\n");
+    printf("  -b MB/s      SD bus bandwidth (default 0 = host speed)\n");
+    printf("  -m us        read-modify-write cost of a partial sector (default 0)\n");
+    printf("  --sd         SDSPI 20 MHz model: -l 150 -w 2500 -b 2.2 -m 1500\n");
+    printf("  --no-check   do not verify the file after every batch\n");
+}
+
+int main(int argc, char** argv)
+{
+    Options opt;
+    for (int i = 1; i < argc; i++)
+    {
+        std::string arg = argv[i];
+        if (arg == "-r" && i + 1 < argc)
+            opt.rateHz = atof(argv[++i]);
+        else if (arg == "-t" && i + 1 < argc)
+            opt.seconds = atof(argv[++i]);
+        else if (arg == "-x" && i + 1 < argc)
+            opt.speedup = atof(argv[++i]);
+        else if (arg == "--ring" && i + 1 < argc)
+            opt.ringKB = strtoul(argv[++i], nullptr, 10);
+        else if (arg == "--batch" && i + 1 < argc)
+            opt.batchBytes = strtoul(argv[++i], nullptr, 10);
+        else if (arg == "--buf" && i + 1 < argc)
+            opt.writeBuf = strtoul(argv[++i], nullptr, 10);
+        else if (arg == "-l" && i + 1 < argc)
+            model.cmdLatencyUs = atof(argv[++i]);
+        else if (arg == "-w" && i + 1 < argc)
+            model.busyUs = atof(argv[++i]);
+        else if (arg == "-b" && i + 1 < argc)
+            model.busMBs = atof(argv[++i]);
+        else if (arg == "-m" && i + 1 < argc)
+            model.rmwUs = atof(argv[++i]);
+        else if (arg == "--sd")
+            model = {150.0, 2500.0, 2.2, 1500.0};
+        else if (arg == "--no-check")
+            opt.check = false;
+        else
+        {
+            usage(argv[0]);
+            return arg == "-h" || arg == "--help" ? 0 : 1;
+        }
+    }
+
+    std::vector<char> ring(opt.ringKB * 1024);
+    std::vector<uint8_t> writeBuf(opt.writeBuf);
+    TrackLog log;
+    if (!log.init(ring.data(), ring.size()))
+    {
+        printf("Ring size must be a power of two of at least %zu bytes\n", 2 * TrackLog::MAX_LINE);
+        return 1;
+    }
+
+    const std::string path = "track_bench.gpx";
+    FILE* file = fopen(path.c_str(), "w+b");
+    if (!file)
+    {
+        perror(path.c_str());
+        return 1;
+    }
+    log.begin("TRK_BENCH");
+
+    const uint32_t totalFixes = (uint32_t)(opt.rateHz * opt.seconds);
+    std::atomic<bool> producing(true);
+    std::vector<double> pushUs;
+    pushUs.reserve(totalFixes);
+    startTime = Clock::now();
+
+    std::thread producer([&] {
+        const double periodUs = 1e6 / opt.rateHz / opt.speedup;
+        double lat = 41.3851;
+        double lon = 2.1734;
+        for (uint32_t i = 0; i < totalFixes; i++)
+        {
+            auto due = startTime + std::chrono::microseconds((long)(i * periodUs));
+            std::this_thread::sleep_until(due);
+
+            TrackFix fix = {};
+            lat += 0.00001 * std::sin(i * 0.01);
+            lon += 0.00001 * std::cos(i * 0.013);
+            fix.lat = (float)lat;
+            fix.lon = (float)lon;
+            fix.ele = 120.0f + (i % 100) * 0.1f;
+            fix.speed = 1.4f;
+            fix.hdop = 0.9f;
+            fix.sats = 9;
+            fix.hasEle = fix.hasSpeed = fix.hasHdop = true;
+            uint32_t secs = (uint32_t)(i / opt.rateHz);
+            fix.year = 2026;
+            fix.month = 10;
+            fix.day = 18;
+            fix.hour = (uint8_t)(10 + secs / 3600 % 12);
+            fix.minute = (uint8_t)(secs / 60 % 60);
+            fix.second = (uint8_t)(secs % 60);
+
+            auto t0 = Clock::now();
+            log.addFix(fix);
+            pushUs.push_back(std::chrono::duration<double, std::micro>(Clock::now() - t0).count());
+        }
+        producing = false;
+    });
+
+    uint32_t flushes = 0;
+    uint32_t badChecks = 0;
+    long lastPoints = 0;
+    uint64_t written = 0;
+    std::vector<double> flushMs;
+    uint32_t maxPending = 0;
+    const uint32_t pollUs = (uint32_t)(opt.pollMs * 1000 / opt.speedup);
+
+    auto flush = [&](bool final) {
+        uint32_t offset = 0;
+        size_t len = log.buildBatch(writeBuf.data(), writeBuf.size(), final, offset);
+        if (len == 0)
+            return false;
+        auto t0 = Clock::now();
+        if (!cardWrite(file, offset, writeBuf.data(), len))
+            return false;
+        flushMs.push_back(std::chrono::duration<double, std::milli>(Clock::now() - t0).count());
+        log.commit(elapsedMs(opt.speedup));
+        written += len;
+        flushes++;
+        if (final)
+        {
+            fflush(file);
+            if (ftruncate(fileno(file), offset + len) != 0)
+                return false;
+        }
+        return true;
+    };
+
+    // Writer, mirrors TrackRecorder::writerTask
+    log.lastFlushMs = 0;
+    while (producing)
+    {
+        waitUs(pollUs);
+        maxPending = std::max<uint32_t>(maxPending, (uint32_t)log.pending());
+        if (log.shouldFlush(elapsedMs(opt.speedup), opt.batchBytes, opt.intervalMs))
+        {
+            if (flush(false) && opt.check)
+            {
+                // What a power loss right now would leave on the card
+                long points = checkFile(path, false);
+                if (points < lastPoints)
+                    badChecks++;
+                else
+                    lastPoints = points;
+            }
+        }
+    }
+    producer.join();
+
+    while (log.pending() > opt.batchBytes)
+        flush(false);
+    flush(true);
+    fclose(file);
+
+    double wallS = std::chrono::duration<double>(Clock::now() - startTime).count();
+    std::sort(pushUs.begin(), pushUs.end());
+    std::sort(flushMs.begin(), flushMs.end());
+    auto pct = [](const std::vector<double>& v, double p) { return v.empty() ? 0.0 : v[(size_t)(p * (v.size() - 1))]; };
+
+    bool ok = checkFile(path, true) == (long)log.points;
+    printf("Model: latency %.0f us, busy %.0f us, bus %.1f MB/s, RMW %.0f us\n", model.cmdLatencyUs, model.busyUs, model.busMBs, model.rmwUs);
+    printf("Recorded %.0f s at %.1f Hz in %.1f s wall time\n", opt.seconds, opt.rateHz, wallS);
+    printf("Points\t\t: %u queued, %u dropped\n", log.points, log.dropped);
+    printf("File\t\t: %u bytes, %llu written in %u batches (x%.2f write amplification)\n", log.fileSize,
+           (unsigned long long)written, flushes, log.fileSize ? (double)written / log.fileSize : 0.0);
+    printf("Queue peak\t: %u bytes of %zu\n", maxPending, ring.size());
+    printf("Push latency\t: p50 %.2f us, p99 %.2f us, max %.2f us\n", pct(pushUs, 0.5), pct(pushUs, 0.99), pct(pushUs, 1.0));
+    printf("Batch latency\t: p50 %.2f ms, p99 %.2f ms, max %.2f ms\n", pct(flushMs, 0.5), pct(flushMs, 0.99), pct(flushMs, 1.0));
+    if (opt.check)
+        printf("Power loss\t: %u of %u checks failed\n", badChecks, flushes);
+    printf("Final file\t: %s\n", ok ? "valid" : "INVALID");
+
+    remove(path.c_str());
+    return ok && badChecks == 0 && log.dropped == 0 ? 0 : 1;
+}
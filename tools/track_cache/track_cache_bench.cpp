@@ -0,0 +1,241 @@
+/**
+ * @file track_cache_bench.cpp
+ * @brief  Host load-time benchmark and invalidation checks for the binary track cache
+ *
+ * Generates a GPX track, loads it with the same tokenizer and index build as
+ * GPXParser::loadTrack (first load) and then from the .trc sidecar written by
+ * lib/gpx/src/trackCache.cpp (later loads), and compares time and contents.
+ *
+ * Then checks that the cache is rejected when the GPX changes size or
+ * modification time, and when the cache is corrupt, truncated or of another version.
+ *
+ * Build: g++ -O2 -std=c++17 -I../host -I../../lib/gpx/src -I../../lib/utils/src track_cache_bench.cpp
+ *        ../../lib/gpx/src/trackCache.cpp ../../lib/gpx/src/gpxTokenizer.cpp ../../lib/utils/src/gpsMath.cpp -o track_cache_bench
+ */
+
+#include "trackCache.hpp"
+#include "gpxTokenizer.hpp"
+#include "gpsMath.hpp"
+
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <utime.h>
+
+using Clock = std::chrono::steady_clock;
+
+static uint32_t failures = 0;
+
+static void check(bool condition, const char *what)
+{
+    printf("  %-44s %s\n", what, condition ? "ok" : "FAIL");
+    if (!condition)
+        failures++;
+}
+
+/**
+ * @brief Write a GPX track in the usual layout of exported tracks (one tag per line)
+ */
+static bool writeGpx(const std::string &path, uint32_t points)
+{
+    FILE *f = fopen(path.c_str(), "w");
+    if (!f)
+        return false;
+    fprintf(f, "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n<gpx version=\"1.1\" creator=\"IceNav\">\n");
+    fprintf(f, "<trk>\n<name>bench</name>\n<trkseg>\n");
+    double lat = 41.3851;
+    double lon = 2.1734;
+    for (uint32_t i = 0; i < points; i++)
+    {
+        lat += 0.00004 * std::sin(i * 0.002);
+        lon += 0.00004 * std::cos(i * 0.0031);
+        fprintf(f, "<trkpt lat=\"%.7f\" lon=\"%.7f\">\n<ele>%.1f</ele>\n<time>2026-10-18T10:%02u:%02uZ</time>\n</trkpt>\n",
+                lat, lon, 120.0 + (i % 300) * 0.5, i / 60 % 60, i % 60);
+    }
+    fprintf(f, "</trkseg>\n</trk>\n</gpx>\n");
+    return fclose(f) == 0;
+}
+
+/**
+ * @brief GPXParser::loadTrack without the cache: tokenizer, distances and segment index
+ */
+static bool parseGpx(const std::string &path, TrackVector &trackData, std::vector<TrackSegment> &trackIndex)
+{
+    GpxTokenizer tokenizer;
+    if (!tokenizer.open(path.c_str()))
+        return false;
+    trackData.clear();
+    trackData.reserve(tokenizer.fileSize / 50);
+    trackIndex.clear();
+    GpxPoint point;
+    while (tokenizer.nextPoint("trkpt", point))
+        trackData.push_back(point.lat, point.lon, point.ele);
+    tokenizer.close();
+    trackData.shrink_to_fit();
+    if (trackData.empty())
+        return true;
+
+    float totalDist = 0;
+    const int SEGMENT_SIZE = 100;
+    const float BUFFER = 0.0005f;
+    TrackSegment seg = {0, 0, 90.0f, -90.0f, 180.0f, -180.0f};
+    for (size_t i = 0; i < trackData.size(); ++i)
+    {
+        const float lat = trackData.lat[i];
+        const float lon = trackData.lon[i];
+        if (i > 0)
+        {
+            totalDist += calcDist(trackData.lat[i - 1], trackData.lon[i - 1], lat, lon);
+            trackData.accumDist[i] = totalDist;
+        }
+        seg.minLat = std::fmin(seg.minLat, lat);
+        seg.maxLat = std::fmax(seg.maxLat, lat);
+        seg.minLon = std::fmin(seg.minLon, lon);
+        seg.maxLon = std::fmax(seg.maxLon, lon);
+        if ((i + 1) % SEGMENT_SIZE == 0 || i == trackData.size() - 1)
+        {
+            seg.endIdx = i;
+            seg.minLat -= BUFFER;
+            seg.maxLat += BUFFER;
+            seg.minLon -= BUFFER;
+            seg.maxLon += BUFFER;
+            trackIndex.push_back(seg);
+            seg = {(int)i + 1, 0, 90.0f, -90.0f, 180.0f, -180.0f};
+        }
+    }
+    return true;
+}
+
+static long fileSize(const std::string &path)
+{
+    struct stat st;
+    return stat(path.c_str(), &st) == 0 ? (long)st.st_size : -1;
+}
+
+static void setMtime(const std::string &path, time_t mtime)
+{
+    struct utimbuf times = {mtime, mtime};
+    utime(path.c_str(), &times);
+}
+
+/**
+ * @brief Overwrite bytes of a file in place
+ */
+static void patchFile(const std::string &path, long offset, const void *data, size_t len)
+{
+    FILE *f = fopen(path.c_str(), "r+b");
+    if (!f)
+        return;
+    fseek(f, offset, SEEK_SET);
+    fwrite(data, 1, len, f);
+    fclose(f);
+}
+
+int main(int argc, char **argv)
+{
+    const uint32_t points = argc > 1 ? strtoul(argv[1], nullptr, 10) : 100000;
+    const int runs = argc > 2 ? atoi(argv[2]) : 5;
+    const std::string gpx = "track_cache_bench.gpx";
+    const std::string trc = TrackCache::cachePath(gpx.c_str());
+
+    if (!writeGpx(gpx, points))
+    {
+        perror(gpx.c_str());
+        return 1;
+    }
+    TrackCache::invalidate(gpx.c_str());
+
+    TrackVector parsed;
+    std::vector<TrackSegment> parsedIndex;
+    TrackVector cached;
+    std::vector<TrackSegment> cachedIndex;
+
+    double parseMs = 1e9;
+    for (int r = 0; r < runs; r++)
+    {
+        auto t0 = Clock::now();
+        parseGpx(gpx, parsed, parsedIndex);
+        parseMs = std::fmin(parseMs, std::chrono::duration<double, std::milli>(Clock::now() - t0).count());
+    }
+
+    auto t0 = Clock::now();
+    bool saved = TrackCache::save(gpx.c_str(), parsed, parsedIndex);
+    const double saveMs = std::chrono::duration<double, std::milli>(Clock::now() - t0).count();
+
+    double loadMs = 1e9;
+    bool loaded = saved;
+    for (int r = 0; loaded && r < runs; r++)
+    {
+        t0 = Clock::now();
+        loaded = TrackCache::load(gpx.c_str(), cached, cachedIndex);
+        loadMs = std::fmin(loadMs, std::chrono::duration<double, std::milli>(Clock::now() - t0).count());
+    }
+
+    printf("Track\t\t: %u points, %zu segments, %.1f km\n", (unsigned)parsed.size(), parsedIndex.size(),
+           parsed.empty() ? 0.0 : parsed.accumDist.back() / 1000.0);
+    printf("Memory\t\t: %zu bytes per point in columns (%zu as wayPoint structs)\n", 4 * sizeof(float), sizeof(wayPoint));
+    printf("GPX\t\t: %ld bytes, parse + index %.2f ms\n", fileSize(gpx), parseMs);
+    printf("Cache\t\t: %ld bytes (%.1f B/point), write %.2f ms, load %.2f ms (x%.1f faster)\n", fileSize(trc),
+           (double)fileSize(trc) / points, saveMs, loadMs, loaded ? parseMs / loadMs : 0.0);
+
+    printf("Round trip\n");
+    check(saved && loaded, "cache written and loaded");
+    check(cached.size() == parsed.size() && cachedIndex.size() == parsedIndex.size(), "same point and segment count");
+    double maxErr = 0.0;
+    double maxEleErr = 0.0;
+    bool distSame = cached.size() == parsed.size();
+    for (size_t i = 0; distSame && i < cached.size(); i++)
+    {
+        maxErr = std::fmax(maxErr, std::fabs(cached.lat[i] - parsed.lat[i]));
+        maxErr = std::fmax(maxErr, std::fabs(cached.lon[i] - parsed.lon[i]));
+        maxEleErr = std::fmax(maxEleErr, std::fabs(cached.ele[i] - parsed.ele[i]));
+        distSame = cached.accumDist[i] == parsed.accumDist[i];
+    }
+    check(distSame, "same cumulative distances");
+    check(maxErr <= 1e-7, "coordinates within 1e-7 degrees");
+    check(maxEleErr <= 0.05, "elevations within 5 cm");
+    check(cachedIndex.size() == parsedIndex.size() &&
+              memcmp(cachedIndex.data(), parsedIndex.data(), parsedIndex.size() * sizeof(TrackSegment)) == 0,
+          "same segment index");
+
+    printf("Invalidation\n");
+    struct stat st;
+    stat(gpx.c_str(), &st);
+    setMtime(gpx, st.st_mtime + 60);
+    check(!TrackCache::load(gpx.c_str(), cached, cachedIndex), "GPX modification time changed");
+    setMtime(gpx, st.st_mtime);
+    check(TrackCache::load(gpx.c_str(), cached, cachedIndex), "GPX modification time restored");
+
+    FILE *f = fopen(gpx.c_str(), "a");
+    fputs("\n", f);
+    fclose(f);
+    setMtime(gpx, st.st_mtime);
+    check(!TrackCache::load(gpx.c_str(), cached, cachedIndex), "GPX size changed");
+    TrackCache::save(gpx.c_str(), parsed, parsedIndex);
+    check(TrackCache::load(gpx.c_str(), cached, cachedIndex), "cache rebuilt");
+
+    const uint16_t oldVersion = TrackCache::VERSION - 1;
+    patchFile(trc, 4, &oldVersion, sizeof(oldVersion));
+    check(!TrackCache::load(gpx.c_str(), cached, cachedIndex), "other layout version");
+    TrackCache::save(gpx.c_str(), parsed, parsedIndex);
+
+    const uint8_t junk = 0x5A;
+    patchFile(trc, fileSize(trc) / 2, &junk, 1);
+    check(!TrackCache::load(gpx.c_str(), cached, cachedIndex) && cached.empty(), "corrupt payload (checksum)");
+    TrackCache::save(gpx.c_str(), parsed, parsedIndex);
+
+    truncate(trc.c_str(), fileSize(trc) - 3);
+    check(!TrackCache::load(gpx.c_str(), cached, cachedIndex), "truncated cache");
+
+    TrackCache::invalidate(gpx.c_str());
+    check(!TrackCache::load(gpx.c_str(), cached, cachedIndex) && fileSize(trc) < 0, "invalidated");
+
+    remove(gpx.c_str());
+    printf("%s\n", failures ? "FAILED" : "All checks passed");
+    return failures ? 1 : 0;
+}
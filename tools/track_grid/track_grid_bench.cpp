@@ -0,0 +1,253 @@
+/**
+ * @file track_grid_bench.cpp
+ * @brief  Host benchmark and checks for the track segment grid
+ *
+ * Builds the spatial grid of lib/gpx/src/trackGrid.cpp over synthetic navigation tracks
+ * and checks its queries against a scan of every segment: nearest segment, projected
+ * distance and the other segments within the direction margin of the nearest one. On an out-and-back track it checks
+ * that both passes are returned with opposite courses, so the heading can pick one.
+ * Then times the grid query against the former global search (segment bounding boxes
+ * of 100 points, then every point inside the matching ones).
+ *
+ * Build: g++ -O2 -std=c++17 -I../host -I../../lib/gpx/src -I../../lib/utils/src track_grid_bench.cpp
+ *        ../../lib/gpx/src/trackGrid.cpp ../../lib/utils/src/gpsMath.cpp -o track_grid_bench
+ */
+
+#include "trackGrid.hpp"
+#include "gpsMath.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+
+using Clock = std::chrono::steady_clock;
+
+static uint32_t failures = 0;
+static volatile float sink;     /**< Keeps the timed loops */
+
+static void check(bool condition, const char *what)
+{
+    printf("  %-44s %s\n", what, condition ? "ok" : "FAIL");
+    if (!condition)
+        failures++;
+}
+
+static double elapsedMs(Clock::time_point t0)
+{
+    return std::chrono::duration<double, std::milli>(Clock::now() - t0).count();
+}
+
+static const float METERS_PER_DEG = 111319.49f;
+static const float MARGIN = 15.0f;     /**< NavConfig::directionMargin */
+
+/**
+ * @brief Fill the cumulative distances like GPXParser::loadTrack
+ */
+static void accumulate(TrackVector &track)
+{
+    float total = 0.0f;
+    for (size_t i = 0; i < track.size(); i++)
+    {
+        if (i > 0)
+            total += calcDist(track.lat[i - 1], track.lon[i - 1], track.lat[i], track.lon[i]);
+        track.accumDist[i] = total;
+    }
+}
+
+/**
+ * @brief Navigation-resolution track: stepM to 2 * stepM segments, bends and junctions
+ */
+static TrackVector walk(uint32_t points, float lat, float lon, float stepM, uint32_t seed)
+{
+    std::mt19937 rng(seed);
+    std::uniform_real_distribution<float> unit(-1.0f, 1.0f);
+    TrackVector track;
+    float course = 0.0f;
+    for (uint32_t i = 0; i < points; i++)
+    {
+        track.push_back(lat, lon, 0.0f);
+        course += unit(rng) * 8.0f + (i % 50 == 0 ? unit(rng) * 120.0f : 0.0f);
+        const float step = stepM * (1.5f + 0.5f * unit(rng));
+        lat += step * cosf(DEG2RAD(course)) / METERS_PER_DEG;
+        lon += step * sinf(DEG2RAD(course)) / (METERS_PER_DEG * cosf(DEG2RAD(lat)));
+        if (lon > 180.0f)
+            lon -= 360.0f;
+    }
+    accumulate(track);
+    return track;
+}
+
+/**
+ * @brief Every segment within radius, sorted by distance
+ */
+static std::vector<TrackMatch> scanAll(const TrackVector &track, float lat, float lon, float radius)
+{
+    std::vector<TrackMatch> all;
+    for (size_t i = 0; i + 1 < track.size(); i++)
+    {
+        const TrackMatch m = TrackGrid::matchSegment(track, i, lat, lon);
+        if (m.dist <= radius)
+            all.push_back(m);
+    }
+    std::sort(all.begin(), all.end(), [](const TrackMatch &a, const TrackMatch &b) { return a.dist < b.dist; });
+    return all;
+}
+
+/**
+ * @brief Former global search: 100 point bounding boxes, closest point inside them
+ */
+static size_t bboxSearch(const TrackVector &track, const std::vector<TrackSegment> &index, float lat, float lon)
+{
+    const float uLat = DEG2RAD(lat), uLon = DEG2RAD(lon);
+    float best = 1e30f;
+    size_t bestIdx = 0;
+    for (const TrackSegment &seg : index)
+    {
+        if (lat <= seg.maxLat && lat >= seg.minLat && lon <= seg.maxLon && lon >= seg.minLon)
+        {
+            for (int i = seg.startIdx; i <= seg.endIdx; ++i)
+            {
+                const float dSq = calcDistSq(uLat, uLon, DEG2RAD(track.lat[i]), DEG2RAD(track.lon[i]));
+                if (dSq < best)
+                {
+                    best = dSq;
+                    bestIdx = i;
+                }
+            }
+        }
+    }
+    return bestIdx;
+}
+
+/**
+ * @brief Segment index as GPXParser::buildTrackIndex
+ */
+static std::vector<TrackSegment> bboxIndex(const TrackVector &track)
+{
+    std::vector<TrackSegment> index;
+    for (size_t start = 0; start < track.size(); start += 100)
+    {
+        TrackSegment seg = {(int)start, (int)std::min(track.size() - 1, start + 99), 90.0f, -90.0f, 180.0f, -180.0f};
+        for (int i = seg.startIdx; i <= seg.endIdx; i++)
+        {
+            seg.minLat = std::min(seg.minLat, track.lat[i] - 0.0005f);
+            seg.maxLat = std::max(seg.maxLat, track.lat[i] + 0.0005f);
+            seg.minLon = std::min(seg.minLon, track.lon[i] - 0.0005f);
+            seg.maxLon = std::max(seg.maxLon, track.lon[i] + 0.0005f);
+        }
+        index.push_back(seg);
+    }
+    return index;
+}
+
+/**
+ * @brief Compare grid queries with a full scan at random positions near the track, then time them
+ */
+static void runCase(const char *name, const TrackVector &track, float radius, uint32_t queries)
+{
+    TrackGrid grid;
+    auto t0 = Clock::now();
+    grid.build(track);
+    const double buildMs = elapsedMs(t0);
+    printf("%s: %u points, cell %.0f m, %u entries, built in %.1f ms\n", name, (unsigned)track.size(), grid.cellSize,
+           (unsigned)grid.entries, buildMs);
+
+    std::mt19937 rng(99);
+    std::uniform_real_distribution<float> unit(-1.0f, 1.0f);
+    std::vector<float> qLat(queries), qLon(queries);
+    for (uint32_t q = 0; q < queries; q++)
+    {
+        const size_t i = rng() % track.size();
+        qLat[q] = track.lat[i] + unit(rng) * radius / METERS_PER_DEG;
+        qLon[q] = track.lon[i] + unit(rng) * radius / (METERS_PER_DEG * cosf(DEG2RAD(track.lat[i])));
+        if (qLon[q] > 180.0f)
+            qLon[q] -= 360.0f;
+    }
+
+    bool nearest = true, complete = true, sorted = true;
+    TrackMatch found[16];
+    for (uint32_t q = 0; q < std::min<uint32_t>(queries, 200); q++)
+    {
+        const std::vector<TrackMatch> all = scanAll(track, qLat[q], qLon[q], radius);
+        const size_t count = grid.query(qLat[q], qLon[q], radius, MARGIN, found, 16);
+        size_t expected = 0;
+        while (expected < all.size() && expected < 16 && all[expected].dist <= all[0].dist + MARGIN)
+            expected++;
+        complete &= count == expected;
+        if (count > 0)
+            nearest &= found[0].dist == all[0].dist;
+        for (size_t k = 1; k < count; k++)
+            sorted &= found[k - 1].dist <= found[k].dist && found[k].dist == all[k].dist;
+    }
+    check(nearest, "nearest segment as a full scan");
+    check(complete && sorted, "segments within the margin of the nearest");
+
+    const std::vector<TrackSegment> index = bboxIndex(track);
+    t0 = Clock::now();
+    for (uint32_t q = 0; q < queries; q++)
+        sink = (float)bboxSearch(track, index, qLat[q], qLon[q]);
+    const double bboxMs = elapsedMs(t0);
+    t0 = Clock::now();
+    for (uint32_t q = 0; q < queries; q++)
+        sink = (float)grid.query(qLat[q], qLon[q], radius, MARGIN, found, 16);
+    const double gridMs = elapsedMs(t0);
+    printf("      %u queries: bounding boxes %.1f ms, grid %.1f ms (x%.1f)\n", queries, bboxMs, gridMs, bboxMs / gridMs);
+}
+
+int main(int argc, char **argv)
+{
+    const uint32_t points = argc > 1 ? strtoul(argv[1], nullptr, 10) : 100000;
+    const uint32_t queries = argc > 2 ? strtoul(argv[2], nullptr, 10) : 2000;
+
+    runCase("walk", walk(points, 42.5f, 1.5f, 10.0f, 1), 200.0f, queries);
+    runCase("walk, 500 m radius", walk(points, 42.5f, 1.5f, 10.0f, 1), 500.0f, queries / 4);
+    runCase("sparse", walk(points / 10, 60.0f, 10.0f, 150.0f, 2), 500.0f, queries / 4);
+    runCase("antimeridian", walk(points / 10, -16.5f, 179.95f, 10.0f, 3), 200.0f, queries / 4);
+
+    printf("Out and back\n");
+    TrackVector outBack;
+    for (int i = 0; i <= 200; i++)
+        outBack.push_back(41.0f + i * 20.0f / METERS_PER_DEG, 2.0f, 0.0f);
+    for (int i = 199; i >= 0; i--)
+        outBack.push_back(41.0f + i * 20.0f / METERS_PER_DEG, 2.0f + 3.0f / (METERS_PER_DEG * 0.7547f), 0.0f);
+    accumulate(outBack);
+    TrackGrid grid;
+    grid.build(outBack);
+    TrackMatch found[16];
+    const size_t count = grid.query(41.0f + 1000.0f / METERS_PER_DEG, 2.0f + 1.0f / (METERS_PER_DEG * 0.7547f), 200.0f,
+                                    MARGIN, found, 16);
+    bool outbound = false, inbound = false;
+    for (size_t k = 0; k < count; k++)
+    {
+        if (found[k].dist < 5.0f && found[k].segIdx < 200 && fabsf(calcAngleDiff(found[k].bearing, 0.0f)) < 1.0f)
+            outbound = true;
+        if (found[k].dist < 5.0f && found[k].segIdx > 200 && fabsf(calcAngleDiff(found[k].bearing, 180.0f)) < 1.0f)
+            inbound = true;
+    }
+    check(outbound && inbound, "both passes with opposite courses");
+    check(found[0].segIdx < 200 && fabsf(found[0].t - 0.0f) < 1.01f, "nearest pass first");
+
+    printf("Edge cases\n");
+    TrackVector single;
+    single.push_back(41.0f, 2.0f, 0.0f);
+    accumulate(single);
+    grid.build(single);
+    check(grid.empty() && grid.query(41.0f, 2.0f, 100.0f, MARGIN, found, 16) == 0, "one point track has no segments");
+    const TrackMatch m = TrackGrid::matchSegment(single, 0, 41.0f + 10.0f / METERS_PER_DEG, 2.0f);
+    check(fabsf(m.dist - 10.0f) < 0.5f && fabsf(m.projLat - 41.0f) < 1e-5f, "one point track matches its point");
+    TrackVector gap;
+    gap.push_back(41.0f, 2.0f, 0.0f);
+    gap.push_back(41.5f, 2.5f, 0.0f);      // ~70 km segment
+    gap.push_back(41.5001f, 2.5f, 0.0f);
+    accumulate(gap);
+    grid.build(gap);
+    const size_t gapCount = grid.query(41.25f, 2.25f, 100.0f, MARGIN, found, 16);
+    check(gapCount == 1 && found[0].segIdx == 0 && found[0].dist < 100.0f, "long segment found mid-way");
+    check(grid.entries < 2000, "long segment stored along its line");
+
+    printf("%s\n", failures ? "FAILED" : "All checks passed");
+    return failures ? 1 : 0;
+}
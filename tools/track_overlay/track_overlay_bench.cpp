@@ -0,0 +1,293 @@
+/**
+ * @file track_overlay_bench.cpp
+ * @brief  Host benchmark and checks for the track map overlay
+ *
+ * Loads the overlay of lib/maps/src/track_overlay.cpp with synthetic tracks (a long
+ * planned route, a recorded breadcrumb added point by point and some reference tracks),
+ * then compares random viewports at every zoom with a scan of all the segments and times
+ * the frames against projecting every point, as a plain track draw does.
+ *
+ * Build: g++ -O2 -std=c++17 -I../host -I../../lib/utils/src -I../../lib/maps/src
+ *        track_overlay_bench.cpp ../../lib/maps/src/track_overlay.cpp -o track_overlay_bench
+ */
+
+#include "track_overlay.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+
+using Clock = std::chrono::steady_clock;
+
+static uint32_t failures = 0;
+
+static void check(bool condition, const char *what)
+{
+    printf("  %-44s %s\n", what, condition ? "ok" : "FAIL");
+    if (!condition)
+        failures++;
+}
+
+static double elapsedUs(Clock::time_point t0)
+{
+    return std::chrono::duration<double, std::micro>(Clock::now() - t0).count();
+}
+
+static const int32_t VIEW_SIZE = 1024;      /**< Map temp sprite of the T4-S3 (4x4 tiles) */
+
+/**
+ * @brief Synthetic track
+ */
+struct TestTrack
+{
+    std::vector<float> lat;
+    std::vector<float> lon;
+};
+
+/**
+ * @brief Random walk of about 10 m steps, with a few GPS gaps
+ */
+static void makeTrack(uint32_t seed, float lat, float lon, uint32_t count, TestTrack &t)
+{
+    std::mt19937 rng(seed);
+    std::normal_distribution<float> turn(0.0f, 0.15f);
+    std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+    float heading = unit(rng) * 6.2832f;
+    for (uint32_t i = 0; i < count; i++)
+    {
+        t.lat.push_back(lat);
+        t.lon.push_back(lon);
+        heading += turn(rng);
+        const float step = unit(rng) < 0.0005f ? 0.05f : 0.0001f;     // Gap of about 5 km
+        lat += step * cosf(heading);
+        lon += step * sinf(heading) / cosf(lat * 0.01745f);
+    }
+}
+
+/**
+ * @brief Whether a segment is inside a world viewport, by its bounding box
+ */
+static bool segmentVisible(int32_t x0, int32_t y0, int32_t x1, int32_t y1, int64_t left, int64_t top, int64_t right,
+                           int64_t bottom)
+{
+    return std::max(x0, x1) >= left && std::min(x0, x1) < right && std::max(y0, y1) >= top && std::min(y0, y1) < bottom;
+}
+
+/**
+ * @brief Runs cover every visible segment of the scan, sorted and disjoint
+ */
+static bool runsCover(const std::vector<TestTrack> &tracks, const std::vector<TrackRun> &runs, uint8_t zoom,
+                      int32_t left, int32_t top, int32_t size)
+{
+    for (size_t r = 1; r < runs.size(); r++)
+        if (runs[r].track < runs[r - 1].track || (runs[r].track == runs[r - 1].track && runs[r].first <= runs[r - 1].last))
+            return false;
+
+    for (uint8_t t = 0; t < tracks.size(); t++)
+    {
+        int32_t px = 0, py = 0;
+        for (uint32_t i = 0; i < tracks[t].lat.size(); i++)
+        {
+            int32_t x, y;
+            TrackOverlay::project(tracks[t].lat[i], tracks[t].lon[i], TrackOverlay::WORLD_ZOOM, x, y);
+            x >>= TrackOverlay::WORLD_ZOOM - zoom;
+            y >>= TrackOverlay::WORLD_ZOOM - zoom;
+            if (i > 0 && segmentVisible(px, py, x, y, left, top, (int64_t)left + size, (int64_t)top + size))
+            {
+                bool covered = false;
+                for (const TrackRun &run : runs)
+                    covered |= run.track == t && run.first <= i - 1 && run.last >= i;
+                if (!covered)
+                    return false;
+            }
+            px = x;
+            py = y;
+        }
+    }
+    return true;
+}
+
+/**
+ * @brief Same runs
+ */
+static bool sameRuns(const std::vector<TrackRun> &a, const std::vector<TrackRun> &b)
+{
+    if (a.size() != b.size())
+        return false;
+    for (size_t i = 0; i < a.size(); i++)
+        if (a[i].track != b[i].track || a[i].first != b[i].first || a[i].last != b[i].last)
+            return false;
+    return true;
+}
+
+int main(int argc, char **argv)
+{
+    const uint32_t routePoints = argc > 1 ? strtoul(argv[1], nullptr, 10) : 50000;
+    const int views = argc > 2 ? atoi(argv[2]) : 200;
+
+    // Slot 0 planned route, slot 1 breadcrumb, slots 2.. reference tracks
+    std::vector<TestTrack> tracks(TrackOverlay::MAX_TRACKS);
+    makeTrack(1, 41.39f, 2.17f, routePoints, tracks[0]);
+    makeTrack(2, 41.40f, 2.16f, routePoints / 2, tracks[1]);
+    for (uint8_t t = 2; t < TrackOverlay::MAX_TRACKS; t++)
+        makeTrack(t + 1, 41.3f + t * 0.05f, 2.0f + t * 0.04f, routePoints / 4, tracks[t]);
+
+    TrackOverlay overlay;
+    size_t totalPoints = 0;
+    auto t0 = Clock::now();
+    for (uint8_t t = 0; t < TrackOverlay::MAX_TRACKS; t++)
+    {
+        if (t != 1)
+            overlay.set(t, tracks[t].lat.data(), tracks[t].lon.data(), tracks[t].lat.size(), {(uint16_t)(t * 1000), 3});
+        totalPoints += tracks[t].lat.size();
+    }
+    const double loadUs = elapsedUs(t0);
+    t0 = Clock::now();
+    for (size_t i = 0; i < tracks[1].lat.size(); i++)
+        overlay.append(1, tracks[1].lat[i], tracks[1].lon[i], {0xF800, 2});
+    const double appendUs = elapsedUs(t0);
+    printf("Tracks: %u, %zu points, load %.2f ms, append %.3f us/point, %zu bytes\n", TrackOverlay::MAX_TRACKS, totalPoints,
+           loadUs / 1000.0, appendUs / tracks[1].lat.size(), overlay.memoryBytes());
+
+    printf("Checks\n");
+    bool counts = true;
+    for (uint8_t t = 0; t < TrackOverlay::MAX_TRACKS; t++)
+        counts &= overlay.points(t) == tracks[t].lat.size();
+    check(counts && overlay.style(1).color == 0xF800 && overlay.style(1).width == 2, "points and styles of each track");
+
+    std::mt19937 rng(48);
+    std::vector<TrackRun> runs, other;
+    uint32_t misses = 0;
+    for (int v = 0; v < views; v++)
+    {
+        const uint8_t zoom = 4 + rng() % 15;
+        const TestTrack &c = tracks[rng() % tracks.size()];
+        const size_t i = rng() % c.lat.size();
+        int32_t cx, cy;
+        TrackOverlay::project(c.lat[i], c.lon[i], zoom, cx, cy);
+        const int32_t size = 64 + (int32_t)(rng() % VIEW_SIZE);
+        const int32_t left = cx - size / 2 + (int32_t)(rng() % 400) - 200;
+        const int32_t top = cy - size / 2 + (int32_t)(rng() % 400) - 200;
+        overlay.query(zoom, left, top, size, size, runs);
+        if (!runsCover(tracks, runs, zoom, left, top, size) && misses++ < 5)
+            printf("    zoom %u at %d,%d size %d: %zu runs miss segments\n", zoom, left, top, size, runs.size());
+    }
+    check(misses == 0, "random viewports cover the visible segments");
+
+    {
+        // A breadcrumb added point by point is indexed as the same track loaded at once
+        TrackOverlay loaded;
+        loaded.set(1, tracks[1].lat.data(), tracks[1].lon.data(), tracks[1].lat.size(), {0xF800, 2});
+        bool same = true;
+        for (int v = 0; v < 50; v++)
+        {
+            const uint8_t zoom = 10 + rng() % 9;
+            const size_t i = rng() % tracks[1].lat.size();
+            int32_t cx, cy;
+            TrackOverlay::project(tracks[1].lat[i], tracks[1].lon[i], zoom, cx, cy);
+            overlay.query(zoom, cx - 300, cy - 300, 600, 600, runs);
+            runs.erase(std::remove_if(runs.begin(), runs.end(), [](const TrackRun &r) { return r.track != 1; }), runs.end());
+            loaded.query(zoom, cx - 300, cy - 300, 600, 600, other);
+            same &= sameRuns(runs, other);
+        }
+        check(same, "appended track matches the loaded one");
+    }
+
+    {
+        // Whole world at zoom 0: one run per track
+        overlay.query(0, 0, 0, 256, 256, runs);
+        bool whole = runs.size() == TrackOverlay::MAX_TRACKS;
+        for (const TrackRun &r : runs)
+            whole &= r.first == 0 && r.last == tracks[r.track].lat.size() - 1;
+        check(whole, "whole world is one run per track");
+    }
+
+    {
+        TrackOverlay copy;
+        for (uint8_t t = 0; t < 3; t++)
+            copy.set(t, tracks[t].lat.data(), tracks[t].lon.data(), tracks[t].lat.size(), {0, 3});
+        copy.remove(1);
+        copy.query(0, 0, 0, 256, 256, runs);
+        check(runs.size() == 2 && runs[0].track == 0 && runs[1].track == 2 && copy.points(1) == 0, "removed track is not drawn");
+        copy.append(1, 41.0f, 2.0f, {0, 3});
+        const bool single = copy.query(0, 0, 0, 256, 256, runs) == 2;
+        copy.append(1, 41.001f, 2.001f, {0, 3});
+        copy.query(0, 0, 0, 256, 256, runs);
+        check(single && runs.size() == 3 && runs[1].track == 1 && runs[1].last == 1, "first points of a breadcrumb");
+    }
+
+    {
+        TrackOverlay none;
+        const bool emptyOk = none.query(10, 0, 0, 100, 100, runs) == 0;
+        const bool offWorld = overlay.query(4, -5000, -5000, 100, 100, runs) == 0 &&
+                              overlay.query(4, 0, 0, 0, 100, runs) == 0 &&
+                              overlay.query(TrackOverlay::WORLD_ZOOM + 1, 0, 0, 100, 100, runs) == 0;
+        check(emptyOk && offWorld, "empty overlay and viewports off the world");
+    }
+
+    printf("Frames (%dx%d viewport, query and vertices of the runs)\n", VIEW_SIZE, VIEW_SIZE);
+    double worstUs = 0.0, wholeUs = 0.0;
+    uint32_t chunksTotal = 0;
+    for (uint8_t zoom = 8; zoom <= 18; zoom += 2)
+    {
+        const int reps = 300;
+        size_t vertices = 0, visited = 0;
+        double totalUs = 0.0, maxUs = 0.0;
+        int64_t sink = 0;
+        for (int r = 0; r < reps; r++)
+        {
+            const TestTrack &c = tracks[rng() % tracks.size()];
+            const size_t i = rng() % c.lat.size();
+            int32_t cx, cy;
+            TrackOverlay::project(c.lat[i], c.lon[i], zoom, cx, cy);
+            t0 = Clock::now();
+            overlay.query(zoom, cx - VIEW_SIZE / 2, cy - VIEW_SIZE / 2, VIEW_SIZE, VIEW_SIZE, runs);
+            for (const TrackRun &run : runs)
+                for (uint32_t p = run.first; p <= run.last; p++)
+                {
+                    int32_t x, y;
+                    overlay.vertex(run.track, p, zoom, x, y);
+                    sink += x + y;
+                }
+            const double us = elapsedUs(t0);
+            totalUs += us;
+            maxUs = std::max(maxUs, us);
+            visited += overlay.chunksVisited;
+            for (const TrackRun &run : runs)
+                vertices += run.last - run.first + 1;
+        }
+        if (zoom == 16)
+            chunksTotal = (uint32_t)(visited / reps);
+        printf("  zoom %2u  %8.1f vertices  %6.1f chunks  mean %7.2f us  max %7.2f us%s\n", zoom, (double)vertices / reps,
+               (double)visited / reps, totalUs / reps, maxUs, sink == 1 ? " " : "");
+        if (zoom == 8)
+            wholeUs = totalUs / reps;
+        else if (zoom >= 14)
+            worstUs = std::max(worstUs, totalUs / reps);
+    }
+    double plainUs = 0.0;
+    {
+        // Plain draw: project every point of every track
+        int64_t sink = 0;
+        t0 = Clock::now();
+        for (int r = 0; r < 10; r++)
+            for (const TestTrack &t : tracks)
+                for (size_t i = 0; i < t.lat.size(); i++)
+                {
+                    int32_t x, y;
+                    TrackOverlay::project(t.lat[i], t.lon[i], 16, x, y);
+                    sink += x + y;
+                }
+        plainUs = elapsedUs(t0) / 10;
+        printf("  projection of all points  %8.2f us%s\n", plainUs, sink == 1 ? " " : "");
+    }
+    check(chunksTotal < totalPoints / TrackOverlay::CHUNK / 20, "zoom 16 visits a small part of the chunks");
+    check(worstUs < 200.0, "mean frame from zoom 14 under 0.2 ms");
+    check(wholeUs * 4 < plainUs, "all tracks in view beat the plain projection");
+
+    printf("%s\n", failures ? "FAILED" : "All checks passed");
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,253 @@
+/**
+ * @file track_profile_bench.cpp
+ * @brief  Host benchmark and checks for the track profile pyramid
+ *
+ * Builds the min/max pyramid of lib/gpx/src/trackProfile.cpp over a synthetic elevation
+ * track (uneven point spacing, repeated points, hills and noise) and checks random
+ * windows against a scan of the points of each column. Then times the build and the
+ * queries of a 320 pixel plot, whole track and zoomed in, against scanning the points.
+ *
+ * Build: g++ -O2 -std=c++17 -I../host -I../../lib/gpx/src -I../../lib/utils/src track_profile_bench.cpp
+ *        ../../lib/gpx/src/trackProfile.cpp -o track_profile_bench
+ */
+
+#include "trackProfile.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+
+using Clock = std::chrono::steady_clock;
+
+static uint32_t failures = 0;
+static volatile float sink;     /**< Keeps the timed loops */
+
+static void check(bool condition, const char *what)
+{
+    printf("  %-44s %s\n", what, condition ? "ok" : "FAIL");
+    if (!condition)
+        failures++;
+}
+
+static double elapsedMs(Clock::time_point t0)
+{
+    return std::chrono::duration<double, std::milli>(Clock::now() - t0).count();
+}
+
+static const size_t PLOT_COLUMNS = 320;
+
+/**
+ * @brief Synthetic track: 0.5-3 m between points, some repeated, hills with noise
+ */
+static void makeTrack(size_t points, TrackColumn &dist, TrackColumn &ele)
+{
+    std::mt19937 rng(21);
+    std::uniform_real_distribution<float> step(0.5f, 3.0f);
+    std::normal_distribution<float> noise(0.0f, 0.8f);
+    float d = 0.0f;
+    for (size_t i = 0; i < points; i++)
+    {
+        if (i > 0 && rng() % 50 != 0)
+            d += step(rng);
+        dist.push_back(d);
+        ele.push_back(600.0f + 300.0f * sinf(d / 4000.0f) + 40.0f * sinf(d / 300.0f) + noise(rng));
+    }
+}
+
+/**
+ * @brief Value at a distance on the segment ending at point i
+ */
+static float lerpAt(const TrackColumn &dist, const TrackColumn &ele, size_t i, float d)
+{
+    if (i == 0)
+        return ele[0];
+    const float segment = dist[i] - dist[i - 1];
+    if (segment <= 0.0f)
+        return ele[i];
+    return ele[i - 1] + (ele[i] - ele[i - 1]) * ((d - dist[i - 1]) / segment);
+}
+
+/**
+ * @brief Columns of a window by scanning the points, same column bounds as TrackProfile::query
+ */
+static void scanColumns(const TrackColumn &dist, const TrackColumn &ele, float from, float to, size_t columns,
+                        ProfileSpan *out)
+{
+    const float width = (to - from) / columns;
+    const float end = dist.back();
+    for (size_t c = 0; c < columns; c++)
+    {
+        const float a = from + c * width;
+        const float b = c + 1 == columns ? to : a + width;
+        if (b < 0.0f || a > end)
+        {
+            out[c] = {NAN, NAN};
+            continue;
+        }
+        ProfileSpan span = {INFINITY, -INFINITY};
+        size_t first = dist.size(), after = dist.size();
+        for (size_t i = 0; i < dist.size(); i++)
+        {
+            if (dist[i] >= a && first == dist.size())
+                first = i;
+            if (dist[i] > b)
+            {
+                after = i;
+                break;
+            }
+            if (dist[i] >= a)
+            {
+                span.min = std::min(span.min, ele[i]);
+                span.max = std::max(span.max, ele[i]);
+            }
+        }
+        auto add = [&](float v) {
+            span.min = std::min(span.min, v);
+            span.max = std::max(span.max, v);
+        };
+        if (a >= 0.0f)
+            add(lerpAt(dist, ele, first < dist.size() ? first : dist.size() - 1, a));
+        if (b <= end && after < dist.size())
+            add(lerpAt(dist, ele, after, b));
+        out[c] = span;
+    }
+}
+
+static bool sameSpan(const ProfileSpan &a, const ProfileSpan &b)
+{
+    if (std::isnan(a.min) || std::isnan(b.min))
+        return std::isnan(a.min) && std::isnan(b.min) && std::isnan(a.max) && std::isnan(b.max);
+    return a.min == b.min && a.max == b.max;
+}
+
+int main(int argc, char **argv)
+{
+    const size_t points = argc > 1 ? strtoul(argv[1], nullptr, 10) : 100000;
+    const int windows = argc > 2 ? atoi(argv[2]) : 300;
+
+    TrackColumn dist, ele;
+    makeTrack(points, dist, ele);
+    const float length = dist.back();
+
+    printf("Track: %zu points, %.1f km\n", points, length / 1000.0f);
+    printf("Checks\n");
+
+    TrackProfile profile;
+    Clock::time_point t0 = Clock::now();
+    profile.build(dist, ele);
+    const double buildMs = elapsedMs(t0);
+    printf("    build %.2f ms, %u levels, %zu bytes (%.0f%% of the values column)\n", buildMs, profile.levelCount(),
+           profile.memoryBytes(), 100.0 * profile.memoryBytes() / (points * sizeof(float)));
+    check(profile.memoryBytes() < points * sizeof(float) / 3, "pyramid under a third of the values");
+
+    {
+        const float lo = *std::min_element(ele.begin(), ele.end()), hi = *std::max_element(ele.begin(), ele.end());
+        const ProfileSpan r = profile.range();
+        check(r.min == lo && r.max == hi && profile.length() == length, "whole track range and length");
+    }
+
+    {
+        std::mt19937 rng(4);
+        std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+        std::vector<ProfileSpan> got, expect;
+        uint32_t mismatches = 0;
+        for (int w = 0; w < windows; w++)
+        {
+            // Whole track, zoomed in to a few meters, and windows past the ends
+            const float span = w % 3 == 0 ? length * 1.2f : w % 3 == 1 ? 5.0f + unit(rng) * 500.0f : unit(rng) * length;
+            const float from = -0.1f * length + unit(rng) * (length * 1.1f);
+            const size_t columns = 1 + rng() % 400;
+            got.resize(columns);
+            expect.resize(columns);
+            profile.query(from, from + span, columns, got.data());
+            scanColumns(dist, ele, from, from + span, columns, expect.data());
+            for (size_t c = 0; c < columns; c++)
+                if (!sameSpan(got[c], expect[c]) && mismatches++ < 5)
+                    printf("    window %.1f-%.1f column %zu: %.3f-%.3f, expected %.3f-%.3f\n", from, from + span, c,
+                           got[c].min, got[c].max, expect[c].min, expect[c].max);
+        }
+        check(mismatches == 0, "random windows match the scan of the points");
+    }
+
+    {
+        // Zoomed in between two points far apart: a straight line, column after column
+        TrackColumn d2 = {0.0f, 1000.0f, 1001.0f}, e2 = {100.0f, 200.0f, 150.0f};
+        TrackProfile sparse;
+        sparse.build(d2, e2);
+        ProfileSpan cols[100];
+        sparse.query(200.0f, 300.0f, 100, cols);
+        bool line = true;
+        for (size_t c = 0; c < 100; c++)
+            line &= fabsf(cols[c].min - (120.0f + c * 0.1f)) < 1e-3f && fabsf(cols[c].max - (120.1f + c * 0.1f)) < 1e-3f;
+        check(line, "columns between two points interpolated");
+        check(fabsf(sparse.valueAt(500.0f) - 150.0f) < 1e-3f && std::isnan(sparse.valueAt(-1.0f)) &&
+                  std::isnan(sparse.valueAt(2000.0f)),
+              "value at a distance");
+    }
+
+    {
+        TrackProfile none;
+        ProfileSpan cols[4];
+        TrackColumn d1 = {0.0f}, e1 = {42.0f};
+        const bool emptyOk = none.empty() && none.query(0.0f, 100.0f, 4, cols) == 0 && std::isnan(cols[0].min);
+        TrackProfile single;
+        single.build(d1, e1);
+        const bool singleOk = single.levelCount() == 0 && single.range().max == 42.0f &&
+                              single.query(-10.0f, 10.0f, 4, cols) == 2 && cols[1].min == 42.0f && std::isnan(cols[3].min);
+        TrackColumn bad = {0.0f, 1.0f};
+        TrackProfile mismatch;
+        mismatch.build(bad, e1);
+        check(emptyOk && singleOk && mismatch.empty(), "empty, one point and mismatched columns");
+    }
+
+    printf("Timing (%zu columns)\n", PLOT_COLUMNS);
+    {
+        std::vector<ProfileSpan> cols(PLOT_COLUMNS);
+        const int reps = 200;
+        t0 = Clock::now();
+        for (int r = 0; r < reps; r++)
+        {
+            profile.query(0.0f, length, PLOT_COLUMNS, cols.data());
+            sink = cols[r % PLOT_COLUMNS].max;
+        }
+        const double wholeMs = elapsedMs(t0) / reps;
+
+        std::mt19937 rng(8);
+        t0 = Clock::now();
+        for (int r = 0; r < reps; r++)
+        {
+            const float from = (rng() % 1000) * length / 1000.0f;
+            profile.query(from, from + 5000.0f, PLOT_COLUMNS, cols.data());
+            sink = cols[r % PLOT_COLUMNS].min;
+        }
+        const double zoomMs = elapsedMs(t0) / reps;
+
+        // Scanning every point of the window once, the cost of plotting the points
+        t0 = Clock::now();
+        for (int r = 0; r < reps / 10; r++)
+        {
+            const float width = length / PLOT_COLUMNS;
+            for (size_t c = 0; c < PLOT_COLUMNS; c++)
+                cols[c] = {INFINITY, -INFINITY};
+            for (size_t i = 0; i < points; i++)
+            {
+                ProfileSpan &s = cols[std::min(PLOT_COLUMNS - 1, (size_t)(dist[i] / width))];
+                s.min = std::min(s.min, ele[i]);
+                s.max = std::max(s.max, ele[i]);
+            }
+            sink = cols[r % PLOT_COLUMNS].max;
+        }
+        const double scanMs = elapsedMs(t0) / (reps / 10);
+
+        printf("  whole track    %8.3f ms\n", wholeMs);
+        printf("  5 km window    %8.3f ms\n", zoomMs);
+        printf("  point scan     %8.3f ms (%.0fx the whole track query)\n", scanMs, scanMs / wholeMs);
+        check(wholeMs < scanMs, "whole track query faster than a point scan");
+    }
+
+    printf("%s\n", failures ? "FAILED" : "All checks passed");
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,281 @@
+/**
+ * @file track_simplify_bench.cpp
+ * @brief  Host benchmark and checks for the Douglas-Peucker track simplification
+ *
+ * Generates dense tracks (a point every meter with GPS noise), simplifies them with
+ * lib/gpx/src/trackSimplify.cpp and checks that every dropped point is within the
+ * tolerance of the simplified track, that kept points are no more than maxSpacing apart,
+ * and that the index map is consistent. Then times the work done on the full and on
+ * the simplified track: closest point search, segment drawing loop and turn detection.
+ *
+ * Build: g++ -O2 -std=c++17 -I../host -I../../lib/gpx/src -I../../lib/utils/src track_simplify_bench.cpp
+ *        ../../lib/gpx/src/trackSimplify.cpp ../../lib/gpx/src/turnScan.cpp ../../lib/utils/src/gpsMath.cpp -o track_simplify_bench
+ */
+
+#include "trackSimplify.hpp"
+#include "turnScan.hpp"
+#include "gpsMath.hpp"
+
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+
+using Clock = std::chrono::steady_clock;
+
+static uint32_t failures = 0;
+static volatile uint32_t sink;      /**< Keeps the timed loops */
+
+static void check(bool condition, const char *what)
+{
+    printf("  %-44s %s\n", what, condition ? "ok" : "FAIL");
+    if (!condition)
+        failures++;
+}
+
+static double elapsedMs(Clock::time_point t0)
+{
+    return std::chrono::duration<double, std::milli>(Clock::now() - t0).count();
+}
+
+static const float METERS_PER_DEG = 111319.49f;
+
+/**
+ * @brief Fill the cumulative distances like GPXParser::loadTrack
+ */
+static void accumulate(TrackVector &track)
+{
+    float total = 0.0f;
+    for (size_t i = 0; i < track.size(); i++)
+    {
+        if (i > 0)
+            total += calcDist(track.lat[i - 1], track.lon[i - 1], track.lat[i], track.lon[i]);
+        track.accumDist[i] = total;
+    }
+}
+
+/**
+ * @brief Dense recorded track: long straights and curves, spacing stepM, GPS noise
+ */
+static TrackVector recordedTrack(uint32_t points, float lat, float lon, float stepM, float noiseM, uint32_t seed)
+{
+    std::mt19937 rng(seed);
+    std::uniform_real_distribution<float> unit(-1.0f, 1.0f);
+    std::normal_distribution<float> noise(0.0f, noiseM);
+    TrackVector track;
+    track.reserve(points);
+    float course = 30.0f, rate = 0.0f;
+    for (uint32_t i = 0; i < points; i++)
+    {
+        const float k = METERS_PER_DEG * cosf(DEG2RAD(lat));
+        track.push_back(lat + noise(rng) / METERS_PER_DEG, lon + noise(rng) / k, 500.0f + 100.0f * sinf(i * 1e-4f));
+        if (i % 300 == 0)
+            rate = unit(rng) < 0.0f ? 0.0f : unit(rng) * 0.3f * stepM;  // Straight or bend, radius 190 m or more
+        if (i % 2000 == 1000)
+            course += unit(rng) * 120.0f;                               // Junction
+        course += rate;
+        lat += stepM * cosf(DEG2RAD(course)) / METERS_PER_DEG;
+        lon += stepM * sinf(DEG2RAD(course)) / k;
+        if (lon > 180.0f)
+            lon -= 360.0f;
+    }
+    accumulate(track);
+    return track;
+}
+
+/**
+ * @brief Distance (m) from a point to a segment, local plane at the segment start
+ */
+static float segmentDistance(float lat, float lon, float aLat, float aLon, float bLat, float bLon)
+{
+    const float k = METERS_PER_DEG * cosf(DEG2RAD(aLat));
+    auto wrap = [](float d) { return d > 180.0f ? d - 360.0f : (d < -180.0f ? d + 360.0f : d); };
+    const float bx = wrap(bLon - aLon) * k, by = (bLat - aLat) * METERS_PER_DEG;
+    const float px = wrap(lon - aLon) * k, py = (lat - aLat) * METERS_PER_DEG;
+    const float lenSq = bx * bx + by * by;
+    float t = lenSq > 0.0f ? (px * bx + py * by) / lenSq : 0.0f;
+    t = t < 0.0f ? 0.0f : (t > 1.0f ? 1.0f : t);
+    return hypotf(px - t * bx, py - t * by);
+}
+
+/**
+ * @brief Global closest point search over every point
+ */
+static size_t closestPoint(const TrackVector &track, float lat, float lon)
+{
+    const float uLat = DEG2RAD(lat), uLon = DEG2RAD(lon);
+    float best = 1e30f;
+    size_t bestIdx = 0;
+    for (size_t i = 0; i < track.size(); i++)
+    {
+        const float dSq = calcDistSq(uLat, uLon, DEG2RAD(track.lat[i]), DEG2RAD(track.lon[i]));
+        if (dSq < best)
+        {
+            best = dSq;
+            bestIdx = i;
+        }
+    }
+    return bestIdx;
+}
+
+/**
+ * @brief Segment loop of Maps::drawTrack without the drawing, returns segments in view
+ */
+static uint32_t drawLoop(const TrackVector &track, float minLat, float maxLat, float minLon, float maxLon)
+{
+    uint32_t visible = 0;
+    const float *lat = track.lat.data();
+    const float *lon = track.lon.data();
+    for (size_t i = 1; i < track.size(); ++i)
+    {
+        const int16_t x1 = (int16_t)((lon[i - 1] - minLon) / (maxLon - minLon) * 320.0f);
+        const int16_t y1 = (int16_t)((maxLat - lat[i - 1]) / (maxLat - minLat) * 480.0f);
+        const int16_t x2 = (int16_t)((lon[i] - minLon) / (maxLon - minLon) * 320.0f);
+        const int16_t y2 = (int16_t)((maxLat - lat[i]) / (maxLat - minLat) * 480.0f);
+        if ((x1 >= 0 && x1 < 320 && y1 >= 0 && y1 < 480) || (x2 >= 0 && x2 < 320 && y2 >= 0 && y2 < 480))
+            visible++;
+    }
+    return visible;
+}
+
+/**
+ * @brief Simplify a track, check the result and time the consumers
+ */
+static void runCase(const char *name, const TrackVector &full, const SimplifyParams &params)
+{
+    TrackVector nav;
+    TrackIndexMap map;
+    auto t0 = Clock::now();
+    simplifyTrack(full, params, nav, map);
+    const double simplifyMs = elapsedMs(t0);
+
+    printf("%s: %u -> %u points (x%.1f), tolerance %.1f m, spacing %.0f m, %.1f ms\n", name, (unsigned)full.size(),
+           (unsigned)nav.size(), (double)full.size() / nav.size(), params.tolerance, params.maxSpacing, simplifyMs);
+
+    bool ordered = map.size() == nav.size() && map.front() == 0 && map.back() == full.size() - 1;
+    bool copied = true;
+    bool spaced = true;
+    for (size_t k = 0; k < map.size(); k++)
+    {
+        ordered &= k == 0 || map[k] > map[k - 1];
+        copied &= nav.lat[k] == full.lat[map[k]] && nav.ele[k] == full.ele[map[k]] &&
+                  nav.accumDist[k] == full.accumDist[map[k]];
+        if (k > 0 && map[k] - map[k - 1] > 1 && params.maxSpacing > 0.0f)
+            spaced &= nav.accumDist[k] - nav.accumDist[k - 1] <= params.maxSpacing;
+    }
+
+    float worst = 0.0f;
+    bool mapped = true;
+    for (size_t k = 1; k < map.size(); k++)
+    {
+        for (uint32_t j = map[k - 1] + 1; j < map[k]; j++)
+        {
+            const float d = segmentDistance(full.lat[j], full.lon[j], nav.lat[k - 1], nav.lon[k - 1], nav.lat[k], nav.lon[k]);
+            worst = std::max(worst, d);
+            mapped &= fullToNavIdx(map, j) == k - 1;
+        }
+        mapped &= fullToNavIdx(map, map[k]) == k;
+    }
+    check(ordered && copied, "index map and copied columns");
+    check(mapped, "full to simplified index");
+    check(spaced, "kept points within max spacing");
+    char what[64];
+    snprintf(what, sizeof(what), "dropped points within tolerance (%.2f m)", worst);
+    check(worst <= params.tolerance * 1.01f + 0.01f, what);
+
+    // Closest point search from positions along the track
+    const uint32_t queries = 200;
+    float worstMiss = 0.0f;
+    t0 = Clock::now();
+    for (uint32_t q = 0; q < queries; q++)
+        sink = closestPoint(full, full.lat[q * (full.size() / queries)] + 1e-5f, full.lon[q * (full.size() / queries)]);
+    const double fullSearchMs = elapsedMs(t0);
+    t0 = Clock::now();
+    for (uint32_t q = 0; q < queries; q++)
+    {
+        const size_t j = q * (full.size() / queries);
+        const size_t k = closestPoint(nav, full.lat[j] + 1e-5f, full.lon[j]);
+        worstMiss = std::max(worstMiss, calcDist(full.lat[j] + 1e-5f, full.lon[j], nav.lat[k], nav.lon[k]));
+    }
+    const double navSearchMs = elapsedMs(t0);
+    if (params.maxSpacing > 0.0f)
+        check(worstMiss <= params.maxSpacing / 2.0f + params.tolerance + 2.0f, "closest simplified point near the position");
+
+    float minLat = 90.0f, maxLat = -90.0f, minLon = 180.0f, maxLon = -180.0f;
+    for (size_t i = 0; i < nav.size(); i++)
+    {
+        minLat = std::min(minLat, nav.lat[i]);
+        maxLat = std::max(maxLat, nav.lat[i]);
+        minLon = std::min(minLon, nav.lon[i]);
+        maxLon = std::max(maxLon, nav.lon[i]);
+    }
+    t0 = Clock::now();
+    sink = drawLoop(full, minLat, maxLat, minLon, maxLon);
+    const double fullDrawMs = elapsedMs(t0);
+    t0 = Clock::now();
+    sink = drawLoop(nav, minLat, maxLat, minLon, maxLon);
+    const double navDrawMs = elapsedMs(t0);
+
+    const TurnParams turnParams = {18.0f, 10, 70.0f, 5};
+    t0 = Clock::now();
+    const std::vector<TurnPoint> turns = TurnScan::detect(full, turnParams);
+    const double fullTurnMs = elapsedMs(t0);
+    const size_t fullTurns = turns.size();
+    t0 = Clock::now();
+    const size_t navTurns = TurnScan::detect(nav, turnParams).size();
+    const double navTurnMs = elapsedMs(t0);
+
+    // Turns are detected on the full track and moved to the simplified one
+    std::vector<TurnPoint> navMapped = turns;
+    turnsToNav(nav, map, navMapped);
+    bool sameTurns = navMapped.size() == turns.size();
+    float worstShift = 0.0f;
+    for (size_t i = 0; sameTurns && i < turns.size(); i++)
+    {
+        const TurnPoint &t = navMapped[i];
+        sameTurns = t.idx >= 0 && (size_t)t.idx < nav.size() && (i == 0 || t.idx >= navMapped[i - 1].idx) &&
+                    t.angle == turns[i].angle && t.distance == turns[i].distance;
+        if (sameTurns)
+            worstShift = std::max(worstShift, fabsf(nav.accumDist[t.idx] - t.distance));
+    }
+    check(sameTurns, "full track turns kept, in order");
+    if (params.maxSpacing > 0.0f)
+        check(worstShift <= params.maxSpacing / 2.0f, "turns on the nearest simplified point");
+
+    printf("      closest point x%u: %.1f ms -> %.1f ms\n", queries, fullSearchMs, navSearchMs);
+    printf("      draw loop       : %.2f ms -> %.2f ms\n", fullDrawMs, navDrawMs);
+    printf("      turns           : %.1f ms -> %.1f ms (%u -> %u turns)\n", fullTurnMs, navTurnMs, (unsigned)fullTurns,
+           (unsigned)navTurns);
+}
+
+int main(int argc, char **argv)
+{
+    const uint32_t points = argc > 1 ? strtoul(argv[1], nullptr, 10) : 1000000;
+    const float tolerance = argc > 2 ? strtof(argv[2], nullptr) : 2.0f;
+
+    const TrackVector hike = recordedTrack(points, 42.5f, 1.5f, 1.0f, 0.3f, 1);
+    runCase("1 m hike", hike, {tolerance, 25.0f});
+    runCase("1 m hike, no spacing limit", hike, {tolerance, 0.0f});
+    runCase("1 m hike, tight", hike, {0.5f, 25.0f});
+    runCase("5 m bike", recordedTrack(points / 4, 47.0f, 8.0f, 5.0f, 0.5f, 2), {tolerance, 25.0f});
+    runCase("antimeridian", recordedTrack(points / 10, -16.5f, 179.9f, 2.0f, 0.5f, 3), {tolerance, 25.0f});
+
+    printf("Edge cases\n");
+    TrackVector nav;
+    TrackIndexMap map;
+    TrackVector one = recordedTrack(1, 41.0f, 2.0f, 1.0f, 0.0f, 4);
+    check(simplifyTrack(one, {2.0f, 25.0f}, nav, map) == 1 && map[0] == 0, "single point");
+    TrackVector two = recordedTrack(2, 41.0f, 2.0f, 1.0f, 0.0f, 4);
+    check(simplifyTrack(two, {2.0f, 25.0f}, nav, map) == 2, "two points");
+    TrackVector same;
+    for (int i = 0; i < 1000; i++)
+        same.push_back(41.0f, 2.0f, 0.0f);
+    accumulate(same);
+    check(simplifyTrack(same, {2.0f, 25.0f}, nav, map) == 2, "repeated point");
+    check(simplifyTrack(hike, {0.0f, 25.0f}, nav, map) == hike.size() && map.back() == hike.size() - 1,
+          "tolerance 0 keeps all points");
+
+    printf("%s\n", failures ? "FAILED" : "All checks passed");
+    return failures ? 1 : 0;
+}
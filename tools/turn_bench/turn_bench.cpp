@@ -0,0 +1,265 @@
+/**
+ * @file turn_bench.cpp
+ * @brief  Host benchmark and equivalence checks for the turn detection
+ *
+ * Runs the former per-point sliding window search (copied below) and the linear-time
+ * scan of lib/gpx/src/turnScan.cpp over synthetic tracks and optional GPX files, checks
+ * that both return the same turns and times them.
+ *
+ * Build: g++ -O2 -std=c++17 -I../host -I../../lib/gpx/src -I../../lib/utils/src turn_bench.cpp
+ *        ../../lib/gpx/src/turnScan.cpp ../../lib/gpx/src/gpxTokenizer.cpp ../../lib/utils/src/gpsMath.cpp -o turn_bench
+ */
+
+#include "turnScan.hpp"
+#include "gpxTokenizer.hpp"
+#include "gpsMath.hpp"
+
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <string>
+
+using Clock = std::chrono::steady_clock;
+
+static uint32_t failures = 0;
+
+static void check(bool condition, const char *what)
+{
+    printf("  %-44s %s\n", what, condition ? "ok" : "FAIL");
+    if (!condition)
+        failures++;
+}
+
+static double elapsedMs(Clock::time_point t0)
+{
+    return std::chrono::duration<double, std::milli>(Clock::now() - t0).count();
+}
+
+/**
+ * @brief Former GPXParser::getTurnPointsSlidingWindow, O(points * window)
+ */
+static std::vector<TurnPoint> referenceTurns(float thresholdDeg, float minDist, float sharpTurnDeg,
+                                             int windowSize, const TrackVector& trackData)
+{
+    std::vector<TurnPoint> turnPoints;
+    if (trackData.size() < 2 * windowSize + 1) return turnPoints;
+    turnPoints.reserve(trackData.size() / 20);
+    for (size_t i = windowSize; i < trackData.size() - windowSize; ++i)
+    {
+        float distWindow = 0.0f;
+        bool skipWindow = false;
+        for (int j = int(i - windowSize); j < int(i + windowSize); ++j)
+        {
+            float d = calcDist(trackData.lat[j], trackData.lon[j], trackData.lat[j + 1], trackData.lon[j + 1]);
+            if (d > 200.0f) 
+            { 
+                skipWindow = true; 
+                break; 
+            }
+            distWindow += d;
+        }
+        if (skipWindow) 
+            continue;
+        float brgStart = calcCourse(trackData.lat[i - windowSize], trackData.lon[i - windowSize], trackData.lat[i], trackData.lon[i]);
+        float brgEnd   = calcCourse(trackData.lat[i], trackData.lon[i], trackData.lat[i + windowSize], trackData.lon[i + windowSize]);
+        float diff = calcAngleDiff(brgEnd, brgStart);
+        if (std::fabs(diff) > sharpTurnDeg)
+        {
+            turnPoints.push_back({static_cast<int>(i), diff, trackData.accumDist[i]});
+            continue;
+        }
+        if (distWindow < minDist) 
+            continue;
+        if (std::fabs(diff) > thresholdDeg) 
+            turnPoints.push_back({static_cast<int>(i), diff, trackData.accumDist[i]});
+    }
+    return turnPoints;
+}
+
+/**
+ * @brief Fill the cumulative distances like GPXParser::loadTrack
+ */
+static void accumulate(TrackVector &track)
+{
+    float total = 0.0f;
+    for (size_t i = 0; i < track.size(); i++)
+    {
+        if (i > 0)
+            total += calcDist(track.lat[i - 1], track.lon[i - 1], track.lat[i], track.lon[i]);
+        track.accumDist[i] = total;
+    }
+}
+
+/**
+ * @brief Walk with a random course, step length and course change
+ */
+static TrackVector randomWalk(uint32_t points, float lat, float lon, float stepM, float turnDeg, uint32_t seed)
+{
+    std::mt19937 rng(seed);
+    std::uniform_real_distribution<float> unit(-1.0f, 1.0f);
+    TrackVector track;
+    track.reserve(points);
+    float course = 0.0f;
+    for (uint32_t i = 0; i < points; i++)
+    {
+        track.push_back(lat, lon, 0.0f);
+        course += unit(rng) * turnDeg;
+        const float step = stepM * (1.0f + 0.5f * unit(rng));
+        lat += step * cosf(DEG2RAD(course)) / 111195.0f;
+        lon += step * sinf(DEG2RAD(course)) / (111195.0f * cosf(DEG2RAD(lat)));
+        if (lon > 180.0f)
+            lon -= 360.0f;
+        if (lon < -180.0f)
+            lon += 360.0f;
+    }
+    accumulate(track);
+    return track;
+}
+
+/**
+ * @brief Zig-zag climb with hairpins every legPoints points
+ */
+static TrackVector switchbacks(uint32_t points, uint32_t legPoints)
+{
+    TrackVector track;
+    float lat = 42.5f, lon = 1.5f;
+    for (uint32_t i = 0; i < points; i++)
+    {
+        track.push_back(lat, lon, 0.0f);
+        const bool east = (i / legPoints) % 2 == 0;
+        lon += (east ? 1.0f : -1.0f) * 0.00012f;
+        lat += 0.00002f;
+    }
+    accumulate(track);
+    return track;
+}
+
+/**
+ * @brief Circle of the given radius
+ */
+static TrackVector circle(uint32_t points, float radiusM)
+{
+    TrackVector track;
+    for (uint32_t i = 0; i < points; i++)
+    {
+        const float a = 2.0f * (float)M_PI * i / points;
+        track.push_back(41.0f + radiusM * cosf(a) / 111195.0f, 2.0f + radiusM * sinf(a) / (111195.0f * 0.7547f), 0.0f);
+    }
+    accumulate(track);
+    return track;
+}
+
+/**
+ * @brief Random walk with duplicate points and jumps over 200 m
+ */
+static TrackVector gapsAndDuplicates(uint32_t points)
+{
+    TrackVector walk = randomWalk(points, 41.3f, 2.1f, 8.0f, 25.0f, 7);
+    TrackVector track;
+    for (size_t i = 0; i < walk.size(); i++)
+    {
+        float lat = walk.lat[i];
+        if (i % 997 > 900)
+            lat += 0.003f;      // ~330 m off
+        track.push_back(lat, walk.lon[i], 0.0f);
+        if (i % 13 == 0)
+            track.push_back(lat, walk.lon[i], 0.0f);
+    }
+    accumulate(track);
+    return track;
+}
+
+/**
+ * @brief Track points of a GPX file
+ */
+static TrackVector loadGpx(const char *path)
+{
+    TrackVector track;
+    GpxTokenizer tokenizer;
+    if (!tokenizer.open(path))
+        return track;
+    GpxPoint point;
+    while (tokenizer.nextPoint("trkpt", point))
+        track.push_back(point.lat, point.lon, point.hasEle ? point.ele : 0.0f);
+    tokenizer.close();
+    accumulate(track);
+    return track;
+}
+
+static bool sameTurns(const std::vector<TurnPoint> &a, const std::vector<TurnPoint> &b)
+{
+    if (a.size() != b.size())
+        return false;
+    for (size_t i = 0; i < a.size(); i++)
+    {
+        if (a[i].idx != b[i].idx || a[i].angle != b[i].angle || a[i].distance != b[i].distance)
+            return false;
+    }
+    return true;
+}
+
+/**
+ * @brief Compare and time both detectors on a track
+ */
+static void runCase(const char *name, const TrackVector &track, const TurnParams &params)
+{
+    auto t0 = Clock::now();
+    const std::vector<TurnPoint> expected = referenceTurns(params.thresholdDeg, params.minDist, params.sharpTurnDeg,
+                                                           params.windowSize, track);
+    const double referenceMs = elapsedMs(t0);
+
+    t0 = Clock::now();
+    const std::vector<TurnPoint> turns = TurnScan::detect(track, params);
+    const double scanMs = elapsedMs(t0);
+
+    // Small steps, as run by the background task
+    TurnScan scan;
+    scan.begin(track, params);
+    bool monotonic = true;
+    uint8_t last = scan.progress();
+    while (!scan.step(37))
+    {
+        monotonic &= scan.progress() >= last;
+        last = scan.progress();
+    }
+
+    char what[96];
+    snprintf(what, sizeof(what), "%s (%u pts, %u turns)", name, (unsigned)track.size(), (unsigned)expected.size());
+    check(sameTurns(expected, turns) && sameTurns(expected, scan.turns) && monotonic && scan.progress() == 100, what);
+    printf("      window %d: %.2f ms -> %.2f ms (x%.1f)\n", params.windowSize, referenceMs, scanMs,
+           scanMs > 0.0 ? referenceMs / scanMs : 0.0);
+}
+
+int main(int argc, char **argv)
+{
+    const TurnParams screen = {18.0f, 10, 70.0f, 5};     // Track screen settings
+    const TurnParams wide = {25.0f, 40, 60.0f, 20};
+    const TurnParams tight = {10.0f, 0, 90.0f, 1};
+
+    printf("Synthetic tracks\n");
+    const TrackVector hike = randomWalk(200000, 41.5f, 2.0f, 6.0f, 12.0f, 1);
+    runCase("hike", hike, screen);
+    runCase("hike", hike, wide);
+    runCase("hike", hike, tight);
+    runCase("switchbacks", switchbacks(50000, 40), screen);
+    runCase("GPS jitter", randomWalk(50000, 41.5f, 2.0f, 0.8f, 90.0f, 2), screen);
+    runCase("gaps and duplicates", gapsAndDuplicates(50000), screen);
+    runCase("circle", circle(3600, 300.0f), screen);
+    runCase("high latitude", randomWalk(50000, 78.2f, 15.6f, 10.0f, 20.0f, 3), screen);
+    runCase("antimeridian", randomWalk(50000, -16.5f, 179.99f, 15.0f, 20.0f, 4), screen);
+    runCase("tiny", randomWalk(11, 41.5f, 2.0f, 5.0f, 60.0f, 5), screen);
+    runCase("too short", randomWalk(10, 41.5f, 2.0f, 5.0f, 60.0f, 5), screen);
+
+    if (argc > 1)
+        printf("GPX files\n");
+    for (int i = 1; i < argc; i++)
+    {
+        const TrackVector track = loadGpx(argv[i]);
+        runCase(argv[i], track, screen);
+    }
+
+    printf("%s\n", failures ? "FAILED" : "All checks passed");
+    return failures ? 1 : 0;
+}
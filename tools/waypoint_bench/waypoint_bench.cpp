@@ -0,0 +1,304 @@
+/**
+ * @file waypoint_bench.cpp
+ * @brief  Host benchmark and consistency checks for the indexed waypoint store
+ *
+ * Generates a waypoint GPX file, imports it into lib/gpx/src/waypointStore.cpp and times
+ * adds, renames, deletes and lookups against a full export of the GPX file, which is
+ * the cost every edit had when the whole document was rewritten.
+ *
+ * Then checks log replay, recovery from a torn record, compaction, the GPX export round
+ * trip, re-import after an outside change of the GPX file and the spatial query.
+ *
+ * Build: g++ -O2 -std=c++17 -I../host -I../../lib/gpx/src -I../../lib/utils/src waypoint_bench.cpp
+ *        ../../lib/gpx/src/waypointStore.cpp ../../lib/gpx/src/gpxTokenizer.cpp -o waypoint_bench
+ */
+
+#include "waypointStore.hpp"
+
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <sys/stat.h>
+#include <utime.h>
+
+using Clock = std::chrono::steady_clock;
+
+static uint32_t failures = 0;
+
+static void check(bool condition, const char *what)
+{
+    printf("  %-44s %s\n", what, condition ? "ok" : "FAIL");
+    if (!condition)
+        failures++;
+}
+
+static double elapsedUs(Clock::time_point t0)
+{
+    return std::chrono::duration<double, std::micro>(Clock::now() - t0).count();
+}
+
+static void wptLocation(uint32_t i, float &lat, float &lon)
+{
+    lat = 41.0f + (float)((i * 7919u) % 10000) * 0.0002f;
+    lon = 1.5f + (float)((i * 104729u) % 10000) * 0.0002f;
+}
+
+/**
+ * @brief Write a waypoint GPX file like the ones exported by IceNav, plus a few odd entries
+ */
+static bool writeGpx(const std::string &path, uint32_t count)
+{
+    FILE *f = fopen(path.c_str(), "w");
+    if (!f)
+        return false;
+    fprintf(f, "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n<gpx version=\"1.0\" creator=\"IceNav\">\n");
+    for (uint32_t i = 0; i < count; i++)
+    {
+        float lat, lon;
+        wptLocation(i, lat, lon);
+        fprintf(f, "<wpt lat=\"%.6f\" lon=\"%.6f\">\n <ele>%u</ele>\n <time>2026-10-18T10:00:00Z</time>\n"
+                   " <name>WP %u</name>\n <src>IceNav</src>\n <sat>%u</sat>\n <hdop>1.2</hdop>\n</wpt>\n",
+                lat, lon, 100 + i % 500, i, 4 + i % 8);
+    }
+    fprintf(f, "<wpt lat=\"42.5\" lon=\"1.7\"><name>Fish &amp; Chips</name><desc>&lt;b&gt;</desc></wpt>\n");
+    fprintf(f, "<wpt lat=\"42.6\" lon=\"1.8\"/>\n");
+    fprintf(f, "</gpx>\n");
+    return fclose(f) == 0;
+}
+
+static void freeWaypoint(wayPoint &wp)
+{
+    free(wp.name); free(wp.time); free(wp.desc); free(wp.src); free(wp.sym); free(wp.type);
+    wp = {};
+}
+
+static bool hasWaypoint(WaypointStore &store, const char *name, float lat, float lon)
+{
+    wayPoint wp = {};
+    const bool found = store.get(name, wp) && wp.name && strcmp(wp.name, name) == 0 &&
+                       std::fabs(wp.lat - lat) < 1e-6f && std::fabs(wp.lon - lon) < 1e-6f;
+    freeWaypoint(wp);
+    return found;
+}
+
+static long fileSize(const std::string &path)
+{
+    struct stat st;
+    return stat(path.c_str(), &st) == 0 ? (long)st.st_size : -1;
+}
+
+int main(int argc, char **argv)
+{
+    const uint32_t count = argc > 1 ? strtoul(argv[1], nullptr, 10) : 2000;
+    const uint32_t edits = argc > 2 ? strtoul(argv[2], nullptr, 10) : 200;
+    const std::string gpx = "waypoint_bench.gpx";
+    const std::string wdb = gpx + ".wdb";
+    char name[32];
+
+    if (!writeGpx(gpx, count))
+    {
+        perror(gpx.c_str());
+        return 1;
+    }
+    std::remove(wdb.c_str());
+
+    WaypointStore store;
+    auto t0 = Clock::now();
+    const bool opened = store.open(gpx.c_str());
+    const double importUs = elapsedUs(t0);
+
+    printf("Import\t\t: %u waypoints, %ld byte GPX -> %ld byte log in %.1f ms\n", (unsigned)store.liveCount,
+           fileSize(gpx), fileSize(wdb), importUs / 1000.0);
+
+    t0 = Clock::now();
+    for (uint32_t i = 0; i < edits; i++)
+    {
+        wayPoint wp = {};
+        snprintf(name, sizeof(name), "NEW %u", i);
+        wp.name = name;
+        wptLocation(count + i, wp.lat, wp.lon);
+        wp.ele = 250;
+        store.add(wp);
+    }
+    const double addUs = elapsedUs(t0) / edits;
+
+    t0 = Clock::now();
+    for (uint32_t i = 0; i < edits; i++)
+    {
+        char newName[32];
+        snprintf(name, sizeof(name), "NEW %u", i);
+        snprintf(newName, sizeof(newName), "REN %u", i);
+        store.rename(name, newName);
+    }
+    const double renameUs = elapsedUs(t0) / edits;
+
+    t0 = Clock::now();
+    uint32_t found = 0;
+    for (uint32_t i = 0; i < edits; i++)
+    {
+        wayPoint wp = {};
+        snprintf(name, sizeof(name), "WP %u", (i * 37) % count);
+        found += store.get(name, wp);
+        freeWaypoint(wp);
+    }
+    const double getUs = elapsedUs(t0) / edits;
+
+    t0 = Clock::now();
+    for (uint32_t i = 0; i < edits / 2; i++)
+    {
+        snprintf(name, sizeof(name), "REN %u", i);
+        store.remove(name);
+    }
+    const double removeUs = elapsedUs(t0) / (edits / 2);
+
+    t0 = Clock::now();
+    const bool exported = store.exportGpx();
+    const double exportUs = elapsedUs(t0);
+
+    printf("Add\t\t: %.1f us per waypoint\n", addUs);
+    printf("Rename\t\t: %.1f us per waypoint\n", renameUs);
+    printf("Delete\t\t: %.1f us per waypoint\n", removeUs);
+    printf("Lookup\t\t: %.1f us per waypoint\n", getUs);
+    printf("GPX rewrite\t: %.1f us (cost of each edit without the log, x%.0f an add)\n", exportUs,
+           addUs > 0 ? exportUs / addUs : 0.0);
+    printf("Log\t\t: %u bytes, %u live, %u dead records\n", (unsigned)store.logSize, (unsigned)store.liveCount,
+           (unsigned)store.deadCount);
+
+    const uint32_t expected = count + 2 + edits - edits / 2;
+    printf("Edits\n");
+    check(opened && exported && store.liveCount == expected, "import, add, rename and delete counts");
+    check(found == edits, "lookups by name");
+    float lat, lon;
+    wptLocation(count + edits - 1, lat, lon);
+    snprintf(name, sizeof(name), "REN %u", edits - 1);
+    check(hasWaypoint(store, name, lat, lon), "renamed waypoint keeps its fields");
+    snprintf(name, sizeof(name), "NEW %u", edits - 1);
+    check(!hasWaypoint(store, name, lat, lon), "old name is gone");
+    check(!hasWaypoint(store, "REN 0", 0, 0), "deleted waypoint is gone");
+    wayPoint special = {};
+    check(store.get("Fish & Chips", special) && special.desc && strcmp(special.desc, "<b>") == 0,
+          "XML entities in name and description");
+    freeWaypoint(special);
+    snprintf(name, sizeof(name), "WPT%03u", count + 2);
+    check(hasWaypoint(store, name, 42.6f, 1.8f), "unnamed waypoint gets a name");
+
+    printf("Replay\n");
+    {
+        WaypointStore replayed;
+        check(replayed.open(gpx.c_str()) && replayed.liveCount == store.liveCount &&
+                  replayed.getNames() == store.getNames(),
+              "log replays to the same waypoints");
+        replayed.close();
+    }
+
+    wayPoint wp = {};
+    wp.name = (char *)"TORN";
+    store.add(wp);
+    store.close();
+    const long goodSize = fileSize(wdb);
+    FILE *f = fopen(wdb.c_str(), "ab");
+    const uint8_t torn[11] = {0x12, 0x34, 0x56, 0x78, 40, 0, 1, 0, 'x', 'y', 'z'};
+    fwrite(torn, 1, sizeof(torn), f);
+    fclose(f);
+    check(store.open(gpx.c_str()) && store.liveCount == expected + 1 && fileSize(wdb) == goodSize,
+          "torn record at the end is dropped");
+
+    printf("Compaction\n");
+    const uint32_t live = store.liveCount;
+    for (uint32_t i = 0; i < count / 2; i++)
+    {
+        snprintf(name, sizeof(name), "WP %u", i);
+        store.remove(name);
+    }
+    check(store.liveCount == live - count / 2, "deleted half of the waypoints");
+    check(store.deadCount <= WaypointStore::COMPACT_MIN_DEAD || store.deadCount <= store.liveCount,
+          "log compacted automatically");
+    const long before = store.logSize;
+    check(store.compact() && store.deadCount == 0 && (long)store.logSize <= before, "explicit compaction");
+    wptLocation(count - 1, lat, lon);
+    snprintf(name, sizeof(name), "WP %u", count - 1);
+    check(store.liveCount == live - count / 2 && hasWaypoint(store, name, lat, lon), "contents kept");
+
+    printf("Export\n");
+    const std::vector<std::string> names = store.getNames();
+    check(store.exportGpx() && !store.dirty, "exported to GPX");
+    store.close();
+    std::remove(wdb.c_str());
+    check(store.open(gpx.c_str()) && store.getNames() == names, "GPX re-import gives the same waypoints");
+    check(hasWaypoint(store, name, lat, lon), "exported coordinates");
+
+    // Each case reopens without close(), as a reset would
+    printf("Power loss recovery\n");
+    wayPoint pending = {};
+    pending.name = (char *)"PENDING";
+    pending.lat = 41.0f;
+    pending.lon = 2.0f;
+    store.add(pending);
+    std::vector<std::string> expectedNames = store.getNames();
+    std::rename(wdb.c_str(), (wdb + ".tmp").c_str());
+    check(store.open(gpx.c_str()) && store.getNames() == expectedNames && store.dirty &&
+              fileSize(wdb + ".tmp") < 0, "compacted log left as .tmp is recovered");
+    check(store.exportGpx(), "export before the cut");
+    std::rename(gpx.c_str(), (gpx + ".tmp").c_str());
+    check(store.open(gpx.c_str()) && store.getNames() == expectedNames && fileSize(gpx + ".tmp") < 0,
+          "exported GPX left as .tmp is recovered");
+    f = fopen((gpx + ".tmp").c_str(), "w");
+    fputs("<gpx><wpt lat=\"1\"", f);
+    fclose(f);
+    check(store.open(gpx.c_str()) && store.getNames() == expectedNames && fileSize(gpx + ".tmp") < 0,
+          "partial .tmp next to the GPX is removed");
+    pending.name = (char *)"PENDING 2";
+    store.add(pending);
+    expectedNames = store.getNames();
+    std::remove(gpx.c_str());
+    check(store.open(gpx.c_str()) && store.getNames() == expectedNames && !store.dirty && fileSize(gpx) > 0,
+          "missing GPX is exported from the log");
+    store.close();
+    std::remove(wdb.c_str());
+    check(store.open(gpx.c_str()) && store.getNames() == expectedNames, "exported GPX holds every waypoint");
+
+    store.close();
+    f = fopen(gpx.c_str(), "r+");
+    fseek(f, -7, SEEK_END);
+    fputs("<wpt lat=\"40.0\" lon=\"2.0\"><name>OUTSIDE</name></wpt>\n</gpx>\n", f);
+    fclose(f);
+    struct stat st;
+    stat(gpx.c_str(), &st);
+    struct utimbuf times = {st.st_mtime + 10, st.st_mtime + 10};
+    utime(gpx.c_str(), &times);
+    check(store.open(gpx.c_str()) && hasWaypoint(store, "OUTSIDE", 40.0f, 2.0f), "GPX edited outside is re-imported");
+
+    printf("Spatial query\n");
+    std::vector<uint32_t> ids;
+    const float minLat = 41.3f, maxLat = 41.6f, minLon = 1.9f, maxLon = 2.4f;
+    t0 = Clock::now();
+    store.query(minLat, maxLat, minLon, maxLon, ids);
+    const double queryUs = elapsedUs(t0);
+    uint32_t brute = 0;
+    for (const std::string &n : store.getNames())
+    {
+        wayPoint q = {};
+        if (store.get(n.c_str(), q) && q.lat >= minLat && q.lat <= maxLat && q.lon >= minLon && q.lon <= maxLon)
+            brute++;
+        freeWaypoint(q);
+    }
+    bool inside = true;
+    for (uint32_t id : ids)
+    {
+        const WaypointEntry &e = store.getEntry(id);
+        inside = inside && e.alive && e.lat >= minLat && e.lat <= maxLat && e.lon >= minLon && e.lon <= maxLon;
+    }
+    printf("  %u waypoints in the box, %.1f us\n", (unsigned)ids.size(), queryUs);
+    check(ids.size() == brute && inside, "grid query matches a full scan");
+    store.query(-90, 90, -180, 180, ids);
+    check(ids.size() == store.liveCount, "whole world query");
+
+    store.close();
+    std::remove(gpx.c_str());
+    std::remove(wdb.c_str());
+    printf("%s\n", failures ? "FAILED" : "All checks passed");
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,299 @@
+/**
+ * @file waypoint_overlay_bench.cpp
+ * @brief  Host benchmark and checks for the waypoint map overlay
+ *
+ * Builds the overlay of lib/maps/src/waypoint_overlay.cpp over synthetic waypoints
+ * (dense towns and scattered points), then compares random viewports at every zoom with
+ * a scan of all the waypoints, clustered and not, and times the frames. Also checks the
+ * positions and generations given by the waypoint store.
+ *
+ * Build: g++ -O2 -std=c++17 -I../host -I../../lib/gpx/src -I../../lib/utils/src -I../../lib/maps/src
+ *        waypoint_overlay_bench.cpp ../../lib/maps/src/waypoint_overlay.cpp ../../lib/gpx/src/waypointStore.cpp
+ *        ../../lib/gpx/src/gpxTokenizer.cpp -o waypoint_overlay_bench
+ */
+
+#include "waypoint_overlay.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <map>
+#include <random>
+#include <string>
+#include <sys/stat.h>
+
+using Clock = std::chrono::steady_clock;
+
+static uint32_t failures = 0;
+
+static void check(bool condition, const char *what)
+{
+    printf("  %-44s %s\n", what, condition ? "ok" : "FAIL");
+    if (!condition)
+        failures++;
+}
+
+static double elapsedUs(Clock::time_point t0)
+{
+    return std::chrono::duration<double, std::micro>(Clock::now() - t0).count();
+}
+
+static const int32_t VIEW_SIZE = 600;       /**< Bounding square of a rotated 320x480 screen */
+static const uint8_t CLUSTER_ZOOM = 15;     /**< Map default: clusters below this zoom */
+
+/**
+ * @brief Waypoints around a few towns, plus some scattered over the region
+ */
+static void makeWaypoints(uint32_t count, std::vector<WaypointPosition> &points)
+{
+    std::mt19937 rng(47);
+    std::normal_distribution<float> spread(0.0f, 0.02f);
+    std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+    const float towns[][2] = {{41.39f, 2.17f}, {41.98f, 2.82f}, {41.62f, 0.62f}, {42.51f, 1.52f}, {41.12f, 1.25f}};
+    for (uint32_t i = 0; i < count; i++)
+    {
+        float lat, lon;
+        if (i % 4 == 3)
+        {
+            lat = 40.5f + unit(rng) * 2.5f;
+            lon = 0.2f + unit(rng) * 3.0f;
+        }
+        else
+        {
+            const float *town = towns[i % 5];
+            lat = town[0] + spread(rng);
+            lon = town[1] + spread(rng);
+        }
+        points.push_back({lat, lon, i * 3});   // Ids are not positions in the vector
+    }
+    // Same place twice, and the Mercator limits
+    points.push_back({41.39f, 2.17f, 900001});
+    points.push_back({41.39f, 2.17f, 900002});
+    points.push_back({89.0f, -180.0f, 900003});
+}
+
+/**
+ * @brief Marks of a viewport by scanning all the waypoints, same rules as WaypointOverlay::query
+ */
+static void scanMarks(const std::vector<WaypointPosition> &points, uint8_t zoom, int32_t left, int32_t top, int32_t width,
+                      int32_t height, bool cluster, std::vector<OverlayMark> &out)
+{
+    out.clear();
+    const int64_t worldSize = (int64_t)256 << zoom;
+    const int32_t right = (int32_t)std::min<int64_t>(worldSize, (int64_t)left + width);
+    const int32_t bottom = (int32_t)std::min<int64_t>(worldSize, (int64_t)top + height);
+    left = std::max(0, left);
+    top = std::max(0, top);
+    if (left >= right || top >= bottom)
+        return;
+    const uint8_t down = WaypointOverlay::WORLD_ZOOM - zoom;
+
+    struct Cell
+    {
+        uint64_t sumX = 0, sumY = 0;
+        std::vector<const WaypointPosition *> members;
+        std::vector<std::pair<int32_t, int32_t>> pos;
+    };
+    std::map<std::pair<uint32_t, uint32_t>, Cell> cells;
+    for (const WaypointPosition &p : points)
+    {
+        int32_t wx, wy;
+        WaypointOverlay::project(p.lat, p.lon, WaypointOverlay::WORLD_ZOOM, wx, wy);
+        const int32_t x = wx >> down, y = wy >> down;
+        const uint32_t cx = (uint32_t)x >> WaypointOverlay::CELL_SHIFT, cy = (uint32_t)y >> WaypointOverlay::CELL_SHIFT;
+        if (cx < ((uint32_t)left >> WaypointOverlay::CELL_SHIFT) || cx > ((uint32_t)(right - 1) >> WaypointOverlay::CELL_SHIFT) ||
+            cy < ((uint32_t)top >> WaypointOverlay::CELL_SHIFT) || cy > ((uint32_t)(bottom - 1) >> WaypointOverlay::CELL_SHIFT))
+            continue;
+        Cell &c = cells[{cy, cx}];
+        c.sumX += (uint32_t)wx;
+        c.sumY += (uint32_t)wy;
+        c.members.push_back(&p);
+        c.pos.push_back({x, y});
+    }
+    for (auto &it : cells)
+    {
+        Cell &c = it.second;
+        const uint32_t n = (uint32_t)c.members.size();
+        if (cluster && n > 1)
+        {
+            out.push_back({(int32_t)((c.sumX / n) >> down), (int32_t)((c.sumY / n) >> down), n, 0});
+            continue;
+        }
+        for (uint32_t i = 0; i < n; i++)
+        {
+            const int32_t x = c.pos[i].first, y = c.pos[i].second;
+            if (x >= left && x < right && y >= top && y < bottom)
+                out.push_back({x, y, 1, c.members[i]->id});
+        }
+    }
+}
+
+/**
+ * @brief Same marks, whatever the order (cluster ids are not compared)
+ */
+static bool sameMarks(std::vector<OverlayMark> a, std::vector<OverlayMark> b)
+{
+    auto key = [](const OverlayMark &m) { return std::make_tuple(m.y, m.x, m.count, m.count == 1 ? m.id : 0u); };
+    auto less = [&](const OverlayMark &l, const OverlayMark &r) { return key(l) < key(r); };
+    std::sort(a.begin(), a.end(), less);
+    std::sort(b.begin(), b.end(), less);
+    if (a.size() != b.size())
+        return false;
+    for (size_t i = 0; i < a.size(); i++)
+        if (key(a[i]) != key(b[i]))
+            return false;
+    return true;
+}
+
+/**
+ * @brief Positions and generations given by the waypoint store
+ */
+static bool checkStore()
+{
+    const std::string dir = "/tmp/waypoint_overlay_store";
+    mkdir(dir.c_str(), 0755);
+    const std::string gpx = dir + "/waypoint.gpx";
+    FILE *f = fopen(gpx.c_str(), "w");
+    if (!f)
+        return false;
+    fprintf(f, "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n<gpx version=\"1.0\" creator=\"IceNav\">\n"
+               "<wpt lat=\"41.5\" lon=\"2.0\"><name>A</name></wpt>\n<wpt lat=\"41.6\" lon=\"2.1\"><name>B</name></wpt>\n"
+               "</gpx>\n");
+    fclose(f);
+    std::remove((gpx + ".wdb").c_str());
+
+    WaypointStore store;
+    std::vector<WaypointPosition> pos;
+    if (!store.open(gpx.c_str()))
+        return false;
+    const uint32_t g0 = store.getPositions(pos);
+    bool ok = pos.size() == 2 && g0 == store.generation;
+
+    wayPoint wp = {};
+    char name[] = "C";
+    wp.name = name;
+    wp.lat = 41.7f;
+    wp.lon = 2.2f;
+    store.add(wp);
+    store.remove("A");
+    const uint32_t g1 = store.getPositions(pos);
+    ok &= g1 != g0 && pos.size() == 2;
+    for (const WaypointPosition &p : pos)
+        ok &= store.getName(p.id) != "A";
+    ok &= store.getPositions(pos) == g1;    // Reading does not change it
+    store.close();
+    std::remove(gpx.c_str());
+    std::remove((gpx + ".wdb").c_str());
+    return ok;
+}
+
+int main(int argc, char **argv)
+{
+    const uint32_t count = argc > 1 ? strtoul(argv[1], nullptr, 10) : 10000;
+    const int views = argc > 2 ? atoi(argv[2]) : 400;
+
+    std::vector<WaypointPosition> points;
+    makeWaypoints(count, points);
+
+    WaypointOverlay overlay;
+    auto t0 = Clock::now();
+    overlay.build(points, 7);
+    const double buildUs = elapsedUs(t0);
+    printf("Waypoints: %zu, build %.2f ms, %zu bytes\n", points.size(), buildUs / 1000.0, overlay.memoryBytes());
+
+    printf("Checks\n");
+    check(overlay.size() == points.size() && overlay.generation == 7 && overlay.built, "snapshot size and generation");
+
+    std::mt19937 rng(11);
+    std::vector<OverlayMark> got, expect;
+    uint32_t mismatches = 0;
+    for (int v = 0; v < views; v++)
+    {
+        const uint8_t zoom = 4 + rng() % 15;
+        const bool cluster = rng() % 4 != 0;
+        const WaypointPosition &c = points[rng() % points.size()];
+        int32_t cx, cy;
+        WaypointOverlay::project(c.lat, c.lon, zoom, cx, cy);
+        const int32_t left = cx - VIEW_SIZE / 2 + (int32_t)(rng() % 200) - 100;
+        const int32_t top = cy - VIEW_SIZE / 2 + (int32_t)(rng() % 200) - 100;
+        overlay.query(zoom, left, top, VIEW_SIZE, VIEW_SIZE, cluster, got);
+        scanMarks(points, zoom, left, top, VIEW_SIZE, VIEW_SIZE, cluster, expect);
+        if (!sameMarks(got, expect) && mismatches++ < 5)
+            printf("    zoom %u %s at %d,%d: %zu marks, expected %zu\n", zoom, cluster ? "clustered" : "single", left, top,
+                   got.size(), expect.size());
+    }
+    check(mismatches == 0, "random viewports match the scan");
+
+    {
+        // Every waypoint once, in a cluster or on its own
+        overlay.query(0, 0, 0, 256, 256, true, got);
+        uint64_t total = 0;
+        for (const OverlayMark &m : got)
+            total += m.count;
+        overlay.query(0, 0, 0, 256, 256, false, expect);
+        check(total == points.size() && expect.size() == points.size(), "whole world holds every waypoint once");
+    }
+
+    {
+        // Two waypoints at the same place: one cluster below the cluster zoom, two marks above
+        std::vector<WaypointPosition> pair = {{41.39f, 2.17f, 1}, {41.39f, 2.17f, 2}};
+        WaypointOverlay two;
+        two.build(pair, 1);
+        int32_t x, y;
+        WaypointOverlay::project(41.39f, 2.17f, 18, x, y);
+        two.query(18, x - 10, y - 10, 20, 20, true, got);
+        const bool clustered = got.size() == 1 && got[0].count == 2 && got[0].x == x && got[0].y == y;
+        two.query(18, x - 10, y - 10, 20, 20, false, got);
+        check(clustered && got.size() == 2 && got[0].x == x, "same place clustered or not");
+        two.query(18, x + 10, y + 10, 20, 20, false, got);
+        check(got.empty(), "waypoint out of the viewport in its cell");
+    }
+
+    {
+        WaypointOverlay none;
+        const bool emptyOk = none.query(10, 0, 0, 100, 100, true, got) == 0 && !none.built;
+        const bool offWorld = overlay.query(4, -5000, -5000, 100, 100, true, got) == 0 &&
+                              overlay.query(4, 0, 0, 0, 100, true, got) == 0 &&
+                              overlay.query(WaypointOverlay::WORLD_ZOOM + 1, 0, 0, 100, 100, true, got) == 0;
+        none.build(points, 2);
+        none.clear();
+        check(emptyOk && offWorld && none.size() == 0 && !none.built, "empty overlay and viewports off the world");
+    }
+
+    check(checkStore(), "store positions and generations");
+
+    printf("Frames (%dx%d viewport)\n", VIEW_SIZE, VIEW_SIZE);
+    double worstUs = 0.0;
+    for (uint8_t zoom = 6; zoom <= 18; zoom += 2)
+    {
+        const int reps = 500;
+        size_t marks = 0;
+        double maxUs = 0.0, totalUs = 0.0;
+        for (int r = 0; r < reps; r++)
+        {
+            const WaypointPosition &c = points[rng() % points.size()];
+            int32_t cx, cy;
+            WaypointOverlay::project(c.lat, c.lon, zoom, cx, cy);
+            t0 = Clock::now();
+            overlay.query(zoom, cx - VIEW_SIZE / 2, cy - VIEW_SIZE / 2, VIEW_SIZE, VIEW_SIZE, zoom < CLUSTER_ZOOM, got);
+            const double us = elapsedUs(t0);
+            totalUs += us;
+            maxUs = std::max(maxUs, us);
+            marks += got.size();
+        }
+        printf("  zoom %2u  %6.1f marks  mean %7.2f us  max %7.2f us\n", zoom, (double)marks / reps, totalUs / reps, maxUs);
+        worstUs = std::max(worstUs, totalUs / reps);
+    }
+    {
+        t0 = Clock::now();
+        for (int r = 0; r < 20; r++)
+            scanMarks(points, 10, 0, 0, VIEW_SIZE, VIEW_SIZE, true, expect);
+        printf("  scan of all waypoints      %7.2f us\n", elapsedUs(t0) / 20);
+    }
+    check(worstUs < 200.0, "mean frame under 0.2 ms on the host");
+
+    printf("%s\n", failures ? "FAILED" : "All checks passed");
+    return failures ? 1 : 0;
+}